@@ -32,11 +32,63 @@
 #include <stdio.h>
 
 namespace ArchapplData {
+
+   // As serialized PB messages are binary data; after serialization, newline characters are escaped
+   // to maintain a "sample per line" constraint:
+   // 1. The ASCII escape character 0x1B is escaped to the following two characters 0x1B 0x01
+   // 2. The ASCII newline character \n or 0x0A is escaped to the following two characters 0x1B 0x02
+   // 3. The ASCII carriage return character 0x0D is escaped to the following two characters 0x1B 0x03
+   //
+   // To successfully parse deserialize the data we have to remove the escaping. Every time we find 0x1B
+   // we know that this is an exaped character and is should be replaced by the character that follows.
+   //
+   static const char ESCAPE_CHAR = 0x1B;
+   static const char ESCAPE_ESCAPE_CHAR = 0x01;
+   static const char NEWLINE_CHAR = 0x0A;
+   static const char NEWLINE_ESCAPE_CHAR = 0x02;
+   static const char CARRIAGERETURN_CHAR = 0x0D;
+   static const char CARRIAGERETURN_ESCAPE_CHAR = 0x03;
+
+   static char unescapeChar(const char b)
+   {
+      switch(b) {
+      case ESCAPE_ESCAPE_CHAR:
+         return ESCAPE_CHAR;
+      case NEWLINE_ESCAPE_CHAR:
+         return NEWLINE_CHAR;
+      case CARRIAGERETURN_ESCAPE_CHAR:
+         return CARRIAGERETURN_CHAR;
+      default:
+         return b;
+      }
+   }
+
+   // Seconds from the EPICS epoch (1990-01-01 00:00:00 UTC) to the start of
+   // the given year (UTC). Based on the well known days from civil algorithm,
+   // simplified for 1st January, i.e. the March based year is year - 1.
+   //
+   static long long yearStartEpicsSeconds(const int year)
+   {
+      static const long long epicsEpochOffsetSecs = 631152000LL;   // from 1970-01-01
+
+      const long long y = static_cast<long long>(year) - 1;
+      const long long era = (y >= 0 ? y : y - 399) / 400;
+      const long long yoe = y - era * 400;                          // [0, 399]
+      const long long doy = 306;                                    // 1st Jan in a March based year
+      const long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;  // [0, 146096]
+      const long long days = era * 146097 + doe - 719468;           // since 1970-01-01
+
+      return days * 86400 - epicsEpochOffsetSecs;
+   }
+
    // A generic template funciton to get all data for one point regardless of
-   // a point value's data type
+   // a point value's data type. The point object is supplied by the caller so
+   // that it may be reused, which avoids per-sample allocation.
    //
-   template <class T> void processValue(const void* vptr, int size,  ArchapplData::PBData& data) {
-      T point;
+   template <class T> void processValue(T& point, const void* vptr, int size,
+                                        const bool wantFieldValues,
+                                        double& displayHigh, double& displayLow,
+                                        ArchapplData::PBData& data) {
       point.ParseFromArray(vptr, size);
       data.value = static_cast<double>(point.val());
       data.seconds = point.secondsintoyear();
@@ -46,61 +98,265 @@ namespace ArchapplData {
 
       for (int i = 0; i < point.fieldvalues_size(); i++) {
          const ArchapplPB::FieldValue& fieldValue = point.fieldvalues(i);
-         data.fieldValues.insert(std::make_pair(fieldValue.name(), fieldValue.val()));
+
+         // HOPR and LOPR of a PV are simply added to one or more data point values
+         // We set them only once
+         //
+         if (displayHigh == DBL_MIN || displayLow == DBL_MAX) {
+            if (fieldValue.name() == "HOPR") {
+               displayHigh = atof(fieldValue.val().c_str());
+            } else if (fieldValue.name() == "LOPR") {
+               displayLow = atof(fieldValue.val().c_str());
+            }
+         }
+
+         if (wantFieldValues) {
+            data.fieldValues.insert(std::make_pair(fieldValue.name(), fieldValue.val()));
+         }
       }
    }
 
-   void unescapePBData(std::vector<char> *pbData, std::vector< std::vector<char> > &unescapedLines)
-   {
-      // As serialized PB messages are binary data; after serialization, newline characters are escaped
-      // to maintain a "sample per line" constraint:
-      // 1. The ASCII escape character 0x1B is escaped to the following two characters 0x1B 0x01
-      // 2. The ASCII newline character \n or 0x0A is escaped to the following two characters 0x1B 0x02
-      // 3. The ASCII carriage return character 0x0D is escaped to the following two characters 0x1B 0x03
+   //---------------------------------------------------------------------------
+   // StreamDecoder private data
+   //
+   class StreamDecoder::Private {
+   public:
+      Private() { this->reset(); }
+
+      void reset() {
+         this->line.clear();
+         this->pendingEscape = false;
+         this->failed = false;
+         this->headerComming = true;
+         this->type = ArchapplPB::SCALAR_STRING;
+         this->year = 0;
+         this->yearStartSecs = yearStartEpicsSeconds(0);
+         this->eguAndPrecSet = false;
+         this->precision = 0;
+         this->pvName.clear();
+         this->units.clear();
+         this->displayHigh = DBL_MIN;
+         this->displayLow = DBL_MAX;
+         this->sampleCount = 0;
+      }
+
+      std::vector<char> line;      // reusable unescaped line buffer
+      bool pendingEscape;          // last block ended with an escape char
+      bool failed;
+      bool wantFieldValues;
+
+      bool headerComming;
+      ArchapplPB::PayloadType type;
+      int year;
+      long long yearStartSecs;     // start of year, relative to the EPICS epoch
+      bool eguAndPrecSet;
+      int precision;
+      std::string pvName;
+      std::string units;
+      double displayHigh;
+      double displayLow;
+      size_t sampleCount;
+
+      // Reused message objects.
       //
-      // To successfully parse deserialize the data we have to remove the escaping. Every time we find 0x1B
-      // we know that this is an exaped character and is should be replaced by the character that follows.
+      ArchapplPB::PayloadInfo payloadInfo;
+      ArchapplPB::ScalarShort scalarShort;
+      ArchapplPB::ScalarEnum scalarEnum;
+      ArchapplPB::ScalarFloat scalarFloat;
+      ArchapplPB::ScalarDouble scalarDouble;
+      ArchapplPB::ScalarInt scalarInt;
+      ArchapplData::PBData sample;
+   };
+
+   //---------------------------------------------------------------------------
+   //
+   StreamDecoder::StreamDecoder()
+   {
+      this->priv = new Private();
+      this->priv->wantFieldValues = false;
+   }
+
+   StreamDecoder::~StreamDecoder()
+   {
+      delete this->priv;
+   }
+
+   void StreamDecoder::reset()
+   {
+      this->priv->reset();
+   }
+
+   void StreamDecoder::setWantFieldValues(const bool wantFieldValues)
+   {
+      this->priv->wantFieldValues = wantFieldValues;
+   }
+
+   bool StreamDecoder::getWantFieldValues() const { return this->priv->wantFieldValues; }
+   int StreamDecoder::getPrecision() const { return this->priv->precision; }
+   const std::string& StreamDecoder::getPvName() const { return this->priv->pvName; }
+   const std::string& StreamDecoder::getUnits() const { return this->priv->units; }
+   double StreamDecoder::getDisplayHigh() const { return this->priv->displayHigh; }
+   double StreamDecoder::getDisplayLow() const { return this->priv->displayLow; }
+   size_t StreamDecoder::getSampleCount() const { return this->priv->sampleCount; }
+
+   //---------------------------------------------------------------------------
+   // The year is normally that of the current header, whose start is held.
+   //
+   long long StreamDecoder::getSampleEpicsNanoSecs(const PBData& data) const
+   {
+      const long long yearStart = (data.year == this->priv->year) ? this->priv->yearStartSecs
+                                                                   : yearStartEpicsSeconds(data.year);
+      return (yearStart + data.seconds) * 1000000000LL + data.nanos;
+   }
+
+   //---------------------------------------------------------------------------
+   // Each line is either processed directly from the given data (the common
+   // case - no escapes and not split across blocks), or unescaped into the
+   // reusable line buffer.
+   //
+   bool StreamDecoder::processData(const char* data, const size_t size)
+   {
+      Private* p = this->priv;
+      size_t i = 0;
+
+      // Complete any escape sequence split across blocks.
       //
-      const char ESCAPE_CHAR = 0x1B;
-      const char ESCAPE_ESCAPE_CHAR = 0x01;
-      const char NEWLINE_CHAR = 0x0A;
-      const char NEWLINE_ESCAPE_CHAR = 0x02;
-      const char CARRIAGERETURN_CHAR = 0x0D;
-      const char CARRIAGERETURN_ESCAPE_CHAR = 0x03;
-
-      std::vector<char> unescapedLineBuffer;
-
-      for (size_t i = 0; i < pbData->size(); i++) {
-         if (pbData->at(i) == NEWLINE_CHAR) {
-            std::vector<char> unescapedLine = unescapedLineBuffer;
-            unescapedLines.push_back(unescapedLine);
-            unescapedLineBuffer = std::vector<char>();
+      if (p->pendingEscape && (size > 0)) {
+         p->line.push_back(unescapeChar(data[i++]));
+         p->pendingEscape = false;
+      }
+
+      while (i < size && !p->failed) {
+         // Find the end of this run, i.e. the next newline or escape.
+         //
+         const size_t start = i;
+         while (i < size && data[i] != NEWLINE_CHAR && data[i] != ESCAPE_CHAR) i++;
+
+         if (i >= size) {
+            // Partial line - retain until next block.
+            //
+            p->line.insert(p->line.end(), data + start, data + i);
+            break;
+         }
+
+         if (data[i] == NEWLINE_CHAR) {
+            if (p->line.empty()) {
+               // Whole line within this block, nothing escaped - zero copy.
+               //
+               this->processLine(data + start, i - start);
+            } else {
+               p->line.insert(p->line.end(), data + start, data + i);
+               this->processLine(&p->line[0], p->line.size());
+               p->line.clear();    // retains capacity
+            }
+            i++;
+
          } else {
-            char b = pbData->at(i);
-            if (b == ESCAPE_CHAR) {
-               b = pbData->at(++i);
-               switch(b) {
-               case ESCAPE_ESCAPE_CHAR:
-                  unescapedLineBuffer.push_back(ESCAPE_CHAR);
-                  break;
-               case NEWLINE_ESCAPE_CHAR:
-                  unescapedLineBuffer.push_back(NEWLINE_CHAR);
-                  break;
-               case CARRIAGERETURN_ESCAPE_CHAR:
-                  unescapedLineBuffer.push_back(CARRIAGERETURN_CHAR);
-                  break;
-               default:
-                  unescapedLineBuffer.push_back(b);
-                  break;
-               }
+            // Escape char
+            //
+            p->line.insert(p->line.end(), data + start, data + i);
+            i++;
+            if (i < size) {
+               p->line.push_back(unescapeChar(data[i++]));
             } else {
-               unescapedLineBuffer.push_back(b);
+               p->pendingEscape = true;
             }
          }
       }
+
+      return !p->failed;
    }
 
+   //---------------------------------------------------------------------------
+   //
+   void StreamDecoder::processLine(const char* line, const size_t lineLength)
+   {
+      Private* p = this->priv;
+
+      if (p->failed) return;
+
+      if (lineLength == 0) {
+         // We're at an empty line
+         //
+         p->headerComming = true;
+      } else if (p->headerComming && p->payloadInfo.ParseFromArray(line, int(lineLength))) {
+         // We're at a header line containing PV name, year, data type and possibly but not
+         // necessarily extra PV field values like EGU and PREC
+         //
+         p->pvName = p->payloadInfo.pvname();
+         p->type = p->payloadInfo.type();
+         if (p->payloadInfo.year() != p->year) {
+            p->year = p->payloadInfo.year();
+            p->yearStartSecs = yearStartEpicsSeconds(p->year);
+         }
+
+         // We only set engineering units and precission once as they are the same
+         // for the same PV
+         //
+         if (!p->eguAndPrecSet) {
+            for (int i = 0; i < p->payloadInfo.headers_size(); i++) {
+               const ArchapplPB::FieldValue& value = p->payloadInfo.headers(i);
+               if (value.name() == "EGU") {
+                  p->units = value.val();
+               } else if (value.name() == "PREC") {
+                  p->precision = atoi(value.val().c_str());
+               }
+            }
+            p->eguAndPrecSet = true;
+         }
+         p->headerComming = false;
+      } else {
+         // We're at a line containing one PV data point along with timestamp,
+         // severity and status
+         //
+         ArchapplData::PBData& onePointData = p->sample;
+         onePointData.fieldValues.clear();
+
+         const int length = int(lineLength);
+         switch (p->type) {
+         case ArchapplPB::SCALAR_SHORT:
+            processValue(p->scalarShort, line, length, p->wantFieldValues, p->displayHigh, p->displayLow, onePointData);
+            break;
+         case ArchapplPB::SCALAR_ENUM:
+            processValue(p->scalarEnum, line, length, p->wantFieldValues, p->displayHigh, p->displayLow, onePointData);
+            break;
+         case ArchapplPB::SCALAR_FLOAT:
+            processValue(p->scalarFloat, line, length, p->wantFieldValues, p->displayHigh, p->displayLow, onePointData);
+            break;
+         case ArchapplPB::SCALAR_DOUBLE:
+            processValue(p->scalarDouble, line, length, p->wantFieldValues, p->displayHigh, p->displayLow, onePointData);
+            break;
+         case ArchapplPB::SCALAR_INT:
+            processValue(p->scalarInt, line, length, p->wantFieldValues, p->displayHigh, p->displayLow, onePointData);
+            break;
+         default:
+            printf("archapplData.cpp:%d:%s Unsupported data format: %d\n", __LINE__, __FUNCTION__, int(p->type));
+            p->failed = true;
+            return;
+         }
+
+         onePointData.year = p->year;
+         p->sampleCount++;
+         this->processSample(onePointData);
 
+         p->headerComming = false;
+      }
+   }
+
+   //---------------------------------------------------------------------------
+   // Collects all the samples into a vector, as per processProtoBuffers.
+   //
+   class VectorDecoder : public StreamDecoder {
+   public:
+      explicit VectorDecoder(std::vector<PBData>& pvDataIn) : pvData(pvDataIn) {}
+   protected:
+      void processSample(const PBData& data) { this->pvData.push_back(data); }
+   private:
+      std::vector<PBData>& pvData;
+   };
+
+   //---------------------------------------------------------------------------
+   //
    void processProtoBuffers(std::vector<char> *pbData,
                             int &precision,
                             std::string &pvName,
@@ -109,104 +365,21 @@ namespace ArchapplData {
                             double &displayLow,
                             std::vector<ArchapplData::PBData> &pvData)
    {
-      ArchapplPB::PayloadInfo payloadInfo;
-      std::vector< std::vector<char> > unescapedLines;
-
       // Archiver Appliance escapes special characters so that after serialization
-      // each data point still falls in one line. To successfully parse the data
-      // we first have to unsecape special characters.
+      // each data point still falls in one line. The decoder handles the unescaping.
+      // Note: this function has always provided the sample field values.
       //
-      unescapePBData(pbData, unescapedLines);
-
-      bool headerComming = true;
-      ArchapplPB::PayloadType type = ArchapplPB::SCALAR_STRING;
-      int year = 0;
-      bool eguAndPrecSet = false;
-      displayHigh = DBL_MIN;
-      displayLow = DBL_MAX;
-
-      std::vector< std::vector<char> >::iterator it = unescapedLines.begin();
-      while (it != unescapedLines.end()) {
-         int lineLength = (*it).size();
-         const void* line = &((*(it++))[0]);
-         if (lineLength == 0) {
-            // We're at an empty line
-            //
-            headerComming = true;
-         } else if (headerComming && payloadInfo.ParseFromArray(line, lineLength)) {
-            // We're at a header line containing PV name, year, data type and possibly but not
-            // necessarily extra PV field values like EGU and PREC
-            //
-            pvName = payloadInfo.pvname();
-            type = payloadInfo.type();
-            year = payloadInfo.year();
-
-            // We only set engineering units and precission once as they are the same
-            // for the same PV
-            //
-            if (!eguAndPrecSet) {
-               for (int i = 0; i < payloadInfo.headers_size(); i++) {
-                  const ArchapplPB::FieldValue& value = payloadInfo.headers(i);
-                  std::string name = value.name();
-                  std::string fieldValue = value.val();
-                  if (name == "EGU") {
-                     units = fieldValue;
-                  } else if (name == "PREC") {
-                     //precision = std::stoi(fieldValue);
-                     precision = atoi( fieldValue.c_str() );
-                  }
-               }
-               eguAndPrecSet = true;
-            }
-            headerComming = false;
-         } else {
-            // We're at a line containing one PV data point along with timestamp,
-            // severity and status
-            //
-            ArchapplData::PBData onePointData;
-            switch (type) {
-            case ArchapplPB::SCALAR_SHORT:
-               processValue<ArchapplPB::ScalarShort>(line, lineLength, onePointData);
-               break;
-            case ArchapplPB::SCALAR_ENUM:
-               processValue<ArchapplPB::ScalarEnum>(line, lineLength, onePointData);
-               break;
-            case ArchapplPB::SCALAR_FLOAT:
-               processValue<ArchapplPB::ScalarFloat>(line, lineLength, onePointData);
-               break;
-            case ArchapplPB::SCALAR_DOUBLE:
-               processValue<ArchapplPB::ScalarDouble>(line, lineLength, onePointData);
-               break;
-            case ArchapplPB::SCALAR_INT:
-               processValue<ArchapplPB::ScalarInt>(line, lineLength, onePointData);
-               break;
-            default:
-               printf("archapplData.cpp:%d:%s Unsupported data format: %d\n", __LINE__, __FUNCTION__, int(type));
-               return;
-            }
-
-            // HOPR and LOPR of a PV are simply added to one or more data point values
-            // We set them only once
-            //
-            if ((displayHigh ==  DBL_MIN || displayLow ==  DBL_MAX) && !onePointData.fieldValues.empty()) {
-               std::map<std::string,std::string>::iterator it;
-               for (it = onePointData.fieldValues.begin(); it != onePointData.fieldValues.end(); it++) {
-                  std::string name = it->first;
-                  std::string fieldValue = it->second;
-                  if (name == "HOPR") {
-                     displayHigh = atof(fieldValue.c_str());
-                  } else if (name == "LOPR") {
-                     displayLow = atof(fieldValue.c_str());
-                  }
-               }
-            }
-
-            onePointData.year = year;
-            pvData.push_back(onePointData);
-
-            headerComming = false;
-         }
+      VectorDecoder decoder(pvData);
+      decoder.setWantFieldValues(true);
+      if (!pbData->empty()) {
+         decoder.processData(&(*pbData)[0], pbData->size());
       }
+
+      precision = decoder.getPrecision();
+      pvName = decoder.getPvName();
+      units = decoder.getUnits();
+      displayHigh = decoder.getDisplayHigh();
+      displayLow = decoder.getDisplayLow();
    }
 }
 
@@ -73,6 +73,75 @@ namespace ArchapplData {
                             double &displayLow,
                             std::vector<PBData> &pvData);
 
+
+   /**
+    * Streaming Google Protcol Buffers decoder
+    *
+    * Data may be presented in arbitrary sized blocks as and when it arrives,
+    * e.g. on each network readyRead. Each complete line is unescaped into a
+    * single reusable line buffer (or parsed directly from the presented data
+    * when it contains no escaped characters) and each sample is passed to
+    * processSample as soon as it is decoded. There is no intermediate copy of
+    * the whole response nor of the decoded samples.
+    *
+    * Sample field values (as opposed to HOPR/LOPR which are always extracted)
+    * are only materialised if requested using setWantFieldValues.
+    */
+   class epicsShareClass StreamDecoder {
+   public:
+      explicit StreamDecoder();
+      virtual ~StreamDecoder();
+
+      // Discards any partial line and header information, ready for new data.
+      //
+      void reset();
+
+      // Decode the next block of data. Returns false once an unsupported data
+      // type has been encountered, after which all further data is ignored.
+      // Any trailing partial line is retained until the next block.
+      //
+      bool processData(const char* data, const size_t size);
+
+      // Default is false.
+      //
+      void setWantFieldValues(const bool wantFieldValues);
+      bool getWantFieldValues() const;
+
+      // Header information - available once the (first) header has been decoded.
+      // The displayHigh/displayLow values are DBL_MIN/DBL_MAX respectively if
+      // not available.
+      //
+      int getPrecision() const;
+      const std::string& getPvName() const;
+      const std::string& getUnits() const;
+      double getDisplayHigh() const;
+      double getDisplayLow() const;
+      size_t getSampleCount() const;
+
+   protected:
+      // Called for each decoded sample. The data reference is only valid for
+      // the duration of the call.
+      //
+      virtual void processSample(const PBData& data) = 0;
+
+      // Returns the sample time as nano seconds since the EPICS epoch, i.e.
+      // 1990-01-01 00:00:00 UTC, combining the year (from the header) with the
+      // seconds into year and nano seconds (from the sample). The start of the
+      // year is only worked out when a header changes the year.
+      //
+      long long getSampleEpicsNanoSecs(const PBData& data) const;
+
+   private:
+      void processLine(const char* line, const size_t lineLength);
+
+      class Private;
+      Private* priv;
+
+      // No copy
+      StreamDecoder(const StreamDecoder&);
+      StreamDecoder& operator=(const StreamDecoder&);
+   };
+
 }
 
 #endif // ARCHAPPLDATA_H
@@ -0,0 +1,1072 @@
+/*  QEArchapplFileInterface.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Starritt
+ *  Contact details:
+ *    andrew.starritt@synchrotron.org.au
+ */
+
+#include "QEArchapplFileInterface.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+#include <QTimer>
+#include <QECommon.h>
+#include <QEAdaptationParameters.h>
+#include <QEArchiveManager.h>
+
+// Enable Archiver Appliance support
+//
+#ifdef QE_ARCHAPPL_SUPPORT
+   #include <string.h>
+   #include <algorithm>
+   #include <QDateTime>
+   #include <QDir>
+   #include <QDirIterator>
+   #include <QElapsedTimer>
+   #include <QFile>
+   #include <QFileInfo>
+   #include <QRegularExpression>
+   #include "../../../include/archapplData.h"
+#endif
+
+#define DEBUG qDebug () << "QEArchapplFileInterface" << __LINE__ << __FUNCTION__  << "  "
+
+
+//------------------------------------------------------------------------------
+// Enable Archiver Appliance support
+//
+#ifdef QE_ARCHAPPL_SUPPORT
+
+// Target spacing of the time index entries.
+//
+static const qint64 indexStride = 64 * 1024;
+
+//==============================================================================
+// QEArchapplPartitionCollector
+//==============================================================================
+// Gathers the samples within a time range, together with the latest sample
+// prior to the start time. As partition files from different storage stages
+// may overlap, samples that are not after the last retained sample are ignored.
+//
+// Binned requests are binned as the samples arrive, so that at most count bins
+// worth of points are held, irrespective of the number of samples decoded. The
+// raw samples are held only while there are too few to be worth binning. Raw
+// requests are limited to maxPoints samples.
+//
+class QEArchapplPartitionCollector {
+public:
+   explicit QEArchapplPartitionCollector (const QCaTimeStamp& startTimeIn,
+                                          const QCaTimeStamp& endTimeIn,
+                                          const int count,
+                                          const QEArchiveInterface::How howIn,
+                                          const int maxPointsIn);
+   ~QEArchapplPartitionCollector () {}
+
+   void add (const QCaDataPoint& point);
+
+   // Raw request with more than maxPoints samples.
+   //
+   bool isOverflow () const { return this->overflow; }
+
+   // Leading point (if any) followed by the in-range points or bins.
+   //
+   void takeResult (QCaDataPointList& result);
+
+private:
+   void startBinning ();
+   void accumulate (const QCaDataPoint& point);
+   void flushBin ();
+
+   const QCaTimeStamp startTime;
+   const QCaTimeStamp endTime;
+   const QEArchiveInterface::How how;
+   const int maxPoints;
+   int numberBins;
+   int pointsPerBin;
+   qint64 binWidth;                // nano seconds
+   bool isBinning;                 // request is to be binned
+   bool isBinned;                  // points hold bins as opposed to samples
+   bool overflow;
+
+   QCaDataPointList points;
+   QCaDataPoint leading;
+   bool hasLeading;
+   QCaTimeStamp lastTime;
+   bool hasLast;
+
+   // The current bin.
+   //
+   int bin;
+   int number;
+   int numberValid;
+   double sum;
+   QCaDataPoint minPoint;
+   QCaDataPoint maxPoint;
+   QCaDataPoint worstPoint;
+};
+
+//------------------------------------------------------------------------------
+//
+QEArchapplPartitionCollector::QEArchapplPartitionCollector (const QCaTimeStamp& startTimeIn,
+                                                            const QCaTimeStamp& endTimeIn,
+                                                            const int count,
+                                                            const QEArchiveInterface::How howIn,
+                                                            const int maxPointsIn) :
+   startTime (startTimeIn),
+   endTime (endTimeIn),
+   how (howIn),
+   maxPoints (maxPointsIn)
+{
+   const qint64 span = startTimeIn.nanoSecsTo (endTimeIn);
+
+   // The appliance provides the mean_N and caplotbinning_N post processors;
+   // here we do the equivalent locally. Plot binning yields the minimum and
+   // maximum points of each bin, the others yield the mean value at the start
+   // of each bin.
+   //
+   this->numberBins = MAX (count, 1);
+   this->pointsPerBin = (howIn == QEArchiveInterface::PlotBinning) ? 2 : 1;
+   this->binWidth = (span > 0) ? span / this->numberBins : 0;
+   this->isBinning = (span > 0) &&
+                     (howIn != QEArchiveInterface::Raw) &&
+                     (howIn != QEArchiveInterface::SpreadSheet);
+   this->isBinned = false;
+   this->overflow = false;
+
+   this->hasLeading = false;
+   this->hasLast = false;
+
+   this->bin = -1;
+   this->number = 0;
+   this->numberValid = 0;
+   this->sum = 0.0;
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplPartitionCollector::add (const QCaDataPoint& point)
+{
+   if (point.datetime < this->startTime) {
+      if (!this->hasLeading || (point.datetime >= this->leading.datetime)) {
+         this->leading = point;
+         this->hasLeading = true;
+      }
+      return;
+   }
+
+   if (point.datetime > this->endTime) return;
+   if (this->hasLast && (point.datetime <= this->lastTime)) return;
+
+   this->lastTime = point.datetime;
+   this->hasLast = true;
+
+   if (this->isBinned) {
+      this->accumulate (point);
+      return;
+   }
+
+   if (!this->isBinning && (this->points.count () >= this->maxPoints)) {
+      this->overflow = true;
+      return;
+   }
+
+   this->points.append (point);
+
+   // Nothing to gain from binning until there are more samples than bin points.
+   //
+   if (this->isBinning && (this->points.count () > this->numberBins * this->pointsPerBin)) {
+      this->startBinning ();
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplPartitionCollector::takeResult (QCaDataPointList& result)
+{
+   // The leading point counts towards whether binning is worthwhile.
+   //
+   const int extra = this->hasLeading ? 1 : 0;
+   if (this->isBinning && !this->isBinned &&
+       (this->points.count () + extra > this->numberBins * this->pointsPerBin)) {
+      this->startBinning ();
+   }
+   if (this->isBinned) this->flushBin ();
+
+   result.clear ();
+   result.reserve (this->points.count () + 1);
+   if (this->hasLeading) result.append (this->leading);
+   result.append (this->points);
+   this->points.clear ();
+   this->hasLeading = false;
+   this->hasLast = false;
+}
+
+//------------------------------------------------------------------------------
+// Re-bin the samples gathered so far; from here on the samples are binned as
+// they arrive.
+//
+void QEArchapplPartitionCollector::startBinning ()
+{
+   const QCaDataPointList samples = this->points;
+   this->points.clear ();
+   this->points.reserve (this->numberBins * this->pointsPerBin);
+   this->isBinned = true;
+
+   for (int j = 0; j < samples.count (); j++) {
+      this->accumulate (samples.value (j));
+   }
+}
+
+//------------------------------------------------------------------------------
+// Samples arrive in time order, so once a sample is beyond the current bin,
+// that bin is complete. Empty bins yield no points.
+//
+void QEArchapplPartitionCollector::accumulate (const QCaDataPoint& point)
+{
+   const qint64 offset = this->startTime.nanoSecsTo (point.datetime);
+   int pointBin = this->numberBins - 1;
+   if (this->binWidth > 0) {
+      pointBin = int (MIN (offset / this->binWidth, qint64 (this->numberBins - 1)));
+   }
+
+   if (pointBin != this->bin) {
+      this->flushBin ();
+      this->bin = pointBin;
+   }
+
+   if (this->number == 0 || int (point.alarm.getSeverity ()) > int (this->worstPoint.alarm.getSeverity ())) {
+      this->worstPoint = point;
+   }
+   this->number++;
+
+   if (point.alarm.isInvalid ()) return;
+
+   if ((this->numberValid == 0) || (point.value < this->minPoint.value)) this->minPoint = point;
+   if ((this->numberValid == 0) || (point.value > this->maxPoint.value)) this->maxPoint = point;
+   this->sum += point.value;
+   this->numberValid++;
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplPartitionCollector::flushBin ()
+{
+   if (this->number == 0) return;      // empty bin
+
+   const QCaTimeStamp binStart = this->startTime.addNanoSecs (this->binWidth * this->bin);
+
+   if (this->numberValid == 0) {
+      // Nothing but invalid points.
+      //
+      this->worstPoint.datetime = binStart;
+      this->points.append (this->worstPoint);
+
+   } else if (this->how == QEArchiveInterface::PlotBinning) {
+      if (this->minPoint.datetime == this->maxPoint.datetime) {
+         this->points.append (this->minPoint);
+      } else if (this->minPoint.datetime < this->maxPoint.datetime) {
+         this->points.append (this->minPoint);
+         this->points.append (this->maxPoint);
+      } else {
+         this->points.append (this->maxPoint);
+         this->points.append (this->minPoint);
+      }
+
+   } else {
+      QCaDataPoint meanPoint;
+      meanPoint.value = this->sum / this->numberValid;
+      meanPoint.datetime = binStart;
+      meanPoint.alarm = this->worstPoint.alarm;
+      this->points.append (meanPoint);
+   }
+
+   this->number = 0;
+   this->numberValid = 0;
+   this->sum = 0.0;
+}
+
+
+//==============================================================================
+// QEArchapplPartitionReader
+//==============================================================================
+// Provides access to a single memory-mapped partition file. The first line is
+// the header (PayloadInfo), each subsequent line is one sample. Because of the
+// appliance's escaping, a newline character only ever occurs at the end of a
+// line, so any line may be located, and decoded, independently of the rest of
+// the file. Any trailing partial line (i.e. a sample being written by a live
+// appliance) is ignored.
+//
+class QEArchapplPartitionReader : public ArchapplData::StreamDecoder {
+public:
+   explicit QEArchapplPartitionReader () :
+      collector (NULL),
+      map (NULL), size (0), dataOffset (0), dataEnd (0) {}
+   ~QEArchapplPartitionReader () { this->close (); }
+
+   // Maps the file and decodes the header.
+   //
+   bool open (const QString& path);
+   void close ();
+
+   // Returns the offset of the first line starting at or after the given offset.
+   //
+   qint64 lineStartAfter (const qint64 offset) const;
+
+   // Returns the offset of the last (complete) sample line, or dataEnd if none.
+   //
+   qint64 lastLineStart () const;
+
+   // Decodes the single sample line at offset.
+   //
+   bool sampleTime (const qint64 offset, QCaTimeStamp& time);
+
+   // Decodes all the sample lines in the range, passing each to the collector.
+   //
+   void decode (const qint64 from, const qint64 to);
+
+   QEArchapplPartitionCollector* collector;
+   const uchar* map;
+   qint64 size;
+   qint64 dataOffset;      // first sample line
+   qint64 dataEnd;         // end of last complete line
+
+protected:
+   void processSample (const ArchapplData::PBData& onePointData);
+
+private:
+   QFile file;
+   QCaTimeStamp lastTime;
+};
+
+//------------------------------------------------------------------------------
+//
+bool QEArchapplPartitionReader::open (const QString& path)
+{
+   this->close ();
+   this->reset ();
+
+   this->file.setFileName (path);
+   if (!this->file.open (QIODevice::ReadOnly)) {
+      DEBUG << "cannot open" << path;
+      return false;
+   }
+
+   this->size = this->file.size ();
+   this->map = (this->size > 0) ? this->file.map (0, this->size) : NULL;
+   if (!this->map) {
+      this->close ();
+      return false;
+   }
+
+   const uchar* newLine = (const uchar*) memchr (this->map, '\n', size_t (this->size));
+   if (!newLine) {
+      this->close ();
+      return false;
+   }
+
+   this->dataOffset = (newLine - this->map) + 1;
+
+   // Decode the header, i.e. PV name, year, type etc.
+   //
+   this->processData ((const char*) this->map, size_t (this->dataOffset));
+   if (this->getPvName ().empty ()) {
+      DEBUG << "invalid header" << path;
+      this->close ();
+      return false;
+   }
+
+   // Locate the end of the last complete line.
+   //
+   this->dataEnd = this->size;
+   while ((this->dataEnd > this->dataOffset) && (this->map [this->dataEnd - 1] != '\n')) {
+      this->dataEnd--;
+   }
+
+   return true;
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplPartitionReader::close ()
+{
+   if (this->map) {
+      this->file.unmap ((uchar*) this->map);
+      this->map = NULL;
+   }
+   if (this->file.isOpen ()) {
+      this->file.close ();
+   }
+   this->size = 0;
+   this->dataOffset = 0;
+   this->dataEnd = 0;
+}
+
+//------------------------------------------------------------------------------
+//
+qint64 QEArchapplPartitionReader::lineStartAfter (const qint64 offset) const
+{
+   if (offset <= this->dataOffset) return this->dataOffset;
+   if (offset >= this->dataEnd) return this->dataEnd;
+
+   // Is offset already at the start of a line?
+   //
+   const qint64 from = offset - 1;
+   const uchar* newLine = (const uchar*) memchr (this->map + from, '\n',
+                                                 size_t (this->dataEnd - from));
+
+   return newLine ? (newLine - this->map) + 1 : this->dataEnd;
+}
+
+//------------------------------------------------------------------------------
+//
+qint64 QEArchapplPartitionReader::lastLineStart () const
+{
+   if (this->dataEnd <= this->dataOffset) return this->dataEnd;
+
+   qint64 result = this->dataEnd - 1;   // the last line's newline
+   while ((result > this->dataOffset) && (this->map [result - 1] != '\n')) {
+      result--;
+   }
+   return result;
+}
+
+//------------------------------------------------------------------------------
+//
+bool QEArchapplPartitionReader::sampleTime (const qint64 offset, QCaTimeStamp& time)
+{
+   if ((offset < this->dataOffset) || (offset >= this->dataEnd)) return false;
+
+   const uchar* newLine = (const uchar*) memchr (this->map + offset, '\n',
+                                                 size_t (this->dataEnd - offset));
+   if (!newLine) return false;
+
+   const size_t number = this->getSampleCount ();
+   QEArchapplPartitionCollector* save = this->collector;
+   this->collector = NULL;
+   this->processData ((const char*) this->map + offset, size_t ((newLine - this->map) + 1 - offset));
+   this->collector = save;
+
+   if (this->getSampleCount () == number) return false;
+   time = this->lastTime;
+   return true;
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplPartitionReader::decode (const qint64 from, const qint64 to)
+{
+   const qint64 start = MAX (from, this->dataOffset);
+   const qint64 end = MIN (to, this->dataEnd);
+   if (start >= end) return;
+
+   this->processData ((const char*) this->map + start, size_t (end - start));
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplPartitionReader::processSample (const ArchapplData::PBData& onePointData)
+{
+   // As per the values decoder, the year comes from the header, and the
+   // seconds into year and nano seconds from each sample.
+   //
+   this->lastTime = QCaTimeStamp::fromNanoSecs (this->getSampleEpicsNanoSecs (onePointData));
+   if (this->collector) {
+      QCaDataPoint point;
+      point.value = onePointData.value;
+      point.alarm = QCaAlarmInfo (onePointData.status, onePointData.severity);
+      point.datetime = this->lastTime;
+      this->collector->add (point);
+   }
+}
+
+
+//==============================================================================
+// QEArchapplFileInterface
+//==============================================================================
+//
+QEArchapplFileInterface::QEArchapplFileInterface (QUrl url, QObject* parent) :
+   QEArchiveInterface (parent)
+{
+   this->isScanned = false;
+   this->isProcessScheduled = false;
+
+   QEAdaptationParameters ap ("QE_");
+   this->maxValuesPoints = MAX (ap.getInt ("archive_ca_max_points", 2000000), 1000);
+
+   this->statistics.bytesReceived = 0;
+   this->statistics.decodeJobs = 0;
+   this->statistics.decodeNanoSecs = 0;
+   this->statistics.queueNanoSecs = 0;
+
+   this->setUrl (url);
+}
+
+//------------------------------------------------------------------------------
+//
+QEArchapplFileInterface::~QEArchapplFileInterface () { }
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplFileInterface::setUrl (QUrl url)
+{
+   QEArchiveInterface::setUrl (url);
+
+   const QString path = url.isLocalFile () ? url.toLocalFile () : url.path ();
+   this->rootDirectory = QDir::cleanPath (path);
+   this->isScanned = false;
+   this->partitions.clear ();
+   this->indexCache.clear ();
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplFileInterface::getStatistics (Statistics& statisticsOut) const
+{
+   QMutexLocker locker (&this->statisticsMutex);
+   statisticsOut = this->statistics;
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplFileInterface::infoRequest (QObject* userData)
+{
+   Request request;
+   request.context.method = Information;
+   request.context.userData = userData;
+   request.context.requested_element = 0;
+   request.count = 0;
+   request.how = Raw;
+   this->queueRequest (request);
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplFileInterface::archivesRequest (QObject* userData)
+{
+   Request request;
+   request.context.method = Archives;
+   request.context.userData = userData;
+   request.context.requested_element = 0;
+   request.count = 0;
+   request.how = Raw;
+   this->queueRequest (request);
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplFileInterface::namesRequest (QObject* userData, const int /* key */,
+                                            QString pattern)
+{
+   Request request;
+   request.context.method = Names;
+   request.context.userData = userData;
+   request.context.requested_element = 0;
+   request.count = 0;
+   request.how = Raw;
+   request.pattern = pattern;
+   this->queueRequest (request);
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplFileInterface::valuesRequest (QObject* userData,
+                                             const QCaDateTime startTime,
+                                             const QCaDateTime endTime,
+                                             const int count,
+                                             const How how,
+                                             const QStringList pvNames,
+                                             const int /* key */,
+                                             const unsigned int requested_element)
+{
+   Request request;
+   request.context.method = Values;
+   request.context.userData = userData;
+   request.context.requested_element = requested_element;
+   request.startTime = startTime.toTimeStamp ();
+   request.endTime = endTime.toTimeStamp ();
+   request.count = count;
+   request.how = how;
+   request.pvNames = pvNames;
+   this->queueRequest (request);
+}
+
+//------------------------------------------------------------------------------
+// As requests are processed one at a time, any request to be cancelled must
+// still be queued.
+//
+void QEArchapplFileInterface::cancelValuesRequest (QObject* userData)
+{
+   for (int j = 0; j < this->requests.count (); j++) {
+      Request& request = this->requests [j];
+      if ((request.context.method == Values) && (request.context.userData == userData)) {
+         request.isCancelled = true;
+      }
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplFileInterface::valuesAtTimeRequest (QObject* userData,
+                                                   const QCaDateTime time,
+                                                   const QStringList pvNames,
+                                                   const int /* key */)
+{
+   Request request;
+   request.context.method = ValuesAtTime;
+   request.context.userData = userData;
+   request.context.requested_element = 0;
+   request.startTime = time.toTimeStamp ();
+   request.endTime = request.startTime;
+   request.count = 1;
+   request.how = Raw;
+   request.pvNames = pvNames;
+   this->queueRequest (request);
+}
+
+//------------------------------------------------------------------------------
+// The responses are always emitted from the event loop, never from within the
+// xxxRequest function itself, as the interface manager's request functions
+// are not re-entrant.
+//
+void QEArchapplFileInterface::queueRequest (const Request& request)
+{
+   this->requests.append (request);
+   this->requests.last ().isCancelled = false;
+   if (!this->isProcessScheduled) {
+      this->isProcessScheduled = true;
+      QTimer::singleShot (0, this, SLOT (processRequests ()));
+   }
+}
+
+//------------------------------------------------------------------------------
+// slot
+// One request per event loop iteration, so as not to block for too long.
+//
+void QEArchapplFileInterface::processRequests ()
+{
+   this->isProcessScheduled = false;
+   if (this->requests.isEmpty ()) return;
+
+   const Request request = this->requests.takeFirst ();
+
+   switch (request.context.method) {
+
+      case Information:
+         {
+            const bool okay = QDir (this->rootDirectory).exists ();
+            const QString description =
+                  QString ("Archiver Appliance storage: %1").arg (this->rootDirectory);
+            emit this->infoResponse (request.context.userData, okay, 0, description);
+         }
+         break;
+
+      case Archives:
+         {
+            // As per the Archiver Appliance, there is just the one "archive".
+            //
+            ArchiveList pvArchives;
+            struct Archive item;
+
+            item.key = 0;
+            item.nameIndex = QEArchiveManager::getArchiveNameIndex ("Archiver Appliance Storage");
+            item.pathIndex = QEArchiveManager::getPathIndex (this->rootDirectory);
+            pvArchives.append (item);
+
+            emit this->archivesResponse (request.context.userData, true, pvArchives);
+         }
+         break;
+
+      case Names:
+         this->processNames (request);
+         break;
+
+      case Values:
+         this->processValues (request);
+         break;
+
+      case ValuesAtTime:
+         this->processValuesAtTime (request);
+         break;
+
+      default:
+         DEBUG << "unexpected method: " << request.context.method;
+         break;
+   }
+
+   if (!this->requests.isEmpty () && !this->isProcessScheduled) {
+      this->isProcessScheduled = true;
+      QTimer::singleShot (0, this, SLOT (processRequests ()));
+   }
+}
+
+//------------------------------------------------------------------------------
+// Find all partition files, and note the PV name and time span of each.
+// Time indices for files that have not changed are retained.
+//
+void QEArchapplFileInterface::scan ()
+{
+   this->partitions.clear ();
+   this->isScanned = true;
+
+   QHash<QString, FileIndex> retained;
+   QEArchapplPartitionReader reader;
+
+   QDirIterator iterator (this->rootDirectory, QStringList () << "*.pb",
+                          QDir::Files, QDirIterator::Subdirectories);
+
+   while (iterator.hasNext ()) {
+      iterator.next ();
+      const QFileInfo info = iterator.fileInfo ();
+
+      Partition partition;
+      partition.path = info.filePath ();
+      partition.size = info.size ();
+      partition.modified = info.lastModified ().toMSecsSinceEpoch ();
+
+      if (!reader.open (partition.path)) continue;
+
+      // Empty partitions, and unsupported types (e.g. waveforms), are skipped.
+      //
+      const bool okay =
+            reader.sampleTime (reader.dataOffset, partition.firstTime) &&
+            reader.sampleTime (reader.lastLineStart (), partition.lastTime);
+
+      const QString pvName = QString::fromStdString (reader.getPvName ());
+      reader.close ();
+      if (!okay) continue;
+
+      this->partitions [pvName].append (partition);
+
+      QHash<QString, FileIndex>::const_iterator it = this->indexCache.constFind (partition.path);
+      if ((it != this->indexCache.constEnd ()) &&
+          (it->size == partition.size) && (it->modified == partition.modified)) {
+         retained.insert (partition.path, it.value ());
+      }
+   }
+
+   this->indexCache.swap (retained);
+
+   // Order each PV's partitions by start time.
+   //
+   QHash<QString, PartitionList>::iterator it;
+   for (it = this->partitions.begin (); it != this->partitions.end (); ++it) {
+      std::sort (it->begin (), it->end (),
+                 [] (const Partition& a, const Partition& b) { return a.firstTime < b.firstTime; });
+   }
+}
+
+//------------------------------------------------------------------------------
+// The index has one entry per indexStride bytes or so, each being the time
+// and offset of the first sample line in the stride.
+//
+const QEArchapplFileInterface::FileIndex*
+QEArchapplFileInterface::getIndex (QEArchapplPartitionReader& reader,
+                                   const Partition& partition)
+{
+   QHash<QString, FileIndex>::iterator it = this->indexCache.find (partition.path);
+   if ((it != this->indexCache.end ()) &&
+       (it->size == partition.size) && (it->modified == partition.modified)) {
+      return &it.value ();
+   }
+
+   FileIndex index;
+   index.size = partition.size;
+   index.modified = partition.modified;
+   index.entries.reserve (int (reader.dataEnd / indexStride) + 1);
+
+   qint64 offset = reader.dataOffset;
+   while (offset < reader.dataEnd) {
+      QCaTimeStamp time;
+      if (reader.sampleTime (offset, time)) {
+         IndexEntry entry;
+         entry.nanoSecs = time.toNanoSecs ();
+         entry.offset = offset;
+         index.entries.append (entry);
+      }
+      offset = reader.lineStartAfter (offset + indexStride);
+   }
+
+   it = this->indexCache.insert (partition.path, index);
+   return &it.value ();
+}
+
+//------------------------------------------------------------------------------
+//
+bool QEArchapplFileInterface::readValues (const QString& pvName,
+                                          const QCaTimeStamp& startTime,
+                                          const QCaTimeStamp& endTime,
+                                          const int count, const How how,
+                                          ResponseValues& item,
+                                          QString& errorText)
+{
+   item.pvName = pvName;
+   item.displayLow = 0.0;
+   item.displayHigh = 0.0;
+   item.precision = 0;
+   item.units = "";
+   item.elementCount = 1;
+   item.dataPoints.clear ();
+   errorText = "";
+
+   if (!this->isScanned) this->scan ();
+
+   const PartitionList list = this->partitions.value (pvName);
+   if (list.isEmpty ()) return false;
+
+   QElapsedTimer timer;
+   timer.start ();
+   qint64 bytesDecoded = 0;
+
+   QEArchapplPartitionCollector collector (startTime, endTime, count, how, this->maxValuesPoints);
+   QEArchapplPartitionReader reader;
+   bool isMetaSet = false;
+
+   // Of the partitions wholly before the start time, only the one with the
+   // latest sample is of interest - for the leading sample.
+   //
+   int before = -1;
+   for (int j = 0; j < list.count (); j++) {
+      const Partition& partition = list.at (j);
+      if (partition.lastTime >= startTime) continue;
+      if ((before < 0) || (partition.lastTime > list.at (before).lastTime)) {
+         before = j;
+      }
+   }
+
+   for (int j = 0; j < list.count (); j++) {
+      const Partition& partition = list.at (j);
+
+      if (partition.firstTime > endTime) break;     // this and all subsequent
+      if ((partition.lastTime < startTime) && (j != before)) continue;
+
+      if (!reader.open (partition.path)) continue;
+      reader.collector = &collector;
+
+      qint64 from;
+      qint64 to;
+      if (j == before) {
+         from = reader.lastLineStart ();
+         to = reader.dataEnd;
+      } else {
+         const FileIndex* index = this->getIndex (reader, partition);
+         const qint64 startNanoSecs = startTime.toNanoSecs ();
+         const qint64 endNanoSecs = endTime.toNanoSecs ();
+
+         // Start from the last entry strictly before the start time, so that
+         // we get the leading sample, and stop at the first entry after the
+         // end time.
+         //
+         QVector<IndexEntry>::const_iterator first =
+               std::lower_bound (index->entries.constBegin (), index->entries.constEnd (), startNanoSecs,
+                                 [] (const IndexEntry& e, const qint64 t) { return e.nanoSecs < t; });
+         from = (first == index->entries.constBegin ()) ? reader.dataOffset : (first - 1)->offset;
+
+         QVector<IndexEntry>::const_iterator last =
+               std::upper_bound (index->entries.constBegin (), index->entries.constEnd (), endNanoSecs,
+                                 [] (const qint64 t, const IndexEntry& e) { return t < e.nanoSecs; });
+         to = (last == index->entries.constEnd ()) ? reader.dataEnd : last->offset;
+      }
+
+      reader.decode (from, to);
+      bytesDecoded += MAX (to - from, qint64 (0));
+
+      if (!isMetaSet) {
+         item.precision = reader.getPrecision ();
+         item.units = QString::fromStdString (reader.getUnits ());
+         item.displayHigh = reader.getDisplayHigh ();
+         item.displayLow = reader.getDisplayLow ();
+         isMetaSet = true;
+      }
+
+      reader.collector = NULL;
+      reader.close ();
+
+      if (collector.isOverflow ()) break;
+   }
+
+   if (collector.isOverflow ()) {
+      errorText = QString ("response exceeds %1 points").arg (this->maxValuesPoints);
+   } else {
+      collector.takeResult (item.dataPoints);
+   }
+
+   QMutexLocker locker (&this->statisticsMutex);
+   this->statistics.bytesReceived += bytesDecoded;
+   this->statistics.decodeNanoSecs += timer.nsecsElapsed ();
+   return errorText.isEmpty ();
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplFileInterface::processNames (const Request& request)
+{
+   PVNameList pvNames;
+
+   if (!QDir (this->rootDirectory).exists ()) {
+      DEBUG << "no such directory" << this->rootDirectory;
+      emit this->pvNamesResponse (request.context.userData, false, pvNames);
+      return;
+   }
+
+   // Always re-scan, e.g. when the user requests a PV name update.
+   //
+   this->scan ();
+
+   const QRegularExpression regExp (request.pattern);
+   if (!regExp.isValid ()) {
+      DEBUG << "invalid pattern" << request.pattern;
+   }
+
+   QHash<QString, PartitionList>::const_iterator it;
+   for (it = this->partitions.constBegin (); it != this->partitions.constEnd (); ++it) {
+      if (regExp.isValid () && !regExp.match (it.key ()).hasMatch ()) continue;
+
+      const PartitionList& list = it.value ();
+      QCaTimeStamp lastTime = list.first ().lastTime;
+      for (int j = 1; j < list.count (); j++) {
+         if (list.at (j).lastTime > lastTime) lastTime = list.at (j).lastTime;
+      }
+
+      struct PVName item;
+      item.pvName = it.key ();
+      item.startTime = QCaDateTime (list.first ().firstTime);
+      item.endTime = QCaDateTime (lastTime);
+      pvNames.append (item);
+   }
+
+   emit this->pvNamesResponse (request.context.userData, true, pvNames);
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplFileInterface::processValues (const Request& request)
+{
+   ResponseValueList pvValues;
+   bool okay = true;
+
+   if (request.isCancelled) {
+      emit this->valuesResponse (request.context.userData, false, pvValues);
+      return;
+   }
+
+   for (int j = 0; j < request.pvNames.count (); j++) {
+      ResponseValues item;
+      QString errorText;
+      if (!this->readValues (request.pvNames.value (j),
+                             request.startTime, request.endTime,
+                             request.count, request.how, item, errorText)) {
+         okay = false;
+         if (errorText.isEmpty ()) continue;
+
+         // As per the Channel Archiver interface, the whole request fails.
+         //
+         DEBUG << "values response:" << item.pvName << errorText;
+         pvValues.clear ();
+         break;
+      }
+      pvValues.push_back (item);
+   }
+
+   {
+      QMutexLocker locker (&this->statisticsMutex);
+      this->statistics.decodeJobs++;
+   }
+
+   emit this->valuesResponse (request.context.userData, okay, pvValues);
+}
+
+//------------------------------------------------------------------------------
+// One item per PV, with at most one point - the last at or before the time.
+//
+void QEArchapplFileInterface::processValuesAtTime (const Request& request)
+{
+   ResponseValueList pvValues;
+
+   for (int j = 0; j < request.pvNames.count (); j++) {
+      ResponseValues item;
+      QString errorText;
+      this->readValues (request.pvNames.value (j),
+                        request.startTime, request.endTime,
+                        1, Raw, item, errorText);
+
+      const int n = item.dataPoints.count ();
+      if (n > 1) {
+         item.dataPoints.removeFirstItems (n - 1);
+      }
+      pvValues.push_back (item);
+   }
+
+   {
+      QMutexLocker locker (&this->statisticsMutex);
+      this->statistics.decodeJobs++;
+   }
+
+   emit this->valuesAtTimeResponse (request.context.userData, true, pvValues);
+}
+
+#else
+
+//------------------------------------------------------------------------------
+// QE framework is being only built for CA Archiver only.
+//
+QEArchapplFileInterface::QEArchapplFileInterface (QUrl, QObject* parent) :
+   QEArchiveInterface (parent) {}
+
+QEArchapplFileInterface::~QEArchapplFileInterface () {}
+
+void QEArchapplFileInterface::setUrl (QUrl url)
+{
+   QEArchiveInterface::setUrl (url);
+}
+
+void QEArchapplFileInterface::namesRequest (QObject*, const int, QString) {}
+
+void QEArchapplFileInterface::valuesRequest (QObject*,
+                    const QCaDateTime,
+                    const QCaDateTime,
+                    const int,
+                    const How,
+                    const QStringList,
+                    const int,
+                    const unsigned int) {}
+
+void QEArchapplFileInterface::cancelValuesRequest (QObject*) {}
+
+void QEArchapplFileInterface::valuesAtTimeRequest (QObject*,
+                    const QCaDateTime,
+                    const QStringList,
+                    const int) {}
+
+void QEArchapplFileInterface::infoRequest (QObject*) {}
+
+void QEArchapplFileInterface::archivesRequest (QObject*) {}
+
+void QEArchapplFileInterface::getStatistics (Statistics& statistics) const
+{
+   QEArchiveInterface::getStatistics (statistics);
+}
+
+void QEArchapplFileInterface::processRequests () {}
+
+#endif
+
+// end
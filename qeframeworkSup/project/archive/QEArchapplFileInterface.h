@@ -0,0 +1,181 @@
+/*  QEArchapplFileInterface.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Starritt
+ *  Contact details:
+ *    andrew.starritt@synchrotron.org.au
+ */
+
+#ifndef QE_ARCHAPPL_FILE_INTERFACE_H
+#define QE_ARCHAPPL_FILE_INTERFACE_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QVector>
+
+#include <QEArchiveInterface.h>
+#include <QCaDataPoint.h>
+#include <QCaDateTime.h>
+#include <QCaTimeStamp.h>
+
+class QEArchapplPartitionReader;    // differed
+
+/// Interface to a local directory of Archiver Appliance storage, i.e. the
+/// protocol buffer (.pb) partition files as written by the appliance (or an
+/// exported copy thereof), as opposed to a live appliance. The directory is
+/// specified as a file URL, e.g. file:///data/archappl/lts, and is searched
+/// recursively, so that the appliance's PV name to path mapping does not
+/// matter - the PV name is taken from each partition file's header.
+///
+/// Partition files are memory-mapped when read. A sparse time index (one
+/// entry per 64 KByte or so) is built for each file on first use, and is
+/// retained while the file remains unchanged, so that a values request only
+/// decodes the samples in and around the requested time range.
+///
+/// Raw and spread sheet requests return all the samples within the requested
+/// time range plus the sample immediately prior, as per the appliance's raw
+/// retrieval, up to QE_ARCHIVE_CA_MAX_POINTS samples per PV beyond which the
+/// request fails. Other requests are binned locally to at most count bins as
+/// the samples are decoded.
+///
+/// Requests are processed one at a time from the event loop, and are not
+/// re-entrant with respect to the caller.
+///
+class QEArchapplFileInterface :
+      public QEArchiveInterface
+{
+   Q_OBJECT
+
+public:
+   explicit QEArchapplFileInterface (QUrl url, QObject* parent = 0);
+   virtual ~QEArchapplFileInterface ();
+
+   void setUrl (QUrl url);
+
+   // Override QEArchiveInterface virtual methods.
+   //
+   void namesRequest (QObject* userData,
+                      const int key,
+                      QString pattern = ".*");
+
+   void valuesRequest (QObject* userData,
+                       const QCaDateTime startTime,
+                       const QCaDateTime endTime,
+                       const int count,
+                       const How how,
+                       const QStringList pvNames,
+                       const int key = 0,
+                       const unsigned int requested_element = 0);
+
+   // Queued requests are responded to without reading any files.
+   //
+   void cancelValuesRequest (QObject* userData);
+
+   void valuesAtTimeRequest (QObject* userData,
+                             const QCaDateTime time,
+                             const QStringList pvNames,
+                             const int key = 0);
+
+   void infoRequest (QObject* userData);
+
+   void archivesRequest (QObject* userData);
+
+   void getStatistics (Statistics& statistics) const;
+
+private:
+   // One partition file.
+   //
+   struct Partition {
+      QString path;
+      qint64 size;
+      qint64 modified;             // mSec since Unix epoch
+      QCaTimeStamp firstTime;
+      QCaTimeStamp lastTime;
+   };
+
+   typedef QList<Partition> PartitionList;   // in time order
+
+   // Sparse time index of a partition file.
+   //
+   struct IndexEntry {
+      qint64 nanoSecs;             // of the sample
+      qint64 offset;               // of the sample line
+   };
+
+   struct FileIndex {
+      qint64 size;
+      qint64 modified;
+      QVector<IndexEntry> entries;
+   };
+
+   struct Request {
+      Context context;
+      QCaTimeStamp startTime;
+      QCaTimeStamp endTime;
+      int count;
+      How how;
+      QStringList pvNames;
+      QString pattern;
+      bool isCancelled;
+   };
+
+   void queueRequest (const Request& request);
+
+   void scan ();
+   const FileIndex* getIndex (QEArchapplPartitionReader& reader,
+                              const Partition& partition);
+
+   // Reads the samples within the time range, plus the sample before, binned
+   // as per how. Returns false if there are no partition files for the PV, or
+   // if a raw request exceeds maxValuesPoints, in which case errorText is set.
+   //
+   bool readValues (const QString& pvName,
+                    const QCaTimeStamp& startTime,
+                    const QCaTimeStamp& endTime,
+                    const int count, const How how,
+                    ResponseValues& item,
+                    QString& errorText);
+
+   void processNames (const Request& request);
+   void processValues (const Request& request);
+   void processValuesAtTime (const Request& request);
+
+   QString rootDirectory;
+   bool isScanned;
+   QHash<QString, PartitionList> partitions;   // keyed by PV name
+   QHash<QString, FileIndex> indexCache;        // keyed by file path
+   QList<Request> requests;
+   bool isProcessScheduled;
+   int maxValuesPoints;        // per PV - from QE_ARCHIVE_CA_MAX_POINTS
+
+   mutable QMutex statisticsMutex;
+   QEArchiveInterface::Statistics statistics;
+
+private slots:
+   void processRequests ();
+};
+
+#endif // QE_ARCHAPPL_FILE_INTERFACE_H
@@ -36,11 +36,15 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <QECommon.h>
+#include <QEAdaptationParameters.h>
 #include <QEArchiveManager.h>
 
 // Enable Archiver Appliance support
 //
 #ifdef QE_ARCHAPPL_SUPPORT
+   #include <QElapsedTimer>
+   #include <QJsonArray>
    #include <QJsonDocument>
    #include <QJsonObject>
    #include <QUrlQuery>
@@ -64,6 +68,7 @@ static bool setupMaps () {
    requestMethodToURL.insert (QEArchiveInterface::Information, QString("getApplianceInfo"));
    requestMethodToURL.insert (QEArchiveInterface::Names,       QString("getTimeSpanReport"));
    requestMethodToURL.insert (QEArchiveInterface::Values,      QString("data/getData.raw"));
+   requestMethodToURL.insert (QEArchiveInterface::ValuesAtTime, QString("data/getDataAtTime"));
 
    howToPostPP.insert (QEArchiveInterface::Raw,         QString(""));
    howToPostPP.insert (QEArchiveInterface::SpreadSheet, QString(""));
@@ -76,6 +81,219 @@ static bool setupMaps () {
 
 static const bool elaborateMaps = setupMaps ();
 
+// The getDataAtTime retrieval method accepts a list of PV names. We limit
+// the number per request so as to keep the individual requests/responses
+// to a reasonable size.
+//
+static const int maxNamesPerAtTimeRequest = 500;
+
+
+//==============================================================================
+// QEArchapplValuesAtTimeBatch
+//==============================================================================
+// Used as the user data for each getDataAtTime request. This gathers the
+// responses to the sub-requests so that a single valuesAtTimeResponse
+// may be emitted, in the same order as the requested PV names.
+//
+class QEArchapplValuesAtTimeBatch : public QObject {
+public:
+   explicit QEArchapplValuesAtTimeBatch (QObject* userDataIn,
+                                         const QStringList& pvNamesIn) :
+      QObject (NULL),
+      userData (userDataIn),
+      pvNames (pvNamesIn),
+      outstanding (0),
+      isAnySuccess (false) {}
+   ~QEArchapplValuesAtTimeBatch () {}
+
+   QObject* userData;
+   const QStringList pvNames;
+   int outstanding;
+   bool isAnySuccess;
+   QHash<QString, QCaDataPoint> values;
+};
+
+
+//==============================================================================
+// QEArchapplValuesDecoder
+//==============================================================================
+// Decodes the Archiver Appliance protocol buffer data as it arrives and
+// appends each sample directly to the data point list.
+//
+// Data is appended by the network manager's thread, and decoded by a decode
+// pool thread. At most one decode job per decoder is scheduled at any time,
+// so the data is always decoded in order. Once finished, and all data has
+// been decoded, the decoder invokes the network manager's decodeComplete slot.
+//
+class QEArchapplValuesDecoder : public ArchapplData::StreamDecoder {
+public:
+   explicit QEArchapplValuesDecoder (QEArchapplNetworkManager* ownerIn,
+                                     QThreadPool* poolIn,
+                                     const int idIn) :
+      id (idIn),
+      bytesReceived (0), decodeNanoSecs (0), queueNanoSecs (0),
+      owner (ownerIn), pool (poolIn),
+      isScheduled (false), isFinished (false), isAbandoned (false) {}
+   ~QEArchapplValuesDecoder () {}
+
+   // Decodes the data immediately, within the calling thread.
+   //
+   void decode (const char* data, const qint64 size)
+   {
+      this->bytesReceived += size;
+      this->processData (data, size_t (size));
+   }
+
+   // Called from the network manager's thread.
+   //
+   void append (const QByteArray& data);
+   void finish (const bool abandon);
+
+   // Called from a decode pool thread.
+   //
+   void run ();
+
+   const int id;
+
+   // These must only be read once decodeComplete has been invoked.
+   //
+   qint64 bytesReceived;
+   qint64 decodeNanoSecs;
+   qint64 queueNanoSecs;
+   QCaDataPointList dataPoints;
+
+protected:
+   void processSample (const ArchapplData::PBData& onePointData);
+
+private:
+   void schedule ();       // mutex must be held
+
+   QEArchapplNetworkManager* owner;
+   QThreadPool* pool;
+
+   QMutex mutex;
+   QByteArray pending;     // appended, but not yet decoded
+   QElapsedTimer queueTimer;
+   bool isScheduled;
+   bool isFinished;
+   bool isAbandoned;
+};
+
+//------------------------------------------------------------------------------
+// Decode jobs are owned, and deleted, by the thread pool.
+//
+class QEArchapplDecodeJob : public QRunnable {
+public:
+   explicit QEArchapplDecodeJob (QEArchapplValuesDecoder* decoderIn) :
+      decoder (decoderIn) {}
+   ~QEArchapplDecodeJob () {}
+
+   void run () { this->decoder->run (); }
+
+private:
+   QEArchapplValuesDecoder* decoder;
+};
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplValuesDecoder::schedule ()
+{
+   if (this->isScheduled) return;
+   this->isScheduled = true;
+   this->queueTimer.start ();
+   this->pool->start (new QEArchapplDecodeJob (this));
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplValuesDecoder::append (const QByteArray& data)
+{
+   if (data.isEmpty ()) return;
+   this->bytesReceived += data.size ();
+
+   QMutexLocker locker (&this->mutex);
+   this->pending.append (data);
+   this->schedule ();
+}
+
+//------------------------------------------------------------------------------
+// When abandoned, e.g. on a network error, any remaining data is discarded.
+//
+void QEArchapplValuesDecoder::finish (const bool abandon)
+{
+   QMutexLocker locker (&this->mutex);
+   this->isFinished = true;
+   this->isAbandoned = abandon;
+   this->schedule ();
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplValuesDecoder::run ()
+{
+   {
+      QMutexLocker locker (&this->mutex);
+      this->queueNanoSecs += this->queueTimer.nsecsElapsed ();
+   }
+
+   while (true) {
+      QByteArray data;
+      bool isComplete = false;
+      bool isDiscard = false;
+      {
+         QMutexLocker locker (&this->mutex);
+         data.swap (this->pending);
+         isDiscard = this->isAbandoned;
+         if (data.isEmpty ()) {
+            this->isScheduled = false;
+            isComplete = this->isFinished;
+         }
+      }
+
+      if (data.isEmpty ()) {
+         // Once complete, the network manager may delete this decoder at any
+         // time, so use copies of owner and id.
+         //
+         if (isComplete) {
+            QEArchapplNetworkManager* target = this->owner;
+            const int decoderId = this->id;
+            QMetaObject::invokeMethod (target, "decodeComplete", Qt::QueuedConnection,
+                                       Q_ARG (int, decoderId));
+         }
+         return;
+      }
+
+      if (!isDiscard) {
+         QElapsedTimer timer;
+         timer.start ();
+         this->processData (data.constData (), size_t (data.size ()));
+         this->decodeNanoSecs += timer.nsecsElapsed ();
+      }
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplValuesDecoder::processSample (const ArchapplData::PBData& onePointData)
+{
+   // To save space, the record processing timestamps in the samples are split into three parts
+   // 1. year - This is stored once in the PB file in the header.
+   // 2. secondsintoyear - This is stored with each sample.
+   // 3. nano - This is stored with each sample.
+   //
+   // The decoder combines all three into one timestamp using integer arithmetic,
+   // retaining full nano second resolution. Any conversion to local time is
+   // deferred until the time is actually displayed.
+   //
+   // Create a data point structure used by other clients
+   //
+   QCaDataPoint dataPoint;
+   dataPoint.value = onePointData.value;
+   dataPoint.alarm = QCaAlarmInfo(onePointData.status, onePointData.severity);
+   dataPoint.datetime = QCaTimeStamp::fromNanoSecs (this->getSampleEpicsNanoSecs (onePointData));
+   this->dataPoints.append(dataPoint);
+}
+
 
 //==============================================================================
 // QEArchapplNetworkManager
@@ -86,10 +304,30 @@ QEArchapplNetworkManager::QEArchapplNetworkManager(const QUrl& bplURL, QObject*
 {
    this->bplURL = bplURL;
    networkManager = new QNetworkAccessManager(this);
+
+   QEAdaptationParameters ap ("QE_");
+   const int defaultThreads = LIMIT (QThread::idealThreadCount() / 2, 1, 4);
+
+   this->decodePool = new QThreadPool(this);
+   this->decodePool->setMaxThreadCount(MAX (ap.getInt ("archive_decode_threads", defaultThreads), 1));
+   this->nextDecoderId = 0;
+
+   this->statistics.bytesReceived = 0;
+   this->statistics.decodeJobs = 0;
+   this->statistics.decodeNanoSecs = 0;
+   this->statistics.queueNanoSecs = 0;
 }
 
 QEArchapplNetworkManager::~QEArchapplNetworkManager()
 {
+   // Ensure no decode job is still referencing any decoder.
+   //
+   this->decodePool->clear();
+   this->decodePool->waitForDone();
+
+   qDeleteAll(this->decoders);
+   this->decoders.clear();
+   this->decodingReplies.clear();
    delete networkManager;
 }
 
@@ -177,14 +415,75 @@ void QEArchapplNetworkManager::getValues(const QEArchiveInterface::Context& cont
    }
 }
 
+bool QEArchapplNetworkManager::getValuesAtTime(const QEArchiveInterface::Context& context,
+                                               const QString& atTime,
+                                               const QStringList& names)
+{
+   URLMap::const_iterator it = requestMethodToURL.find(context.method);
+   if (it == requestMethodToURL.end()) return false;
+
+   // As per getValues, we need the data retrieval URL.
+   //
+   if (this->dataURL.isEmpty()) {
+      return false;
+   }
+   QUrl url = this->dataURL.resolved(it.value());
+
+   QUrlQuery query;
+   query.addQueryItem("at", atTime);
+   query.addQueryItem("includeProxies", "true");
+   url.setQuery(query);
+
+   // The PV names are posted as a JSON array.
+   //
+   const QJsonArray jsonNames = QJsonArray::fromStringList(names);
+   const QByteArray postData = QJsonDocument(jsonNames).toJson(QJsonDocument::Compact);
+
+   executeRequest(url, context, postData);
+   return true;
+}
+
+void QEArchapplNetworkManager::cancelValues(const QObject* userData)
+{
+   // Once finished, a reply's data is already being decoded by the decode pool,
+   // so we just let that complete.
+   //
+   const QList<QNetworkReply*> replies = this->decoders.keys();
+   for (int j = 0; j < replies.count(); j++) {
+      QNetworkReply* reply = replies.at(j);
+      if (reply->isFinished()) continue;
+
+      QVariant property = reply->property("context");
+      QEArchiveInterface::Context context = qvariant_cast<QEArchiveInterface::Context>(property);
+      if (context.userData == userData) {
+         // The reply emits finished, and hence a fault, as per any other error.
+         //
+         reply->abort();
+      }
+   }
+}
+
 void QEArchapplNetworkManager::executeRequest(const QUrl url,
-                                              const QEArchiveInterface::Context& context)
+                                              const QEArchiveInterface::Context& context,
+                                              const QByteArray& postData)
 {
    // Set URL of the request and request the data
    //
    QNetworkRequest request;
    request.setUrl(url);
-   QNetworkReply* reply = this->networkManager->get(request);
+
+   // QNetworkAccessManager re-uses persistent connections (up to 6 per host),
+   // but be explicit as some proxies default to closing the connection.
+   //
+   request.setRawHeader("Connection", "keep-alive");
+
+   QNetworkReply* reply;
+   if (postData.isEmpty()) {
+      reply = this->networkManager->get(request);
+   } else {
+      request.setHeader(QNetworkRequest::ContentTypeHeader, QString("application/json"));
+      reply = this->networkManager->post(request, postData);
+   }
 
    // Set the context as a part of reply so that the slot catching finished() signal
    // knows how to handle the response
@@ -194,31 +493,102 @@ void QEArchapplNetworkManager::executeRequest(const QUrl url,
    reply->setProperty("context", variant);
 
    // Do the plumbing
+   // Values are decoded on the fly as the data arrives.
    //
+   if (context.method == QEArchiveInterface::Values) {
+      this->nextDecoderId++;
+      this->decoders.insert(reply, new QEArchapplValuesDecoder(this, this->decodePool,
+                                                               this->nextDecoderId));
+      QObject::connect (reply, SIGNAL(readyRead()), this, SLOT(replyReadyRead()));
+   }
    QObject::connect (reply, SIGNAL(finished()), this, SLOT(replyFinished()));
 }
 
+void QEArchapplNetworkManager::replyReadyRead()
+{
+   QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+   if (reply) {
+      this->decodeAvailable(reply);
+   }
+}
+
+void QEArchapplNetworkManager::decodeAvailable(QNetworkReply* reply)
+{
+   // Just pass the data on - the decoding itself happens in the decode pool.
+   //
+   QEArchapplValuesDecoder* decoder = this->decoders.value(reply, NULL);
+   if (!decoder) return;
+
+   decoder->append(reply->readAll());
+}
+
+QEArchapplValuesDecoder* QEArchapplNetworkManager::takeDecoder(QNetworkReply* reply)
+{
+   return this->decoders.take(reply);
+}
+
 void QEArchapplNetworkManager::replyFinished()
 {
    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+   if (!reply) return;
 
-   if (reply) {
-      QVariant property = reply->property("context");
-      QEArchiveInterface::Context context = qvariant_cast<QEArchiveInterface::Context>(property);
-      if (reply->error() == QNetworkReply::NoError) {
-         emit this->networkManagerResponse(context, reply);
-      } else {
-         emit this->networkManagerFault(context, reply->error());
+   // For values replies, we must wait for the decode to complete.
+   //
+   QEArchapplValuesDecoder* decoder = this->decoders.value(reply, NULL);
+   if (decoder) {
+      const bool isOkay = (reply->error() == QNetworkReply::NoError);
+      if (isOkay) {
+         this->decodeAvailable(reply);   // any residual values data
       }
+      this->decodingReplies.insert(decoder->id, reply);
+      decoder->finish(!isOkay);
+      return;
+   }
+
+   QMutexLocker locker (&this->statisticsMutex);
+   this->statistics.bytesReceived += reply->bytesAvailable();
+   locker.unlock();
+
+   this->processReply(reply);
+}
+
+void QEArchapplNetworkManager::decodeComplete(const int decoderId)
+{
+   QNetworkReply* reply = this->decodingReplies.take(decoderId);
+   if (!reply) return;
+
+   QEArchapplValuesDecoder* decoder = this->decoders.value(reply, NULL);
+   if (decoder) {
+      QMutexLocker locker (&this->statisticsMutex);
+      this->statistics.bytesReceived += decoder->bytesReceived;
+      this->statistics.decodeJobs++;
+      this->statistics.decodeNanoSecs += decoder->decodeNanoSecs;
+      this->statistics.queueNanoSecs += decoder->queueNanoSecs;
+   }
+
+   this->processReply(reply);
+}
+
+void QEArchapplNetworkManager::processReply(QNetworkReply* reply)
+{
+   QVariant property = reply->property("context");
+   QEArchiveInterface::Context context = qvariant_cast<QEArchiveInterface::Context>(property);
+   if (reply->error() == QNetworkReply::NoError) {
+      emit this->networkManagerResponse(context, reply);
+   } else {
+      emit this->networkManagerFault(context, reply->error());
    }
 
+   // Normally taken by processValues, but not on error.
+   //
+   delete this->takeDecoder(reply);
+
    // We don't delete the reply straight away but we give it time to be read
    // by the slot processing the data and schedule it for deletion
    //
    reply->deleteLater();
 }
 
-
 //==============================================================================
 // QEArchapplInterface
 //==============================================================================
@@ -316,6 +686,53 @@ void QEArchapplInterface::valuesRequest (QObject* userData,
    }
 }
 
+//------------------------------------------------------------------------------
+//
+void QEArchapplInterface::cancelValuesRequest (QObject* userData)
+{
+   if (this->networkManager != 0)
+   {
+      this->networkManager->cancelValues(userData);
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplInterface::valuesAtTimeRequest (QObject* userData,
+                                               const QCaDateTime time,
+                                               const QStringList pvNames,
+                                               const int /* key */)
+{
+   QEArchapplValuesAtTimeBatch* batch = new QEArchapplValuesAtTimeBatch (userData, pvNames);
+
+   Context context;
+   context.method = ValuesAtTime;
+   context.userData = batch;
+   context.requested_element = 0;
+
+   const QString atTime = time.ISOText();
+   const int number = pvNames.count ();
+
+   // Count the sub-requests first, as any one sub-request may fail immediately.
+   //
+   batch->outstanding = (number + maxNamesPerAtTimeRequest - 1) / maxNamesPerAtTimeRequest;
+   if (batch->outstanding == 0) {
+      batch->outstanding = 1;
+      this->valuesAtTimeBatchDone (batch, true);
+      return;
+   }
+
+   for (int j = 0; j < number; j += maxNamesPerAtTimeRequest) {
+      const QStringList names = pvNames.mid (j, maxNamesPerAtTimeRequest);
+
+      const bool status = (this->networkManager != 0) &&
+                          this->networkManager->getValuesAtTime(context, atTime, names);
+      if (!status) {
+         this->valuesAtTimeBatchDone (batch, false);
+      }
+   }
+}
+
 //------------------------------------------------------------------------------
 //
 void QEArchapplInterface::infoRequest (QObject* userData)
@@ -334,6 +751,14 @@ void QEArchapplInterface::infoRequest (QObject* userData)
    }
 }
 
+//------------------------------------------------------------------------------
+//
+void QEArchapplInterface::getStatistics (Statistics& statistics) const
+{
+   QMutexLocker locker (&this->networkManager->statisticsMutex);
+   statistics = this->networkManager->statistics;
+}
+
 //------------------------------------------------------------------------------
 //
 void QEArchapplInterface::archivesRequest (QObject* userData)
@@ -364,6 +789,10 @@ void QEArchapplInterface::networkManagerResponse(const QEArchiveInterface::Conte
       this->processValues (context.userData, reply, context.requested_element);
       break;
 
+   case ValuesAtTime:
+      this->processValuesAtTime (context.userData, reply);
+      break;
+
    default:
       DEBUG << "unexpected method: " << context.method;
       break;
@@ -392,6 +821,12 @@ void QEArchapplInterface::networkManagerFault(const QEArchiveInterface::Context
       emit this->valuesResponse (context.userData, false, nullPvValues);
       break;
 
+   case ValuesAtTime:
+      // We always use a batch object as the user data for this method.
+      //
+      this->valuesAtTimeBatchDone ((QEArchapplValuesAtTimeBatch*) context.userData, false);
+      break;
+
    default:
       DEBUG << "unexpected method: " << context.method << error;
       break;
@@ -506,69 +941,126 @@ void QEArchapplInterface::processArchives (const QObject* userData)
 void QEArchapplInterface::processValues(const QObject* userData, QNetworkReply* reply,
                                         const unsigned int /* requested_element */)
 {
-   QByteArray arrayData = reply->readAll();
+   // The data has been decoded as it arrived.
+   //
+   QEArchapplValuesDecoder* decoder = this->networkManager->takeDecoder(reply);
+   if (!decoder) {
+      // Belts 'n' braces - decode the whole reply now.
+      //
+      decoder = new QEArchapplValuesDecoder(NULL, NULL, 0);
+      const QByteArray arrayData = reply->readAll();
+      decoder->decode(arrayData.constData(), arrayData.size());
+   }
 
-   if (arrayData.isNull()) {
+   if (decoder->bytesReceived == 0) {
       DEBUG << "response empty";
+      delete decoder;
       return;
    }
 
-   std::vector<char> charData;
-   charData.assign(arrayData.data(), arrayData.data() + arrayData.size());
+   ResponseValueList PvValues;
+   ResponseValues responseValues;
 
-   std::vector<ArchapplData::PBData> pvData;
-   int precision;
-   std::string pvName;
-   std::string units;
-   double displayHigh;
-   double displayLow;
-   ArchapplData::processProtoBuffers(&charData, precision, pvName, units, displayHigh, displayLow, pvData);
+   responseValues.dataPoints = decoder->dataPoints;
+   responseValues.precision = decoder->getPrecision();
+   responseValues.pvName = QString::fromStdString(decoder->getPvName());
+   responseValues.units = QString::fromStdString(decoder->getUnits());
+   responseValues.displayHigh = decoder->getDisplayHigh();
+   responseValues.displayLow = decoder->getDisplayLow();
+   responseValues.elementCount = responseValues.dataPoints.count();
 
-   ResponseValueList PvValues;
-   QCaDataPointList dataPointList;
+   delete decoder;
 
-   std::vector<ArchapplData::PBData>::iterator it = pvData.begin();
-   while (it != pvData.end()) {
-      ArchapplData::PBData onePointData = *it;
+   PvValues.push_back(responseValues);
 
-      // To save space, the record processing timestamps in the samples are split into three parts
-      // 1. year - This is stored once in the PB file in the header.
-      // 2. secondsintoyear - This is stored with each sample.
-      // 3. nano - This is stored with each sample.
-      //
-      // Here we combine all three into one timestamp and covert to local time
-      //
-      QTime zeroTime (0, 0, 0);
-      QDateTime pointDateTime(QDate(onePointData.year, 1, 1), zeroTime);
-      pointDateTime.setTimeSpec(Qt::UTC);
-      pointDateTime = pointDateTime.addSecs(onePointData.seconds);
-      pointDateTime = pointDateTime.addMSecs((int)(onePointData.nanos/1000000));
-      pointDateTime = pointDateTime.toLocalTime();
-      QCaDateTime caDateTime(pointDateTime);
-
-      // Create a data point structure used by other clients
+   emit this->valuesResponse (userData, true, PvValues);
+}
+
+//------------------------------------------------------------------------------
+// The response is a JSON object keyed by PV name, each value being an object
+// comprising secs, nanos, val, severity and status. PVs for which there is no
+// data are omitted.
+//
+void QEArchapplInterface::processValuesAtTime (const QObject* userData, QNetworkReply* reply)
+{
+   QEArchapplValuesAtTimeBatch* batch = (QEArchapplValuesAtTimeBatch*) userData;
+
+   QByteArray arrayData = reply->readAll();
+   QJsonDocument jsonDocument = QJsonDocument::fromJson(arrayData);
+   if (jsonDocument.isNull()) {
+      DEBUG << "data received is not JSON encoded";
+      this->valuesAtTimeBatchDone (batch, false);
+      return;
+   }
+
+   const QJsonObject jsonObject = jsonDocument.object();
+   QJsonObject::const_iterator dataIterator;
+
+   for (dataIterator = jsonObject.begin(); dataIterator != jsonObject.end(); ++dataIterator) {
+      const QJsonObject onePVData = dataIterator.value().toObject();
+
+      // Only numeric (and enum) values are of interest. For arrays, we take the
+      // first element as per the valuesRequest default requested element.
       //
-      QCaDataPoint dataPoint;
-      dataPoint.value = onePointData.value;
-      dataPoint.alarm = QCaAlarmInfo(onePointData.status, onePointData.severity);
-      dataPoint.datetime = caDateTime;
-      dataPointList.append(dataPoint);
+      QJsonValue val = onePVData.value("val");
+      if (val.isArray()) {
+         const QJsonArray array = val.toArray();
+         if (array.isEmpty()) continue;
+         val = array.first();
+      }
+
+      QCaDataPoint point;
+      if (val.isDouble()) {
+         point.value = val.toDouble();
+      } else if (val.isBool()) {
+         point.value = val.toBool() ? 1.0 : 0.0;
+      } else {
+         continue;
+      }
+
+      const int seconds = (int) onePVData.value("secs").toDouble();
+      const int nanoSecs = (int) onePVData.value("nanos").toDouble();
+      point.datetime = this->convertArchiveToTimeStamp (seconds, nanoSecs);
+      point.alarm = QCaAlarmInfo (onePVData.value("status").toInt(),
+                                  onePVData.value("severity").toInt());
 
-      it++;
+      batch->values.insert (dataIterator.key(), point);
    }
 
-   ResponseValues responseValues;
-   responseValues.dataPoints = dataPointList;
-   responseValues.precision = precision;
-   responseValues.pvName = QString::fromStdString(pvName);
-   responseValues.units = QString::fromStdString(units);
-   responseValues.displayHigh = displayHigh;
-   responseValues.displayLow = displayLow;
-   responseValues.elementCount = dataPointList.count();
+   this->valuesAtTimeBatchDone (batch, true);
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchapplInterface::valuesAtTimeBatchDone (QEArchapplValuesAtTimeBatch* batch,
+                                                 const bool isSuccess)
+{
+   if (!batch) return;
 
-   PvValues.push_back(responseValues);   
+   if (isSuccess) batch->isAnySuccess = true;
+   batch->outstanding--;
+   if (batch->outstanding > 0) return;    // still waiting for other responses
 
-   emit this->valuesResponse (userData, true, PvValues);
+   ResponseValueList PvValues;
+
+   for (int j = 0; j < batch->pvNames.count (); j++) {
+      ResponseValues responseValues;
+
+      responseValues.pvName = batch->pvNames.value (j);
+      responseValues.displayLow = 0.0;
+      responseValues.displayHigh = 0.0;
+      responseValues.precision = 0;
+      responseValues.elementCount = 1;
+
+      if (batch->values.contains (responseValues.pvName)) {
+         responseValues.dataPoints.append (batch->values.value (responseValues.pvName));
+      }
+
+      PvValues.append (responseValues);
+   }
+
+   emit this->valuesAtTimeResponse (batch->userData, batch->isAnySuccess, PvValues);
+   delete batch;
 }
 
 #else
@@ -584,12 +1076,26 @@ void QEArchapplNetworkManager::getPVs(const QEArchiveInterface::Context&, const
 
 void QEArchapplNetworkManager::getApplianceInfo(const QEArchiveInterface::Context&) {}
 
-void QEArchapplNetworkManager::executeRequest(const QUrl, const QEArchiveInterface::Context&) {}
+void QEArchapplNetworkManager::executeRequest(const QUrl, const QEArchiveInterface::Context&, const QByteArray&) {}
 
 void QEArchapplNetworkManager::getValues(const QEArchiveInterface::Context&, const ValuesRequest&, const unsigned int) {}
 
+bool QEArchapplNetworkManager::getValuesAtTime(const QEArchiveInterface::Context&, const QString&, const QStringList&) { return false; }
+
+void QEArchapplNetworkManager::cancelValues(const QObject*) {}
+
 void QEArchapplNetworkManager::replyFinished() {}
 
+void QEArchapplNetworkManager::replyReadyRead() {}
+
+void QEArchapplNetworkManager::decodeComplete(const int) {}
+
+void QEArchapplNetworkManager::processReply(QNetworkReply*) {}
+
+void QEArchapplNetworkManager::decodeAvailable(QNetworkReply*) {}
+
+QEArchapplValuesDecoder* QEArchapplNetworkManager::takeDecoder(QNetworkReply*) { return NULL; }
+
 QEArchapplInterface::QEArchapplInterface (QUrl, QObject*) {}
 
 QEArchapplInterface::~QEArchapplInterface () {}
@@ -605,10 +1111,22 @@ void QEArchapplInterface::valuesRequest (QObject*,
                     const int,
                     const unsigned int) {}
 
+void QEArchapplInterface::cancelValuesRequest (QObject*) {}
+
+void QEArchapplInterface::valuesAtTimeRequest (QObject*,
+                    const QCaDateTime,
+                    const QStringList,
+                    const int) {}
+
 void QEArchapplInterface::infoRequest (QObject*) {}
 
 void QEArchapplInterface::archivesRequest (QObject*) {}
 
+void QEArchapplInterface::getStatistics (Statistics& statistics) const
+{
+   QEArchiveInterface::getStatistics (statistics);
+}
+
 void QEArchapplInterface::networkManagerResponse (const QEArchiveInterface::Context &,
                                                   QNetworkReply*) {}
 
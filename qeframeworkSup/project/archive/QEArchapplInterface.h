@@ -32,7 +32,11 @@
 #include <QDateTime>
 #include <QVector>
 #include <QList>
+#include <QHash>
+#include <QByteArray>
+#include <QMutex>
 #include <QStringList>
+#include <QThreadPool>
 #include <QUrl>
 #include <QNetworkRequest>
 #include <QNetworkReply>
@@ -43,7 +47,9 @@
 #include <QCaDateTime.h>
 #include <QCaAlarmInfo.h>
 
-class QEArchapplNetworkManager;  // differed
+class QEArchapplNetworkManager;     // differed
+class QEArchapplValuesDecoder;      // differed
+class QEArchapplValuesAtTimeBatch;  // differed
 
 /// Interface to EPICS Archiver Appliance.
 ///
@@ -72,10 +78,23 @@ public:
                        const int key = 0,
                        const unsigned int requested_element = 0);
 
+   // Aborts the request's network replies, if still in progress.
+   //
+   void cancelValuesRequest (QObject* userData);
+
+   // Uses the getDataAtTime retrieval method, which accepts many PVs per request.
+   //
+   void valuesAtTimeRequest (QObject* userData,
+                             const QCaDateTime time,
+                             const QStringList pvNames,
+                             const int key = 0);
+
    void infoRequest (QObject* userData);
 
    void archivesRequest (QObject* userData);
 
+   void getStatistics (Statistics& statistics) const;
+
 public slots:
    // Triggered by signals coming from network manager
    //
@@ -92,6 +111,8 @@ private:
    void processPvNames  (const QObject* userData, QNetworkReply* reply);
    void processValues   (const QObject* userData, QNetworkReply* reply,
                          const unsigned int requested_element);
+   void processValuesAtTime (const QObject* userData, QNetworkReply* reply);
+   void valuesAtTimeBatchDone (QEArchapplValuesAtTimeBatch* batch, const bool isSuccess);
 };
 
 
@@ -130,8 +151,33 @@ private:
 
    void getPVs(const QEArchiveInterface::Context& context, const QString& pattern);
    void getApplianceInfo(const QEArchiveInterface::Context& context);
-   void executeRequest(const QUrl url, const QEArchiveInterface::Context& context);
+   void executeRequest(const QUrl url, const QEArchiveInterface::Context& context,
+                       const QByteArray& postData = QByteArray());
    void getValues(const QEArchiveInterface::Context& context, const ValuesRequest& request, const unsigned int binSize);
+   bool getValuesAtTime(const QEArchiveInterface::Context& context, const QString& atTime, const QStringList& names);
+
+   // Aborts any values replies, still in progress, with the given user data.
+   //
+   void cancelValues(const QObject* userData);
+
+   // Values responses are decoded as the data arrives, as opposed to all at
+   // once when the reply is finished. One decoder per outstanding reply.
+   // The decoding itself is done by the decode pool, so that neither this
+   // thread nor other replies are held up by a large response, and replies
+   // are decoded in parallel. The number of decode threads per archiver is
+   // set by the QE_ARCHIVE_DECODE_THREADS adaptation parameter.
+   //
+   QHash<QNetworkReply*, QEArchapplValuesDecoder*> decoders;
+   QHash<int, QNetworkReply*> decodingReplies;   // finished, keyed by decoder id
+   QThreadPool* decodePool;
+   int nextDecoderId;
+
+   mutable QMutex statisticsMutex;
+   QEArchiveInterface::Statistics statistics;
+
+   void decodeAvailable(QNetworkReply* reply);
+   QEArchapplValuesDecoder* takeDecoder(QNetworkReply* reply);
+   void processReply(QNetworkReply* reply);
 
 signals:
    // Signals that a response from the Archiver Appliance is ready. The type of reponse
@@ -149,6 +195,15 @@ private slots:
    //
    void replyFinished();
 
+   // Triggered from network manager when more (values) data is available
+   //
+   void replyReadyRead();
+
+   // Invoked (queued) from the decode pool once a values reply has been
+   // fully decoded.
+   //
+   void decodeComplete(const int decoderId);
+
    // We are very popular
    //
    friend class QEArchapplInterface;
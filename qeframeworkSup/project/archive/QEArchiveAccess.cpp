@@ -82,12 +82,25 @@ QEArchiveAccess::QEArchiveAccess (QObject * parent) : QObject (parent)
                      archiveManager, SLOT   (readArchiveRequest  (const QEArchiveAccess*,
                                                                   const QEArchiveAccess::PVDataRequests&)));
 
+   QObject::connect (this,           SIGNAL (cancelReadArchiveRequest  (const QEArchiveAccess*,
+                                                                        const QEArchiveAccess::PVDataRequests&)),
+                     archiveManager, SLOT   (cancelReadArchiveRequest  (const QEArchiveAccess*,
+                                                                        const QEArchiveAccess::PVDataRequests&)));
+
+   QObject::connect (this,           SIGNAL (readArchiveAtTimeRequest  (const QEArchiveAccess*,
+                                                                        const QEArchiveAccess::PVValuesAtTimeRequests&)),
+                     archiveManager, SLOT   (readArchiveAtTimeRequest  (const QEArchiveAccess*,
+                                                                        const QEArchiveAccess::PVValuesAtTimeRequests&)));
+
    // We send the archive data response to ourself, invoked by the archiveManager
    // calling the archiveResponse function. In this way, the response is only
    // sent to the acrive access object that requested it.
    //
    QObject::connect (this, SIGNAL (signalArchiveResponse (const QEArchiveAccess::PVDataResponses&)),
                      this, SLOT   (actionArchiveResponse (const QEArchiveAccess::PVDataResponses&)));
+
+   QObject::connect (this, SIGNAL (signalArchiveValuesAtTimeResponse (const QEArchiveAccess::PVValuesAtTimeResponses&)),
+                     this, SLOT   (actionArchiveValuesAtTimeResponse (const QEArchiveAccess::PVValuesAtTimeResponses&)));
 }
 
 //------------------------------------------------------------------------------
@@ -176,6 +189,38 @@ void QEArchiveAccess::readArchive (QObject* userData,
    emit this->readArchiveRequest (this, request);
 }
 
+//------------------------------------------------------------------------------
+// Only the userData is relevant.
+//
+void QEArchiveAccess::cancelReadArchive (QObject* userData)
+{
+   QEArchiveAccess::PVDataRequests request;
+
+   request.userData = userData;
+   request.metaRequest = mrNone;
+   request.key = 0;
+   request.count = 0;
+   request.how = QEArchiveInterface::Raw;
+   request.element = 0;
+
+   emit this->cancelReadArchiveRequest (this, request);
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveAccess::readArchiveAtTime (QObject* userData,
+                                         const QStringList& pvNames,
+                                         const QCaDateTime& dateTime)
+{
+   QEArchiveAccess::PVValuesAtTimeRequests request;
+
+   request.userData = userData;
+   request.dateTime = dateTime;
+   request.pvNames = pvNames;
+
+   emit this->readArchiveAtTimeRequest (this, request);
+}
+
 //------------------------------------------------------------------------------
 // Called by the QEArchiverManager in the QEArchiverManager's thread
 // Sent to actionArchiveResponse slot processed in QEArchiveAccess's thread.
@@ -196,6 +241,22 @@ void QEArchiveAccess::actionArchiveResponse (const QEArchiveAccess::PVDataRespon
                               response.supplementary);
 }
 
+//------------------------------------------------------------------------------
+// Called by the QEArchiverManager in the QEArchiverManager's thread
+// Sent to actionArchiveValuesAtTimeResponse slot processed in QEArchiveAccess's thread.
+//
+void QEArchiveAccess::archiveValuesAtTimeResponse (const QEArchiveAccess::PVValuesAtTimeResponses& response) const
+{
+    emit this->signalArchiveValuesAtTimeResponse (response);
+}
+
+//------------------------------------------------------------------------------
+// slot
+void QEArchiveAccess::actionArchiveValuesAtTimeResponse (const QEArchiveAccess::PVValuesAtTimeResponses& response)
+{
+   emit this->setArchiveValuesAtTime (response.userData, response.values);
+}
+
 //------------------------------------------------------------------------------
 // static functions
 //------------------------------------------------------------------------------
@@ -240,6 +301,24 @@ QStringList QEArchiveAccess::getAllPvNames ()
    return  result;
 }
 
+//------------------------------------------------------------------------------
+//
+QSharedPointer<const QEPvNameSearch> QEArchiveAccess::getPvNameSearch ()
+{
+   QSharedPointer<const QEPvNameSearch> result;
+
+   if (archiveManager) {
+      result = archiveManager->getPvNameSearch ();
+   }
+
+   if (result.isNull ()) {
+      result = QSharedPointer<const QEPvNameSearch> (
+                  new QEPvNameSearch (QEArchiveAccess::getAllPvNames ()));
+   }
+
+   return result;
+}
+
 //------------------------------------------------------------------------------
 //
 bool QEArchiveAccess::getArchivePvInformation (const QString& pvName,
@@ -266,6 +345,9 @@ bool QEArchiveAccess::_registerMetaTypes()
    qRegisterMetaType<QEArchiveAccess::StatusList> ("QEArchiveAccess::StatusList");
    qRegisterMetaType<QEArchiveAccess::PVDataRequests> ("QEArchiveAccess::PVDataRequests");
    qRegisterMetaType<QEArchiveAccess::PVDataResponses> ("QEArchiveAccess::PVDataResponses");
+   qRegisterMetaType<QEArchiveAccess::PVValueAtTimeList> ("QEArchiveAccess::PVValueAtTimeList");
+   qRegisterMetaType<QEArchiveAccess::PVValuesAtTimeRequests> ("QEArchiveAccess::PVValuesAtTimeRequests");
+   qRegisterMetaType<QEArchiveAccess::PVValuesAtTimeResponses> ("QEArchiveAccess::PVValuesAtTimeResponses");
    return true;
 }
 
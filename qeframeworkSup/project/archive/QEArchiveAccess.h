@@ -30,12 +30,14 @@
 #include <QList>
 #include <QMetaType>
 #include <QObject>
+#include <QSharedPointer>
 #include <QString>
 #include <QStringList>
 #include <QVariant>
 
 #include <QCaDateTime.h>
 #include <QEArchiveInterface.h>
+#include <QEPvNameSearch.h>
 
 #include <UserMessage.h>
 #include <QEFrameworkLibraryGlobal.h>
@@ -62,6 +64,7 @@ public:
    enum ArchiverTypes {
       CA,          // Traditional EPIC Channel Access archiver
       ARCHAPPL,    // Archive Appliance archiver
+      PBFILES,     // Local Archive Appliance storage, i.e. .pb partition files
       Error        // Malformed archiver specification
    };
    Q_ENUM (ArchiverTypes)
@@ -96,6 +99,15 @@ public:
 
    static QStringList getAllPvNames ();
 
+   // Returns an indexed name search object for all archived PV names. This is
+   // built by the archive manager off the GUI thread and is re-built whenever
+   // the set of names changes, so callers should re-get this for each search
+   // rather than hold on to it. Until the first index is available, this
+   // returns an un-indexed object, which still works, just slower.
+   // Never returns a null pointer.
+   //
+   static QSharedPointer<const QEPvNameSearch> getPvNameSearch ();
+
    // Requests re-transmission of archive status.
    // Returned status is via archiveStatus signal.
    // This info re-emitted on change, but this allows an (initial) status quo update.
@@ -120,6 +132,33 @@ public:
                      const QEArchiveInterface::How how,
                      const unsigned int element = 0);
 
+   // Cancels any of this object's readArchive requests with the given userData.
+   // Each cancelled request gets an immediate (unsuccessful) setArchiveData
+   // response. Where a request already sent to an archiver is not merged with
+   // any other request, the archiver request itself is aborted.
+   //
+   void cancelReadArchive (QObject* userData);
+
+   // Bulk "value at time" request - the value of each of the specified PVs at
+   // the given time. As per readArchive, no extended meta data, just value +
+   // timestamp + alarm info, and for array PVs the first element only.
+   // This is much more efficient than one readArchive request per PV.
+   //
+   // Returned data is via setArchiveValuesAtTime signal. This signal may be
+   // emitted more than once per request (e.g. once per archiver), however
+   // each requested PV is reported exactly once.
+   //
+   struct PVValueAtTime {
+      QString pvName;          // as per the request
+      bool isOkay;             // false if unknown or no data at/before the time
+      QCaDataPoint point;
+   };
+   typedef QList<PVValueAtTime> PVValueAtTimeList;
+
+   void readArchiveAtTime (QObject* userData,   // provides call back signal context
+                           const QStringList& pvNames,
+                           const QCaDateTime& dateTime);
+
    // Defines the nature of the archives found when the QEArchiveManager
    // interogated the available archives.
    //
@@ -132,6 +171,7 @@ public:
       int read;                              // number of archives successfully read
       int numberPVs;                         //
       int pending;                           // number of outstanding request/responses
+      QEArchiveInterface::Statistics statistics;
    };
    typedef QList<Status> StatusList;
 
@@ -182,6 +222,17 @@ public:
       QString supplementary;  // error info when not successfull
    };
 
+   struct PVValuesAtTimeRequests {
+      QObject* userData;
+      QCaDateTime dateTime;
+      QStringList pvNames;
+   };
+
+   struct PVValuesAtTimeResponses {
+      QObject* userData;
+      PVValueAtTimeList values;
+   };
+
    // Register these meta types.
    // Note: This function is public for conveniance only, and is invoked by the
    // module itself during program elaboration.
@@ -198,11 +249,15 @@ signals:
                         const QString& pvName,
                         const QString& supplementary);
 
+   void setArchiveValuesAtTime (const QObject* userData,
+                                const QEArchiveAccess::PVValueAtTimeList& values);
+
 private:
    void initialiseArchiverType ();
 
    friend class QEArchiveManager;
    void archiveResponse (const QEArchiveAccess::PVDataResponses& response) const;
+   void archiveValuesAtTimeResponse (const QEArchiveAccess::PVValuesAtTimeResponses& response) const;
 
 
    // Used to convey a message during the creation of the object.
@@ -217,10 +272,16 @@ signals:
    void archiveStatusRequest ();
    void readArchiveRequest (const QEArchiveAccess*,
                             const QEArchiveAccess::PVDataRequests&);
+   void cancelReadArchiveRequest (const QEArchiveAccess*,
+                                  const QEArchiveAccess::PVDataRequests&);
+   void readArchiveAtTimeRequest (const QEArchiveAccess*,
+                                  const QEArchiveAccess::PVValuesAtTimeRequests&);
 
-   // This is sent indirectly from the Archive Manager via emitArchiveResponse.
+   // These are sent indirectly from the Archive Manager via archiveResponse
+   // and archiveValuesAtTimeResponse.
    //
    void signalArchiveResponse (const QEArchiveAccess::PVDataResponses& response) const;
+   void signalArchiveValuesAtTimeResponse (const QEArchiveAccess::PVValuesAtTimeResponses& response) const;
 
 private slots:
    // Note: The archiveStatusResponse sent to all ArchiveAccess objects.
@@ -228,6 +289,7 @@ private slots:
    void archiveStatusResponse (const QEArchiveAccess::StatusList&);
 
    void actionArchiveResponse (const QEArchiveAccess::PVDataResponses& response);
+   void actionArchiveValuesAtTimeResponse (const QEArchiveAccess::PVValuesAtTimeResponses& response);
 
    void sendMessagePostConstruction ();
 };
@@ -239,5 +301,8 @@ Q_DECLARE_METATYPE (QEArchiveAccess::Status)
 Q_DECLARE_METATYPE (QEArchiveAccess::StatusList)
 Q_DECLARE_METATYPE (QEArchiveAccess::PVDataRequests)
 Q_DECLARE_METATYPE (QEArchiveAccess::PVDataResponses)
+Q_DECLARE_METATYPE (QEArchiveAccess::PVValueAtTimeList)
+Q_DECLARE_METATYPE (QEArchiveAccess::PVValuesAtTimeRequests)
+Q_DECLARE_METATYPE (QEArchiveAccess::PVValuesAtTimeResponses)
 
 #endif // QE_ARCHIVE_ACCESS_H
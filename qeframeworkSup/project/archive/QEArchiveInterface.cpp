@@ -53,6 +53,13 @@ QCaDateTime QEArchiveInterface::convertArchiveToEpics (const int seconds, const
    return QCaDateTime (epicsSeconds, epicsNanoSec);
 }
 
+//------------------------------------------------------------------------------
+// static - light weight equivalent of convertArchiveToEpics; used for data points.
+QCaTimeStamp QEArchiveInterface::convertArchiveToTimeStamp (const int seconds, const int nanoSecs)
+{
+   return QCaTimeStamp::fromUnixTime (seconds, nanoSecs);
+}
+
 //------------------------------------------------------------------------------
 // static
 void QEArchiveInterface::convertEpicsToArchive (const QCaDateTime& datetime, int& seconds, int& nanoSecs)
@@ -133,4 +140,18 @@ QString QEArchiveInterface::getName () const
    return this->getUrl ().toString ();
 }
 
+//------------------------------------------------------------------------------
+//
+void QEArchiveInterface::cancelValuesRequest (QObject*) { }
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveInterface::getStatistics (Statistics& statistics) const
+{
+   statistics.bytesReceived = 0;
+   statistics.decodeJobs = 0;
+   statistics.decodeNanoSecs = 0;
+   statistics.queueNanoSecs = 0;
+}
+
 // end
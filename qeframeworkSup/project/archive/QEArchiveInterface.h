@@ -40,9 +40,10 @@
 
 /// This virtual class provides the functional interface to the achivers.
 ///
-/// There are currently two sub classes:
-///    QEChannelArchiveInterface (for the traditional EPICS CA archiver ); and
-///    QEArchapplInterface (for the new Archive Appliance archiver)
+/// There are currently three sub classes:
+///    QEChannelArchiveInterface (for the traditional EPICS CA archiver );
+///    QEArchapplInterface (for the new Archive Appliance archiver); and
+///    QEArchapplFileInterface (for local Archive Appliance storage files)
 ///
 /// Other archivers could be added.
 ///
@@ -117,6 +118,7 @@ public:
       Archives,
       Names,
       Values,
+      ValuesAtTime,
       Count
    };
    Q_ENUM (Methods)
@@ -137,6 +139,15 @@ public:
       unsigned int requested_element;
    };
 
+   // Cumulative retrieval statistics, since the interface was created.
+   //
+   struct Statistics {
+      qint64 bytesReceived;
+      qint64 decodeJobs;       // number of values responses decoded
+      qint64 decodeNanoSecs;   // total time spent decoding values
+      qint64 queueNanoSecs;    // total time decodes waited for a worker thread
+   };
+
    typedef QList <QEArchiveInterface::Archive> ArchiveList;
    typedef QList<QEArchiveInterface::PVName> PVNameList;
    typedef std::list<QEArchiveInterface::ResponseValues> ResponseValueList;
@@ -181,6 +192,30 @@ public:
                                const int key = 0,
                                const unsigned int requested_element = 0) = 0;
 
+   // Cancels any outstanding valuesRequest with the given userData, e.g. by
+   // aborting the network reply. As per normal, the request still results in
+   // a single (unsuccessful) valuesResponse signal.
+   // The default implementation does nothing, i.e. the request runs to completion.
+   //
+   virtual void cancelValuesRequest (QObject* userData);
+
+   /* Bulk point-in-time request, i.e. the value of each of the PVs at the given
+    * time. The response contains one ResponseValues item per PV, not necessarily
+    * in the requested order, each with at most one data point. Where the value
+    * is not available, dataPoints is empty. Only element 0 is supported.
+    */
+   virtual void valuesAtTimeRequest (QObject* userData,
+                                     const QCaDateTime time,
+                                     const QStringList pvNames,
+                                     const int key = 0) = 0;
+
+   // Returns the retrieval statistics. The statistics are updated within the
+   // interface's own (archive manager) thread, but this may be called from any
+   // thread, so implementations must guard them, e.g. with a mutex.
+   // The default implementation returns all zeros.
+   //
+   virtual void getStatistics (Statistics& statistics) const;
+
    // Register these meta types.
    // Note: This function is public for conveniance only, and is invoked by the
    // module itself during program elaboration.
@@ -189,6 +224,7 @@ public:
 
 protected:
    static QCaDateTime convertArchiveToEpics (const int seconds, const int nanoSecs);
+   static QCaTimeStamp convertArchiveToTimeStamp (const int seconds, const int nanoSecs);
    static void convertEpicsToArchive (const QCaDateTime& datetime, int& seconds, int& nanoSecs);
 
 signals:
@@ -201,6 +237,7 @@ signals:
    //
    void pvNamesResponse  (const QObject*, const bool, const QEArchiveInterface::PVNameList&);
    void valuesResponse   (const QObject*, const bool, const QEArchiveInterface::ResponseValueList&);
+   void valuesAtTimeResponse (const QObject*, const bool, const QEArchiveInterface::ResponseValueList&);
    void infoResponse     (const QObject*, const bool, const int, const QString&);
    void archivesResponse (const QObject*, const bool, const QEArchiveInterface::ArchiveList&);
    void nextRequest      (const int requestIndex);
@@ -34,6 +34,7 @@
 #include <QECommon.h>
 #include <QEPvNameUri.h>
 #include <QEArchiveManager.h>
+#include <QEArchapplFileInterface.h>
 #include <QEArchapplInterface.h>
 #include <QEChannelArchiveInterface.h>
 
@@ -74,6 +75,25 @@ public:
 };
 
 
+//------------------------------------------------------------------------------
+//
+class QEArchiveInterfaceManager::ValuesAtTimeResponseContext: public QObject {
+public:
+   const QEArchiveInterfaceManager* archiveInterfaceManager;
+   const QEArchiveAccess* archiveAccess;
+   const QEArchiveAccess::PVValuesAtTimeRequests request;
+
+   explicit ValuesAtTimeResponseContext (const QEArchiveInterfaceManager* aim,
+                                         const QEArchiveAccess* archiveAccessIn,
+                                         const QEArchiveAccess::PVValuesAtTimeRequests& requestIn) :
+      archiveInterfaceManager (aim),
+      archiveAccess (archiveAccessIn),
+      request (requestIn)
+   { }
+   ~ValuesAtTimeResponseContext() { }
+};
+
+
 //==============================================================================
 // QEArchiveInterfaceManager
 //==============================================================================
@@ -94,6 +114,7 @@ QEArchiveInterfaceManager::QEArchiveInterfaceManager (const int instanceIn,
    this->requestIndex = 0;
    this->archiveList.clear ();
    this->responseCount = 0;
+   this->namesOkay = true;
    this->numberPVs = 0;
    this->unique = 0;
 
@@ -113,6 +134,16 @@ QEArchiveInterfaceManager::QEArchiveInterfaceManager (const int instanceIn,
                                                       const int,
                                                       const QEArchiveAccess::PVDataRequests&)));
 
+   QObject::connect (this, SIGNAL (signalCancelDataRequest (const QEArchiveAccess::PVDataRequests&)),
+                     this, SLOT   (actionCancelDataRequest (const QEArchiveAccess::PVDataRequests&)));
+
+   QObject::connect (this, SIGNAL (signalValuesAtTimeRequest (const QEArchiveAccess*,
+                                                              const int,
+                                                              const QEArchiveAccess::PVValuesAtTimeRequests&)),
+                     this, SLOT   (actionValuesAtTimeRequest (const QEArchiveAccess*,
+                                                              const int,
+                                                              const QEArchiveAccess::PVValuesAtTimeRequests&)));
+
    // Signals from the archiveInterface
    #define ai this->archiveInterface
 
@@ -131,6 +162,11 @@ QEArchiveInterfaceManager::QEArchiveInterfaceManager (const int instanceIn,
                      this, SLOT (valuesResponse (const QObject*, const bool,
                                                  const QEArchiveInterface::ResponseValueList&)));
 
+   QObject::connect (ai, SIGNAL (valuesAtTimeResponse (const QObject*, const bool,
+                                                       const QEArchiveInterface::ResponseValueList&)),
+                     this, SLOT (valuesAtTimeResponse (const QObject*, const bool,
+                                                       const QEArchiveInterface::ResponseValueList&)));
+
    #undef ai
 }
 
@@ -172,6 +208,16 @@ QEArchiveInterfaceManager* QEArchiveInterfaceManager::createInterfaceManager (
          #endif
          break;
 
+      case QEArchiveAccess::PBFILES:
+         #ifdef QE_ARCHAPPL_SUPPORT
+            thread = new QThread (owner);
+            interface = new QEArchapplFileInterface (url, NULL);
+         #else
+            DEBUG << "Unexpected archiver type, no Archiver Appliance support";
+            return NULL;
+         #endif
+         break;
+
       default:
          DEBUG << "Unexpected archiver type" << archiverType;
          return NULL;
@@ -206,6 +252,7 @@ void QEArchiveInterfaceManager::getStatus (QEArchiveAccess::Status& status) cons
    status.hostName = url.host ();
    status.portNumber = url.port();
    status.endPoint = url.path ();
+   this->archiveInterface->getStatistics (status.statistics);
 
    QMutexLocker locker (this->aimMutex);
 
@@ -259,6 +306,7 @@ void QEArchiveInterfaceManager::actionRequestArchives ()
    this->requestIndex = 0;
    this->archiveList.clear ();
    this->responseCount = 0;
+   this->namesOkay = true;
    this->numberPVs = 0;
    this->archiveInterface->archivesRequest (this);
 }
@@ -286,8 +334,14 @@ void QEArchiveInterfaceManager::archivesResponse (
       // Only one for the archive applicance, but potentially many for the
       // Channel Access arhiver
 
+      if (this->archiveList.count() == 0) {
+         this->state = QEArchiveInterface::Complete;
+         emit this->aimPvNamesComplete (this, true);
+      }
+
    } else {
       this->state = QEArchiveInterface::Error;
+      emit this->aimPvNamesComplete (this, false);
 
       QString message;
       message = QString ("request failure from %1").arg (this->getName ());
@@ -376,6 +430,11 @@ void QEArchiveInterfaceManager::pvNamesResponse (
 
       this->sendMessage (message, message_types (MESSAGE_TYPE_ERROR));
       DEBUG << message;
+      this->namesOkay = false;
+   }
+
+   if (this->responseCount == this->archiveList.count()) {
+      emit this->aimPvNamesComplete (this, this->namesOkay);
    }
 
    if (context) delete context;
@@ -408,6 +467,7 @@ void QEArchiveInterfaceManager::actionDataRequest (
    requestInfo.archiveAccess = archiveAccess;
    requestInfo.request = request;
    requestInfo.key = key;
+   requestInfo.context = NULL;
 
    QMutexLocker locker (this->aimMutex);
    if (this->activeRequests.count() <= maxActiveQueueSize) {
@@ -436,15 +496,17 @@ void QEArchiveInterfaceManager::activateDataRequest (RequestInfo& requestInfo)
    this->unique++;
    requestInfo.unique = this->unique;
    requestInfo.timeoutTime = timeNow.addSecs (maxAllowedTime);
+
+   ValuesResponseContext* context =
+         new ValuesResponseContext (this, requestInfo.unique);
+
+   requestInfo.context = context;
    this->activeRequests.insert (requestInfo.unique, requestInfo);
 
    // pass on to the inferface.
 
    QEArchiveAccess::PVDataRequests* request = & requestInfo.request;
 
-   ValuesResponseContext* context =
-         new ValuesResponseContext (this, requestInfo.unique);
-
    // Converts name to a list of one in order to satisfy the valuesRequest API.
    //
    QStringList pvNames;
@@ -455,6 +517,59 @@ void QEArchiveInterfaceManager::activateDataRequest (RequestInfo& requestInfo)
             request->how, pvNames,  request->key, request->element);
 }
 
+//------------------------------------------------------------------------------
+//
+void QEArchiveInterfaceManager::cancelDataRequest (const QEArchiveAccess::PVDataRequests& request)
+{
+   emit this->signalCancelDataRequest (request);
+}
+
+//------------------------------------------------------------------------------
+// slot - from self
+// Queued requests are responded to straight away. Active requests are cancelled
+// by the archive interface, and then get a (failed) response as per normal.
+//
+void QEArchiveInterfaceManager::actionCancelDataRequest (
+      const QEArchiveAccess::PVDataRequests& request)
+{
+   QList<RequestInfo> cancelled;
+   QList<QObject*> contexts;
+
+   QMutexLocker locker (this->aimMutex);
+   for (int j = this->requestQueue.count () - 1; j >= 0; j--) {
+      if (this->requestQueue.at (j).request.userData == request.userData) {
+         cancelled.prepend (this->requestQueue.takeAt (j));
+      }
+   }
+
+   RequestLists::const_iterator it;
+   for (it = this->activeRequests.constBegin (); it != this->activeRequests.constEnd (); ++it) {
+      if (it->request.userData == request.userData) {
+         contexts.append (it->context);
+      }
+   }
+   locker.unlock ();
+
+   for (int j = 0; j < cancelled.count (); j++) {
+      const RequestInfo& requestInfo = cancelled.at (j);
+
+      QEArchiveAccess::PVDataResponses response;
+      response.userData = requestInfo.request.userData;
+      response.isSuccess = false;
+      response.pvName = requestInfo.request.pvName;
+      response.metaRequest = requestInfo.request.metaRequest;
+      response.supplementary = "cancelled";
+
+      emit this->aimDataResponse (requestInfo.archiveAccess, response);
+   }
+
+   // The interface may respond from within cancelValuesRequest.
+   //
+   for (int j = 0; j < contexts.count (); j++) {
+      this->archiveInterface->cancelValuesRequest (contexts.at (j));
+   }
+}
+
 //------------------------------------------------------------------------------
 // slot - from archiveInterface
 //
@@ -502,6 +617,85 @@ void QEArchiveInterfaceManager::valuesResponse (
    emit this->aimDataResponse (requestInfo.archiveAccess, response);
 }
 
+//------------------------------------------------------------------------------
+// Values at time requests
+//------------------------------------------------------------------------------
+//
+void QEArchiveInterfaceManager::valuesAtTimeRequest (const QEArchiveAccess* archiveAccess,
+                                                     const int key,
+                                                     const QEArchiveAccess::PVValuesAtTimeRequests& request)
+{
+   emit this->signalValuesAtTimeRequest (archiveAccess, key, request);
+}
+
+//------------------------------------------------------------------------------
+// slot - from self
+// Note: this is a single request for many PVs, so no need to queue these.
+//
+void QEArchiveInterfaceManager::actionValuesAtTimeRequest (
+      const QEArchiveAccess* archiveAccess,
+      const int key,
+      const QEArchiveAccess::PVValuesAtTimeRequests& request)
+{
+   ValuesAtTimeResponseContext* context =
+         new ValuesAtTimeResponseContext (this, archiveAccess, request);
+
+   this->archiveInterface->valuesAtTimeRequest (context, request.dateTime,
+                                                request.pvNames, key);
+}
+
+//------------------------------------------------------------------------------
+// slot - from archiveInterface
+//
+void QEArchiveInterfaceManager::valuesAtTimeResponse (
+      const QObject* userData,
+      const bool isSuccess,
+      const QEArchiveInterface::ResponseValueList& valuesList)
+{
+   const ValuesAtTimeResponseContext* context =
+         dynamic_cast <const ValuesAtTimeResponseContext*> (userData);
+
+   if (!context || (context->archiveInterfaceManager != this)) {
+      DEBUG  << "instance" << this->instance << "userData mis-match";
+      return;
+   }
+
+   // The interfaces return the values in request order, but we do not rely
+   // on that, and index by name.
+   //
+   QHash<QString, const QEArchiveInterface::ResponseValues*> valuesByName;
+   for (int j = 0; j < valuesList.count (); j++) {
+      const QEArchiveInterface::ResponseValues& item = valuesList.at (j);
+      valuesByName.insert (item.pvName, &item);
+   }
+
+   QEArchiveAccess::PVValuesAtTimeResponses response;
+   response.userData = context->request.userData;
+
+   const QStringList& pvNames = context->request.pvNames;
+   response.values.reserve (pvNames.count ());
+
+   for (int j = 0; j < pvNames.count (); j++) {
+      QEArchiveAccess::PVValueAtTime item;
+      item.pvName = pvNames.value (j);
+
+      const QEArchiveInterface::ResponseValues* values = valuesByName.value (item.pvName, NULL);
+      item.isOkay = isSuccess && values && (values->dataPoints.count () > 0);
+      if (item.isOkay) {
+         item.point = values->dataPoints.last ();
+      }
+
+      response.values.append (item);
+   }
+
+   const QEArchiveAccess* archiveAccess = context->archiveAccess;
+   delete context;
+
+   // Hand off the the Archiver Manager.
+   //
+   emit this->aimValuesAtTimeResponse (archiveAccess, response);
+}
+
 //------------------------------------------------------------------------------
 // slot
 void QEArchiveInterfaceManager::started ()
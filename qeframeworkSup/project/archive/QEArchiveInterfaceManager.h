@@ -80,6 +80,10 @@ private:
    void dataRequest (const QEArchiveAccess* archiveAccess,
                      const int key,
                      const QEArchiveAccess::PVDataRequests& request);
+   void cancelDataRequest (const QEArchiveAccess::PVDataRequests& request);   // only userData relevant
+   void valuesAtTimeRequest (const QEArchiveAccess* archiveAccess,
+                             const int key,
+                             const QEArchiveAccess::PVValuesAtTimeRequests& request);
 
 signals:
    // Signals to self
@@ -88,6 +92,10 @@ signals:
    void signalDataRequest (const QEArchiveAccess*,
                            const int,
                            const QEArchiveAccess::PVDataRequests&);
+   void signalCancelDataRequest (const QEArchiveAccess::PVDataRequests&);
+   void signalValuesAtTimeRequest (const QEArchiveAccess*,
+                                   const int,
+                                   const QEArchiveAccess::PVValuesAtTimeRequests&);
 
    // Signals to the Archive Manager when the responses are available.
    //
@@ -95,9 +103,19 @@ signals:
                             const QEArchiveInterface::Archive,
                             const QEArchiveInterface::PVNameList&);
 
+   // Sent once all archives have responded (or failed) following requestArchives.
+   // The bool parameter is true if, and only if, all archives responded successfully.
+   //
+   void aimPvNamesComplete (QEArchiveInterfaceManager*, const bool);
+
    void aimDataResponse (const QEArchiveAccess*,    // context
                          const QEArchiveAccess::PVDataResponses&);
 
+   // The response values are in the same order as the request PV names.
+   //
+   void aimValuesAtTimeResponse (const QEArchiveAccess*,    // context
+                                 const QEArchiveAccess::PVValuesAtTimeResponses&);
+
 private slots:
    // From the Archive Manager via self
    //
@@ -105,6 +123,10 @@ private slots:
    void actionDataRequest (const QEArchiveAccess* archiveAccess,  // context
                            const int key,
                            const QEArchiveAccess::PVDataRequests& request);
+   void actionCancelDataRequest (const QEArchiveAccess::PVDataRequests& request);
+   void actionValuesAtTimeRequest (const QEArchiveAccess* archiveAccess,  // context
+                                   const int key,
+                                   const QEArchiveAccess::PVValuesAtTimeRequests& request);
 
    // From the archive interface
    //
@@ -117,6 +139,9 @@ private slots:
    void valuesResponse   (const QObject* userData, const bool isSuccess,
                           const QEArchiveInterface::ResponseValueList& valuesList);
 
+   void valuesAtTimeResponse (const QObject* userData, const bool isSuccess,
+                              const QEArchiveInterface::ResponseValueList& valuesList);
+
 private:
    enum Constants {
       maxActiveQueueSize = 200,   // maxiumum number of outstanding requests allowed.
@@ -129,6 +154,7 @@ private:
       const QEArchiveAccess* archiveAccess;
       QEArchiveAccess::PVDataRequests request;
       int key;
+      QObject* context;           // userData passed to the interface when active
    };
 
    void actionNamesRequest (const int index);
@@ -145,6 +171,7 @@ private:
    QEArchiveInterface::ArchiveList archiveList;
    int requestIndex;
    int responseCount;
+   bool namesOkay;
    volatile int numberPVs;
 
    typedef QQueue <RequestInfo> RequestQueues;
@@ -156,6 +183,7 @@ private:
 
    class NamesResponseContext;
    class ValuesResponseContext;
+   class ValuesAtTimeResponseContext;
 
 private slots:
    void started ();              // From owning thread
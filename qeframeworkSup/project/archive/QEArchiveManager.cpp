@@ -29,11 +29,15 @@
 #include "QEArchiveManager.h"
 
 #include <QApplication>
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QDir>
 #include <QHash>
 #include <QMap>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QPair>
+#include <QStandardPaths>
 #include <QThread>
 
 #include <QECommon.h>
@@ -41,6 +45,8 @@
 #include <QEAdaptationParameters.h>
 #include <QEArchiveInterfaceManager.h>
 #include <QEArchiveAccess.h>
+#include <QEArchiveNameIndex.h>
+#include <QEArchiveSegmentCache.h>
 #include <QCaDataPoint.h>
 
 #define DEBUG  qDebug () << "QEArchiveManager" << __LINE__ <<  __FUNCTION__  << "  "
@@ -147,6 +153,20 @@ public:
       }
       return false;
    }
+
+   //---------------------------------------------------------------------------
+   // Replaces the spec for an existing key, otherwise inserts.
+   //
+   bool update (const KeyTimeSpec spec)
+   {
+      for (int k = 0; k < numberOfKeys; k++) {
+         if (this->keyToTimeSpecLookUp[k].key == spec.key) {
+            this->keyToTimeSpecLookUp[k] = spec;
+            return true;
+         }
+      }
+      return this->insert (spec);
+   }
 };
 
 //------------------------------------------------------------------------------
@@ -166,6 +186,194 @@ public:
 };
 
 
+//==============================================================================
+// Segment cache types
+//==============================================================================
+// When a request is (partially) satisfied from the segment cache, or modified
+// in order to fill the cache, the user's userData is substituted with one of
+// these context objects.
+//
+class QEArchiveManager::CacheFillContext : public QObject {
+public:
+   explicit CacheFillContext () : QObject (NULL) { }
+   ~CacheFillContext () { }
+
+   QObject* userData;                  // the original user data
+   QEArchiveSegmentCache::Key key;     // bucket is set per segment
+   qint64 span;                        // bucket span
+   qint64 fetchStart;                  // all times in seconds since EPICS epoch
+   qint64 fetchEnd;
+   qint64 safeEnd;                     // data prior to this time deemed immutable
+   int maxPoints;                      // point count indicating truncation, or 0
+   QCaTimeStamp startTime;             // the original request times
+   QCaTimeStamp endTime;
+   QCaDataPointList cachedPoints;      // from the leading cached buckets
+};
+
+//------------------------------------------------------------------------------
+// A set of one or more merged requests to a single archive interface manager.
+// The coalesced request object itself is used as the userData of the request
+// sent to the interface manager.
+//
+class QEArchiveManager::CoalescedRequest : public QObject {
+public:
+   explicit CoalescedRequest () : QObject (NULL) { }
+   ~CoalescedRequest () { }
+
+   struct Requestor {
+      const QEArchiveAccess* archiveAccess;
+      QEArchiveAccess::PVDataRequests request;
+   };
+
+   QEArchiveInterfaceManager* interfaceManager;
+   int key;
+   qint64 binSize;                     // seconds, 0 for non-binned requests
+   bool isRangeMergable;               // else only identical requests merged
+   bool isActive;                      // i.e. sent to the interface manager
+   QCaTimeStamp startTime;             // of the merged request
+   QCaTimeStamp endTime;
+   QEArchiveAccess::PVDataRequests request;
+   QList<Requestor> requestors;
+};
+
+//==============================================================================
+// Values at time types
+//==============================================================================
+// The part of a values at time request sent to a single archive interface
+// manager and key. The context object is used as the userData of the request
+// sent to the interface manager.
+//
+class QEArchiveManager::AtTimeContext : public QObject {
+public:
+   explicit AtTimeContext () : QObject (NULL) { }
+   ~AtTimeContext () { }
+
+   QObject* userData;                                 // the original user data
+   QStringList userPvNames;                           // as per the original request
+   QList<QEArchiveAccess::MetaRequests> metas;        // per PV
+   QEArchiveAccess::PVValuesAtTimeRequests request;   // effective PV names
+};
+
+// Requests are held for this period (mSec) prior to being issued, allowing
+// requests from all the widgets on a newly opened form to be merged.
+//
+static const int coalesceDelay = 20;
+
+// Data within this many seconds of the current time is not cached, allowing for
+// archive engine write periods, late/delayed updates and clock differences.
+//
+static const qint64 cacheSafetyMargin = 3600;
+
+// PV names typically arrive in bursts of many 1000s. We wait for a lull
+// before re-building the name search index.
+//
+static const int nameSearchRebuildDelay = 2000;   // mSec
+
+//------------------------------------------------------------------------------
+//
+static qint64 floorDiv (const qint64 a, const qint64 b)
+{
+   qint64 q = a / b;
+   if ((a % b != 0) && ((a < 0) != (b < 0))) q--;
+   return q;
+}
+
+//------------------------------------------------------------------------------
+// The archive interfaces expect UTC date times.
+//
+static QCaDateTime utcDateTime (const QCaTimeStamp& timeStamp)
+{
+   const QCaDateTime local (timeStamp);
+   return QCaDateTime (local.toUTC ());
+}
+
+static QCaDateTime utcDateTime (const qint64 seconds)
+{
+   return utcDateTime (QCaTimeStamp::fromNanoSecs (seconds * QCaTimeStamp::nanoSecsPerSec));
+}
+
+//------------------------------------------------------------------------------
+// Selects the key that best fits the request time frame. This is really only
+// applicable to the EPICS CA archiver which supported both a long term and a
+// short term sub-archives for various catagories of data types.
+// Returns -1 if no key has a suitable time overlap.
+//
+static int selectKey (const SourceSpec& sourceSpec,
+                      const QCaDateTime& requestStartTime,
+                      const QCaDateTime& requestEndTime)
+{
+   int key = -1;
+   int bestOverlap = -864000;  // we allow 10 days grace.
+
+   QList <int> keys = sourceSpec.keys ();
+   for (int j = 0; j < keys.count (); j++) {
+
+      const KeyTimeSpec keyTimeSpec = sourceSpec.value (keys.value (j));
+
+      // Can't use const here
+      QCaDateTime startTime = QCaDateTime (keyTimeSpec.startTime, 0, 0);
+      QCaDateTime endTime = QCaDateTime (keyTimeSpec.endTime, 0, 0);
+
+      const QCaDateTime useStart = MAX (requestStartTime.toUTC (), startTime);
+      const QCaDateTime useEnd = MIN (requestEndTime.toUTC (), endTime);
+
+      // We don't worry about calculating the overlap to an accuracy
+      // of any more one than one second.
+      //
+      int overlap = useStart.secsTo (useEnd);
+      if (overlap > bestOverlap) {
+         bestOverlap = overlap;
+         key = keyTimeSpec.key;
+      }
+   }
+
+   return key;
+}
+
+//------------------------------------------------------------------------------
+// Binned requests are those for which the archivers return data in fixed size
+// time bins, the bin size being derived from the time span and count.
+//
+static bool isBinnedRequest (const QEArchiveAccess::PVDataRequests& request)
+{
+   return (request.how == QEArchiveInterface::Averaged) ||
+          (request.how == QEArchiveInterface::PlotBinning) ||
+          (request.how == QEArchiveInterface::Linear);
+}
+
+//------------------------------------------------------------------------------
+// Same bin size calculation as used by the archive interfaces.
+// Returns the bin size in seconds, or 0 if not a binned request.
+//
+static qint64 requestBinSize (const QEArchiveAccess::PVDataRequests& request)
+{
+   if (!isBinnedRequest (request) || (request.count <= 0)) return 0;
+   const double seconds = request.startTime.secondsTo (request.endTime);
+   return seconds > request.count ? qint64 (seconds) / request.count : 0;
+}
+
+//------------------------------------------------------------------------------
+// Trims the points to the request time frame, retaining the last point at
+// or before the start time, as the archivers themselves do.
+//
+static QCaDataPointList trimPoints (const QCaDataPointList& points,
+                                    const QCaTimeStamp& startTime,
+                                    const QCaTimeStamp& endTime)
+{
+   const int first = points.indexBeforeTime (startTime, 0);
+   const int n = points.count ();
+
+   QCaDataPointList result;
+   result.reserve (n - first);
+   for (int j = first; j < n; j++) {
+      const QCaDataPoint point = points.value (j);
+      if (point.datetime > endTime) break;
+      result.append (point);
+   }
+   return result;
+}
+
+
 //==============================================================================
 // Local Data
 //==============================================================================
@@ -184,6 +392,11 @@ static QThread* singletonThread = NULL;
 //
 static QMutex* archiveDataMutex = new QMutex ();
 
+// Protects pvNameSearch - distinct from archiveDataMutex as the index
+// is built (from a copy of the names) without holding that lock.
+//
+static QMutex* nameSearchMutex = new QMutex ();
+
 // This list holds archive names and paths - essentially only applicable to 
 // the traditional Channel Access archiver. We hold an indices (2 bytes each)
 // as opposed to a QStrings (24 bytes each) in the SourceSpec type.
@@ -204,6 +417,12 @@ QEArchiveManager::QEArchiveManager (const QEArchiveAccess::ArchiverTypes archive
    this->allowPendingRequests = true;
 
    this->pvNameToSourceLookUp = new PVNameToSourceSpecLookUp ();
+   this->refreshLookUp = new PVNameToSourceSpecLookUp ();
+   this->isRefreshOkay = false;
+   this->segmentCache = NULL;
+   this->maxConcurrentRequests = 8;
+   this->isIssueScheduled = false;
+   this->isNameSearchRebuildScheduled = false;
    this->timer = new QTimer (this);
 
    // The started function does all the initialisation.
@@ -231,6 +450,32 @@ void QEArchiveManager::started ()
    const QString archives = ap.getString ("archive_list", "");
    this->pattern = ap.getString ("archive_pattern", ".*");
 
+   // The segment cache is shared by all applications run by the user.
+   // The size is specified in MBytes, a size of zero disables the cache.
+   //
+   const QString defaultCacheDir =
+         QStandardPaths::writableLocation (QStandardPaths::GenericCacheLocation) +
+         "/qeframework/archive";
+   const QString cacheDir = ap.getFilename ("archive_cache_directory", defaultCacheDir);
+   const int cacheSize = ap.getInt ("archive_cache_size", 256);
+   this->segmentCache = new QEArchiveSegmentCache (cacheDir, qint64 (MAX (cacheSize, 0)) * 1024 * 1024);
+
+   // The PV name index file lives alongside the segment cache. It is specific
+   // to the archiver configuration, which is hashed to form the file name.
+   //
+   if (!ap.getBool ("archive_no_name_index")) {
+      const QString config = QString ("%1|%2|%3")
+            .arg (int (this->archiverType)).arg (archives).arg (this->pattern);
+      const QString hash = QString::fromLatin1 (
+               QCryptographicHash::hash (config.toUtf8 (), QCryptographicHash::Sha1).toHex ());
+      this->nameIndexFilename = QDir::cleanPath (cacheDir) + "/names/" + hash + ".qeidx";
+   }
+
+   // Limit the number of concurrent requests per archiver, so as not to trip
+   // any archiver rate limiting. Excess requests are queued.
+   //
+   this->maxConcurrentRequests = MAX (ap.getInt ("archive_max_requests", 8), 1);
+
    // Normally a 5 minute wait to re-interogaye the archives, but allow first
    // re-request to be done after 3 minutes.
    //
@@ -252,9 +497,17 @@ void QEArchiveManager::started ()
    for (int j = 0; j < archiveList.count (); j++) {
 
       const QString item = archiveList.value (j);
-      const QString prefix = item.indexOf ("://") <= 0 ? "http://" : "";
+      const bool isSchemeDefined = item.indexOf ("://") > 0;
+
+      // Archive Appliance storage directories may be specified as plain paths.
+      //
+      QUrl url;
+      if (!isSchemeDefined && (this->archiverType == QEArchiveAccess::PBFILES)) {
+         url = QUrl::fromLocalFile (item);
+      } else {
+         url = QUrl ((isSchemeDefined ? "" : "http://") + item);
+      }
 
-      QUrl url (prefix + item);
       if (!url.isValid()) {
          const QString message = QString ("not a valid URL: %1").arg (item);
          DEBUG << message;
@@ -264,7 +517,7 @@ void QEArchiveManager::started ()
 
       // If no port defined, go with port 80 by default.
       //
-      if (url.port() == -1) {
+      if ((url.port() == -1) && !url.isLocalFile()) {
          url.setPort (80);
       }
 
@@ -293,6 +546,11 @@ void QEArchiveManager::started ()
                                                     const QEArchiveInterface::Archive,
                                                     const QEArchiveInterface::PVNameList&)));
 
+      QObject::connect (aim,
+                        SIGNAL (aimPvNamesComplete (QEArchiveInterfaceManager*, const bool)),
+                        this,
+                        SLOT   (aimPvNamesComplete (QEArchiveInterfaceManager*, const bool)));
+
       QObject::connect (aim,
                         SIGNAL (aimDataResponse (const QEArchiveAccess*,
                                                  const QEArchiveAccess::PVDataResponses&)),
@@ -300,13 +558,26 @@ void QEArchiveManager::started ()
                         SLOT   (aimDataResponse (const QEArchiveAccess*,
                                                  const QEArchiveAccess::PVDataResponses&)));
 
+      QObject::connect (aim,
+                        SIGNAL (aimValuesAtTimeResponse (const QEArchiveAccess*,
+                                                         const QEArchiveAccess::PVValuesAtTimeResponses&)),
+                        this,
+                        SLOT   (aimValuesAtTimeResponse (const QEArchiveAccess*,
+                                                         const QEArchiveAccess::PVValuesAtTimeResponses&)));
+
       // Lastly prod the archive interface manager to start interogating the
       // archive to provide info re which PVs are archived and over which time
-      // period.
+      // period. The responses are not processed until this function returns.
       //
+      this->refreshing.insert (aim);
       aim->requestArchives();
    }
 
+   // Pre-load the PV name look up from the index file, if we have one.
+   //
+   this->loadNameIndex ();
+   this->scheduleNameSearchRebuild ();
+
    // Allow 60 seconds for all archives to respond before clearing out
    // any pending requests.
    // Empircally, the rate is approx 5000 PV / sec.
@@ -333,7 +604,10 @@ void QEArchiveManager::started ()
 
 //------------------------------------------------------------------------------
 //
-QEArchiveManager::~QEArchiveManager() { }
+QEArchiveManager::~QEArchiveManager()
+{
+   if (this->segmentCache) delete this->segmentCache;
+}
 
 //------------------------------------------------------------------------------
 // static
@@ -360,7 +634,7 @@ QEArchiveManager* QEArchiveManager::getInstance (QString& statusMessage)
       // Note: caller reports errors, we are static and can't use sendMessage
       //
       statusMessage = QString ("QE_ARCHIVE_TYPE variable '%1' not correctly specified. "
-                               "Options are: CA or ARCHAPPL.").arg(archiveString);
+                               "Options are: CA, ARCHAPPL or PBFILES.").arg(archiveString);
       DEBUG << statusMessage;
       return singletonManager;  // It is still NULL
    }
@@ -381,16 +655,17 @@ QEArchiveManager* QEArchiveManager::getInstance (QString& statusMessage)
          break;
 
       case (QEArchiveAccess::ARCHAPPL):
-         // Create ARCHAPPL manager instance only when built with ARCHAPPL support
+      case (QEArchiveAccess::PBFILES):
+         // Create ARCHAPPL/PBFILES manager instance only when built with ARCHAPPL support
          //
          #ifdef QE_ARCHAPPL_SUPPORT
             singletonThread = new QThread (NULL);
             singletonManager = new QEArchiveManager (archiverType);
          #else
             statusMessage =
-                  "QE_ARCHIVE_TYPE=ARCHAPPL but the QEFramework has not been built "
-                  "with Archiver Appliance support, i.e. QE_ARCHAPPL_SUPPORT=YES. "
-                  "Please consult the documentation.";
+                  QString ("QE_ARCHIVE_TYPE=%1 but the QEFramework has not been built "
+                           "with Archiver Appliance support, i.e. QE_ARCHAPPL_SUPPORT=YES. "
+                           "Please consult the documentation.").arg (archiveString);
             DEBUG << statusMessage;
          #endif
          break;
@@ -504,6 +779,39 @@ QStringList QEArchiveManager::getAllPvNames () const
    return result;
 }
 
+//------------------------------------------------------------------------------
+//
+QSharedPointer<const QEPvNameSearch> QEArchiveManager::getPvNameSearch () const
+{
+   QMutexLocker locker (nameSearchMutex);
+   return this->pvNameSearch;
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveManager::scheduleNameSearchRebuild ()
+{
+   if (this->isNameSearchRebuildScheduled) return;
+   this->isNameSearchRebuildScheduled = true;
+   QTimer::singleShot (nameSearchRebuildDelay, this, SLOT (rebuildNameSearch ()));
+}
+
+//------------------------------------------------------------------------------
+// slot
+// The keys of the look up are already sorted and unique, the set call is then
+// relatively cheap. Users retain any previous index until they next ask.
+//
+void QEArchiveManager::rebuildNameSearch ()
+{
+   this->isNameSearchRebuildScheduled = false;
+
+   QEPvNameSearch* search = new QEPvNameSearch (this->getAllPvNames ());
+   search->buildIndex ();
+
+   QMutexLocker locker (nameSearchMutex);
+   this->pvNameSearch = QSharedPointer<const QEPvNameSearch> (search);
+}
+
 //------------------------------------------------------------------------------
 //
 bool QEArchiveManager::getArchivePvInformation (
@@ -559,9 +867,29 @@ void QEArchiveManager::clear ()
 {
    QMutexLocker locker (archiveDataMutex);
    this->pvNameToSourceLookUp->clear ();
+   this->refreshLookUp->clear ();
+   this->refreshing.clear ();
+   this->isRefreshOkay = false;
    this->allowPendingRequests = true;
 }
 
+//------------------------------------------------------------------------------
+// Unlike clear, this retains the current look up, which remains usable during
+// the refresh.
+//
+void QEArchiveManager::beginRefresh ()
+{
+   QMutexLocker locker (archiveDataMutex);
+   this->refreshLookUp->clear ();
+   this->refreshing.clear ();
+   this->isRefreshOkay = false;
+   this->allowPendingRequests = true;
+
+   for (int j = 0; j < this->archiveInterfaceManagerList.count (); j++) {
+      this->refreshing.insert (this->archiveInterfaceManagerList.value (j));
+   }
+}
+
 //------------------------------------------------------------------------------
 //
 void QEArchiveManager::resendStatus ()
@@ -678,7 +1006,7 @@ void QEArchiveManager::reInterogateArchives ()
 
       // More than 5 minutes - re-start interogating the archiver.
       //
-      this->clear ();
+      this->beginRefresh ();
 
       for (int j = 0; j < this->archiveInterfaceManagerList.count (); j++) {
 
@@ -737,34 +1065,9 @@ void QEArchiveManager::readArchiveRequest (const QEArchiveAccess* archiveAccess,
 
       const SourceSpec sourceSpec = this->pvNameToSourceLookUp->value (effectivePvName);
 
-      int key = -1;
-      int bestOverlap = -864000;  // we allow 10 days grace.
-
-      // Check times here - really only applicable to the EPICS CA archiver
-      // which supported both a long term and a short term sub-archives
-      // for various catagories of data types.
+      // Check times here.
       //
-      QList <int> keys = sourceSpec.keys ();
-      for (int j = 0; j < keys.count (); j++) {
-
-         const KeyTimeSpec keyTimeSpec = sourceSpec.value (keys.value (j));
-
-         // Can't use const here
-         QCaDateTime startTime = QCaDateTime (keyTimeSpec.startTime, 0, 0);
-         QCaDateTime endTime = QCaDateTime (keyTimeSpec.endTime, 0, 0);
-
-         const QCaDateTime useStart = MAX (request.startTime.toUTC (), startTime);
-         const QCaDateTime useEnd = MIN (request.endTime.toUTC (), endTime);
-
-         // We don't worry about calculating the overlap to an accuracy
-         // of any more one than one second.
-         //
-         int overlap = useStart.secsTo (useEnd);
-         if (overlap > bestOverlap) {
-            bestOverlap = overlap;
-            key = keyTimeSpec.key;
-         }
-      }
+      const int key = selectKey (sourceSpec, request.startTime, request.endTime);
 
       if (key >= 0) {
          // All looks good - re-route to the appropriate interface manager
@@ -773,7 +1076,14 @@ void QEArchiveManager::readArchiveRequest (const QEArchiveAccess* archiveAccess,
          modifiedRequest = request;
          modifiedRequest.pvName = effectivePvName;
          modifiedRequest.metaRequest = meta;
-         sourceSpec.interfaceManager->dataRequest (archiveAccess, key, modifiedRequest);
+
+         const bool isHandled = this->segmentCacheRequest (archiveAccess,
+                                                           sourceSpec.interfaceManager,
+                                                           key, modifiedRequest);
+         if (!isHandled) {
+            this->issueDataRequest (archiveAccess, sourceSpec.interfaceManager,
+                                    key, modifiedRequest);
+         }
          this->resendStatus ();
 
       } else {
@@ -808,6 +1118,210 @@ void QEArchiveManager::readArchiveRequest (const QEArchiveAccess* archiveAccess,
    }
 }
 
+//------------------------------------------------------------------------------
+// slot
+// Each cancelled requestor is sent a failed response straight away so that,
+// as per normal, each request gets exactly one response. Coalesced requests
+// with no remaining requestors are discarded if still queued, or if already
+// sent to an interface manager, are cancelled in flight. The response to a
+// request cancelled in flight just releases the coalesced request.
+//
+void QEArchiveManager::cancelReadArchiveRequest (const QEArchiveAccess* archiveAccess,
+                                                 const QEArchiveAccess::PVDataRequests& request)
+{
+   if (!archiveAccess) return;   // sanity check
+
+   QEArchiveAccess::PVDataResponses response;
+   response.userData = request.userData;
+   response.metaRequest = QEArchiveAccess::mrNone;
+   response.isSuccess = false;
+   response.supplementary = "cancelled";
+
+   for (int j = this->pendingRequests.count () - 1; j >= 0; j--) {
+      const PendingRequest& pending = this->pendingRequests.at (j);
+      if ((pending.archiveAccess == archiveAccess) &&
+          (pending.userRequest.userData == request.userData)) {
+         response.pvName = pending.userRequest.pvName;
+         this->pendingRequests.removeAt (j);
+         archiveAccess->archiveResponse (response);
+      }
+   }
+
+   int j = 0;
+   while (j < this->queuedRequests.count ()) {
+      CoalescedRequest* coalesced = this->queuedRequests.value (j);
+      this->cancelRequestors (coalesced, archiveAccess, request.userData);
+
+      if (coalesced->requestors.isEmpty ()) {
+         this->queuedRequests.removeAt (j);
+         this->coalescedByName.remove (coalesced->request.pvName, coalesced);
+         delete coalesced;
+      } else {
+         j++;
+      }
+   }
+
+   const QList<CoalescedRequest*> active = this->activeRequests.values ();
+   for (j = 0; j < active.count (); j++) {
+      CoalescedRequest* coalesced = active.value (j);
+      if (coalesced->requestors.isEmpty ()) continue;   // already cancelled
+
+      this->cancelRequestors (coalesced, archiveAccess, request.userData);
+
+      if (coalesced->requestors.isEmpty ()) {
+         // No other request may now be merged with this request.
+         //
+         this->coalescedByName.remove (coalesced->request.pvName, coalesced);
+         coalesced->interfaceManager->cancelDataRequest (coalesced->request);
+      }
+   }
+
+   this->resendStatus ();
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveManager::cancelRequestors (CoalescedRequest* coalesced,
+                                         const QEArchiveAccess* archiveAccess,
+                                         QObject* userDataIn)
+{
+   QEArchiveAccess::PVDataResponses response;
+   response.userData = userDataIn;
+   response.isSuccess = false;
+   response.supplementary = "cancelled";
+
+   for (int k = coalesced->requestors.count () - 1; k >= 0; k--) {
+      const CoalescedRequest::Requestor& requestor = coalesced->requestors.at (k);
+      if (requestor.archiveAccess != archiveAccess) continue;
+
+      // The user data may have been substituted with a cache fill context.
+      //
+      const QObject* requestUserData = requestor.request.userData;
+      CacheFillContext* fill = this->cacheFills.value (requestUserData, NULL);
+      const QObject* userData = fill ? fill->userData : requestUserData;
+      if (userData != userDataIn) continue;
+
+      if (fill) {
+         this->cacheFills.remove (requestUserData);
+         delete fill;
+      }
+
+      response.pvName = requestor.request.pvName;
+      response.metaRequest = requestor.request.metaRequest;
+      coalesced->requestors.removeAt (k);
+      archiveAccess->archiveResponse (response);
+   }
+}
+
+//------------------------------------------------------------------------------
+// slot
+void QEArchiveManager::readArchiveAtTimeRequest (const QEArchiveAccess* archiveAccess,
+                                                 const QEArchiveAccess::PVValuesAtTimeRequests& request)
+{
+   QMutexLocker locker (archiveDataMutex);
+
+   const QStringList& pvNames = request.pvNames;
+   QString effectivePvName;
+   QEArchiveAccess::MetaRequests meta;
+
+   // Whilst still initialising, hold the whole request until all the PVs are
+   // known, or until we stop waiting (see clearPending).
+   //
+   if (this->allowPendingRequests) {
+      bool allKnown = true;
+      for (int j = 0; j < pvNames.count () && allKnown; j++) {
+         allKnown = this->containsPvName (pvNames.value (j), effectivePvName, meta);
+      }
+
+      if (!allKnown) {
+         PendingAtTimeRequest pendingRequest;
+         pendingRequest.archiveAccess = archiveAccess;
+         pendingRequest.userRequest = request;
+         this->pendingAtTimeRequests.append (pendingRequest);
+         return;
+      }
+   }
+
+   // Split the request by archive interface manager and key.
+   //
+   typedef QPair<QEArchiveInterfaceManager*, int> Targets;
+   typedef QMap<Targets, AtTimeContext*> TargetContextMaps;
+
+   TargetContextMaps targetContexts;
+   QStringList failedNames;
+
+   for (int j = 0; j < pvNames.count (); j++) {
+      const QString pvName = pvNames.value (j);
+
+      if (!this->containsPvName (pvName, effectivePvName, meta)) {
+         failedNames.append (pvName);
+         continue;
+      }
+
+      const SourceSpec sourceSpec = this->pvNameToSourceLookUp->value (effectivePvName);
+      const int key = selectKey (sourceSpec, request.dateTime, request.dateTime);
+      if (key < 0) {
+         failedNames.append (pvName);
+         continue;
+      }
+
+      AtTimeContext*& context = targetContexts [Targets (sourceSpec.interfaceManager, key)];
+      if (!context) {
+         context = new AtTimeContext ();
+         context->userData = request.userData;
+         context->request.userData = context;
+         context->request.dateTime = request.dateTime;
+      }
+
+      context->userPvNames.append (pvName);
+      context->metas.append (meta);
+      context->request.pvNames.append (effectivePvName);
+   }
+
+   for (TargetContextMaps::const_iterator it = targetContexts.constBegin ();
+        it != targetContexts.constEnd (); ++it) {
+      AtTimeContext* context = it.value ();
+      this->atTimeRequests.insert (context, context);
+      it.key ().first->valuesAtTimeRequest (archiveAccess, it.key ().second,
+                                            context->request);
+   }
+
+   if (!failedNames.isEmpty ()) {
+      QString message = QString ("Archive Manager: %1 of %2 PVs not found in archive or have no matching time overlaps.")
+            .arg (failedNames.count ()).arg (pvNames.count ());
+      this->sendMessage (message, message_types (MESSAGE_TYPE_WARNING));
+   }
+
+   // Always respond to an empty request.
+   //
+   if (!failedNames.isEmpty () || targetContexts.isEmpty ()) {
+      this->sendValuesAtTimeFailures (archiveAccess, request.userData, failedNames);
+   }
+
+   this->resendStatus ();
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveManager::sendValuesAtTimeFailures (const QEArchiveAccess* archiveAccess,
+                                                 QObject* userData,
+                                                 const QStringList& pvNames)
+{
+   if (!archiveAccess) return;   // sanity check
+
+   QEArchiveAccess::PVValuesAtTimeResponses response;
+   response.userData = userData;
+
+   for (int j = 0; j < pvNames.count (); j++) {
+      QEArchiveAccess::PVValueAtTime item;
+      item.pvName = pvNames.value (j);
+      item.isOkay = false;
+      response.values.append (item);
+   }
+
+   archiveAccess->archiveValuesAtTimeResponse (response);
+}
+
 //------------------------------------------------------------------------------
 //
 void QEArchiveManager::processPending ()
@@ -831,6 +1345,16 @@ void QEArchiveManager::processPending ()
          this->pendingRequests.removeAt (j);
       }
    }
+
+   // Values at time requests that are still not fully resolved are re-added
+   // to the pending list by readArchiveAtTimeRequest.
+   //
+   const QList<PendingAtTimeRequest> pendingAtTime = this->pendingAtTimeRequests;
+   this->pendingAtTimeRequests.clear ();
+   for (int j = 0; j < pendingAtTime.count (); j++) {
+      const PendingAtTimeRequest& pendingRequest = pendingAtTime.at (j);
+      this->readArchiveAtTimeRequest (pendingRequest.archiveAccess, pendingRequest.userRequest);
+   }
 }
 
 //------------------------------------------------------------------------------
@@ -866,6 +1390,17 @@ void QEArchiveManager::clearPending ()
    }
 
    this->pendingRequests.clear ();
+
+   // Now allowPendingRequests is false, any unknown PVs are responded to
+   // as failures.
+   //
+   const QList<PendingAtTimeRequest> pendingAtTime = this->pendingAtTimeRequests;
+   this->pendingAtTimeRequests.clear ();
+   for (int j = 0; j < pendingAtTime.count (); j++) {
+      const PendingAtTimeRequest& pendingRequest = pendingAtTime.at (j);
+      this->readArchiveAtTimeRequest (pendingRequest.archiveAccess, pendingRequest.userRequest);
+   }
+
    this->resendStatus ();
 }
 
@@ -901,12 +1436,16 @@ void QEArchiveManager::processPvChannel (QEArchiveInterfaceManager* interfaceMan
       keyTimeSpec.endTime = this->lastReadTime;
    }
 
-   if (!this->pvNameToSourceLookUp->contains (pvChannel.pvName)) {
+   // The checks are made against the refresh look up, i.e. the names
+   // received since the (re-)interrogation started.
+   //
+   if (!this->refreshLookUp->contains (pvChannel.pvName)) {
       // First instance of this PV Name
       //
       sourceSpec.interfaceManager = interfaceManager;
       sourceSpec.insert (keyTimeSpec);
-      this->pvNameToSourceLookUp->insert (pvChannel.pvName, sourceSpec);
+      this->refreshLookUp->insert (pvChannel.pvName, sourceSpec);
+      this->updateLookUp (pvChannel.pvName, interfaceManager, keyTimeSpec);
       return;
    }
 
@@ -914,7 +1453,7 @@ void QEArchiveManager::processPvChannel (QEArchiveInterfaceManager* interfaceMan
    // To be acceptable, this must be from the same archive host, i.e. the same
    // archive interface, i.e. same archive interface manager.
    //
-   sourceSpec = this->pvNameToSourceLookUp->value (pvChannel.pvName);
+   sourceSpec = this->refreshLookUp->value (pvChannel.pvName);
    if (interfaceManager != sourceSpec.interfaceManager) {
       message = QString ("PV %1 hosted on multiple interfaces. Primary %2, Secondary %3")
             .arg (pvChannel.pvName)
@@ -942,7 +1481,208 @@ void QEArchiveManager::processPvChannel (QEArchiveInterfaceManager* interfaceMan
    // QHash: If there is already an item with the key, that item's
    // value is replaced with value.
    //
-   this->pvNameToSourceLookUp->insert (pvChannel.pvName, sourceSpec);
+   this->refreshLookUp->insert (pvChannel.pvName, sourceSpec);
+   this->updateLookUp (pvChannel.pvName, interfaceManager, keyTimeSpec);
+}
+
+//------------------------------------------------------------------------------
+// Makes the received PV name info available straight away. Note: keys no
+// longer archived are only removed when the archiver has responded in full.
+//
+void QEArchiveManager::updateLookUp (const QString& pvName,
+                                     QEArchiveInterfaceManager* interfaceManager,
+                                     const KeyTimeSpec& keyTimeSpec)
+{
+   // NOTE: no lock here - caller's responsibility.
+
+   PVNameToSourceSpecLookUp::iterator it = this->pvNameToSourceLookUp->find (pvName);
+   if (it == this->pvNameToSourceLookUp->end ()) {
+      SourceSpec sourceSpec;
+      sourceSpec.interfaceManager = interfaceManager;
+      sourceSpec.insert (keyTimeSpec);
+      this->pvNameToSourceLookUp->insert (pvName, sourceSpec);
+
+   } else if (it->interfaceManager == interfaceManager) {
+      it->update (keyTimeSpec);
+
+   } else {
+      // The PV has moved archiver since the last interrogation.
+      //
+      SourceSpec sourceSpec;
+      sourceSpec.interfaceManager = interfaceManager;
+      sourceSpec.insert (keyTimeSpec);
+      *it = sourceSpec;
+   }
+}
+
+//------------------------------------------------------------------------------
+// slot - from archive interface manager
+//
+void QEArchiveManager::aimPvNamesComplete (QEArchiveInterfaceManager* interfaceManager,
+                                           const bool isSuccess)
+{
+   bool saveRequired = false;
+   {
+      QMutexLocker locker (archiveDataMutex);
+
+      if (!this->refreshing.contains (interfaceManager)) return;  // not expected
+      this->refreshing.remove (interfaceManager);
+
+      // Only remove PVs no longer archived if we have the full picture.
+      //
+      if (isSuccess) {
+         PVNameToSourceSpecLookUp::iterator it = this->pvNameToSourceLookUp->begin ();
+         while (it != this->pvNameToSourceLookUp->end ()) {
+            if ((it->interfaceManager == interfaceManager) &&
+                !this->refreshLookUp->contains (it.key ())) {
+               it = this->pvNameToSourceLookUp->erase (it);
+            } else {
+               ++it;
+            }
+         }
+         this->isRefreshOkay = true;
+      }
+
+      // The refresh look up is definitive for this archiver, e.g. it excludes
+      // any keys no longer in use.
+      //
+      PVNameToSourceSpecLookUp::iterator it = this->refreshLookUp->begin ();
+      while (it != this->refreshLookUp->end ()) {
+         if (it->interfaceManager == interfaceManager) {
+            this->pvNameToSourceLookUp->insert (it.key (), it.value ());
+            it = this->refreshLookUp->erase (it);
+         } else {
+            ++it;
+         }
+      }
+
+      saveRequired = this->refreshing.isEmpty () && this->isRefreshOkay;
+   }
+
+   // Lastly, once all archivers have responded, save the look up.
+   //
+   if (saveRequired) {
+      this->saveNameIndex ();
+   }
+
+   this->scheduleNameSearchRebuild ();
+   this->resendStatus ();
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveManager::loadNameIndex ()
+{
+   if (this->nameIndexFilename.isEmpty ()) return;
+
+   QEArchiveNameIndex index (this->nameIndexFilename);
+   if (!index.open ()) return;
+
+   QMutexLocker locker (archiveDataMutex);
+
+   // Archive names and paths are few, so cache their indices.
+   //
+   QHash<QString, int> archiveNameIndices;
+   QHash<QString, int> pathIndices;
+
+   // The records are in PV name order, with all the keys for a PV together.
+   // This allows a hinted insert at the end of the (sorted) map.
+   //
+   PVNameToSourceSpecLookUp* lookUp = this->pvNameToSourceLookUp;
+   QString pvName;
+   SourceSpec sourceSpec;
+   bool isPending = false;
+
+   const int number = index.count ();
+   for (int j = 0; j < number; j++) {
+      QEArchiveNameIndex::Record record;
+      if (!index.getRecord (j, record)) continue;
+
+      QEArchiveInterfaceManager* aim =
+            this->archiveInterfaceManagerList.value (record.instance, NULL);
+      if (!aim) continue;
+
+      if (!isPending || (record.pvName != pvName)) {
+         if (isPending && !lookUp->contains (pvName)) {
+            lookUp->insert (lookUp->constEnd (), pvName, sourceSpec);
+         }
+         pvName = record.pvName;
+         sourceSpec = SourceSpec ();
+         sourceSpec.interfaceManager = aim;
+         isPending = true;
+      }
+
+      if (!archiveNameIndices.contains (record.archiveName)) {
+         archiveNameIndices.insert (record.archiveName,
+                                    QEArchiveManager::getArchiveNameIndex (record.archiveName));
+      }
+      if (!pathIndices.contains (record.path)) {
+         pathIndices.insert (record.path, QEArchiveManager::getPathIndex (record.path));
+      }
+
+      KeyTimeSpec keyTimeSpec;
+      keyTimeSpec.key = record.key;
+      keyTimeSpec.nameIndex = archiveNameIndices.value (record.archiveName);
+      keyTimeSpec.pathIndex = pathIndices.value (record.path);
+      keyTimeSpec.startTime = record.startTime;
+      keyTimeSpec.endTime = record.endTime;
+      sourceSpec.update (keyTimeSpec);
+   }
+
+   if (isPending && !lookUp->contains (pvName)) {
+      lookUp->insert (lookUp->constEnd (), pvName, sourceSpec);
+   }
+
+   this->sendMessage (QString ("Loaded %1 archived PV names from %2")
+                      .arg (lookUp->count ()).arg (this->nameIndexFilename),
+                      message_types (MESSAGE_TYPE_INFO));
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveManager::saveNameIndex ()
+{
+   if (this->nameIndexFilename.isEmpty ()) return;
+
+   // Take a (shallow) copy of the look up. This is only ever modified within
+   // this thread, so we need not hold the lock whilst writing the file.
+   //
+   PVNameToSourceSpecMap lookUp;
+   {
+      QMutexLocker locker (archiveDataMutex);
+      lookUp = *this->pvNameToSourceLookUp;
+   }
+
+   QEArchiveNameIndex index (this->nameIndexFilename);
+   index.beginWrite ();
+
+   for (PVNameToSourceSpecMap::const_iterator it = lookUp.constBegin ();
+        it != lookUp.constEnd (); ++it) {
+      const SourceSpec& sourceSpec = it.value ();
+      if (!sourceSpec.interfaceManager) continue;
+
+      QEArchiveNameIndex::Record record;
+      record.pvName = it.key ();
+      record.instance = sourceSpec.interfaceManager->instance;
+
+      const QList<int> keys = sourceSpec.keys ();
+      for (int k = 0; k < keys.count (); k++) {
+         const KeyTimeSpec keyTimeSpec = sourceSpec.value (keys.value (k));
+
+         record.key = keyTimeSpec.key;
+         record.archiveName = QEArchiveManager::getArchiveNameFromIndex (keyTimeSpec.nameIndex);
+         record.path = QEArchiveManager::getPathFromIndex (keyTimeSpec.pathIndex);
+         record.startTime = keyTimeSpec.startTime;
+         record.endTime = keyTimeSpec.endTime;
+         index.addRecord (record);
+      }
+   }
+
+   if (index.commit ()) {
+      this->sendMessage (QString ("Saved %1 archived PV names to %2")
+                         .arg (lookUp.count ()).arg (this->nameIndexFilename),
+                         message_types (MESSAGE_TYPE_INFO));
+   }
 }
 
 //------------------------------------------------------------------------------
@@ -961,10 +1701,386 @@ void QEArchiveManager::aimPvNamesResponse  (
    // We have had an updaye, process any pending requests.
    //
    this->processPending ();
+   this->scheduleNameSearchRebuild ();
 
    this->resendStatus();
 }
 
+//------------------------------------------------------------------------------
+//
+bool QEArchiveManager::segmentCacheRequest (const QEArchiveAccess* archiveAccess,
+                                            QEArchiveInterfaceManager* interfaceManager,
+                                            const int key,
+                                            const QEArchiveAccess::PVDataRequests& request)
+{
+   // NOTE: no lock here - caller holds archiveDataMutex.
+
+   if (!this->segmentCache || !this->segmentCache->isEnabled ()) return false;
+
+   // Only raw data and data with well defined bins are cachable.
+   //
+   const bool isRaw = (request.how == QEArchiveInterface::Raw);
+   const bool isBinned = isBinnedRequest (request);
+
+   if (!isRaw && !isBinned) return false;
+   if (request.count <= 0) return false;
+
+   const QCaTimeStamp startTime = request.startTime.toTimeStamp ();
+   const QCaTimeStamp endTime = request.endTime.toTimeStamp ();
+   if (endTime <= startTime) return false;
+
+   // We need at least 2 seconds so that the modified request below does
+   // not degenerate into a raw data request.
+   //
+   const qint64 binSize = requestBinSize (request);
+   if (isBinned && (binSize < 2)) return false;
+
+   const qint64 span = QEArchiveSegmentCache::bucketSpan (binSize);
+   const qint64 endSecs = endTime.getSeconds ();
+   const qint64 safeEnd = QCaTimeStamp::currentTime ().getSeconds () - cacheSafetyMargin;
+
+   QEArchiveSegmentCache::Key cacheKey;
+   cacheKey.archiver = QString ("%1#%2").arg (interfaceManager->getUrl ().toString ()).arg (key);
+   cacheKey.pvName = request.pvName;
+   cacheKey.element = request.element;
+   cacheKey.how = int (request.how);
+   cacheKey.binSize = binSize;
+
+   // Gather the leading run of cached buckets.
+   // Subsequent buckets' leading points duplicate previous bucket data.
+   //
+   QCaDataPointList cachedPoints;
+   qint64 bucket = floorDiv (startTime.getSeconds (), span);
+   qint64 fetchStart = bucket * span;
+
+   while ((fetchStart <= endSecs) && (fetchStart + span <= safeEnd)) {
+      cacheKey.bucket = bucket;
+      QCaDataPointList segment;
+      if (!this->segmentCache->read (cacheKey, segment)) break;
+
+      if (cachedPoints.count () == 0) {
+         cachedPoints = segment;
+      } else {
+         const QCaTimeStamp bucketStart = QCaTimeStamp::fromNanoSecs (fetchStart * QCaTimeStamp::nanoSecsPerSec);
+         for (int j = 0; j < segment.count (); j++) {
+            const QCaDataPoint point = segment.value (j);
+            if (point.datetime >= bucketStart) cachedPoints.append (point);
+         }
+      }
+
+      bucket++;
+      fetchStart += span;
+   }
+
+   if (fetchStart > endSecs) {
+      // The cache has it all - respond directly.
+      //
+      QEArchiveAccess::PVDataResponses response;
+      response.userData = request.userData;
+      response.metaRequest = request.metaRequest;
+      response.isSuccess = true;
+      response.pointsList = trimPoints (cachedPoints, startTime, endTime);
+      response.pvName = request.pvName;
+      response.supplementary = "okay";
+      this->sendDataResponse (archiveAccess, response);
+      return true;
+   }
+
+   // Request the remainder, starting at a bucket boundary, so that the whole
+   // buckets may be saved. For binned data we align the end time and adjust the
+   // count so that the archiver uses the same, aligned, bins.
+   //
+   QEArchiveAccess::PVDataRequests fillRequest = request;
+   qint64 fetchEnd = endSecs;
+   fillRequest.startTime = utcDateTime (fetchStart);
+   if (isBinned) {
+      const qint64 bins = (endSecs - fetchStart + binSize) / binSize;
+      fetchEnd = fetchStart + bins * binSize;
+      fillRequest.endTime = utcDateTime (fetchEnd);
+      fillRequest.count = int (bins);
+   }
+
+   CacheFillContext* fill = new CacheFillContext ();
+   fill->userData = request.userData;
+   fill->key = cacheKey;
+   fill->span = span;
+   fill->fetchStart = fetchStart;
+   fill->fetchEnd = fetchEnd;
+   fill->safeEnd = safeEnd;
+
+   // The Channel Access archiver limits the number of raw points returned.
+   //
+   fill->maxPoints = (isRaw && this->archiverType == QEArchiveAccess::CA) ? fillRequest.count : 0;
+   fill->startTime = startTime;
+   fill->endTime = endTime;
+   fill->cachedPoints = cachedPoints;
+
+   fillRequest.userData = fill;
+   this->cacheFills.insert (fill, fill);
+
+   this->issueDataRequest (archiveAccess, interfaceManager, key, fillRequest);
+   return true;
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveManager::segmentCacheResponse (CacheFillContext* fill,
+                                             QEArchiveAccess::PVDataResponses& response)
+{
+   response.userData = fill->userData;
+   if (!response.isSuccess) return;
+
+   const QCaDataPointList fetched = response.pointsList;
+   const int n = fetched.count ();
+   const bool isTruncated = (fill->maxPoints > 0) && (n >= fill->maxPoints);
+
+   if (!isTruncated) {
+      // Save each whole, immutable, bucket.
+      //
+      QEArchiveSegmentCache::Key cacheKey = fill->key;
+      qint64 bucketStart = fill->fetchStart;
+      int index = 0;
+
+      while ((bucketStart + fill->span <= fill->safeEnd) &&
+             (bucketStart + fill->span <= fill->fetchEnd)) {
+
+         const qint64 bucketEnd = bucketStart + fill->span;
+         const QCaTimeStamp startStamp = QCaTimeStamp::fromNanoSecs (bucketStart * QCaTimeStamp::nanoSecsPerSec);
+         const QCaTimeStamp endStamp = QCaTimeStamp::fromNanoSecs (bucketEnd * QCaTimeStamp::nanoSecsPerSec);
+
+         while ((index < n) && (fetched.value (index).datetime < startStamp)) index++;
+
+         // Include the leading point (if any) - this provides the value at the
+         // start of the bucket.
+         //
+         QCaDataPointList segment;
+         if (index > 0) segment.append (fetched.value (index - 1));
+
+         while ((index < n) && (fetched.value (index).datetime < endStamp)) {
+            segment.append (fetched.value (index));
+            index++;
+         }
+
+         cacheKey.bucket = floorDiv (bucketStart, fill->span);
+         this->segmentCache->write (cacheKey, segment);
+         bucketStart = bucketEnd;
+      }
+   }
+
+   // Merge with the previously cached data, if any. Fetched points prior to the
+   // fetch start time are already included in the cached points.
+   //
+   QCaDataPointList merged;
+   if (fill->cachedPoints.count () > 0) {
+      const QCaTimeStamp fetchStamp = QCaTimeStamp::fromNanoSecs (fill->fetchStart * QCaTimeStamp::nanoSecsPerSec);
+      merged = fill->cachedPoints;
+      merged.reserve (merged.count () + n);
+      for (int j = 0; j < n; j++) {
+         const QCaDataPoint point = fetched.value (j);
+         if (point.datetime >= fetchStamp) merged.append (point);
+      }
+   } else {
+      merged = fetched;
+   }
+
+   response.pointsList = trimPoints (merged, fill->startTime, fill->endTime);
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveManager::issueDataRequest (const QEArchiveAccess* archiveAccess,
+                                         QEArchiveInterfaceManager* interfaceManager,
+                                         const int key,
+                                         const QEArchiveAccess::PVDataRequests& request)
+{
+   // Can this request be merged with an existing queued or active request?
+   //
+   QMultiHash<QString, CoalescedRequest*>::const_iterator it;
+   for (it = this->coalescedByName.constFind (request.pvName);
+        (it != this->coalescedByName.constEnd ()) && (it.key () == request.pvName); ++it) {
+
+      CoalescedRequest* coalesced = it.value ();
+      if ((coalesced->interfaceManager == interfaceManager) && (coalesced->key == key) &&
+          this->mergeRequest (coalesced, archiveAccess, request)) {
+         return;
+      }
+   }
+
+   // No - create a new coalesced request and queue it.
+   // Raw requests to the Channel Access archiver are limited by count, so
+   // we only merge identical requests.
+   //
+   const bool isRaw = (request.how == QEArchiveInterface::Raw);
+
+   CoalescedRequest* coalesced = new CoalescedRequest ();
+   coalesced->interfaceManager = interfaceManager;
+   coalesced->key = key;
+   coalesced->binSize = requestBinSize (request);
+   coalesced->isRangeMergable = (coalesced->binSize >= 2) ||
+                                (isRaw && (this->archiverType != QEArchiveAccess::CA));
+   coalesced->isActive = false;
+   coalesced->startTime = request.startTime.toTimeStamp ();
+   coalesced->endTime = request.endTime.toTimeStamp ();
+   coalesced->request = request;
+   coalesced->request.userData = coalesced;
+
+   CoalescedRequest::Requestor requestor;
+   requestor.archiveAccess = archiveAccess;
+   requestor.request = request;
+   coalesced->requestors.append (requestor);
+
+   this->queuedRequests.append (coalesced);
+   this->coalescedByName.insert (request.pvName, coalesced);
+
+   if (!this->isIssueScheduled) {
+      this->isIssueScheduled = true;
+      QTimer::singleShot (coalesceDelay, this, SLOT (issueRequests ()));
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+bool QEArchiveManager::mergeRequest (CoalescedRequest* coalesced,
+                                     const QEArchiveAccess* archiveAccess,
+                                     const QEArchiveAccess::PVDataRequests& request)
+{
+   const QEArchiveAccess::PVDataRequests& current = coalesced->request;
+
+   if ((request.how != current.how) || (request.element != current.element)) return false;
+
+   const QCaTimeStamp startTime = request.startTime.toTimeStamp ();
+   const QCaTimeStamp endTime = request.endTime.toTimeStamp ();
+
+   if (!coalesced->isRangeMergable) {
+      const bool isIdentical = (request.count == current.count) &&
+                               (startTime == coalesced->startTime) &&
+                               (endTime == coalesced->endTime);
+      if (!isIdentical) return false;
+
+   } else if (requestBinSize (request) != coalesced->binSize) {
+      return false;
+
+   } else if (coalesced->isActive) {
+      // Already sent - can only merge if wholly contained.
+      //
+      if ((startTime < coalesced->startTime) || (endTime > coalesced->endTime)) return false;
+
+   } else {
+      // Still queued - can merge if overlapping or adjacent.
+      //
+      if ((startTime > coalesced->endTime) || (endTime < coalesced->startTime)) return false;
+
+      const QCaTimeStamp unionStart = MIN (startTime, coalesced->startTime);
+      QCaTimeStamp unionEnd = MAX (endTime, coalesced->endTime);
+
+      if (coalesced->binSize > 0) {
+         // Preserve the bin size, i.e. request a whole number of bins.
+         //
+         const qint64 binNanoSecs = coalesced->binSize * QCaTimeStamp::nanoSecsPerSec;
+         const qint64 bins = (unionStart.nanoSecsTo (unionEnd) + binNanoSecs - 1) / binNanoSecs;
+         unionEnd = unionStart.addNanoSecs (bins * binNanoSecs);
+         coalesced->request.count = int (bins);
+      }
+
+      coalesced->startTime = unionStart;
+      coalesced->endTime = unionEnd;
+      coalesced->request.startTime = utcDateTime (unionStart);
+      coalesced->request.endTime = utcDateTime (unionEnd);
+   }
+
+   CoalescedRequest::Requestor requestor;
+   requestor.archiveAccess = archiveAccess;
+   requestor.request = request;
+   coalesced->requestors.append (requestor);
+   return true;
+}
+
+//------------------------------------------------------------------------------
+// slot
+void QEArchiveManager::issueRequests ()
+{
+   this->isIssueScheduled = false;
+
+   int j = 0;
+   while (j < this->queuedRequests.count ()) {
+      CoalescedRequest* coalesced = this->queuedRequests.value (j);
+
+      int& active = this->activeCounts [coalesced->interfaceManager];
+      if (active >= this->maxConcurrentRequests) {
+         j++;   // leave on the queue - try next
+         continue;
+      }
+
+      active++;
+      this->queuedRequests.removeAt (j);
+      coalesced->isActive = true;
+      this->activeRequests.insert (coalesced, coalesced);
+
+      // The archive access object is passed back in the response, but we
+      // use those in the requestors list.
+      //
+      coalesced->interfaceManager->dataRequest (coalesced->requestors.first ().archiveAccess,
+                                                coalesced->key, coalesced->request);
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveManager::processDataResponse (const QEArchiveAccess* archiveAccess,
+                                            const QEArchiveAccess::PVDataResponses& response)
+{
+   // Was this a segment cache fill request?
+   // Note: we look up the userData as opposed to dynamic casting it, as a
+   // user's userData object may no longer exist.
+   //
+   CacheFillContext* fill = this->cacheFills.take (response.userData);
+   if (fill) {
+      QEArchiveAccess::PVDataResponses userResponse = response;
+      this->segmentCacheResponse (fill, userResponse);
+      delete fill;
+      this->sendDataResponse (archiveAccess, userResponse);
+   } else {
+      // We just take the response and pass it back to the requestor.
+      //
+      this->sendDataResponse (archiveAccess, response);
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveManager::sendDataResponse (const QEArchiveAccess* archiveAccess,
+                                         const QEArchiveAccess::PVDataResponses& response)
+{
+   if (!archiveAccess) return;   // sanity check
+
+   const bool isSeverity = response.metaRequest == QEArchiveAccess::mrSeverity;
+   const bool isStatus   = response.metaRequest == QEArchiveAccess::mrStatus;
+
+   // Was this a meta data request?
+   //
+   if (isSeverity || isStatus) {
+      // In the data points lits, replace the VALue with the severity or status as requested.
+      //
+      QCaDataPointList metaPointsList;
+      const int n = response.pointsList.count();
+      metaPointsList.reserve (n);
+      for (int j = 0; j < n; j++) {
+         QCaDataPoint point = response.pointsList.value (j);
+         point.value = isSeverity ? point.alarm.getSeverity() : point.alarm.getStatus();
+         point.alarm = QCaAlarmInfo ();   // clear the alrm info so that always displayable.
+         metaPointsList.append (point);
+      }
+
+      QEArchiveAccess::PVDataResponses metaResponse;
+      metaResponse = response;
+      metaResponse.pointsList = metaPointsList;
+      archiveAccess->archiveResponse (metaResponse);
+   } else {
+      // Just return as is.
+      archiveAccess->archiveResponse (response);
+   }
+}
+
 //------------------------------------------------------------------------------
 // slot - from archive interface manager
 //
@@ -972,38 +2088,91 @@ void QEArchiveManager::aimDataResponse (
       const QEArchiveAccess* archiveAccess,
       const QEArchiveAccess::PVDataResponses& response)
 {
-   // We just take the response and pass it back to the requestor.
-   //
-   if (archiveAccess)  { // sanity check
+   CoalescedRequest* coalesced = this->activeRequests.take (response.userData);
+   if (coalesced) {
+      this->coalescedByName.remove (coalesced->request.pvName, coalesced);
 
-      const bool isSeverity = response.metaRequest == QEArchiveAccess::mrSeverity;
-      const bool isStatus   = response.metaRequest == QEArchiveAccess::mrStatus;
+      int& active = this->activeCounts [coalesced->interfaceManager];
+      if (active > 0) active--;
 
-      // Was this a meta data request?
+      // Fan out the response to each requestor. Where requests were merged,
+      // each requestor only gets the data for its own time frame. Note: some
+      // of the merged requestors may since have been cancelled.
       //
-      if (isSeverity || isStatus) {
-         // In the data points lits, replace the VALue with the severity or status as requested.
-         //
-         QCaDataPointList metaPointsList;
-         const int n = response.pointsList.count();
-         metaPointsList.reserve (n);
-         for (int j = 0; j < n; j++) {
-            QCaDataPoint point = response.pointsList.value (j);
-            point.value = isSeverity ? point.alarm.getSeverity() : point.alarm.getStatus();
-            point.alarm = QCaAlarmInfo ();   // clear the alrm info so that always displayable.
-            metaPointsList.append (point);
+      for (int j = 0; j < coalesced->requestors.count (); j++) {
+         const CoalescedRequest::Requestor& requestor = coalesced->requestors.at (j);
+         const QCaTimeStamp startTime = requestor.request.startTime.toTimeStamp ();
+         const QCaTimeStamp endTime = requestor.request.endTime.toTimeStamp ();
+         const bool isMerged = !((startTime == coalesced->startTime) &&
+                                 (endTime == coalesced->endTime));
+
+         QEArchiveAccess::PVDataResponses userResponse = response;
+         userResponse.userData = requestor.request.userData;
+         userResponse.metaRequest = requestor.request.metaRequest;
+         if (isMerged && userResponse.isSuccess) {
+            userResponse.pointsList = trimPoints (response.pointsList, startTime, endTime);
          }
+         this->processDataResponse (requestor.archiveAccess, userResponse);
+      }
+
+      delete coalesced;
 
-         QEArchiveAccess::PVDataResponses metaResponse;
-         metaResponse = response;
-         metaResponse.pointsList = metaPointsList;
-         archiveAccess->archiveResponse (metaResponse);
+      // There is now room for another request.
+      //
+      this->issueRequests ();
+   } else {
+      this->processDataResponse (archiveAccess, response);
+   }
+
+   this->resendStatus ();
+}
+
+//------------------------------------------------------------------------------
+// slot - from archive interface manager
+//
+void QEArchiveManager::aimValuesAtTimeResponse (
+      const QEArchiveAccess* archiveAccess,
+      const QEArchiveAccess::PVValuesAtTimeResponses& response)
+{
+   AtTimeContext* context = this->atTimeRequests.take (response.userData);
+   if (!context) {
+      DEBUG << "unexpected values at time response";
+      return;
+   }
+
+   // The response values are in effective PV name request order. Map back
+   // to the user's PV names and convert any meta data requests.
+   //
+   QEArchiveAccess::PVValuesAtTimeResponses userResponse;
+   userResponse.userData = context->userData;
+
+   const int n = context->userPvNames.count ();
+   for (int j = 0; j < n; j++) {
+      QEArchiveAccess::PVValueAtTime item;
+      if (j < response.values.count ()) {
+         item = response.values.at (j);
       } else {
-         // Just return as is.
-         archiveAccess->archiveResponse (response);
+         item.isOkay = false;
+      }
+      item.pvName = context->userPvNames.value (j);
+
+      const QEArchiveAccess::MetaRequests meta = context->metas.value (j);
+      const bool isSeverity = meta == QEArchiveAccess::mrSeverity;
+      const bool isStatus   = meta == QEArchiveAccess::mrStatus;
+
+      if (item.isOkay && (isSeverity || isStatus)) {
+         item.point.value = isSeverity ? item.point.alarm.getSeverity() : item.point.alarm.getStatus();
+         item.point.alarm = QCaAlarmInfo ();
       }
+
+      userResponse.values.append (item);
    }
 
+   delete context;
+
+   if (archiveAccess)   // sanity check
+      archiveAccess->archiveValuesAtTimeResponse (userResponse);
+
    this->resendStatus ();
 }
 
@@ -30,8 +30,12 @@
 #define QE_ARCHIVE_MANAGER_H
 
 #include <QDateTime>
+#include <QHash>
 #include <QList>
+#include <QMultiHash>
 #include <QObject>
+#include <QSet>
+#include <QSharedPointer>
 #include <QString>
 #include <QStringList>
 #include <QTimer>
@@ -40,9 +44,12 @@
 #include <QCaDateTime.h>
 #include <QEArchiveAccess.h>
 #include <QEArchiveInterface.h>
+#include <QEPvNameSearch.h>
 #include <UserMessage.h>
 
 class QEArchiveInterfaceManager;        // differed
+class QEArchiveSegmentCache;            // differed
+struct KeyTimeSpec;                     // differed
 
 /// Archive Manager manages access to the archives, and provides a thick binding
 /// around the Archive Interface class. It's main function is to provide a PV Name
@@ -93,13 +100,74 @@ private:
    int getNumberPVs () const;
    QString getPattern () const;
    QStringList getAllPvNames () const;   
+   QSharedPointer<const QEPvNameSearch> getPvNameSearch () const;
    bool getArchivePvInformation (const QString& pvName,
                                  QString& effectivePvName,
                                  QEArchiveAccess::ArchiverPvInfoLists& data);
    void clear ();
+   void beginRefresh ();
    void resendStatus ();
    void processPending ();
 
+   // Passes the response back to the requestor, converting meta data requests
+   // (i.e. severity and status) as required.
+   //
+   void sendDataResponse (const QEArchiveAccess* archiveAccess,
+                          const QEArchiveAccess::PVDataResponses& response);
+
+   // Satisfies the request, in part or in full, from the segment cache.
+   // Returns true if the request has been handled, i.e. either responded to
+   // directly or a modified request sent on to the interface manager.
+   // Returns false if the request is not cachable.
+   //
+   bool segmentCacheRequest (const QEArchiveAccess* archiveAccess,
+                             QEArchiveInterfaceManager* interfaceManager,
+                             const int key,
+                             const QEArchiveAccess::PVDataRequests& request);
+
+   // Stores the immutable buckets of a cache fill response, and merges in
+   // the previously cached data.
+   //
+   class CacheFillContext;
+   void segmentCacheResponse (CacheFillContext* fill,
+                              QEArchiveAccess::PVDataResponses& response);
+
+   // All archiver data requests go via issueDataRequest. Requests are held
+   // briefly, and also while the archiver has maxConcurrentRequests active
+   // requests, during which time identical or overlapping requests are merged.
+   // Requests wholly contained within an active request are also merged. On
+   // response, each requestor is sent the data for its own time frame.
+   //
+   class CoalescedRequest;
+   void issueDataRequest (const QEArchiveAccess* archiveAccess,
+                          QEArchiveInterfaceManager* interfaceManager,
+                          const int key,
+                          const QEArchiveAccess::PVDataRequests& request);
+
+   bool mergeRequest (CoalescedRequest* coalesced,
+                      const QEArchiveAccess* archiveAccess,
+                      const QEArchiveAccess::PVDataRequests& request);
+
+   // Removes, and sends a failed response to, each of the coalesced request's
+   // requestors with the given archive access object and userData.
+   //
+   void cancelRequestors (CoalescedRequest* coalesced,
+                          const QEArchiveAccess* archiveAccess,
+                          QObject* userData);
+
+   // Handles a response for a single requestor.
+   //
+   void processDataResponse (const QEArchiveAccess* archiveAccess,
+                             const QEArchiveAccess::PVDataResponses& response);
+
+   // Values at time requests are split per archive interface manager/key.
+   // The context object is used as the userData of each split request.
+   //
+   class AtTimeContext;
+   void sendValuesAtTimeFailures (const QEArchiveAccess* archiveAccess,
+                                  QObject* userData,
+                                  const QStringList& pvNames);
+
    // Checks if the specified PV is archived. This is a smart check:
    // a) it removes any protocol qualifier (e.g. ca://); and
    // b) takes care of the {record name} and {record namer}.VAL ambiguity.
@@ -118,6 +186,22 @@ private:
                           const QEArchiveInterface::Archive archive,
                           const QEArchiveInterface::PVName pvChannel);
 
+   // Updates the main look up with newly received PV name info.
+   //
+   void updateLookUp (const QString& pvName,
+                      QEArchiveInterfaceManager* interfaceManager,
+                      const KeyTimeSpec& keyTimeSpec);
+
+   // Load/save the PV name index file, which allows the look up to be
+   // populated at start up without waiting for the archivers to respond.
+   //
+   void loadNameIndex ();
+   void saveNameIndex ();
+
+   // Schedules a (debounced) rebuild of the shared PV name search index.
+   //
+   void scheduleNameSearchRebuild ();
+
    const QEArchiveAccess::ArchiverTypes archiverType;
    QString pattern;
    bool allowPendingRequests;
@@ -131,6 +215,23 @@ private:
    class PVNameToSourceSpecLookUp;
    PVNameToSourceSpecLookUp* pvNameToSourceLookUp;
 
+   // The look up is refreshed incrementally. Whilst archivers are being
+   // (re-)interrogated, the PV names received are accumulated in the refresh
+   // look up. New PV names are also added to the main look up straight away.
+   // Once an archiver has responded in full, the main look up is reconciled
+   // with the refresh look up for that archiver.
+   //
+   PVNameToSourceSpecLookUp* refreshLookUp;
+   QSet<const QEArchiveInterfaceManager*> refreshing;
+   bool isRefreshOkay;
+   QString nameIndexFilename;
+
+   // Indexed search of all PV names. This is built within this thread, and
+   // shared (read only) with all QEArchiveAccess users.
+   //
+   QSharedPointer<const QEPvNameSearch> pvNameSearch;
+   bool isNameSearchRebuildScheduled;
+
    // Hold a set (list) of requests awaiting completion of the initial
    // data retrieval from the various archivers.
    //
@@ -142,6 +243,31 @@ private:
    typedef QList<PendingRequest> PVDataRequestLists;
    PVDataRequestLists pendingRequests;
 
+   struct PendingAtTimeRequest {
+      const QEArchiveAccess* archiveAccess;
+      QEArchiveAccess::PVValuesAtTimeRequests userRequest;
+   };
+
+   QList<PendingAtTimeRequest> pendingAtTimeRequests;
+   QHash<const QObject*, AtTimeContext*> atTimeRequests;
+
+   // Persistent cache of retrieved archive data, and the set of outstanding
+   // requests issued to fill the cache, keyed by the substituted userData.
+   //
+   QEArchiveSegmentCache* segmentCache;
+   QHash<const QObject*, CacheFillContext*> cacheFills;
+
+   // Coalesced requests - queued and active.
+   //
+   typedef QHash<const QEArchiveInterfaceManager*, int> ActiveCounts;
+
+   int maxConcurrentRequests;                             // per archiver
+   bool isIssueScheduled;
+   QList<CoalescedRequest*> queuedRequests;               // in order
+   QMultiHash<QString, CoalescedRequest*> coalescedByName;
+   QHash<const QObject*, CoalescedRequest*> activeRequests;
+   ActiveCounts activeCounts;
+
 signals:
    // Signals to archiverAccess objects when the responses are ready
    //
@@ -156,6 +282,10 @@ private slots:
    void archiveStatusRequest ();
    void readArchiveRequest (const QEArchiveAccess* archiveAccess,  // context
                             const QEArchiveAccess::PVDataRequests& request);
+   void readArchiveAtTimeRequest (const QEArchiveAccess* archiveAccess,  // context
+                                  const QEArchiveAccess::PVValuesAtTimeRequests& request);
+   void cancelReadArchiveRequest (const QEArchiveAccess* archiveAccess,  // context
+                                  const QEArchiveAccess::PVDataRequests& request);
 
 
    // From the approprate archive interface manager
@@ -165,9 +295,15 @@ private slots:
                              const QEArchiveInterface::Archive archive,
                              const QEArchiveInterface::PVNameList& pvNameList);
 
+   void aimPvNamesComplete  (QEArchiveInterfaceManager* interfaceManager,
+                             const bool isSuccess);
+
    void aimDataResponse (const QEArchiveAccess* archiveAccess,
                          const QEArchiveAccess::PVDataResponses& response);
 
+   void aimValuesAtTimeResponse (const QEArchiveAccess* archiveAccess,
+                                 const QEArchiveAccess::PVValuesAtTimeResponses& response);
+
    // Internal slots
    //
    // This function connects the specified the archive(s). The format of the string is
@@ -189,6 +325,14 @@ private slots:
    //
    void clearPending ();
 
+   // Issues queued coalesced requests, subject to the concurrency limit.
+   //
+   void issueRequests ();
+
+   // Rebuilds the shared PV name search index.
+   //
+   void rebuildNameSearch ();
+
    void aboutToQuitHandler ();       // application is about to terminate
    void reInterogateTimeout ();      // daily auto archiver re-interogation
 };
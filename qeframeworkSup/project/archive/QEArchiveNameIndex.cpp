@@ -0,0 +1,304 @@
+/*  QEArchiveNameIndex.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Starritt
+ *  Contact details:
+ *    andrew.starritt@synchrotron.org.au
+ */
+
+#include "QEArchiveNameIndex.h"
+
+#include <string.h>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#define DEBUG  qDebug () << "QEArchiveNameIndex" << __LINE__ <<  __FUNCTION__  << "  "
+
+static const quint32 indexByteOrder = 0x01020304;
+static const quint32 indexVersion = 2;
+
+struct IndexHeader {
+   char magic [4];            // "QEAN"
+   quint32 byteOrder;
+   quint32 version;
+   quint32 recordSize;
+   quint32 recordCount;
+   quint32 namesSize;         // bytes
+   quint32 stringsSize;       // bytes
+};
+
+struct IndexRecord {
+   quint32 nameOffset;        // into the name table
+   quint32 nameLength;        // other offsets are into the string table
+   quint32 archiveOffset;
+   quint32 archiveLength;
+   quint32 pathOffset;
+   quint32 pathLength;
+   qint32 key;
+   quint32 instance;
+   quint32 startTime;
+   quint32 endTime;
+};
+
+//==============================================================================
+//
+QEArchiveNameIndex::QEArchiveNameIndex (const QString& filenameIn) :
+   filename (filenameIn),
+   file (filenameIn)
+{
+   this->map = NULL;
+   this->recordCount = 0;
+   this->records = NULL;
+   this->names = NULL;
+   this->namesSize = 0;
+   this->strings = NULL;
+   this->stringsSize = 0;
+   this->lastNameOffset = 0;
+   this->writeCount = 0;
+}
+
+//------------------------------------------------------------------------------
+//
+QEArchiveNameIndex::~QEArchiveNameIndex ()
+{
+   this->close ();
+}
+
+//------------------------------------------------------------------------------
+//
+QString QEArchiveNameIndex::getFilename () const
+{
+   return this->filename;
+}
+
+//------------------------------------------------------------------------------
+//
+bool QEArchiveNameIndex::open ()
+{
+   this->close ();
+
+   if (!this->file.open (QIODevice::ReadOnly)) return false;
+
+   const qint64 size = this->file.size ();
+   if (size < qint64 (sizeof (IndexHeader))) {
+      this->close ();
+      return false;
+   }
+
+   uchar* data = this->file.map (0, size);
+   if (!data) {
+      this->close ();
+      return false;
+   }
+   this->map = data;
+
+   IndexHeader header;
+   memcpy (&header, data, sizeof (header));
+
+   const qint64 recordBytes = qint64 (header.recordCount) * qint64 (sizeof (IndexRecord));
+
+   const bool isValid = (memcmp (header.magic, "QEAN", 4) == 0) &&
+                        (header.byteOrder == indexByteOrder) &&
+                        (header.version == indexVersion) &&
+                        (header.recordSize == sizeof (IndexRecord)) &&
+                        (size == qint64 (sizeof (IndexHeader)) + recordBytes +
+                                 qint64 (header.namesSize) + qint64 (header.stringsSize));
+   if (!isValid) {
+      DEBUG << "ignoring invalid index file" << this->filename;
+      this->close ();
+      return false;
+   }
+
+   this->recordCount = header.recordCount;
+   this->records = data + sizeof (IndexHeader);
+   this->names = (const char*) (this->records + recordBytes);
+   this->namesSize = header.namesSize;
+   this->strings = this->names + header.namesSize;
+   this->stringsSize = header.stringsSize;
+
+   return true;
+}
+
+//------------------------------------------------------------------------------
+//
+int QEArchiveNameIndex::count () const
+{
+   return int (this->recordCount);
+}
+
+//------------------------------------------------------------------------------
+// static
+QString QEArchiveNameIndex::textAt (const char* table, const quint32 tableSize,
+                                    const quint32 offset, const quint32 length)
+{
+   // Guard against corruption.
+   //
+   if ((qint64 (offset) + qint64 (length)) > qint64 (tableSize)) return QString ();
+   return QString::fromUtf8 (table + offset, int (length));
+}
+
+//------------------------------------------------------------------------------
+//
+bool QEArchiveNameIndex::getRecord (const int index, Record& record) const
+{
+   if (!this->map || (index < 0) || (quint32 (index) >= this->recordCount)) return false;
+
+   IndexRecord item;
+   memcpy (&item, this->records + qint64 (index) * qint64 (sizeof (IndexRecord)), sizeof (item));
+
+   record.pvName = textAt (this->names, this->namesSize, item.nameOffset, item.nameLength);
+   record.instance = int (item.instance);
+   record.key = item.key;
+   record.archiveName = textAt (this->strings, this->stringsSize, item.archiveOffset, item.archiveLength);
+   record.path = textAt (this->strings, this->stringsSize, item.pathOffset, item.pathLength);
+   record.startTime = item.startTime;
+   record.endTime = item.endTime;
+
+   return !record.pvName.isEmpty ();
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveNameIndex::close ()
+{
+   if (this->map) {
+      this->file.unmap ((uchar*) this->map);
+      this->map = NULL;
+   }
+   if (this->file.isOpen ()) this->file.close ();
+
+   this->recordCount = 0;
+   this->records = NULL;
+   this->names = NULL;
+   this->namesSize = 0;
+   this->strings = NULL;
+   this->stringsSize = 0;
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveNameIndex::beginWrite ()
+{
+   this->recordData.clear ();
+   this->nameData.clear ();
+   this->lastName.clear ();
+   this->lastNameOffset = 0;
+   this->stringData.clear ();
+   this->stringOffsets.clear ();
+   this->writeCount = 0;
+}
+
+//------------------------------------------------------------------------------
+// Records are added in PV name order, and all the records for a PV name are
+// consecutive, so we need only compare with the previous name.
+//
+quint32 QEArchiveNameIndex::appendName (const QString& pvName, quint32& length)
+{
+   const QByteArray utf8 = pvName.toUtf8 ();
+   length = utf8.size ();
+
+   if ((this->writeCount > 0) && (pvName == this->lastName)) return this->lastNameOffset;
+
+   if ((this->writeCount > 0) && (pvName < this->lastName)) {
+      DEBUG << "PV name out of order" << pvName;
+   }
+
+   this->lastName = pvName;
+   this->lastNameOffset = this->nameData.size ();
+   this->nameData.append (utf8);
+   return this->lastNameOffset;
+}
+
+//------------------------------------------------------------------------------
+//
+quint32 QEArchiveNameIndex::internString (const QString& text, quint32& length)
+{
+   const QByteArray utf8 = text.toUtf8 ();
+   length = utf8.size ();
+
+   QHash<QString, quint32>::const_iterator it = this->stringOffsets.constFind (text);
+   if (it != this->stringOffsets.constEnd ()) return it.value ();
+
+   const quint32 offset = this->stringData.size ();
+   this->stringData.append (utf8);
+   this->stringOffsets.insert (text, offset);
+   return offset;
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveNameIndex::addRecord (const Record& record)
+{
+   IndexRecord item;
+
+   item.nameOffset = this->appendName (record.pvName, item.nameLength);
+   item.archiveOffset = this->internString (record.archiveName, item.archiveLength);
+   item.pathOffset = this->internString (record.path, item.pathLength);
+   item.key = record.key;
+   item.instance = record.instance;
+   item.startTime = record.startTime;
+   item.endTime = record.endTime;
+
+   this->recordData.append ((const char*) &item, sizeof (item));
+   this->writeCount++;
+}
+
+//------------------------------------------------------------------------------
+//
+bool QEArchiveNameIndex::commit ()
+{
+   IndexHeader header;
+   memcpy (header.magic, "QEAN", 4);
+   header.byteOrder = indexByteOrder;
+   header.version = indexVersion;
+   header.recordSize = sizeof (IndexRecord);
+   header.recordCount = this->writeCount;
+   header.namesSize = this->nameData.size ();
+   header.stringsSize = this->stringData.size ();
+
+   // As per the segment cache, QSaveFile writes to a temporary file and
+   // renames on commit.
+   //
+   QDir ().mkpath (QFileInfo (this->filename).absolutePath ());
+   QSaveFile saveFile (this->filename);
+   if (!saveFile.open (QIODevice::WriteOnly)) {
+      DEBUG << "cannot create" << this->filename;
+      return false;
+   }
+
+   const bool status =
+         (saveFile.write ((const char*) &header, sizeof (header)) == qint64 (sizeof (header))) &&
+         (saveFile.write (this->recordData) == this->recordData.size ()) &&
+         (saveFile.write (this->nameData) == this->nameData.size ()) &&
+         (saveFile.write (this->stringData) == this->stringData.size ()) &&
+         saveFile.commit ();
+
+   if (!status) {
+      DEBUG << "write failed" << this->filename;
+   }
+
+   this->beginWrite ();   // release memory
+   return status;
+}
+
+// end
@@ -0,0 +1,114 @@
+/*  QEArchiveNameIndex.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Starritt
+ *  Contact details:
+ *    andrew.starritt@synchrotron.org.au
+ */
+
+#ifndef QE_ARCHIVE_NAME_INDEX_H
+#define QE_ARCHIVE_NAME_INDEX_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+
+/// The archive name index file provides a persistent copy of the PV name to
+/// archiver/key/time span look up held by the QEArchiveManager. This allows the
+/// archive manager to be usable within milliseconds of start up, as opposed to
+/// waiting for all the archivers to be interrogated. The archivers are still
+/// interrogated in the background and the index file re-written thereafter.
+///
+/// The file comprises a header, fixed size records, one per PV name/archive key
+/// pair, a name table and a string table. Records are written in PV name order.
+/// Each PV name is written once to the name table, which is therefore a single
+/// contiguous sorted table that may be binary searched. Archive names and paths
+/// are interned in the separate string table. Both are referenced by offset.
+/// All items are native endian.
+///
+/// This class is not thread safe - it is only used by the QEArchiveManager
+/// from within the archive manager's own thread.
+///
+class QEArchiveNameIndex {
+public:
+   struct Record {
+      QString pvName;
+      int instance;           // archive interface manager instance
+      int key;
+      QString archiveName;
+      QString path;
+      quint32 startTime;      // seconds past EPICS epoch
+      quint32 endTime;
+   };
+
+   explicit QEArchiveNameIndex (const QString& filename);
+   ~QEArchiveNameIndex ();
+
+   QString getFilename () const;
+
+   // Read - open maps the file and validates the header. Returns false if
+   // the file does not exist or is not valid.
+   //
+   bool open ();
+   int count () const;
+   bool getRecord (const int index, Record& record) const;
+   void close ();
+
+   // Write - records must be added in PV name order. Commit writes the index
+   // file atomically, i.e. readers never see a partial file.
+   //
+   void beginWrite ();
+   void addRecord (const Record& record);
+   bool commit ();
+
+private:
+   quint32 appendName (const QString& pvName, quint32& length);
+   quint32 internString (const QString& text, quint32& length);
+   static QString textAt (const char* table, const quint32 tableSize,
+                          const quint32 offset, const quint32 length);
+
+   const QString filename;
+
+   // Read items.
+   //
+   QFile file;
+   const uchar* map;
+   quint32 recordCount;
+   const uchar* records;
+   const char* names;
+   quint32 namesSize;
+   const char* strings;
+   quint32 stringsSize;
+
+   // Write items.
+   //
+   QByteArray recordData;
+   QByteArray nameData;
+   QString lastName;
+   quint32 lastNameOffset;
+   QByteArray stringData;
+   QHash<QString, quint32> stringOffsets;
+   quint32 writeCount;
+};
+
+#endif  // QE_ARCHIVE_NAME_INDEX_H
@@ -31,12 +31,19 @@
 
 #define DEBUG  qDebug () << "QEArchiveNameSearch::" << __FUNCTION__ << __LINE__
 
+// Number of names added to the list widget per event loop iteration.
+//
+static const int namesPerPage = 2000;
+
 //==============================================================================
 //
 QEArchiveNameSearch::QEArchiveNameSearch (QWidget* parent) : QEFrame (parent)
 {
    this->archiveAccess = new QEArchiveAccess (this);
    this->delayedText = new QEDelayedText (0.25, this);
+   this->pageTimer = new QTimer (this);
+   this->pageTimer->setSingleShot (true);
+   this->pageIndex = 0;
    this->createInternalWidgets ();
 
    // Use standard context menu - start with full option set and remove
@@ -59,6 +66,9 @@ QEArchiveNameSearch::QEArchiveNameSearch (QWidget* parent) : QEFrame (parent)
 
    QObject::connect (this->listWidget, SIGNAL (itemSelectionChanged ()),
                      this,             SLOT   (itemSelectionChanged ()));
+
+   QObject::connect (this->pageTimer, SIGNAL (timeout ()),
+                     this,            SLOT   (addNextPage ()));
 }
 
 //------------------------------------------------------------------------------
@@ -78,7 +88,11 @@ void QEArchiveNameSearch::search ()
 
    searchText = this->lineEdit->text ().trimmed ();
 
+   this->pageTimer->stop ();
+
    if (searchText.isEmpty ()) {
+      this->lastParts.clear ();
+      this->lastMatches.clear ();
       this->listWidget->clear ();
       this->setReadOut ("There are no matching names");
       return;
@@ -92,30 +106,65 @@ void QEArchiveNameSearch::search ()
    parts = QEUtilities::split (searchText);
    matchingNames.clear ();
 
-   QEPvNameSearch findNames (QEArchiveAccess::getAllPvNames ());
+   // This is (re-)built by the archive manager as and when needed, it is not
+   // built per search.
+   //
+   QSharedPointer<const QEPvNameSearch> findNames = QEArchiveAccess::getPvNameSearch ();
 
-   // Use each part to find a set of matching names, and then merge the list.
+   // If the user has just extended each part, e.g. by typing more characters,
+   // the new matches are a subset of the previous matches, so we just need to
+   // filter the previous result.
    //
-   for (int p = 0; p < parts.count (); p++) {
-      QString part = parts.value (p);
-      QStringList partMatches;
+   bool isRefinement = (findNames == this->lastNameSearch) &&
+                       (parts.count () == this->lastParts.count ());
+   for (int p = 0; isRefinement && p < parts.count (); p++) {
+      isRefinement = parts.value (p).contains (this->lastParts.value (p), Qt::CaseInsensitive);
+   }
 
-      // QEArchiveAccess ensures the list is sorted.
-      // Find nay names containing this string (and ignore case as well).
-      //
-      partMatches = findNames.getMatchingPvNames (part, Qt::CaseInsensitive);
+   if (isRefinement) {
+      for (int j = 0; j < this->lastMatches.count (); j++) {
+         const QString& name = this->lastMatches.at (j);
+         for (int p = 0; p < parts.count (); p++) {
+            if (name.contains (parts.at (p), Qt::CaseInsensitive)) {
+               matchingNames.append (name);
+               break;
+            }
+         }
+      }
 
-      // Now nmerge the lists.
+   } else {
+      // Use each part to find a set of matching names, and then merge the list.
       //
-      matchingNames.append (partMatches);
-      matchingNames.sort ();
-      matchingNames.removeDuplicates ();
+      for (int p = 0; p < parts.count (); p++) {
+         QString part = parts.value (p);
+         QStringList partMatches;
+
+         // QEArchiveAccess ensures the list is sorted.
+         // Find nay names containing this string (and ignore case as well).
+         //
+         partMatches = findNames->getMatchingPvNames (part, Qt::CaseInsensitive);
+
+         // Now nmerge the lists.
+         //
+         matchingNames.append (partMatches);
+      }
+
+      if (parts.count () > 1) {
+         matchingNames.sort ();
+         matchingNames.removeDuplicates ();
+      }
    }
 
-   // Use names to populate the list.
+   this->lastNameSearch = findNames;
+   this->lastParts = parts;
+   this->lastMatches = matchingNames;
+
+   // Use names to populate the list. The first page is added immediately,
+   // the rest via the page timer so the GUI remains responsive.
    //
    this->listWidget->clear ();
-   this->listWidget->addItems (matchingNames);
+   this->pageIndex = 0;
+   this->addNextPage ();
 
    int n = matchingNames.count ();
    if (n == 1) {
@@ -125,6 +174,22 @@ void QEArchiveNameSearch::search ()
    }
 }
 
+//------------------------------------------------------------------------------
+// slot
+void QEArchiveNameSearch::addNextPage ()
+{
+   const int n = this->lastMatches.count ();
+   const int number = MIN (namesPerPage, n - this->pageIndex);
+   if (number <= 0) return;
+
+   this->listWidget->addItems (this->lastMatches.mid (this->pageIndex, number));
+   this->pageIndex += number;
+
+   if (this->pageIndex < n) {
+      this->pageTimer->start (0);
+   }
+}
+
 //------------------------------------------------------------------------------
 //
 void QEArchiveNameSearch::setReadOut (const QString& text)
@@ -188,6 +253,9 @@ QStringList QEArchiveNameSearch::getSelectedNames () const
 //
 void QEArchiveNameSearch::clear ()
 {
+   this->pageTimer->stop ();
+   this->lastParts.clear ();
+   this->lastMatches.clear ();
    this->lineEdit->setText ("");
    this->listWidget->clear ();
 }
@@ -33,13 +33,16 @@
 #include <QListWidget>
 #include <QListWidgetItem>
 #include <QPushButton>
+#include <QSharedPointer>
 #include <QString>
 #include <QStringList>
+#include <QTimer>
 #include <QWidget>
 
 #include <QEFrame.h>
 #include <QEFrameworkLibraryGlobal.h>
 #include <QEDelayedText.h>
+#include <QEPvNameSearch.h>
 
 #include <QEArchiveManager.h>
 
@@ -76,6 +79,17 @@ private:
    QEArchiveAccess *archiveAccess;
    QEDelayedText* delayedText;
 
+   // Previous search - used to refine the search as the user types.
+   //
+   QSharedPointer<const QEPvNameSearch> lastNameSearch;
+   QStringList lastParts;
+   QStringList lastMatches;
+
+   // Large result sets are added to the list widget a page at a time.
+   //
+   QTimer* pageTimer;
+   int pageIndex;
+
    // Internal widgets.
    //
    QVBoxLayout *verticalLayout;
@@ -89,6 +103,7 @@ private slots:
    void textEdited (const QString &);
    void searchReturnPressed ();
    void itemSelectionChanged ();
+   void addNextPage ();
 };
 
 #endif  // QE_ARCHIVE_NAME_SEARCH_H
@@ -0,0 +1,412 @@
+/*  QEArchiveSegmentCache.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Starritt
+ *  Contact details:
+ *    andrew.starritt@synchrotron.org.au
+ */
+
+#include "QEArchiveSegmentCache.h"
+
+#include <string.h>
+#include <algorithm>
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QPair>
+#include <QSaveFile>
+#include <QStringList>
+
+#define DEBUG  qDebug () << "QEArchiveSegmentCache" << __LINE__ <<  __FUNCTION__  << "  "
+
+// Bucket sizes. For binned data we aim for a fixed number of bins per segment,
+// which is scale independent. For raw data we have no idea of the data rate,
+// so just go with one hour.
+//
+static const qint64 binsPerSegment = 256;
+static const qint64 rawBucketSpan = 3600;
+
+// Only update the file modification time (i.e. the last use time) if the
+// segment has not been used within this period.
+//
+static const qint64 touchInterval = 60000;   // mSec
+
+static const char* const segmentSuffix = ".qeseg";
+
+static const quint32 segmentByteOrder = 0x01020304;
+static const quint32 segmentVersion = 1;
+
+// File layout: header, key text (padded to a multiple of 8 bytes) and then
+// count records. All items are native endian - the byte order field allows
+// us to reject files written on a different architecture.
+//
+struct SegmentHeader {
+   char magic [4];            // "QEAS"
+   quint32 byteOrder;
+   quint32 version;
+   quint32 recordSize;
+   quint32 keyLength;         // un-padded length
+   quint32 count;
+};
+
+struct SegmentRecord {
+   qint64 nanoSecs;           // since EPICS epoch
+   double value;
+   quint16 status;
+   quint16 severity;
+   quint32 spare;
+};
+
+//------------------------------------------------------------------------------
+//
+static qint64 paddedLength (const qint64 length)
+{
+   return (length + 7) & ~qint64 (7);
+}
+
+//==============================================================================
+//
+QEArchiveSegmentCache::QEArchiveSegmentCache (const QString& directoryIn,
+                                              const qint64 maxSizeIn) :
+   directory (QDir::cleanPath (directoryIn)),
+   maxSize (maxSizeIn)
+{
+   this->indexLoaded = false;
+   this->totalSize = 0;
+}
+
+//------------------------------------------------------------------------------
+//
+QEArchiveSegmentCache::~QEArchiveSegmentCache () { }
+
+//------------------------------------------------------------------------------
+//
+bool QEArchiveSegmentCache::isEnabled () const
+{
+   return (this->maxSize > 0) && !this->directory.isEmpty ();
+}
+
+//------------------------------------------------------------------------------
+//
+QString QEArchiveSegmentCache::getDirectory () const
+{
+   return this->directory;
+}
+
+//------------------------------------------------------------------------------
+//
+qint64 QEArchiveSegmentCache::getTotalSize () const
+{
+   return this->totalSize;
+}
+
+//------------------------------------------------------------------------------
+//
+int QEArchiveSegmentCache::getNumberSegments () const
+{
+   return this->entries.count ();
+}
+
+//------------------------------------------------------------------------------
+// static
+qint64 QEArchiveSegmentCache::bucketSpan (const qint64 binSize)
+{
+   return binSize > 0 ? binSize * binsPerSegment : rawBucketSpan;
+}
+
+//------------------------------------------------------------------------------
+// static
+QString QEArchiveSegmentCache::keyText (const Key& key)
+{
+   return QString ("%1|%2|%3|%4|%5|%6")
+         .arg (key.archiver)
+         .arg (key.pvName)
+         .arg (key.element)
+         .arg (key.how)
+         .arg (key.binSize)
+         .arg (key.bucket);
+}
+
+//------------------------------------------------------------------------------
+// Use two levels so that no single directory gets too large.
+//
+QString QEArchiveSegmentCache::segmentPath (const QString& text) const
+{
+   const QString hash = QString::fromLatin1 (
+            QCryptographicHash::hash (text.toUtf8 (), QCryptographicHash::Sha1).toHex ());
+
+   return this->directory + "/" + hash.left (2) + "/" + hash.mid (2) + segmentSuffix;
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveSegmentCache::loadIndex ()
+{
+   if (this->indexLoaded) return;
+   this->indexLoaded = true;
+
+   this->entries.clear ();
+   this->totalSize = 0;
+
+   QDirIterator iterator (this->directory,
+                          QStringList () << QString ("*") + segmentSuffix,
+                          QDir::Files, QDirIterator::Subdirectories);
+
+   while (iterator.hasNext ()) {
+      iterator.next ();
+      const QFileInfo info = iterator.fileInfo ();
+
+      Entry entry;
+      entry.size = info.size ();
+      entry.lastUsed = info.lastModified ().toMSecsSinceEpoch ();
+      this->entries.insert (info.filePath (), entry);
+      this->totalSize += entry.size;
+   }
+
+   // Another application may have left the cache over size.
+   //
+   this->evict ();
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveSegmentCache::touch (const QString& path)
+{
+   const qint64 now = QDateTime::currentMSecsSinceEpoch ();
+
+   EntryMap::iterator it = this->entries.find (path);
+   if (it == this->entries.end ()) {
+      // Written by another application - add to our index.
+      //
+      Entry entry;
+      entry.size = QFileInfo (path).size ();
+      entry.lastUsed = 0;
+      it = this->entries.insert (path, entry);
+      this->totalSize += entry.size;
+   }
+
+   if (now - it->lastUsed < touchInterval) return;
+   it->lastUsed = now;
+
+   // Persist the last use time for the benefit of other/future applications.
+   //
+#if QT_VERSION >= 0x050A00
+   QFile file (path);
+   if (file.open (QIODevice::ReadWrite)) {
+      file.setFileTime (QDateTime::fromMSecsSinceEpoch (now),
+                        QFileDevice::FileModificationTime);
+      file.close ();
+   }
+#endif
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveSegmentCache::remove (const QString& path)
+{
+   EntryMap::iterator it = this->entries.find (path);
+   if (it != this->entries.end ()) {
+      this->totalSize -= it->size;
+      this->entries.erase (it);
+   }
+   QFile::remove (path);
+}
+
+//------------------------------------------------------------------------------
+// Remove the least recently used segments until we are below 90% of the limit,
+// which avoids evicting on every subsequent write.
+//
+void QEArchiveSegmentCache::evict ()
+{
+   if (this->totalSize <= this->maxSize) return;
+
+   typedef QPair<qint64, QString> UsePair;
+   QList<UsePair> useList;
+   useList.reserve (this->entries.count ());
+
+   for (EntryMap::const_iterator it = this->entries.constBegin ();
+        it != this->entries.constEnd (); ++it) {
+      useList.append (UsePair (it->lastUsed, it.key ()));
+   }
+
+   std::sort (useList.begin (), useList.end ());
+
+   const qint64 target = (this->maxSize / 10) * 9;
+   for (int j = 0; j < useList.count () && this->totalSize > target; j++) {
+      this->remove (useList.at (j).second);
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+bool QEArchiveSegmentCache::read (const Key& key, QCaDataPointList& points)
+{
+   if (!this->isEnabled ()) return false;
+   this->loadIndex ();
+
+   const QString text = QEArchiveSegmentCache::keyText (key);
+   const QString path = this->segmentPath (text);
+
+   QFile file (path);
+   if (!file.open (QIODevice::ReadOnly)) {
+      // Not cached, or evicted by another application.
+      //
+      if (this->entries.contains (path)) this->remove (path);
+      return false;
+   }
+
+   const qint64 size = file.size ();
+   uchar* map = (size >= qint64 (sizeof (SegmentHeader))) ? file.map (0, size) : NULL;
+   if (!map) {
+      file.close ();
+      this->remove (path);
+      return false;
+   }
+
+   SegmentHeader header;
+   memcpy (&header, map, sizeof (header));
+
+   const QByteArray keyBytes = text.toUtf8 ();
+   const qint64 recordOffset = sizeof (SegmentHeader) + paddedLength (header.keyLength);
+
+   bool isValid = (memcmp (header.magic, "QEAS", 4) == 0) &&
+                  (header.byteOrder == segmentByteOrder) &&
+                  (header.version == segmentVersion) &&
+                  (header.recordSize == sizeof (SegmentRecord)) &&
+                  (header.keyLength == quint32 (keyBytes.size ())) &&
+                  (size == recordOffset + qint64 (header.count) * qint64 (sizeof (SegmentRecord)));
+
+   // Guard against hash collisions as well as corruption.
+   //
+   isValid = isValid && (memcmp (map + sizeof (SegmentHeader),
+                                 keyBytes.constData (), keyBytes.size ()) == 0);
+
+   if (isValid) {
+      const uchar* source = map + recordOffset;
+      points.reserve (points.count () + int (header.count));
+
+      for (quint32 j = 0; j < header.count; j++) {
+         SegmentRecord record;
+         memcpy (&record, source, sizeof (record));
+         source += sizeof (record);
+
+         QCaDataPoint point;
+         point.value = record.value;
+         point.datetime = QCaTimeStamp::fromNanoSecs (record.nanoSecs);
+         point.alarm = QCaAlarmInfo (record.status, record.severity);
+         points.append (point);
+      }
+   }
+
+   file.unmap (map);
+   file.close ();
+
+   if (isValid) {
+      this->touch (path);
+   } else {
+      DEBUG << "removing invalid segment" << path;
+      this->remove (path);
+   }
+
+   return isValid;
+}
+
+//------------------------------------------------------------------------------
+//
+bool QEArchiveSegmentCache::write (const Key& key, const QCaDataPointList& points)
+{
+   if (!this->isEnabled ()) return false;
+   this->loadIndex ();
+
+   const QString text = QEArchiveSegmentCache::keyText (key);
+   const QString path = this->segmentPath (text);
+   const QByteArray keyBytes = text.toUtf8 ();
+
+   const int count = points.count ();
+   const qint64 recordOffset = sizeof (SegmentHeader) + paddedLength (keyBytes.size ());
+   const qint64 size = recordOffset + qint64 (count) * qint64 (sizeof (SegmentRecord));
+
+   QByteArray data (int (size), '\0');
+   char* target = data.data ();
+
+   SegmentHeader header;
+   memcpy (header.magic, "QEAS", 4);
+   header.byteOrder = segmentByteOrder;
+   header.version = segmentVersion;
+   header.recordSize = sizeof (SegmentRecord);
+   header.keyLength = keyBytes.size ();
+   header.count = count;
+
+   memcpy (target, &header, sizeof (header));
+   memcpy (target + sizeof (header), keyBytes.constData (), keyBytes.size ());
+   target += recordOffset;
+
+   for (int j = 0; j < count; j++) {
+      const QCaDataPoint point = points.value (j);
+
+      SegmentRecord record;
+      record.nanoSecs = point.datetime.toNanoSecs ();
+      record.value = point.value;
+      record.status = point.alarm.getStatus ();
+      record.severity = point.alarm.getSeverity ();
+      record.spare = 0;
+
+      memcpy (target, &record, sizeof (record));
+      target += sizeof (record);
+   }
+
+   // QSaveFile writes to a temporary file and renames on commit, so readers,
+   // including other applications, never see a partial segment.
+   //
+   QDir ().mkpath (QFileInfo (path).absolutePath ());
+   QSaveFile file (path);
+   if (!file.open (QIODevice::WriteOnly)) {
+      DEBUG << "cannot create" << path;
+      return false;
+   }
+
+   if ((file.write (data) != size) || !file.commit ()) {
+      DEBUG << "write failed" << path;
+      return false;
+   }
+
+   EntryMap::iterator it = this->entries.find (path);
+   if (it != this->entries.end ()) {
+      this->totalSize -= it->size;
+   }
+
+   Entry entry;
+   entry.size = size;
+   entry.lastUsed = QDateTime::currentMSecsSinceEpoch ();
+   this->entries.insert (path, entry);
+   this->totalSize += size;
+
+   this->evict ();
+   return true;
+}
+
+// end
@@ -0,0 +1,111 @@
+/*  QEArchiveSegmentCache.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Starritt
+ *  Contact details:
+ *    andrew.starritt@synchrotron.org.au
+ */
+
+#ifndef QE_ARCHIVE_SEGMENT_CACHE_H
+#define QE_ARCHIVE_SEGMENT_CACHE_H
+
+#include <QtGlobal>
+#include <QHash>
+#include <QString>
+#include <QCaDataPoint.h>
+
+/// The archive segment cache provides a persistent, on-disk, cache of archive
+/// data retrieved by the QEArchiveManager. Time is divided into fixed length
+/// buckets and each segment holds the data for one bucket, keyed by archiver,
+/// PV name, array element, How, bin size and bucket number. The data for a
+/// bucket wholly in the past is deemed immutable, so a segment is never
+/// updated once written, only evicted.
+///
+/// Each segment is a small native-endian binary file, comprising a header, the
+/// key text (used to guard against hash collisions) and fixed size records.
+/// Segments are memory-mapped when read, and written via a QSaveFile so that
+/// several applications may share the same cache directory.
+///
+/// The overall size of the cache is limited. When the limit is exceeded, the
+/// least recently used segments are removed. The last use time is held as the
+/// file modification time, so this survives application restarts.
+///
+/// This class is not thread safe - it is only used by the QEArchiveManager
+/// from within the archive manager's own thread.
+///
+class QEArchiveSegmentCache {
+public:
+   struct Key {
+      QString archiver;     // archiver URL and archive key
+      QString pvName;
+      unsigned int element;
+      int how;              // QEArchiveInterface::How
+      qint64 binSize;       // seconds - 0 for raw data
+      qint64 bucket;        // start of bucket is bucket * span
+   };
+
+   // A maxSize of zero disables the cache.
+   //
+   explicit QEArchiveSegmentCache (const QString& directory, const qint64 maxSize);
+   ~QEArchiveSegmentCache ();
+
+   bool isEnabled () const;
+   QString getDirectory () const;
+   qint64 getTotalSize () const;
+   int getNumberSegments () const;
+
+   // Returns the bucket span (in seconds) for the given bin size.
+   //
+   static qint64 bucketSpan (const qint64 binSize);
+
+   // Reads the segment, appending the points to the given list.
+   // Returns true if the segment was found and is valid.
+   //
+   bool read (const Key& key, QCaDataPointList& points);
+
+   // Writes the segment. The points may include one leading point prior to the
+   // start of the bucket, which provides the value at the start of the bucket.
+   //
+   bool write (const Key& key, const QCaDataPointList& points);
+
+private:
+   struct Entry {
+      qint64 size;
+      qint64 lastUsed;      // mSec since Unix epoch
+   };
+
+   typedef QHash<QString, Entry> EntryMap;    // keyed by segment path name
+
+   static QString keyText (const Key& key);
+   QString segmentPath (const QString& text) const;
+   void loadIndex ();
+   void touch (const QString& path);
+   void remove (const QString& path);
+   void evict ();
+
+   const QString directory;
+   const qint64 maxSize;
+   bool indexLoaded;
+   EntryMap entries;
+   qint64 totalSize;
+};
+
+#endif  // QE_ARCHIVE_SEGMENT_CACHE_H
@@ -251,6 +251,9 @@ QEArchiveStatus::QEArchiveStatus (QWidget* parent) : QEGroupBox (parent)
       case QEArchiveAccess::ARCHAPPL:
          this->setTitle (" Archive Appliance Host Status ");
          break;
+      case QEArchiveAccess::PBFILES:
+         this->setTitle (" Archive Appliance Storage Status ");
+         break;
       case QEArchiveAccess::Error:
          this->setTitle (" Archive Status Summary ");
          break;
@@ -316,6 +319,19 @@ void QEArchiveStatus::archiveStatus (const QEArchiveAccess::StatusList& statusLi
          row->hostNamePort->setText (QString ("%1:%2 ").arg (state.hostName).arg (state.portNumber));
          row->endPoint->setText (QString("%1 ").arg (state.endPoint));
          row->state->setText (QEUtilities::enumToString (QEArchiveInterface::staticMetaObject, QString("States"), state.state));
+
+         // Retrieval statistics available as a tool tip.
+         //
+         const QEArchiveInterface::Statistics& stats = state.statistics;
+         const qint64 jobs = MAX (stats.decodeJobs, 1);
+         row->state->setToolTip (
+                  QString (" Received: %1 MB \n Decoded: %2 responses \n"
+                           " Decode time: %3 s (avg %4 mS) \n Avg queue delay: %5 mS ")
+                  .arg (double (stats.bytesReceived) / 1.0e6, 0, 'f', 1)
+                  .arg (stats.decodeJobs)
+                  .arg (double (stats.decodeNanoSecs) / 1.0e9, 0, 'f', 3)
+                  .arg (double (stats.decodeNanoSecs / jobs) / 1.0e6, 0, 'f', 2)
+                  .arg (double (stats.queueNanoSecs / jobs) / 1.0e6, 0, 'f', 2));
          row->numberPVs->setText (QString ("%1").arg (state.numberPVs));
          totalPVs += state.numberPVs;
 
@@ -38,7 +38,10 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <QElapsedTimer>
+#include <QECommon.h>
 #include <QEPlatform.h>
+#include <QEAdaptationParameters.h>
 #include <QEArchiveManager.h>
 
 #define DEBUG qDebug () << "QEArchiveInterfaceCA" << __LINE__ << __FUNCTION__  << "  "
@@ -59,6 +62,17 @@ QEChannelArchiveInterface::QEChannelArchiveInterface (QUrl url, QObject *parent)
    config = this->client->sslConfiguration ();
    config.setProtocol (QSsl::AnyProtocol);
    this->client->setSslConfiguration (config);
+
+   // Guard against unreasonably large values responses - the default is
+   // way more than any plot could use.
+   //
+   QEAdaptationParameters ap ("QE_");
+   this->maxValuesPoints = MAX (ap.getInt ("archive_ca_max_points", 2000000), 1000);
+
+   this->statistics.bytesReceived = 0;
+   this->statistics.decodeJobs = 0;
+   this->statistics.decodeNanoSecs = 0;
+   this->statistics.queueNanoSecs = 0;
 }
 
 //------------------------------------------------------------------------------
@@ -73,6 +87,14 @@ void QEChannelArchiveInterface::setUrl (QUrl url)
    this->client->setUrl (url);
 }
 
+//------------------------------------------------------------------------------
+//
+void QEChannelArchiveInterface::getStatistics (Statistics& statisticsOut) const
+{
+   QMutexLocker locker (&this->statisticsMutex);
+   statisticsOut = this->statistics;
+}
+
 //------------------------------------------------------------------------------
 //
 void QEChannelArchiveInterface::infoRequest (QObject *userData)
@@ -186,7 +208,68 @@ void QEChannelArchiveInterface::valuesRequest (QObject *userData,
    args.append (QVariant (count));
    args.append (QVariant ((int) how));
 
-   agent->call (context, "archiver.values", args);
+   agent->callValues (context, args);
+}
+
+//------------------------------------------------------------------------------
+// Each values request has its own agent.
+//
+void QEChannelArchiveInterface::cancelValuesRequest (QObject* userData)
+{
+   const QList<QEArchiveInterfaceAgent*> agents =
+         this->findChildren<QEArchiveInterfaceAgent*> ();
+
+   for (int j = 0; j < agents.count (); j++) {
+      QEArchiveInterfaceAgent* agent = agents.value (j);
+      if ((agent->context.method == Values) && (agent->context.userData == userData)) {
+         agent->abortValues ();
+      }
+   }
+}
+
+//------------------------------------------------------------------------------
+// The archiver.values method accepts a list of names, so this is just a linear
+// interpolation request for a single value at the given time for all PVs.
+//
+void QEChannelArchiveInterface::valuesAtTimeRequest (QObject* userData,
+                                                     const QCaDateTime time,
+                                                     const QStringList pvNames,
+                                                     const int key)
+{
+   QEArchiveInterfaceAgent *agent;
+   Context context;
+   QVariantList args;
+   QVariantList list;
+   int seconds;
+   int nanoSecs;
+
+   // Set up context
+   //
+   context.method = ValuesAtTime;
+   context.userData = userData;
+   context.requested_element = 0;
+
+   agent = new QEArchiveInterfaceAgent (this->client, this);
+
+   args.append (QVariant (key));
+
+   for (int j = 0; j < pvNames.count (); j++) {
+      list.append (pvNames.value (j));
+   }
+   args.append (QVariant (list));
+
+   // Start and end times are the same.
+   //
+   this->convertEpicsToArchive (time, seconds, nanoSecs);
+   args.append (QVariant (seconds));
+   args.append (QVariant (nanoSecs));
+   args.append (QVariant (seconds));
+   args.append (QVariant (nanoSecs));
+
+   args.append (QVariant (1));
+   args.append (QVariant ((int) Linear));
+
+   agent->callValues (context, args);
 }
 
 //------------------------------------------------------------------------------
@@ -310,159 +393,47 @@ void QEChannelArchiveInterface::processPvNames  (const QObject *userData, const
 
 
 //------------------------------------------------------------------------------
+// Note: the decoder's values are taken, i.e. the decoder is left empty.
 //
-void  QEChannelArchiveInterface::processOnePoint (const DataType dtype,
-                                                  const StringToVariantMaps& value,
-                                                  const unsigned int requested_element,
-                                                  QCaDataPoint & datum)
-{
-   bool okay;
-   int seconds;
-   int nanoSecs;
-   unsigned short status;
-   unsigned short severity;
-   QVariantList array_list;
-   unsigned int n;
-
-   seconds = value ["secs"].toInt (&okay);
-   nanoSecs = value ["nano"].toInt (&okay);
-   datum.datetime = this->convertArchiveToEpics (seconds, nanoSecs);
-
-   status = value ["stat"].toInt (&okay);
-   severity = value ["sevr"].toInt (&okay);
-   datum.alarm = QCaAlarmInfo (status, severity);
-
-   array_list = value ["value"].toList ();
-   n = array_list.count ();
-
-   if (requested_element < n) {
-
-      QVariant array_item = array_list.value(requested_element);
-
-      switch (dtype) {
-      case dtEnumeration:
-      case dtInteger:
-         datum.value = array_item.toInt (&okay);
-         break;
-
-      case dtDouble:
-         datum.value = array_item.toDouble (&okay);
-         break;
-
-      case dtString:
-      default:
-         datum.value = 0.0;
-         break;
-      }
-   } else {
-      // Set points as invalid.
-      //
-      datum.alarm = QCaAlarmInfo (epicsAlarmSoft, epicsSevInvalid);
-   }
-}
-
-//------------------------------------------------------------------------------
-//
-void QEChannelArchiveInterface::processOnePV (const StringToVariantMaps& map,
-                                              const unsigned int requested_element,
-                                              struct ResponseValues& item)
+void QEChannelArchiveInterface::valuesDecoded (const QEArchiveInterface::Context& context,
+                                               QEChannelArchiveValuesDecoder* decoder)
 {
-   StringToVariantMaps meta;
-   bool okay;
-   enum MetaKind mkind;
-   enum DataType dtype;
-   QVariantList values_list;
-   int count;
-   int v;
-
-   item.pvName = map ["name"].toString ();
-
-   meta = map ["meta"].toMap ();
-   mkind = (enum MetaKind)  meta ["type"].toInt (&okay);
-
-   // The meta data values available depends of the type.
-   //
-   switch (mkind) {
-   case mtEnumeration:
-      item.displayLow  = 0.0;
-      item.displayHigh = meta ["states"].toList ().count () - 1;
-      item.precision   = 0;
-      item.units       = "";
-      break;
-
-   case mtNumeric:
-      item.displayLow  = meta ["disp_low"].toDouble (&okay);
-      item.displayHigh = meta ["disp_high"].toDouble (&okay);
-      item.precision   = meta ["prec"].toInt (&okay);
-      item.units       = meta ["units"].toString ();
-      break;
-
-   default:
-      item.displayLow  = 0.0;
-      item.displayHigh = 1.0;
-      item.precision   = 0;
-      item.units       = "";
-      break;
-   }
-
-   item.elementCount =  map ["count"].toInt (&okay);
-   dtype = (enum DataType) map ["type"].toInt (&okay);
-   values_list = map ["values"].toList ();
-
-   count = values_list.count ();
-   for (v = 0; v < count; v++) {
-      // No checking here - just go for it.
-      //
-      StringToVariantMaps value = values_list.value (v).toMap ();
-      QCaDataPoint datum;
-
-      this->processOnePoint (dtype, value, requested_element, datum);
-      item.dataPoints.append (datum);
-      // qDebug () << v << datum.value;
+   {
+      QMutexLocker locker (&this->statisticsMutex);
+      this->statistics.bytesReceived += decoder->bytesReceived;
+      this->statistics.decodeJobs++;
+      this->statistics.decodeNanoSecs += decoder->decodeNanoSecs;
    }
-}
-
 
-//------------------------------------------------------------------------------
-//
-void QEChannelArchiveInterface::processValues (const QObject* userData,
-                                               const QVariant& response,
-                                               const unsigned int requested_element)
-{
-   ResponseValueList PvValues;
-   QVariantList list;
-   QVariant element;
-   int j;
-
-   const QMetaType::Type rtype = QEPlatform::metaType (response);
-   if (rtype != QMetaType::QVariantList) {
-      DEBUG << "response not a list";
+   const bool okay = decoder->finish ();
+   if (!okay) {
+      if (decoder->isFault) {
+         DEBUG << "fault:" << decoder->faultCode << decoder->faultString;
+      } else {
+         DEBUG << "values response:" << decoder->errorString;
+      }
+      this->xmlRpcFault (context, decoder->faultCode, decoder->faultString);
       return;
    }
 
-   list = response.toList ();
-   for (j = 0; j < list.count (); j++) {
-      element = list.value (j);
-
-      const QMetaType::Type etype = QEPlatform::metaType (element) ;
-      if (etype == QMetaType::QVariantMap) {
-
-         StringToVariantMaps map = element.toMap ();
-         struct ResponseValues item;
-
-         this->processOnePV (map, requested_element, item);
-
-         PvValues.push_back (item);
+   ResponseValueList PvValues;
+   PvValues.swap (decoder->values);
 
-      } else {
-         DEBUG << "element [" << j << "] is not a map";
+   if (context.method == ValuesAtTime) {
+      // Only return the last value, if any.
+      //
+      ResponseValueList::iterator it;
+      for (it = PvValues.begin (); it != PvValues.end (); ++it) {
+         if (it->dataPoints.count () > 1) {
+            it->dataPoints.removeFirstItems (it->dataPoints.count () - 1);
+         }
       }
+      emit this->valuesAtTimeResponse (context.userData, true, PvValues);
+   } else {
+      emit this->valuesResponse (context.userData, true, PvValues);
    }
-
-   emit this->valuesResponse (userData, true, PvValues);
 }
 
-
 //------------------------------------------------------------------------------
 //
 void QEChannelArchiveInterface::xmlRpcResponse (const QEArchiveInterface::Context & context,
@@ -482,9 +453,7 @@ void QEChannelArchiveInterface::xmlRpcResponse (const QEArchiveInterface::Contex
       this->processPvNames (context.userData, response);
       break;
 
-   case Values:
-      this->processValues (context.userData, response, context.requested_element);
-      break;
+   // Values and ValuesAtTime responses are streamed - see valuesDecoded.
 
    default:
       DEBUG << "unexpected method: " << context.method;
@@ -519,6 +488,10 @@ void QEChannelArchiveInterface::xmlRpcFault (const QEArchiveInterface::Context &
       emit this->valuesResponse (context.userData, false, nullPvValues);
       break;
 
+   case ValuesAtTime:
+      emit this->valuesAtTimeResponse (context.userData, false, nullPvValues);
+      break;
+
    default:
       DEBUG << "unexpected method: " << context.method << error  << response;
       break;
@@ -533,6 +506,9 @@ QEArchiveInterfaceAgent::QEArchiveInterfaceAgent (MaiaXmlRpcClient *clientIn,
                                                   QEChannelArchiveInterface *parent) : QObject (parent)
 {
    this->client = clientIn;
+   this->owner = parent;
+   this->reply = NULL;
+   this->decoder = NULL;
 
    QObject::connect (this, SIGNAL (xmlRpcResponse (const QEArchiveInterface::Context &, const QVariant &)),
                      parent, SLOT (xmlRpcResponse (const QEArchiveInterface::Context &, const QVariant &)));
@@ -543,7 +519,13 @@ QEArchiveInterfaceAgent::QEArchiveInterfaceAgent (MaiaXmlRpcClient *clientIn,
 
 //------------------------------------------------------------------------------
 //
-QEArchiveInterfaceAgent::~QEArchiveInterfaceAgent () { }
+// If the interface is destroyed with a streamed call still in progress, the
+// agent (a child object) is deleted and the call is abandoned.
+//
+QEArchiveInterfaceAgent::~QEArchiveInterfaceAgent ()
+{
+   this->finishValues (true);
+}
 
 //------------------------------------------------------------------------------
 //
@@ -557,6 +539,88 @@ QNetworkReply* QEArchiveInterfaceAgent::call (QEArchiveInterface::Context & cont
                               this, SLOT (xmlRpcFault (int, const QString&)));
 }
 
+//------------------------------------------------------------------------------
+//
+QNetworkReply* QEArchiveInterfaceAgent::callValues (QEArchiveInterface::Context & contextIn,
+                                                    QList<QVariant> args)
+{
+   this->context = contextIn;
+   this->decoder = new QEChannelArchiveValuesDecoder (contextIn.requested_element,
+                                                      this->owner->maxValuesPoints);
+   this->reply = this->client->post ("archiver.values", args);
+
+   QObject::connect (this->reply, SIGNAL (readyRead ()),
+                     this,        SLOT   (replyReadyRead ()));
+
+   QObject::connect (this->reply, SIGNAL (finished ()),
+                     this,        SLOT   (replyFinished ()));
+
+   return this->reply;
+}
+
+//------------------------------------------------------------------------------
+// Disconnects from and releases the reply (if any), aborting it if requested.
+//
+void QEArchiveInterfaceAgent::finishValues (const bool abandon)
+{
+   if (this->reply) {
+      QObject::disconnect (this->reply, NULL, this, NULL);
+      if (abandon) this->reply->abort ();
+      this->reply->deleteLater ();
+      this->reply = NULL;
+   }
+
+   if (this->decoder) {
+      delete this->decoder;
+      this->decoder = NULL;
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+void QEArchiveInterfaceAgent::abortValues ()
+{
+   if (!this->reply) return;   // not in progress
+
+   this->finishValues (true);
+   this->owner->xmlRpcFault (this->context, -32300, "cancelled");
+   delete this;
+}
+
+//------------------------------------------------------------------------------
+// slot
+void QEArchiveInterfaceAgent::replyReadyRead ()
+{
+   if (!this->reply || !this->decoder) return;   // sanity check
+
+   if (!this->decoder->append (this->reply->readAll ())) {
+      // Invalid or excessive - no point reading any more. The decoder
+      // records the error, and finish will fail.
+      //
+      this->owner->valuesDecoded (this->context, this->decoder);
+      this->finishValues (true);
+      delete this;
+   }
+}
+
+//------------------------------------------------------------------------------
+// slot
+void QEArchiveInterfaceAgent::replyFinished ()
+{
+   if (!this->reply || !this->decoder) return;   // sanity check
+
+   if (this->reply->error () != QNetworkReply::NoError) {
+      const QString errorText = this->reply->errorString ();
+      this->finishValues (false);
+      this->owner->xmlRpcFault (this->context, -32300, errorText);
+   } else {
+      this->decoder->append (this->reply->readAll ());
+      this->owner->valuesDecoded (this->context, this->decoder);
+      this->finishValues (false);
+   }
+   delete this;
+}
+
 //------------------------------------------------------------------------------
 //
 void QEArchiveInterfaceAgent::xmlRpcResponse (QVariant &response)
@@ -577,4 +641,390 @@ void QEArchiveInterfaceAgent::xmlRpcFault (int error, const QString &response)
    delete this;
 }
 
+
+//==============================================================================
+// QEChannelArchiveValuesDecoder
+//==============================================================================
+//
+QEChannelArchiveValuesDecoder::QEChannelArchiveValuesDecoder (const unsigned int requestedElementIn,
+                                                              const int maxPointsIn) :
+   requestedElement (requestedElementIn),
+   maxPoints (maxPointsIn)
+{
+   this->isFault = false;
+   this->faultCode = 0;
+   this->bytesReceived = 0;
+   this->decodeNanoSecs = 0;
+
+   this->valueIsTyped = false;
+   this->isComplete = false;
+   this->isValid = true;
+   this->totalPoints = 0;
+
+   this->metaKind = -1;
+   this->dataType = -1;
+   this->numberStates = 0;
+   this->seconds = 0;
+   this->nanoSecs = 0;
+   this->status = 0;
+   this->severity = 0;
+   this->value = 0.0;
+   this->pointHasValue = false;
+}
+
+//------------------------------------------------------------------------------
+//
+QEChannelArchiveValuesDecoder::~QEChannelArchiveValuesDecoder () { }
+
+//------------------------------------------------------------------------------
+//
+bool QEChannelArchiveValuesDecoder::append (const QByteArray& data)
+{
+   if (!this->isValid) return false;
+   if (data.isEmpty ()) return true;
+
+   QElapsedTimer timer;
+   timer.start ();
+
+   this->bytesReceived += data.size ();
+   this->reader.addData (data);
+   this->parse ();
+
+   this->decodeNanoSecs += timer.nsecsElapsed ();
+   return this->isValid;
+}
+
+//------------------------------------------------------------------------------
+//
+bool QEChannelArchiveValuesDecoder::finish ()
+{
+   if (this->isValid && !this->isComplete) {
+      this->isValid = false;
+      this->errorString = "incomplete response";
+   }
+
+   if (this->isFault) {
+      this->isValid = false;
+   }
+
+   if (!this->isValid && !this->isFault) {
+      // Present decode errors as per the maia client parse error fault.
+      //
+      this->faultCode = -32700;
+      this->faultString = QString ("parse error: %1").arg (this->errorString);
+   }
+
+   return this->isValid;
+}
+
+//------------------------------------------------------------------------------
+// Process all the tokens available so far. Running out of data mid-document
+// is expected - we just wait for the next chunk.
+//
+void QEChannelArchiveValuesDecoder::parse ()
+{
+   while (this->isValid && !this->reader.atEnd ()) {
+      const QXmlStreamReader::TokenType token = this->reader.readNext ();
+
+      switch (token) {
+         case QXmlStreamReader::StartElement:
+            this->startElement ();
+            break;
+
+         case QXmlStreamReader::EndElement:
+            this->endElement ();
+            break;
+
+         case QXmlStreamReader::Characters:
+            this->text.append (this->reader.text ());
+            break;
+
+         case QXmlStreamReader::EndDocument:
+            this->isComplete = true;
+            break;
+
+         default:
+            break;
+      }
+   }
+
+   if (this->reader.hasError () &&
+       (this->reader.error () != QXmlStreamReader::PrematureEndOfDocumentError)) {
+      this->isValid = false;
+      this->errorString = QString ("response not well formed at line %1: %2")
+            .arg (this->reader.lineNumber ()).arg (this->reader.errorString ());
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+int QEChannelArchiveValuesDecoder::structDepth () const
+{
+   int result = 0;
+   for (int j = 0; j < this->frames.count (); j++) {
+      if (this->frames.at (j).isStruct) result++;
+   }
+   return result;
+}
+
+//------------------------------------------------------------------------------
+// Returns the level'th (from 0, outermost) struct frame, if any.
+//
+const QEChannelArchiveValuesDecoder::Frame*
+QEChannelArchiveValuesDecoder::structFrame (const int level) const
+{
+   int n = 0;
+   for (int j = 0; j < this->frames.count (); j++) {
+      const Frame& frame = this->frames.at (j);
+      if (!frame.isStruct) continue;
+      if (n == level) return &frame;
+      n++;
+   }
+   return NULL;
+}
+
+//------------------------------------------------------------------------------
+//
+void QEChannelArchiveValuesDecoder::startElement ()
+{
+   const QString name = this->reader.name ().toString ().toLower ();
+
+   this->text.clear ();
+
+   if (name == "value") {
+      this->valueIsTyped = false;
+      return;
+   }
+
+   // Any child element of a value specifies the value's type.
+   //
+   this->valueIsTyped = true;
+
+   if (name == "fault") {
+      this->isFault = true;
+
+   } else if (name == "struct") {
+      Frame frame;
+      frame.isStruct = true;
+      frame.index = 0;
+      this->frames.append (frame);
+
+      const int depth = this->structDepth ();
+      if (this->isFault) return;
+
+      if (depth == 1) {
+         // Start of a PV.
+         //
+         this->item = QEArchiveInterface::ResponseValues ();
+         this->item.displayLow = 0.0;
+         this->item.displayHigh = 1.0;
+         this->item.precision = 0;
+         this->item.elementCount = 0;
+         this->metaKind = -1;
+         this->dataType = -1;
+         this->numberStates = 0;
+
+      } else if ((depth == 2) && (this->structFrame (0)->member == "values")) {
+         // Start of a point.
+         //
+         this->seconds = 0;
+         this->nanoSecs = 0;
+         this->status = 0;
+         this->severity = 0;
+         this->value = 0.0;
+         this->pointHasValue = false;
+      }
+
+   } else if (name == "array") {
+      Frame frame;
+      frame.isStruct = false;
+      frame.index = 0;
+      this->frames.append (frame);
+
+   } else if (name == "member") {
+      if (!this->frames.isEmpty ()) this->frames.last ().member.clear ();
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+void QEChannelArchiveValuesDecoder::endElement ()
+{
+   const QString name = this->reader.name ().toString ().toLower ();
+
+   if (name == "value") {
+      // If no type is indicated, the type is string.
+      //
+      if (!this->valueIsTyped) this->scalar (this->text);
+      this->valueIsTyped = true;
+
+   } else if ((name == "string") || (name == "i4") || (name == "int") ||
+              (name == "double") || (name == "boolean")) {
+      this->scalar (this->text);
+
+   } else if (name == "name") {
+      if (!this->frames.isEmpty () && this->frames.last ().isStruct) {
+         this->frames.last ().member = this->text.trimmed ();
+      }
+
+   } else if (name == "struct") {
+      const int depth = this->structDepth ();
+      const Frame* outer = this->structFrame (0);
+      const QString outerMember = outer ? outer->member : QString ();
+
+      if (this->isFault || this->frames.isEmpty ()) {
+         // pass
+
+      } else if (depth == 1) {
+         // End of a PV.
+         //
+         this->values.push_back (this->item);
+         this->item.dataPoints.clear ();
+
+      } else if ((depth == 2) && (outerMember == "values")) {
+         // End of a point.
+         //
+         QCaDataPoint datum;
+         datum.datetime = QEArchiveInterface::convertArchiveToTimeStamp (this->seconds, this->nanoSecs);
+         if (this->pointHasValue) {
+            datum.value = this->value;
+            datum.alarm = QCaAlarmInfo (this->status, this->severity);
+         } else {
+            // Set points as invalid.
+            //
+            datum.value = 0.0;
+            datum.alarm = QCaAlarmInfo (epicsAlarmSoft, epicsSevInvalid);
+         }
+         this->item.dataPoints.append (datum);
+
+         this->totalPoints++;
+         if (this->totalPoints > this->maxPoints) {
+            this->isValid = false;
+            this->errorString = QString ("response exceeds %1 points").arg (this->maxPoints);
+         }
+
+      } else if ((depth == 2) && (outerMember == "meta")) {
+         // The meta data values available depends of the type.
+         //
+         switch (this->metaKind) {
+            case QEChannelArchiveInterface::mtEnumeration:
+               this->item.displayLow  = 0.0;
+               this->item.displayHigh = this->numberStates - 1;
+               this->item.precision   = 0;
+               this->item.units       = "";
+               break;
+
+            case QEChannelArchiveInterface::mtNumeric:
+               break;
+
+            default:
+               this->item.displayLow  = 0.0;
+               this->item.displayHigh = 1.0;
+               this->item.precision   = 0;
+               this->item.units       = "";
+               break;
+         }
+      }
+
+      if (!this->frames.isEmpty ()) this->frames.removeLast ();
+
+   } else if (name == "array") {
+      if (!this->frames.isEmpty ()) this->frames.removeLast ();
+   }
+
+   this->text.clear ();
+}
+
+//------------------------------------------------------------------------------
+// Handles a scalar value in the context of the current struct member/array.
+//
+void QEChannelArchiveValuesDecoder::scalar (const QString& scalarText)
+{
+   if (this->frames.isEmpty ()) return;
+
+   Frame& frame = this->frames.last ();
+   const int depth = this->structDepth ();
+   const Frame* outer = this->structFrame (0);
+   const Frame* inner = this->structFrame (1);
+   const QString member = inner ? inner->member : (outer ? outer->member : QString ());
+
+   int index = -1;
+   if (!frame.isStruct) {
+      index = frame.index;
+      frame.index++;
+   }
+
+   bool okay;
+
+   if (this->isFault) {
+      if ((depth == 1) && frame.isStruct) {
+         if (member == "faultCode") {
+            this->faultCode = scalarText.toInt (&okay);
+         } else if (member == "faultString") {
+            this->faultString = scalarText;
+         }
+      }
+      return;
+   }
+
+   if (depth == 1 && frame.isStruct) {
+      // PV member
+      //
+      if (member == "name") {
+         this->item.pvName = scalarText;
+      } else if (member == "type") {
+         this->dataType = scalarText.toInt (&okay);
+      } else if (member == "count") {
+         this->item.elementCount = scalarText.toInt (&okay);
+      }
+
+   } else if ((depth == 2) && (outer->member == "meta")) {
+      if (frame.isStruct) {
+         if (member == "type") {
+            this->metaKind = scalarText.toInt (&okay);
+         } else if (member == "disp_low") {
+            this->item.displayLow = scalarText.toDouble (&okay);
+         } else if (member == "disp_high") {
+            this->item.displayHigh = scalarText.toDouble (&okay);
+         } else if (member == "prec") {
+            this->item.precision = scalarText.toInt (&okay);
+         } else if (member == "units") {
+            this->item.units = scalarText;
+         }
+      } else if (member == "states") {
+         this->numberStates++;
+      }
+
+   } else if ((depth == 2) && (outer->member == "values")) {
+      if (frame.isStruct) {
+         if (member == "secs") {
+            this->seconds = scalarText.toInt (&okay);
+         } else if (member == "nano") {
+            this->nanoSecs = scalarText.toInt (&okay);
+         } else if (member == "stat") {
+            this->status = scalarText.toInt (&okay);
+         } else if (member == "sevr") {
+            this->severity = scalarText.toInt (&okay);
+         }
+      } else if ((member == "value") && (index == int (this->requestedElement))) {
+         switch (this->dataType) {
+            case QEChannelArchiveInterface::dtEnumeration:
+            case QEChannelArchiveInterface::dtInteger:
+               this->value = scalarText.toInt (&okay);
+               break;
+
+            case QEChannelArchiveInterface::dtDouble:
+               this->value = scalarText.toDouble (&okay);
+               break;
+
+            case QEChannelArchiveInterface::dtString:
+            default:
+               this->value = 0.0;
+               break;
+         }
+         this->pointHasValue = true;
+      }
+   }
+}
+
 // end
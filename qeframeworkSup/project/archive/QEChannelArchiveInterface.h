@@ -32,10 +32,13 @@
 #include <QDateTime>
 #include <QVector>
 #include <QList>
+#include <QMutex>
 #include <QStringList>
 #include <QUrl>
 #include <QNetworkRequest>
 #include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QXmlStreamReader>
 
 #include <QCaDataPoint.h>
 #include <QCaDateTime.h>
@@ -44,6 +47,8 @@
 #include <maiaXmlRpcClient.h>
 #include <QEArchiveInterface.h>
 
+class QEChannelArchiveValuesDecoder;
+
 /// This class provides a thin wrapper around the maiaXmlRpcClient specifically
 /// for handling the EPICS Channel Access Archive XML RPC procedure calls.
 /// While functionally thin, it does provide the conversion between the types
@@ -78,14 +83,24 @@ public:
                        const int key = 0,
                        const unsigned int requested_element = 0);
 
+   void cancelValuesRequest (QObject* userData);
+
+   void valuesAtTimeRequest (QObject* userData,
+                             const QCaDateTime time,
+                             const QStringList pvNames,
+                             const int key = 0);
+
    void infoRequest (QObject* userData);
 
    void archivesRequest (QObject* userData);
 
    void setUrl (QUrl url);
 
+   void getStatistics (Statistics& statistics) const;
+
 private:
    friend class QEArchiveInterfaceAgent;
+   friend class QEChannelArchiveValuesDecoder;
 
    typedef QMap<QString, QVariant> StringToVariantMaps;
 
@@ -102,21 +117,19 @@ private:
    };
 
    MaiaXmlRpcClient* client;
+   int maxValuesPoints;        // per response - from QE_ARCHIVE_CA_MAX_POINTS
+
+   mutable QMutex statisticsMutex;
+   QEArchiveInterface::Statistics statistics;
 
    void processInfo     (const QObject* userData, const QVariant& response);
    void processArchives (const QObject* userData, const QVariant& response);
    void processPvNames  (const QObject* userData, const QVariant& response);
-   void processValues   (const QObject* userData, const QVariant& response,
-                         const unsigned int requested_element);
 
-   void processOnePoint (const DataType dtype,
-                         const StringToVariantMaps& value,
-                         const unsigned int requested_element,
-                         QCaDataPoint & datum);
-
-   void processOnePV (const StringToVariantMaps& map,
-                      const unsigned int requested_element,
-                      struct ResponseValues& item);
+   // Used by the agent for streamed archiver.values responses.
+   //
+   void valuesDecoded (const QEArchiveInterface::Context& context,
+                       QEChannelArchiveValuesDecoder* decoder);
 
 private slots:
    // Used by intermediary QEArchiveInterfaceAgent
@@ -149,8 +162,24 @@ private:
                         QString procedure,
                         QList<QVariant> args);
 
+   // As per call, but the response is decoded as it arrives by a values
+   // decoder, as opposed to via a DOM and a QVariant tree.
+   //
+   QNetworkReply* callValues (QEArchiveInterface::Context& contextIn,
+                              QList<QVariant> args);
+
+   void finishValues (const bool abandon);
+
+   // Abandons a streamed values call still in progress, responding with a fault.
+   // Note: this deletes the agent.
+   //
+   void abortValues ();
+
    MaiaXmlRpcClient* client;
+   QEChannelArchiveInterface* owner;
    QEArchiveInterface::Context context;
+   QNetworkReply* reply;                      // streamed values call only
+   QEChannelArchiveValuesDecoder* decoder;
 
 signals:
    void xmlRpcResponse (const QEArchiveInterface::Context&, const QVariant &);
@@ -162,6 +191,88 @@ private slots:
    //
    void xmlRpcResponse (QVariant& response);
    void xmlRpcFault    (int error, const QString& response);
+
+   // from network reply - streamed values call only
+   //
+   void replyReadyRead ();
+   void replyFinished ();
+};
+
+
+//------------------------------------------------------------------------------
+// Essentially a private class. Decodes an archiver.values XML RPC response
+// incrementally, i.e. as the bytes arrive, directly into data points. Unlike
+// the generic maia client, neither a DOM nor a QVariant tree is constructed,
+// so memory use is the response data points plus the current chunk of XML.
+//
+// Only the structure of an archiver.values response is understood, that is
+// an array of PV structs, each with name, meta, type, count and values members,
+// where values is an array of point structs (secs, nano, stat, sevr, value).
+// Alternatively, the response may be a fault struct.
+//
+class QEChannelArchiveValuesDecoder {
+private:
+   friend class QEChannelArchiveInterface;
+   friend class QEArchiveInterfaceAgent;
+
+   explicit QEChannelArchiveValuesDecoder (const unsigned int requestedElement,
+                                           const int maxPoints);
+   ~QEChannelArchiveValuesDecoder ();
+
+   // Returns false if the response is invalid or too large, in which case
+   // the caller should abandon the response.
+   //
+   bool append (const QByteArray& data);
+
+   // Returns true if a complete and valid response has been decoded.
+   //
+   bool finish ();
+
+   QEArchiveInterface::ResponseValueList values;
+   bool isFault;
+   int faultCode;
+   QString faultString;
+   QString errorString;
+   qint64 bytesReceived;
+   qint64 decodeNanoSecs;
+
+   // Parser state
+   //
+   struct Frame {
+      bool isStruct;     // else array
+      QString member;    // current member name - struct only
+      int index;         // next element index - array only
+   };
+
+   void parse ();
+   void startElement ();
+   void endElement ();
+   void scalar (const QString& text);
+   const Frame* structFrame (const int level) const;
+   int structDepth () const;
+
+   const unsigned int requestedElement;
+   const int maxPoints;
+   QXmlStreamReader reader;
+   QVector<Frame> frames;
+   QString text;
+   bool valueIsTyped;
+   bool isComplete;
+   bool isValid;
+   int totalPoints;
+
+   // Current PV and point
+   //
+   QEArchiveInterface::ResponseValues item;
+   int metaKind;
+   int dataType;
+   int numberStates;
+   int seconds;
+   int nanoSecs;
+   int status;
+   int severity;
+   double value;
+   bool pointHasValue;
 };
 
 #endif // QE_CHANNEL_ARCHIVE_INTERFACE_H
@@ -29,6 +29,9 @@ QT += xml network
 
 INCLUDEPATH += $$PWD
 
+HEADERS += $$PWD/QEArchapplFileInterface.h
+SOURCES += $$PWD/QEArchapplFileInterface.cpp
+
 HEADERS += $$PWD/QEArchapplInterface.h
 SOURCES += $$PWD/QEArchapplInterface.cpp
 
@@ -44,9 +47,15 @@ SOURCES += $$PWD/QEArchiveInterfaceManager.cpp
 HEADERS += $$PWD/QEArchiveManager.h
 SOURCES += $$PWD/QEArchiveManager.cpp
 
+HEADERS += $$PWD/QEArchiveNameIndex.h
+SOURCES += $$PWD/QEArchiveNameIndex.cpp
+
 HEADERS += $$PWD/QEArchiveNameSearch.h
 SOURCES += $$PWD/QEArchiveNameSearch.cpp
 
+HEADERS += $$PWD/QEArchiveSegmentCache.h
+SOURCES += $$PWD/QEArchiveSegmentCache.cpp
+
 HEADERS += $$PWD/QEArchiveStatus.h
 SOURCES += $$PWD/QEArchiveStatus.cpp
 
@@ -83,6 +83,13 @@ QNetworkReply* MaiaXmlRpcClient::call(QString method, QList<QVariant> args,
 	return reply;
 }
 
+QNetworkReply* MaiaXmlRpcClient::post(QString method, QList<QVariant> args) {
+	MaiaObject call;
+	// Not added to the callmap, so ignored by replyFinished.
+	return manager.post( request,
+		call.prepareCall(method, args).toUtf8() );
+}
+
 void MaiaXmlRpcClient::setSslConfiguration(const QSslConfiguration &config) {
 	request.setSslConfiguration(config);
 }
@@ -46,6 +46,9 @@ class MaiaXmlRpcClient : public QObject {
 		QNetworkReply* call(QString method, QList<QVariant> args,
 		QObject* responseObject, const char* responseSlot,
 		QObject* faultObject, const char* faultSlot);
+		// Posts the call, but leaves the reply wholly to the caller, e.g. for
+		// streamed decoding of large responses.
+		QNetworkReply* post(QString method, QList<QVariant> args);
 		void setSslConfiguration(const QSslConfiguration &config);
 		QSslConfiguration sslConfiguration () const;
 	
@@ -0,0 +1,944 @@
+/*  QENumericKernels.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Starritt
+ *  Contact details:
+ *    andrew.starritt@synchrotron.org.au
+ */
+
+#include "QENumericKernels.h"
+#include <atomic>
+#include <limits>
+#include <math.h>
+#include <string.h>
+
+// Determine if we can use the x86 SSE2/AVX2 intrinsics.
+// SSE2 is part of the x86-64 base line, AVX2 is selected at run time.
+//
+#if defined(__x86_64__) || defined(_M_X64) || \
+   (defined(__i386__) && defined(__SSE2__)) || \
+   (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define QE_NUMERIC_X86  1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define QE_NUMERIC_X86  0
+#endif
+
+// GCC and clang require functions using AVX2 intrinsics to be so marked.
+// MSVC allows AVX2 intrinsics to be used without any special options.
+//
+#if defined(__GNUC__) || defined(__clang__)
+#define QE_TARGET_AVX2  __attribute__((target("avx2")))
+#else
+#define QE_TARGET_AVX2
+#endif
+
+// Points closer than this in x yield a zero derivative - as per QEFloatingArray.
+//
+#define MIN_DELTA_X  (1.0E-20)
+
+namespace {
+
+//==============================================================================
+// Portable implementations.
+//==============================================================================
+//
+template <typename T>
+static void portableToDouble (const T* source, double* target, const int count)
+{
+   for (int j = 0; j < count; j++) {
+      target [j] = double (source [j]);
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+static inline bool isUsable (const double v, const bool includeInf)
+{
+   if (v != v) return false;  // NaN
+   if (!includeInf && ((v == std::numeric_limits<double>::infinity ()) ||
+                       (v == -std::numeric_limits<double>::infinity ()))) return false;
+   return true;
+}
+
+static bool portableMinMax (const double* source, const int count, const bool includeInf,
+                            double& minimum, double& maximum)
+{
+   bool found = false;
+   double lo = 0.0;
+   double hi = 0.0;
+   for (int j = 0; j < count; j++) {
+      const double v = source [j];
+      if (!isUsable (v, includeInf)) continue;
+      if (found) {
+         if (v < lo) lo = v;
+         if (v > hi) hi = v;
+      } else {
+         lo = hi = v;
+         found = true;
+      }
+   }
+   if (found) {
+      minimum = lo;
+      maximum = hi;
+   }
+   return found;
+}
+
+//------------------------------------------------------------------------------
+//
+static void portableSumAndSumSquares (const double* source, const int count,
+                                      double& sum, double& sumSquares)
+{
+   double s = 0.0;
+   double ss = 0.0;
+   for (int j = 0; j < count; j++) {
+      const double v = source [j];
+      s += v;
+      ss += v * v;
+   }
+   sum = s;
+   sumSquares = ss;
+}
+
+//------------------------------------------------------------------------------
+//
+static void portableAffine (double* data, const int count, const double m, const double c)
+{
+   for (int j = 0; j < count; j++) {
+      data [j] = m * data [j] + c;
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+static inline bool isFinite (const double v)
+{
+   return (v == v) && (v != std::numeric_limits<double>::infinity ()) &&
+                      (v != -std::numeric_limits<double>::infinity ());
+}
+
+static int portableReplaceNonFinite (double* data, const int count, const double replacement)
+{
+   int number = 0;
+   for (int j = 0; j < count; j++) {
+      if (!isFinite (data [j])) {
+         data [j] = replacement;
+         number++;
+      }
+   }
+   return number;
+}
+
+//------------------------------------------------------------------------------
+// Derivative helpers - these define the reference behaviour.
+//
+static inline double derivative2 (const double xp1, const double yp1,
+                                  const double xp2, const double yp2)
+{
+   const double dx = xp2 - xp1;
+   const double dy = yp2 - yp1;
+   return (fabs (dx) >= MIN_DELTA_X) ? (dy / dx) : 0.0;
+}
+
+static inline double derivative3 (const double xp1, const double yp1,
+                                  const double xp2, const double yp2,
+                                  const double xp3, const double yp3)
+{
+   // Form quadratic:    y  = a.x^2 + b.x + c
+   // then:              y' = 2.a.x + b
+   // and specifically:  y'(X2) = 2.a.(X2) + b
+   //
+   // First perform linear co-ordinate mapping (xpi, ypi) to (xi, yi)
+   // such that:  xi = xpi - xp2,  and  yi = ypi - yp2.
+   // x2 = y2 = 0 by defn, which implies c = 0, and y'(x2) = y'(0) = b, where
+   //
+   //   y1 = a.x1.x1 + b.x1
+   //   y3 = a.x3.x3 + b.x3
+   //
+   const double x1 = xp1 - xp2;
+   const double y1 = yp1 - yp2;
+   const double x3 = xp3 - xp2;
+   const double y3 = yp3 - yp2;
+   const double divisor = x1*x3*(x3 - x1);
+   return (fabs (divisor) >= MIN_DELTA_X) ? (y1*x3*x3 - y3*x1*x1) / divisor : 0.0;
+}
+
+// Does the end points and returns false if there are no middle points.
+//
+static bool derivativeEnds (const double* x, const double* y, double* dydx, const int count)
+{
+   if (count <= 0) return false;
+   if (count == 1) {
+      dydx [0] = 0.0;
+      return false;
+   }
+
+   dydx [0] = derivative2 (x [0], y [0], x [1], y [1]);
+   if (count == 2) {
+      dydx [1] = dydx [0];
+      return false;
+   }
+
+   dydx [count - 1] = derivative2 (x [count - 2], y [count - 2], x [count - 1], y [count - 1]);
+   return true;
+}
+
+static void portableDerivativeMiddle (const double* x, const double* y, double* dydx,
+                                      const int first, const int last)
+{
+   for (int j = first; j <= last; j++) {
+      dydx [j] = derivative3 (x [j - 1], y [j - 1], x [j], y [j], x [j + 1], y [j + 1]);
+   }
+}
+
+static void portableDerivative (const double* x, const double* y, double* dydx, const int count)
+{
+   if (!derivativeEnds (x, y, dydx, count)) return;
+   portableDerivativeMiddle (x, y, dydx, 1, count - 2);
+}
+
+
+#if QE_NUMERIC_X86
+
+//==============================================================================
+// SSE2 implementations.
+//==============================================================================
+//
+static inline void sse2Store4 (const __m128i v, double* target)
+{
+   _mm_storeu_pd (target + 0, _mm_cvtepi32_pd (v));
+   _mm_storeu_pd (target + 2, _mm_cvtepi32_pd (_mm_shuffle_epi32 (v, _MM_SHUFFLE (3, 2, 3, 2))));
+}
+
+// Widens eight 16-bit values, sign/zero extension per the extend vector.
+//
+static inline void sse2Store8x16 (const __m128i v, const __m128i extend, double* target)
+{
+   sse2Store4 (_mm_unpacklo_epi16 (v, extend), target + 0);
+   sse2Store4 (_mm_unpackhi_epi16 (v, extend), target + 4);
+}
+
+//------------------------------------------------------------------------------
+//
+static void sse2Int8ToDouble (const int8_t* source, double* target, const int count)
+{
+   const __m128i zero = _mm_setzero_si128 ();
+   int j = 0;
+   for (; j + 16 <= count; j += 16) {
+      const __m128i v = _mm_loadu_si128 ((const __m128i*) (source + j));
+      const __m128i sign = _mm_cmplt_epi8 (v, zero);
+      const __m128i lo = _mm_unpacklo_epi8 (v, sign);
+      const __m128i hi = _mm_unpackhi_epi8 (v, sign);
+      sse2Store8x16 (lo, _mm_srai_epi16 (lo, 15), target + j);
+      sse2Store8x16 (hi, _mm_srai_epi16 (hi, 15), target + j + 8);
+   }
+   portableToDouble (source + j, target + j, count - j);
+}
+
+static void sse2Uint8ToDouble (const uint8_t* source, double* target, const int count)
+{
+   const __m128i zero = _mm_setzero_si128 ();
+   int j = 0;
+   for (; j + 16 <= count; j += 16) {
+      const __m128i v = _mm_loadu_si128 ((const __m128i*) (source + j));
+      sse2Store8x16 (_mm_unpacklo_epi8 (v, zero), zero, target + j);
+      sse2Store8x16 (_mm_unpackhi_epi8 (v, zero), zero, target + j + 8);
+   }
+   portableToDouble (source + j, target + j, count - j);
+}
+
+static void sse2Int16ToDouble (const int16_t* source, double* target, const int count)
+{
+   int j = 0;
+   for (; j + 8 <= count; j += 8) {
+      const __m128i v = _mm_loadu_si128 ((const __m128i*) (source + j));
+      sse2Store8x16 (v, _mm_srai_epi16 (v, 15), target + j);
+   }
+   portableToDouble (source + j, target + j, count - j);
+}
+
+static void sse2Uint16ToDouble (const uint16_t* source, double* target, const int count)
+{
+   const __m128i zero = _mm_setzero_si128 ();
+   int j = 0;
+   for (; j + 8 <= count; j += 8) {
+      const __m128i v = _mm_loadu_si128 ((const __m128i*) (source + j));
+      sse2Store8x16 (v, zero, target + j);
+   }
+   portableToDouble (source + j, target + j, count - j);
+}
+
+static void sse2Int32ToDouble (const int32_t* source, double* target, const int count)
+{
+   int j = 0;
+   for (; j + 4 <= count; j += 4) {
+      sse2Store4 (_mm_loadu_si128 ((const __m128i*) (source + j)), target + j);
+   }
+   portableToDouble (source + j, target + j, count - j);
+}
+
+static void sse2Uint32ToDouble (const uint32_t* source, double* target, const int count)
+{
+   // Convert as signed, then add 2^32 to those that came out negative.
+   //
+   const __m128d zero = _mm_setzero_pd ();
+   const __m128d two32 = _mm_set1_pd (4294967296.0);
+   int j = 0;
+   for (; j + 4 <= count; j += 4) {
+      const __m128i v = _mm_loadu_si128 ((const __m128i*) (source + j));
+      __m128d a = _mm_cvtepi32_pd (v);
+      __m128d b = _mm_cvtepi32_pd (_mm_shuffle_epi32 (v, _MM_SHUFFLE (3, 2, 3, 2)));
+      a = _mm_add_pd (a, _mm_and_pd (_mm_cmplt_pd (a, zero), two32));
+      b = _mm_add_pd (b, _mm_and_pd (_mm_cmplt_pd (b, zero), two32));
+      _mm_storeu_pd (target + j + 0, a);
+      _mm_storeu_pd (target + j + 2, b);
+   }
+   portableToDouble (source + j, target + j, count - j);
+}
+
+static void sse2FloatToDouble (const float* source, double* target, const int count)
+{
+   int j = 0;
+   for (; j + 4 <= count; j += 4) {
+      const __m128 v = _mm_loadu_ps (source + j);
+      _mm_storeu_pd (target + j + 0, _mm_cvtps_pd (v));
+      _mm_storeu_pd (target + j + 2, _mm_cvtps_pd (_mm_movehl_ps (v, v)));
+   }
+   portableToDouble (source + j, target + j, count - j);
+}
+
+//------------------------------------------------------------------------------
+// Unusable values are replaced by +inf for the minimum and -inf for the maximum.
+//
+static bool sse2MinMax (const double* source, const int count, const bool includeInf,
+                        double& minimum, double& maximum)
+{
+   const __m128d posInf = _mm_set1_pd (std::numeric_limits<double>::infinity ());
+   const __m128d negInf = _mm_set1_pd (-std::numeric_limits<double>::infinity ());
+   const __m128d signMask = _mm_set1_pd (-0.0);
+
+   __m128d lo = posInf;
+   __m128d hi = negInf;
+   __m128d any = _mm_setzero_pd ();
+
+   int j = 0;
+   for (; j + 2 <= count; j += 2) {
+      const __m128d v = _mm_loadu_pd (source + j);
+      __m128d usable = _mm_cmpeq_pd (v, v);
+      if (!includeInf) {
+         usable = _mm_and_pd (usable, _mm_cmplt_pd (_mm_andnot_pd (signMask, v), posInf));
+      }
+      lo = _mm_min_pd (lo, _mm_or_pd (_mm_and_pd (usable, v), _mm_andnot_pd (usable, posInf)));
+      hi = _mm_max_pd (hi, _mm_or_pd (_mm_and_pd (usable, v), _mm_andnot_pd (usable, negInf)));
+      any = _mm_or_pd (any, usable);
+   }
+
+   double loLanes [2];
+   double hiLanes [2];
+   _mm_storeu_pd (loLanes, lo);
+   _mm_storeu_pd (hiLanes, hi);
+
+   bool found = _mm_movemask_pd (any) != 0;
+   double rlo = loLanes [0] < loLanes [1] ? loLanes [0] : loLanes [1];
+   double rhi = hiLanes [0] > hiLanes [1] ? hiLanes [0] : hiLanes [1];
+
+   double tlo, thi;
+   if (portableMinMax (source + j, count - j, includeInf, tlo, thi)) {
+      if (found) {
+         if (tlo < rlo) rlo = tlo;
+         if (thi > rhi) rhi = thi;
+      } else {
+         rlo = tlo;
+         rhi = thi;
+         found = true;
+      }
+   }
+
+   if (found) {
+      minimum = rlo;
+      maximum = rhi;
+   }
+   return found;
+}
+
+//------------------------------------------------------------------------------
+//
+static void sse2SumAndSumSquares (const double* source, const int count,
+                                  double& sum, double& sumSquares)
+{
+   __m128d s = _mm_setzero_pd ();
+   __m128d ss = _mm_setzero_pd ();
+   int j = 0;
+   for (; j + 2 <= count; j += 2) {
+      const __m128d v = _mm_loadu_pd (source + j);
+      s = _mm_add_pd (s, v);
+      ss = _mm_add_pd (ss, _mm_mul_pd (v, v));
+   }
+
+   double sLanes [2];
+   double ssLanes [2];
+   _mm_storeu_pd (sLanes, s);
+   _mm_storeu_pd (ssLanes, ss);
+
+   double ts, tss;
+   portableSumAndSumSquares (source + j, count - j, ts, tss);
+   sum = sLanes [0] + sLanes [1] + ts;
+   sumSquares = ssLanes [0] + ssLanes [1] + tss;
+}
+
+//------------------------------------------------------------------------------
+//
+static void sse2Affine (double* data, const int count, const double m, const double c)
+{
+   const __m128d vm = _mm_set1_pd (m);
+   const __m128d vc = _mm_set1_pd (c);
+   int j = 0;
+   for (; j + 2 <= count; j += 2) {
+      const __m128d v = _mm_loadu_pd (data + j);
+      _mm_storeu_pd (data + j, _mm_add_pd (_mm_mul_pd (vm, v), vc));
+   }
+   portableAffine (data + j, count - j, m, c);
+}
+
+//------------------------------------------------------------------------------
+//
+static int sse2ReplaceNonFinite (double* data, const int count, const double replacement)
+{
+   const __m128d posInf = _mm_set1_pd (std::numeric_limits<double>::infinity ());
+   const __m128d signMask = _mm_set1_pd (-0.0);
+   const __m128d vr = _mm_set1_pd (replacement);
+   static const int bits [4] = { 0, 1, 1, 2 };
+
+   int number = 0;
+   int j = 0;
+   for (; j + 2 <= count; j += 2) {
+      const __m128d v = _mm_loadu_pd (data + j);
+      // NaN compare false, so |v| < inf is true for finite values only.
+      const __m128d finite = _mm_cmplt_pd (_mm_andnot_pd (signMask, v), posInf);
+      const int mask = _mm_movemask_pd (finite);
+      if (mask != 3) {
+         _mm_storeu_pd (data + j, _mm_or_pd (_mm_and_pd (finite, v), _mm_andnot_pd (finite, vr)));
+         number += 2 - bits [mask];
+      }
+   }
+   number += portableReplaceNonFinite (data + j, count - j, replacement);
+   return number;
+}
+
+//------------------------------------------------------------------------------
+//
+static void sse2Derivative (const double* x, const double* y, double* dydx, const int count)
+{
+   if (!derivativeEnds (x, y, dydx, count)) return;
+
+   const __m128d signMask = _mm_set1_pd (-0.0);
+   const __m128d minDelta = _mm_set1_pd (MIN_DELTA_X);
+   const int last = count - 2;
+   int j = 1;
+   for (; j + 1 <= last; j += 2) {
+      const __m128d xp2 = _mm_loadu_pd (x + j);
+      const __m128d yp2 = _mm_loadu_pd (y + j);
+      const __m128d x1 = _mm_sub_pd (_mm_loadu_pd (x + j - 1), xp2);
+      const __m128d y1 = _mm_sub_pd (_mm_loadu_pd (y + j - 1), yp2);
+      const __m128d x3 = _mm_sub_pd (_mm_loadu_pd (x + j + 1), xp2);
+      const __m128d y3 = _mm_sub_pd (_mm_loadu_pd (y + j + 1), yp2);
+
+      const __m128d divisor = _mm_mul_pd (_mm_mul_pd (x1, x3), _mm_sub_pd (x3, x1));
+      const __m128d numerator = _mm_sub_pd (_mm_mul_pd (_mm_mul_pd (y1, x3), x3),
+                                            _mm_mul_pd (_mm_mul_pd (y3, x1), x1));
+      const __m128d okay = _mm_cmpge_pd (_mm_andnot_pd (signMask, divisor), minDelta);
+      _mm_storeu_pd (dydx + j, _mm_and_pd (okay, _mm_div_pd (numerator, divisor)));
+   }
+   portableDerivativeMiddle (x, y, dydx, j, last);
+}
+
+//==============================================================================
+// AVX2 implementations.
+//==============================================================================
+//
+QE_TARGET_AVX2
+static void avx2Int8ToDouble (const int8_t* source, double* target, const int count)
+{
+   int j = 0;
+   for (; j + 16 <= count; j += 16) {
+      const __m128i v = _mm_loadu_si128 ((const __m128i*) (source + j));
+      _mm256_storeu_pd (target + j +  0, _mm256_cvtepi32_pd (_mm_cvtepi8_epi32 (v)));
+      _mm256_storeu_pd (target + j +  4, _mm256_cvtepi32_pd (_mm_cvtepi8_epi32 (_mm_srli_si128 (v, 4))));
+      _mm256_storeu_pd (target + j +  8, _mm256_cvtepi32_pd (_mm_cvtepi8_epi32 (_mm_srli_si128 (v, 8))));
+      _mm256_storeu_pd (target + j + 12, _mm256_cvtepi32_pd (_mm_cvtepi8_epi32 (_mm_srli_si128 (v, 12))));
+   }
+   portableToDouble (source + j, target + j, count - j);
+}
+
+QE_TARGET_AVX2
+static void avx2Uint8ToDouble (const uint8_t* source, double* target, const int count)
+{
+   int j = 0;
+   for (; j + 16 <= count; j += 16) {
+      const __m128i v = _mm_loadu_si128 ((const __m128i*) (source + j));
+      _mm256_storeu_pd (target + j +  0, _mm256_cvtepi32_pd (_mm_cvtepu8_epi32 (v)));
+      _mm256_storeu_pd (target + j +  4, _mm256_cvtepi32_pd (_mm_cvtepu8_epi32 (_mm_srli_si128 (v, 4))));
+      _mm256_storeu_pd (target + j +  8, _mm256_cvtepi32_pd (_mm_cvtepu8_epi32 (_mm_srli_si128 (v, 8))));
+      _mm256_storeu_pd (target + j + 12, _mm256_cvtepi32_pd (_mm_cvtepu8_epi32 (_mm_srli_si128 (v, 12))));
+   }
+   portableToDouble (source + j, target + j, count - j);
+}
+
+QE_TARGET_AVX2
+static void avx2Int16ToDouble (const int16_t* source, double* target, const int count)
+{
+   int j = 0;
+   for (; j + 8 <= count; j += 8) {
+      const __m128i v = _mm_loadu_si128 ((const __m128i*) (source + j));
+      _mm256_storeu_pd (target + j + 0, _mm256_cvtepi32_pd (_mm_cvtepi16_epi32 (v)));
+      _mm256_storeu_pd (target + j + 4, _mm256_cvtepi32_pd (_mm_cvtepi16_epi32 (_mm_srli_si128 (v, 8))));
+   }
+   portableToDouble (source + j, target + j, count - j);
+}
+
+QE_TARGET_AVX2
+static void avx2Uint16ToDouble (const uint16_t* source, double* target, const int count)
+{
+   int j = 0;
+   for (; j + 8 <= count; j += 8) {
+      const __m128i v = _mm_loadu_si128 ((const __m128i*) (source + j));
+      _mm256_storeu_pd (target + j + 0, _mm256_cvtepi32_pd (_mm_cvtepu16_epi32 (v)));
+      _mm256_storeu_pd (target + j + 4, _mm256_cvtepi32_pd (_mm_cvtepu16_epi32 (_mm_srli_si128 (v, 8))));
+   }
+   portableToDouble (source + j, target + j, count - j);
+}
+
+QE_TARGET_AVX2
+static void avx2Int32ToDouble (const int32_t* source, double* target, const int count)
+{
+   int j = 0;
+   for (; j + 4 <= count; j += 4) {
+      const __m128i v = _mm_loadu_si128 ((const __m128i*) (source + j));
+      _mm256_storeu_pd (target + j, _mm256_cvtepi32_pd (v));
+   }
+   portableToDouble (source + j, target + j, count - j);
+}
+
+QE_TARGET_AVX2
+static void avx2Uint32ToDouble (const uint32_t* source, double* target, const int count)
+{
+   const __m256d zero = _mm256_setzero_pd ();
+   const __m256d two32 = _mm256_set1_pd (4294967296.0);
+   int j = 0;
+   for (; j + 4 <= count; j += 4) {
+      const __m128i v = _mm_loadu_si128 ((const __m128i*) (source + j));
+      const __m256d d = _mm256_cvtepi32_pd (v);
+      const __m256d negative = _mm256_cmp_pd (d, zero, _CMP_LT_OQ);
+      _mm256_storeu_pd (target + j, _mm256_add_pd (d, _mm256_and_pd (negative, two32)));
+   }
+   portableToDouble (source + j, target + j, count - j);
+}
+
+QE_TARGET_AVX2
+static void avx2FloatToDouble (const float* source, double* target, const int count)
+{
+   int j = 0;
+   for (; j + 4 <= count; j += 4) {
+      _mm256_storeu_pd (target + j, _mm256_cvtps_pd (_mm_loadu_ps (source + j)));
+   }
+   portableToDouble (source + j, target + j, count - j);
+}
+
+//------------------------------------------------------------------------------
+//
+QE_TARGET_AVX2
+static bool avx2MinMax (const double* source, const int count, const bool includeInf,
+                        double& minimum, double& maximum)
+{
+   const __m256d posInf = _mm256_set1_pd (std::numeric_limits<double>::infinity ());
+   const __m256d negInf = _mm256_set1_pd (-std::numeric_limits<double>::infinity ());
+   const __m256d signMask = _mm256_set1_pd (-0.0);
+
+   __m256d lo = posInf;
+   __m256d hi = negInf;
+   __m256d any = _mm256_setzero_pd ();
+
+   int j = 0;
+   for (; j + 4 <= count; j += 4) {
+      const __m256d v = _mm256_loadu_pd (source + j);
+      __m256d usable = _mm256_cmp_pd (v, v, _CMP_EQ_OQ);
+      if (!includeInf) {
+         usable = _mm256_and_pd (usable, _mm256_cmp_pd (_mm256_andnot_pd (signMask, v), posInf, _CMP_LT_OQ));
+      }
+      lo = _mm256_min_pd (lo, _mm256_blendv_pd (posInf, v, usable));
+      hi = _mm256_max_pd (hi, _mm256_blendv_pd (negInf, v, usable));
+      any = _mm256_or_pd (any, usable);
+   }
+
+   double loLanes [4];
+   double hiLanes [4];
+   _mm256_storeu_pd (loLanes, lo);
+   _mm256_storeu_pd (hiLanes, hi);
+
+   bool found = _mm256_movemask_pd (any) != 0;
+   double rlo = loLanes [0];
+   double rhi = hiLanes [0];
+   for (int k = 1; k < 4; k++) {
+      if (loLanes [k] < rlo) rlo = loLanes [k];
+      if (hiLanes [k] > rhi) rhi = hiLanes [k];
+   }
+
+   double tlo, thi;
+   if (portableMinMax (source + j, count - j, includeInf, tlo, thi)) {
+      if (found) {
+         if (tlo < rlo) rlo = tlo;
+         if (thi > rhi) rhi = thi;
+      } else {
+         rlo = tlo;
+         rhi = thi;
+         found = true;
+      }
+   }
+
+   if (found) {
+      minimum = rlo;
+      maximum = rhi;
+   }
+   return found;
+}
+
+//------------------------------------------------------------------------------
+//
+QE_TARGET_AVX2
+static void avx2SumAndSumSquares (const double* source, const int count,
+                                  double& sum, double& sumSquares)
+{
+   __m256d s = _mm256_setzero_pd ();
+   __m256d ss = _mm256_setzero_pd ();
+   int j = 0;
+   for (; j + 4 <= count; j += 4) {
+      const __m256d v = _mm256_loadu_pd (source + j);
+      s = _mm256_add_pd (s, v);
+      ss = _mm256_add_pd (ss, _mm256_mul_pd (v, v));
+   }
+
+   double sLanes [4];
+   double ssLanes [4];
+   _mm256_storeu_pd (sLanes, s);
+   _mm256_storeu_pd (ssLanes, ss);
+
+   double ts, tss;
+   portableSumAndSumSquares (source + j, count - j, ts, tss);
+   sum = (sLanes [0] + sLanes [1]) + (sLanes [2] + sLanes [3]) + ts;
+   sumSquares = (ssLanes [0] + ssLanes [1]) + (ssLanes [2] + ssLanes [3]) + tss;
+}
+
+//------------------------------------------------------------------------------
+// Note: deliberately no FMA, so that results match the portable version.
+//
+QE_TARGET_AVX2
+static void avx2Affine (double* data, const int count, const double m, const double c)
+{
+   const __m256d vm = _mm256_set1_pd (m);
+   const __m256d vc = _mm256_set1_pd (c);
+   int j = 0;
+   for (; j + 4 <= count; j += 4) {
+      const __m256d v = _mm256_loadu_pd (data + j);
+      _mm256_storeu_pd (data + j, _mm256_add_pd (_mm256_mul_pd (vm, v), vc));
+   }
+   portableAffine (data + j, count - j, m, c);
+}
+
+//------------------------------------------------------------------------------
+//
+QE_TARGET_AVX2
+static int avx2ReplaceNonFinite (double* data, const int count, const double replacement)
+{
+   const __m256d posInf = _mm256_set1_pd (std::numeric_limits<double>::infinity ());
+   const __m256d signMask = _mm256_set1_pd (-0.0);
+   const __m256d vr = _mm256_set1_pd (replacement);
+   static const int bits [16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+   int number = 0;
+   int j = 0;
+   for (; j + 4 <= count; j += 4) {
+      const __m256d v = _mm256_loadu_pd (data + j);
+      const __m256d finite = _mm256_cmp_pd (_mm256_andnot_pd (signMask, v), posInf, _CMP_LT_OQ);
+      const int mask = _mm256_movemask_pd (finite);
+      if (mask != 15) {
+         _mm256_storeu_pd (data + j, _mm256_blendv_pd (vr, v, finite));
+         number += 4 - bits [mask];
+      }
+   }
+   number += portableReplaceNonFinite (data + j, count - j, replacement);
+   return number;
+}
+
+//------------------------------------------------------------------------------
+//
+QE_TARGET_AVX2
+static void avx2Derivative (const double* x, const double* y, double* dydx, const int count)
+{
+   if (!derivativeEnds (x, y, dydx, count)) return;
+
+   const __m256d signMask = _mm256_set1_pd (-0.0);
+   const __m256d minDelta = _mm256_set1_pd (MIN_DELTA_X);
+   const int last = count - 2;
+   int j = 1;
+   for (; j + 3 <= last; j += 4) {
+      const __m256d xp2 = _mm256_loadu_pd (x + j);
+      const __m256d yp2 = _mm256_loadu_pd (y + j);
+      const __m256d x1 = _mm256_sub_pd (_mm256_loadu_pd (x + j - 1), xp2);
+      const __m256d y1 = _mm256_sub_pd (_mm256_loadu_pd (y + j - 1), yp2);
+      const __m256d x3 = _mm256_sub_pd (_mm256_loadu_pd (x + j + 1), xp2);
+      const __m256d y3 = _mm256_sub_pd (_mm256_loadu_pd (y + j + 1), yp2);
+
+      const __m256d divisor = _mm256_mul_pd (_mm256_mul_pd (x1, x3), _mm256_sub_pd (x3, x1));
+      const __m256d numerator = _mm256_sub_pd (_mm256_mul_pd (_mm256_mul_pd (y1, x3), x3),
+                                               _mm256_mul_pd (_mm256_mul_pd (y3, x1), x1));
+      const __m256d okay = _mm256_cmp_pd (_mm256_andnot_pd (signMask, divisor), minDelta, _CMP_GE_OQ);
+      _mm256_storeu_pd (dydx + j, _mm256_and_pd (okay, _mm256_div_pd (numerator, divisor)));
+   }
+   portableDerivativeMiddle (x, y, dydx, j, last);
+}
+
+//------------------------------------------------------------------------------
+//
+static bool cpuHasAvx2 ()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+   int info [4];
+   __cpuid (info, 0);
+   if (info [0] < 7) return false;
+
+   // Check OSXSAVE and AVX, and that the OS saves the YMM registers.
+   //
+   __cpuid (info, 1);
+   const bool osxsave = (info [2] & (1 << 27)) != 0;
+   const bool avx = (info [2] & (1 << 28)) != 0;
+   if (!osxsave || !avx) return false;
+   if ((_xgetbv (0) & 0x6) != 0x6) return false;
+
+   __cpuidex (info, 7, 0);
+   return (info [1] & (1 << 5)) != 0;
+#elif defined(__GNUC__) || defined(__clang__)
+   __builtin_cpu_init ();
+   return __builtin_cpu_supports ("avx2") != 0;
+#else
+   return false;
+#endif
+}
+
+#endif  // QE_NUMERIC_X86
+
+//==============================================================================
+// Dispatch tables
+//==============================================================================
+//
+struct KernelTable {
+   QENumericKernels::InstructionSets set;
+   void (*int8ToDouble)   (const int8_t*,   double*, const int);
+   void (*uint8ToDouble)  (const uint8_t*,  double*, const int);
+   void (*int16ToDouble)  (const int16_t*,  double*, const int);
+   void (*uint16ToDouble) (const uint16_t*, double*, const int);
+   void (*int32ToDouble)  (const int32_t*,  double*, const int);
+   void (*uint32ToDouble) (const uint32_t*, double*, const int);
+   void (*floatToDouble)  (const float*,    double*, const int);
+   bool (*minMax) (const double*, const int, const bool, double&, double&);
+   void (*sumAndSumSquares) (const double*, const int, double&, double&);
+   void (*affine) (double*, const int, const double, const double);
+   int  (*replaceNonFinite) (double*, const int, const double);
+   void (*derivative) (const double*, const double*, double*, const int);
+};
+
+static const KernelTable portableTable = {
+   QENumericKernels::Portable,
+   portableToDouble<int8_t>,  portableToDouble<uint8_t>,
+   portableToDouble<int16_t>, portableToDouble<uint16_t>,
+   portableToDouble<int32_t>, portableToDouble<uint32_t>,
+   portableToDouble<float>,
+   portableMinMax, portableSumAndSumSquares, portableAffine,
+   portableReplaceNonFinite, portableDerivative
+};
+
+#if QE_NUMERIC_X86
+static const KernelTable sse2Table = {
+   QENumericKernels::SSE2,
+   sse2Int8ToDouble,  sse2Uint8ToDouble,
+   sse2Int16ToDouble, sse2Uint16ToDouble,
+   sse2Int32ToDouble, sse2Uint32ToDouble,
+   sse2FloatToDouble,
+   sse2MinMax, sse2SumAndSumSquares, sse2Affine,
+   sse2ReplaceNonFinite, sse2Derivative
+};
+
+static const KernelTable avx2Table = {
+   QENumericKernels::AVX2,
+   avx2Int8ToDouble,  avx2Uint8ToDouble,
+   avx2Int16ToDouble, avx2Uint16ToDouble,
+   avx2Int32ToDouble, avx2Uint32ToDouble,
+   avx2FloatToDouble,
+   avx2MinMax, avx2SumAndSumSquares, avx2Affine,
+   avx2ReplaceNonFinite, avx2Derivative
+};
+#endif
+
+//------------------------------------------------------------------------------
+//
+static const KernelTable* tableFor (const QENumericKernels::InstructionSets set)
+{
+#if QE_NUMERIC_X86
+   switch (set) {
+      case QENumericKernels::AVX2: return &avx2Table;
+      case QENumericKernels::SSE2: return &sse2Table;
+      default: break;
+   }
+#else
+   (void) set;
+#endif
+   return &portableTable;
+}
+
+static QENumericKernels::InstructionSets detectInstructionSet ()
+{
+#if QE_NUMERIC_X86
+   return cpuHasAvx2 () ? QENumericKernels::AVX2 : QENumericKernels::SSE2;
+#else
+   return QENumericKernels::Portable;
+#endif
+}
+
+static std::atomic<const KernelTable*> currentTable (nullptr);
+
+static const KernelTable* kernels ()
+{
+   const KernelTable* result = currentTable.load (std::memory_order_acquire);
+   if (!result) {
+      // Benign race - all threads would select the same table.
+      //
+      result = tableFor (QENumericKernels::availableInstructionSet ());
+      currentTable.store (result, std::memory_order_release);
+   }
+   return result;
+}
+
+}  // end anonymous namespace
+
+//==============================================================================
+// QENumericKernels
+//==============================================================================
+//
+// static
+QENumericKernels::InstructionSets QENumericKernels::availableInstructionSet ()
+{
+   static const InstructionSets available = detectInstructionSet ();
+   return available;
+}
+
+//------------------------------------------------------------------------------
+// static
+QENumericKernels::InstructionSets QENumericKernels::instructionSet ()
+{
+   return kernels ()->set;
+}
+
+//------------------------------------------------------------------------------
+// static
+void QENumericKernels::setInstructionSet (const InstructionSets set)
+{
+   const InstructionSets available = QENumericKernels::availableInstructionSet ();
+   const InstructionSets use = (set <= available) ? set : available;
+   currentTable.store (tableFor (use), std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+// static
+const char* QENumericKernels::instructionSetName (const InstructionSets set)
+{
+   switch (set) {
+      case Portable: return "Portable";
+      case SSE2:     return "SSE2";
+      case AVX2:     return "AVX2";
+   }
+   return "Unknown";
+}
+
+//------------------------------------------------------------------------------
+// Call throughs.
+//
+void QENumericKernels::toDouble (const int8_t*   s, double* t, const int n) { if (n > 0) kernels ()->int8ToDouble   (s, t, n); }
+void QENumericKernels::toDouble (const uint8_t*  s, double* t, const int n) { if (n > 0) kernels ()->uint8ToDouble  (s, t, n); }
+void QENumericKernels::toDouble (const int16_t*  s, double* t, const int n) { if (n > 0) kernels ()->int16ToDouble  (s, t, n); }
+void QENumericKernels::toDouble (const uint16_t* s, double* t, const int n) { if (n > 0) kernels ()->uint16ToDouble (s, t, n); }
+void QENumericKernels::toDouble (const int32_t*  s, double* t, const int n) { if (n > 0) kernels ()->int32ToDouble  (s, t, n); }
+void QENumericKernels::toDouble (const uint32_t* s, double* t, const int n) { if (n > 0) kernels ()->uint32ToDouble (s, t, n); }
+void QENumericKernels::toDouble (const float*    s, double* t, const int n) { if (n > 0) kernels ()->floatToDouble  (s, t, n); }
+
+//------------------------------------------------------------------------------
+// static
+bool QENumericKernels::minMax (const double* source, const int count, const bool includeInf,
+                               double& minimum, double& maximum)
+{
+   if (count <= 0) return false;
+   return kernels ()->minMax (source, count, includeInf, minimum, maximum);
+}
+
+//------------------------------------------------------------------------------
+// static
+void QENumericKernels::sumAndSumSquares (const double* source, const int count,
+                                         double& sum, double& sumSquares)
+{
+   if (count <= 0) {
+      sum = 0.0;
+      sumSquares = 0.0;
+      return;
+   }
+   kernels ()->sumAndSumSquares (source, count, sum, sumSquares);
+}
+
+//------------------------------------------------------------------------------
+// static
+void QENumericKernels::affine (double* data, const int count, const double m, const double c)
+{
+   if (count > 0) kernels ()->affine (data, count, m, c);
+}
+
+//------------------------------------------------------------------------------
+// static
+int QENumericKernels::replaceNonFinite (double* data, const int count, const double replacement)
+{
+   if (count <= 0) return 0;
+   return kernels ()->replaceNonFinite (data, count, replacement);
+}
+
+//------------------------------------------------------------------------------
+// static
+void QENumericKernels::derivative (const double* x, const double* y, double* dydx, const int count)
+{
+   if (count > 0) kernels ()->derivative (x, y, dydx, count);
+}
+
+//------------------------------------------------------------------------------
+// Place holders
+//
+QENumericKernels::QENumericKernels () { }
+QENumericKernels::~QENumericKernels () { }
+
+// end
@@ -0,0 +1,102 @@
+/*  QENumericKernels.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Starritt
+ *  Contact details:
+ *    andrew.starritt@synchrotron.org.au
+ */
+
+#ifndef QE_NUMERIC_KERNELS_H
+#define QE_NUMERIC_KERNELS_H
+
+#include <stdint.h>
+#include <QEFrameworkLibraryGlobal.h>
+
+/// Vectorised numeric kernels for the framework's array processing paths,
+/// e.g. QEVectorVariants conversions, QEFloatingArray and QEPlotter.
+///
+/// On x86/x86-64 the best available instruction set (SSE2 or AVX2) is selected
+/// at run time, otherwise a portable implementation is used. All kernels work
+/// on raw, non-overlapping, arrays and perform no bounds checking beyond the
+/// specified count. Results are identical to the portable implementation save
+/// for summation order, i.e. sum and sumSquares may differ in the last bit.
+///
+/// We use a class of static methods as opposed to a set of regular functions,
+/// as per QEPlatform.
+///
+class QE_FRAMEWORK_LIBRARY_SHARED_EXPORT QENumericKernels {
+public:
+   enum InstructionSets {
+      Portable = 0,
+      SSE2,
+      AVX2
+   };
+
+   /// Returns the instruction set currently in use.
+   static InstructionSets instructionSet ();
+
+   /// Returns the best instruction set supported by this build and processor.
+   static InstructionSets availableInstructionSet ();
+
+   /// Select the instruction set to use - intended for testing/benchmarking.
+   /// The requested set is limited to that which is available.
+   static void setInstructionSet (const InstructionSets set);
+
+   static const char* instructionSetName (const InstructionSets set);
+
+   /// Widening conversion to double: target [j] = double (source [j]).
+   static void toDouble (const int8_t*   source, double* target, const int count);
+   static void toDouble (const uint8_t*  source, double* target, const int count);
+   static void toDouble (const int16_t*  source, double* target, const int count);
+   static void toDouble (const uint16_t* source, double* target, const int count);
+   static void toDouble (const int32_t*  source, double* target, const int count);
+   static void toDouble (const uint32_t* source, double* target, const int count);
+   static void toDouble (const float*    source, double* target, const int count);
+
+   /// Finds the minimum and maximum values. NaN values are always ignored and
+   /// +/-inf values are ignored unless includeInf is set. Returns false (and
+   /// leaves minimum/maximum unchanged) when there are no usable values.
+   static bool minMax (const double* source, const int count, const bool includeInf,
+                       double& minimum, double& maximum);
+
+   /// Calculates the sum and sum of squares of all values.
+   static void sumAndSumSquares (const double* source, const int count,
+                                 double& sum, double& sumSquares);
+
+   /// Affine scaling in situ:  data [j] = m * data [j] + c
+   static void affine (double* data, const int count, const double m, const double c);
+
+   /// Replaces all NaN and +/-inf values with the replacement value.
+   /// Returns the number of values replaced.
+   static int replaceNonFinite (double* data, const int count, const double replacement);
+
+   /// Derivative of y with respect to x, using three-point quadratic for the
+   /// middle points and two-point linear for the end points. Where the points
+   /// are too close in x, the derivative is set to 0.0.
+   /// Needs count >= 1; dydx must have space for count values.
+   static void derivative (const double* x, const double* y, double* dydx, const int count);
+
+private:
+   explicit QENumericKernels ();
+   ~QENumericKernels ();
+};
+
+#endif  // QE_NUMERIC_KERNELS_H
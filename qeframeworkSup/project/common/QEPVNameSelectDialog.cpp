@@ -56,6 +56,36 @@ QStringList QEPVNameSelectDialog::getPvNameList ()
    return QEPVNameSelectDialog::pvNameList;
 }
 
+//------------------------------------------------------------------------------
+// static
+// The user defined list is typically small, whereas the archived list may well
+// be very large. We search each separately, using the archive manager's shared
+// index, and merge the results. This avoids forming, sorting and searching a
+// combined list on each and every filter change.
+//
+QStringList QEPVNameSelectDialog::getMatchingPvNames (const QRegularExpression& re,
+                                                      int& numberOfNames)
+{
+   QSharedPointer<const QEPvNameSearch> archiveNames = QEArchiveAccess::getPvNameSearch ();
+   const QEPvNameSearch userNames (QEPVNameSelectDialog::pvNameList);
+
+   numberOfNames = archiveNames->count ();
+   const QStringList userList = userNames.getAllPvNames ();
+   for (int j = 0; j < userList.count (); j++) {
+      if (!archiveNames->contains (userList.at (j))) numberOfNames++;
+   }
+
+   QStringList result = archiveNames->getMatchingPvNames (re, true);
+   const QStringList userMatches = userNames.getMatchingPvNames (re, true);
+   if (!userMatches.isEmpty ()) {
+      result.append (userMatches);
+      result.sort ();
+      result.removeDuplicates ();
+   }
+
+   return result;
+}
+
 //------------------------------------------------------------------------------
 //
 QEPVNameSelectDialog::QEPVNameSelectDialog (QWidget *parent) :
@@ -146,18 +176,12 @@ void QEPVNameSelectDialog::applyFilter ()
    QString pattern = this->ui->filterEdit->text ().trimmed ();
    QRegularExpression re (pattern, QRegularExpression::NoPatternOption);
 
-   // Form list of PV names from both the user defined arbitary list
+   // Find matching PV names from both the user defined arbitary list
    // and the list extarcted from the QEArchiveAccess.
    //
-   QEPvNameSearch findNames (QEPVNameSelectDialog::pvNameList);
-
-   // addPvNameList ensures overall set of names is sorted and unique.
-   //
-   findNames.addPvNameList (QEArchiveAccess::getAllPvNames ());
-   const int m = findNames.count ();
-
+   int m = 0;
    this->filteredNames.clear ();
-   this->filteredNames = findNames.getMatchingPvNames (re, true);
+   this->filteredNames = QEPVNameSelectDialog::getMatchingPvNames (re, m);
    const int n = this->filteredNames.count ();
 
    this->ui->pvNameEdit->clear ();
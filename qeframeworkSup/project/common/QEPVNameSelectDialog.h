@@ -28,6 +28,7 @@
 #define QE_PVNAME_SELECT_DIALOG_H
 
 #include <QString>
+#include <QRegularExpression>
 #include <QStringList>
 #include <QWidget>
 #include <QEDialog.h>
@@ -57,6 +58,13 @@ public:
    static void setPvNameList (const QStringList& pvNameList);
    static QStringList getPvNameList ();
 
+   // Returns the sorted/unique names from both the user defined list and the
+   // archived PV names which match the regular expression (exact match).
+   // numberOfNames is set to the total number of unique names searched.
+   //
+   static QStringList getMatchingPvNames (const QRegularExpression& re,
+                                          int& numberOfNames);
+
 protected:
    void closeEvent (QCloseEvent * e);
 
@@ -25,25 +25,32 @@
  */
 
 #include <QEPvNameSearch.h>
+#include <algorithm>
+#include <QList>
 
 //------------------------------------------------------------------------------
 //
 QEPvNameSearch::QEPvNameSearch ()
 {
    this->pvNameList.clear ();
+   this->indexed = false;
 }
 
 //------------------------------------------------------------------------------
+// Other list already sorted/unique, and any index is equally applicable.
 //
 QEPvNameSearch::QEPvNameSearch (const QEPvNameSearch& other)
 {
-   this->setPvNameList (other.pvNameList);
+   this->pvNameList = other.pvNameList;
+   this->trigramIndex = other.trigramIndex;
+   this->indexed = other.indexed;
 }
 
 //------------------------------------------------------------------------------
 //
 QEPvNameSearch::QEPvNameSearch (const QStringList& pvNameListIn)
 {
+   this->indexed = false;
    this->setPvNameList (pvNameListIn);
 }
 
@@ -52,12 +59,14 @@ QEPvNameSearch::QEPvNameSearch (const QStringList& pvNameListIn)
 QEPvNameSearch::~QEPvNameSearch ()
 {
    this->pvNameList.clear ();
+   this->clearIndex ();
 }
 
 //------------------------------------------------------------------------------
 //
 void QEPvNameSearch::clear ()
 {
+   this->clearIndex ();
    return this->pvNameList.clear();
 }
 
@@ -72,6 +81,7 @@ int QEPvNameSearch::count () const
 //
 void QEPvNameSearch::setPvNameList (const QStringList& pvNameListIn)
 {
+   this->clearIndex ();
    this->pvNameList = pvNameListIn;
 
    // Ensure sorted/unique
@@ -84,6 +94,7 @@ void QEPvNameSearch::setPvNameList (const QStringList& pvNameListIn)
 //
 void QEPvNameSearch::addPvNameList (const QStringList& pvNameListIn)
 {
+   this->clearIndex ();
    this->pvNameList.append (pvNameListIn);
    this->pvNameList.sort ();
    this->pvNameList.removeDuplicates ();
@@ -96,6 +107,246 @@ QStringList QEPvNameSearch::getAllPvNames () const
    return this->pvNameList;
 }
 
+//------------------------------------------------------------------------------
+//
+bool QEPvNameSearch::contains (const QString& pvName) const
+{
+   QStringList::const_iterator it = std::lower_bound (this->pvNameList.constBegin (),
+                                                      this->pvNameList.constEnd (),
+                                                      pvName);
+   return (it != this->pvNameList.constEnd ()) && (*it == pvName);
+}
+
+//------------------------------------------------------------------------------
+//
+void QEPvNameSearch::clearIndex ()
+{
+   this->trigramIndex.clear ();
+   this->indexed = false;
+}
+
+//------------------------------------------------------------------------------
+// static
+quint64 QEPvNameSearch::trigramKey (const QString& text, const int index)
+{
+   return (quint64 (text.at (index).unicode ()) << 32) |
+          (quint64 (text.at (index + 1).unicode ()) << 16) |
+           quint64 (text.at (index + 2).unicode ());
+}
+
+//------------------------------------------------------------------------------
+// The trigrams are case insensitive, so the one index serves both case
+// sensitive and case insensitive searches - the candidates are verified anyway.
+//
+void QEPvNameSearch::buildIndex ()
+{
+   this->clearIndex ();
+
+   QVector<quint64> keys;
+   const int n = this->pvNameList.count ();
+   for (int j = 0; j < n; j++) {
+      const QString lower = this->pvNameList.at (j).toLower ();
+
+      keys.resize (0);
+      for (int k = 0; k + 3 <= lower.length (); k++) {
+         keys.append (QEPvNameSearch::trigramKey (lower, k));
+      }
+
+      // Only add each name once per trigram. As j is increasing, each posting
+      // list is inherently in ascending order.
+      //
+      std::sort (keys.begin (), keys.end ());
+      QVector<quint64>::iterator end = std::unique (keys.begin (), keys.end ());
+      for (QVector<quint64>::iterator it = keys.begin (); it != end; ++it) {
+         this->trigramIndex [*it].append (j);
+      }
+   }
+
+   for (TrigramIndex::iterator it = this->trigramIndex.begin ();
+        it != this->trigramIndex.end (); ++it) {
+      it->squeeze ();
+   }
+
+   this->indexed = true;
+}
+
+//------------------------------------------------------------------------------
+//
+bool QEPvNameSearch::isIndexed () const
+{
+   return this->indexed;
+}
+
+//------------------------------------------------------------------------------
+//
+static void endLiteralRun (QString& run, bool& isLeading,
+                           QString& prefix, QStringList& literals)
+{
+   if (isLeading) prefix = run;
+   isLeading = false;
+   if (!run.isEmpty ()) literals.append (run);
+   run.clear ();
+}
+
+//------------------------------------------------------------------------------
+// This is deliberately conservative. We do not need every literal, but every
+// literal we do extract must be present in any matching name. Groups and
+// alternation are not analysed - we just give up.
+// static
+bool QEPvNameSearch::extractLiterals (const QString& pattern,
+                                      QString& prefix, QStringList& literals)
+{
+   prefix.clear ();
+   literals.clear ();
+
+   const int n = pattern.length ();
+   int j = 0;
+
+   bool isLeading = false;
+   while ((j < n) && (pattern.at (j) == QChar ('^'))) {
+      isLeading = true;
+      j++;
+   }
+
+   QString run;
+   while (j < n) {
+      const QChar c = pattern.at (j);
+
+      if (c == QChar ('\\')) {
+         if (j + 1 >= n) return false;
+         const QChar e = pattern.at (j + 1);
+         j += 2;
+         if (QString ("dDsSwWhHvVbBAzZGaefnrt").contains (e)) {
+            // Character class, assertion or control character - not a literal,
+            // and (unlike \x, \c, \Q, \1 etc.) not followed by any operands.
+            endLiteralRun (run, isLeading, prefix, literals);
+         } else if (e.isLetterOrNumber ()) {
+            // Hex, octal, control, unicode, quoted text, back reference etc.
+            // The characters that follow are operands, not literals, so give up.
+            return false;
+         } else {
+            run.append (e);
+         }
+
+      } else if ((c == QChar ('(')) || (c == QChar (')')) || (c == QChar ('|'))) {
+         return false;
+
+      } else if ((c == QChar ('.')) || (c == QChar ('^')) || (c == QChar ('$'))) {
+         endLiteralRun (run, isLeading, prefix, literals);
+         j++;
+
+      } else if (c == QChar ('[')) {
+         // Skip the character class. A leading ']' (after any '^') is literal.
+         //
+         endLiteralRun (run, isLeading, prefix, literals);
+         j++;
+         if ((j < n) && (pattern.at (j) == QChar ('^'))) j++;
+         if ((j < n) && (pattern.at (j) == QChar (']'))) j++;
+         while ((j < n) && (pattern.at (j) != QChar (']'))) {
+            // POSIX classes such as [:alpha:] contain a ']' - just give up.
+            if ((pattern.at (j) == QChar ('[')) && (j + 1 < n) &&
+                QString (":.=").contains (pattern.at (j + 1))) return false;
+            j += (pattern.at (j) == QChar ('\\')) ? 2 : 1;
+         }
+         if (j >= n) return false;
+         j++;
+
+      } else if ((c == QChar ('*')) || (c == QChar ('?')) || (c == QChar ('{'))) {
+         // The previous item is optional, so it's not part of the literal.
+         //
+         run.chop (1);
+         endLiteralRun (run, isLeading, prefix, literals);
+         if (c == QChar ('{')) {
+            while ((j < n) && (pattern.at (j) != QChar ('}'))) j++;
+         }
+         j++;
+
+      } else if (c == QChar ('+')) {
+         // The previous item is required, but the run stops here.
+         //
+         endLiteralRun (run, isLeading, prefix, literals);
+         j++;
+
+      } else {
+         run.append (c);
+         j++;
+      }
+   }
+
+   endLiteralRun (run, isLeading, prefix, literals);
+   return true;
+}
+
+//------------------------------------------------------------------------------
+// Names with a common prefix are contiguous within the sorted list.
+//
+void QEPvNameSearch::prefixRange (const QString& prefix, int& first, int& last) const
+{
+   const QStringList::const_iterator begin = this->pvNameList.constBegin ();
+   const QStringList::const_iterator end = this->pvNameList.constEnd ();
+
+   QStringList::const_iterator lower = std::lower_bound (begin, end, prefix);
+   QStringList::const_iterator upper =
+         std::partition_point (lower, end, [&prefix] (const QString& name) {
+                                  return name.startsWith (prefix);
+                               });
+
+   first = int (lower - begin);
+   last = int (upper - begin);
+}
+
+//------------------------------------------------------------------------------
+//
+static bool shorterPostingList (const QVector<int>* a, const QVector<int>* b)
+{
+   return a->count () < b->count ();
+}
+
+//------------------------------------------------------------------------------
+//
+bool QEPvNameSearch::trigramCandidates (const QStringList& literals,
+                                        PostingList& candidates) const
+{
+   candidates.clear ();
+   if (!this->indexed) return false;
+
+   QList<const PostingList*> lists;
+   for (int j = 0; j < literals.count (); j++) {
+      const QString lower = literals.at (j).toLower ();
+      for (int k = 0; k + 3 <= lower.length (); k++) {
+         TrigramIndex::const_iterator it =
+               this->trigramIndex.constFind (QEPvNameSearch::trigramKey (lower, k));
+         if (it == this->trigramIndex.constEnd ()) {
+            return true;     // no name can match
+         }
+         lists.append (&it.value ());
+      }
+   }
+
+   if (lists.isEmpty ()) return false;   // all literals too short
+
+   // Intersect starting with the shortest lists - this keeps the work down.
+   //
+   std::sort (lists.begin (), lists.end (), shorterPostingList);
+
+   candidates = *lists.at (0);
+   PostingList work;
+   for (int j = 1; j < lists.count () && !candidates.isEmpty (); j++) {
+      const PostingList* other = lists.at (j);
+      if (other == lists.at (j - 1)) continue;
+
+      work.resize (candidates.count ());
+      PostingList::iterator end =
+            std::set_intersection (candidates.constBegin (), candidates.constEnd (),
+                                   other->constBegin (), other->constEnd (),
+                                   work.begin ());
+      work.resize (int (end - work.begin ()));
+      candidates.swap (work);
+   }
+
+   return true;
+}
+
 //------------------------------------------------------------------------------
 //
 QStringList QEPvNameSearch::getMatchingPvNames (const QRegularExpression& reIn,
@@ -111,7 +362,41 @@ QStringList QEPvNameSearch::getMatchingPvNames (const QRegularExpression& reIn,
       QString pattern = QString ("^") + reIn.pattern() + QString ("$");
       re.setPattern (pattern);
    }
-   result = this->pvNameList.filter (re);
+
+   const QRegularExpression::PatternOptions options = re.patternOptions ();
+
+   // Extended syntax ignores white space, and hence invalidates our literals.
+   //
+   QString prefix;
+   QStringList literals;
+   if (!this->indexed ||
+       (options & QRegularExpression::ExtendedPatternSyntaxOption) ||
+       !QEPvNameSearch::extractLiterals (re.pattern (), prefix, literals)) {
+      result = this->pvNameList.filter (re);
+      return result;
+   }
+
+   int first = 0;
+   int last = this->pvNameList.count ();
+   if (!prefix.isEmpty () && !(options & QRegularExpression::CaseInsensitiveOption)) {
+      this->prefixRange (prefix, first, last);
+   }
+
+   PostingList candidates;
+   if (this->trigramCandidates (literals, candidates)) {
+      PostingList::const_iterator it = std::lower_bound (candidates.constBegin (),
+                                                         candidates.constEnd (), first);
+      for (; it != candidates.constEnd () && *it < last; ++it) {
+         const QString& name = this->pvNameList.at (*it);
+         if (re.match (name).hasMatch ()) result.append (name);
+      }
+   } else {
+      for (int j = first; j < last; j++) {
+         const QString& name = this->pvNameList.at (j);
+         if (re.match (name).hasMatch ()) result.append (name);
+      }
+   }
+
    return result;
 }
 
@@ -120,7 +405,17 @@ QStringList QEPvNameSearch::getMatchingPvNames (const QRegularExpression& reIn,
 QStringList QEPvNameSearch::getMatchingPvNames (const QString& str,
                                                 const Qt::CaseSensitivity cs) const
 {
-   return this->pvNameList.filter (str, cs);
+   PostingList candidates;
+   if (!this->trigramCandidates (QStringList () << str, candidates)) {
+      return this->pvNameList.filter (str, cs);
+   }
+
+   QStringList result;
+   for (int j = 0; j < candidates.count (); j++) {
+      const QString& name = this->pvNameList.at (candidates.at (j));
+      if (name.contains (str, cs)) result.append (name);
+   }
+   return result;
 }
 
 // end
@@ -27,9 +27,11 @@
 #ifndef QE_PV_NAME_SEARCH_H
 #define QE_PV_NAME_SEARCH_H
 
+#include <QHash>
 #include <QRegularExpression>
 #include <QString>
 #include <QStringList>
+#include <QVector>
 
 #include <QEFrameworkLibraryGlobal.h>
 
@@ -39,6 +41,13 @@
 //
 // QEPvNameSearch is essentially just a contrainer/wrapper around a QStringList
 //
+// For large name lists, i.e. many 100,000s of names, a search index may be built.
+// This comprises the sorted name list itself, used as a prefix array for anchored
+// expressions, and a trigram index used for substring searches and to pre-filter
+// regular expression searches using any literal text within the expression.
+// Candidate names are always verified, so the results are identical to those
+// returned by an un-indexed search.
+//
 class QE_FRAMEWORK_LIBRARY_SHARED_EXPORT QEPvNameSearch {
 public:
    explicit QEPvNameSearch ();
@@ -62,6 +71,18 @@ public:
 
    QStringList getAllPvNames () const;
 
+   // Returns true if the name is held - this uses a binary search.
+   //
+   bool contains (const QString& pvName) const;
+
+   // Builds the search index. This is relatively expensive, and is best done once
+   // off the GUI thread, after which the object may be shared (as a const object)
+   // as the getMatchingPvNames functions are thread safe.
+   // Note: clear, setPvNameList and addPvNameList discard the index.
+   //
+   void buildIndex ();
+   bool isIndexed () const;
+
    // The getMatchingPVnames functions allow the caller to extract a subset of
    // available PV names. The first uses a regular expression and allows for
    // sophisticated pattern matching. The second just returns a list of all the
@@ -74,7 +95,33 @@ public:
    QStringList getMatchingPvNames (const QString& str, const Qt::CaseSensitivity cs) const;
 
 private:
+   typedef QVector<int> PostingList;       // indices into pvNameList, ascending
+   typedef QHash<quint64, PostingList> TrigramIndex;
+
+   void clearIndex ();
+
+   static quint64 trigramKey (const QString& text, const int index);
+
+   // Extracts the literal text runs of a regular expression pattern that any
+   // matching name must contain, plus the literal prefix (if any) of an anchored
+   // pattern. Returns false if the pattern is too complex to analyse.
+   //
+   static bool extractLiterals (const QString& pattern,
+                                QString& prefix, QStringList& literals);
+
+   // Finds the range [first, last) of names that start with the given prefix.
+   //
+   void prefixRange (const QString& prefix, int& first, int& last) const;
+
+   // Returns false if no candidates could be determined, i.e. all names are
+   // candidates, otherwise candidates holds the indices of names that contain
+   // all of the literals' trigrams (case insensitive).
+   //
+   bool trigramCandidates (const QStringList& literals, PostingList& candidates) const;
+
    QStringList pvNameList;
+   TrigramIndex trigramIndex;
+   bool indexed;
 };
 
 #endif // QE_PV_NAME_SEARCH_H
@@ -92,6 +92,9 @@ HEADERS += $$PWD/QEPVNameSelectDialog.h
 SOURCES += $$PWD/QEPVNameSelectDialog.cpp
 FORMS   += $$PWD/QEPVNameSelectDialog.ui
 
+HEADERS += $$PWD/QENumericKernels.h
+SOURCES += $$PWD/QENumericKernels.cpp
+
 HEADERS += $$PWD/QEPlatform.h
 SOURCES += $$PWD/QEPlatform.cpp
 
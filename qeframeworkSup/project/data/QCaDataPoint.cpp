@@ -115,7 +115,11 @@ QString QCaDataPoint::toString () const
    QString severityText = "?";
    QString statusText = "?";
 
-   zone = QEUtilities::getTimeZoneTLA (this->datetime);
+   // This is a display boundary - convert to a full QDateTime.
+   //
+   const QCaDateTime displayDateTime (this->datetime);
+
+   zone = QEUtilities::getTimeZoneTLA (displayDateTime);
    valid = this->isDisplayable () ? "True " : "False";
    severity = (QEArchiveInterface::archiveAlarmSeverity) this->alarm.getSeverity ();
    severityText = QEArchiveInterface::alarmSeverityName (severity);
@@ -124,7 +128,7 @@ QString QCaDataPoint::toString () const
    // At some timme the MMM (from the format string) changed from "Jan" to "Jan."
    // So much for backward compatibility. Lose the "." if it exists.
    //
-   QString dateTimeImage = datetime.toString (stdFormat);
+   QString dateTimeImage = displayDateTime.toString (stdFormat);
    if (dateTimeImage [6] == '.') {
       dateTimeImage = dateTimeImage.remove (6, 1);
    }
@@ -142,7 +146,7 @@ QString QCaDataPoint::toString () const
 
 //------------------------------------------------------------------------------
 //
-QString QCaDataPoint::toString (const QCaDateTime& originDateTime) const
+QString QCaDataPoint::toString (const QCaTimeStamp& originDateTime) const
 {
    QString result;
    QString zone;
@@ -152,7 +156,9 @@ QString QCaDataPoint::toString (const QCaDateTime& originDateTime) const
    QString severityText = "?";
    QString statusText = "?";
 
-   zone = QEUtilities::getTimeZoneTLA (this->datetime);
+   const QCaDateTime displayDateTime (this->datetime);
+
+   zone = QEUtilities::getTimeZoneTLA (displayDateTime);
    valid = this->isDisplayable () ? "True " : "False";
    severity = (QEArchiveInterface::archiveAlarmSeverity) this->alarm.getSeverity ();
    severityText = QEArchiveInterface::alarmSeverityName (severity);
@@ -165,7 +171,7 @@ QString QCaDataPoint::toString (const QCaDateTime& originDateTime) const
    // At some timme the MMM (from the format string) changed from "Jan" to "Jan."
    // So much for backward compatibility. Lose the "." if it exists.
    //
-   QString dateTimeImage = datetime.toString (stdFormat);
+   QString dateTimeImage = displayDateTime.toString (stdFormat);
    if (dateTimeImage [6] == '.') {
       dateTimeImage = dateTimeImage.remove (6, 1);
    }
@@ -290,19 +296,24 @@ void QCaDataPointList::truncate (const int position)
 
 //------------------------------------------------------------------------------
 //
-int QCaDataPointList::indexBeforeTime (const QCaDateTime& searchTime,
+int QCaDataPointList::indexBeforeTime (const QCaTimeStamp& searchTime,
                                        const int defaultIndex) const
 {
    // Cover "corner-case" specific no answer cases.
    //
    if (this->data.count () <= 0) return defaultIndex;
-   if (this->data.value (0).datetime > searchTime) return defaultIndex;
+
+   // Access the points by reference - avoids a copy per probe.
+   //
+   const QCaDataPoint* points = this->data.constData ();
+
+   if (points [0].datetime > searchTime) return defaultIndex;
 
    // Cover no need to search case.
    //
    int first = 0;
    int last = this->data.count () - 1;
-   if (this->data.value (last).datetime <= searchTime) return last;
+   if (points [last].datetime <= searchTime) return last;
 
    // We know first point <= searchTime, last point > searchTime
    // While first and last are not adjacent...
@@ -310,7 +321,7 @@ int QCaDataPointList::indexBeforeTime (const QCaDateTime& searchTime,
       // Perform binary search to find point of iterest.
       //
       int midway = (first + last) / 2;
-      if (this->data.value (midway).datetime <= searchTime) {
+      if (points [midway].datetime <= searchTime) {
          first = midway;
       } else {
          last = midway;
@@ -324,7 +335,7 @@ int QCaDataPointList::indexBeforeTime (const QCaDateTime& searchTime,
 
 //------------------------------------------------------------------------------
 //
-const QCaDataPoint* QCaDataPointList::findNearestPoint (const QCaDateTime& searchTime) const
+const QCaDataPoint* QCaDataPointList::findNearestPoint (const QCaTimeStamp& searchTime) const
 {
    const int number = this->data.count ();
    const int first = 0;
@@ -340,8 +351,8 @@ const QCaDataPoint* QCaDataPointList::findNearestPoint (const QCaDateTime& searc
    const int before = this->indexBeforeTime (searchTime, 0);
    const int after = before + 1;
 
-   double bsdt = this->data.value (before).datetime.secondsTo (searchTime);
-   double sadt = searchTime.secondsTo (this->data.value (after).datetime);
+   const qint64 bsdt = this->data [before].datetime.nanoSecsTo (searchTime);
+   const qint64 sadt = searchTime.nanoSecsTo (this->data [after].datetime);
 
    const QCaDataPoint*  result = (bsdt < sadt) ? &this->data [before] : &this->data [after];
    return result;
@@ -351,12 +362,12 @@ const QCaDataPoint* QCaDataPointList::findNearestPoint (const QCaDateTime& searc
 //
 void QCaDataPointList::resample (const QCaDataPointList& source,
                                  const double interval,
-                                 const QCaDateTime& endTime)
+                                 const QCaTimeStamp& endTime)
 {
-   QCaDateTime firstTime;
+   QCaTimeStamp firstTime;
    int j;
    int next;
-   QCaDateTime jthTime;
+   QCaTimeStamp jthTime;
    QCaDataPoint point;
 
    this->clear ();
@@ -367,9 +378,7 @@ void QCaDataPointList::resample (const QCaDataPointList& source,
    next = 0;
    for (j = 0; jthTime < endTime; j++) {
 
-      // Calculate to nearest mSec.
-      //
-      jthTime = firstTime.addMSecs ((qint64)( (double) j * 1000.0 * interval));
+      jthTime = firstTime.addSeconds ((double) j * interval);
 
       while (next < source.count () && source.value (next).datetime <= jthTime) next++;
       point = source.value (next - 1);
@@ -410,7 +419,7 @@ void QCaDataPointList::toStream (QTextStream& target,
 {
    int number = this->count ();
    int j;
-   QCaDateTime originDateTime;
+   QCaTimeStamp originDateTime;
 
    if (number > 0) {
       originDateTime = this->value (0).datetime;
@@ -467,7 +476,7 @@ bool QCaDataPointList::calculateStatistics (Statistics& statistics,
    // X here is time - relative to first time.
    // It's kind of arbitary - the slope works out the same.
    //
-   QCaDateTime startTime = this->data.value (0).datetime;
+   const QCaTimeStamp startTime = this->data.value (0).datetime;
    double sumX = 0.0;
    double sumY = 0.0;
    double sumXX = 0.0;
@@ -495,7 +504,7 @@ bool QCaDataPointList::calculateStatistics (Statistics& statistics,
          } else {
             // Must be extendToTimeNow set true.
             //
-            weight = thisPoint.datetime.secondsTo (QDateTime::currentDateTime().toUTC());
+            weight = thisPoint.datetime.secondsTo (QCaTimeStamp::currentTime ());
          }
 
          sumWeight += weight;
@@ -592,7 +601,7 @@ void QCaDataPointList::distribute (double distribution [], const int size,
          } else {
             // Must be extendToTimeNow set true.
             //
-            weight = thisPoint.datetime.secondsTo (QDateTime::currentDateTime().toUTC());
+            weight = thisPoint.datetime.secondsTo (QCaTimeStamp::currentTime ());
          }
 
          // Avoid divide by zero, and the hence the creation of a NaN slot value
@@ -34,6 +34,7 @@
 
 #include <QCaAlarmInfo.h>
 #include <QCaDateTime.h>
+#include <QCaTimeStamp.h>
 #include <QEFrameworkLibraryGlobal.h>
 
 /// This class used to hold a single data point. Objects of this type are
@@ -53,7 +54,7 @@ public:
    // Generate image of point.
    //
    QString toString () const;                                   // basic
-   QString toString (const QCaDateTime& originDateTime) const;  // ... plus a relative time
+   QString toString (const QCaTimeStamp& originDateTime) const; // ... plus a relative time
 
 
    // Register these meta types.
@@ -65,8 +66,11 @@ public:
    // We don't bother with a variant but just use a double.  A double can be
    // used to hold all CA data types except strings (which is are not plotable).
    //
+   // The time is held as a light weight time stamp as opposed to a QCaDateTime.
+   // Use QCaDateTime (datetime) when a QDateTime is required for display.
+   //
    double value;
-   QCaDateTime datetime;      // datetime + nSec
+   QCaTimeStamp datetime;     // nSec since EPICS epoch
    QCaAlarmInfo alarm;
 };
 
@@ -111,14 +115,14 @@ public:
    // Uses a binary search to find point of iterest.
    // Note: assumes that the data point list is in increasing time order.
    //
-   int indexBeforeTime (const QCaDateTime& searchTime,
+   int indexBeforeTime (const QCaTimeStamp& searchTime,
                         const int defaultIndex) const;
 
    // Return a reference to the point nearest to the specified time or NULL.
    // WARNING - do not store this reference. To be consider valid during the
    // processing of a single event only.
    //
-   const QCaDataPoint* findNearestPoint (const QCaDateTime& searchTime) const;
+   const QCaDataPoint* findNearestPoint (const QCaTimeStamp& searchTime) const;
 
    // Resamples the source list of points into the current list.
    // Items are resampled into data points at fixed time intervals.
@@ -127,7 +131,7 @@ public:
    //
    void resample (const QCaDataPointList& source,
                   const double interval,
-                  const QCaDateTime& endTime);
+                  const QCaTimeStamp& endTime);
 
    // Removes duplicate sample points.
    // Note: any previous data is lost.
@@ -29,9 +29,9 @@
 #include <QTextStream>
 #include <QDebug>
 
-static const QDateTime qtEpoch    (QDate( 1970, 1, 1 ), QTime( 0, 0, 0, 0 ), Qt::UTC );
-static const QDateTime epicsEpoch (QDate( 1990, 1, 1 ), QTime( 0, 0, 0, 0 ), Qt::UTC );
-static unsigned long EPICSQtEpocOffset = qtEpoch.secsTo ( epicsEpoch );
+// Seconds between the Qt epoch (1970-01-01 UTC) and the EPICS epoch (1990-01-01 UTC).
+//
+static const unsigned long EPICSQtEpocOffset = (unsigned long) QCaTimeStamp::epicsEpochOffsetSecs;
 
 /*
   Construct an empty QCa date time
@@ -60,6 +60,23 @@ QCaDateTime::QCaDateTime( const QDateTime& dt ) : QDateTime( dt )
     this->userTag = 0;
 }
 
+/*
+  Construct a QCa date time set to the same date/time as a QCa time stamp
+ */
+QCaDateTime::QCaDateTime( const QCaTimeStamp& timeStamp )
+{
+    // The milli seconds go in the Qt base class structure, the remaining
+    // nanoseconds are saved in this class. Both derived by integer arithmetic.
+    //
+    const qint64 nanoSecs = timeStamp.getNanoSeconds();
+    const qint64 mSecsSinceEpoch = (timeStamp.getSeconds() + QCaTimeStamp::epicsEpochOffsetSecs) * 1000 +
+                                   nanoSecs / 1000000;
+    setMSecsSinceEpoch (mSecsSinceEpoch);
+
+    this->nSec = (unsigned long) (nanoSecs % 1000000);
+    this->userTag = 0;
+}
+
 /*
   Construct a QCa date time set to the same date/time as an EPICS time stamp
  */
@@ -161,12 +178,21 @@ double QCaDateTime::secondsTo( const QDateTime & target ) const
    return double (msec) / double (1000.0);
 }
 
+/*
+  Returns the equivalent light weight time stamp, including the nano seconds.
+ */
+QCaTimeStamp QCaDateTime::toTimeStamp() const
+{
+   const qint64 msec = this->toMSecsSinceEpoch() - QCaTimeStamp::epicsEpochOffsetSecs * 1000;
+   return QCaTimeStamp::fromNanoSecs( msec * 1000000 + qint64 (this->nSec) );
+}
+
 /*
   Returns original number of seconds from EPICS Epoch
  */
 unsigned long QCaDateTime::getSeconds() const
 {
-   qint64 msec = epicsEpoch.msecsTo (*this);
+   qint64 msec = this->toMSecsSinceEpoch() - QCaTimeStamp::epicsEpochOffsetSecs * 1000;
 
    if( msec < 0 ) msec = 0;
    return (unsigned long) (msec / 1000);
@@ -177,7 +203,7 @@ unsigned long QCaDateTime::getSeconds() const
  */
 unsigned long QCaDateTime::getNanoSeconds() const
 {
-   qint64 msec = epicsEpoch.msecsTo (*this);
+   qint64 msec = this->toMSecsSinceEpoch() - QCaTimeStamp::epicsEpochOffsetSecs * 1000;
 
    if( msec < 0 ) msec = 0;
 
@@ -30,6 +30,7 @@
 #define QE_DATE_TIME_H
 
 #include <QDateTime>
+#include <QCaTimeStamp.h>
 #include <QEFrameworkLibraryGlobal.h>
 
 /// Extends the Qt datatime object in irder to provide nSec precision
@@ -45,6 +46,11 @@ public:
     QCaDateTime( const unsigned long seconds,
                  const unsigned long nanoseconds,
                  const int userTag = 0 );
+
+    /// Construct from a light weight time stamp. The resultant object has
+    /// a local time spec (as per the EPICS time constructor).
+    ///
+    explicit QCaDateTime( const QCaTimeStamp& timeStamp );
     ~QCaDateTime();
 
     QCaDateTime& operator=(const QCaDateTime& other);
@@ -65,6 +71,11 @@ public:
     unsigned long getNanoSeconds() const;
     int getUserTag() const;
 
+    /// Conversion to the light weight time stamp - retains nSec precision.
+    ///
+    QCaTimeStamp toTimeStamp() const;
+    operator QCaTimeStamp() const { return toTimeStamp(); }
+
 private:
     unsigned long nSec;
     int userTag;
@@ -121,6 +121,8 @@ void QCaObject::initialise( const QString& newRecordName,
    this->objectIdentity = ++QCaObject::nextObjectIdentity;
 
    this->arrayIndex = 0;
+   this->isFirstMetaUpdate = false;
+   this->isResendUpdate = false;
 
    // Note the record required name and associated index.
    //
@@ -362,6 +364,14 @@ bool QCaObject::getIsMataDataUpdate () const
    return this->isFirstMetaUpdate;
 }
 
+//------------------------------------------------------------------------------
+// Indicates if the current data update is a resend of the last data.
+//
+bool QCaObject::getIsResendUpdate () const
+{
+   return this->isResendUpdate;
+}
+
 //------------------------------------------------------------------------------
 // Return the current value as string
 //
@@ -960,7 +970,9 @@ bool QCaObject::writeDataElement (const QVariant& elementValue)
 void QCaObject::resendLastData()
 {
    if( this->getDataIsAvailable() ){
+      this->isResendUpdate = true;
       this->dataUpdate( false );
+      this->isResendUpdate = false;
    }
 }
 
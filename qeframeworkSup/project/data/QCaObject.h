@@ -165,6 +165,11 @@ public:
    //
    bool getIsMataDataUpdate () const;
 
+   // Indicates if this update is a resend of the last data, i.e. due to a
+   // resendLastData request, as opposed to a new update from the server.
+   //
+   bool getIsResendUpdate () const;
+
    // note: apart for array action, this provides a raw string conversion,
    // i.e. no units, precision or other QEString formatting
    //
@@ -234,6 +239,7 @@ private:
    SignalsToSendFlags signalsToSend;
    int arrayIndex;
    bool isFirstMetaUpdate;
+   bool isResendUpdate;
 
    // This can be one of QECaClient, QEPvaClient or QENullClient.
    //
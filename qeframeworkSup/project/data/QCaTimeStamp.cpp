@@ -0,0 +1,131 @@
+/*  QCaTimeStamp.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Starritt
+ *  Contact details:
+ *    andrew.starritt@synchrotron.org.au
+ */
+
+#include "QCaTimeStamp.h"
+#include <math.h>
+#include <QDateTime>
+
+// Out of class definitions - in case odr-used.
+//
+const qint64 QCaTimeStamp::nanoSecsPerSec;
+const qint64 QCaTimeStamp::epicsEpochOffsetSecs;
+
+static const qint64 nanoSecsPerMSec = 1000000;
+
+//------------------------------------------------------------------------------
+// Integer division that rounds towards minus infinity, with matching modulo,
+// so that pre-epoch times decompose sensibly.
+//
+static inline qint64 floorDiv (const qint64 a, const qint64 b)
+{
+   qint64 q = a / b;
+   if ((a % b != 0) && ((a < 0) != (b < 0))) q--;
+   return q;
+}
+
+static inline qint64 floorMod (const qint64 a, const qint64 b)
+{
+   return a - floorDiv (a, b) * b;
+}
+
+//------------------------------------------------------------------------------
+// static
+QCaTimeStamp QCaTimeStamp::fromUnixTime (const qint64 unixSeconds, const qint64 nsec)
+{
+   return fromNanoSecs ((unixSeconds - epicsEpochOffsetSecs) * nanoSecsPerSec + nsec);
+}
+
+//------------------------------------------------------------------------------
+// static
+QCaTimeStamp QCaTimeStamp::fromMSecsSinceUnixEpoch (const qint64 mSecs)
+{
+   return fromNanoSecs ((mSecs - epicsEpochOffsetSecs * 1000) * nanoSecsPerMSec);
+}
+
+//------------------------------------------------------------------------------
+// static
+qint64 QCaTimeStamp::yearStartSeconds (const int year)
+{
+   // Days since 1970-01-01 of 1st January of the given year.
+   // Based on the well known days from civil algorithm, simplified for
+   // month = 1 and day = 1, i.e. March based year is year - 1.
+   //
+   const qint64 y = qint64 (year) - 1;
+   const qint64 era = floorDiv (y, 400);
+   const qint64 yoe = y - era * 400;                           // [0, 399]
+   const qint64 doy = 306;                                     // 1st Jan is day 306 of a March based year
+   const qint64 doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;   // [0, 146096]
+   const qint64 days = era * 146097 + doe - 719468;
+
+   return days * 86400 - epicsEpochOffsetSecs;
+}
+
+//------------------------------------------------------------------------------
+// static
+QCaTimeStamp QCaTimeStamp::fromYearTime (const int year, const qint64 secondsIntoYear,
+                                         const qint64 nsec)
+{
+   return fromNanoSecs ((yearStartSeconds (year) + secondsIntoYear) * nanoSecsPerSec + nsec);
+}
+
+//------------------------------------------------------------------------------
+// static
+QCaTimeStamp QCaTimeStamp::currentTime ()
+{
+   // Note: currentMSecsSinceEpoch avoids any time zone look up.
+   //
+   return fromMSecsSinceUnixEpoch (QDateTime::currentMSecsSinceEpoch ());
+}
+
+//------------------------------------------------------------------------------
+//
+qint64 QCaTimeStamp::getSeconds () const
+{
+   return floorDiv (this->nanoSecs, nanoSecsPerSec);
+}
+
+//------------------------------------------------------------------------------
+//
+qint64 QCaTimeStamp::getNanoSeconds () const
+{
+   return floorMod (this->nanoSecs, nanoSecsPerSec);
+}
+
+//------------------------------------------------------------------------------
+//
+qint64 QCaTimeStamp::toMSecsSinceUnixEpoch () const
+{
+   return floorDiv (this->nanoSecs, nanoSecsPerMSec) + epicsEpochOffsetSecs * 1000;
+}
+
+//------------------------------------------------------------------------------
+//
+QCaTimeStamp QCaTimeStamp::addSeconds (const double seconds) const
+{
+   return fromNanoSecs (this->nanoSecs + qint64 (floor (seconds * double (nanoSecsPerSec) + 0.5)));
+}
+
+// end
@@ -0,0 +1,130 @@
+/*  QCaTimeStamp.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Starritt
+ *  Contact details:
+ *    andrew.starritt@synchrotron.org.au
+ */
+
+#ifndef QCA_TIME_STAMP_H
+#define QCA_TIME_STAMP_H
+
+#include <QtGlobal>
+#include <QMetaType>
+#include <QEFrameworkLibraryGlobal.h>
+
+/// A light weight, trivially copyable, time stamp holding the number of
+/// nano seconds since the EPICS epoch, i.e. 1990-01-01 00:00:00 UTC.
+///
+/// This is intended for the hot paths, e.g. data points, archive decode and
+/// plotting calculations, where QDateTime's time-spec handling and per-object
+/// allocation is an unnecessary overhead. Conversion to/from a QCaDateTime
+/// (and hence a QDateTime) is provided by QCaDateTime itself and should only
+/// be required at the display/formatting boundaries.
+///
+/// A qint64 covers approximately +/- 292 years about the EPICS epoch.
+///
+class QE_FRAMEWORK_LIBRARY_SHARED_EXPORT QCaTimeStamp {
+public:
+   static const qint64 nanoSecsPerSec = 1000000000;
+
+   /// Offset between the EPICS epoch and the Unix/Qt epoch (1970-01-01 UTC).
+   ///
+   static const qint64 epicsEpochOffsetSecs = 631152000;
+
+   // Construct a null time stamp, i.e. the EPICS epoch.
+   //
+   QCaTimeStamp () : nanoSecs (0) {}
+
+   // Construct from an EPICS time stamp, i.e. seconds past EPICS epoch and nSec.
+   //
+   QCaTimeStamp (const quint32 secPastEpoch, const quint32 nsec) :
+      nanoSecs (qint64 (secPastEpoch) * nanoSecsPerSec + qint64 (nsec)) {}
+
+   // Construct from nano seconds since the EPICS epoch.
+   //
+   static QCaTimeStamp fromNanoSecs (const qint64 nanoSecs) {
+      QCaTimeStamp result;
+      result.nanoSecs = nanoSecs;
+      return result;
+   }
+
+   // Construct from seconds since the Unix epoch (1970-01-01 UTC) plus nSec.
+   //
+   static QCaTimeStamp fromUnixTime (const qint64 unixSeconds, const qint64 nsec);
+
+   // Construct from milli seconds since the Unix epoch (1970-01-01 UTC),
+   // i.e. the same reference as QDateTime::toMSecsSinceEpoch.
+   //
+   static QCaTimeStamp fromMSecsSinceUnixEpoch (const qint64 mSecs);
+
+   // Construct from a year and the seconds and nano seconds into that year,
+   // all UTC, e.g. as used by the Archiver Appliance.
+   //
+   static QCaTimeStamp fromYearTime (const int year, const qint64 secondsIntoYear,
+                                     const qint64 nsec);
+
+   // Returns the number of seconds from the EPICS epoch to the start of the
+   // given year, i.e. 1st January 00:00:00 UTC. This is pure integer
+   // arithmetic (proleptic Gregorian calendar), no time zone look up involved.
+   //
+   static qint64 yearStartSeconds (const int year);
+
+   // Returns the current time.
+   //
+   static QCaTimeStamp currentTime ();
+
+   qint64 toNanoSecs () const { return this->nanoSecs; }
+
+   // Returns the (floor) number of seconds and the residual nano seconds
+   // relative to the EPICS epoch. The nano seconds are always in the
+   // range 0 .. 999,999,999, even for pre-epoch times.
+   //
+   qint64 getSeconds () const;
+   qint64 getNanoSeconds () const;
+
+   // Milli seconds since the Unix epoch, as per QDateTime::toMSecsSinceEpoch.
+   //
+   qint64 toMSecsSinceUnixEpoch () const;
+
+   // Equivilent to the QCaDateTime addSeconds and secondsTo functions,
+   // save that these retain full nano second precision.
+   //
+   QCaTimeStamp addSeconds (const double seconds) const;
+   QCaTimeStamp addNanoSecs (const qint64 nSecs) const { return fromNanoSecs (this->nanoSecs + nSecs); }
+   double secondsTo (const QCaTimeStamp& target) const { return double (target.nanoSecs - this->nanoSecs) / double (nanoSecsPerSec); }
+   qint64 nanoSecsTo (const QCaTimeStamp& target) const { return target.nanoSecs - this->nanoSecs; }
+
+   friend bool operator== (const QCaTimeStamp& a, const QCaTimeStamp& b) { return a.nanoSecs == b.nanoSecs; }
+   friend bool operator!= (const QCaTimeStamp& a, const QCaTimeStamp& b) { return a.nanoSecs != b.nanoSecs; }
+   friend bool operator<  (const QCaTimeStamp& a, const QCaTimeStamp& b) { return a.nanoSecs <  b.nanoSecs; }
+   friend bool operator<= (const QCaTimeStamp& a, const QCaTimeStamp& b) { return a.nanoSecs <= b.nanoSecs; }
+   friend bool operator>  (const QCaTimeStamp& a, const QCaTimeStamp& b) { return a.nanoSecs >  b.nanoSecs; }
+   friend bool operator>= (const QCaTimeStamp& a, const QCaTimeStamp& b) { return a.nanoSecs >= b.nanoSecs; }
+
+private:
+   qint64 nanoSecs;
+};
+
+Q_DECLARE_TYPEINFO (QCaTimeStamp, Q_PRIMITIVE_TYPE);
+Q_DECLARE_METATYPE (QCaTimeStamp)
+
+#endif  // QCA_TIME_STAMP_H
@@ -26,11 +26,19 @@
 
 #include "QEFloatingArray.h"
 #include <algorithm>
+#include <vector>
 #include <QDebug>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
 #include <QtAlgorithms>
 #include <QECommon.h>
+#include <QENumericKernels.h>
 #include <QEPlatform.h>
 
+#define MIN_DELTA_X  (1.0E-20)
+
 //=================================================================================
 // QEFloatingArray
 //=================================================================================
@@ -59,206 +67,535 @@ QEFloatingArray& QEFloatingArray::operator=( const  QVector<double>& other )
 //
 double QEFloatingArray::minimumValue (const double& defaultValue, const bool includeInf)
 {
-   const int n = this->count ();
+   double minimum = defaultValue;
+   double maximum = defaultValue;
+   QENumericKernels::minMax (this->constData (), this->count (), includeInf, minimum, maximum);
+   return minimum;
+}
 
-   double result = defaultValue;
-   bool isFirst = true;
-   for (int j = 0; j < n; j++) {
-      const double v = this->value (j);
+//---------------------------------------------------------------------------------
+//
+double QEFloatingArray::maximumValue (const double& defaultValue, const bool includeInf)
+{
+   double minimum = defaultValue;
+   double maximum = defaultValue;
+   QENumericKernels::minMax (this->constData (), this->count (), includeInf, minimum, maximum);
+   return maximum;
+}
 
-      // Ignore nan values, and only include inf if requested
-      //
-      if (QEPlatform::isNaN (v)) continue;
-      if (!includeInf && QEPlatform::isInf (v)) continue;
+//---------------------------------------------------------------------------------
+//
+QEFloatingArray QEFloatingArray::calcDyByDx (const QVector<double>& x)
+{
+   const int size = MIN (this->size(), x.size());
+   QEFloatingArray result (MAX (size, 0));
+
+   QENumericKernels::derivative (x.constData (), this->constData (), result.data (), size);
+   return result;
+}
+
+//=================================================================================
+// Filter infrastructure.
+//
+// Each filter is implemented as a kernel function that calculates the filtered
+// values for the output index range [begin, end). As each output element only
+// depends on the source data, large arrays may be split into chunks and each
+// chunk processed independently (in parallel) by the same kernel.
+//=================================================================================
+//
+namespace {
+
+struct FilterContext {
+   const double* source;
+   double* target;
+   int size;
+   int offset;                   // half window size
+   const double* coefficients;   // Savitzky-Golay only: (2*offset+1)^2 table
+};
+
+typedef void (*FilterKernel) (const FilterContext& context,
+                              const int begin, const int end);
+
+// Arrays smaller than this are always filtered in the calling thread.
+// Each parallel chunk is at least this size.
+//
+static const int parallelThreshold = 20000;
+static const int minimumChunkSize = 10000;
+
+//---------------------------------------------------------------------------------
+//
+class FilterRunnable : public QRunnable {
+public:
+   explicit FilterRunnable (FilterKernel kernelIn, const FilterContext& contextIn,
+                            const int beginIn, const int endIn,
+                            QSemaphore* doneIn) :
+      kernel (kernelIn), context (contextIn),
+      begin (beginIn), end (endIn), done (doneIn) {}
+
+   void run () {
+      this->kernel (this->context, this->begin, this->end);
+      this->done->release ();
+   }
 
-      if (isFirst) {
-         result = v;
-         isFirst = false;
+private:
+   FilterKernel kernel;
+   FilterContext context;
+   int begin;
+   int end;
+   QSemaphore* done;
+};
+
+//---------------------------------------------------------------------------------
+// Runs the kernel over the whole array, in chunks when worth while.
+//
+static void applyFilter (FilterKernel kernel, const FilterContext& context)
+{
+   const int size = context.size;
+
+   int chunks = 1;
+   if (size >= parallelThreshold) {
+      chunks = MIN (QThread::idealThreadCount (), size / minimumChunkSize);
+   }
+
+   if (chunks <= 1) {
+      kernel (context, 0, size);
+      return;
+   }
+
+   // The calling thread does the first chunk, the global thread pool
+   // does the others. The semaphore tells us when they are all done.
+   //
+   QSemaphore done (0);
+   const int chunkSize = (size + chunks - 1) / chunks;
+   int started = 0;
+   for (int begin = chunkSize; begin < size; begin += chunkSize) {
+      const int end = MIN (begin + chunkSize, size);
+      QThreadPool::globalInstance ()->start
+            (new FilterRunnable (kernel, context, begin, end, &done));
+      started++;
+   }
+
+   kernel (context, 0, MIN (chunkSize, size));
+   done.acquire (started);
+}
+
+//---------------------------------------------------------------------------------
+// Defines a strict total order with NaNs sorted to the high end. This keeps
+// the heaps consistent even when the data contains NaN values.
+//
+static inline bool lessThan (const double a, const double b)
+{
+   if (a != a) return false;   // a is NaN
+   if (b != b) return true;    // b is NaN, a is not
+   return a < b;
+}
+
+//---------------------------------------------------------------------------------
+// Running median using a max-heap (lower half) and a min-heap (upper half).
+// Each window element is held in a fixed slot, and each slot records which
+// heap it is in and where, so that the element leaving the window can be
+// removed in O(log window). No memory allocation after construction.
+//
+class RunningMedian {
+public:
+   explicit RunningMedian (const int capacity) :
+      value (capacity), heapOf (capacity), posn (capacity),
+      lower (capacity), upper (capacity),
+      lowerCount (0), upperCount (0) {}
+
+   void insert (const int slot, const double x)
+   {
+      this->value [slot] = x;
+      if ((this->lowerCount > 0) && lessThan (this->value [this->lower [0]], x)) {
+         this->push (Upper, slot);
       } else {
-         result = MIN (result, v);   // not first, so must merge
+         this->push (Lower, slot);
       }
+      this->rebalance ();
+   }
+
+   void remove (const int slot)
+   {
+      Heaps heap = Heaps (this->heapOf [slot]);
+      int* h = this->heapArray (heap);
+      int& count = this->heapCount (heap);
+      const int p = this->posn [slot];
+
+      count--;
+      if (p < count) {
+         // Move the last item into the vacated position and restore heap order.
+         //
+         const int moved = h [count];
+         this->place (heap, p, moved);
+         this->siftUp (heap, p);
+         this->siftDown (heap, this->posn [moved]);
+      }
+      this->rebalance ();
+   }
+
+   // The median is the ((count/2) + 1)th smallest element, i.e. the upper
+   // median for even counts - as per the original sort based implementation.
+   //
+   double median () const { return this->value [this->lower [0]]; }
+
+private:
+   enum Heaps { Lower = 0, Upper = 1 };
+
+   std::vector<double> value;
+   std::vector<char> heapOf;
+   std::vector<int> posn;
+   std::vector<int> lower;    // max heap of slots
+   std::vector<int> upper;    // min heap of slots
+   int lowerCount;
+   int upperCount;
+
+   int* heapArray (const Heaps heap) { return heap == Lower ? this->lower.data () : this->upper.data (); }
+   int& heapCount (const Heaps heap) { return heap == Lower ? this->lowerCount : this->upperCount; }
+
+   // Returns true if the item in slot a should be nearer the top of heap than slot b.
+   //
+   bool before (const Heaps heap, const int a, const int b) const
+   {
+      return heap == Lower ? lessThan (this->value [b], this->value [a])
+                           : lessThan (this->value [a], this->value [b]);
+   }
+
+   void place (const Heaps heap, const int p, const int slot)
+   {
+      this->heapArray (heap) [p] = slot;
+      this->heapOf [slot] = char (heap);
+      this->posn [slot] = p;
+   }
+
+   void siftUp (const Heaps heap, int p)
+   {
+      int* h = this->heapArray (heap);
+      const int slot = h [p];
+      while (p > 0) {
+         const int parent = (p - 1) / 2;
+         if (!this->before (heap, slot, h [parent])) break;
+         this->place (heap, p, h [parent]);
+         p = parent;
+      }
+      this->place (heap, p, slot);
+   }
+
+   void siftDown (const Heaps heap, int p)
+   {
+      int* h = this->heapArray (heap);
+      const int count = this->heapCount (heap);
+      const int slot = h [p];
+      while (true) {
+         int child = 2*p + 1;
+         if (child >= count) break;
+         if ((child + 1 < count) && this->before (heap, h [child + 1], h [child])) child++;
+         if (!this->before (heap, h [child], slot)) break;
+         this->place (heap, p, h [child]);
+         p = child;
+      }
+      this->place (heap, p, slot);
+   }
+
+   void push (const Heaps heap, const int slot)
+   {
+      int& count = this->heapCount (heap);
+      this->place (heap, count, slot);
+      count++;
+      this->siftUp (heap, count - 1);
+   }
+
+   int pop (const Heaps heap)
+   {
+      int* h = this->heapArray (heap);
+      int& count = this->heapCount (heap);
+      const int slot = h [0];
+      count--;
+      if (count > 0) {
+         this->place (heap, 0, h [count]);
+         this->siftDown (heap, 0);
+      }
+      return slot;
    }
-   return result;
-}
+
+   void rebalance ()
+   {
+      const int total = this->lowerCount + this->upperCount;
+      const int target = (total > 0) ? (total / 2) + 1 : 0;
+      while (this->lowerCount > target) this->push (Upper, this->pop (Lower));
+      while (this->lowerCount < target) this->push (Lower, this->pop (Upper));
+   }
+};
 
 //---------------------------------------------------------------------------------
 //
-double QEFloatingArray::maximumValue (const double& defaultValue, const bool includeInf)
+static void medianKernel (const FilterContext& context, const int begin, const int end)
 {
-   const int n = this->count ();
+   const double* source = context.source;
+   const int size = context.size;
+   const int offset = context.offset;
+   const int capacity = 2*offset + 1;
+
+   RunningMedian running (capacity);
+
+   // Prime the window for the first output element.
+   //
+   const int first = MAX (begin - offset, 0);
+   const int last = MIN (begin + offset, size - 1);
+   for (int k = first; k <= last; k++) {
+      running.insert (k % capacity, source [k]);
+   }
 
-   double result = defaultValue;
-   bool isFirst = true;
-   for (int j = 0; j < n; j++) {
-      const double v = this->value (j);
+   for (int j = begin; j < end; j++) {
+      context.target [j] = running.median ();
 
-      // Ignore nan values, and only include inf if requested
+      // Slide the window - the leaving and entering elements share a slot,
+      // so remove before insert.
       //
-      if (QEPlatform::isNaN (v)) continue;
-      if (!includeInf && QEPlatform::isInf (v)) continue;
+      const int leaving = j - offset;
+      const int entering = j + 1 + offset;
+      if (leaving >= 0) running.remove (leaving % capacity);
+      if (entering < size) running.insert (entering % capacity, source [entering]);
+   }
+}
 
-      if (isFirst) {
-         result = v;
-         isFirst = false;
+//---------------------------------------------------------------------------------
+// The running sum is re-synchronised periodically to bound rounding error.
+//
+static void meanKernel (const FilterContext& context, const int begin, const int end)
+{
+   const double* source = context.source;
+   const int size = context.size;
+   const int offset = context.offset;
+   static const int resyncPeriod = 1024;
+
+   double sum = 0.0;
+   int number = 0;
+   int sinceSync = 0;
+
+   for (int j = begin; j < end; j++) {
+      const int first = MAX (j - offset, 0);
+      const int last = MIN (j + offset, size - 1);
+
+      if ((j == begin) || (sinceSync >= resyncPeriod)) {
+         sum = 0.0;
+         number = 0;
+         for (int k = first; k <= last; k++) {
+            const double v = source [k];
+            if (QEPlatform::isNaN (v) || QEPlatform::isInf (v)) continue;
+            sum += v;
+            number++;
+         }
+         sinceSync = 0;
       } else {
-         result = MAX (result, v);   // not first, so must merge
+         // Window moved on by one: add new last element, remove old first element.
+         //
+         const int entering = j + offset;
+         const int leaving = j - offset - 1;
+         if (entering < size) {
+            const double v = source [entering];
+            if (!QEPlatform::isNaN (v) && !QEPlatform::isInf (v)) { sum += v; number++; }
+         }
+         if (leaving >= 0) {
+            const double v = source [leaving];
+            if (!QEPlatform::isNaN (v) && !QEPlatform::isInf (v)) { sum -= v; number--; }
+         }
+         sinceSync++;
       }
+
+      context.target [j] = (number > 0) ? sum / number : source [j];
    }
-   return result;
 }
 
 //---------------------------------------------------------------------------------
 //
-QEFloatingArray QEFloatingArray::calcDyByDx (const QVector<double>& x)
+static void savitzkyGolayKernel (const FilterContext& context, const int begin, const int end)
 {
-   const int size = MIN (this->size(), x.size());
-   QEFloatingArray result;
-   double s;
-   int j;
-
-   result.clear ();
+   const double* source = context.source;
+   const int size = context.size;
+   const int offset = context.offset;
+   const int width = 2*offset + 1;
+
+   for (int j = begin; j < end; j++) {
+      // Select the window start and the row of the coefficient table for the
+      // evaluation point within that window.
+      //
+      int start;
+      if (j < offset) {
+         start = 0;
+      } else if (j > size - 1 - offset) {
+         start = size - width;
+      } else {
+         start = j - offset;
+      }
+      const double* c = context.coefficients + (j - start) * width;
+      const double* x = source + start;
 
-   if (size == 1) {
-      result.append (0.0);
+      double sum = 0.0;
+      for (int i = 0; i < width; i++) {
+         sum += c [i] * x [i];
+      }
+      context.target [j] = sum;
+   }
+}
 
-   } else if (size == 2) {
+//---------------------------------------------------------------------------------
+// Calculates the Savitzky-Golay coefficient table for the given half width and
+// polynomial order. Row t (0 .. 2*offset) are the weights that evaluate the
+// least squares polynomial at position t within the window.
+//
+static std::vector<double> savitzkyGolayCoefficients (const int offset, const int order)
+{
+   const int width = 2*offset + 1;
+   const int terms = order + 1;
+   const double scale = MAX (offset, 1);
 
-      s = derivative (x.value (0), this->value (0),
-                      x.value (1), this->value (1));
+   // Design matrix A (width x terms), with scaled abscissa in [-1, +1].
+   //
+   std::vector<double> a (width * terms);
+   for (int i = 0; i < width; i++) {
+      const double x = (i - offset) / scale;
+      double p = 1.0;
+      for (int k = 0; k < terms; k++) {
+         a [i*terms + k] = p;
+         p *= x;
+      }
+   }
 
-      result.append (s);
-      result.append (s);
+   // Solve (A'A) H = A' for H (terms x width) by Gaussian elimination with
+   // partial pivoting on the augmented matrix [A'A | A'].
+   //
+   const int cols = terms + width;
+   std::vector<double> m (terms * cols, 0.0);
+   for (int r = 0; r < terms; r++) {
+      for (int c = 0; c < terms; c++) {
+         double sum = 0.0;
+         for (int i = 0; i < width; i++) sum += a [i*terms + r] * a [i*terms + c];
+         m [r*cols + c] = sum;
+      }
+      for (int i = 0; i < width; i++) {
+         m [r*cols + terms + i] = a [i*terms + r];
+      }
+   }
 
-   } else if (size >= 3) {
+   for (int col = 0; col < terms; col++) {
+      int pivot = col;
+      for (int r = col + 1; r < terms; r++) {
+         if (ABS (m [r*cols + col]) > ABS (m [pivot*cols + col])) pivot = r;
+      }
+      if (pivot != col) {
+         for (int c = 0; c < cols; c++) std::swap (m [col*cols + c], m [pivot*cols + c]);
+      }
 
-      // First point.
-      //
-      s = derivative (x.value (0), this->value (0),
-                      x.value (1), this->value (1));
-      result.append (s);
+      const double d = m [col*cols + col];
+      if (ABS (d) < MIN_DELTA_X) continue;    // singular - should not happen for order < width
+      for (int c = 0; c < cols; c++) m [col*cols + c] /= d;
 
-      // Middle points.
-      //
-      for (j = 1 ; j < size - 1; j++) {
-         s = derivative (x.value(j - 1), this->value(j - 1),
-                         x.value(j    ), this->value(j    ),
-                         x.value(j + 1), this->value(j + 1));
-         result.append (s);
+      for (int r = 0; r < terms; r++) {
+         if (r == col) continue;
+         const double f = m [r*cols + col];
+         if (f == 0.0) continue;
+         for (int c = 0; c < cols; c++) m [r*cols + c] -= f * m [col*cols + c];
       }
+   }
 
-      // Last point.
-      //
-      s = derivative (x.value (size - 2), this->value (size - 2),
-                      x.value (size - 1), this->value (size - 1));
-      result.append (s);
+   // Evaluate the fitted polynomial at each position in the window.
+   //
+   std::vector<double> result (width * width);
+   for (int t = 0; t < width; t++) {
+      const double x = (t - offset) / scale;
+      for (int i = 0; i < width; i++) {
+         double sum = 0.0;
+         double p = 1.0;
+         for (int k = 0; k < terms; k++) {
+            sum += p * m [k*cols + terms + i];
+            p *= x;
+         }
+         result [t*width + i] = sum;
+      }
    }
 
    return result;
 }
 
+}  // end anonymous namespace
+
 //---------------------------------------------------------------------------------
 //
 QEFloatingArray QEFloatingArray::medianFilter (const int window)
 {
    const int size = this->size ();
-   QEFloatingArray result;
-   result.reserve (size);
-
-   if (window > 1) {
-      const int offset = window / 2;
-      for (int j = 0; j < size; j++) {
-         // Must cater for edge effects
-         //
-         int pos = MAX (j - offset, 0);
-         int end = MIN (j + offset, size - 1);
-
-         // Extract vector slice, sort and extract middle, i.e. median, value.
-         //
-         QVector<double> qtemp = this->mid (pos, end - pos + 1);
-         std::vector <double> temp;
 
-         // Create a std vector form the QVector. Is there a better way?
-         //
-         for (int j = 0; j < qtemp.size(); j++) {
-            temp.push_back(qtemp[j]);
-         }
-
-         std::sort (temp.begin(), temp.end());
-         result.append (temp [qtemp.size ()/2]);
-      }
-   } else {
+   if ((window <= 1) || (size <= 1)) {
       // Window size is 1 (identity) or invalid - just return this vector.
       //
-      result = *this;
+      return *this;
    }
-   return result;
-}
 
+   QEFloatingArray result (size);
 
-#define MIN_DELTA_X  (1.0E-20)
+   FilterContext context;
+   context.source = this->constData ();
+   context.target = result.data ();
+   context.size = size;
+   context.offset = window / 2;
+   context.coefficients = NULL;
+
+   applyFilter (medianKernel, context);
+   return result;
+}
 
 //---------------------------------------------------------------------------------
-// static
-double QEFloatingArray::derivative (const double xp1, const double yp1,
-                                    const double xp2, const double yp2)
+//
+QEFloatingArray QEFloatingArray::meanFilter (const int window)
 {
-   double result;
-   double dx, dy;
+   const int size = this->size ();
 
-   dx = xp2 - xp1;
-   dy = yp2 - yp1;
+   if ((window <= 1) || (size <= 1)) {
+      return *this;
+   }
 
-   // Must avoid the divide by zero.
-   //
-   result = (ABS(dx) >= MIN_DELTA_X) ?  (dy / dx ) : 0.0;
+   QEFloatingArray result (size);
 
+   FilterContext context;
+   context.source = this->constData ();
+   context.target = result.data ();
+   context.size = size;
+   context.offset = window / 2;
+   context.coefficients = NULL;
+
+   applyFilter (meanKernel, context);
    return result;
 }
 
-
 //---------------------------------------------------------------------------------
-// static
-double QEFloatingArray::derivative (const double xp1, const double yp1,
-                                    const double xp2, const double yp2,
-                                    const double xp3, const double yp3)
+//
+QEFloatingArray QEFloatingArray::savitzkyGolayFilter (const int window, const int order)
 {
-   double result;
-   double x1, x3;
-   double y1, y3;
-   double divisor;
-
-   // Form quadratic:    y  = a.x^2 + b.x + c
-   // then:              y' = 2.a.x + b
-   // and specifically:  y'(X2) = 2.a.(X2) + b
-   //
-   // First perform linear co-ordinate mapping (xpi, ypi) to (xi, yi)
-   // such that:  xi = xpi - xp2,  and  yi = ypi - yp2.
-   //
-   x1 = xp1 - xp2;
-   y1 = yp1 - yp2;
-   x3 = xp3 - xp2;
-   y3 = yp3 - yp2;
+   const int size = this->size ();
 
-   // x2 = y2 = 0 by defn, which implies c = 0.
-   // Therefore need to solve for a, b using:
-   //
-   //   y1 = a.x1.x1 + b.x1
-   //   y3 = a.x3.x3 + b.x3
-   //
-   // Note y'(x2) = y'(0) = b,  which implies we only need to find b.
+   // The window cannot exceed the array size, and the order must be less than
+   // the window width (otherwise the polynomial just reproduces the data).
    //
-   // Avoid the divide by zero.
-   //
-   divisor = x1*x3*(x3 - x1);
-   if (ABS (divisor) >= MIN_DELTA_X) {
-      // Now calculate b
-      //
-      result = (y1*x3*x3 - y3*x1*x1) / divisor;
-   } else {
-      result = 0.0;
+   const int offset = MIN (window / 2, (size - 1) / 2);
+   const int width = 2*offset + 1;
+   if ((offset < 1) || (order < 0) || (order >= width - 1)) {
+      return *this;
    }
 
+   const std::vector<double> coefficients = savitzkyGolayCoefficients (offset, order);
+
+   QEFloatingArray result (size);
+
+   FilterContext context;
+   context.source = this->constData ();
+   context.target = result.data ();
+   context.size = size;
+   context.offset = offset;
+   context.coefficients = coefficients.data ();
+
+   applyFilter (savitzkyGolayKernel, context);
    return result;
 }
 
+
 // end
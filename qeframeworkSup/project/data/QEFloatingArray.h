@@ -49,6 +49,7 @@ public:
    // Find min/max values of the array. If array has zero usable elements then
    // the returned value is the defaultValue.
    // NaN values are always ignored. By default +/-inf values are also ignored.
+   // These, and calcDyByDx, use the vectorised QENumericKernels.
    //
    double minimumValue (const double& defaultValue = 0.0, const bool includeInf = false);
    double maximumValue (const double& defaultValue = 0.0, const bool includeInf = false);
@@ -60,20 +61,24 @@ public:
 
    // Calc median filter. window is median window size.
    // Should be > 0 and odd. 1 is essentuially no filter.
+   // Near the ends of the array, the window is truncated.
+   // Uses a running (two-heap) median, i.e. O(n.log(window)), and large arrays
+   // are split into chunks and filtered in parallel.
    //
    QEFloatingArray medianFilter (const int window);
 
-private:
-   static double derivative (const double xp1, const double yp1,
-                             const double xp2, const double yp2);
-
-   // This function calculates the derirative of the quadratic line through
-   // the points (xp1, yp1), (xp2,yYp2) and (xp3, yp3) at the point xp2.
+   // Calc moving average (mean) filter. As per medianFilter, the window should be
+   // > 0 and odd, and the window is truncated at the ends of the array.
+   // NaN/Inf values within the window are ignored.
    //
-   static double derivative (const double xp1, const double yp1,
-                             const double xp2, const double yp2,
-                             const double xp3, const double yp3);
+   QEFloatingArray meanFilter (const int window);
 
+   // Calc Savitzky-Golay smoothing filter, i.e. a moving polynomial least squares
+   // fit of the given order. Assumes equally spaced data. The window should be
+   // > 0 and odd and greater than order. Near the ends of the array, the
+   // polynomial fitted to the first/last full window is used.
+   //
+   QEFloatingArray savitzkyGolayFilter (const int window, const int order);
 };
 
 #endif   // QEFLOATING_ARRAY_H
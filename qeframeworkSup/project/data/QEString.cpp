@@ -58,11 +58,30 @@ QEString::QEString (QString pvName, QObject* eventObject,
 void QEString::initialise (QEStringFormatting* newStringFormat)
 {
    this->stringFormat = newStringFormat;
+   this->suppressUnchanged = false;
+   this->lastIsValid = false;
+   this->lastConfigurationVersion = 0;
+   this->lastArrayIndex = 0;
 
    QObject::connect (this, SIGNAL  (dataChanged (const QVariant&, QCaAlarmInfo&, QCaDateTime&, const unsigned int&)),
                      this, SLOT (convertVariant (const QVariant&, QCaAlarmInfo&, QCaDateTime&, const unsigned int&)));
 }
 
+//------------------------------------------------------------------------------
+//
+void QEString::setSuppressUnchanged (const bool suppressUnchangedIn)
+{
+   this->suppressUnchanged = suppressUnchangedIn;
+   this->lastIsValid = false;
+}
+
+//------------------------------------------------------------------------------
+//
+bool QEString::getSuppressUnchanged () const
+{
+   return this->suppressUnchanged;
+}
+
 //------------------------------------------------------------------------------
 // Take a new text value and write it to the database.
 // The type of data formatted (text, floating, integer, etc) will be determined by the record data type,
@@ -78,6 +97,7 @@ bool QEString::writeString (const QString &data, QString& message)
    QVariant formattedData = stringFormat->formatValue (data, ok);
    if (ok) {
       this->writeData (formattedData);
+      this->lastIsValid = false;     // ensure the update is presented
    } else {
       message = QString ("Write failed, unabled to format: '").append (data).append ("'.");
    }
@@ -106,6 +126,7 @@ bool QEString::writeStringElement (const QString &data, QString& message)
    QVariant elementValue = this->stringFormat->formatValue (data, ok);
    if (ok) {
       this->writeDataElement (elementValue);
+      this->lastIsValid = false;
    } else {
       message = QString ("Write element failed, unabled to format:'").append (data).append ("'.");
    }
@@ -133,6 +154,7 @@ bool QEString::writeString (const QVector<QString> &data, QString& message)
    QVariant arrayValue = this->stringFormat->formatValue (data, ok);
    if (ok) {
       writeData (arrayValue);
+      this->lastIsValid = false;
    } else {
       message = QString ("Write element failed, unabled to format string array.");
    }
@@ -163,9 +185,40 @@ void QEString::convertVariant (const QVariant& value, QCaAlarmInfo& alarmInfo,
    this->stringFormat->setDbEnumerations (getEnumerations());
    this->stringFormat->setDbPrecision (getPrecision());
 
+   // Skip the formatting, and the consequential widget updates, if the
+   // presented text and alarm state would not change.
+   //
+   if (this->suppressUnchanged) {
+      if (this->isUnchanged (value, alarmInfo)) {
+         this->stringFormat->noteUnchangedUpdate ();
+         return;
+      }
+
+      this->lastIsValid = true;
+      this->lastValue = value;
+      this->lastAlarmInfo = alarmInfo;
+      this->lastConfigurationVersion = this->stringFormat->getConfigurationVersion ();
+      this->lastArrayIndex = this->getArrayIndex ();
+   }
+
    // Format the data and send it
    const QString formatted = this->stringFormat->formatString (value, getArrayIndex ());
    emit stringChanged (formatted, alarmInfo, timeStamp, variableIndex);
 }
 
+//------------------------------------------------------------------------------
+// Note: the format configuration version covers egu, enumerations and
+// precision, as well as any widget formatting property changes.
+//
+bool QEString::isUnchanged (const QVariant& value, const QCaAlarmInfo& alarmInfo) const
+{
+   if (!this->lastIsValid) return false;
+   if (this->getIsMataDataUpdate () || this->getIsResendUpdate ()) return false;
+   if (alarmInfo != this->lastAlarmInfo) return false;
+   if (this->getArrayIndex () != this->lastArrayIndex) return false;
+   if (this->stringFormat->getConfigurationVersion () != this->lastConfigurationVersion) return false;
+
+   return this->stringFormat->isSameDisplayValue (value, this->lastValue);
+}
+
 // end
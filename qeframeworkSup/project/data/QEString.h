@@ -53,6 +53,14 @@ public:
    bool writeStringElement (const QString &data, QString& message);
    bool writeString (const QVector<QString> &data, QString& message);
 
+   // When set, data updates that would change neither the formatted text nor
+   // the alarm state are not formatted and do not emit stringChanged.
+   // Meta data updates and resends (see resendLastData) are always emitted.
+   // The default is false.
+   //
+   void setSuppressUnchanged (const bool suppressUnchanged);
+   bool getSuppressUnchanged () const;
+
 signals:
    void stringChanged (const QString& value, QCaAlarmInfo& alarmInfo,
                        QCaDateTime& timeStamp, const unsigned int& variableIndex);
@@ -68,6 +76,17 @@ private:
    void initialise (QEStringFormatting* newStringFormat);
    QEStringFormatting* stringFormat;
 
+   // Change detection - refers to the last emitted update.
+   //
+   bool isUnchanged (const QVariant& value, const QCaAlarmInfo& alarmInfo) const;
+
+   bool suppressUnchanged;
+   bool lastIsValid;
+   QVariant lastValue;
+   QCaAlarmInfo lastAlarmInfo;
+   quint64 lastConfigurationVersion;
+   int lastArrayIndex;
+
 private slots:
    void convertVariant (const QVariant& value, QCaAlarmInfo& alarmInfo,
                         QCaDateTime& timeStamp, const unsigned int& variableIndex);
@@ -77,6 +77,11 @@ QEStringFormatting::QEStringFormatting ()
    this->dbPrecision = 0;
    this->dbEnumerations.clear();
    this->dbFormatArray = false;
+
+   // The format plan is compiled on first use.
+   this->plan.isValid = false;
+   this->configurationVersion = 0;
+   this->unchangedUpdateCount = 0;
 }
 
 //------------------------------------------------------------------------------
@@ -90,7 +95,12 @@ QEStringFormatting::~QEStringFormatting () {}    // place holder
 //
 void QEStringFormatting::setDbPrecision (const unsigned int dbPrecisionIn)
 {
-   this->dbPrecision = dbPrecisionIn;
+   // This is called on every QEString update, so only invalidate on change.
+   //
+   if (this->dbPrecision != dbPrecisionIn) {
+      this->dbPrecision = dbPrecisionIn;
+      this->invalidatePlan ();
+   }
 }
 
 //------------------------------------------------------------------------------
@@ -99,7 +109,10 @@ void QEStringFormatting::setDbPrecision (const unsigned int dbPrecisionIn)
 //
 void QEStringFormatting::setDbEgu (const QString eguIn)
 {
-   this->dbEgu = eguIn;
+   if (this->dbEgu != eguIn) {
+      this->dbEgu = eguIn;
+      this->invalidatePlan ();
+   }
 }
 
 //----------------------------------------------------------------------------
@@ -108,7 +121,10 @@ void QEStringFormatting::setDbEgu (const QString eguIn)
 //
 void QEStringFormatting::setDbEnumerations (const QStringList enumerationsIn)
 {
-   this->dbEnumerations = enumerationsIn;
+   if (this->dbEnumerations != enumerationsIn) {
+      this->dbEnumerations = enumerationsIn;
+      this->invalidatePlan ();
+   }
 }
 
 //------------------------------------------------------------------------------
@@ -745,6 +761,99 @@ QString QEStringFormatting::formatFailure (const QString message) const
    return "---";
 }
 
+//==============================================================================
+// Change detection support
+//==============================================================================
+//
+quint64 QEStringFormatting::getConfigurationVersion () const
+{
+   return this->configurationVersion;
+}
+
+//------------------------------------------------------------------------------
+//
+bool QEStringFormatting::isSameDisplayValue (const QVariant& a, const QVariant& b) const
+{
+   const QMetaType::Type aType = QEPlatform::metaType (a);
+   if (aType != QEPlatform::metaType (b)) return false;
+
+   switch (aType) {
+      case QMetaType::Bool:
+      case QMetaType::Int:
+      case QMetaType::UInt:
+      case QMetaType::LongLong:
+      case QMetaType::ULongLong:
+      case QMetaType::QString:
+         return a == b;
+
+      case QMetaType::Double:
+      case QMetaType::Float:
+         break;    // see below
+
+      default:
+         // Arrays, vector variants, PVA specific types etc. are not
+         // examined here - we just assume these have changed.
+         //
+         return false;
+   }
+
+   const double da = a.toDouble ();
+   const double db = b.toDouble ();
+   if (da == db) return true;
+
+   // Only fixed point floating formatting is examined at the display precision.
+   // Enumerated, integer, time and other formats require an exact match.
+   //
+   const bool isFloating = (this->format == QE::Floating) ||
+                           ((this->format == QE::Default) && this->dbEnumerations.isEmpty ());
+   if (!isFloating) return false;
+
+   if (QEPlatform::isNaN (da) || QEPlatform::isInf (da) ||
+       QEPlatform::isNaN (db) || QEPlatform::isInf (db)) return false;
+
+   if ((da < 0.0) != (db < 0.0)) return false;
+
+   if (this->useScientificNotation (da) || this->useScientificNotation (db)) return false;
+
+   // Scale such that the least significant displayed digit is the units digit,
+   // including the same round up as used by toString.
+   //
+   const FormatPlan& fp = this->getPlan ();
+   const double scale = QEStringFormatting::radixPower (fp, fp.precision);
+   const double qa = (ABS (da) + fp.roundUp) * scale;
+   const double qb = (ABS (db) + fp.roundUp) * scale;
+
+   // Beyond this the digit extraction arithmetic can differ by more than the margin.
+   //
+   const double maxScaled = 1.0E+09;
+   if ((qa >= maxScaled) || (qb >= maxScaled)) return false;
+
+   const double fa = floor (qa);
+   const double fb = floor (qb);
+   if (fa != fb) return false;
+
+   // Stay clear of digit boundaries, where the digit extraction used by
+   // toString could round differently.
+   //
+   const double margin = 1.0E-4;
+   return ((qa - fa) > margin) && ((qa - fa) < (1.0 - margin)) &&
+          ((qb - fb) > margin) && ((qb - fb) < (1.0 - margin));
+}
+
+//------------------------------------------------------------------------------
+//
+void QEStringFormatting::noteUnchangedUpdate ()
+{
+   this->unchangedUpdateCount++;
+}
+
+//------------------------------------------------------------------------------
+//
+quint64 QEStringFormatting::getUnchangedUpdateCount () const
+{
+   return this->unchangedUpdateCount;
+}
+
 //==============================================================================
 // 'Set' formatting configuration methods
 //==============================================================================
@@ -759,6 +868,7 @@ void QEStringFormatting::setPrecision (const int precisionIn)
    // Ensure range is sensible.
    //
    this->precision = LIMIT (precisionIn, 0, 64);
+   this->invalidatePlan ();
 }
 
 //------------------------------------------------------------------------------
@@ -771,6 +881,7 @@ void QEStringFormatting::setPrecision (const int precisionIn)
 void QEStringFormatting::setUseDbPrecision (const bool useDbPrecisionIn)
 {
    this->useDbPrecision = useDbPrecisionIn;
+   this->invalidatePlan ();
 }
 
 //------------------------------------------------------------------------------
@@ -788,6 +899,7 @@ void QEStringFormatting::setLeadingZero (const bool leadingZeroIn)
 void QEStringFormatting::setLeadingZeros (const int leadingZerosIn)
 {
    this->leadingZeros = LIMIT (leadingZerosIn, 0, 64);
+   this->invalidatePlan ();
 }
 
 //------------------------------------------------------------------------------
@@ -806,6 +918,7 @@ void QEStringFormatting::setTrailingZeros (const bool trailingZerosIn)
 void QEStringFormatting::setForceSign (const bool forceSignIn)
 {
    this->forceSign = forceSignIn;
+   this->invalidatePlan ();
 }
 
 //------------------------------------------------------------------------------
@@ -815,6 +928,7 @@ void QEStringFormatting::setForceSign (const bool forceSignIn)
 void QEStringFormatting::setFormat (const QE::Formats formatIn)
 {
    this->format = formatIn;
+   this->invalidatePlan ();
 }
 
 //------------------------------------------------------------------------------
@@ -823,6 +937,7 @@ void QEStringFormatting::setFormat (const QE::Formats formatIn)
 void QEStringFormatting::setSeparator (const QE::Separators separatorIn)
 {
    this->separator = separatorIn;
+   this->invalidatePlan ();
 }
 
 //------------------------------------------------------------------------------
@@ -837,6 +952,7 @@ void QEStringFormatting::setSeparator (const QE::Separators separatorIn)
 void QEStringFormatting::setRadix (const int radix)
 {
    this->radixBase = LIMIT (radix, 2, 16);
+   this->invalidatePlan ();
 }
 
 //------------------------------------------------------------------------------
@@ -846,6 +962,7 @@ void QEStringFormatting::setRadix (const int radix)
 void QEStringFormatting::setUseRadixPrefix (const bool useRadixPrefixIn)
 {
    this->useRadixPrefix = useRadixPrefixIn;
+   this->invalidatePlan ();
 }
 
 //------------------------------------------------------------------------------
@@ -854,6 +971,7 @@ void QEStringFormatting::setUseRadixPrefix (const bool useRadixPrefixIn)
 void QEStringFormatting::setNotation (const QE::Notations notationIn)
 {
    this->notation = notationIn;
+   this->invalidatePlan ();
 }
 
 //------------------------------------------------------------------------------
@@ -863,6 +981,7 @@ void QEStringFormatting::setNotation (const QE::Notations notationIn)
 void QEStringFormatting::setArrayAction (const QE::ArrayActions arrayActionIn)
 {
    this->arrayAction = arrayActionIn;
+   this->invalidatePlan ();
 }
 
 //------------------------------------------------------------------------------
@@ -871,6 +990,7 @@ void QEStringFormatting::setArrayAction (const QE::ArrayActions arrayActionIn)
 void QEStringFormatting::setAddUnits (const bool AddUnitsIn)
 {
    this->addUnits = AddUnitsIn;
+   this->invalidatePlan ();
 }
 
 //------------------------------------------------------------------------------
@@ -882,6 +1002,7 @@ void QEStringFormatting::setAddUnits (const bool AddUnitsIn)
 void QEStringFormatting::setLocalEnumeration (const QString localEnumerationIn)
 {
    this->localEnumerations.setLocalEnumeration (localEnumerationIn);
+   this->invalidatePlan ();
 }
 
 //==============================================================================
@@ -1033,6 +1154,110 @@ static const int separatorGaps[17] = {
    /* 16 => */ 4
 };
 
+//------------------------------------------------------------------------------
+// Writes the decimal image of value (at least minDigits digits) into target
+// and returns the number of characters written - c.f. std::to_chars.
+//
+static int writeDecimal (char* target, unsigned int value, const int minDigits)
+{
+   char temp [16];
+   int n = 0;
+   do {
+      temp [n++] = radixChars [value % 10];
+      value /= 10;
+   } while ((value != 0) || (n < minDigits));
+
+   for (int j = 0; j < n; j++) {
+      target [j] = temp [n - 1 - j];
+   }
+   return n;
+}
+
+//------------------------------------------------------------------------------
+//
+void QEStringFormatting::invalidatePlan ()
+{
+   this->plan.isValid = false;
+   this->configurationVersion++;
+}
+
+//------------------------------------------------------------------------------
+//
+const QEStringFormatting::FormatPlan& QEStringFormatting::getPlan () const
+{
+   if (this->plan.isValid) return this->plan;
+
+   FormatPlan& fp = this->plan;
+
+   fp.precision = LIMIT (this->useDbPrecision ? this->dbPrecision : this->precision, 0, 64);
+   fp.zeros = LIMIT (this->leadingZeros, 0, 64);
+   fp.gap = (this->separator == QE::NoSeparator) ? -1 : separatorGaps[this->radixBase];
+   fp.sepChar = separatorChars[this->separator];
+   fp.positiveSign = this->forceSign ? '+' : '\0';
+
+   // Be consistant with toFloatingValue re selection of e vs. p
+   //
+   fp.expChar = (this->radixBase >= 11) ? 'p' : 'e';
+
+   // Radix prefix if required - numbers represented in decimal are never
+   // preceeded by "10#". Note the special for base 16.
+   //
+   fp.prefixLength = 0;
+   if (this->useRadixPrefix && (this->radixBase != 10)) {
+      if (this->radixBase == 16) {
+         fp.prefix [fp.prefixLength++] = '0';
+         fp.prefix [fp.prefixLength++] = 'x';
+      } else {
+         fp.prefixLength += writeDecimal (&fp.prefix [fp.prefixLength], this->radixBase, 1);
+         fp.prefix [fp.prefixLength++] = '#';
+      }
+   }
+   fp.prefix [fp.prefixLength] = '\0';
+
+   fp.dblRadix = this->radixBase;
+
+   // Round up by half the value of the least significant digit.
+   //
+   fp.roundUp = pow ((1.0 / fp.dblRadix), fp.precision) * 0.5;
+
+   // Automatic notation lower limit, e.g. if prec = 3, low limit is 0.01.
+   // Note: this is based on the user precision, not the effective precision.
+   //
+   const int prec = LIMIT (this->precision, 0, 15);
+   fp.lowFixedLimit = EXP10 (1 - prec);
+
+   // Powers used for digit extraction. These are calculated exactly as
+   // per the on-the-fly calculation, so the formatted output is unchanged.
+   //
+   for (int n = -planMaxPower; n <= planMaxPower; n++) {
+      fp.powers [n + planMaxPower] = pow (fp.dblRadix, n);
+   }
+
+   fp.isValid = true;
+   return fp;
+}
+
+//------------------------------------------------------------------------------
+// static
+double QEStringFormatting::radixPower (const FormatPlan& fp, const int n)
+{
+   if ((n >= -planMaxPower) && (n <= planMaxPower)) {
+      return fp.powers [n + planMaxPower];
+   }
+   return pow (fp.dblRadix, n);
+}
+
+//------------------------------------------------------------------------------
+// The buffer only ever grows, so after the first few updates this is a no-op.
+//
+char* QEStringFormatting::workBuffer (const int size) const
+{
+   if (this->buffer.size () < size) {
+      this->buffer.resize (size);
+   }
+   return this->buffer.data ();
+}
+
 //------------------------------------------------------------------------------
 //
 bool QEStringFormatting::useScientificNotation (const double value) const
@@ -1042,13 +1267,8 @@ bool QEStringFormatting::useScientificNotation (const double value) const
 
    // Pick best/most approptiate notation based on the value.
    // This is athe same logic as in formatFromFloating
-   // Extact precision being used.
-   //
-   const int prec = LIMIT (this->precision, 0, 15);
-
-   // Example, if prec = 3, when low limit is 0.01
    //
-   const double lowFixedLimit = EXP10 (1 - prec);
+   const double lowFixedLimit = this->getPlan ().lowFixedLimit;
    const double highFixedLimit = 1.0E+05;
 
    // Work with the absolute value
@@ -1062,17 +1282,19 @@ bool QEStringFormatting::useScientificNotation (const double value) const
 
 //------------------------------------------------------------------------------
 // We could template floating to/from string if ever needs be.
+// The image is generated directly into the reusable work buffer, and only
+// converted to a QString once complete.
 //
 QString QEStringFormatting::toString (const double value) const
 {
-   // Some of these could be pre-computed once.
-   //
-   const QString sign = (value < 0.0) ? "-" : (this->forceSign ? "+" : "");
-   const int zeros = LIMIT (this->leadingZeros, 0, 64);
-   const char sepChar = separatorChars[this->separator];
-   const int gap = (this->separator == QE::NoSeparator) ? -1 : separatorGaps[this->radixBase];
+   const FormatPlan& fp = this->getPlan ();
 
-   const int prec = LIMIT (this->useDbPrecision ? this->dbPrecision : this->precision, 0, 64);
+   const char sign = (value < 0.0) ? '-' : fp.positiveSign;
+   const int zeros = fp.zeros;
+   const char sepChar = fp.sepChar;
+   const int gap = fp.gap;
+   const int prec = fp.precision;
+   const double dblRadix = fp.dblRadix;
 
    // Sanity checks/specials.
    //
@@ -1081,35 +1303,16 @@ QString QEStringFormatting::toString (const double value) const
    }
 
    if (QEPlatform::isInf (value)) {
-      return sign + "inf";
-   }
-
-   QString result = "";
-
-   // Do leading sign if needed or requested.
-   //
-   result.append (sign);
-
-   // Is a radix prefix required?
-   //
-   if (this->useRadixPrefix && (this->radixBase != 10)) {
-      // Yes - do prefix.
-      //
-      if (this->radixBase == 16) {
-         result.append ("0x");
-      } else {
-         result.append (QString ("%1#").arg (this->radixBase));
-      }
+      return (sign == '-') ? "-inf" : ((sign == '+') ? "+inf" : "inf");
    }
 
    double work = ABS (value);   // working value
-   const double dblRadix = this->radixBase;
+   const bool useScientific = this->useScientificNotation (value);
 
-   if (this->useScientificNotation (value)) {
-      // Scientifc representation.
-      //
-      int exponent = 0;
+   int exponent = 0;
+   int mostSig = 0;
 
+   if (useScientific) {
       if (work != 0.0) {
          // Non-zero value - normalise the value.
          //
@@ -1126,10 +1329,7 @@ QString QEStringFormatting::toString (const double value) const
          }
          // now:  1.0 <= value < 10.0 in the nominated base (unless is zero).
 
-         // Round up by half the value of the least significant digit.
-         //
-         const double roundUp = pow ((1.0 / dblRadix), prec) * 0.5;
-         work = work + roundUp;
+         work = work + fp.roundUp;
 
          // Check if the round up pushed us into the next radix-decade?
          //
@@ -1138,74 +1338,79 @@ QString QEStringFormatting::toString (const double value) const
             exponent += 1;
          }
       }
+   } else {
+      work = work + fp.roundUp;
 
+      // Find most significant digit position.
+      // Units are 0, tens are 1, etc.
+      //
+      if (work >= dblRadix) {
+         double temp = work;
+         while (temp >= dblRadix) {
+            temp /= dblRadix;
+            mostSig += 1;
+         }
+      }
+      mostSig = MAX (mostSig, zeros - 1);
+   }
+
+   // Worst case size: sign, prefix, digits, point, separators and exponent.
+   //
+   char* const start = this->workBuffer (2 * (mostSig + zeros + prec) + 32);
+   char* p = start;
+
+   // Do leading sign if needed or requested.
+   //
+   if (sign) *p++ = sign;
+
+   // Is a radix prefix required?
+   //
+   for (int j = 0; j < fp.prefixLength; j++) {
+      *p++ = fp.prefix [j];
+   }
+
+   if (useScientific) {
+      // Scientifc representation.
       // Leading zeros
+      //
       for (int j = zeros; j >= 2; j--) {
          if ((gap > 0) && ((j % gap) == 0) && (j < zeros)) {
-            result.append (sepChar);
+            *p++ = sepChar;
          }
-         result.append ('0');
+         *p++ = '0';
       }
 
       int r = int (work);   // rounds down towards zero
-      result.append (radixChars[r]);
+      *p++ = radixChars[r];
 
       if (prec > 0) {
-         result.append ('.');
+         *p++ = '.';
          for (int j = 1; j <= prec; j++) {
             work = dblRadix * (work - r);
             r = int (work);
-            result.append (radixChars[r]);
+            *p++ = radixChars[r];
 
             if ((gap > 0) && ((j % gap) == 0) && (j < prec)) {
-               result.append (sepChar);
+               *p++ = sepChar;
             }
          }
       }
 
-      // Now do the exponent.
-      // Be consistant with toFloatingValue re selection of e vs. p
+      // Now do the exponent, at least two digits, always signed.
       //
-      char xp[20];
-      if (this->radixBase >= 11) {
-         snprintf (xp, sizeof (xp), "p%+03d", exponent);
-      } else {
-         snprintf (xp, sizeof (xp), "e%+03d", exponent);
-      }
-      result.append (xp);
+      *p++ = fp.expChar;
+      *p++ = (exponent < 0) ? '-' : '+';
+      p += writeDecimal (p, ABS (exponent), 2);
 
    } else {
       // Fixed point representation.
       //
-      // Round up by half the value of the least significant digit.
-      //
-      const double roundUp = pow ((1.0 / dblRadix), prec) * 0.5;
-      work = work + roundUp;
-
-      // Find most significant digit position.
-      // Units are 0, tens are 1, etc.
-      //
-      int mostSig = 0;
-      if (work >= dblRadix) {
-         double temp = work;
-         while (temp >= dblRadix) {
-            temp /= dblRadix;
-            mostSig += 1;
-         }
-      }
-
-      // Alternative - how expensive is pow?
-      // for (int t = dblRadix; t < work; t = t*dblRadix) {
-      //    mostSig++;
-      // }
-
-      mostSig = MAX (mostSig, zeros - 1);
       for (int n = mostSig; n >= -prec; n--) {
-         double prs = pow (dblRadix, n);
+         const double prs = QEStringFormatting::radixPower (fp, n);
          int r = int (floor (work / prs));
          work = work - r * prs;
 
-         result.append (radixChars[r]);
+         *p++ = radixChars[r];
 
          // All done?
          //
@@ -1213,14 +1418,14 @@ QString QEStringFormatting::toString (const double value) const
             break;
 
          if (n == 0) {
-            result.append ('.');
+            *p++ = '.';
          } else if ((gap > 0) && (ABS (n) % gap) == 0) {
-            result.append (sepChar);
+            *p++ = sepChar;
          }
       }
    }
 
-   return result;
+   return QString::fromLatin1 (start, int (p - start));
 }
 
 //------------------------------------------------------------------------------
@@ -1340,20 +1545,21 @@ double QEStringFormatting::toDouble (const QString& image, bool& okay) const
 template<typename Number>
 QString QEStringFormatting::toIntegerStringGeneric (const Number value) const
 {
-   // Some of these could be pre-computed once.
-   //
-   const QString sign = (value < 0) ? "-" : (this->forceSign ? "+" : "");
-   const int zeros = LIMIT (this->leadingZeros, 0, 64);
-   const char sepChar = separatorChars[this->separator];
-   const int gap = (this->separator == QE::NoSeparator) ? -1 : separatorGaps[this->radixBase];
+   const FormatPlan& fp = this->getPlan ();
+
+   const char sign = (value < 0) ? '-' : fp.positiveSign;
+   const int zeros = fp.zeros;
+   const char sepChar = fp.sepChar;
+   const int gap = fp.gap;
 
    // Big enough for a 64 bit integer on base 2 plus separators, sign and nn#
    // Given zeros are allowed upto 64, then 86 required for decimal.
    // Plus some for any extra I haven't thought about.
+   // The prefix and sign are filled in after the digits, hence the reserve.
    //
    char work[96];
+   const int reserve = sizeof (fp.prefix) + 1;
    int p = sizeof (work);
-   work[--p] = '\0';            // Fill work in backwards
 
    int n = 0;                   // Number of digits so far - excluding separators
    Number t = value;              // Working value
@@ -1373,7 +1579,7 @@ QString QEStringFormatting::toIntegerStringGeneric (const Number value) const
          work[--p] = sepChar;
 
       t = q;
-   } while ((t != 0 || n < zeros) && (p > 0));
+   } while ((t != 0 || n < zeros) && (p > reserve));
 
    if (work[p] == sepChar) {
       p++;                      // no leading separator wanted
@@ -1381,21 +1587,13 @@ QString QEStringFormatting::toIntegerStringGeneric (const Number value) const
 
    // Do we need to add the radix prefix?
    //
-   if (this->useRadixPrefix && (this->radixBase != 10)) {
-      // Do the prefix, note the special for base 16.
-      //
-      if (this->radixBase == 16) {
-         // We can't but the 0x directly in the string as %1 becomes %10
-         //
-         return QString ("%1%2%3").arg (sign).arg ("0x").arg (&work[p]);
-      } else {
-         return QString ("%1%2#%3").arg (sign).arg (this->radixBase).arg (&work[p]);
-      }
+   for (int j = fp.prefixLength - 1; j >= 0; j--) {
+      work[--p] = fp.prefix [j];
    }
 
-   // No radix prefix
-   //
-   return QString ("%1%2").arg (sign).arg (&work[p]);
+   if (sign) work[--p] = sign;
+
+   return QString::fromLatin1 (&work[p], int (sizeof (work)) - p);
 }
 
 //------------------------------------------------------------------------------
@@ -29,6 +29,7 @@
 #ifndef QE_STRING_FORMATTING_H
 #define QE_STRING_FORMATTING_H
 
+#include <QByteArray>
 #include <QVariant>
 #include <QString>
 #include <QStringList>
@@ -121,6 +122,26 @@ public:
    unsigned long toULong (const QString& image, bool& okay) const;
    double toDouble (const QString& image, bool& okay) const;
 
+   // Change detection support, used by QEString to avoid re-formatting and
+   // emitting text that would not change.
+   //
+   // The configuration version changes whenever any formatting configuration
+   // or database information that affects the formatted string changes.
+   //
+   quint64 getConfigurationVersion () const;
+
+   // Returns true if formatString would produce the same text for both values
+   // given the current configuration. This is conservative, i.e. it may return
+   // false for values that would format identically. Floating point values
+   // are compared at the display precision when using fixed notation.
+   //
+   bool isSameDisplayValue (const QVariant& a, const QVariant& b) const;
+
+   // Counts updates not re-formatted because the text would not have changed.
+   //
+   void noteUnchangedUpdate ();
+   quint64 getUnchangedUpdateCount () const;
+
 private:
    // isNumeric set true iff value is numeric data.
    //
@@ -153,6 +174,44 @@ private:
    // Error reporting
    QString formatFailure (const QString message) const;
 
+   // Compiled format plan.
+   // This holds all the configuration derived values used by the numeric
+   // toString functions. It is (re)built on demand after any change to the
+   // formatting configuration or to the database precision, so that the
+   // per-update cost is just the digit generation.
+   //
+   enum { planMaxPower = 64 };
+
+   struct FormatPlan {
+      bool isValid;
+      int precision;          // effective precision, i.e. database or user precision
+      int zeros;              // number of leading zeros
+      int gap;                // separator spacing, -1 when there is no separator
+      char sepChar;           // separator character
+      char positiveSign;      // '+' when forceSign set, otherwise '\0'
+      char expChar;           // 'e', or 'p' for radix 11 and above
+      char prefix [4];        // radix prefix, e.g. "0x", "8#", "12#" or "" for decimal
+      int prefixLength;
+      double dblRadix;
+      double roundUp;         // half the value of the least significant digit
+      double lowFixedLimit;   // automatic notation lower limit
+      double powers [2 * planMaxPower + 1];   // radix^n for n = -planMaxPower .. +planMaxPower
+   };
+
+   const FormatPlan& getPlan () const;
+   void invalidatePlan ();
+
+   // Returns radix^n, from the plan when within range.
+   static double radixPower (const FormatPlan& fp, const int n);
+
+   // Ensures the reusable work buffer has at least size bytes.
+   char* workBuffer (const int size) const;
+
+   mutable FormatPlan plan;
+   mutable QByteArray buffer;
+   quint64 configurationVersion;
+   quint64 unchangedUpdateCount;
+
    // Formatted output string
    mutable QE::Formats dbFormat; // Format determined from read value (Floating, integer, etc).
    mutable bool dbFormatArray;   // True if read value is an array
@@ -42,6 +42,9 @@ SOURCES += $$PWD/QCaDateTime.cpp
 HEADERS += $$PWD/QCaObject.h
 SOURCES += $$PWD/QCaObject.cpp
 
+HEADERS += $$PWD/QCaTimeStamp.h
+SOURCES += $$PWD/QCaTimeStamp.cpp
+
 HEADERS += $$PWD/QCaVariableNamePropertyManager.h
 SOURCES += $$PWD/QCaVariableNamePropertyManager.cpp
 
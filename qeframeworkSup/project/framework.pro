@@ -179,6 +179,7 @@ include (adaptation_parameters/adaptation_parameters.pri)
 include (common/common.pri)
 include (protocol/protocol.pri)
 include (data/data.pri)
+include (threads/threads.pri)
 include (archive/archive.pri)
 include (widgets/QEWidget/QEWidget.pri)
 include (widgets/QE2DDataVisualisation/QE2DDataVisualisation.pri)
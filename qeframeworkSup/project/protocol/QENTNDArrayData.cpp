@@ -506,6 +506,13 @@ int QENTNDArrayData::getBitDepth () const
    return this->bitDepth;
 }
 
+//------------------------------------------------------------------------------
+//
+int QENTNDArrayData::getUniqueId () const
+{
+   return this->uniqueId;
+}
+
 //------------------------------------------------------------------------------
 //
 QVariant QENTNDArrayData::getAttibute (const QString& name) const
@@ -538,6 +545,22 @@ bool QENTNDArrayData::assignFromVariant (const QVariant & item)
 //------------------------------------------------------------------------------
 //
 bool QENTNDArrayData::decompressData ()
+{
+   QByteArray buffer;
+   return this->decompressData (buffer, 1);
+}
+
+//------------------------------------------------------------------------------
+//
+bool QENTNDArrayData::isCompressed () const
+{
+   if (this->isDecompressed) return false;
+   return !(this->codecName == "" || this->codecName == "none");
+}
+
+//------------------------------------------------------------------------------
+//
+bool QENTNDArrayData::decompressData (QByteArray& buffer, const int codecThreads)
 {
    if (this->isDecompressed) {
       return true;   // Already decompressed - do nothing
@@ -556,17 +579,19 @@ bool QENTNDArrayData::decompressData ()
 
    bool result;
 
+   this->prepareBuffer (buffer);
+
    if (this->codecName == "jpeg") {
-      result = this->isDecompressed = this->decompressJpeg();
+      result = this->isDecompressed = this->decompressJpeg (buffer);
 
    } else if (this->codecName == "blosc") {
-      result = this->isDecompressed = this->decompressBlosc ();
+      result = this->isDecompressed = this->decompressBlosc (buffer, codecThreads);
 
    } else if (this->codecName == "lz4") {
-      result = this->isDecompressed = this->decompressLz4 ();
+      result = this->isDecompressed = this->decompressLz4 (buffer);
 
    } else if (this->codecName == "bslz4") {
-      result = this->isDecompressed = this->decompressBslz4 ();
+      result = this->isDecompressed = this->decompressBslz4 (buffer);
 
    } else {
       DEBUG << "Codec " + this->codecName + " not handled/unexpected";
@@ -576,15 +601,30 @@ bool QENTNDArrayData::decompressData ()
    return result;
 
 #else
+   Q_UNUSED (codecThreads);
    DEBUG << "NTNDArray decompression not supported";
    return false;
 #endif
 }
 
+//------------------------------------------------------------------------------
+// Allocating (and zeroing) a new buffer for each image is not free - the
+// images can be many MBytes - so re-use the buffer when we can. We can if we
+// are the only user, i.e. the buffer is not shared with a previous image.
+//
+void QENTNDArrayData::prepareBuffer (QByteArray& buffer) const
+{
+   const int size = int (this->uncompressedDataSize);
+
+   if (buffer.size () != size || !buffer.isDetached ()) {
+      buffer = QByteArray (size, 0);
+   }
+}
+
 //------------------------------------------------------------------------------
 // Cribbed from the various decompress functions out of NDPluginCodec.cpp (R3-8)
 //
-bool QENTNDArrayData::decompressJpeg ()
+bool QENTNDArrayData::decompressJpeg (QByteArray& output)
 {
 #ifdef QE_AD_SUPPORT
 
@@ -605,8 +645,6 @@ bool QENTNDArrayData::decompressJpeg ()
    QByteArray input = this->data;
    unsigned char* inbuffer = (unsigned char*) (input.data());
 
-   QByteArray output = QByteArray (int (this->uncompressedDataSize), 0);
-
    jpeg_mem_src (&jpegInfo, inbuffer, this->compressedDataSize);
 
    jpeg_read_header (&jpegInfo, TRUE);
@@ -635,6 +673,7 @@ bool QENTNDArrayData::decompressJpeg ()
    return result;
 
 #else
+   Q_UNUSED (output);
    DEBUG << "Jpeg decompression not supported";
    return false;
 #endif
@@ -642,7 +681,7 @@ bool QENTNDArrayData::decompressJpeg ()
 
 //------------------------------------------------------------------------------
 //
-bool QENTNDArrayData::decompressBlosc ()
+bool QENTNDArrayData::decompressBlosc (QByteArray& output, const int codecThreads)
 {
 #ifdef QE_AD_SUPPORT
 
@@ -657,11 +696,12 @@ bool QENTNDArrayData::decompressBlosc ()
    // Copy source (by referance).
    //
    QByteArray input = this->data;
-   QByteArray output = QByteArray (int (this->uncompressedDataSize), 0);
 
    const size_t destSize = this->uncompressedDataSize;
+   const int numinternalthreads = MAX (1, codecThreads);
 
-   status = blosc_decompress_ctx (input.data(), output.data(), destSize, 1);
+   status = blosc_decompress_ctx (input.data(), output.data(), destSize,
+                                  numinternalthreads);
    result = (status >= 0);
 
    // Copy output back to data (by ref with copy-on-write).
@@ -671,6 +711,8 @@ bool QENTNDArrayData::decompressBlosc ()
    return result;
 
 #else
+   Q_UNUSED (output);
+   Q_UNUSED (codecThreads);
    DEBUG << "Blosc decompression not supported";
    return false;
 #endif
@@ -678,7 +720,7 @@ bool QENTNDArrayData::decompressBlosc ()
 
 //------------------------------------------------------------------------------
 //
-bool QENTNDArrayData::decompressLz4 ()
+bool QENTNDArrayData::decompressLz4 (QByteArray& output)
 {
 #ifdef QE_AD_SUPPORT
 
@@ -693,7 +735,6 @@ bool QENTNDArrayData::decompressLz4 ()
    // Copy source (by referance).
    //
    QByteArray input = this->data;
-   QByteArray output = QByteArray (int (this->uncompressedDataSize), 0);
 
    int originalSize = this->uncompressedDataSize;
 
@@ -707,6 +748,7 @@ bool QENTNDArrayData::decompressLz4 ()
    return result;
 
 #else
+   Q_UNUSED (output);
    DEBUG << "Bsloc decompression not supported";
    return false;
 #endif
@@ -714,7 +756,7 @@ bool QENTNDArrayData::decompressLz4 ()
 
 //------------------------------------------------------------------------------
 //
-bool QENTNDArrayData::decompressBslz4 ()
+bool QENTNDArrayData::decompressBslz4 (QByteArray& output)
 {
 #ifdef QE_AD_SUPPORT
 
@@ -729,7 +771,6 @@ bool QENTNDArrayData::decompressBslz4 ()
    // Copy source (by referance).
    //
    QByteArray input = this->data;
-   QByteArray output = QByteArray (int (this->uncompressedDataSize), 0);
 
    const size_t numberOfElements = this->uncompressedDataSize;
    const size_t elementSize = 1;  /// ONLY works for mono 8 bit
@@ -747,6 +788,7 @@ bool QENTNDArrayData::decompressBslz4 ()
    return result;
 
 #else
+   Q_UNUSED (output);
    DEBUG << "Bslz4 decompression not supported";
    return false;
 #endif
@@ -84,6 +84,18 @@ public:
    //
    bool decompressData ();
 
+   // As above, but decompresses into the given buffer. The buffer is re-used,
+   // i.e. no new buffer is allocated, if it is the right size and is not shared.
+   // On success, the image data shares the buffer. Codecs that support it
+   // (currently blosc only) use up to codecThreads threads.
+   //
+   bool decompressData (QByteArray& buffer, const int codecThreads);
+
+   // Returns true if the image data is compressed, i.e. decompressData
+   // has something to do.
+   //
+   bool isCompressed () const;
+
    QByteArray getData () const;
 
    // Returns the name of the codec used to compress image.
@@ -99,6 +111,7 @@ public:
    int getWidth () const;
    int getHeight () const;
    int getBitDepth () const;
+   int getUniqueId () const;
 
    // Returns QVariant type Invalid is the attribute is not defined.
    //
@@ -149,10 +162,14 @@ private:
 
    void assignOther (const QENTNDArrayData& other);
 
-   bool decompressJpeg ();
-   bool decompressBlosc ();
-   bool decompressLz4 ();
-   bool decompressBslz4 ();
+   // Ensures the buffer is suitable for the uncompressed data.
+   //
+   void prepareBuffer (QByteArray& buffer) const;
+
+   bool decompressJpeg (QByteArray& output);
+   bool decompressBlosc (QByteArray& output, const int codecThreads);
+   bool decompressLz4 (QByteArray& output);
+   bool decompressBslz4 (QByteArray& output);
 
    int numberDimensions;
    int dimensionSizes [10];   // we expect only 2 or 3. area detector NDArray allows upto 10
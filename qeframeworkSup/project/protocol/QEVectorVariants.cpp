@@ -28,6 +28,7 @@
 #include <limits>
 #include <QDebug>
 #include <QMetaType>
+#include <QENumericKernels.h>
 #include <QEPlatform.h>
 
 #define DEBUG qDebug() << "QEArrayVariants" << __LINE__ << __FUNCTION__ << "  "
@@ -158,6 +159,16 @@ int QEVectorVariants::vectorCount (const QVariant& vector)
    okay = true;                                                                \
 }
 
+// As above, but uses the vectorised widening kernels.
+//
+#define VAR_TO_DOUBLE_VECTOR_KERNEL(kind) {                                    \
+   const kind temp = qvariant_cast<kind>(vector);                              \
+   const int n = temp.count();                                                 \
+   result.resize (n);                                                          \
+   QENumericKernels::toDouble (temp.constData(), result.data(), n);            \
+   okay = true;                                                                \
+}
+
 // static
 QVector<double> QEVectorVariants::convertToFloatingVector (const QVariant& vector, bool& okay)
 {
@@ -175,7 +186,7 @@ QVector<double> QEVectorVariants::convertToFloatingVector (const QVariant& vecto
          break;
 
       case FloatVector:
-         VAR_TO_DOUBLE_VECTOR (QEFloatVector);
+         VAR_TO_DOUBLE_VECTOR_KERNEL (QEFloatVector);
          break;
 
       case BoolVector:
@@ -183,15 +194,15 @@ QVector<double> QEVectorVariants::convertToFloatingVector (const QVariant& vecto
          break;
 
       case Int8Vector:
-         VAR_TO_DOUBLE_VECTOR (QEInt8Vector);
+         VAR_TO_DOUBLE_VECTOR_KERNEL (QEInt8Vector);
          break;
 
       case Int16Vector:
-         VAR_TO_DOUBLE_VECTOR (QEInt16Vector);
+         VAR_TO_DOUBLE_VECTOR_KERNEL (QEInt16Vector);
          break;
 
       case Int32Vector:
-         VAR_TO_DOUBLE_VECTOR (QEInt32Vector);
+         VAR_TO_DOUBLE_VECTOR_KERNEL (QEInt32Vector);
          break;
 
       case Int64Vector:
@@ -199,15 +210,15 @@ QVector<double> QEVectorVariants::convertToFloatingVector (const QVariant& vecto
          break;
 
       case Uint8Vector:
-         VAR_TO_DOUBLE_VECTOR (QEUint8Vector);
+         VAR_TO_DOUBLE_VECTOR_KERNEL (QEUint8Vector);
          break;
 
       case Uint16Vector:
-         VAR_TO_DOUBLE_VECTOR (QEUint16Vector);
+         VAR_TO_DOUBLE_VECTOR_KERNEL (QEUint16Vector);
          break;
 
       case Uint32Vector:
-         VAR_TO_DOUBLE_VECTOR (QEUint32Vector);
+         VAR_TO_DOUBLE_VECTOR_KERNEL (QEUint32Vector);
          break;
 
       case Uint64Vector:
@@ -223,6 +234,7 @@ QVector<double> QEVectorVariants::convertToFloatingVector (const QVariant& vecto
    return result;
 }
 
+#undef VAR_TO_DOUBLE_VECTOR_KERNEL
 #undef VAR_TO_DOUBLE_VECTOR
 
 
@@ -0,0 +1,433 @@
+/*  archapplValuesAtTimeTest.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron.
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Starritt
+ *  Contact details:
+ *    andrew.starritt@synchrotron.org.au
+ */
+
+// Standalone test of QEArchapplInterface::valuesAtTimeRequest. The test acts
+// as a minimal HTTP server standing in for the appliance. Which response is
+// made to each getDataAtTime request is determined by the PV names posted:
+//
+//   names starting "MISSING" - omitted from the response (no data),
+//   a name starting "MALFORMED" - the whole response is not valid JSON,
+//   a name starting "FAIL" - the whole response is HTTP 500,
+//   otherwise - val is the number after the last ':' in the name.
+//
+// The cases cover batching of more than 500 names per request, missing PVs,
+// malformed JSON and HTTP failure, for whole and partial requests.
+//
+
+#include <stdio.h>
+#include <algorithm>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include <QEArchapplInterface.h>
+
+static const qint64 testSeconds = 1760000000;   // Unix time of all samples
+static const qint64 testNanoSecs = 250000000;
+
+static int failures = 0;
+
+//------------------------------------------------------------------------------
+//
+static void check (const bool okay, const QString& what)
+{
+   if (okay) return;
+   failures++;
+   printf ("FAILED: %s\n", what.toLatin1 ().constData ());
+}
+
+//==============================================================================
+// The stand-in appliance.
+//==============================================================================
+//
+class StandIn {
+public:
+   explicit StandIn ();
+   ~StandIn ();
+
+   quint16 port () const { return this->server.serverPort (); }
+
+   int infoRequests;
+   QList<int> atTimeRequestSizes;   // number of names in each getDataAtTime request
+
+private:
+   void newConnection ();
+   void readyRead (QTcpSocket* socket);
+   void respond (QTcpSocket* socket, const QByteArray& requestLine, const QByteArray& body);
+   QByteArray dataAtTime (const QByteArray& body, int& httpStatus);
+
+   QTcpServer server;
+   QHash<QTcpSocket*, QByteArray> buffers;
+};
+
+//------------------------------------------------------------------------------
+//
+StandIn::StandIn ()
+{
+   this->infoRequests = 0;
+   QObject::connect (&this->server, &QTcpServer::newConnection,
+                     [this] () { this->newConnection (); });
+   this->server.listen (QHostAddress::LocalHost, 0);
+}
+
+//------------------------------------------------------------------------------
+//
+StandIn::~StandIn () { }
+
+//------------------------------------------------------------------------------
+//
+void StandIn::newConnection ()
+{
+   while (this->server.hasPendingConnections ()) {
+      QTcpSocket* socket = this->server.nextPendingConnection ();
+      this->buffers.insert (socket, QByteArray ());
+      QObject::connect (socket, &QTcpSocket::readyRead,
+                        [this, socket] () { this->readyRead (socket); });
+      QObject::connect (socket, &QTcpSocket::disconnected,
+                        [this, socket] () { this->buffers.remove (socket); socket->deleteLater (); });
+   }
+}
+
+//------------------------------------------------------------------------------
+// Handles any number of (keep alive) requests per connection.
+//
+void StandIn::readyRead (QTcpSocket* socket)
+{
+   QByteArray& buffer = this->buffers [socket];
+   buffer.append (socket->readAll ());
+
+   while (true) {
+      const int headerEnd = buffer.indexOf ("\r\n\r\n");
+      if (headerEnd < 0) return;
+
+      const QList<QByteArray> lines = buffer.left (headerEnd).split ('\n');
+      int contentLength = 0;
+      for (int j = 1; j < lines.count (); j++) {
+         const QByteArray line = lines.value (j).trimmed ();
+         if (line.toLower ().startsWith ("content-length:")) {
+            contentLength = line.mid (15).trimmed ().toInt ();
+         }
+      }
+
+      const int total = headerEnd + 4 + contentLength;
+      if (buffer.size () < total) return;    // wait for the rest of the body
+
+      const QByteArray requestLine = lines.value (0).trimmed ();
+      const QByteArray body = buffer.mid (headerEnd + 4, contentLength);
+      buffer.remove (0, total);
+
+      this->respond (socket, requestLine, body);
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+void StandIn::respond (QTcpSocket* socket, const QByteArray& requestLine,
+                       const QByteArray& body)
+{
+   int httpStatus = 200;
+   QByteArray content;
+
+   if (requestLine.contains ("/getApplianceInfo")) {
+      this->infoRequests++;
+      QJsonObject info;
+      info.insert ("dataRetrievalURL",
+                   QString ("http://127.0.0.1:%1/retrieval").arg (this->port ()));
+      info.insert ("version", QString ("stand-in"));
+      content = QJsonDocument (info).toJson (QJsonDocument::Compact);
+
+   } else if (requestLine.startsWith ("POST") &&
+              requestLine.contains ("/retrieval/data/getDataAtTime?")) {
+      content = this->dataAtTime (body, httpStatus);
+
+   } else {
+      httpStatus = 404;
+      content = "not found";
+   }
+
+   QByteArray response;
+   response.append (httpStatus == 200 ? "HTTP/1.1 200 OK\r\n" :
+                    httpStatus == 404 ? "HTTP/1.1 404 Not Found\r\n" :
+                                        "HTTP/1.1 500 Internal Server Error\r\n");
+   response.append ("Content-Type: application/json\r\n");
+   response.append ("Content-Length: " + QByteArray::number (content.size ()) + "\r\n");
+   response.append ("\r\n");
+   response.append (content);
+   socket->write (response);
+}
+
+//------------------------------------------------------------------------------
+//
+QByteArray StandIn::dataAtTime (const QByteArray& body, int& httpStatus)
+{
+   const QJsonArray names = QJsonDocument::fromJson (body).array ();
+   this->atTimeRequestSizes.append (names.count ());
+
+   QJsonObject result;
+   for (int j = 0; j < names.count (); j++) {
+      const QString name = names.at (j).toString ();
+
+      if (name.startsWith ("FAIL")) {
+         httpStatus = 500;
+         return "internal error";
+      }
+      if (name.startsWith ("MALFORMED")) {
+         return "{ \"truncated\": { \"secs\": 17600";
+      }
+      if (name.startsWith ("MISSING")) continue;
+
+      QJsonObject sample;
+      sample.insert ("secs", double (testSeconds));
+      sample.insert ("nanos", double (testNanoSecs));
+      sample.insert ("val", name.section (':', -1).toDouble ());
+      sample.insert ("severity", 1);
+      sample.insert ("status", 3);
+      result.insert (name, sample);
+   }
+   return QJsonDocument (result).toJson (QJsonDocument::Compact);
+}
+
+//==============================================================================
+// Test cases.
+//==============================================================================
+//
+struct Response {
+   bool received;
+   bool isOkay;
+   QEArchiveInterface::ResponseValueList values;
+};
+
+//------------------------------------------------------------------------------
+// Makes the request and waits (up to 10 seconds) for the response.
+//
+static Response request (QEArchapplInterface& archiver, const QStringList& names)
+{
+   Response response;
+   response.received = false;
+   response.isOkay = false;
+
+   QObject userData;
+   QEventLoop loop;
+   QTimer::singleShot (10000, &loop, SLOT (quit ()));
+
+   const QMetaObject::Connection connection =
+      QObject::connect (&archiver, &QEArchiveInterface::valuesAtTimeResponse,
+                        [&] (const QObject* context, const bool isOkay,
+                             const QEArchiveInterface::ResponseValueList& values) {
+         if (context != &userData) return;
+         response.received = true;
+         response.isOkay = isOkay;
+         response.values = values;
+         loop.quit ();
+      });
+
+   archiver.valuesAtTimeRequest (&userData, QCaDateTime (QDateTime::currentDateTime ()), names);
+   if (!response.received) loop.exec ();   // unless the response was immediate
+
+   QObject::disconnect (connection);
+   return response;
+}
+
+//------------------------------------------------------------------------------
+// Checks the response is in request order, and that each PV has a value
+// iff expected to.
+//
+static void checkValues (const char* name, const Response& response,
+                         const QStringList& names, const int firstFailed, const int lastFailed)
+{
+   check (response.values.count () == names.count (),
+          QString ("%1: %2 values for %3 names").arg (name)
+          .arg (response.values.count ()).arg (names.count ()));
+
+   const QCaTimeStamp expectedTime = QCaTimeStamp::fromUnixTime (testSeconds, testNanoSecs);
+   int errors = 0;
+   for (int j = 0; j < response.values.count () && j < names.count (); j++) {
+      const QEArchiveInterface::ResponseValues& rv = response.values.at (j);
+      const QString pvName = names.value (j);
+      const bool expectData = !pvName.startsWith ("MISSING") &&
+                              !(j >= firstFailed && j <= lastFailed);
+
+      bool okay = (rv.pvName == pvName);
+      if (expectData) {
+         okay = okay && (rv.dataPoints.count () == 1);
+         if (okay) {
+            const QCaDataPoint point = rv.dataPoints.value (0);
+            okay = (point.value == pvName.section (':', -1).toDouble ()) &&
+                   (point.datetime == expectedTime) &&
+                   (point.alarm.getSeverity () == 1) &&
+                   (point.alarm.getStatus () == 3);
+         }
+      } else {
+         okay = okay && (rv.dataPoints.count () == 0);
+      }
+
+      if (!okay && errors++ < 5) {
+         check (false, QString ("%1: unexpected value for %2 (index %3)")
+                .arg (name).arg (pvName).arg (j));
+      }
+   }
+   if (errors > 5) {
+      check (false, QString ("%1: %2 further value errors").arg (name).arg (errors - 5));
+   }
+}
+
+//------------------------------------------------------------------------------
+// Forms count names; every seventh is a missing PV. The name at special
+// index (if any) is replaced by the special name.
+//
+static QStringList makeNames (const int count, const int special = -1,
+                              const QString& specialName = "")
+{
+   QStringList names;
+   for (int j = 0; j < count; j++) {
+      if (j == special) {
+         names.append (specialName);
+      } else if (j % 7 == 3) {
+         names.append (QString ("MISSING:PV:%1").arg (j));
+      } else {
+         names.append (QString ("SR%1:PV:%2").arg (j % 13).arg (j));
+      }
+   }
+   return names;
+}
+
+//------------------------------------------------------------------------------
+//
+static void runCase (StandIn& standIn, QEArchapplInterface& archiver,
+                     const char* name, const QStringList& names,
+                     const bool expectedOkay, const QList<int>& expectedSizes,
+                     const int firstFailed = -1, const int lastFailed = -1)
+{
+   QElapsedTimer timer;
+   timer.start ();
+
+   standIn.atTimeRequestSizes.clear ();
+   const Response response = request (archiver, names);
+
+   check (response.received, QString ("%1: no response").arg (name));
+   if (!response.received) return;
+
+   check (response.isOkay == expectedOkay,
+          QString ("%1: isOkay %2, expected %3").arg (name)
+          .arg (response.isOkay).arg (expectedOkay));
+
+   QList<int> sizes = standIn.atTimeRequestSizes;
+   std::sort (sizes.begin (), sizes.end ());
+   QList<int> expected = expectedSizes;
+   std::sort (expected.begin (), expected.end ());
+   check (sizes == expected, QString ("%1: unexpected request batching").arg (name));
+
+   checkValues (name, response, names, firstFailed, lastFailed);
+
+   printf ("%-28s %6d names %3d requests %8.1f mS\n", name, int (names.count ()),
+           int (standIn.atTimeRequestSizes.count ()), double (timer.nsecsElapsed ()) / 1.0e6);
+}
+
+//------------------------------------------------------------------------------
+//
+int main (int argc, char* argv [])
+{
+   QCoreApplication app (argc, argv);
+
+   StandIn standIn;
+   if (standIn.port () == 0) {
+      printf ("unable to listen on a local port\n");
+      return 2;
+   }
+
+   // The interface requests the appliance info on construction, which gives
+   // the data retrieval URL. Wait for that before making any data requests.
+   //
+   QEArchapplInterface archiver (QUrl (QString ("http://127.0.0.1:%1/mgmt/bpl").arg (standIn.port ())));
+   {
+      QEventLoop loop;
+      QTimer::singleShot (10000, &loop, SLOT (quit ()));
+      QObject::connect (&archiver, &QEArchiveInterface::infoResponse,
+                        &loop, &QEventLoop::quit);
+      loop.exec ();
+   }
+   check (standIn.infoRequests == 1, "no getApplianceInfo request");
+
+   typedef QList<int> Sizes;
+
+   // Nothing requested - immediate success.
+   //
+   runCase (standIn, archiver, "no names", QStringList (), true, Sizes ());
+
+   // Single request, including missing PVs.
+   //
+   runCase (standIn, archiver, "single request", makeNames (120), true, Sizes () << 120);
+
+   // Exactly one full request, then one more name.
+   //
+   runCase (standIn, archiver, "500 names", makeNames (500), true, Sizes () << 500);
+   runCase (standIn, archiver, "501 names", makeNames (501), true, Sizes () << 500 << 1);
+
+   // Batching over 500 names.
+   //
+   runCase (standIn, archiver, "batched", makeNames (1234), true,
+            Sizes () << 500 << 500 << 234);
+
+   // All missing.
+   //
+   QStringList missing;
+   for (int j = 0; j < 50; j++) missing.append (QString ("MISSING:ALL:%1").arg (j));
+   runCase (standIn, archiver, "all missing", missing, true, Sizes () << 50);
+
+   // Malformed JSON: whole request, and one batch of several.
+   //
+   runCase (standIn, archiver, "malformed", makeNames (40, 10, "MALFORMED:X:1"),
+            false, Sizes () << 40, 0, 39);
+   runCase (standIn, archiver, "malformed batch", makeNames (1100, 700, "MALFORMED:X:2"),
+            true, Sizes () << 500 << 500 << 100, 500, 999);
+
+   // HTTP failure: whole request, and one batch of several.
+   //
+   runCase (standIn, archiver, "http failure", makeNames (40, 0, "FAIL:X:1"),
+            false, Sizes () << 40, 0, 39);
+   runCase (standIn, archiver, "http failure batch", makeNames (1100, 1050, "FAIL:X:2"),
+            true, Sizes () << 500 << 500 << 100, 1000, 1099);
+
+   // All batches fail.
+   //
+   QStringList allFail = makeNames (1000, 0, "FAIL:X:3");
+   allFail [600] = "MALFORMED:X:4";
+   runCase (standIn, archiver, "all batches fail", allFail,
+            false, Sizes () << 500 << 500, 0, 999);
+
+   printf ("\n%s\n", failures == 0 ? "all checks passed" : "CHECKS FAILED");
+   return failures == 0 ? 0 : 1;
+}
+
+// end
@@ -0,0 +1,375 @@
+/*  decodedImageCacheTest.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron.
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Rhyder
+ *  Contact details:
+ *    andrew.rhyder@synchrotron.org.au
+ */
+
+// Standalone test of decodedImageCache.
+//
+// Images are claimed, published and abandoned as the image processing threads of several
+// QEImage widgets displaying the same image source would. The cases cover which image
+// sources are cached, images identified by unique ID where the time stamp and size are the
+// same, waiting for another thread to publish or abandon an image, the claim timeout, and
+// the images kept per source and within the memory budget.
+
+#include <stdio.h>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QCaDateTime.h>
+#include <decodedImageCache.h>
+
+// Claim timeout used by the cache (mS)
+#define CLAIM_TIMEOUT 1000
+
+// Memory budget used for the test (MBytes)
+#define TEST_BUDGET 1
+
+//==============================================================================
+// Test images
+//==============================================================================
+
+// Identifies an image as per the cache
+struct imageKey
+{
+    imageKey( const QString& sourceIn, unsigned long secondsIn, int uniqueIdIn, int compressedSizeIn )
+    {
+        source = sourceIn;
+        time = QCaDateTime( secondsIn, 500000000 );
+        uniqueId = uniqueIdIn;
+        compressedSize = compressedSizeIn;
+    }
+
+    QString source;
+    QCaDateTime time;
+    int uniqueId;
+    int compressedSize;
+};
+
+static decodedImageCache::claimResults claim( const imageKey& key, QByteArray& imageData )
+{
+    return decodedImageCache::claim( key.source, key.time, key.uniqueId, key.compressedSize, imageData );
+}
+
+static void publish( const imageKey& key, const QByteArray& imageData )
+{
+    decodedImageCache::publish( key.source, key.time, key.uniqueId, key.compressedSize, imageData );
+}
+
+static void abandon( const imageKey& key )
+{
+    decodedImageCache::abandon( key.source, key.time, key.uniqueId, key.compressedSize );
+}
+
+// Generate distinct decompressed image data for an image
+static QByteArray makeImageData( int size, int fill )
+{
+    QByteArray data( size, 0 );
+    for( int i = 0; i < size; i++ )
+    {
+        data[i] = (char)( fill + i*7 );
+    }
+    return data;
+}
+
+// Thread that claims an image, as another widget's image processing thread would
+class claimThread : public QThread
+{
+public:
+    claimThread( const imageKey& keyIn ) : key( keyIn ){ result = decodedImageCache::CLAIM_NONE; waited = 0; }
+
+    void run()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        result = claim( key, imageData );
+        waited = timer.elapsed();
+    }
+
+    imageKey key;
+    decodedImageCache::claimResults result;
+    QByteArray imageData;
+    qint64 waited;              // mS
+};
+
+//==============================================================================
+// Checks
+//==============================================================================
+
+static int checks = 0;
+static int failures = 0;
+
+static const char* resultName( decodedImageCache::claimResults result )
+{
+    switch( result )
+    {
+        case decodedImageCache::CLAIM_FOUND:  return "found";
+        case decodedImageCache::CLAIM_DECODE: return "decode";
+        case decodedImageCache::CLAIM_NONE:   return "none";
+    }
+    return "?";
+}
+
+static void check( bool okay, const char* name, const char* what )
+{
+    checks++;
+    if( !okay )
+    {
+        failures++;
+        printf( "FAIL: %s: %s\n", name, what );
+    }
+}
+
+// Claim an image and check the result (and the image data if found)
+static void checkClaim( const char* name, const imageKey& key,
+                        decodedImageCache::claimResults expected, const QByteArray& expectedData = QByteArray() )
+{
+    QByteArray imageData;
+    decodedImageCache::claimResults result = claim( key, imageData );
+    checks++;
+    if( result != expected )
+    {
+        failures++;
+        printf( "FAIL: %s: claim %s id %d: %s expected %s\n", name, key.source.toLatin1().constData(),
+                key.uniqueId, resultName( result ), resultName( expected ) );
+        return;
+    }
+    if( expected == decodedImageCache::CLAIM_FOUND )
+    {
+        check( imageData == expectedData, name, "image data" );
+        check( imageData.constData() == expectedData.constData(), name, "image data shared" );
+    }
+}
+
+//==============================================================================
+// Cases
+//==============================================================================
+
+// Only image sources displayed by more than one image processor are cached
+static void testUsers()
+{
+    const imageKey key( "TEST:USERS", 1000, 1, 5000 );
+
+    checkClaim( "no users", key, decodedImageCache::CLAIM_NONE );
+
+    decodedImageCache::addUser( key.source );
+    checkClaim( "one user", key, decodedImageCache::CLAIM_NONE );
+
+    decodedImageCache::addUser( key.source );
+    checkClaim( "two users", key, decodedImageCache::CLAIM_DECODE );
+    const QByteArray data = makeImageData( 1000, 1 );
+    publish( key, data );
+    checkClaim( "two users", key, decodedImageCache::CLAIM_FOUND, data );
+
+    // Once back to one user the cached images are discarded
+    decodedImageCache::removeUser( key.source );
+    checkClaim( "user removed", key, decodedImageCache::CLAIM_NONE );
+    decodedImageCache::addUser( key.source );
+    checkClaim( "user added again", key, decodedImageCache::CLAIM_DECODE );
+    abandon( key );
+
+    decodedImageCache::removeUser( key.source );
+    decodedImageCache::removeUser( key.source );
+
+    checkClaim( "no source", imageKey( "", 1000, 1, 5000 ), decodedImageCache::CLAIM_NONE );
+}
+
+// Images with the same time stamp and compressed size are distinguished by unique ID, and
+// the most recent images from each source are kept
+static void testIdentity()
+{
+    const char* source = "TEST:IDENTITY";
+    decodedImageCache::addUser( source );
+    decodedImageCache::addUser( source );
+
+    const imageKey key1( source, 2000, 1, 7000 );
+    const imageKey key2( source, 2000, 2, 7000 );
+    const imageKey key3( source, 2000, 3, 7000 );
+    const QByteArray data1 = makeImageData( 2000, 1 );
+    const QByteArray data2 = makeImageData( 2000, 2 );
+    const QByteArray data3 = makeImageData( 2000, 3 );
+
+    checkClaim( "unique ID 1", key1, decodedImageCache::CLAIM_DECODE );
+    publish( key1, data1 );
+    checkClaim( "unique ID 2", key2, decodedImageCache::CLAIM_DECODE );
+    publish( key2, data2 );
+    checkClaim( "unique ID 1 cached", key1, decodedImageCache::CLAIM_FOUND, data1 );
+    checkClaim( "unique ID 2 cached", key2, decodedImageCache::CLAIM_FOUND, data2 );
+
+    // Any difference in time stamp or compressed size is a different image
+    const imageKey otherTime( source, 2001, 1, 7000 );
+    const imageKey otherSize( source, 2000, 1, 7001 );
+    checkClaim( "other time", otherTime, decodedImageCache::CLAIM_DECODE );
+    abandon( otherTime );
+    checkClaim( "other size", otherSize, decodedImageCache::CLAIM_DECODE );
+    abandon( otherSize );
+
+    // A third image from the source replaces the oldest
+    checkClaim( "unique ID 3", key3, decodedImageCache::CLAIM_DECODE );
+    publish( key3, data3 );
+    checkClaim( "unique ID 1 dropped", key1, decodedImageCache::CLAIM_DECODE );
+    abandon( key1 );
+    checkClaim( "unique ID 2 kept", key2, decodedImageCache::CLAIM_FOUND, data2 );
+    checkClaim( "unique ID 3 kept", key3, decodedImageCache::CLAIM_FOUND, data3 );
+
+    decodedImageCache::removeUser( source );
+    decodedImageCache::removeUser( source );
+}
+
+// A claim waits while another thread is decompressing the image
+static void testWaiting()
+{
+    const char* source = "TEST:WAITING";
+    decodedImageCache::addUser( source );
+    decodedImageCache::addUser( source );
+
+    // Published while waiting
+    {
+        const imageKey key( source, 3000, 1, 9000 );
+        const QByteArray data = makeImageData( 3000, 1 );
+        checkClaim( "publish", key, decodedImageCache::CLAIM_DECODE );
+
+        claimThread other( key );
+        other.start();
+        QThread::msleep( 200 );
+        publish( key, data );
+        other.wait();
+
+        check( other.result == decodedImageCache::CLAIM_FOUND, "publish", "other thread found image" );
+        check( other.imageData == data, "publish", "other thread image data" );
+        check( other.waited >= 150 && other.waited < CLAIM_TIMEOUT, "publish", "other thread waited for publish" );
+    }
+
+    // Abandoned while waiting. The waiting thread must decompress the image itself.
+    {
+        const imageKey key( source, 3001, 1, 9000 );
+        checkClaim( "abandon", key, decodedImageCache::CLAIM_DECODE );
+
+        claimThread other( key );
+        other.start();
+        QThread::msleep( 200 );
+        abandon( key );
+        other.wait();
+
+        check( other.result == decodedImageCache::CLAIM_DECODE, "abandon", "other thread to decode" );
+        check( other.waited >= 150 && other.waited < CLAIM_TIMEOUT, "abandon", "other thread waited for abandon" );
+
+        // The other thread's claim is outstanding
+        const QByteArray data = makeImageData( 3000, 2 );
+        publish( key, data );
+        checkClaim( "abandon", key, decodedImageCache::CLAIM_FOUND, data );
+    }
+
+    // Other images published while waiting
+    {
+        const imageKey key1( source, 3002, 1, 9000 );
+        const imageKey key2( source, 3002, 2, 9000 );
+        const QByteArray data1 = makeImageData( 3000, 3 );
+        const QByteArray data2 = makeImageData( 3000, 4 );
+        checkClaim( "publish other", key1, decodedImageCache::CLAIM_DECODE );
+        checkClaim( "publish other", key2, decodedImageCache::CLAIM_DECODE );
+
+        claimThread other( key1 );
+        other.start();
+        QThread::msleep( 100 );
+        publish( key2, data2 );
+        QThread::msleep( 200 );
+        publish( key1, data1 );
+        other.wait();
+
+        check( other.result == decodedImageCache::CLAIM_FOUND, "publish other", "other thread found image" );
+        check( other.imageData == data1, "publish other", "other thread image data" );
+        check( other.waited >= 250 && other.waited < CLAIM_TIMEOUT, "publish other", "other thread waited for its image" );
+    }
+
+    // Never published. The claim times out (over the total time waited) and the image is not cached.
+    {
+        const imageKey key( source, 3003, 1, 9000 );
+        checkClaim( "timeout", key, decodedImageCache::CLAIM_DECODE );
+
+        claimThread other( key );
+        other.start();
+
+        // Publishing other images wakes the waiting thread, but does not extend the timeout
+        const imageKey otherKey( source, 3003, 2, 9000 );
+        checkClaim( "timeout", otherKey, decodedImageCache::CLAIM_DECODE );
+        QThread::msleep( 500 );
+        publish( otherKey, makeImageData( 3000, 5 ) );
+        other.wait();
+
+        check( other.result == decodedImageCache::CLAIM_NONE, "timeout", "other thread timed out" );
+        check( other.waited >= CLAIM_TIMEOUT - 50 && other.waited < CLAIM_TIMEOUT + 300, "timeout", "other thread waited for the timeout" );
+        abandon( key );
+    }
+
+    decodedImageCache::removeUser( source );
+    decodedImageCache::removeUser( source );
+}
+
+// Images from any source are discarded, oldest first, while over the memory budget
+static void testBudget()
+{
+    const imageKey keyA( "TEST:BUDGET:A", 4000, 1, 100 );
+    const imageKey keyB( "TEST:BUDGET:B", 4000, 1, 100 );
+    const QByteArray dataA = makeImageData( 768*1024, 1 );
+    const QByteArray dataB = makeImageData( 512*1024, 2 );
+
+    decodedImageCache::addUser( keyA.source );
+    decodedImageCache::addUser( keyA.source );
+    decodedImageCache::addUser( keyB.source );
+    decodedImageCache::addUser( keyB.source );
+
+    checkClaim( "budget", keyA, decodedImageCache::CLAIM_DECODE );
+    publish( keyA, dataA );
+    checkClaim( "budget", keyA, decodedImageCache::CLAIM_FOUND, dataA );
+
+    checkClaim( "budget", keyB, decodedImageCache::CLAIM_DECODE );
+    publish( keyB, dataB );
+    checkClaim( "budget newest kept", keyB, decodedImageCache::CLAIM_FOUND, dataB );
+    checkClaim( "budget oldest dropped", keyA, decodedImageCache::CLAIM_DECODE );
+    abandon( keyA );
+
+    decodedImageCache::removeUser( keyA.source );
+    decodedImageCache::removeUser( keyA.source );
+    decodedImageCache::removeUser( keyB.source );
+    decodedImageCache::removeUser( keyB.source );
+}
+
+int main( int argc, char* argv[] )
+{
+    // The memory budget is read when the cache is first used
+    qputenv( "QE_IMAGE_DECODE_CACHE", QByteArray::number( TEST_BUDGET ) );
+    QCoreApplication app( argc, argv );
+
+    testUsers();
+    testIdentity();
+    testWaiting();
+    testBudget();
+
+    printf( "%d checks, %d failed\n", checks, failures );
+    printf( "\n%s\n", failures ? "CHECKS FAILED" : "all checks passed" );
+    return failures ? 1 : 0;
+}
+
+// end
@@ -0,0 +1,429 @@
+/*  imageAnalysisTest.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron.
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Rhyder
+ *  Contact details:
+ *    andrew.rhyder@synchrotron.org.au
+ */
+
+// Standalone correctness test for imageAnalysis beam statistics.
+//
+// Synthetic frames (Gaussian beams, with and without correlation, and uniform rectangles) are
+// analysed in each of the eight scan options. The centroid, RMS size, covariance, background,
+// peak and sum are compared against a straight forward two pass calculation over the frame,
+// mapped to displayed image coordinates. The FWHM is compared against the known width of each
+// beam. Degenerate frames (flat, or too little image data) are also checked.
+
+#include <stdio.h>
+#include <math.h>
+#include <QByteArray>
+#include <QPoint>
+#include <QPointF>
+#include <imageAnalysis.h>
+
+// FWHM of a Gaussian as a multiple of its standard deviation
+#define GAUSSIAN_FWHM 2.354820045
+
+//==============================================================================
+// Test frames
+//==============================================================================
+
+// A synthetic frame, as received (before any rotation or flipping)
+struct frame
+{
+    frame( int widthIn, int heightIn, unsigned long bytesPerPixelIn, unsigned int bitDepthIn )
+    {
+        width = widthIn;
+        height = heightIn;
+        bytesPerPixel = bytesPerPixelIn;
+        bitDepth = bitDepthIn;
+        data = QByteArray( width*height*(int)bytesPerPixel, 0 );
+    }
+
+    // Set a pixel. Any bits beyond the bit depth are also set (as they may be in image data
+    // from a PV) and should be ignored.
+    void setPixel( int x, int y, unsigned int value, unsigned int extraBits = 0 )
+    {
+        unsigned int raw = value | ( extraBits << bitDepth );
+        unsigned char* ptr = (unsigned char*)data.data() + ( y*width + x ) * bytesPerPixel;
+        if( bytesPerPixel == 1 )
+        {
+            *ptr = (unsigned char)raw;
+        }
+        else
+        {
+            *((quint16*)ptr) = (quint16)raw;
+        }
+    }
+
+    // Pixel value within the bit depth
+    unsigned int pixel( int x, int y ) const
+    {
+        const unsigned char* ptr = (const unsigned char*)data.constData() + ( y*width + x ) * bytesPerPixel;
+        unsigned int raw = ( bytesPerPixel == 1 ) ? *ptr : *((const quint16*)ptr);
+        return raw & ( ( 1u << bitDepth ) - 1 );
+    }
+
+    QByteArray data;
+    int width;
+    int height;
+    unsigned long bytesPerPixel;
+    unsigned int bitDepth;
+};
+
+// Simple, repeatable pseudo random number generator
+static unsigned int nextRandom( unsigned int& seed )
+{
+    seed = seed * 1103515245u + 12345u;
+    return ( seed >> 8 ) & 0xFFFFFF;
+}
+
+// Generate a (possibly correlated) Gaussian beam above a background.
+// The single brightest pixel is made one count brighter so the peak position is unambiguous.
+static frame makeGaussian( int width, int height, unsigned long bytesPerPixel, unsigned int bitDepth,
+                           double cx, double cy, double sx, double sy, double rho,
+                           unsigned int background, unsigned int amplitude, unsigned int& seed )
+{
+    frame f( width, height, bytesPerPixel, bitDepth );
+    const unsigned int extraMask = ( bytesPerPixel*8 > bitDepth ) ? ( 1u << ( bytesPerPixel*8 - bitDepth ) ) - 1 : 0;
+
+    int peakX = 0;
+    int peakY = 0;
+    double peakV = -1.0;
+    for( int y = 0; y < height; y++ )
+    {
+        for( int x = 0; x < width; x++ )
+        {
+            const double dx = ( x - cx ) / sx;
+            const double dy = ( y - cy ) / sy;
+            const double q = ( dx*dx - 2*rho*dx*dy + dy*dy ) / ( 2 * ( 1 - rho*rho ) );
+            const double v = amplitude * exp( -q );
+            if( v > peakV )
+            {
+                peakV = v;
+                peakX = x;
+                peakY = y;
+            }
+            f.setPixel( x, y, background + (unsigned int)( v + 0.5 ), nextRandom( seed ) & extraMask );
+        }
+    }
+    f.setPixel( peakX, peakY, f.pixel( peakX, peakY ) + 1 );
+    return f;
+}
+
+// Generate a uniform rectangle above a background
+static frame makeRectangle( int width, int height, unsigned long bytesPerPixel, unsigned int bitDepth,
+                            int left, int top, int rectWidth, int rectHeight,
+                            unsigned int background, unsigned int level )
+{
+    frame f( width, height, bytesPerPixel, bitDepth );
+    for( int y = 0; y < height; y++ )
+    {
+        for( int x = 0; x < width; x++ )
+        {
+            const bool inside = x >= left && x < left + rectWidth && y >= top && y < top + rectHeight;
+            f.setPixel( x, y, inside ? level : background );
+        }
+    }
+    return f;
+}
+
+//==============================================================================
+// Expected results
+//==============================================================================
+
+// Beam statistics in frame coordinates, calculated in two passes
+struct reference
+{
+    double sum;
+    unsigned int background;
+    unsigned int peak;
+    QPoint peakPos;
+    double cx;
+    double cy;
+    double varX;
+    double varY;
+    double covariance;
+};
+
+static reference calculateReference( const frame& f )
+{
+    reference r;
+    r.background = f.pixel( 0, 0 );
+    r.peak = f.pixel( 0, 0 );
+    for( int y = 0; y < f.height; y++ )
+    {
+        for( int x = 0; x < f.width; x++ )
+        {
+            const unsigned int p = f.pixel( x, y );
+            if( p < r.background ) r.background = p;
+            if( p > r.peak ) { r.peak = p; r.peakPos = QPoint( x, y ); }
+        }
+    }
+
+    r.sum = 0.0;
+    double sx = 0.0;
+    double sy = 0.0;
+    for( int y = 0; y < f.height; y++ )
+    {
+        for( int x = 0; x < f.width; x++ )
+        {
+            const double v = (double)f.pixel( x, y ) - r.background;
+            r.sum += v;
+            sx += v * x;
+            sy += v * y;
+        }
+    }
+    r.cx = r.sum > 0.0 ? sx / r.sum : ( f.width - 1 ) / 2.0;
+    r.cy = r.sum > 0.0 ? sy / r.sum : ( f.height - 1 ) / 2.0;
+
+    r.varX = 0.0;
+    r.varY = 0.0;
+    r.covariance = 0.0;
+    if( r.sum > 0.0 )
+    {
+        for( int y = 0; y < f.height; y++ )
+        {
+            for( int x = 0; x < f.width; x++ )
+            {
+                const double v = (double)f.pixel( x, y ) - r.background;
+                r.varX += v * ( x - r.cx ) * ( x - r.cx );
+                r.varY += v * ( y - r.cy ) * ( y - r.cy );
+                r.covariance += v * ( x - r.cx ) * ( y - r.cy );
+            }
+        }
+        r.varX /= r.sum;
+        r.varY /= r.sum;
+        r.covariance /= r.sum;
+    }
+    return r;
+}
+
+// Return true if the scan option transposes the image (the displayed X axis is the frame Y axis)
+static bool isTransposed( int scanOption )
+{
+    return scanOption >= 5;
+}
+
+// Map a position in the frame to the displayed image for a scan option.
+// (See the table of scan options in imageAnalysis.cpp)
+static QPointF toDisplayed( int scanOption, const frame& f, double x, double y )
+{
+    const double w1 = f.width - 1;
+    const double h1 = f.height - 1;
+    switch( scanOption )
+    {
+        default:
+        case 1: return QPointF( x, y );
+        case 2: return QPointF( w1 - x, y );
+        case 3: return QPointF( x, h1 - y );
+        case 4: return QPointF( w1 - x, h1 - y );
+        case 5: return QPointF( y, x );
+        case 6: return QPointF( y, w1 - x );
+        case 7: return QPointF( h1 - y, x );
+        case 8: return QPointF( h1 - y, w1 - x );
+    }
+}
+
+// Return the sign of the covariance in the displayed image relative to the frame.
+// (Reflecting one axis reverses the sign)
+static double covarianceSign( int scanOption )
+{
+    switch( scanOption )
+    {
+        case 2: case 3: case 6: case 7: return -1.0;
+        default:                        return  1.0;
+    }
+}
+
+//==============================================================================
+// Checks
+//==============================================================================
+
+static int checks = 0;
+static int failures = 0;
+
+static bool isClose( double value, double expected, double tolerance )
+{
+    return fabs( value - expected ) <= tolerance;
+}
+
+static void check( bool okay, const char* name, int scanOption, const char* what, double value, double expected )
+{
+    checks++;
+    if( !okay )
+    {
+        failures++;
+        printf( "FAIL: %s, scan %d, %s: %.6f expected %.6f\n", name, scanOption, what, value, expected );
+    }
+}
+
+static imageBeamStatistics analyse( const frame& f, int scanOption )
+{
+    imageAnalysis analysis( f.data, f.width, f.height, scanOption, f.bytesPerPixel, QE::Mono, f.bitDepth, f.bytesPerPixel );
+    imageBeamStatistics beam;
+    analysis.generateBeamStatistics( beam );
+    return beam;
+}
+
+// Check the beam statistics of a frame in every scan option against the two pass calculation.
+// The FWHM is checked against the expected width in frame coordinates, to within a tolerance.
+// The peak position is the first peak pixel in the displayed image, so is only checked if unique.
+static void checkFrame( const char* name, const frame& f, bool uniquePeak,
+                        double fwhmX, double fwhmY, double fwhmTolerance )
+{
+    const reference r = calculateReference( f );
+
+    for( int scanOption = 1; scanOption <= 8; scanOption++ )
+    {
+        const imageBeamStatistics beam = analyse( f, scanOption );
+        const bool t = isTransposed( scanOption );
+
+        check( beam.valid, name, scanOption, "valid", beam.valid, 1 );
+        if( !beam.valid )
+        {
+            continue;
+        }
+
+        // Exact results
+        check( beam.background == r.background, name, scanOption, "background", beam.background, r.background );
+        check( beam.peak == r.peak, name, scanOption, "peak", beam.peak, r.peak );
+        if( uniquePeak )
+        {
+            const QPointF peakPos = toDisplayed( scanOption, f, r.peakPos.x(), r.peakPos.y() );
+            check( beam.peakPos.x() == peakPos.x(), name, scanOption, "peak X", beam.peakPos.x(), peakPos.x() );
+            check( beam.peakPos.y() == peakPos.y(), name, scanOption, "peak Y", beam.peakPos.y(), peakPos.y() );
+        }
+        check( isClose( beam.sum, r.sum, 1e-9 * r.sum ), name, scanOption, "sum", beam.sum, r.sum );
+
+        // Moments. The single pass calculation removes the background from large sums, so allow for rounding.
+        const double positionTolerance = 1e-6 * ( f.width + f.height );
+        const QPointF centroid = toDisplayed( scanOption, f, r.cx, r.cy );
+        check( isClose( beam.centroid.x(), centroid.x(), positionTolerance ), name, scanOption, "centroid X", beam.centroid.x(), centroid.x() );
+        check( isClose( beam.centroid.y(), centroid.y(), positionTolerance ), name, scanOption, "centroid Y", beam.centroid.y(), centroid.y() );
+
+        const double rmsX = sqrt( t ? r.varY : r.varX );
+        const double rmsY = sqrt( t ? r.varX : r.varY );
+        check( isClose( beam.rmsSize.x(), rmsX, positionTolerance ), name, scanOption, "RMS X", beam.rmsSize.x(), rmsX );
+        check( isClose( beam.rmsSize.y(), rmsY, positionTolerance ), name, scanOption, "RMS Y", beam.rmsSize.y(), rmsY );
+
+        const double covariance = covarianceSign( scanOption ) * r.covariance;
+        check( isClose( beam.covariance, covariance, positionTolerance * ( f.width + f.height ) ), name, scanOption, "covariance", beam.covariance, covariance );
+
+        // FWHM of the projections
+        const double expectedX = t ? fwhmY : fwhmX;
+        const double expectedY = t ? fwhmX : fwhmY;
+        check( isClose( beam.fwhm.x(), expectedX, fwhmTolerance ), name, scanOption, "FWHM X", beam.fwhm.x(), expectedX );
+        check( isClose( beam.fwhm.y(), expectedY, fwhmTolerance ), name, scanOption, "FWHM Y", beam.fwhm.y(), expectedY );
+    }
+}
+
+// Check a Gaussian beam.
+// The projections of a Gaussian beam are Gaussian with the same standard deviation, so the FWHM of
+// each projection is known. Pixel rounding and the linear interpolation of the half maximum crossing
+// give an error of a small fraction of a pixel.
+static void checkGaussian( const char* name, int width, int height, unsigned long bytesPerPixel, unsigned int bitDepth,
+                           double cx, double cy, double sx, double sy, double rho,
+                           unsigned int background, unsigned int amplitude )
+{
+    unsigned int seed = 12345;
+    const frame f = makeGaussian( width, height, bytesPerPixel, bitDepth, cx, cy, sx, sy, rho, background, amplitude, seed );
+    checkFrame( name, f, true, GAUSSIAN_FWHM * sx, GAUSSIAN_FWHM * sy, 0.02 * GAUSSIAN_FWHM * ( sx > sy ? sx : sy ) );
+
+    // The beam is well within the frame, so the centroid and RMS size are also close to those of the Gaussian.
+    const imageBeamStatistics beam = analyse( f, 1 );
+    check( isClose( beam.centroid.x(), cx, 0.05 ), name, 1, "Gaussian centre X", beam.centroid.x(), cx );
+    check( isClose( beam.centroid.y(), cy, 0.05 ), name, 1, "Gaussian centre Y", beam.centroid.y(), cy );
+    check( isClose( beam.rmsSize.x(), sx, 0.02 * sx ), name, 1, "Gaussian sigma X", beam.rmsSize.x(), sx );
+    check( isClose( beam.rmsSize.y(), sy, 0.02 * sy ), name, 1, "Gaussian sigma Y", beam.rmsSize.y(), sy );
+    const double covariance = rho * sx * sy;
+    check( isClose( beam.covariance, covariance, 0.02 * sx * sy ), name, 1, "Gaussian covariance", beam.covariance, covariance );
+}
+
+// Check a uniform rectangle.
+// Each projection is a step either side of the rectangle, so the FWHM is exactly its size.
+// The variance of a uniform run of n pixels is (n*n-1)/12.
+static void checkRectangle( const char* name, int width, int height, unsigned long bytesPerPixel, unsigned int bitDepth,
+                            int left, int top, int rectWidth, int rectHeight,
+                            unsigned int background, unsigned int level )
+{
+    const frame f = makeRectangle( width, height, bytesPerPixel, bitDepth, left, top, rectWidth, rectHeight, background, level );
+    checkFrame( name, f, false, rectWidth, rectHeight, 1e-9 );
+
+    const imageBeamStatistics beam = analyse( f, 1 );
+    const double cx = left + ( rectWidth - 1 ) / 2.0;
+    const double cy = top + ( rectHeight - 1 ) / 2.0;
+    const double rmsX = sqrt( ( (double)rectWidth * rectWidth - 1 ) / 12 );
+    const double rmsY = sqrt( ( (double)rectHeight * rectHeight - 1 ) / 12 );
+    check( isClose( beam.centroid.x(), cx, 1e-6 ), name, 1, "rectangle centre X", beam.centroid.x(), cx );
+    check( isClose( beam.centroid.y(), cy, 1e-6 ), name, 1, "rectangle centre Y", beam.centroid.y(), cy );
+    check( isClose( beam.rmsSize.x(), rmsX, 1e-6 ), name, 1, "rectangle RMS X", beam.rmsSize.x(), rmsX );
+    check( isClose( beam.rmsSize.y(), rmsY, 1e-6 ), name, 1, "rectangle RMS Y", beam.rmsSize.y(), rmsY );
+    check( isClose( beam.covariance, 0.0, 1e-6 ), name, 1, "rectangle covariance", beam.covariance, 0.0 );
+}
+
+// Check frames with nothing above the background, and with too little image data
+static void checkDegenerate()
+{
+    const frame flat = makeRectangle( 31, 17, 1, 8, 0, 0, 0, 0, 40, 40 );
+    for( int scanOption = 1; scanOption <= 8; scanOption++ )
+    {
+        const imageBeamStatistics beam = analyse( flat, scanOption );
+        const double cx = ( ( isTransposed( scanOption ) ? flat.height : flat.width ) - 1 ) / 2.0;
+        const double cy = ( ( isTransposed( scanOption ) ? flat.width : flat.height ) - 1 ) / 2.0;
+        check( beam.valid, "flat", scanOption, "valid", beam.valid, 1 );
+        check( beam.sum == 0.0, "flat", scanOption, "sum", beam.sum, 0.0 );
+        check( beam.background == 40 && beam.peak == 40, "flat", scanOption, "background and peak", beam.peak, 40 );
+        check( beam.centroid.x() == cx, "flat", scanOption, "centroid X", beam.centroid.x(), cx );
+        check( beam.centroid.y() == cy, "flat", scanOption, "centroid Y", beam.centroid.y(), cy );
+        check( beam.rmsSize.x() == 0.0 && beam.rmsSize.y() == 0.0, "flat", scanOption, "RMS", beam.rmsSize.x(), 0.0 );
+        check( beam.fwhm.x() == 0.0 && beam.fwhm.y() == 0.0, "flat", scanOption, "FWHM", beam.fwhm.x(), 0.0 );
+    }
+
+    frame shortFrame = makeRectangle( 31, 17, 2, 12, 5, 5, 10, 5, 10, 1000 );
+    shortFrame.data.chop( 1 );
+    const imageBeamStatistics beam = analyse( shortFrame, 1 );
+    check( !beam.valid, "short data", 1, "valid", beam.valid, 0 );
+}
+
+int main()
+{
+    // Gaussian beams in 8 bit and 12 bit (in 16 bit) frames, including odd frame sizes,
+    // off centre and correlated (tilted) beams
+    checkGaussian( "gaussian 8 bit",          64,  48, 1,  8, 31.5, 23.5, 6.0, 4.0,  0.0,  10,  200 );
+    checkGaussian( "gaussian 8 bit odd",      77,  53, 1,  8, 20.3, 30.7, 5.0, 7.5,  0.0,   3,  240 );
+    checkGaussian( "gaussian 12 bit",        160, 120, 2, 12, 70.2, 55.9, 9.0, 6.5,  0.0, 100, 3900 );
+    checkGaussian( "gaussian 12 bit tilted", 161, 121, 2, 12, 80.0, 60.0, 10.0, 7.0, 0.6,  50, 4000 );
+    checkGaussian( "gaussian 16 bit tilted", 200,  90, 2, 16, 90.3, 44.1, 12.0, 8.0, -0.4, 500, 60000 );
+
+    // Uniform rectangles
+    checkRectangle( "rectangle 8 bit",   64,  48, 1,  8, 10, 20, 17,  9, 5,  250 );
+    checkRectangle( "rectangle 12 bit", 101,  33, 2, 12, 60,  1, 40, 30, 0, 4095 );
+
+    // Flat frames and insufficient image data
+    checkDegenerate();
+
+    printf( "%d checks, %d failed\n", checks, failures );
+    printf( "\n%s\n", failures ? "CHECKS FAILED" : "all checks passed" );
+    return failures ? 1 : 0;
+}
+
+// end
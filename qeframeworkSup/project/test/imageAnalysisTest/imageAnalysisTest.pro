@@ -0,0 +1,47 @@
+# File: qeframeworkSup/project/test/imageAnalysisTest/imageAnalysisTest.pro
+#
+# Copyright (c) 2026 Australian Synchrotron
+#
+# This file is part of the EPICS QT Framework, initially developed at the Australian Synchrotron.
+# The EPICS QT Framework is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+# The EPICS QT Framework is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+# You should have received a copy of the GNU Lesser General Public License
+# along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Author: Andrew Rhyder
+# Contact details: andrew.rhyder@synchrotron.org.au
+#
+
+# Standalone correctness test for the QEImage beam statistics. This is not part
+# of the regular build, and needs neither EPICS nor a display. To build and run:
+#
+#    qmake && make && ./imageAnalysisTest
+#
+# The centroid, RMS size, covariance, peak and FWHM are checked for synthetic
+# frames, in every scan option. The exit status is non zero if any check fails.
+#
+
+TEMPLATE = app
+TARGET = imageAnalysisTest
+CONFIG += console release
+CONFIG -= app_bundle
+QT = core
+
+# Build the framework source directly rather than link against the library.
+#
+DEFINES += QE_FRAMEWORK_LIBRARY
+
+INCLUDEPATH += ../../common
+INCLUDEPATH += ../../widgets/QEWidget
+INCLUDEPATH += ../../widgets/QEImage
+
+SOURCES += imageAnalysisTest.cpp
+SOURCES += ../../widgets/QEImage/imageAnalysis.cpp
+
+# end
@@ -0,0 +1,398 @@
+/*  imageConversionKernelsTest.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron.
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Rhyder
+ *  Contact details:
+ *    andrew.rhyder@synchrotron.org.au
+ */
+
+// Standalone correctness and throughput test for imageConversionKernels.
+//
+// Synthetic image data is converted for every format, depth, lookup mode, scan option, region
+// and band split using each available instruction set, and the output image and pixel statistics
+// compared against a single band converted by the portable kernels. The throughput of each
+// instruction set is then reported for a larger image.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QENumericKernels.h>
+#include <imageConversionKernels.h>
+
+typedef imageDisplayProperties::rgbPixel rgbPixel;
+
+// Bytes allocated beyond the end of the input data. The kernels may read (but not use) a
+// few bytes beyond the last pixel, as they may when converting image data from a PV.
+#define INPUT_PADDING 32
+
+// Image formats converted by the kernels
+static const struct
+{
+    QE::ImageFormatOptions format;
+    const char* name;
+} formats[] = { { QE::Mono,    "Mono"    },
+                { QE::BayerGB, "BayerGB" },
+                { QE::BayerBG, "BayerBG" },
+                { QE::BayerGR, "BayerGR" },
+                { QE::BayerRG, "BayerRG" } };
+
+// Input data pixel sizes and depths. Includes sizes and depths used by the SIMD kernels,
+// and those that always fall back to the portable kernels.
+static const struct
+{
+    unsigned long bytesPerPixel;
+    unsigned int bitDepth;
+} depths[] = { { 1, 8 }, { 1, 5 }, { 2, 8 }, { 2, 10 }, { 2, 12 }, { 2, 16 }, { 4, 18 }, { 4, 24 } };
+
+// How pixels are selected from the lookup table
+enum lookupModes { LOOKUP_FULL,         // Full depth lookup table (where the depth allows)
+                   LOOKUP_SCALED,       // Scaled for brightness and contrast over part of the pixel range
+                   LOOKUP_WIDE,         // Scaled for brightness and contrast over the whole pixel range (too wide for the SIMD kernels when deep)
+                   LOOKUP_COUNT };
+
+static const char* lookupNames[LOOKUP_COUNT] = { "full", "scaled", "wide" };
+
+// Number of bands each image is split into (as if built by that many band workers)
+static const int bandSplits[] = { 1, 2, 3, 7 };
+
+// Image sizes used for correctness testing. Odd sizes exercise the partial SIMD runs and the Bayer edges.
+static const struct
+{
+    unsigned long width;
+    unsigned long height;
+} sizes[] = { { 37, 23 }, { 130, 17 }, { 5, 4 }, { 1, 9 } };
+
+//==============================================================================
+// Test data
+//==============================================================================
+
+// Simple, repeatable pseudo random number generator
+static unsigned int nextRandom( unsigned int& seed )
+{
+    seed = seed * 1103515245u + 12345u;
+    return ( seed >> 8 ) & 0xFFFFFF;
+}
+
+// Generate image data. All bits of each pixel are set randomly, including those beyond
+// the bit depth, so the kernels must mask each pixel.
+static QVector<unsigned char> makeImageData( unsigned long width, unsigned long height, unsigned long bytesPerPixel )
+{
+    QVector<unsigned char> data( width*height*bytesPerPixel + INPUT_PADDING );
+    unsigned int seed = 12345;
+    for( int i = 0; i < data.count(); i++ )
+    {
+        data[i] = nextRandom( seed ) & 0xff;
+    }
+    return data;
+}
+
+// Generate a lookup table where every entry is distinct from its neighbours
+static QVector<rgbPixel> makeLookup( unsigned int size )
+{
+    QVector<rgbPixel> lookup( size );
+    for( unsigned int i = 0; i < size; i++ )
+    {
+        lookup[i].p[0] = i & 0xff;
+        lookup[i].p[1] = ( i >> 8 ) & 0xff;
+        lookup[i].p[2] = ( i*7 ) & 0xff;
+        lookup[i].p[3] = 0xff;
+    }
+    return lookup;
+}
+
+// Set the scan parameters for a scan option (as per imageScan in imageAnalysis.cpp), then
+// restrict the scan to part of the output image if required (as per imagePropertiesCore::buildImageCore()).
+static imageConversionKernels::scan makeScan( int scanOption, int w, int h, bool region )
+{
+    imageConversionKernels::scan s;
+    switch( scanOption )
+    {
+        default:
+        case 1: s.outCount = h; s.inCount = w; s.start = 0;       s.outInc =  0;     s.inInc =  1; break;
+        case 2: s.outCount = h; s.inCount = w; s.start = w-1;     s.outInc =  2*w;   s.inInc = -1; break;
+        case 3: s.outCount = h; s.inCount = w; s.start = w*(h-1); s.outInc = -2*w;   s.inInc =  1; break;
+        case 4: s.outCount = h; s.inCount = w; s.start = (w*h)-1; s.outInc =  0;     s.inInc = -1; break;
+        case 5: s.outCount = w; s.inCount = h; s.start = 0;       s.outInc = -w*h+1; s.inInc =  w; break;
+        case 6: s.outCount = w; s.inCount = h; s.start = w-1;     s.outInc = -w*h-1; s.inInc =  w; break;
+        case 7: s.outCount = w; s.inCount = h; s.start = w*(h-1); s.outInc =  w*h+1; s.inInc = -w; break;
+        case 8: s.outCount = w; s.inCount = h; s.start = (w*h)-1; s.outInc =  w*h-1; s.inInc = -w; break;
+    }
+
+    // Trim a few rows and columns from each edge of the output image, where there are enough
+    if( region && s.outCount > 4 && s.inCount > 5 )
+    {
+        const long rowStep = (long)s.inCount*s.inInc + s.outInc;
+        const int left = 3;
+        const int top = 2;
+        s.start += top*rowStep + left*s.inInc;
+        s.outCount -= 4;
+        s.inCount -= 5;
+        s.outInc = rowStep - (long)s.inCount*s.inInc;
+    }
+    return s;
+}
+
+//==============================================================================
+// Conversion
+//==============================================================================
+
+// Set the conversion parameters
+static imageConversionKernels::parameters makeParameters( QE::ImageFormatOptions format,
+                                                          unsigned long width, unsigned long height,
+                                                          unsigned long bytesPerPixel, unsigned int bitDepth,
+                                                          lookupModes mode,
+                                                          const QVector<rgbPixel>& lookup,
+                                                          const QVector<rgbPixel>& fullLookup )
+{
+    imageConversionKernels::parameters params;
+    params.format = format;
+    params.width = width;
+    params.height = height;
+    params.bytesPerPixel = bytesPerPixel;
+    params.bitDepth = bitDepth;
+    params.pixelLookup = lookup.constData();
+    params.fullPixelLookup = NULL;
+    params.fullPixelLookupSize = 0;
+
+    const long maxPixel = ( 1L << bitDepth ) - 1;
+    switch( mode )
+    {
+        case LOOKUP_FULL:
+            params.pixelLow = 0;
+            params.pixelHigh = maxPixel;
+            if( bitDepth <= 16 )
+            {
+                params.fullPixelLookup = fullLookup.constData();
+                params.fullPixelLookupSize = fullLookup.count();
+            }
+            break;
+
+        default:
+        case LOOKUP_SCALED:
+            params.pixelLow = maxPixel/5;
+            params.pixelHigh = maxPixel - maxPixel/3;
+            break;
+
+        case LOOKUP_WIDE:
+            params.pixelLow = 7;
+            params.pixelHigh = maxPixel;
+            break;
+    }
+    return params;
+}
+
+// Convert the image in the given number of bands, merging the band statistics
+static void convert( const imageConversionKernels::parameters& params, const imageConversionKernels::scan& s,
+                     int bands, const unsigned char* dataIn, QVector<rgbPixel>& dataOut,
+                     imageBandStatistics& stats )
+{
+    // Fill the output with a value the kernels never write, so missing pixels are noticed
+    dataOut.resize( s.outCount*s.inCount );
+    memset( dataOut.data(), 0x5a, dataOut.count()*sizeof( rgbPixel ) );
+
+    stats.clear();
+    for( int i = 0; i < bands; i++ )
+    {
+        imageBandStatistics bandStats;
+        bandStats.clear();
+        imageConversionKernels::buildBand( params, s,
+                                           s.outCount*i/bands, s.outCount*(i+1)/bands,
+                                           dataIn, dataOut.data(), bandStats );
+        stats.merge( bandStats );
+    }
+}
+
+// Return true if two conversions are identical
+static bool isSame( const QVector<rgbPixel>& outA, const imageBandStatistics& statsA,
+                    const QVector<rgbPixel>& outB, const imageBandStatistics& statsB )
+{
+    return outA.count() == outB.count() &&
+           memcmp( outA.constData(), outB.constData(), outA.count()*sizeof( rgbPixel ) ) == 0 &&
+           statsA.minP == statsB.minP &&
+           statsA.maxP == statsB.maxP &&
+           memcmp( statsA.bins, statsB.bins, sizeof( statsA.bins ) ) == 0;
+}
+
+//==============================================================================
+// Tests
+//==============================================================================
+
+// Compare every combination against the portable kernels. Returns the number of failures.
+static int testCorrectness( const QVector<QENumericKernels::InstructionSets>& sets, int& tests )
+{
+    int failures = 0;
+    const QVector<rgbPixel> lookup = makeLookup( 256 );
+    const QVector<rgbPixel> fullLookup = makeLookup( 1 << 16 );
+
+    for( unsigned int si = 0; si < sizeof( sizes )/sizeof( sizes[0] ); si++ )
+    {
+        const unsigned long w = sizes[si].width;
+        const unsigned long h = sizes[si].height;
+
+        for( unsigned int di = 0; di < sizeof( depths )/sizeof( depths[0] ); di++ )
+        {
+            const QVector<unsigned char> data = makeImageData( w, h, depths[di].bytesPerPixel );
+
+            for( unsigned int fi = 0; fi < sizeof( formats )/sizeof( formats[0] ); fi++ )
+            {
+                for( int mode = 0; mode < LOOKUP_COUNT; mode++ )
+                {
+                    imageConversionKernels::parameters params =
+                        makeParameters( formats[fi].format, w, h, depths[di].bytesPerPixel, depths[di].bitDepth,
+                                        (lookupModes)mode, lookup, fullLookup );
+
+                    for( int scanOption = 1; scanOption <= 8; scanOption++ )
+                    {
+                        for( int region = 0; region < 2; region++ )
+                        {
+                            imageConversionKernels::scan s = makeScan( scanOption, w, h, region != 0 );
+
+                            // Reference conversion: portable kernels, one band
+                            QVector<rgbPixel> refOut;
+                            imageBandStatistics refStats;
+                            QENumericKernels::setInstructionSet( QENumericKernels::Portable );
+                            convert( params, s, 1, data.constData(), refOut, refStats );
+
+                            for( int ii = 0; ii < sets.count(); ii++ )
+                            {
+                                QENumericKernels::setInstructionSet( sets[ii] );
+                                for( unsigned int bi = 0; bi < sizeof( bandSplits )/sizeof( bandSplits[0] ); bi++ )
+                                {
+                                    QVector<rgbPixel> out;
+                                    imageBandStatistics stats;
+                                    convert( params, s, bandSplits[bi], data.constData(), out, stats );
+                                    tests++;
+                                    if( !isSame( refOut, refStats, out, stats ) )
+                                    {
+                                        failures++;
+                                        printf( "FAIL: %lux%lu %s %lu byte %u bit, %s lookup, scan %d%s, %s, %d bands\n",
+                                                w, h, formats[fi].name,
+                                                depths[di].bytesPerPixel, depths[di].bitDepth,
+                                                lookupNames[mode], scanOption, region ? " (region)" : "",
+                                                QENumericKernels::instructionSetName( sets[ii] ), bandSplits[bi] );
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+// Report the throughput of each instruction set for a larger image
+static void testThroughput( const QVector<QENumericKernels::InstructionSets>& sets,
+                            unsigned long w, unsigned long h )
+{
+    const QVector<rgbPixel> lookup = makeLookup( 256 );
+    const QVector<rgbPixel> fullLookup = makeLookup( 1 << 16 );
+
+    printf( "\nthroughput, %lux%lu pixels, Mpixel/S\n", w, h );
+    printf( "%-8s %-13s %-7s %-5s", "format", "depth", "lookup", "scan" );
+    for( int ii = 0; ii < sets.count(); ii++ )
+    {
+        printf( " %9s", QENumericKernels::instructionSetName( sets[ii] ) );
+    }
+    printf( "\n" );
+
+    static const int scanOptions[] = { 1, 5 };
+    for( unsigned int di = 0; di < sizeof( depths )/sizeof( depths[0] ); di++ )
+    {
+        const QVector<unsigned char> data = makeImageData( w, h, depths[di].bytesPerPixel );
+        for( unsigned int fi = 0; fi < 2; fi++ )    // Mono and one Bayer format
+        {
+            for( int mode = LOOKUP_FULL; mode <= LOOKUP_SCALED; mode++ )
+            {
+                imageConversionKernels::parameters params =
+                    makeParameters( formats[fi].format, w, h, depths[di].bytesPerPixel, depths[di].bitDepth,
+                                    (lookupModes)mode, lookup, fullLookup );
+
+                for( unsigned int oi = 0; oi < sizeof( scanOptions )/sizeof( scanOptions[0] ); oi++ )
+                {
+                    imageConversionKernels::scan s = makeScan( scanOptions[oi], w, h, false );
+                    char depthText[20];
+                    sprintf( depthText, "%lu byte %2u bit", depths[di].bytesPerPixel, depths[di].bitDepth );
+                    printf( "%-8s %-13s %-7s %-5d", formats[fi].name, depthText, lookupNames[mode], scanOptions[oi] );
+
+                    for( int ii = 0; ii < sets.count(); ii++ )
+                    {
+                        QENumericKernels::setInstructionSet( sets[ii] );
+                        QVector<rgbPixel> out;
+                        imageBandStatistics stats;
+
+                        // Convert repeatedly for at least a short while
+                        QElapsedTimer timer;
+                        timer.start();
+                        int repeats = 0;
+                        do
+                        {
+                            convert( params, s, 1, data.constData(), out, stats );
+                            repeats++;
+                        } while( timer.nsecsElapsed() < 200000000 );
+
+                        double mPixels = double( w*h )*repeats / 1.0e6;
+                        printf( " %9.1f", mPixels / ( double( timer.nsecsElapsed() ) / 1.0e9 ) );
+                    }
+                    printf( "\n" );
+                }
+            }
+        }
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    unsigned long width = 2048;
+    unsigned long height = 2048;
+    if( argc == 3 )
+    {
+        width = strtoul( argv[1], NULL, 10 );
+        height = strtoul( argv[2], NULL, 10 );
+    }
+    if( ( argc != 1 && argc != 3 ) || width == 0 || height == 0 )
+    {
+        printf( "usage: %s [width height]\n", argv[0] );
+        return 2;
+    }
+
+    // Instruction sets available on this processor (the portable kernels are always available)
+    QVector<QENumericKernels::InstructionSets> sets;
+    const QENumericKernels::InstructionSets available = QENumericKernels::availableInstructionSet();
+    for( int i = QENumericKernels::Portable; i <= available; i++ )
+    {
+        sets.append( (QENumericKernels::InstructionSets)i );
+    }
+
+    int tests = 0;
+    int failures = testCorrectness( sets, tests );
+    printf( "correctness: %d conversions, %d failed\n", tests, failures );
+
+    testThroughput( sets, width, height );
+
+    printf( "\n%s\n", failures ? "RESULTS DIFFER" : "all results identical" );
+    return failures ? 1 : 0;
+}
+
+// end
@@ -0,0 +1,55 @@
+# File: qeframeworkSup/project/test/imageConversionKernelsTest/imageConversionKernelsTest.pro
+#
+# Copyright (c) 2026 Australian Synchrotron
+#
+# This file is part of the EPICS QT Framework, initially developed at the Australian Synchrotron.
+# The EPICS QT Framework is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+# The EPICS QT Framework is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+# You should have received a copy of the GNU Lesser General Public License
+# along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Author: Andrew Rhyder
+# Contact details: andrew.rhyder@synchrotron.org.au
+#
+
+# Standalone correctness and throughput test for the QEImage pixel conversion
+# kernels. This is not part of the regular build, and needs neither EPICS nor
+# a display. To build and run:
+#
+#    qmake && make && ./imageConversionKernelsTest [width height]
+#
+# Every format, depth, scan option, region and band split is converted using
+# each available instruction set and compared against the portable kernels.
+# The exit status is non zero if any results differ.
+#
+# Note, the kernels themselves use only QtCore and QENumericKernels, but the
+# QEImage headers declaring the kernel types include QtWidgets headers.
+#
+
+TEMPLATE = app
+TARGET = imageConversionKernelsTest
+CONFIG += console release
+CONFIG -= app_bundle
+QT = core gui widgets
+
+# Build the framework source directly rather than link against the library.
+#
+DEFINES += QE_FRAMEWORK_LIBRARY
+
+INCLUDEPATH += ../../common
+INCLUDEPATH += ../../data
+INCLUDEPATH += ../../protocol
+INCLUDEPATH += ../../widgets/QEWidget
+INCLUDEPATH += ../../widgets/QEImage
+
+SOURCES += imageConversionKernelsTest.cpp
+SOURCES += ../../widgets/QEImage/imageConversionKernels.cpp
+SOURCES += ../../common/QENumericKernels.cpp
+
+# end
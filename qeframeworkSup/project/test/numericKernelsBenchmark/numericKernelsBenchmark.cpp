@@ -0,0 +1,359 @@
+/*  numericKernelsBenchmark.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron.
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Starritt
+ *  Contact details:
+ *    andrew.starritt@synchrotron.org.au
+ */
+
+// Standalone benchmark for QENumericKernels. Each kernel is run using each of
+// the available instruction sets. The results must be identical to those of
+// the portable implementation, save that sum and sumSquares may differ in the
+// last few bits due to summation order; the times give the benefit.
+//
+// The equivalence checks are run for all counts from 0 to 67, so as to cover
+// every tail length for both the SSE2 and AVX2 vector widths, and for the
+// full benchmark count.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QENumericKernels.h>
+
+typedef QENumericKernels NK;
+
+static const int numberSets = 3;
+static const NK::InstructionSets sets [numberSets] = { NK::Portable, NK::SSE2, NK::AVX2 };
+
+//------------------------------------------------------------------------------
+// Simple, repeatable pseudo random number generator - we want the same data
+// irrespective of platform.
+//
+static unsigned int nextRandom (unsigned int& seed)
+{
+   seed = seed * 1103515245u + 12345u;
+   return (seed >> 8) & 0xFFFFFF;
+}
+
+//------------------------------------------------------------------------------
+//
+static double elapsedMilliSec (const QElapsedTimer& timer)
+{
+   return double (timer.nsecsElapsed ()) / 1.0e6;
+}
+
+//------------------------------------------------------------------------------
+// Bit for bit comparison, so that NaN == NaN and -0.0 != +0.0.
+//
+static bool sameValues (const double* a, const double* b, const int count)
+{
+   return (count <= 0) || (memcmp (a, b, count * sizeof (double)) == 0);
+}
+
+//------------------------------------------------------------------------------
+// Allowance for summation order: relative to the sum of absolute values.
+//
+static bool closeEnough (const double a, const double b, const double scale)
+{
+   return fabs (a - b) <= 1.0e-12 * scale;
+}
+
+//------------------------------------------------------------------------------
+// Source data - integer data spans the full range of each type, the floating
+// point data includes NaN, +/-inf and signed zero values.
+//
+struct SourceData {
+   QVector<int8_t>   i8;
+   QVector<uint8_t>  u8;
+   QVector<int16_t>  i16;
+   QVector<uint16_t> u16;
+   QVector<int32_t>  i32;
+   QVector<uint32_t> u32;
+   QVector<float>    f32;
+   QVector<double>   finite;    // finite values only
+   QVector<double>   mixed;     // includes NaN, inf and -0.0
+   QVector<double>   x;         // increasing, some points very close
+};
+
+static void makeData (SourceData& data, const int number)
+{
+   unsigned int seed = 20260101;
+
+   data.i8.resize (number);
+   data.u8.resize (number);
+   data.i16.resize (number);
+   data.u16.resize (number);
+   data.i32.resize (number);
+   data.u32.resize (number);
+   data.f32.resize (number);
+   data.finite.resize (number);
+   data.mixed.resize (number);
+   data.x.resize (number);
+
+   double x = 0.0;
+   for (int j = 0; j < number; j++) {
+      const unsigned int r = nextRandom (seed);
+      const unsigned int s = nextRandom (seed);
+      const uint32_t bits = (r << 8) ^ s;
+
+      data.i8 [j]  = int8_t (r);
+      data.u8 [j]  = uint8_t (r);
+      data.i16 [j] = int16_t (r);
+      data.u16 [j] = uint16_t (r);
+      data.i32 [j] = int32_t (bits);
+      data.u32 [j] = bits;
+      data.f32 [j] = float (int32_t (bits)) / 65536.0f;
+      data.finite [j] = (double (r) - 8388608.0) / double (s + 1);
+
+      double v = data.finite [j];
+      switch (s % 41) {
+         case 0: v = NAN;        break;
+         case 1: v = INFINITY;   break;
+         case 2: v = -INFINITY;  break;
+         case 3: v = -0.0;       break;
+         default:                break;
+      }
+      data.mixed [j] = v;
+
+      x += (s % 17 == 0) ? 1.0e-12 : double (s % 1000 + 1) / 1000.0;
+      data.x [j] = x;
+   }
+}
+
+//------------------------------------------------------------------------------
+// Runs every kernel for the given count; results appended to output, one
+// slot per kernel output so that the sets can be compared.
+//
+struct KernelResults {
+   QVector<double> toDouble [7];
+   bool   minMaxOkay [2];
+   double minimum [2];
+   double maximum [2];
+   double sum;
+   double sumSquares;
+   double absSum;
+   double sumAbsSquares;
+   QVector<double> affine;
+   QVector<double> replaced;
+   int    numberReplaced;
+   QVector<double> derivative;
+};
+
+static void runKernels (const SourceData& data, const int count, KernelResults& r)
+{
+   for (int k = 0; k < 7; k++) {
+      r.toDouble [k].fill (-1.0, count);
+   }
+   NK::toDouble (data.i8.constData (),  r.toDouble [0].data (), count);
+   NK::toDouble (data.u8.constData (),  r.toDouble [1].data (), count);
+   NK::toDouble (data.i16.constData (), r.toDouble [2].data (), count);
+   NK::toDouble (data.u16.constData (), r.toDouble [3].data (), count);
+   NK::toDouble (data.i32.constData (), r.toDouble [4].data (), count);
+   NK::toDouble (data.u32.constData (), r.toDouble [5].data (), count);
+   NK::toDouble (data.f32.constData (), r.toDouble [6].data (), count);
+
+   for (int k = 0; k < 2; k++) {
+      r.minimum [k] = r.maximum [k] = 12345.0;
+      r.minMaxOkay [k] = NK::minMax (data.mixed.constData (), count, k == 1,
+                                     r.minimum [k], r.maximum [k]);
+   }
+
+   NK::sumAndSumSquares (data.finite.constData (), count, r.sum, r.sumSquares);
+   r.absSum = 0.0;
+   r.sumAbsSquares = 0.0;
+   for (int j = 0; j < count; j++) {
+      r.absSum += fabs (data.finite [j]);
+      r.sumAbsSquares += data.finite [j] * data.finite [j];
+   }
+
+   r.affine = data.mixed.mid (0, count);
+   NK::affine (r.affine.data (), count, -2.5, 0.125);
+
+   r.replaced = data.mixed.mid (0, count);
+   r.numberReplaced = NK::replaceNonFinite (r.replaced.data (), count, 0.0);
+
+   r.derivative.fill (-1.0, count);
+   if (count >= 1) {
+      NK::derivative (data.x.constData (), data.finite.constData (),
+                      r.derivative.data (), count);
+   }
+}
+
+//------------------------------------------------------------------------------
+// Compares results with the portable results, returns the number of mismatches.
+//
+static int compareResults (const KernelResults& a, const KernelResults& b,
+                           const char* setName, const int count)
+{
+   int mismatches = 0;
+
+#define CHECK(okay, kernel)                                                   \
+   if (!(okay)) {                                                             \
+      printf ("%s: %s mismatch for count %d\n", setName, kernel, count);     \
+      mismatches++;                                                           \
+   }
+
+   static const char* const toDoubleNames [7] = {
+      "toDouble (int8)", "toDouble (uint8)", "toDouble (int16)",
+      "toDouble (uint16)", "toDouble (int32)", "toDouble (uint32)",
+      "toDouble (float)"
+   };
+   for (int k = 0; k < 7; k++) {
+      CHECK (sameValues (a.toDouble [k].constData (), b.toDouble [k].constData (), count),
+             toDoubleNames [k]);
+   }
+
+   for (int k = 0; k < 2; k++) {
+      CHECK (a.minMaxOkay [k] == b.minMaxOkay [k] &&
+             sameValues (&a.minimum [k], &b.minimum [k], 1) &&
+             sameValues (&a.maximum [k], &b.maximum [k], 1),
+             k == 0 ? "minMax" : "minMax (inf)");
+   }
+
+   CHECK (closeEnough (a.sum, b.sum, a.absSum), "sum");
+   CHECK (closeEnough (a.sumSquares, b.sumSquares, a.sumAbsSquares), "sumSquares");
+   CHECK (sameValues (a.affine.constData (), b.affine.constData (), count), "affine");
+   CHECK (a.numberReplaced == b.numberReplaced &&
+          sameValues (a.replaced.constData (), b.replaced.constData (), count),
+          "replaceNonFinite");
+   CHECK (sameValues (a.derivative.constData (), b.derivative.constData (), count),
+          "derivative");
+
+#undef CHECK
+
+   return mismatches;
+}
+
+//------------------------------------------------------------------------------
+// Times each kernel, printing elements per second.
+//
+static void timeKernels (const SourceData& data, const int count, const int repeats)
+{
+   QVector<double> target (count);
+   QVector<double> work;
+   QElapsedTimer timer;
+   double ms [12];
+   double a, b;
+
+#define TIME(index, statement)                                               \
+   timer.start ();                                                           \
+   for (int rep = 0; rep < repeats; rep++) { statement; }                     \
+   ms [index] = elapsedMilliSec (timer);
+
+   TIME (0, NK::toDouble (data.i8.constData (),  target.data (), count));
+   TIME (1, NK::toDouble (data.u8.constData (),  target.data (), count));
+   TIME (2, NK::toDouble (data.i16.constData (), target.data (), count));
+   TIME (3, NK::toDouble (data.u16.constData (), target.data (), count));
+   TIME (4, NK::toDouble (data.i32.constData (), target.data (), count));
+   TIME (5, NK::toDouble (data.u32.constData (), target.data (), count));
+   TIME (6, NK::toDouble (data.f32.constData (), target.data (), count));
+   TIME (7, NK::minMax (data.mixed.constData (), count, false, a, b));
+   TIME (8, NK::sumAndSumSquares (data.finite.constData (), count, a, b));
+
+   // In situ kernels - successive repeats operate on the previous result;
+   // with m = -1.0 the values stay bounded.
+   //
+   work = data.mixed;
+   TIME (9,  NK::affine (work.data (), count, -1.0, 0.125));
+   TIME (10, NK::replaceNonFinite (work.data (), count, 0.0));
+   TIME (11, NK::derivative (data.x.constData (), data.finite.constData (), target.data (), count));
+
+#undef TIME
+
+   static const char* const names [12] = {
+      "toDouble int8", "toDouble uint8", "toDouble int16", "toDouble uint16",
+      "toDouble int32", "toDouble uint32", "toDouble float", "minMax",
+      "sumAndSumSquares", "affine", "replaceNonFinite", "derivative"
+   };
+
+   const double elements = double (count) * double (repeats);
+   for (int k = 0; k < 12; k++) {
+      const double rate = ms [k] > 0.0 ? elements / ms [k] / 1.0e3 : 0.0;
+      printf ("   %-18s %10.3f mS %10.1f M elements/S\n", names [k], ms [k], rate);
+   }
+}
+
+//------------------------------------------------------------------------------
+//
+int main (int argc, char* argv [])
+{
+   const int number = (argc >= 2) ? atoi (argv [1]) : 1000003;
+   if (number < 68) {
+      printf ("usage: %s [number_of_elements]  (at least 68)\n", argv [0]);
+      return 2;
+   }
+
+   SourceData data;
+   makeData (data, number);
+
+   const NK::InstructionSets available = NK::availableInstructionSet ();
+   printf ("elements: %d, available instruction set: %s\n\n", number,
+           NK::instructionSetName (available));
+
+   int mismatches = 0;
+
+   // Equivalence: all short counts (every tail length), and the full count.
+   //
+   QVector<int> counts;
+   for (int count = 0; count < 68; count++) counts.append (count);
+   counts.append (number);
+
+   for (int c = 0; c < counts.count (); c++) {
+      const int count = counts [c];
+      KernelResults reference;
+      NK::setInstructionSet (NK::Portable);
+      runKernels (data, count, reference);
+
+      for (int s = 1; s < numberSets; s++) {
+         if (sets [s] > available) continue;
+         NK::setInstructionSet (sets [s]);
+         KernelResults results;
+         runKernels (data, count, results);
+         mismatches += compareResults (reference, results,
+                                       NK::instructionSetName (sets [s]), count);
+      }
+   }
+
+   // Throughput.
+   //
+   const int repeats = 20;
+   for (int s = 0; s < numberSets; s++) {
+      if (sets [s] > available) {
+         printf ("%s: not available\n\n", NK::instructionSetName (sets [s]));
+         continue;
+      }
+      NK::setInstructionSet (sets [s]);
+      printf ("%s:\n", NK::instructionSetName (sets [s]));
+      timeKernels (data, number, repeats);
+      printf ("\n");
+   }
+
+   NK::setInstructionSet (available);
+
+   printf ("%s\n", mismatches == 0 ? "all results identical" : "RESULTS DIFFER");
+   return mismatches == 0 ? 0 : 1;
+}
+
+// end
@@ -0,0 +1,191 @@
+/*  pvNameSearchBenchmark.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron.
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Starritt
+ *  Contact details:
+ *    andrew.starritt@synchrotron.org.au
+ */
+
+// Standalone benchmark for QEPvNameSearch. A synthetic corpus of PV names is
+// generated, and each search is run with and without the search index. The
+// results must be identical; the times give the benefit of the index.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QEPvNameSearch.h>
+
+//------------------------------------------------------------------------------
+// Simple, repeatable pseudo random number generator - we want the same corpus
+// irrespective of platform and Qt version.
+//
+static unsigned int nextRandom (unsigned int& seed)
+{
+   seed = seed * 1103515245u + 12345u;
+   return (seed >> 8) & 0xFFFFFF;
+}
+
+//------------------------------------------------------------------------------
+// Forms names in the style of a typical facility, e.g. SR03BPM07:SA_X_MONITOR.
+//
+static QStringList makeCorpus (const int number)
+{
+   static const char* const areas [] = {
+      "SR", "BR", "LI", "BTS", "LTB", "TL", "FE", "BL"
+   };
+   static const char* const devices [] = {
+      "BPM", "BCM", "CM", "QF", "QD", "SF", "SD", "VAC", "IG", "TC",
+      "MOT", "DCCT", "RF", "KIC", "SEP", "SCR", "CAM", "PS", "GV", "FLW"
+   };
+   static const char* const fields [] = {
+      "SA_X_MONITOR", "SA_Y_MONITOR", "CURRENT_MONITOR", "CURRENT_SP",
+      "VOLTAGE_MONITOR", "TEMP_MONITOR", "STATUS", "INTERLOCK", "PRESSURE",
+      "POSITION", "POSITION_SP", "VELOCITY", "ENABLE_CMD", "RESET_CMD",
+      "ImageWidth_RBV", "ArrayCounter_RBV", "SIGNAL:LEVEL", "SIGNAL:NOISE"
+   };
+   const int numberAreas = sizeof (areas) / sizeof (areas [0]);
+   const int numberDevices = sizeof (devices) / sizeof (devices [0]);
+   const int numberFields = sizeof (fields) / sizeof (fields [0]);
+
+   unsigned int seed = 20260101;
+   QStringList result;
+   result.reserve (number);
+   while (result.count () < number) {
+      const QString name = QString ("%1%2%3%4:%5")
+            .arg (areas [nextRandom (seed) % numberAreas])
+            .arg (nextRandom (seed) % 40 + 1, 2, 10, QChar ('0'))
+            .arg (devices [nextRandom (seed) % numberDevices])
+            .arg (nextRandom (seed) % 100, 2, 10, QChar ('0'))
+            .arg (fields [nextRandom (seed) % numberFields]);
+      result.append (name);
+   }
+   return result;
+}
+
+//------------------------------------------------------------------------------
+//
+static double elapsedMilliSec (const QElapsedTimer& timer)
+{
+   return double (timer.nsecsElapsed ()) / 1.0e6;
+}
+
+//------------------------------------------------------------------------------
+//
+static bool compare (const char* kind, const QString& what,
+                     const QStringList& plain, const double plainTime,
+                     const QStringList& indexed, const double indexedTime)
+{
+   const bool same = (plain == indexed);
+   printf ("%-6s %-32s %8d %10.3f %10.3f %8.1f  %s\n", kind,
+           what.toLatin1 ().constData (), int (plain.count ()),
+           plainTime, indexedTime,
+           indexedTime > 0.0 ? plainTime / indexedTime : 0.0,
+           same ? "ok" : "MISMATCH");
+   if (!same) {
+      printf ("       un-indexed %d names, indexed %d names\n",
+              int (plain.count ()), int (indexed.count ()));
+   }
+   return same;
+}
+
+//------------------------------------------------------------------------------
+//
+int main (int argc, char* argv [])
+{
+   const int number = (argc >= 2) ? atoi (argv [1]) : 1000000;
+   if (number <= 0) {
+      printf ("usage: %s [number_of_names]\n", argv [0]);
+      return 2;
+   }
+
+   QElapsedTimer timer;
+
+   timer.start ();
+   const QStringList corpus = makeCorpus (number);
+   QEPvNameSearch plain (corpus);
+   printf ("corpus: %d names (%d unique), %.1f mS\n",
+           number, plain.count (), elapsedMilliSec (timer));
+
+   QEPvNameSearch indexed (corpus);
+   timer.start ();
+   indexed.buildIndex ();
+   printf ("index:  %.1f mS\n\n", elapsedMilliSec (timer));
+
+   // Substring searches, as used by QEArchiveNameSearch.
+   //
+   static const char* const substrings [] = {
+      "CURRENT", "sr12bpm", "QF03:", "_RBV", "ArrayCounter", "XYZZY", "SR0", "PS"
+   };
+
+   // Regular expression searches, including expressions that must not be
+   // pre-filtered, i.e. where the apparent literal text is not literal.
+   //
+   static const char* const expressions [] = {
+      "^SR12", "^SR1.BPM.*X_MON", "TEMP_MONITOR$", "BPM0[0-4]:SA_.",
+      "^(SR|BR)03", "CM\\d\\d:POS", "\\.*STATUS", "SIGNAL:(LEVEL|NOISE)",
+      "\\x53R01", "\\123R01", "S\\QR01\\E", "\\cA", "[[:digit:]]]",
+      "Q[FD]1[0-9]:CURRENT_SP", "KIC0+5", "^BTS.*_CMD$", "NO_SUCH_NAME"
+   };
+
+   printf ("kind   search                              count  plain(mS)  index(mS)  speedup\n");
+
+   bool allOkay = true;
+
+   for (unsigned int j = 0; j < sizeof (substrings) / sizeof (substrings [0]); j++) {
+      const QString str = substrings [j];
+
+      timer.start ();
+      const QStringList a = plain.getMatchingPvNames (str, Qt::CaseInsensitive);
+      const double ta = elapsedMilliSec (timer);
+
+      timer.start ();
+      const QStringList b = indexed.getMatchingPvNames (str, Qt::CaseInsensitive);
+      const double tb = elapsedMilliSec (timer);
+
+      allOkay &= compare ("string", str, a, ta, b, tb);
+   }
+
+   for (unsigned int j = 0; j < sizeof (expressions) / sizeof (expressions [0]); j++) {
+      for (int cs = 0; cs < 2; cs++) {
+         const QString pattern = expressions [j];
+         QRegularExpression re (pattern, cs ? QRegularExpression::CaseInsensitiveOption
+                                            : QRegularExpression::NoPatternOption);
+
+         timer.start ();
+         const QStringList a = plain.getMatchingPvNames (re, false);
+         const double ta = elapsedMilliSec (timer);
+
+         timer.start ();
+         const QStringList b = indexed.getMatchingPvNames (re, false);
+         const double tb = elapsedMilliSec (timer);
+
+         allOkay &= compare (cs ? "re/i" : "re", pattern, a, ta, b, tb);
+      }
+   }
+
+   printf ("\n%s\n", allOkay ? "all results identical" : "RESULTS DIFFER");
+   return allOkay ? 0 : 1;
+}
+
+// end
@@ -0,0 +1,339 @@
+/*  recordingStoreTest.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron.
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Rhyder
+ *  Contact details:
+ *    andrew.rhyder@synchrotron.org.au
+ */
+
+// Standalone test of recordingStore.
+//
+// Images are recorded with a small memory budget so the oldest images are spilled to disk by
+// the spill thread. The cases cover reading back every image (spilled or not, uncompressed and
+// zlib compressed) in any order, discarding the oldest images, the disk budget, and what happens
+// when images can't be spilled: no more images are spilled, the reason is available, and the
+// store becomes full so recording stops.
+
+#include <stdio.h>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QCaAlarmInfo.h>
+#include <QCaDateTime.h>
+#include <recordingStore.h>
+
+#define KBYTES 1024
+#define MBYTES (1024*1024)
+
+// Memory budget used for the test (MBytes)
+#define TEST_MEMORY 1
+
+// Images waiting to be spilled before the store is considered full, if more than the memory budget (as per recordingStore.cpp)
+#define MIN_SPILL_BACKLOG (64*MBYTES)
+
+// Maximum time to wait for the spill thread (mS)
+#define SPILL_TIMEOUT 10000
+
+//==============================================================================
+// Test images
+//==============================================================================
+
+// Simple, repeatable pseudo random number generator
+static unsigned int nextRandom( unsigned int& seed )
+{
+    seed = seed * 1103515245u + 12345u;
+    return ( seed >> 8 ) & 0xFFFFFF;
+}
+
+// Generate distinct image data for each image. Mostly smooth, with a little noise, so it compresses.
+static QByteArray makeImageData( int size, int number )
+{
+    QByteArray data( size, 0 );
+    unsigned int seed = number + 1;
+    for( int i = 0; i < size; i++ )
+    {
+        data[i] = (char)( ( i / 64 + number ) + ( nextRandom( seed ) & 0x3 ) );
+    }
+    return data;
+}
+
+// Generate an image with a distinct time and alarm state
+static historicImage makeImage( int size, int number )
+{
+    QCaAlarmInfo alarmInfo( number % 20, number % 4 );
+    QCaDateTime time( 1000000 + number, number * 1000 );
+    return historicImage( makeImageData( size, number ), 2, alarmInfo, time );
+}
+
+// Set the recording options read when a store is constructed
+static void setOptions( const QString& directory, const char* compression, int diskBudget )
+{
+    qputenv( "QE_IMAGE_RECORDING_MEMORY", QByteArray::number( TEST_MEMORY ) );
+    qputenv( "QE_IMAGE_RECORDING_DISK", QByteArray::number( diskBudget ) );
+    qputenv( "QE_IMAGE_RECORDING_COMPRESSION", compression );
+    qputenv( "QE_IMAGE_RECORDING_DIRECTORY", directory.toLocal8Bit() );
+}
+
+// Number of spill files in a directory
+static int spillFiles( const QString& directory )
+{
+    return QDir( directory ).entryList( QStringList() << "QEImageRecording_*", QDir::Files ).count();
+}
+
+// Wait for the spill thread to bring the images held in memory within the memory budget
+static bool waitForSpill( recordingStore& store )
+{
+    QElapsedTimer timer;
+    timer.start();
+    while( store.getMemoryUsed() > TEST_MEMORY*MBYTES )
+    {
+        if( timer.elapsed() > SPILL_TIMEOUT )
+        {
+            return false;
+        }
+        QThread::msleep( 10 );
+    }
+    return true;
+}
+
+// Wait for the spill thread to report a spill error
+static bool waitForSpillError( recordingStore& store )
+{
+    QElapsedTimer timer;
+    timer.start();
+    QString error;
+    while( !store.getSpillError( error ) )
+    {
+        if( timer.elapsed() > SPILL_TIMEOUT )
+        {
+            return false;
+        }
+        QThread::msleep( 10 );
+    }
+    return true;
+}
+
+//==============================================================================
+// Checks
+//==============================================================================
+
+static int checks = 0;
+static int failures = 0;
+
+static void check( bool okay, const char* name, const QString& what )
+{
+    checks++;
+    if( !okay )
+    {
+        failures++;
+        printf( "FAIL: %s: %s\n", name, what.toLatin1().constData() );
+    }
+}
+
+// Retrieve an image and check it is the image recorded
+static void checkFrame( const char* name, recordingStore& store, int index, int size, int number )
+{
+    historicImage frame;
+    if( !store.getFrame( index, frame ) )
+    {
+        check( false, name, QString( "image %1 retrieved" ).arg( index ) );
+        return;
+    }
+
+    const historicImage expected = makeImage( size, number );
+    check( frame.image == expected.image, name, QString( "image %1 data" ).arg( index ) );
+    check( frame.dataSize == expected.dataSize, name, QString( "image %1 data size" ).arg( index ) );
+    check( frame.time.getSeconds() == expected.time.getSeconds() &&
+           frame.time.getNanoSeconds() == expected.time.getNanoSeconds(), name, QString( "image %1 time" ).arg( index ) );
+    check( frame.alarmInfo.getStatus() == expected.alarmInfo.getStatus() &&
+           frame.alarmInfo.getSeverity() == expected.alarmInfo.getSeverity(), name, QString( "image %1 alarm" ).arg( index ) );
+}
+
+//==============================================================================
+// Cases
+//==============================================================================
+
+// Record more images than the memory budget allows, and read them all back
+static void testSpill( const char* name, const char* compression )
+{
+    const int imageSize = 256*KBYTES;
+    const int images = 40;
+
+    QTemporaryDir directory;
+    setOptions( directory.path(), compression, 0 );
+    {// set scope of the store
+        recordingStore store;
+        for( int i = 0; i < images; i++ )
+        {
+            store.append( makeImage( imageSize, i ) );
+        }
+
+        check( waitForSpill( store ), name, "images spilled to within the memory budget" );
+        check( store.count() == images, name, "image count" );
+        check( !store.isFull(), name, "not full" );
+        check( spillFiles( directory.path() ) == 1, name, "one spill file" );
+
+        const qint64 spilledBytes = (qint64)images*imageSize - store.getMemoryUsed();
+        check( spilledBytes > 0, name, "images spilled" );
+        if( QString( compression ) == "none" )
+        {
+            check( store.getDiskUsed() == spilledBytes, name, QString( "disk used %1 expected %2" ).arg( store.getDiskUsed() ).arg( spilledBytes ) );
+        }
+        else
+        {
+            check( store.getDiskUsed() > 0 && store.getDiskUsed() < spilledBytes, name,
+                   QString( "disk used %1 compressed from %2" ).arg( store.getDiskUsed() ).arg( spilledBytes ) );
+        }
+
+        // Read back every image, in no particular order
+        for( int i = 0; i < images; i++ )
+        {
+            int index = ( i * 17 ) % images;
+            checkFrame( name, store, index, imageSize, index );
+        }
+
+        // Discard the oldest images. The remaining images are still retrieved.
+        const qint64 diskUsed = store.getDiskUsed();
+        for( int i = 0; i < 10; i++ )
+        {
+            store.removeFirst();
+        }
+        check( store.count() == images - 10, name, "image count after discarding" );
+        check( store.getDiskUsed() < diskUsed, name, "disk used after discarding" );
+        checkFrame( name, store, 0, imageSize, 10 );
+        checkFrame( name, store, images - 11, imageSize, images - 1 );
+
+        historicImage frame;
+        check( !store.getFrame( images - 10, frame ), name, "image beyond the last not retrieved" );
+
+        store.clear();
+        check( store.count() == 0 && store.getMemoryUsed() == 0 && store.getDiskUsed() == 0, name, "cleared" );
+        check( !store.getFrame( 0, frame ), name, "no image retrieved once cleared" );
+    }
+    check( spillFiles( directory.path() ) == 0, name, "spill files removed" );
+}
+
+// Recording stops once the disk budget is reached
+static void testDiskBudget()
+{
+    const char* name = "disk budget";
+    const int imageSize = 256*KBYTES;
+    const int diskBudget = 2;
+
+    QTemporaryDir directory;
+    setOptions( directory.path(), "none", diskBudget );
+    recordingStore store;
+
+    // Add images, as the recorder does, until the store is full.
+    // Once the spill thread has caught up, the images held in memory are exactly the memory budget,
+    // so the store is full once the disk budget has also been spilled.
+    int images = 0;
+    while( !store.isFull() && images < 100 )
+    {
+        store.append( makeImage( imageSize, images++ ) );
+        check( waitForSpill( store ), name, QString( "image %1 spilled" ).arg( images ) );
+    }
+
+    const int expected = ( TEST_MEMORY + diskBudget ) * MBYTES / imageSize;
+    check( images == expected, name, QString( "full after %1 images, expected %2" ).arg( images ).arg( expected ) );
+    check( store.getDiskUsed() == diskBudget*MBYTES, name, "disk used" );
+    checkFrame( name, store, 0, imageSize, 0 );
+    checkFrame( name, store, images - 1, imageSize, images - 1 );
+
+    // Discarding the oldest images makes room again
+    store.removeFirst();
+    check( !store.isFull(), name, "not full once an image is discarded" );
+}
+
+// Images can't be spilled as the spill directory does not exist.
+// The reason is reported, no more images are spilled (even once the directory exists), and the store
+// becomes full (so the recorder stops) once the images waiting to be spilled reach the backlog limit.
+static void testSpillFailure()
+{
+    const char* name = "spill failure";
+    const int imageSize = 256*KBYTES;
+    const int images = 8;
+
+    QTemporaryDir directory;
+    const QString missing = QDir( directory.path() ).filePath( "missing" );
+    setOptions( missing, "none", 0 );
+    recordingStore store;
+
+    for( int i = 0; i < images; i++ )
+    {
+        store.append( makeImage( imageSize, i ) );
+    }
+
+    check( waitForSpillError( store ), name, "spill error reported" );
+    QString error;
+    store.getSpillError( error );
+    check( error.contains( missing ), name, QString( "spill error names the directory: %1" ).arg( error ) );
+    check( store.getDiskUsed() == 0, name, "nothing spilled" );
+    check( store.getMemoryUsed() == (qint64)images*imageSize, name, "all images held in memory" );
+    check( !store.isFull(), name, "not yet full" );
+    check( !QDir( missing ).exists(), name, "spill directory not created" );
+
+    // No more images are spilled, even if they now could be
+    QDir( directory.path() ).mkdir( "missing" );
+
+    // Add 1 MByte images, as the recorder does, until the store is full
+    const int bigImageSize = MBYTES;
+    int added = 0;
+    while( !store.isFull() && added < 100 )
+    {
+        store.append( makeImage( bigImageSize, images + added++ ) );
+    }
+    const qint64 backlog = TEST_MEMORY*MBYTES + ( TEST_MEMORY*MBYTES > MIN_SPILL_BACKLOG ? TEST_MEMORY*MBYTES : MIN_SPILL_BACKLOG );
+    const int expected = ( backlog - (qint64)images*imageSize ) / bigImageSize + 1;
+    check( added == expected, name, QString( "full after %1 more images, expected %2" ).arg( added ).arg( expected ) );
+    QThread::msleep( 200 );
+    check( store.getDiskUsed() == 0 && spillFiles( missing ) == 0, name, "still nothing spilled" );
+
+    // All images are still available from memory
+    checkFrame( name, store, 0, imageSize, 0 );
+    checkFrame( name, store, images, bigImageSize, images );
+    checkFrame( name, store, store.count() - 1, bigImageSize, store.count() - 1 );
+
+    // Clearing the store clears the error
+    store.clear();
+    check( !store.getSpillError( error ), name, "spill error cleared" );
+    check( !store.isFull(), name, "not full once cleared" );
+}
+
+int main( int argc, char* argv[] )
+{
+    QCoreApplication app( argc, argv );
+
+    testSpill( "spill uncompressed", "none" );
+    testSpill( "spill zlib", "zlib" );
+    testDiskBudget();
+    testSpillFailure();
+
+    printf( "%d checks, %d failed\n", checks, failures );
+    printf( "\n%s\n", failures ? "CHECKS FAILED" : "all checks passed" );
+    return failures ? 1 : 0;
+}
+
+// end
@@ -0,0 +1,51 @@
+# File: qeframeworkSup/project/test/recordingStoreTest/recordingStoreTest.pro
+#
+# Copyright (c) 2026 Australian Synchrotron
+#
+# This file is part of the EPICS QT Framework, initially developed at the Australian Synchrotron.
+# The EPICS QT Framework is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+# The EPICS QT Framework is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+# You should have received a copy of the GNU Lesser General Public License
+# along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Author: Andrew Rhyder
+# Contact details: andrew.rhyder@synchrotron.org.au
+#
+
+# Standalone test of the QEImage recording store. This is not part of the
+# regular build, and needs no display. recordingStore uses the framework's
+# alarm, time and adaptation parameter classes, so this links against the
+# framework library, located using QE_FRAMEWORK as per the plugin.
+# recordingStore is not an exported class, so this test is for Linux/macOS
+# builds. To build and run:
+#
+#    qmake && make && ./recordingStoreTest
+#
+# Spill files are written to (and removed from) temporary directories, and
+# around 70 MBytes of memory is used. The exit status is non zero if any
+# check fails.
+#
+
+TEMPLATE = app
+TARGET = recordingStoreTest
+CONFIG += console release
+CONFIG -= app_bundle
+QT = core
+
+INCLUDEPATH += ../../data
+INCLUDEPATH += ../../protocol
+INCLUDEPATH += ../../widgets/QEWidget
+INCLUDEPATH += ../../widgets/QEImage
+
+SOURCES += recordingStoreTest.cpp
+
+LIBS += -L$$(QE_FRAMEWORK)/lib/$$(EPICS_HOST_ARCH) -lQEFramework
+unix: QMAKE_LFLAGS += -Wl,-rpath,$$(QE_FRAMEWORK)/lib/$$(EPICS_HOST_ARCH)
+
+# end
@@ -0,0 +1,618 @@
+/*  stringFormattingBenchmark.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron.
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Starritt
+ *  Contact details:
+ *    andrew.starritt@synchrotron.org.au
+ */
+
+// Standalone benchmark for the QEStringFormatting numeric format plan.
+// The previous implementation of the numeric toString functions is retained
+// here, verbatim save for reading the configuration via the get functions.
+// Values are formatted across radix, precision, notation, separator, leading
+// zero, sign and prefix settings, as scalars, as arrays (append and index
+// actions) and with database enumerations, using both implementations.
+// The results must be identical; the times give the benefit of the plan.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits>
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVariantList>
+#include <QVector>
+#include <QEStringFormatting.h>
+
+#define ABS(a)             ((a) >= 0  ? (a) : -(a))
+#define MIN(a, b)          ((a) <= (b) ? (a) : (b))
+#define MAX(a, b)          ((a) >= (b) ? (a) : (b))
+#define LIMIT(x,low,high)  (MAX(low, MIN(x, high)))
+#define EXP10(x)           exp (2.302585092994046 * (x))
+
+//------------------------------------------------------------------------------
+// Simple, repeatable pseudo random number generator - we want the same values
+// irrespective of platform and Qt version.
+//
+static unsigned int nextRandom (unsigned int& seed)
+{
+   seed = seed * 1103515245u + 12345u;
+   return (seed >> 8) & 0xFFFFFF;
+}
+
+//------------------------------------------------------------------------------
+//
+static double elapsedMilliSec (const QElapsedTimer& timer)
+{
+   return double (timer.nsecsElapsed ()) / 1.0e6;
+}
+
+//==============================================================================
+// The previous implementation.
+//==============================================================================
+//
+static const char radixChars[] = "0123456789ABCDEF";
+
+const static char separatorChars[] = "?,_ ";
+
+static const int separatorGaps[17] = {
+   -1, -1,
+   /* 2  => */ 8, 5, 5, 5, 5, 5,
+   /* 8  => */ 5, 5,
+   /* 10 => */ 3, 5, 5, 5, 5, 5,
+   /* 16 => */ 4
+};
+
+class PreviousFormatting {
+public:
+   // Takes a snapshot of the configuration of the given formatting object.
+   // The database precision is not readable, so is passed in.
+   //
+   explicit PreviousFormatting (const QEStringFormatting& sf,
+                                const unsigned int dbPrecisionIn)
+   {
+      this->precision = sf.getPrecision ();
+      this->useDbPrecision = sf.getUseDbPrecision ();
+      this->dbPrecision = dbPrecisionIn;
+      this->leadingZeros = sf.getLeadingZeros ();
+      this->forceSign = sf.getForceSign ();
+      this->separator = sf.getSeparator ();
+      this->radixBase = sf.getRadix ();
+      this->notation = sf.getNotation ();
+      this->useRadixPrefix = sf.getUseRadixPrefix ();
+   }
+
+   QString toString (const long value) const
+   {
+      return this->toIntegerStringGeneric <long> (value);
+   }
+
+   QString toString (const unsigned long value) const
+   {
+      return this->toIntegerStringGeneric <unsigned long> (value);
+   }
+
+   QString toString (const double value) const;
+
+private:
+   template<typename Number>
+   QString toIntegerStringGeneric (const Number value) const;
+
+   bool useScientificNotation (const double value) const;
+
+   int precision;
+   bool useDbPrecision;
+   unsigned int dbPrecision;
+   int leadingZeros;
+   bool forceSign;
+   QE::Separators separator;
+   int radixBase;
+   QE::Notations notation;
+   bool useRadixPrefix;
+};
+
+//------------------------------------------------------------------------------
+//
+bool PreviousFormatting::useScientificNotation (const double value) const
+{
+   if (this->notation == QE::Fixed) return false;
+   if (this->notation == QE::Scientific) return true;
+
+   // Pick best/most approptiate notation based on the value.
+   // This is athe same logic as in formatFromFloating
+   // Extact precision being used.
+   //
+   const int prec = LIMIT (this->precision, 0, 15);
+
+   // Example, if prec = 3, when low limit is 0.01
+   //
+   const double lowFixedLimit = EXP10 (1 - prec);
+   const double highFixedLimit = 1.0E+05;
+
+   // Work with the absolute value
+   //
+   const double absValue = ABS (value);
+   const bool inFixedLimits = (absValue >= lowFixedLimit) &&
+                              (absValue < highFixedLimit);
+
+   return (absValue != 0.0) && !inFixedLimits;
+}
+
+//------------------------------------------------------------------------------
+//
+QString PreviousFormatting::toString (const double value) const
+{
+   // Some of these could be pre-computed once.
+   //
+   const QString sign = (value < 0.0) ? "-" : (this->forceSign ? "+" : "");
+   const int zeros = LIMIT (this->leadingZeros, 0, 64);
+   const char sepChar = separatorChars[this->separator];
+   const int gap = (this->separator == QE::NoSeparator) ? -1 : separatorGaps[this->radixBase];
+
+   const int prec = LIMIT (this->useDbPrecision ? int (this->dbPrecision) : this->precision, 0, 64);
+
+   // Sanity checks/specials.
+   //
+   if (std::isnan (value)) {
+      return "nan";
+   }
+
+   if (std::isinf (value)) {
+      return sign + "inf";
+   }
+
+   QString result = "";
+
+   // Do leading sign if needed or requested.
+   //
+   result.append (sign);
+
+   // Is a radix prefix required?
+   //
+   if (this->useRadixPrefix && (this->radixBase != 10)) {
+      // Yes - do prefix.
+      //
+      if (this->radixBase == 16) {
+         result.append ("0x");
+      } else {
+         result.append (QString ("%1#").arg (this->radixBase));
+      }
+   }
+
+   double work = ABS (value);   // working value
+   const double dblRadix = this->radixBase;
+
+   if (this->useScientificNotation (value)) {
+      // Scientifc representation.
+      //
+      int exponent = 0;
+
+      if (work != 0.0) {
+         // Non-zero value - normalise the value.
+         //
+         if (work >= dblRadix) {
+            while (work >= dblRadix) {
+               work /= dblRadix;
+               exponent += 1;
+            }
+         } else if (work < 1.0) {
+            while (work < 1.0) {
+               work *= dblRadix;
+               exponent -= 1;
+            }
+         }
+         // now:  1.0 <= value < 10.0 in the nominated base (unless is zero).
+
+         // Round up by half the value of the least significant digit.
+         //
+         const double roundUp = pow ((1.0 / dblRadix), prec) * 0.5;
+         work = work + roundUp;
+
+         // Check if the round up pushed us into the next radix-decade?
+         //
+         if (work >= dblRadix) {
+            work /= dblRadix;
+            exponent += 1;
+         }
+      }
+
+      // Leading zeros
+      for (int j = zeros; j >= 2; j--) {
+         if ((gap > 0) && ((j % gap) == 0) && (j < zeros)) {
+            result.append (sepChar);
+         }
+         result.append ('0');
+      }
+
+      int r = int (work);   // rounds down towards zero
+      result.append (radixChars[r]);
+
+      if (prec > 0) {
+         result.append ('.');
+         for (int j = 1; j <= prec; j++) {
+            work = dblRadix * (work - r);
+            r = int (work);
+            result.append (radixChars[r]);
+
+            if ((gap > 0) && ((j % gap) == 0) && (j < prec)) {
+               result.append (sepChar);
+            }
+         }
+      }
+
+      // Now do the exponent.
+      // Be consistant with toFloatingValue re selection of e vs. p
+      //
+      char xp[20];
+      if (this->radixBase >= 11) {
+         snprintf (xp, sizeof (xp), "p%+03d", exponent);
+      } else {
+         snprintf (xp, sizeof (xp), "e%+03d", exponent);
+      }
+      result.append (xp);
+
+   } else {
+      // Fixed point representation.
+      //
+      // Round up by half the value of the least significant digit.
+      //
+      const double roundUp = pow ((1.0 / dblRadix), prec) * 0.5;
+      work = work + roundUp;
+
+      // Find most significant digit position.
+      // Units are 0, tens are 1, etc.
+      //
+      int mostSig = 0;
+      if (work >= dblRadix) {
+         double temp = work;
+         while (temp >= dblRadix) {
+            temp /= dblRadix;
+            mostSig += 1;
+         }
+      }
+
+      mostSig = MAX (mostSig, zeros - 1);
+      for (int n = mostSig; n >= -prec; n--) {
+         double prs = pow (dblRadix, n);
+         int r = int (floor (work / prs));
+         work = work - r * prs;
+
+         result.append (radixChars[r]);
+
+         // All done?
+         //
+         if (n <= -prec)
+            break;
+
+         if (n == 0) {
+            result.append ('.');
+         } else if ((gap > 0) && (ABS (n) % gap) == 0) {
+            result.append (sepChar);
+         }
+      }
+   }
+
+   return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template<typename Number>
+QString PreviousFormatting::toIntegerStringGeneric (const Number value) const
+{
+   // Some of these could be pre-computed once.
+   //
+   const QString sign = (value < 0) ? "-" : (this->forceSign ? "+" : "");
+   const int zeros = LIMIT (this->leadingZeros, 0, 64);
+   const char sepChar = separatorChars[this->separator];
+   const int gap = (this->separator == QE::NoSeparator) ? -1 : separatorGaps[this->radixBase];
+
+   // Big enough for a 64 bit integer on base 2 plus separators, sign and nn#
+   // Given zeros are allowed upto 64, then 86 required for decimal.
+   // Plus some for any extra I haven't thought about.
+   //
+   char work[96];
+   int p = sizeof (work);
+   work[--p] = '\0';            // Fill work in backwards
+
+   int n = 0;                   // Number of digits so far - excluding separators
+   Number t = value;              // Working value
+   do {
+      Number q = t / Number (this->radixBase);
+      Number r = t % Number (this->radixBase);
+
+      if (r < 0)
+         r = -r;
+
+      work[--p] = radixChars[r];
+      n++;
+
+      // Add the separator char if needs be.
+      //
+      if ((gap > 0) && (n % gap == 0))
+         work[--p] = sepChar;
+
+      t = q;
+   } while ((t != 0 || n < zeros) && (p > 0));
+
+   if (work[p] == sepChar) {
+      p++;                      // no leading separator wanted
+   }
+
+   // Do we need to add the radix prefix?
+   //
+   if (this->useRadixPrefix && (this->radixBase != 10)) {
+      // Do the prefix, note the special for base 16.
+      //
+      if (this->radixBase == 16) {
+         // We can't but the 0x directly in the string as %1 becomes %10
+         //
+         return QString ("%1%2%3").arg (sign).arg ("0x").arg (&work[p]);
+      } else {
+         return QString ("%1%2#%3").arg (sign).arg (this->radixBase).arg (&work[p]);
+      }
+   }
+
+   // No radix prefix
+   //
+   return QString ("%1%2").arg (sign).arg (&work[p]);
+}
+
+//==============================================================================
+// Test data and comparison.
+//==============================================================================
+//
+struct TestValues {
+   QVector<double> doubles;
+   QVector<long> longs;
+   QVector<unsigned long> ulongs;
+};
+
+//------------------------------------------------------------------------------
+// Doubles span many magnitudes and include zero, signed values and the
+// specials; integers include the type limits.
+//
+static void makeValues (TestValues& values, const int number)
+{
+   unsigned int seed = 20260101;
+
+   values.doubles << 0.0 << -0.0 << 1.0 << -1.0 << 0.5 << 99999.5 << 1.0e5
+                  << 0.01 << 0.00999 << 123456.789 << 1.0e-300 << 1.0e300
+                  << std::numeric_limits<double>::quiet_NaN ()
+                  << std::numeric_limits<double>::infinity ()
+                  << -std::numeric_limits<double>::infinity ();
+
+   values.longs << 0L << 1L << -1L << 1000L << -65536L
+                << std::numeric_limits<long>::max ()
+                << std::numeric_limits<long>::min ();
+
+   values.ulongs << 0UL << 1UL << 4095UL
+                 << std::numeric_limits<unsigned long>::max ();
+
+   while (values.doubles.count () < number) {
+      const double mantissa = double (nextRandom (seed)) / double (0x1000000);
+      const int exponent = int (nextRandom (seed) % 25) - 12;
+      const double sign = (nextRandom (seed) & 1) ? -1.0 : 1.0;
+      values.doubles.append (sign * mantissa * pow (10.0, exponent));
+   }
+
+   while (values.longs.count () < number) {
+      const int bits = nextRandom (seed) % 48;
+      const long magnitude = long ((qint64 (nextRandom (seed)) << 24 | nextRandom (seed)) >> (47 - bits));
+      values.longs.append ((nextRandom (seed) & 1) ? -magnitude : magnitude);
+   }
+
+   while (values.ulongs.count () < number) {
+      const int bits = nextRandom (seed) % 48;
+      values.ulongs.append ((quint64 (nextRandom (seed)) << 24 | nextRandom (seed)) >> (47 - bits));
+   }
+}
+
+//------------------------------------------------------------------------------
+// Reports at most a few mismatches in detail.
+//
+static int mismatches = 0;
+
+static void check (const QString& expected, const QString& actual, const char* what)
+{
+   if (expected == actual) return;
+   mismatches++;
+   if (mismatches <= 10) {
+      printf ("%s mismatch: previous \"%s\" framework \"%s\"\n", what,
+              expected.toLatin1 ().constData (), actual.toLatin1 ().constData ());
+   }
+}
+
+//------------------------------------------------------------------------------
+// Scalars, via both the primitive toString functions and formatString.
+// Successive configurations use successive slices of the values, so that
+// all the values are used.
+//
+static void compareScalars (QEStringFormatting& sf, const PreviousFormatting& pf,
+                            const TestValues& values, const int first, const int number)
+{
+   for (int k = first; k < first + number; k++) {
+      const double d = values.doubles [k % values.doubles.count ()];
+      const long l = values.longs [k % values.longs.count ()];
+      const unsigned long u = values.ulongs [k % values.ulongs.count ()];
+
+      check (pf.toString (d), sf.toString (d), "double");
+      check (pf.toString (l), sf.toString (l), "long");
+      check (pf.toString (u), sf.toString (u), "unsigned long");
+   }
+
+   // The specials are always included.
+   //
+   sf.setFormat (QE::Floating);
+   for (int j = 0; j < 15; j++) {
+      const double d = values.doubles [j];
+      check (pf.toString (d), sf.formatString (QVariant (d), 0), "formatString double");
+   }
+   sf.setFormat (QE::Default);
+}
+
+//------------------------------------------------------------------------------
+// Arrays, using the append and index array actions.
+//
+static void compareArrays (QEStringFormatting& sf, const PreviousFormatting& pf,
+                           const TestValues& values)
+{
+   const int size = 12;
+   QVariantList array;
+   QString expected;
+   for (int j = 0; j < size; j++) {
+      const double d = values.doubles [values.doubles.count () - 1 - j];
+      array.append (QVariant (d));
+      if (j > 0) expected.append (" ");
+      expected.append (pf.toString (d));
+   }
+
+   sf.setArrayAction (QE::Append);
+   check (expected, sf.formatString (QVariant (array), 0), "array append");
+
+   sf.setArrayAction (QE::Index);
+   for (int j = 0; j < size; j += 5) {
+      check (pf.toString (array.value (j).toDouble ()),
+             sf.formatString (QVariant (array), j), "array index");
+   }
+}
+
+//------------------------------------------------------------------------------
+// Enumerations: in range values yield the enumeration string, out of range
+// values fall back to the integer formatting.
+//
+static void compareEnumerations (QEStringFormatting& sf, const PreviousFormatting& pf)
+{
+   const QStringList enumerations = QStringList () << "Off" << "On" << "Fault";
+   sf.setDbEnumerations (enumerations);
+   for (int j = -2; j < 6; j++) {
+      const QString expected = (j >= 0 && j < enumerations.count ())
+                               ? enumerations.value (j) : pf.toString (long (j));
+      check (expected, sf.formatString (QVariant (j), 0), "enumeration");
+   }
+   sf.setDbEnumerations (QStringList ());
+}
+
+//------------------------------------------------------------------------------
+//
+int main (int argc, char* argv [])
+{
+   const int number = (argc >= 2) ? atoi (argv [1]) : 200000;
+   if (number <= 0) {
+      printf ("usage: %s [number_of_values]\n", argv [0]);
+      return 2;
+   }
+
+   TestValues values;
+   makeValues (values, number);
+
+   static const int radixValues [] = { 2, 8, 10, 16, 3, 12 };
+   static const int precisionValues [] = { 0, 1, 3, 6, 12 };
+   static const QE::Notations notationValues [] = { QE::Fixed, QE::Scientific, QE::Automatic };
+   static const QE::Separators separatorValues [] = { QE::NoSeparator, QE::Comma, QE::Underscore, QE::Space };
+   static const int zerosValues [] = { 0, 1, 7 };
+   const unsigned int dbPrecision = 4;
+
+#define NUMBER(array) int (sizeof (array) / sizeof (array [0]))
+
+   // Equivalence - every combination of settings, with a modest number of
+   // values per combination.
+   //
+   const int valuesPerConfig = 60;
+   int configurations = 0;
+
+   QEStringFormatting sf;
+   sf.setDbPrecision (dbPrecision);
+
+   for (int a = 0; a < NUMBER (radixValues); a++)
+   for (int b = 0; b < NUMBER (precisionValues); b++)
+   for (int c = 0; c < NUMBER (notationValues); c++)
+   for (int d = 0; d < NUMBER (separatorValues); d++)
+   for (int e = 0; e < NUMBER (zerosValues); e++)
+   for (int f = 0; f < 8; f++) {
+      sf.setRadix (radixValues [a]);
+      sf.setPrecision (precisionValues [b]);
+      sf.setNotation (notationValues [c]);
+      sf.setSeparator (separatorValues [d]);
+      sf.setLeadingZeros (zerosValues [e]);
+      sf.setForceSign ((f & 1) != 0);
+      sf.setUseRadixPrefix ((f & 2) != 0);
+      sf.setUseDbPrecision ((f & 4) != 0);
+
+      const PreviousFormatting pf (sf, dbPrecision);
+      compareScalars (sf, pf, values, configurations * valuesPerConfig, valuesPerConfig);
+      compareArrays (sf, pf, values);
+      compareEnumerations (sf, pf);
+      configurations++;
+   }
+
+#undef NUMBER
+
+   printf ("configurations: %d, values: %d\n\n", configurations, number);
+
+   // Throughput - a typical configuration, all the values.
+   //
+   QEStringFormatting tf;
+   tf.setRadix (10);
+   tf.setPrecision (4);
+   tf.setNotation (QE::Automatic);
+   tf.setSeparator (QE::Comma);
+   const PreviousFormatting tpf (tf, 0);
+
+   QElapsedTimer timer;
+   int total;
+
+   printf ("type            count  previous(mS)  plan(mS)  speedup\n");
+
+#define TIME_TYPE(name, list)                                                      \
+   {                                                                               \
+      total = 0;                                                                   \
+      timer.start ();                                                              \
+      for (int j = 0; j < values.list.count (); j++) {                            \
+         total += tpf.toString (values.list [j]).length ();                        \
+      }                                                                            \
+      const double ta = elapsedMilliSec (timer);                                   \
+      const int totalA = total;                                                    \
+      total = 0;                                                                   \
+      timer.start ();                                                              \
+      for (int j = 0; j < values.list.count (); j++) {                            \
+         total += tf.toString (values.list [j]).length ();                         \
+      }                                                                            \
+      const double tb = elapsedMilliSec (timer);                                   \
+      if (total != totalA) mismatches++;                                           \
+      printf ("%-13s %7d %12.3f %10.3f %8.2f\n", name, values.list.count (),      \
+              ta, tb, tb > 0.0 ? ta / tb : 0.0);                                   \
+   }
+
+   TIME_TYPE ("double", doubles);
+   TIME_TYPE ("long", longs);
+   TIME_TYPE ("unsigned long", ulongs);
+
+#undef TIME_TYPE
+
+   printf ("\n%s\n", mismatches == 0 ? "all results identical" : "RESULTS DIFFER");
+   return mismatches == 0 ? 0 : 1;
+}
+
+// end
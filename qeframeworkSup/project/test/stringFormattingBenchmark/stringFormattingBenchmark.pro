@@ -0,0 +1,48 @@
+# File: qeframeworkSup/project/test/stringFormattingBenchmark/stringFormattingBenchmark.pro
+#
+# Copyright (c) 2026 Australian Synchrotron
+#
+# This file is part of the EPICS QT Framework, initially developed at the Australian Synchrotron.
+# The EPICS QT Framework is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+# The EPICS QT Framework is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+# You should have received a copy of the GNU Lesser General Public License
+# along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Author: Andrew Starritt
+# Contact details: andrew.starritt@synchrotron.org.au
+#
+
+# Standalone benchmark for the QEStringFormatting numeric format plan. This is
+# not part of the regular build. QEStringFormatting depends on much of the
+# framework, so unlike the other benchmarks this links against the framework
+# library, located using QE_FRAMEWORK as per the plugin. To build and run:
+#
+#    qmake && make && ./stringFormattingBenchmark [number_of_values]
+#
+# Each value is formatted using the framework and using the previous (pre
+# format plan) implementation, and the results compared character for
+# character. The exit status is non zero if any results differ.
+#
+
+TEMPLATE = app
+TARGET = stringFormattingBenchmark
+CONFIG += console release
+CONFIG -= app_bundle
+QT = core
+
+INCLUDEPATH += ../../data
+INCLUDEPATH += ../../common
+INCLUDEPATH += ../../widgets/QEWidget
+
+SOURCES += stringFormattingBenchmark.cpp
+
+LIBS += -L$$(QE_FRAMEWORK)/lib/$$(EPICS_HOST_ARCH) -lQEFramework
+unix: QMAKE_LFLAGS += -Wl,-rpath,$$(QE_FRAMEWORK)/lib/$$(EPICS_HOST_ARCH)
+
+# end
@@ -0,0 +1,228 @@
+/*  timeStampBenchmark.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron.
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Starritt
+ *  Contact details:
+ *    andrew.starritt@synchrotron.org.au
+ */
+
+// Standalone benchmark for QCaTimeStamp. A series of increasing time stamps,
+// as per a data point list, is generated. The binary search used by
+// QCaDataPointList::indexBeforeTime and the time differences used by
+// resample, statistics and plotting are then performed using QCaTimeStamp
+// and using QCaDateTime (the QDateTime based type previously held by
+// QCaDataPoint). The results must be identical; the times give the benefit.
+//
+// Time stamps are whole milli seconds, as QDateTime comparisons and
+// QCaDateTime::secondsTo only have milli second resolution.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QCaTimeStamp.h>
+#include <QCaDateTime.h>
+
+//------------------------------------------------------------------------------
+// Simple, repeatable pseudo random number generator.
+//
+static unsigned int nextRandom (unsigned int& seed)
+{
+   seed = seed * 1103515245u + 12345u;
+   return (seed >> 8) & 0xFFFFFF;
+}
+
+//------------------------------------------------------------------------------
+//
+static double elapsedMilliSec (const QElapsedTimer& timer)
+{
+   return double (timer.nsecsElapsed ()) / 1.0e6;
+}
+
+//------------------------------------------------------------------------------
+// As per QCaDataPointList::indexBeforeTime - templated on the time type.
+//
+template <typename TimeType>
+static int indexBeforeTime (const QVector<TimeType>& times, const TimeType& searchTime)
+{
+   const int number = times.count ();
+   if (number <= 0) return -1;
+
+   const TimeType* points = times.constData ();
+   if (points [0] > searchTime) return -1;
+
+   int first = 0;
+   int last = number - 1;
+   if (points [last] <= searchTime) return last;
+
+   while (last - first > 1) {
+      const int midway = (first + last) / 2;
+      if (points [midway] <= searchTime) {
+         first = midway;
+      } else {
+         last = midway;
+      }
+   }
+   return first;
+}
+
+//------------------------------------------------------------------------------
+// Searches for each of the search times; returns the sum of the indices found.
+//
+template <typename TimeType>
+static qint64 searchAll (const QVector<TimeType>& times,
+                         const QVector<TimeType>& searchTimes)
+{
+   qint64 result = 0;
+   for (int j = 0; j < searchTimes.count (); j++) {
+      result += indexBeforeTime (times, searchTimes [j]);
+   }
+   return result;
+}
+
+//------------------------------------------------------------------------------
+// Sums the differences between successive times, relative to the first time.
+//
+static double differences (const QVector<QCaTimeStamp>& times)
+{
+   double result = 0.0;
+   for (int j = 1; j < times.count (); j++) {
+      result += times [j - 1].secondsTo (times [j]);
+      result += times [0].secondsTo (times [j]);
+   }
+   return result;
+}
+
+static double differences (const QVector<QCaDateTime>& times)
+{
+   double result = 0.0;
+   for (int j = 1; j < times.count (); j++) {
+      result += times [j - 1].secondsTo (times [j]);
+      result += times [0].secondsTo (times [j]);
+   }
+   return result;
+}
+
+//------------------------------------------------------------------------------
+//
+static bool report (const char* what, const int count,
+                    const double dateTimeTime, const double timeStampTime,
+                    const bool same)
+{
+   printf ("%-12s %10d %12.3f %12.3f %8.1f  %8.1f  %s\n", what, count,
+           dateTimeTime, timeStampTime,
+           timeStampTime > 0.0 ? dateTimeTime / timeStampTime : 0.0,
+           timeStampTime > 0.0 ? double (count) / timeStampTime / 1.0e3 : 0.0,
+           same ? "ok" : "MISMATCH");
+   return same;
+}
+
+//------------------------------------------------------------------------------
+//
+int main (int argc, char* argv [])
+{
+   const int number = (argc >= 2) ? atoi (argv [1]) : 1000000;
+   if (number <= 1) {
+      printf ("usage: %s [number_of_points]\n", argv [0]);
+      return 2;
+   }
+
+   QElapsedTimer timer;
+
+   // Irregularly spaced, increasing, times starting mid 2026 with up to 2 seconds
+   // between points, including some duplicate times.
+   //
+   unsigned int seed = 20260101;
+   QVector<QCaTimeStamp> stamps;
+   QVector<QCaDateTime> dateTimes;
+   stamps.reserve (number);
+   dateTimes.reserve (number);
+
+   qint64 mSecs = qint64 (1150000000) * 1000;
+   for (int j = 0; j < number; j++) {
+      mSecs += nextRandom (seed) % 2000;
+      const QCaTimeStamp stamp = QCaTimeStamp::fromNanoSecs (mSecs * 1000000);
+      stamps.append (stamp);
+      dateTimes.append (QCaDateTime (stamp));
+   }
+
+   // Search times span the data, with a margin either side.
+   //
+   const int numberSearches = number;
+   const qint64 firstNanoSecs = stamps.first ().toNanoSecs ();
+   const qint64 spanMSecs = (stamps.last ().toNanoSecs () - firstNanoSecs) / 1000000;
+   QVector<QCaTimeStamp> searchStamps;
+   QVector<QCaDateTime> searchDateTimes;
+   searchStamps.reserve (numberSearches);
+   searchDateTimes.reserve (numberSearches);
+   for (int j = 0; j < numberSearches; j++) {
+      const qint64 offset = qint64 (nextRandom (seed)) * (spanMSecs + 20000) / 0xFFFFFF - 10000;
+      const QCaTimeStamp stamp = QCaTimeStamp::fromNanoSecs (firstNanoSecs + offset * 1000000);
+      searchStamps.append (stamp);
+      searchDateTimes.append (QCaDateTime (stamp));
+   }
+
+   printf ("points: %d, searches: %d\n\n", number, numberSearches);
+   printf ("operation         count   QDateTime(mS) TimeStamp(mS) speedup  Mops/S\n");
+
+   bool allOkay = true;
+
+   // Binary search, as per indexBeforeTime.
+   //
+   timer.start ();
+   const qint64 a = searchAll (dateTimes, searchDateTimes);
+   const double ta = elapsedMilliSec (timer);
+
+   timer.start ();
+   const qint64 b = searchAll (stamps, searchStamps);
+   const double tb = elapsedMilliSec (timer);
+
+   allOkay &= report ("search", numberSearches, ta, tb, a == b);
+
+   // Time differences, as per resample, statistics and the plot time axes.
+   //
+   timer.start ();
+   const double c = differences (dateTimes);
+   const double tc = elapsedMilliSec (timer);
+
+   timer.start ();
+   const double d = differences (stamps);
+   const double td = elapsedMilliSec (timer);
+
+   allOkay &= report ("difference", 2 * (number - 1), tc, td, c == d);
+
+   // Sanity check: the two sets of times represent the same instants.
+   //
+   int mismatches = 0;
+   for (int j = 0; j < number; j++) {
+      if (dateTimes [j].toTimeStamp () != stamps [j]) mismatches++;
+   }
+   if (mismatches > 0) {
+      printf ("%d time conversion mismatches\n", mismatches);
+      allOkay = false;
+   }
+
+   printf ("\n%s\n", allOkay ? "all results identical" : "RESULTS DIFFER");
+   return allOkay ? 0 : 1;
+}
+
+// end
@@ -0,0 +1,49 @@
+# File: qeframeworkSup/project/test/timeStampBenchmark/timeStampBenchmark.pro
+#
+# Copyright (c) 2026 Australian Synchrotron
+#
+# This file is part of the EPICS QT Framework, initially developed at the Australian Synchrotron.
+# The EPICS QT Framework is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+# The EPICS QT Framework is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+# You should have received a copy of the GNU Lesser General Public License
+# along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Author: Andrew Starritt
+# Contact details: andrew.starritt@synchrotron.org.au
+#
+
+# Standalone benchmark for QCaTimeStamp. This is not part of the regular
+# build, and needs only QtCore (not EPICS). To build and run:
+#
+#    qmake && make && ./timeStampBenchmark [number_of_points]
+#
+# The comparison (binary search) and difference operations used by the data
+# point lists are run using QCaTimeStamp and using the QDateTime based
+# QCaDateTime previously held by QCaDataPoint, and the results compared.
+# The exit status is non zero if any results differ.
+#
+
+TEMPLATE = app
+TARGET = timeStampBenchmark
+CONFIG += console release
+CONFIG -= app_bundle
+QT = core
+
+# Build the framework source directly rather than link against the library.
+#
+DEFINES += QE_FRAMEWORK_LIBRARY
+
+INCLUDEPATH += ../../data
+INCLUDEPATH += ../../widgets/QEWidget
+
+SOURCES += timeStampBenchmark.cpp
+SOURCES += ../../data/QCaTimeStamp.cpp
+SOURCES += ../../data/QCaDateTime.cpp
+
+# end
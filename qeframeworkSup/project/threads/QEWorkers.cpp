@@ -24,7 +24,10 @@
  */
 
 #include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QThread>
+#include <QWaitCondition>
 
 #include <QEWorkers.h>
 
@@ -130,6 +133,8 @@ class WorkerManager::ReallyPrivate {
 public:
    WorkerThread* threadList [MAXIMUM_THREADS];
    bool workerComplete [MAXIMUM_THREADS];
+   QMutex mutex;                  // guards workerComplete
+   QWaitCondition allComplete;
 };
 
 
@@ -146,6 +151,8 @@ WorkerManager::WorkerManager (const WorkerList& workForce, QObject *parent) : QO
 
 
    this->pd = new ReallyPrivate ();
+   this->sequenceNumber = 0;
+   this->workPackage = NULL;
 
    this->number =  workForce.count ();
    if (this->number > MAXIMUM_THREADS) {
@@ -154,9 +161,10 @@ WorkerManager::WorkerManager (const WorkerList& workForce, QObject *parent) : QO
 
    for (j = 0; j < this->number; j++) {
       Worker* worker = workForce.value (j);
-      WorkerThread* thread = new WorkerThread (worker, j, this->number, parent);
+      WorkerThread* thread = new WorkerThread (worker, j, this->number, this);
 
       this->pd->threadList [j] = thread;
+      this->pd->workerComplete [j] = true;
 
       QObject::connect (thread, SIGNAL (started ()), worker, SLOT (started ()));
 
@@ -164,7 +172,8 @@ WorkerManager::WorkerManager (const WorkerList& workForce, QObject *parent) : QO
                         worker, SLOT   (startProcessing (const QE::SequenceNumbers, QObject*)));
 
       QObject::connect (worker, SIGNAL (processingComplete (const QE::SequenceNumbers, QE::Counts)),
-                        this,   SLOT   (processingComplete (const QE::SequenceNumbers, QE::Counts)));
+                        this,   SLOT   (processingComplete (const QE::SequenceNumbers, QE::Counts)),
+                        Qt::DirectConnection);
    }
 
    for (j = 0; j < this->number; j++) {
@@ -177,7 +186,15 @@ WorkerManager::WorkerManager (const WorkerList& workForce, QObject *parent) : QO
 //
 WorkerManager::~WorkerManager ()
 {
-   // place holder
+   // The threads are our children, but must be stopped before they are deleted.
+   //
+   for (Counts j = 0; j < this->number; j++) {
+      WorkerThread* thread = this->pd->threadList [j];
+      thread->quit ();
+      thread->wait ();
+   }
+
+   delete this->pd;
 }
 
 //------------------------------------------------------------------------------
@@ -185,15 +202,47 @@ WorkerManager::~WorkerManager ()
 void WorkerManager::process (QObject* workPackageIn)
 {
    Counts j;
+   SequenceNumbers sequence;
+
+   {
+      QMutexLocker locker (&this->pd->mutex);
+
+      this->workPackage = workPackageIn;
+
+      this->sequenceNumber++;
+      for (j = 0; j < this->number; j++) {
+         this->pd->workerComplete [j] = false;
+      }
+      sequence = this->sequenceNumber;
+   }
+
+   emit this->startProcessing (sequence, workPackageIn);
+}
+
+//------------------------------------------------------------------------------
+//
+void WorkerManager::processAndWait (QObject* workPackageIn)
+{
+   // Lock before we start to ensure we cannot miss the wake up.
+   //
+   QMutexLocker locker (&this->pd->mutex);
 
    this->workPackage = workPackageIn;
 
    this->sequenceNumber++;
-   for (j = 0; j < this->number; j++) {
+   for (Counts j = 0; j < this->number; j++) {
       this->pd->workerComplete [j] = false;
    }
 
-   emit this->startProcessing (this->sequenceNumber, this->workPackage);
+   // The workers' startProcessing slots are queued connections. The workers
+   // may start and even finish processing before we wait, but they cannot
+   // record completion until the wait releases the mutex.
+   //
+   emit this->startProcessing (this->sequenceNumber, workPackageIn);
+
+   while (!this->isComplete ()) {
+      this->pd->allComplete.wait (&this->pd->mutex);
+   }
 }
 
 //------------------------------------------------------------------------------
@@ -201,12 +250,17 @@ void WorkerManager::process (QObject* workPackageIn)
 void WorkerManager::processingComplete (const QE::SequenceNumbers workerSequenceNumber,
                                         const QE::Counts instance)
 {
+   QMutexLocker locker (&this->pd->mutex);
+
    if (workerSequenceNumber == this->sequenceNumber) {
       this->pd->workerComplete[instance] = true;
       // All done??
       //
       if (this->isComplete ()) {
-         emit this->complete (this->workPackage);
+         QObject* completedPackage = this->workPackage;
+         this->pd->allComplete.wakeAll ();
+         locker.unlock ();
+         emit this->complete (completedPackage);
       }
    } else {
       DEBUG << "sequenceNumber mismatch, "
@@ -219,6 +273,7 @@ void WorkerManager::processingComplete (const QE::SequenceNumbers workerSequence
 }
 
 //------------------------------------------------------------------------------
+// Caller must hold the mutex.
 //
 bool WorkerManager::isComplete ()
 {
@@ -33,10 +33,11 @@
 #include <QThread>
 
 /*!
- * Proof of concept class - NOT currently in use.
- *
  * When manager's process function called, each worker class object process
  * function is called (in a separate thread).
+ *
+ * Used by the QEImage image processor to convert bands of image rows in
+ * parallel.
  */
 
 #define MAXIMUM_THREADS   16
@@ -120,6 +121,13 @@ public:
 
    void process (QObject* workPackage);
 
+   // As process, but blocks the calling thread until all the workers have
+   // completed. This does not require an event loop in the calling thread,
+   // and hence may be called from within a QThread's run function.
+   // The complete signal is still emitted.
+   //
+   void processAndWait (QObject* workPackage);
+
    Counts getNumber () { return number; }
 
 signals:
@@ -148,7 +156,8 @@ signals:
                          QObject* workPackage);
 
 private slots:
-   // From the work force.
+   // From the work force - this is a direct connection, and hence is
+   // called in the context of each worker thread.
    //
    void processingComplete (const QE::SequenceNumbers sequenceNumber,
                             const QE::Counts instance);
@@ -1421,7 +1421,7 @@ void QECorrelation::setArchiveData (const QObject* userData, const bool isOkay,
    // Resample data into appropriate chunks.
    //
    QCaDataPointList resampledSource;
-   resampledSource.resample (archiveData, samplePeriod, endTime);
+   resampledSource.resample (archiveData, samplePeriod, QCaDateTime (endTime));
 
    const int n = MIN (resampledSource.count (), numberOfCorrelationPoints);
 
@@ -844,7 +844,7 @@ void QEDistribution::connectionChanged (QCaConnectionInfo& connectionInfo,
       // create a dummy point with last value and time now.
       //
       QCaDataPoint point = this->pvData.last ();
-      point.datetime = QDateTime::currentDateTime ().toUTC ();
+      point.datetime = QCaTimeStamp::currentTime ();
       this->pvData.append (point);
 
       // create a dummy point with same time but marked invalid to indicate a break.
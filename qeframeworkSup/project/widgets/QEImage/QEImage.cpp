@@ -37,6 +37,7 @@
 
 #include <QEImage.h>
 #include <QDebug>
+#include <math.h>
 #include <QIcon>
 #include <QPushButton>
 #include <QFileDialog>
@@ -152,6 +153,8 @@ void QEImage::setup()
     haveSelectedArea3 = false;
     haveSelectedArea4 = false;
 
+    haveImageAnalysis = false;
+
     enableProfilePresentation = true;
     enableHozSlicePresentation = true;
     enableVertSlicePresentation = true;
@@ -229,6 +232,16 @@ void QEImage::setup()
                       this,        SLOT  ( pan( QPoint ) ) );
     QObject::connect( videoWidget, SIGNAL( redraw() ),
                       this,        SLOT  ( redraw() ) );
+    QObject::connect( videoWidget, SIGNAL( imagePainted( qint64 ) ),
+                      this,        SLOT  ( imagePainted( qint64 ) ) );
+    QObject::connect( videoWidget, SIGNAL( imageRegionRequired() ),
+                      this,        SLOT  ( imageRegionRequired() ) );
+
+    // Create a timer to update the image pipeline information while displayed
+    pipelineInfoTimer = new QTimer( this );
+    pipelineInfoTimer->setInterval( 1000 );
+    QObject::connect( pipelineInfoTimer, SIGNAL( timeout() ),
+                      this,              SLOT  ( updatePipelineInfo() ) );
 
 
     // Create zoom sub menu
@@ -270,6 +283,7 @@ void QEImage::setup()
     recorder = new recording( this );
     QObject::connect(recorder, SIGNAL(destroyed(QObject*)), this, SLOT(recorderDestroyed(QObject*)));
     QObject::connect(recorder, SIGNAL(playingBack(bool)), this, SLOT(playingBack(bool)));
+    QObject::connect(recorder, SIGNAL(recordingFailed(QString)), this, SLOT(recordingFailed(QString)));
     QObject::connect( recorder,  SIGNAL( byteArrayChanged( const QByteArray&, unsigned long, QCaAlarmInfo&, QCaDateTime&, const unsigned int& ) ),
                       this, SLOT( setImage( const QByteArray&, unsigned long, QCaAlarmInfo&, QCaDateTime&, const unsigned int& ) ) );
 
@@ -414,6 +428,8 @@ void QEImage::setup()
 
     // Connect to the image process to be able to receive images as they are built from image data
     QObject::connect( &iProcessor, SIGNAL( imageBuilt( QImage, QString ) ), this, SLOT( displayBuiltImage( QImage, QString ) ) );
+    QObject::connect( &iProcessor, SIGNAL( imageDecompressed( QByteArray, unsigned int ) ), this, SLOT( useDecompressedImage( QByteArray, unsigned int ) ) );
+    QObject::connect( &iProcessor, SIGNAL( imageAnalysed( imageAnalysisResults ) ), this, SLOT( useImageAnalysis( imageAnalysisResults ) ) );
 
     // !! move this functionality into QEWidget???
     // !! needs one for single variables and one for multiple variables, or just the multiple variable one for all
@@ -705,6 +721,10 @@ void QEImage::establishConnection( unsigned int variableIndex ) {
     {
         // Connect the image waveform record to the display image
         case IMAGE_VARIABLE:
+            // Let the image processor know the image source so it can share decompressed
+            // images with any other image processors displaying the same image source
+            iProcessor.setImageSource( qca ? getSubstitutedVariableName( IMAGE_VARIABLE ) : QString() );
+
             if( qca )
             {
                 QObject::connect( qca,  SIGNAL( byteArrayChanged( const QByteArray&, unsigned long, QCaAlarmInfo&, QCaDateTime&, const unsigned int& ) ),
@@ -1660,6 +1680,13 @@ void QEImage::useAllMarkupData()
     useEllipseData();
 }
 
+//====================================================
+// Slot from recorder control to indicate recording has stopped as images could not be saved.
+void QEImage::recordingFailed( QString error )
+{
+    sendMessage( error, "QEImage", message_types( MESSAGE_TYPE_ERROR ) );
+}
+
 //====================================================
 // Slot from recorder control to indicate playback has started or stopped.
 // When playing back, live sources should be stopped.
@@ -1742,9 +1769,16 @@ void QEImage::setPvaImage( const QVariant& value,
     }
 
     // Decompress if needs be.
+    // Decompression is normally left to the image processing thread, as decompressing large
+    // images can take some time. When recording, however, every image must be recorded, so
+    // decompress here.
     //
-    // bool status =
-    imageData.decompressData ();
+    const bool decompressLater = imageData.isCompressed() && !( recorder && recorder->isRecording() );
+    if( !decompressLater )
+    {
+        // bool status =
+        imageData.decompressData ();
+    }
 
     // set the format
     setFormatOption( imageData.getFormat() );
@@ -1762,12 +1796,30 @@ void QEImage::setPvaImage( const QVariant& value,
     setImageSize();
 
     // Call the standard CA set image
-    setImage( imageData.getData(), imageData.getBytesPerPixel(),
-              alarmInfo, timeStamp, variableIndex );
+    if( decompressLater )
+    {
+        newImage( QByteArray(), &imageData, imageData.getBytesPerPixel(),
+                  alarmInfo, timeStamp, variableIndex );
+    }
+    else
+    {
+        setImage( imageData.getData(), imageData.getBytesPerPixel(),
+                  alarmInfo, timeStamp, variableIndex );
+    }
 
     this->updateToolTipAlarm (alarmInfo, variableIndex);
 }
 
+/* -----------------------------------------------------------------------------
+    Use image data decompressed by the image processing thread.
+    The image itself will follow shortly, this is just the image data for analysis.
+ */
+void QEImage::useDecompressedImage( QByteArray imageData, unsigned int imageId )
+{
+    // Ignored if later image data has been received
+    iProcessor.setDecompressedImage( imageData, imageId );
+}
+
 
 /* -----------------------------------------------------------------------------
     Update the image
@@ -1782,6 +1834,19 @@ void QEImage::setImage( const QByteArray& imageIn,
                         QCaAlarmInfo& alarmInfo,
                         QCaDateTime& time,
                         const unsigned int& variableIndex )
+{
+    newImage( imageIn, NULL, dataSize, alarmInfo, time, variableIndex );
+}
+
+// Use new image data.
+// The image data is either in imageIn, or is compressed in compressedImage (if not NULL).
+// Compressed image data is decompressed by the image processing thread.
+void QEImage::newImage( const QByteArray& imageIn,
+                        const QENTNDArrayData* compressedImage,
+                        unsigned long dataSize,
+                        QCaAlarmInfo& alarmInfo,
+                        QCaDateTime& time,
+                        const unsigned int& variableIndex )
 {
     // Do nothing regarding the image until the width and height are available
     if( iProcessor.getImageBuffWidth() == 0 || iProcessor.getImageBuffHeight() == 0 )
@@ -1796,7 +1861,8 @@ void QEImage::setImage( const QByteArray& imageIn,
     }
 
     // If recording, save image
-    if( recorder && recorder->isRecording() )
+    // (compressed images are decompressed before getting here when recording)
+    if( recorder && recorder->isRecording() && !compressedImage )
     {
         recorder->recordImage( imageIn, dataSize, alarmInfo, time );
     }
@@ -1805,7 +1871,14 @@ void QEImage::setImage( const QByteArray& imageIn,
     emit dbValueChanged( "image" );
 
     // Save the image data for analysis and redisplay
-    iProcessor.setImage( imageIn, dataSize );
+    if( compressedImage )
+    {
+        iProcessor.setCompressedImage( *compressedImage, dataSize, time );
+    }
+    else
+    {
+        iProcessor.setImage( imageIn, dataSize );
+    }
 
     // Note the time of this image
     imageTime = time;
@@ -1857,6 +1930,13 @@ void QEImage::displayImage()
         initScrollPosSet = true;
     }
 
+    // Let the image processor know what part of the image is visible.
+    // (When zoomed in it may only need to build the visible region)
+    iProcessor.setDisplayedArea( getVisibleImageArea() );
+
+    // Let the image processor know what analysis is required for the markups in use
+    updateAnalysisRequest();
+
     // Process the image data. Hopefully a presentable QImage will be result.
     iProcessor.buildImage();
 
@@ -1883,15 +1963,126 @@ void QEImage::displayBuiltImage( QImage image, QString messageText )
     }
 
     // Display the new image
-    videoWidget->setNewImage( image, imageTime );
+    // (The image may only be a region of the whole image, positioned by the image offset)
+    videoWidget->setNewImage( image, imageTime, QSize( iProcessor.rotatedImageBuffWidth(), iProcessor.rotatedImageBuffHeight() ) );
 
     // Update markups if required
+    // (using the analysis of this image by the image processing thread if available)
     updateMarkupData();
 
+    // Display the beam statistics if required
+    if( getShowBeamStatistics() && haveImageAnalysis && imageAnalysisData.request.beamStatistics )
+    {
+        infoUpdateBeamStatistics( imageAnalysisData.beam );
+    }
+
+    // The analysis is only for this image. Markups moved from now on must be analysed by the widget.
+    haveImageAnalysis = false;
+
     // Display the image statistics
     imageDisplayProps->showStatistics();
 }
 
+// Save the analysis of an image by the image processing thread.
+// This is delivered immediately before the image built from the same image data (see displayBuiltImage())
+void QEImage::useImageAnalysis( imageAnalysisResults results )
+{
+    imageAnalysisData = results;
+    haveImageAnalysis = true;
+}
+
+// Let the image processor know what analysis is required for the markups in use.
+// The image processing thread will analyse each image built and deliver the results with the image
+// so markups and profiles are updated without reading the image data in this thread.
+void QEImage::updateAnalysisRequest()
+{
+    imageAnalysisRequest request;
+
+    request.beamStatistics = getShowBeamStatistics();
+
+    request.vSlice = haveVSlice1X && vSliceDisplay;
+    request.vSliceX = vSlice1X;
+    request.vSliceThickness = vSlice1Thickness;
+
+    request.hSlice = haveHSlice1Y && hSliceDisplay;
+    request.hSliceY = hSlice1Y;
+    request.hSliceThickness = hSlice1Thickness;
+
+    request.profile = haveProfileLine && profileDisplay;
+    request.profileStart = profileLineStart;
+    request.profileEnd = profileLineEnd;
+    request.profileThickness = profileThickness;
+
+    request.area[0] = haveSelectedArea1;
+    request.areaRect[0] = QRect( selectedArea1Point1, selectedArea1Point2 );
+    request.area[1] = haveSelectedArea2;
+    request.areaRect[1] = QRect( selectedArea2Point1, selectedArea2Point2 );
+    request.area[2] = haveSelectedArea3;
+    request.areaRect[2] = QRect( selectedArea3Point1, selectedArea3Point2 );
+    request.area[3] = haveSelectedArea4;
+    request.areaRect[3] = QRect( selectedArea4Point1, selectedArea4Point2 );
+
+    iProcessor.setAnalysisRequest( request );
+}
+
+// Return the area of the image that is visible (in displayed image orientation, but not scaled).
+// A margin is included around the visible area so a little scrolling does not immediately need
+// more of the image. Returns a null rectangle if the whole image is visible, or the visible area
+// is not known.
+QRect QEImage::getVisibleImageArea()
+{
+    unsigned int w = iProcessor.rotatedImageBuffWidth();
+    unsigned int h = iProcessor.rotatedImageBuffHeight();
+    if( !w || !h || videoWidget->width() <= 0 || videoWidget->height() <= 0 )
+    {
+        return QRect();
+    }
+
+    QRect visible = videoWidget->visibleRegion().boundingRect();
+    if( visible.isEmpty() )
+    {
+        return QRect();
+    }
+
+    // Add a margin of half the visible area on each side
+    visible.adjust( -visible.width()/2, -visible.height()/2, visible.width()/2, visible.height()/2 );
+
+    // Scale to image pixels (rounding outwards) and clip to the image
+    double xScale = (double)w / (double)videoWidget->width();
+    double yScale = (double)h / (double)videoWidget->height();
+    int left   = (int)floor( visible.left() * xScale );
+    int top    = (int)floor( visible.top() * yScale );
+    int right  = (int)ceil( ( visible.right() + 1 ) * xScale );
+    int bottom = (int)ceil( ( visible.bottom() + 1 ) * yScale );
+    QRect area = QRect( QPoint( left, top ), QPoint( right - 1, bottom - 1 ) ) & QRect( 0, 0, w, h );
+
+    if( area.isEmpty() || area == QRect( 0, 0, w, h ) )
+    {
+        return QRect();
+    }
+    return area;
+}
+
+// The video widget needs more of the image than the current image region.
+// (For example, the image has been scrolled) Rebuild the image.
+void QEImage::imageRegionRequired()
+{
+    displayImage();
+}
+
+// A new image has been painted.
+// Note it, and how long it took, in the image pipeline statistics
+void QEImage::imagePainted( qint64 paintNSecs )
+{
+    iProcessor.imagePainted( paintNSecs );
+}
+
+// Update the image pipeline information in the information area
+void QEImage::updatePipelineInfo()
+{
+    infoUpdatePipeline( iProcessor.getPipelineStatistics() );
+}
+
 // Return the size of the widget where the image will be presented
 // It will be presented in the QEImage's main window used for full screen view,
 // or in QEImage's scroll area
@@ -2914,9 +3105,10 @@ QString QEImage::copyVariable()
     return getSubstitutedVariableName(0);
 }
 
+// Copy the whole image, even if only a region is displayed (and built) when zoomed
 QVariant QEImage::copyData()
 {
-    return QVariant( videoWidget->getImage() );
+    return QVariant( iProcessor.copyImage() );
 }
 
 void QEImage::paste( QVariant v )
@@ -3917,6 +4109,75 @@ bool QEImage::getFullContextMenu()
     return fullContextMenu;
 }
 
+// Display image pipeline statistics in the information area
+void QEImage::setDisplayPipelineInfo( bool displayPipelineInfoIn )
+{
+    setShowPipelineInfo( displayPipelineInfoIn );
+    if( displayPipelineInfoIn )
+    {
+        updatePipelineInfo();
+        pipelineInfoTimer->start();
+    }
+    else
+    {
+        pipelineInfoTimer->stop();
+        infoUpdatePipeline();
+    }
+}
+
+bool QEImage::getDisplayPipelineInfo()
+{
+    return getShowPipelineInfo();
+}
+
+// Calculate beam statistics for each image and display them in the information area
+// (Beam statistics are calculated by the image processing thread)
+void QEImage::setDisplayBeamStatistics( bool displayBeamStatisticsIn )
+{
+    setShowBeamStatistics( displayBeamStatisticsIn );
+    if( displayBeamStatisticsIn )
+    {
+        // Present the current image again to calculate its beam statistics
+        displayImage();
+    }
+    else
+    {
+        infoUpdateBeamStatistics();
+    }
+}
+
+bool QEImage::getDisplayBeamStatistics()
+{
+    return getShowBeamStatistics();
+}
+
+// Adapt processing (reduce statistics work, then display every Nth image) when image processing falls behind
+void QEImage::setAdaptiveProcessing( bool adaptiveProcessingIn )
+{
+    iProcessor.setAdaptiveProcessing( adaptiveProcessingIn );
+}
+
+bool QEImage::getAdaptiveProcessing()
+{
+    return iProcessor.getAdaptiveProcessing();
+}
+
+// Return image pipeline statistics
+imagePipelineStatistics QEImage::getPipelineStatistics()
+{
+    return iProcessor.getPipelineStatistics();
+}
+
+// Clear image pipeline statistics
+void QEImage::resetPipelineStatistics()
+{
+    iProcessor.resetPipelineStatistics();
+    if( getShowPipelineInfo() )
+    {
+        updatePipelineInfo();
+    }
+}
+
 // Display all markups for which there is data available.
 void QEImage::setDisplayMarkups( bool displayMarkupsIn )
 {
@@ -4845,25 +5106,32 @@ void QEImage::setLineProfileControlsNotVisible()
 //==================================================
 
 // Display textual info about a selected area
-//!!! No longer needed. change calls to displaySelectedAreaInfo() to calls to infoUpdateRegion() directly
+// If the image processing thread has analysed the current image for this area, include the area statistics.
 void QEImage::displaySelectedAreaInfo( int region, QPoint point1, QPoint point2 )
 {
-    infoUpdateRegion( region, point1.x(), point1.y(), point2.x(), point2.y() );
+    int i = region - 1;
+    if( haveImageAnalysis && i >= 0 && i < ANALYSIS_AREAS &&
+        imageAnalysisData.request.area[i] && imageAnalysisData.request.areaRect[i] == QRect( point1, point2 ) )
+    {
+        infoUpdateRegion( region, point1.x(), point1.y(), point2.x(), point2.y(), imageAnalysisData.areas[i] );
+    }
+    else
+    {
+        infoUpdateRegion( region, point1.x(), point1.y(), point2.x(), point2.y() );
+    }
 }
 
 // Update the brightness and contrast, if in auto, to match the recently selected region
 void QEImage::setRegionAutoBrightnessContrast( QPoint point1, QPoint point2 )
 {
-    // Translate the corners to match the current flip and roate options
-    QRect area = iProcessor.rotateFlipToDataRectangle( point1, point2 );
-
     // Determine the range of pixel values in the selected area
-    unsigned int min, max;
-    iProcessor.getPixelRange( area, &min, &max );
+    // (The area is as displayed. The analyser reads the image data according to the current flip and rotate options)
+    imageAreaStatistics stats;
+    iProcessor.getImageAnalysis().generateAreaStatistics( QRect( point1, point2 ), stats );
 
-    if( imageDisplayProps )
+    if( imageDisplayProps && stats.valid )
     {
-        imageDisplayProps->setBrightnessContrast( max, min );
+        imageDisplayProps->setBrightnessContrast( stats.maxP, stats.minP );
     }
 }
 
@@ -4883,7 +5151,7 @@ void QEImage::imageDisplayPropertiesChanged()
 // A request has been made to set the brightness and contrast to suit the current image
 void QEImage::brightnessContrastAutoImageRequest()
 {
-    setRegionAutoBrightnessContrast( QPoint( 0, 0), QPoint( iProcessor.getImageBuffWidth(), iProcessor.getImageBuffHeight() ) );
+    setRegionAutoBrightnessContrast( QPoint( 0, 0), QPoint( iProcessor.rotatedImageBuffWidth(), iProcessor.rotatedImageBuffHeight() ) );
 }
 
 //=====================================================================
@@ -4909,7 +5177,16 @@ void QEImage::generateVSlice( int x, unsigned int thickness )
     }
 
     // Generate the data through the slice
-    iProcessor.generateVSliceData( vSliceData, x, thickness );
+    // (Use the data generated by the image processing thread if it is for this slice)
+    if( haveImageAnalysis && imageAnalysisData.request.vSlice &&
+        imageAnalysisData.request.vSliceX == x && imageAnalysisData.request.vSliceThickness == thickness )
+    {
+        vSliceData = imageAnalysisData.vSliceData;
+    }
+    else
+    {
+        iProcessor.generateVSliceData( vSliceData, x, thickness );
+    }
 
     // Write the profile data
     QEFloating *qca;
@@ -4962,7 +5239,16 @@ void QEImage::generateHSlice( int y, unsigned int thickness )
     }
 
     // Generate the data through the slice
-    iProcessor.generateHSliceData( hSliceData, y, thickness );
+    // (Use the data generated by the image processing thread if it is for this slice)
+    if( haveImageAnalysis && imageAnalysisData.request.hSlice &&
+        imageAnalysisData.request.hSliceY == y && imageAnalysisData.request.hSliceThickness == thickness )
+    {
+        hSliceData = imageAnalysisData.hSliceData;
+    }
+    else
+    {
+        iProcessor.generateHSliceData( hSliceData, y, thickness );
+    }
 
     // Write the profile data
     QEFloating *qca;
@@ -5077,8 +5363,18 @@ void QEImage::generateProfile( QPoint point1, QPoint point2, unsigned int thickn
         return;
     }
 
-    // Generate the data through the slice
-    iProcessor.generateProfileData( profileData, point1, point2, thickness );
+    // Generate the data through the line
+    // (Use the data generated by the image processing thread if it is for this line)
+    if( haveImageAnalysis && imageAnalysisData.request.profile &&
+        imageAnalysisData.request.profileStart == point1 && imageAnalysisData.request.profileEnd == point2 &&
+        imageAnalysisData.request.profileThickness == thickness )
+    {
+        profileData = imageAnalysisData.profileData;
+    }
+    else
+    {
+        iProcessor.generateProfileData( profileData, point1, point2, thickness );
+    }
 
     // Write the profile data
     QEFloating *qca;
@@ -5670,17 +5966,6 @@ void QEImage::actionRequest( QString action, QStringList /*arguments*/, bool ini
 
 }
 
-// Constructor for class used to hold a record of a single image
-// Used when building a list of recorded images
-historicImage::historicImage( QByteArray imageIn, unsigned long dataSizeIn, QCaAlarmInfo& alarmInfoIn, QCaDateTime& timeIn )
-{
-    image = imageIn;
-
-    dataSize = dataSizeIn;
-    alarmInfo = alarmInfoIn;
-    time = timeIn;
-}
-
 // A configuration is being saved. Return any configuration to be saved for this widget
 void QEImage::saveConfiguration( PersistanceManager* pm )
 {
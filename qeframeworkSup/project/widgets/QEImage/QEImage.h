@@ -35,6 +35,7 @@
 #include <QVBoxLayout>
 #include <QGridLayout>
 #include <QToolBar>
+#include <QTimer>
 #include <zoomMenu.h>
 #include <flipRotateMenu.h>
 #include <selectMenu.h>
@@ -386,6 +387,18 @@ public:
     void setFullContextMenu( bool fullContextMenuIn );                  ///< Access function for #fullContextMenu property - refer to #fullContextMenu property for details
     bool getFullContextMenu();                                          ///< Access function for #fullContextMenu property - refer to #fullContextMenu property for details
 
+    void setDisplayPipelineInfo( bool displayPipelineInfoIn );          ///< Access function for #displayPipelineInfo property - refer to #displayPipelineInfo property for details
+    bool getDisplayPipelineInfo();                                      ///< Access function for #displayPipelineInfo property - refer to #displayPipelineInfo property for details
+
+    void setDisplayBeamStatistics( bool displayBeamStatisticsIn );      ///< Access function for #displayBeamStatistics property - refer to #displayBeamStatistics property for details
+    bool getDisplayBeamStatistics();                                    ///< Access function for #displayBeamStatistics property - refer to #displayBeamStatistics property for details
+
+    void setAdaptiveProcessing( bool adaptiveProcessingIn );            ///< Access function for #adaptiveProcessing property - refer to #adaptiveProcessing property for details
+    bool getAdaptiveProcessing();                                       ///< Access function for #adaptiveProcessing property - refer to #adaptiveProcessing property for details
+
+    imagePipelineStatistics getPipelineStatistics();                    ///< Return image pipeline statistics (images received, built, dropped and displayed, and the time taken by each stage)
+    void resetPipelineStatistics();                                     ///< Clear image pipeline statistics
+
     void setEnableProfilePresentation( bool enableProfilePresentationIn );     ///< Access function for #enableProfilePresentation property - refer to #enableProfilePresentation property for details
     bool getEnableProfilePresentation();                                       ///< Access function for #enableProfilePresentation property - refer to #enableProfilePresentation property for details
 
@@ -686,8 +699,14 @@ private slots:
     void resizeFullScreen();        // Resize full screen once it has been managed
 
     void playingBack( bool playing );
+    void recordingFailed( QString error );
 
     void displayBuiltImage( QImage image, QString error );
+    void useDecompressedImage( QByteArray imageData, unsigned int imageId );
+    void imagePainted( qint64 paintNSecs );
+    void imageRegionRequired();
+    void useImageAnalysis( imageAnalysisResults results );
+    void updatePipelineInfo();
 
 public slots:
     void setImageFile( QString name );
@@ -805,6 +824,9 @@ private:
     bool imageSizeSet;      // Flag the video widget size has been set (setImageSize() has been called and done something)
     void setImageSize();    // Set the video widget size so it will match the processed image.
 
+    void newImage( const QByteArray& imageIn, const QENTNDArrayData* compressedImage, unsigned long dataSize,
+                   QCaAlarmInfo& alarmInfo, QCaDateTime& time, const unsigned int& variableIndex ); // Use new image data (common to all image sources)
+
     QGridLayout* mainLayout;
     QGridLayout* graphicsLayout;
 
@@ -861,6 +883,8 @@ private:
 
     QEImageOptionsDialog* optionsDialog;
 
+    QTimer* pipelineInfoTimer;      // Updates the image pipeline information while displayed
+
     // Presentation
     bool paused;
 
@@ -934,6 +958,9 @@ private:
     bool haveSelectedArea3;
     bool haveSelectedArea4;
 
+    imageAnalysisResults imageAnalysisData; // Analysis of the image being displayed (from the image processing thread)
+    bool haveImageAnalysis;                 // imageAnalysisData is for the image being displayed
+    void updateAnalysisRequest();           // Let the image processor know what analysis is required for the markups in use
 
     // Private methods
     void generateVSlice( int x, unsigned int thickness );                           // Generate a profile along a line down an image at a given X position
@@ -945,6 +972,7 @@ private:
 
     imageProcessor iProcessor;                              // Image processor. Generates images for presentation from raw image data and formatting information such as brightness, contrast, flip, rotate, canvas size, etc
     void displayImage();                                    // Display a new image.
+    QRect getVisibleImageArea();                            // Return the area of the image that is visible (null if all of it)
 
     void zoomToArea();                                      // Zoom to the area selected on the image
     void setResizeOptionAndZoom( int zoomIn );              // Set the zoom percentage (and force zoom mode)
@@ -1976,6 +2004,20 @@ public:
     ///
     Q_PROPERTY(bool briefInfoArea READ getBriefInfoArea WRITE setBriefInfoArea)
 
+    /// If true, the information area includes image pipeline statistics: the number of images received, built, dropped and displayed,
+    /// and the time taken to decompress, convert, gather statistics for, and paint each image.
+    /// Image pipeline statistics are not included in a brief information area.
+    Q_PROPERTY(bool displayPipelineInfo READ getDisplayPipelineInfo WRITE setDisplayPipelineInfo)
+
+    /// If true, when image processing falls behind the rate images arrive, the work to gather statistics for each image is reduced,
+    /// and if still behind, only every Nth image is displayed.
+    /// If false, every image is processed (images are still dropped if a later image arrives before an image has been processed).
+    Q_PROPERTY(bool adaptiveProcessing READ getAdaptiveProcessing WRITE setAdaptiveProcessing)
+
+    /// If true, beam statistics (centroid, RMS size, FWHM and peak) are calculated for each image and included in the information area.
+    /// Beam statistics are not included in a brief information area.
+    Q_PROPERTY(bool displayBeamStatistics READ getDisplayBeamStatistics WRITE setDisplayBeamStatistics)
+
     /// If true, all markups for which there is data available will be displayed.
     /// If false, markups will only be displayed when a user interacts with the image.
     /// For example, if true and target variables are defined a target position markup will be displayed as soon as target position data is read.
@@ -72,10 +72,15 @@ HEADERS += \
     widgets/QEImage/imageDataFormats.h \
     widgets/QEImage/markupDisplayMenu.h \
     widgets/QEImage/recording.h \
+    widgets/QEImage/recordingStore.h \
+    widgets/QEImage/decodedImageCache.h \
+    widgets/QEImage/imageBandPool.h \
+    widgets/QEImage/imageAnalysis.h \
     widgets/QEImage/screenSelectDialog.h \
     widgets/QEImage/colourConversion.h \
     widgets/QEImage/imageProcessor.h \
     widgets/QEImage/imageProperties.h \
+    widgets/QEImage/imageConversionKernels.h \
     widgets/QEImage/imageMarkupLegendSetText.h \
     widgets/QEImage/mpeg.h
 
@@ -106,9 +111,14 @@ SOURCES += \
     widgets/QEImage/imageDataFormats.cpp \
     widgets/QEImage/markupDisplayMenu.cpp \
     widgets/QEImage/recording.cpp \
+    widgets/QEImage/recordingStore.cpp \
+    widgets/QEImage/decodedImageCache.cpp \
+    widgets/QEImage/imageBandPool.cpp \
+    widgets/QEImage/imageAnalysis.cpp \
     widgets/QEImage/screenSelectDialog.cpp \
     widgets/QEImage/imageProcessor.cpp \
     widgets/QEImage/imageProperties.cpp \
+    widgets/QEImage/imageConversionKernels.cpp \
     widgets/QEImage/imageMarkupLegendSetText.cpp  \
     widgets/QEImage/mpeg.cpp
 
@@ -59,6 +59,7 @@
 imageDisplayProperties::imageDisplayProperties()
 {
    statisticsSet = false;
+   statisticsPending = false;
 
    nonInteractive = false;
 
@@ -785,6 +786,7 @@ void imageDisplayProperties::setStatistics( unsigned int minPIn,
       bins[i] = binsIn[i];
    }
    pixelLookup = pixelLookupIn;
+   statisticsPending = true;
 }
 
 //------------------------------------------------------------------------------
@@ -794,6 +796,14 @@ void imageDisplayProperties::setStatistics( unsigned int minPIn,
 // is called from the image processing thread.
 void imageDisplayProperties::showStatistics()
 {
+   // Do nothing if the statistics have not changed since last shown.
+   // (statistics may not be set for every image - refer to imageProcessor adaptive processing)
+   if( !statisticsPending )
+   {
+      return;
+   }
+   statisticsPending = false;
+
    // Recalculate dependand variables
    range = ((unsigned long)(1)<<depth)-1;
 
@@ -199,6 +199,7 @@ public:
    unsigned int depth; // Bit depth
    unsigned int bins[HISTOGRAM_BINS]; // Histogram bins
    bool statisticsSet; // Statistic have been set ( setStatistics() has been called) and things like range are now available
+   bool statisticsPending; // Statistic have been set ( setStatistics() has been called) but not yet shown ( showStatistics() has not been called since)
 
    rgbPixel* pixelLookup; // Pixel lookup table used to present colour scale in histogram
 
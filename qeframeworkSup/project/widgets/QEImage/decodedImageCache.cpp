@@ -0,0 +1,293 @@
+/*  decodedImageCache.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Rhyder
+ *  Contact details:
+ *    andrew.rhyder@synchrotron.org.au
+ */
+
+/*
+ This class shares decompressed image data between image processors displaying the same image source.
+
+ Image processors note the image source they are displaying with addUser() and removeUser().
+ Images are only cached for image sources displayed by more than one image processor, so a
+ lone widget keeps reusing its own decompression buffers.
+
+ An image is identified by its source (the image PV name), its time stamp, its NTNDArray unique ID
+ and its compressed size. (The unique ID distinguishes images from drivers that don't time stamp
+ each image.) Before decompressing an image, an image processing thread claims it:
+    - If the image has already been decompressed the decompressed image data is returned.
+    - If another thread is decompressing the image, the claim waits for it to finish (up to
+      CLAIM_TIMEOUT in total).
+    - Otherwise, the thread must decompress the image and publish() it (or abandon() it if
+      it could not be decompressed).
+
+ Only the most recent images from each source are kept, and the total size of cached
+ image data is limited.
+
+ The following adaptation parameters are used:
+    QE_image_decode_cache   Memory budget (MBytes). Default 128. 0 disables the cache.
+*/
+
+#include "decodedImageCache.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QEAdaptationParameters.h>
+
+#define DEBUG qDebug () << "decodedImageCache" << __LINE__ << __FUNCTION__ << " "
+
+// Number of images kept for each image source.
+// Image processors displaying the same source will normally be building the same or the previous image.
+#define IMAGES_PER_SOURCE 2
+
+// Maximum total time to wait for another thread to decompress an image before decompressing it anyway (mS)
+#define CLAIM_TIMEOUT 1000
+
+#define MBYTES ((qint64)(1024)*1024)
+
+namespace {
+
+// A cached image
+struct cachedImage
+{
+    QString source;         // Image source (image PV name)
+    QCaDateTime time;       // Image time stamp
+    int uniqueId;           // NTNDArray unique ID
+    int compressedSize;     // Size of the compressed image data
+    QByteArray imageData;   // Decompressed image data. Empty while being decompressed
+    bool decoding;          // Image is being decompressed
+
+    bool matches( const QString& sourceIn, const QCaDateTime& timeIn, int uniqueIdIn, int compressedSizeIn ) const
+    {
+        return compressedSize == compressedSizeIn &&
+               uniqueId == uniqueIdIn &&
+               time.getSeconds() == timeIn.getSeconds() &&
+               time.getNanoSeconds() == timeIn.getNanoSeconds() &&
+               source == sourceIn;
+    }
+};
+
+// The cache
+struct cache
+{
+    cache()
+    {
+        QEAdaptationParameters ap( "QE_" );
+        memoryBudget = ap.getInt( "image_decode_cache", 128 ) * MBYTES;
+        memoryUsed = 0;
+    }
+
+    int find( const QString& source, const QCaDateTime& time, int uniqueId, int compressedSize ) const
+    {
+        for( int i = 0; i < images.count(); i++ )
+        {
+            if( images[i].matches( source, time, uniqueId, compressedSize ) )
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    void remove( int index )
+    {
+        memoryUsed -= images[index].imageData.size();
+        images.removeAt( index );
+    }
+
+    // Discard the oldest images from a source beyond those to be kept, and the oldest images
+    // from any source while over the memory budget. Images being decompressed are kept.
+    void trim( const QString& source )
+    {
+        int count = 0;
+        for( int i = images.count()-1; i >= 0; i-- )
+        {
+            if( images[i].source == source && ++count > IMAGES_PER_SOURCE && !images[i].decoding )
+            {
+                remove( i );
+            }
+        }
+
+        for( int i = 0; i < images.count() && memoryUsed > memoryBudget; )
+        {
+            if( images[i].decoding )
+            {
+                i++;
+            }
+            else
+            {
+                remove( i );
+            }
+        }
+    }
+
+    QMutex lock;                    // Protects everything in the cache
+    QWaitCondition decoded;         // Signalled when an image being decompressed is published or abandoned
+    QHash<QString, int> users;      // Number of image processors displaying each image source
+    QList<cachedImage> images;      // Cached images, oldest first
+    qint64 memoryUsed;              // Bytes of decompressed image data cached
+    qint64 memoryBudget;            // Bytes of decompressed image data that may be cached (0 to disable the cache)
+};
+
+static cache* theCache()
+{
+    static cache* instance = new cache();
+    return instance;
+}
+
+} // end anonymous namespace
+
+// Note an image processor is displaying an image source.
+void decodedImageCache::addUser( const QString& source )
+{
+    if( source.isEmpty() )
+    {
+        return;
+    }
+
+    cache* c = theCache();
+    QMutexLocker locker( &c->lock );
+    c->users[source]++;
+}
+
+// Note an image processor is no longer displaying an image source.
+// Once an image source is displayed by only one image processor its images are no longer cached.
+void decodedImageCache::removeUser( const QString& source )
+{
+    if( source.isEmpty() )
+    {
+        return;
+    }
+
+    cache* c = theCache();
+    QMutexLocker locker( &c->lock );
+    int remaining = c->users.value( source ) - 1;
+    if( remaining > 0 )
+    {
+        c->users[source] = remaining;
+    }
+    else
+    {
+        c->users.remove( source );
+    }
+
+    // Discard any cached images no longer shared
+    if( remaining > 1 )
+    {
+        return;
+    }
+    for( int i = c->images.count()-1; i >= 0; i-- )
+    {
+        if( c->images[i].source == source && !c->images[i].decoding )
+        {
+            c->remove( i );
+        }
+    }
+}
+
+// Claim an image before decompressing it.
+// Returns CLAIM_FOUND (with the decompressed image data) if the image is cached, waiting if another thread is
+// currently decompressing it.
+// Returns CLAIM_DECODE if the caller must decompress the image, then publish() or abandon() it.
+// Returns CLAIM_NONE if the caller must decompress the image, but it will not be cached (the image source is
+// not displayed by more than one image processor, or the cache is disabled).
+decodedImageCache::claimResults decodedImageCache::claim( const QString& source, const QCaDateTime& time, int uniqueId, int compressedSize, QByteArray& imageData )
+{
+    cache* c = theCache();
+    QMutexLocker locker( &c->lock );
+
+    if( c->memoryBudget <= 0 || source.isEmpty() || c->users.value( source ) < 2 )
+    {
+        return CLAIM_NONE;
+    }
+
+    // If the image is being decompressed by another thread, wait for it
+    int index = c->find( source, time, uniqueId, compressedSize );
+    // (Other images may be published or abandoned while waiting, so look for the image again each time.
+    // The timeout applies to the total time waited, not to each wait)
+    QElapsedTimer waited;
+    waited.start();
+    while( index >= 0 && c->images[index].decoding )
+    {
+        const qint64 remaining = CLAIM_TIMEOUT - waited.elapsed();
+        if( remaining <= 0 || !c->decoded.wait( &c->lock, (unsigned long)remaining ) )
+        {
+            DEBUG << "Timed out waiting for image from" << source << "to be decompressed";
+            return CLAIM_NONE;
+        }
+        index = c->find( source, time, uniqueId, compressedSize );
+    }
+
+    // If the image is cached, use it
+    if( index >= 0 )
+    {
+        imageData = c->images[index].imageData;
+        return CLAIM_FOUND;
+    }
+
+    // The image is not cached (or was abandoned by another thread). The caller must decompress it.
+    cachedImage image;
+    image.source = source;
+    image.time = time;
+    image.uniqueId = uniqueId;
+    image.compressedSize = compressedSize;
+    image.decoding = true;
+    c->images.append( image );
+    return CLAIM_DECODE;
+}
+
+// Add a claimed image, once decompressed, and let any threads waiting for it know it is available.
+void decodedImageCache::publish( const QString& source, const QCaDateTime& time, int uniqueId, int compressedSize, const QByteArray& imageData )
+{
+    cache* c = theCache();
+    QMutexLocker locker( &c->lock );
+
+    int index = c->find( source, time, uniqueId, compressedSize );
+    if( index >= 0 )
+    {
+        c->images[index].imageData = imageData;
+        c->images[index].decoding = false;
+        c->memoryUsed += imageData.size();
+        c->trim( source );
+    }
+    c->decoded.wakeAll();
+}
+
+// Give up a claimed image as it could not be decompressed.
+// Any threads waiting for it will try to decompress it themselves.
+void decodedImageCache::abandon( const QString& source, const QCaDateTime& time, int uniqueId, int compressedSize )
+{
+    cache* c = theCache();
+    QMutexLocker locker( &c->lock );
+
+    int index = c->find( source, time, uniqueId, compressedSize );
+    if( index >= 0 )
+    {
+        c->images.removeAt( index );
+    }
+    c->decoded.wakeAll();
+}
+
+// end
@@ -0,0 +1,64 @@
+/*  decodedImageCache.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Rhyder
+ *  Contact details:
+ *    andrew.rhyder@synchrotron.org.au
+ */
+
+/*
+ This class is a process wide cache of decompressed image data.
+
+ When several QEImage widgets display the same image PV (for example, an overview
+ form and a detail form) each receives the same compressed image and would otherwise
+ decompress it independently. The image processing thread of the first widget to
+ build an image decompresses it and adds it to the cache. The other widgets use the
+ cached image data (shared, not copied) and only apply their own formatting, region
+ and rotation to it.
+ */
+
+#ifndef QE_DECODED_IMAGE_CACHE_H
+#define QE_DECODED_IMAGE_CACHE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QCaDateTime.h>
+
+// Class used to share decompressed image data between image processors displaying the same image source
+class decodedImageCache
+{
+public:
+    // Result of claiming an image
+    enum claimResults { CLAIM_FOUND,    // The decompressed image data has been returned
+                        CLAIM_DECODE,   // The image must be decompressed by the caller, then publish() or abandon() called
+                        CLAIM_NONE      // The image must be decompressed by the caller and is not cached
+                      };
+
+    static void addUser( const QString& source );       // Note an image processor is displaying an image source
+    static void removeUser( const QString& source );    // Note an image processor is no longer displaying an image source
+
+    // Claim an image, identified by its source, time stamp, NTNDArray unique ID and compressed size.
+    static claimResults claim( const QString& source, const QCaDateTime& time, int uniqueId, int compressedSize, QByteArray& imageData );
+    static void publish( const QString& source, const QCaDateTime& time, int uniqueId, int compressedSize, const QByteArray& imageData ); // Add a claimed image, once decompressed
+    static void abandon( const QString& source, const QCaDateTime& time, int uniqueId, int compressedSize );  // Give up a claimed image (it could not be decompressed)
+};
+
+#endif // QE_DECODED_IMAGE_CACHE_H
@@ -0,0 +1,712 @@
+/*  imageAnalysis.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Rhyder
+ *  Contact details:
+ *    andrew.rhyder@synchrotron.org.au
+ */
+
+/*
+ This module analyses image data. Refer to imageAnalysis.h for details.
+ */
+
+#include "imageAnalysis.h"
+#include <QECommon.h>
+#include <limits.h>
+#include <math.h>
+
+// Set up the loop parameters used to scan the input image data to generate the displayed image.
+//
+// Depending on the flipping and rotating options pixel drawing can start in any of
+// the four corners and start scanning either vertically or horizontally.
+// See imageProcessor::getScanOption() comments for more details on how the rotate and flip
+// options are used to generate one of 8 scan options.
+// The 8 scanning options are shown numbered here:
+//
+//    o----->1         2<-----o
+//    |                       |
+//    |                       |
+//    |                       |
+//    v                       v
+//    5                       6
+//
+//
+//
+//    7                       8
+//    ^                       ^
+//    |                       |
+//    |                       |
+//    |                       |
+//    o----->3         4<-----o
+//
+// Scanning is performed in two nested loops, one for height and one for width.
+// Depending on the scan option, however, the outer may be height or width.
+// The displayed image is generated consecutivly from first pixel to last and read from the
+// input buffer, which is moved to the next pixel by both the inner and outer
+// loops to where ever that next pixel is according to the rotation and flipping.
+// The following defines parameters driving the loops:
+//
+// opt      = scan option
+// outCount = outer loop count (width or height);
+// inCount  = inner loop count (height or width)
+// start    = input buffer start pixel (one of the four corners)
+// outInc   = outer loop increment to input buffer
+// inInc    = inner loop increment to input buffer
+// w        = image width
+// h        = image height
+//
+// opt outCount inCount start    outInc   inInc
+//  1      h       w      0         0       1
+//  2      h       w      w-1       w      -1
+//  3      h       w    w*(h-1)    -2*w     1
+//  4      h       w    (w*h)-1     0      -1
+//  5      w       h      0     -w*(h-1)+1   w
+//  6      w       h      w-1   -w*(h-1)-1   w
+//  7      w       h    w*(h-1)  w*(h-1)+1  -w
+//  8      w       h    (w*h)-1  w*(h-1)-1  -w
+//
+// Each outer loop iteration generates one row of the displayed image, and moves the
+// input buffer index by (inCount*inInc)+outInc, which is constant for each scan option.
+// So displayed pixel (x,y) is at input buffer index start + y*rowStep() + x*inInc.
+imageScan::imageScan( int scanOption, int w, int h )
+{
+    switch( scanOption )
+    {
+        default:  // Sanity check. default to 1
+        case 1: outCount = h; inCount = w; start = 0;       outInc =  0;     inInc =  1; break;
+        case 2: outCount = h; inCount = w; start = w-1;     outInc =  2*w;   inInc = -1; break;
+        case 3: outCount = h; inCount = w; start = w*(h-1); outInc = -2*w;   inInc =  1; break;
+        case 4: outCount = h; inCount = w; start = (w*h)-1; outInc =  0;     inInc = -1; break;
+        case 5: outCount = w; inCount = h; start = 0;       outInc = -w*h+1; inInc =  w; break;
+        case 6: outCount = w; inCount = h; start = w-1;     outInc = -w*h-1; inInc =  w; break;
+        case 7: outCount = w; inCount = h; start = w*(h-1); outInc =  w*h+1; inInc = -w; break;
+        case 8: outCount = w; inCount = h; start = (w*h)-1; outInc =  w*h-1; inInc = -w; break;
+    }
+}
+
+// Construct an empty request (no analysis required)
+imageAnalysisRequest::imageAnalysisRequest()
+{
+    beamStatistics = false;
+
+    vSlice = false;
+    vSliceX = 0;
+    vSliceThickness = 1;
+
+    hSlice = false;
+    hSliceY = 0;
+    hSliceThickness = 1;
+
+    profile = false;
+    profileThickness = 1;
+
+    for( int i = 0; i < ANALYSIS_AREAS; i++ )
+    {
+        area[i] = false;
+    }
+}
+
+// Return true if no analysis is required
+bool imageAnalysisRequest::isEmpty() const
+{
+    if( beamStatistics || vSlice || hSlice || profile )
+    {
+        return false;
+    }
+    for( int i = 0; i < ANALYSIS_AREAS; i++ )
+    {
+        if( area[i] )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Construct empty results
+imageAnalysisResults::imageAnalysisResults()
+{
+    beam.valid = false;
+    for( int i = 0; i < ANALYSIS_AREAS; i++ )
+    {
+        areas[i].valid = false;
+    }
+}
+
+// Set up to analyse image data.
+// The image data is scanned according to the scan option so all analysis is in displayed image coordinates.
+imageAnalysis::imageAnalysis( const QByteArray& imageData,
+                              unsigned long imageBuffWidth,
+                              unsigned long imageBuffHeight,
+                              int scanOption,
+                              unsigned long bytesPerPixelIn,
+                              QE::ImageFormatOptions formatOptionIn,
+                              unsigned int bitDepthIn,
+                              unsigned long imageDataSizeIn )
+{
+    imageScan scan( scanOption, imageBuffWidth, imageBuffHeight );
+    width = scan.inCount;
+    height = scan.outCount;
+    start = scan.start;
+    rowStep = scan.rowStep();
+    inInc = scan.inInc;
+
+    bytesPerPixel = bytesPerPixelIn;
+    formatOption = formatOptionIn;
+    bitDepth = bitDepthIn;
+    imageDataSize = imageDataSizeIn;
+
+    // Only read the image data if there is enough for the image dimensions
+    const unsigned long requiredSize = imageBuffWidth * imageBuffHeight * bytesPerPixel;
+    if( requiredSize && (unsigned long)imageData.size() >= requiredSize )
+    {
+        data = (const unsigned char*)imageData.constData();
+    }
+    else
+    {
+        data = NULL;
+    }
+}
+
+// Perform all requested analysis
+void imageAnalysis::analyse( const imageAnalysisRequest& request, imageAnalysisResults& results )
+{
+    results.request = request;
+
+    if( request.beamStatistics )
+    {
+        generateBeamStatistics( results.beam );
+    }
+    if( request.vSlice )
+    {
+        generateVSliceData( results.vSliceData, request.vSliceX, request.vSliceThickness );
+    }
+    if( request.hSlice )
+    {
+        generateHSliceData( results.hSliceData, request.hSliceY, request.hSliceThickness );
+    }
+    if( request.profile )
+    {
+        generateProfileData( results.profileData, request.profileStart, request.profileEnd, request.profileThickness );
+    }
+    for( int i = 0; i < ANALYSIS_AREAS; i++ )
+    {
+        if( request.area[i] )
+        {
+            generateAreaStatistics( request.areaRect[i], results.areas[i] );
+        }
+    }
+}
+
+// Calculate beam statistics in a single pass through the image.
+// The moments are accumulated over the raw pixel values, then corrected to be above the minimum
+// pixel value (the background) which is only known once the pass is complete. The horizontal and
+// vertical projections are accumulated at the same time for determining the FWHM.
+void imageAnalysis::generateBeamStatistics( imageBeamStatistics& beam )
+{
+    beam.valid = false;
+    if( !data || width <= 0 || height <= 0 )
+    {
+        return;
+    }
+
+    QVector<double> colSum( width, 0.0 );   // Horizontal projection
+    QVector<double> rowSum( height, 0.0 );  // Vertical projection
+
+    double s0 = 0.0;
+    double sx = 0.0;
+    double sy = 0.0;
+    double sxx = 0.0;
+    double syy = 0.0;
+    double sxy = 0.0;
+    unsigned int minP = UINT_MAX;
+    unsigned int maxP = 0;
+    QPoint peakPos;
+
+    const long pixelStep = inInc * (long)bytesPerPixel;
+    for( int y = 0; y < height; y++ )
+    {
+        // Accumulate the row sums, then add them to the image sums
+        const unsigned char* ptr = pixelPtr( 0, y );
+        double rs = 0.0;
+        double rsx = 0.0;
+        double rsxx = 0.0;
+        for( int x = 0; x < width; x++ )
+        {
+            unsigned int p = getPixelValue( ptr, formatOption, bitDepth, imageDataSize );
+            ptr += pixelStep;
+
+            double v = p;
+            rs += v;
+            rsx += v * x;
+            rsxx += v * x * x;
+            colSum[x] += v;
+
+            if( p < minP ) minP = p;
+            if( p > maxP ) { maxP = p; peakPos = QPoint( x, y ); }
+        }
+        rowSum[y] = rs;
+        s0 += rs;
+        sx += rsx;
+        sxx += rsxx;
+        sy += rs * y;
+        syy += rs * y * y;
+        sxy += rsx * y;
+    }
+
+    // Remove the background from the sums.
+    // (The sums of the pixel coordinates over the whole image are known)
+    const double w = width;
+    const double h = height;
+    const double m = minP;
+    const double gx = w * (w-1) / 2;                // Sum of x over a row
+    const double gxx = (w-1) * w * (2*w-1) / 6;     // Sum of x*x over a row
+    const double gy = h * (h-1) / 2;                // Sum of y over a column
+    const double gyy = (h-1) * h * (2*h-1) / 6;     // Sum of y*y over a column
+    s0  -= m * w * h;
+    sx  -= m * gx * h;
+    sxx -= m * gxx * h;
+    sy  -= m * gy * w;
+    syy -= m * gyy * w;
+    sxy -= m * gx * gy;
+
+    beam.valid = true;
+    beam.background = minP;
+    beam.peak = maxP;
+    beam.peakPos = peakPos;
+    beam.fwhm = QPointF( fwhm( colSum ), fwhm( rowSum ) );
+
+    // If nothing above the background, there is no beam
+    if( s0 <= 0.0 )
+    {
+        beam.sum = 0.0;
+        beam.centroid = QPointF( (w-1) / 2, (h-1) / 2 );
+        beam.rmsSize = QPointF( 0.0, 0.0 );
+        beam.covariance = 0.0;
+        return;
+    }
+
+    double cx = sx / s0;
+    double cy = sy / s0;
+    double varX = sxx / s0 - cx * cx;
+    double varY = syy / s0 - cy * cy;
+
+    beam.sum = s0;
+    beam.centroid = QPointF( cx, cy );
+    beam.rmsSize = QPointF( sqrt( MAX( varX, 0.0 ) ), sqrt( MAX( varY, 0.0 ) ) );
+    beam.covariance = sxy / s0 - cx * cy;
+}
+
+// Return the full width half maximum of a projection.
+// The width is measured between the points either side of the peak where the projection crosses
+// half way between its minimum and maximum, interpolating between values.
+double imageAnalysis::fwhm( const QVector<double>& projection )
+{
+    const int n = projection.count();
+    if( n == 0 )
+    {
+        return 0.0;
+    }
+
+    int peak = 0;
+    double maxV = projection[0];
+    double minV = projection[0];
+    for( int i = 1; i < n; i++ )
+    {
+        double v = projection[i];
+        if( v > maxV ) { maxV = v; peak = i; }
+        if( v < minV ) minV = v;
+    }
+    if( maxV <= minV )
+    {
+        return 0.0;
+    }
+    const double half = ( maxV + minV ) / 2;
+
+    // Find the crossing before the peak
+    int l = peak;
+    while( l > 0 && projection[l-1] > half )
+    {
+        l--;
+    }
+    double left = l;
+    if( l > 0 )
+    {
+        left = (l-1) + ( half - projection[l-1] ) / ( projection[l] - projection[l-1] );
+    }
+
+    // Find the crossing after the peak
+    int r = peak;
+    while( r < n-1 && projection[r+1] > half )
+    {
+        r++;
+    }
+    double right = r;
+    if( r < n-1 )
+    {
+        right = r + ( projection[r] - half ) / ( projection[r] - projection[r+1] );
+    }
+
+    return right - left;
+}
+
+// Calculate statistics for an area of the image.
+// The area is limited to within the image as, if the area selected was the the entire image and the
+// image was not presented at 100%, rounding while scaling may result in area dimensions outside the
+// image by a pixel or so.
+void imageAnalysis::generateAreaStatistics( const QRect& area, imageAreaStatistics& stats )
+{
+    stats.valid = false;
+    stats.minP = 0;
+    stats.maxP = 0;
+    stats.sum = 0.0;
+    stats.pixels = 0;
+
+    QRect clipped = area.normalized() & QRect( 0, 0, width, height );
+    if( !data || clipped.isEmpty() )
+    {
+        return;
+    }
+
+    unsigned int minP = UINT_MAX;
+    unsigned int maxP = 0;
+    double sum = 0.0;
+    const long pixelStep = inInc * (long)bytesPerPixel;
+    const int areaW = clipped.width();
+    for( int y = clipped.top(); y <= clipped.bottom(); y++ )
+    {
+        const unsigned char* ptr = pixelPtr( clipped.left(), y );
+        for( int x = 0; x < areaW; x++ )
+        {
+            unsigned int p = getPixelValue( ptr, formatOption, bitDepth, imageDataSize );
+            ptr += pixelStep;
+
+            sum += p;
+            if( p < minP ) minP = p;
+            if( p > maxP ) maxP = p;
+        }
+    }
+
+    stats.valid = true;
+    stats.minP = minP;
+    stats.maxP = maxP;
+    stats.sum = sum;
+    stats.pixels = (unsigned long)areaW * clipped.height();
+}
+
+// Generate a profile along a line down an image at a given X position
+// Input ordinates are scaled to the source image data.
+// The profile contains values for each pixel intersected by the line, averaged over the line thickness.
+// The profile is ordered so the plot, which sits on its side beside the image, is drawn correctly.
+void imageAnalysis::generateVSliceData( QVector<QPointF>& vSliceData, int x, unsigned int thickness )
+{
+    // Ensure the buffer is the correct size
+    if( vSliceData.size() != height )
+        vSliceData.resize( height );
+
+    // Set up to step through the line thickness
+    unsigned int halfThickness = thickness/2;
+    int xMin = x-halfThickness;
+    if( xMin < 0 ) xMin = 0;
+    int xMax =  xMin+thickness;
+    if( xMax >= width ) xMax = width;
+    double divisor = ( thickness > 1 ) ? thickness : 1;
+
+    // Accumulate the image data value at each pixel across the thickness
+    const long pixelStep = inInc * (long)bytesPerPixel;
+    for( int i = 0; i < height; i++ )
+    {
+        double value = 0.0;
+        if( data && xMin < xMax )
+        {
+            const unsigned char* ptr = pixelPtr( xMin, i );
+            for( int nextX = xMin; nextX < xMax; nextX++ )
+            {
+                value += getPixelValue( ptr, formatOption, bitDepth, imageDataSize );
+                ptr += pixelStep;
+            }
+        }
+        vSliceData[i] = QPointF( value/divisor, i );
+    }
+}
+
+// Generate a profile along a line across an image at a given Y position
+// Input ordinates are at the resolution of the source image data
+// The profile contains values for each pixel intersected by the line, averaged over the line thickness.
+void imageAnalysis::generateHSliceData( QVector<QPointF>& hSliceData, int y, unsigned int thickness )
+{
+    // Ensure the buffer is the correct size
+    if( hSliceData.size() != width )
+        hSliceData.resize( width );
+
+    // Set up to step through the line thickness
+    unsigned int halfThickness = thickness/2;
+    int yMin = y-halfThickness;
+    if( yMin < 0 ) yMin = 0;
+    int yMax =  yMin+thickness;
+    if( yMax >= height ) yMax = height;
+    double divisor = ( thickness > 1 ) ? thickness : 1;
+
+    // Clear the profile
+    for( int i = 0; i < width; i++ )
+    {
+        hSliceData[i] = QPointF( i, 0.0 );
+    }
+    if( !data )
+    {
+        return;
+    }
+
+    // Accumulate the image data value at each pixel, a row at a time
+    const long pixelStep = inInc * (long)bytesPerPixel;
+    for( int nextY = yMin; nextY < yMax; nextY++ )
+    {
+        const unsigned char* ptr = pixelPtr( 0, nextY );
+        for( int i = 0; i < width; i++ )
+        {
+            QPointF& dataPoint = hSliceData[i];
+            dataPoint.setY( dataPoint.y() + getPixelValue( ptr, formatOption, bitDepth, imageDataSize ) );
+            ptr += pixelStep;
+        }
+    }
+
+    // Calculate average pixel values if more than one pixel thick
+    if( thickness > 1 )
+    {
+        for( int i = 0; i < width; i++ )
+        {
+            QPointF& dataPoint = hSliceData[i];
+            dataPoint.setY( dataPoint.y()/divisor );
+        }
+    }
+}
+
+// Generate a profile along an arbitrary line through an image.
+// Input ordinates are scaled to the source image data.
+// The profile contains values one pixel length along the line.
+// Except where the line is vertical or horizontal points one pixel
+// length along the line will not line up with actual pixels.
+// The values returned are a weighted average of the four actual pixels
+// containing a notional pixel drawn around the each point on the line.
+// The line has a notional thickness. The processing for a single pixel
+// width is repeated with the start and end points moved at right angles
+// to the line by a 'pixel' distance up to the line thickness.
+// The results are then averaged.
+// Refer to QEImage::generateProfile() for a detailed description.
+void imageAnalysis::generateProfileData( QVector<QPointF>& profileData, QPoint point1, QPoint point2, unsigned int thickness )
+{
+    // X and Y components of line drawn
+    double dX = point2.x()-point1.x();
+    double dY = point2.y()-point1.y();
+
+    // Line length
+    double len = sqrt( dX*dX+dY*dY );
+    if( len == 0.0 )
+    {
+        profileData.clear();
+        return;
+    }
+
+    // Step on each axis to move one 'pixel' length
+    double xStep = dX/len;
+    double yStep = dY/len;
+
+    // Starting point in center of start pixel
+    double initX = point1.x()+0.5;
+    double initY = point1.y()+0.5;
+
+    // Integer pixel length
+    int intLen = (int)len;
+
+    // Ensure output buffer is the correct size
+    if( profileData.size() != intLen )
+    {
+       profileData.resize( intLen );
+    }
+
+    // Parrallel passes will be made one 'pixel' away from each other up to the thickness required.
+    // Determine the offset for the first pass.
+    // Note, this will not add an offset for a thickness of 1 pixel
+    if( thickness < 1 )
+    {
+        thickness = 1;
+    }
+    initX -= yStep * (double)(thickness-1) / 2;
+    initY += xStep * (double)(thickness-1) / 2;
+
+    // Accumulate a set of values for each pixel width up to the thickness required
+    bool firstPass = true;
+    for( unsigned int j = 0; j < thickness; j++ )
+    {
+        // Starting point for this pass
+        double x = initX;
+        double y = initY;
+
+        // Calculate a value for each pixel length along the selected line
+        for( int i = 0; i < intLen; i++ )
+        {
+            // Calculate the value if the point is within the image (user can drag outside the image)
+            // Use a value of zero if the point is not within the image
+            double value = 0.0;
+            if( data && x >= 0 && x < width && y >= 0 && y < height )
+            {
+                // Determine the top left of the notional pixel that will be measured
+                // The notional pixel is one pixel length both dimensions and will not
+                // nessesarily overlay a single real pixel
+                double xTL = x-0.5;
+                double yTL = y-0.5;
+
+                // Determine the top left actual pixel of the four actual pixels that
+                // the notional pixel overlays, and the fractional part of a pixel that
+                // the notional pixel is offset by.
+                double xTLi = floor( xTL );
+                double yTLi = floor( yTL );
+                double xTLf = xTL - xTLi;
+                double yTLf = yTL - yTLi;
+                int actualX = (int)xTLi;
+                int actualY = (int)yTLi;
+
+                // For each of the four actual pixels that the notional pixel overlays,
+                // determine the proportion of the actual pixel covered by the notional pixel
+                double propTL = (1.0-xTLf)*(1-yTLf);
+                double propTR = (xTLf)*(1-yTLf);
+                double propBL = (1.0-xTLf)*(yTLf);
+                double propBR = (xTLf)*(yTLf);
+
+                // Determine the value of the notional pixel from a weighted average of the four real pixels it overlays.
+                // The larger the proportion of the real pixel overlayed, the greated the weight.
+                // (Ignore pixels outside the image)
+                int pixelsInValue = 0;
+                if( actualX >= 0 && actualY >= 0 )
+                {
+                    value += propTL * pixelValue( actualX, actualY );
+                    pixelsInValue++;
+                }
+                if( actualX+1 < width && actualY >= 0 )
+                {
+                    value += propTR * pixelValue( actualX+1, actualY );
+                    pixelsInValue++;
+                }
+                if( actualX >= 0 && actualY+1 < height )
+                {
+                    value += propBL * pixelValue( actualX, actualY+1 );
+                    pixelsInValue++;
+                }
+                if( actualX+1 < width && actualY+1 < height )
+                {
+                    value += propBR * pixelValue( actualX+1, actualY+1 );
+                    pixelsInValue++;
+                }
+
+                // Calculate the weighted value
+                if( pixelsInValue )
+                {
+                    value = value / pixelsInValue * 4;
+                }
+            }
+
+            // Move on to the next 'point'
+            x+=xStep;
+            y+=yStep;
+
+            // If the first pass, set the X axis and the initial data value
+            // On consequent passes, accumulate the data value
+            QPointF& dataPoint = profileData[i];
+            if( firstPass )
+            {
+                dataPoint = QPointF( i, value );
+            }
+            else
+            {
+                dataPoint.setY( dataPoint.y() + value );
+            }
+        }
+
+        initX += yStep;
+        initY -= xStep;
+
+        firstPass = false;
+    }
+
+    // Average the values
+    for( int i = 0; i < intLen; i++ )
+    {
+        QPointF& dataPoint = profileData[i];
+        dataPoint.setY( dataPoint.y() / thickness );
+    }
+}
+
+// Return a number representing a pixel intensity given a pointer into an image data buffer.
+// Note, the pointer is indexed according to the pixel data size which will be at least
+// big enough for the data format.
+int imageAnalysis::getPixelValue( const unsigned char* ptr, QE::ImageFormatOptions formatOption, unsigned int bitDepth, unsigned long imageDataSize )
+{
+    // Sanity check
+    if( !ptr )
+        return 0;
+
+    // Case the data to the correct size, then return the data as a number.
+    switch( formatOption )
+    {
+        case QE::BayerGB:
+        case QE::BayerBG:
+        case QE::BayerGR:
+        case QE::BayerRG:
+        case QE::Mono:
+            {
+                unsigned int usableDepth = bitDepth;
+                if( bitDepth > (imageDataSize*8) )
+                {
+                    usableDepth = imageDataSize*8;
+                }
+
+                quint32 mask = ((unsigned long)(1)<<usableDepth)-1;
+
+                // Only read the bytes of the data element (reading beyond it may read beyond the end of the image data)
+                switch( imageDataSize )
+                {
+                    case 1:  return (*ptr)&mask;
+                    case 2:  return (*((quint16*)ptr))&mask;
+                    default: return (*((quint32*)ptr))&mask;
+                }
+            }
+
+        case QE::rgb1:
+        case QE::rgb2:      //!!! not done - copy of RGB1
+        case QE::rgb3:      //!!! not done - copy of RGB1
+        case QE::yuv444:    //!!! not done - copy of RGB1
+        case QE::yuv422:    //!!! not done - copy of RGB1
+        case QE::yuv421:    //!!! not done - copy of RGB1
+            {
+                // for RGB, average all colors
+                unsigned int pixel = *(unsigned int*)ptr;
+                return ((pixel&0xff0000>>16) + (pixel&0x00ff00>>8) + (pixel&0x0000ff)) / 3;
+            }
+
+        default:   // avoid  compilation warning for NUMBER_OF_FORMATS
+            break;
+    }
+
+    // Avoid compilation warning (not sure why this is required as all cases are handled in switch statements.
+    return *ptr;
+}
+
+// end
@@ -0,0 +1,181 @@
+/*  imageAnalysis.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Rhyder
+ *  Contact details:
+ *    andrew.rhyder@synchrotron.org.au
+ */
+
+/*
+ This module analyses image data: beam statistics (centroid, size, FWHM and peak),
+ statistics for selected areas, and profiles through the image (vertical and horizontal
+ slices and arbitrary lines).
+
+ All positions are in displayed image coordinates (following any rotation and flipping,
+ but before any zooming). The image data is read directly according to the same scan
+ parameters used to build the displayed image.
+
+ The analysis is performed by the image processing thread for each image built, according to
+ the markups currently in use, and the results are delivered to the widget with the image.
+ The same analysis is used by the widget when markups are moved between images.
+ */
+
+#ifndef QE_IMAGE_ANALYSIS_H
+#define QE_IMAGE_ANALYSIS_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QMetaType>
+#include <QEEnums.h>
+
+// Number of selected areas that may be analysed
+#define ANALYSIS_AREAS 4
+
+// The way input image data is scanned to generate the displayed (rotated and flipped) image.
+// See imageProcessor::getScanOption() for the meaning of each scan option.
+struct imageScan
+{
+    imageScan( int scanOption, int w, int h );
+
+    int outCount;                                   // Outer loop count (displayed image rows)
+    int inCount;                                    // Inner loop count (displayed image columns)
+    int start;                                      // Input data start pixel (one of the four corners)
+    int outInc;                                     // Outer loop increment to input data index
+    int inInc;                                      // Inner loop increment to input data index
+
+    long rowStep() const { return (long)inCount*inInc + outInc; }   // Input data index change per displayed image row
+};
+
+// The analysis required for each image (according to the markups in use)
+class imageAnalysisRequest
+{
+public:
+    imageAnalysisRequest();
+
+    bool isEmpty() const;                           // No analysis is required
+
+    bool beamStatistics;                            // Calculate beam statistics
+
+    bool vSlice;                                    // Generate a vertical slice profile...
+    int vSliceX;                                    // ...at this X position
+    unsigned int vSliceThickness;                   // ...this many pixels thick
+
+    bool hSlice;                                    // Generate a horizontal slice profile...
+    int hSliceY;                                    // ...at this Y position
+    unsigned int hSliceThickness;                   // ...this many pixels thick
+
+    bool profile;                                   // Generate an arbitrary line profile...
+    QPoint profileStart;                            // ...from this point...
+    QPoint profileEnd;                              // ...to this point...
+    unsigned int profileThickness;                  // ...this many pixels thick
+
+    bool area[ANALYSIS_AREAS];                      // Calculate statistics for each selected area...
+    QRect areaRect[ANALYSIS_AREAS];                 // ...over this area
+};
+
+// Statistics for a selected area
+struct imageAreaStatistics
+{
+    bool valid;                                     // Statistics have been calculated (the area overlaps the image)
+    unsigned int minP;                              // Minimum pixel value
+    unsigned int maxP;                              // Maximum pixel value
+    double sum;                                     // Sum of pixel values
+    unsigned long pixels;                           // Number of pixels
+
+    double mean() const { return pixels ? sum / pixels : 0.0; }
+};
+
+// Beam statistics for the whole image.
+// Moments are calculated above the minimum pixel value (the background), and the FWHM from the
+// horizontal and vertical projections of the image.
+struct imageBeamStatistics
+{
+    bool valid;                                     // Statistics have been calculated
+    double sum;                                     // Sum of pixel values above the background
+    unsigned int background;                        // Minimum pixel value
+    unsigned int peak;                              // Maximum pixel value...
+    QPoint peakPos;                                 // ...and its (first) position
+    QPointF centroid;                               // First moments
+    QPointF rmsSize;                                // Square root of the second central moments
+    double covariance;                              // Second central moment XY
+    QPointF fwhm;                                   // Full width half maximum of the X and Y projections
+};
+
+// Results of analysing an image
+class imageAnalysisResults
+{
+public:
+    imageAnalysisResults();
+
+    imageAnalysisRequest request;                   // Analysis performed
+    imageBeamStatistics beam;                       // Beam statistics (if requested)
+    QVector<QPointF> vSliceData;                    // Vertical slice profile (if requested)
+    QVector<QPointF> hSliceData;                    // Horizontal slice profile (if requested)
+    QVector<QPointF> profileData;                   // Arbitrary line profile (if requested)
+    imageAreaStatistics areas[ANALYSIS_AREAS];      // Selected area statistics (if requested)
+};
+
+Q_DECLARE_METATYPE( imageAnalysisResults )
+
+// Class to analyse image data
+class imageAnalysis
+{
+public:
+    imageAnalysis( const QByteArray& imageData,
+                   unsigned long imageBuffWidth,
+                   unsigned long imageBuffHeight,
+                   int scanOption,
+                   unsigned long bytesPerPixel,
+                   QE::ImageFormatOptions formatOption,
+                   unsigned int bitDepth,
+                   unsigned long imageDataSize );
+
+    void analyse( const imageAnalysisRequest& request, imageAnalysisResults& results ); // Perform all requested analysis
+
+    void generateBeamStatistics( imageBeamStatistics& beam );                                                    // Calculate beam statistics
+    void generateAreaStatistics( const QRect& area, imageAreaStatistics& stats );                                // Calculate statistics for an area
+    void generateVSliceData( QVector<QPointF>& vSliceData, int x, unsigned int thickness );                      // Generate a profile down the image at a given X position
+    void generateHSliceData( QVector<QPointF>& hSliceData, int y, unsigned int thickness );                      // Generate a profile across the image at a given Y position
+    void generateProfileData( QVector<QPointF>& profileData, QPoint point1, QPoint point2, unsigned int thickness ); // Generate a profile along an arbitrary line
+
+    static int getPixelValue( const unsigned char* ptr, QE::ImageFormatOptions formatOption, unsigned int bitDepth, unsigned long imageDataSize ); // Return a number representing a pixel intensity
+
+private:
+    const unsigned char* pixelPtr( int x, int y ) const { return data + ( start + y*rowStep + (long)x*inInc ) * (long)bytesPerPixel; }  // Pointer to the data for a displayed pixel
+    int pixelValue( int x, int y ) const { return data ? getPixelValue( pixelPtr( x, y ), formatOption, bitDepth, imageDataSize ) : 0; } // Value of a displayed pixel
+    static double fwhm( const QVector<double>& projection );                                                     // Full width half maximum of a projection
+
+    const unsigned char* data;        // Image data (NULL if not enough image data for the image dimensions)
+    int width;                        // Displayed image width
+    int height;                       // Displayed image height
+    long start;                       // Input data start pixel
+    long rowStep;                     // Input data index change per displayed image row
+    long inInc;                       // Input data index change per displayed image column
+    unsigned long bytesPerPixel;
+    QE::ImageFormatOptions formatOption;
+    unsigned int bitDepth;
+    unsigned long imageDataSize;
+};
+
+#endif // QE_IMAGE_ANALYSIS_H
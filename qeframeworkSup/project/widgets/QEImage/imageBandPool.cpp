@@ -0,0 +1,137 @@
+/*  imageBandPool.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Rhyder
+ *  Contact details:
+ *    andrew.rhyder@synchrotron.org.au
+ */
+
+/*
+ This class shares a single set of band workers between all image processors.
+ Refer to imageBandPool.h for details.
+
+ The following adaptation parameters are used:
+    QE_image_processor_threads   Number of band workers. Default is the number of processor cores.
+                                 1 builds each image in its image processing thread alone.
+*/
+
+#include "imageBandPool.h"
+#include "imageProcessor.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QECommon.h>
+#include <QEAdaptationParameters.h>
+
+namespace {
+
+// The pool
+struct pool
+{
+    pool()
+    {
+        users = 0;
+        manager = NULL;
+    }
+
+    QMutex lock;                // Protects users, workers and manager
+    QMutex busy;                // Held by the image processor using the workers
+    int users;                  // Number of image processors that may use the pool
+    QE::WorkerList workers;     // Band workers
+    QE::WorkerManager* manager; // Manager of the band workers (NULL if images are built by the image processing threads alone)
+};
+
+static pool* thePool()
+{
+    static pool* instance = new pool();
+    return instance;
+}
+
+} // end anonymous namespace
+
+// Note an image processor may use the pool.
+// The workers are created for the first user.
+void imageBandPool::addUser()
+{
+    pool* p = thePool();
+    QMutexLocker locker( &p->lock );
+    if( p->users++ )
+    {
+        return;
+    }
+
+    QEAdaptationParameters ap( "QE_" );
+    int threadCount = ap.getInt( "image_processor_threads", QThread::idealThreadCount() );
+    threadCount = LIMIT( threadCount, 1, MAXIMUM_THREADS );
+    if( threadCount > 1 )
+    {
+        for( int i = 0; i < threadCount; i++ )
+        {
+            p->workers.append( new imageBandWorker() );
+        }
+        p->manager = new QE::WorkerManager( p->workers );
+    }
+}
+
+// Note an image processor will no longer use the pool.
+// The workers are deleted once the last user has gone.
+// Note, the image processor's image processing thread must have finished, so it can not still hold the pool.
+void imageBandPool::removeUser()
+{
+    pool* p = thePool();
+    QMutexLocker locker( &p->lock );
+    if( p->users <= 0 || --p->users )
+    {
+        return;
+    }
+
+    // The workers must be deleted independently of their manager.
+    delete p->manager;
+    p->manager = NULL;
+    for( int i = 0; i < p->workers.count(); i++ )
+    {
+        delete p->workers[i];
+    }
+    p->workers.clear();
+}
+
+// Claim the pool to build an image.
+// Returns NULL if the pool is in use by another image processor (or there are no workers), in which case
+// the caller should build the image in its own thread alone.
+// If the pool is returned, the caller must release() it when done.
+QE::WorkerManager* imageBandPool::claim()
+{
+    pool* p = thePool();
+    QMutexLocker locker( &p->lock );
+    if( !p->manager || !p->busy.tryLock() )
+    {
+        return NULL;
+    }
+    return p->manager;
+}
+
+// Release a claimed pool
+void imageBandPool::release()
+{
+    thePool()->busy.unlock();
+}
+
+// end
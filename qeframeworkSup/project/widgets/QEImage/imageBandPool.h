@@ -0,0 +1,53 @@
+/*  imageBandPool.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Rhyder
+ *  Contact details:
+ *    andrew.rhyder@synchrotron.org.au
+ */
+
+/*
+ This class is a process wide pool of workers used to build bands of image rows in parallel.
+
+ Each QEImage widget has its own image processing thread. If each also had its own set of
+ workers, a form with several QEImage widgets would create many more threads than there are
+ processor cores, all competing with each other. Instead, all image processors share a single
+ set of workers. Only one image processor uses the workers at a time. While the workers are
+ busy, other image processors build their images in their own image processing thread alone.
+ */
+
+#ifndef QE_IMAGE_BAND_POOL_H
+#define QE_IMAGE_BAND_POOL_H
+
+#include <QEWorkers.h>
+
+// Class used to share a single set of band workers between all image processors
+class imageBandPool
+{
+public:
+    static void addUser();                      // Note an image processor may use the pool (creates the pool if required)
+    static void removeUser();                   // Note an image processor will no longer use the pool (deletes the pool when no longer used)
+
+    static QE::WorkerManager* claim();          // Claim the pool if available. Returns NULL if busy, or if images are built by the image processing threads alone
+    static void release();                      // Release a claimed pool
+};
+
+#endif // QE_IMAGE_BAND_POOL_H
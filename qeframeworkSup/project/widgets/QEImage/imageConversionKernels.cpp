@@ -0,0 +1,1188 @@
+/*  imageConversionKernels.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Rhyder
+ *  Contact details:
+ *    andrew.rhyder@synchrotron.org.au
+ */
+
+// Pixel conversion kernels for Mono and Bayer image data.
+// See imageConversionKernels.h for an overview.
+
+#include "imageConversionKernels.h"
+#include <QENumericKernels.h>
+#include <string.h>
+#include <limits.h>
+
+// Determine if we can use the x86 SSE2/AVX2 intrinsics (as per QENumericKernels).
+#if defined(__x86_64__) || defined(_M_X64) || \
+   (defined(__i386__) && defined(__SSE2__)) || \
+   (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define QE_IMAGE_X86  1
+#include <immintrin.h>
+#else
+#define QE_IMAGE_X86  0
+#endif
+
+// GCC and clang require functions using AVX2 intrinsics to be so marked.
+#if defined(__GNUC__) || defined(__clang__)
+#define QE_TARGET_AVX2  __attribute__((target("avx2")))
+#else
+#define QE_TARGET_AVX2
+#endif
+
+// Output rows processed together when each output row is an input column (scan options 5 to 8)
+#define TILE_ROWS 64
+
+typedef imageDisplayProperties::rgbPixel rgbPixel;
+
+namespace {
+
+// Sources of the red, green and blue values for a Bayer cell.
+// Interior cells use all eight neighbouring cells.
+enum bayerSources
+{
+    BS_CENTRE,      // Current cell
+    BS_CROSS,       // Average of above, below, left and right cells
+    BS_DIAGONAL,    // Average of the four diagonal cells
+    BS_HORIZONTAL,  // Average of left and right cells
+    BS_VERTICAL,    // Average of above and below cells
+    BS_COUNT
+};
+
+struct bayerCell
+{
+    bayerSources r;
+    bayerSources g;
+    bayerSources b;
+};
+
+// Each Bayer cluster of four image cells contain one red, one blue, and two green values.
+enum cellColours { CC_G1, CC_G2, CC_R, CC_B };
+
+// Everything derived from the parameters needed by the kernels
+struct context
+{
+    const unsigned char* dataIn;
+    unsigned long width;
+    unsigned long height;
+    unsigned long bytesPerPixel;
+    unsigned int mask;              // Pixel value mask
+    unsigned int shift;             // Bayer shift nessesary to obtain most significant 8 bits
+    unsigned int binShift;          // Shift from pixel value to histogram bin
+    int pixelLow;
+    int pixelHigh;
+    unsigned int pixelRange;
+    const rgbPixel* pixelLookup;    // Displayed pixel lookup table. Indexed by scaled pixel value, or by pixel value if not scaling
+    bool scaled;                    // Pixels are scaled for local brightness and contrast before lookup
+    bool vectorised;
+    QENumericKernels::InstructionSets instructionSet;
+
+    cellColours colours[4];         // Bayer colour for each cell in a cluster
+    bool g1RedVertical;             // Red above and below Green1 (and blue left and right)
+    bayerCell cells[4];             // Bayer sources for each interior cell colour (indexed by cellColours)
+};
+
+// Extract a pixel value
+static inline quint32 readPixel( const unsigned char* p, unsigned int mask )
+{
+    quint32 value;
+    memcpy( &value, p, sizeof( value ) );
+    return value & mask;
+}
+
+// Scale pixel for local brightness and contrast
+static inline unsigned int scalePixel( const context& c, unsigned int value )
+{
+    if( (int)value < c.pixelLow ) return 0;
+    if( (int)value > c.pixelHigh ) return 255;
+    return (value-c.pixelLow)*255/c.pixelRange;
+}
+
+// Return the displayed pixel lookup table index for a pixel value
+static inline unsigned int lookupIndex( const context& c, unsigned int value )
+{
+    return c.scaled ? scalePixel( c, value ) : value;
+}
+
+// Return true if the full depth lookup table can be indexed directly by every pixel value.
+// Mono pixel values are up to the bit depth mask. Bayer values are always reduced to 8 bits.
+static bool isFullLookupUsable( const imageConversionKernels::parameters& params )
+{
+    if( !params.fullPixelLookup || params.bitDepth > 16 )
+    {
+        return false;
+    }
+    unsigned long required = (unsigned long)(1)<<params.bitDepth;
+    if( required < 256 )
+    {
+        required = 256;
+    }
+    return params.fullPixelLookupSize >= required;
+}
+
+// Accumulate pixel statistics
+static inline void buildStats( unsigned int value, unsigned int binShift,
+                               unsigned int& minP, unsigned int& maxP, unsigned int* bins )
+{
+    bins[value>>binShift]++;
+    if( value < minP ) minP = value;
+    if( value > maxP ) maxP = value;
+}
+
+// Write a colour pixel given red, green and blue lookup table indices
+static inline void writeColour( const context& c, rgbPixel* out, unsigned int r, unsigned int g, unsigned int b )
+{
+    out->p[0] = c.pixelLookup[b].p[0];
+    out->p[1] = c.pixelLookup[g].p[0];
+    out->p[2] = c.pixelLookup[r].p[0];
+    out->p[3] = 0xff;
+}
+
+//==============================================================================
+// Portable kernels
+//==============================================================================
+
+// Convert a run of Mono pixels.
+static void portableMono( const context& c, unsigned long dataIndex, int count,
+                          rgbPixel* out, int outStep, imageBandStatistics& stats )
+{
+    const unsigned char* in = c.dataIn + dataIndex*c.bytesPerPixel;
+    for( int k = 0; k < count; k++ )
+    {
+        unsigned int inPixel = readPixel( in, c.mask );
+        buildStats( inPixel, c.binShift, stats.minP, stats.maxP, stats.bins );
+        *out = c.pixelLookup[lookupIndex( c, inPixel )];
+        in += c.bytesPerPixel;
+        out += outStep;
+    }
+}
+
+// Generate the red, green and blue values for one Bayer cell.
+// Edge cells use whatever neighbouring cells are available.
+static void bayerPixel( const context& c, unsigned long dataIndex, bool isEdge,
+                        quint32& r, quint32& g, quint32& b )
+{
+    // Define regions in the image where different calculations occur.
+    // Over most of the image four neighbouring cells are available.
+    // On the sides five neighbours are present.
+    // On the corners three neighbours are present.
+    enum regions {REG_TL, REG_T, REG_TR, REG_L, REG_C, REG_R, REG_BL, REG_B, REG_BR};
+
+    const int bpp = (int)c.bytesPerPixel;
+    const int w = (int)c.width;
+    const int TLOffset = (-w-1)*bpp;
+    const int  TOffset = -w*bpp;
+    const int TROffset = (-w+1)*bpp;
+    const int  LOffset = -bpp;
+    const int  ROffset = bpp;
+    const int BLOffset = (w-1)*bpp;
+    const int  BOffset = w*bpp;
+    const int BROffset = (w+1)*bpp;
+    const quint32 mask = c.mask;
+    const int shift = c.shift;
+
+    const unsigned char* inPixel = c.dataIn + dataIndex*c.bytesPerPixel;
+
+    // Calculate the current Bayer cell and translate it to a color (see imagePropertiesCore::buildImageCore())
+    unsigned int color = (dataIndex&1)|(((dataIndex/c.width)&1)<<1);
+    cellColours cellColour = c.colours[color];
+
+    // Calculate the processing region.
+    regions region = REG_C;
+    if( isEdge )
+    {
+        const unsigned long TLPixel = 0;
+        const unsigned long TRPixel = c.width-1;
+        const unsigned long BLPixel = (c.height-1)*c.width;
+        const unsigned long BRPixel = (c.height*c.width)-1;
+
+        if( dataIndex < c.width )
+        {
+            if     ( dataIndex == TLPixel ) region = REG_TL;
+            else if( dataIndex == TRPixel ) region = REG_TR;
+            else                            region = REG_T;
+        }
+        else if( dataIndex >= BLPixel)
+        {
+            if     ( dataIndex == BLPixel ) region = REG_BL;
+            else if( dataIndex == BRPixel ) region = REG_BR;
+            else                            region = REG_B;
+        }
+        else if( !(dataIndex % c.width) ) region = REG_L;
+        else                              region = REG_R;
+    }
+
+    switch( cellColour )
+    {
+        case CC_R: // red
+        case CC_B: // blue
+        {
+            quint32 g1, g2, g3, g4; // Green above, below, left and right
+            quint32 d1, d2, d3, d4; // Red or blue diagonally above-left, above-right, below-left and below-right
+            quint32 rb = readPixel( inPixel, mask );
+
+            switch( region )
+            {
+                default:
+                case REG_C:
+                    g1 = readPixel( &inPixel[TOffset], mask );
+                    g2 = readPixel( &inPixel[BOffset], mask );
+                    g3 = readPixel( &inPixel[LOffset], mask );
+                    g4 = readPixel( &inPixel[ROffset], mask );
+                    d1 = readPixel( &inPixel[TLOffset], mask );
+                    d2 = readPixel( &inPixel[TROffset], mask );
+                    d3 = readPixel( &inPixel[BLOffset], mask );
+                    d4 = readPixel( &inPixel[BROffset], mask );
+                    break;
+
+                case REG_TL:
+                    g2 = readPixel( &inPixel[BOffset], mask );
+                    g4 = readPixel( &inPixel[ROffset], mask );
+                    g1 = g2;
+                    g3 = g4;
+                    d4 = readPixel( &inPixel[BROffset], mask );
+                    d1 = d4;
+                    d2 = d4;
+                    d3 = d4;
+                    break;
+
+                case REG_T:
+                    g2 = readPixel( &inPixel[BOffset], mask );
+                    g3 = readPixel( &inPixel[LOffset], mask );
+                    g4 = readPixel( &inPixel[ROffset], mask );
+                    g1 = (g2+g3+g4)/3;
+                    d3 = readPixel( &inPixel[BLOffset], mask );
+                    d4 = readPixel( &inPixel[BROffset], mask );
+                    d1 = d3;
+                    d2 = d4;
+                    break;
+
+                case REG_TR:
+                    g2 = readPixel( &inPixel[BOffset], mask );
+                    g3 = readPixel( &inPixel[LOffset], mask );
+                    g1 = g2;
+                    g4 = g3;
+                    d3 = readPixel( &inPixel[BLOffset], mask );
+                    d1 = d3;
+                    d2 = d3;
+                    d4 = d3;
+                    break;
+
+                case REG_L:
+                    g1 = readPixel( &inPixel[TOffset], mask );
+                    g2 = readPixel( &inPixel[BOffset], mask );
+                    g4 = readPixel( &inPixel[ROffset], mask );
+                    g3 = g4;
+                    d2 = readPixel( &inPixel[TROffset], mask );
+                    d4 = readPixel( &inPixel[BROffset], mask );
+                    d1 = d2;
+                    d3 = d4;
+                    break;
+
+                case REG_R:
+                    g1 = readPixel( &inPixel[TOffset], mask );
+                    g2 = readPixel( &inPixel[BOffset], mask );
+                    g3 = readPixel( &inPixel[LOffset], mask );
+                    g4 = (g1+g2+g3)/3;
+                    d1 = readPixel( &inPixel[TLOffset], mask );
+                    d3 = readPixel( &inPixel[BLOffset], mask );
+                    d2 = d1;
+                    d4 = d3;
+                    break;
+
+                case REG_BL:
+                    g1 = readPixel( &inPixel[TOffset], mask );
+                    g4 = readPixel( &inPixel[ROffset], mask );
+                    g2 = g1;
+                    g3 = g4;
+                    d2 = readPixel( &inPixel[TROffset], mask );
+                    d1 = d2;
+                    d3 = d2;
+                    d4 = d2;
+                    break;
+
+                case REG_B:
+                    g1 = readPixel( &inPixel[TOffset], mask );
+                    g3 = readPixel( &inPixel[LOffset], mask );
+                    g4 = readPixel( &inPixel[ROffset], mask );
+                    g2 = (g1+g3+g4)/3;
+                    d1 = readPixel( &inPixel[TLOffset], mask );
+                    d2 = readPixel( &inPixel[TROffset], mask );
+                    d3 = d1;
+                    d4 = d2;
+                    break;
+
+                case REG_BR:
+                    g1 = readPixel( &inPixel[TOffset], mask );
+                    g3 = readPixel( &inPixel[LOffset], mask );
+                    g2 = g1;
+                    g4 = g3;
+                    d1 = readPixel( &inPixel[TLOffset], mask );
+                    d2 = d1;
+                    d3 = d1;
+                    d4 = d1;
+                    break;
+            }
+
+            // Calculate the diagonal sum (red or blue depending on the pattern) and the green value
+            quint32 d = (d1+d2+d3+d4)>>(shift+2);
+            g = (g1+g2+g3+g4)>>(shift+2);
+
+            if( cellColour == CC_R )
+            {
+                r = rb>>shift;
+                b = d;
+            }
+            else
+            {
+                r = d;
+                b = rb>>shift;
+            }
+            break;
+        }
+
+        case CC_G1: // green 1
+        case CC_G2: // green 2
+        {
+            quint32 h1, h2; // Left and right of green
+            quint32 v1, v2; // Above and below green
+            quint32 g12 = readPixel( inPixel, mask );
+
+            switch( region )
+            {
+                default:
+                case REG_C:
+                    h1 = readPixel( &inPixel[LOffset], mask );
+                    h2 = readPixel( &inPixel[ROffset], mask );
+                    v1 = readPixel( &inPixel[TOffset], mask );
+                    v2 = readPixel( &inPixel[BOffset], mask );
+                    break;
+
+                case REG_T:
+                    h1 = readPixel( &inPixel[LOffset], mask );
+                    h2 = readPixel( &inPixel[ROffset], mask );
+                    v2 = readPixel( &inPixel[BOffset], mask );
+                    v1 = v2;
+                    break;
+
+                case REG_TR:
+                    h1 = readPixel( &inPixel[LOffset], mask );
+                    h2 = h1;
+                    v2 = readPixel( &inPixel[BOffset], mask );
+                    v1 = v2;
+                    break;
+
+                case REG_R:
+                    h1 = readPixel( &inPixel[LOffset], mask );
+                    h2 = h1;
+                    v1 = readPixel( &inPixel[TOffset], mask );
+                    v2 = readPixel( &inPixel[BOffset], mask );
+                    break;
+
+                case REG_B:
+                    h1 = readPixel( &inPixel[LOffset], mask );
+                    h2 = readPixel( &inPixel[ROffset], mask );
+                    v1 = readPixel( &inPixel[TOffset], mask );
+                    v2 = v1;
+                    break;
+
+                case REG_BR:
+                    h1 = readPixel( &inPixel[LOffset], mask );
+                    h2 = h1;
+                    v1 = readPixel( &inPixel[TOffset], mask );
+                    v2 = v1;
+                    break;
+
+                case REG_TL:
+                    h2 = readPixel( &inPixel[ROffset], mask );
+                    h1 = h2;
+                    v2 = readPixel( &inPixel[BOffset], mask );
+                    v1 = v2;
+                    break;
+
+                case REG_L:
+                    h2 = readPixel( &inPixel[ROffset], mask );
+                    h1 = h2;
+                    v1 = readPixel( &inPixel[TOffset], mask );
+                    v2 = readPixel( &inPixel[BOffset], mask );
+                    break;
+
+                case REG_BL:
+                    h2 = readPixel( &inPixel[ROffset], mask );
+                    h1 = h2;
+                    v1 = readPixel( &inPixel[TOffset], mask );
+                    v2 = v1;
+                    break;
+            }
+
+            // Calculate the vertical and horizontal sums (one is red, the other is blue depending on the pattern)
+            quint32 h = (h1+h2)>>(shift+1);
+            quint32 v = (v1+v2)>>(shift+1);
+            g = g12>>shift;
+
+            // Red is above and below Green1 and left and right of Green2, or the other way round
+            if( (cellColour == CC_G1) == c.g1RedVertical )
+            {
+                r = v;
+                b = h;
+            }
+            else
+            {
+                r = h;
+                b = v;
+            }
+            break;
+        }
+    }
+}
+
+// Convert a run of Bayer cells within one row of the input data.
+static void portableBayer( const context& c, unsigned long dataIndex, int count,
+                           rgbPixel* out, int outStep, bool isEdge, imageBandStatistics& stats )
+{
+    for( int k = 0; k < count; k++ )
+    {
+        quint32 r = 0, g = 0, b = 0;
+        bayerPixel( c, dataIndex, isEdge, r, g, b );
+
+        // Accumulate pixel statistics (green only)
+        buildStats( g, c.binShift, stats.minP, stats.maxP, stats.bins );
+
+        // Scale pixel for local brightness and contrast (if required) and select displayed pixel
+        writeColour( c, out, lookupIndex( c, r ), lookupIndex( c, g ), lookupIndex( c, b ) );
+
+        dataIndex++;
+        out += outStep;
+    }
+}
+
+#if QE_IMAGE_X86
+
+//==============================================================================
+// SSE2 kernels. Four pixels (32 bit lanes) at a time.
+//==============================================================================
+
+// Constants used for scaling pixels for local brightness and contrast.
+//
+// Scaling is (value-pixelLow)*255/pixelRange. The vectorised kernels are only used when
+// pixelRange <= 65535, so (value-pixelLow)*255 (for values that are not clipped) and
+// quotient*pixelRange are exact in single precision floating point. The quotient is
+// estimated using the reciprocal of the range, which may be out by one, then corrected
+// using the remainder. The result is identical to the integer division.
+struct sse2Scaling
+{
+    __m128i low;
+    __m128i high;
+    __m128i v255;
+    __m128 f255;
+    __m128 range;
+    __m128 reciprocal;
+    __m128 zero;
+};
+
+static void sse2SetScaling( const context& c, sse2Scaling& s )
+{
+    s.low = _mm_set1_epi32( c.pixelLow );
+    s.high = _mm_set1_epi32( c.pixelHigh );
+    s.v255 = _mm_set1_epi32( 255 );
+    s.f255 = _mm_set1_ps( 255.0f );
+    s.range = _mm_set1_ps( (float)c.pixelRange );
+    s.reciprocal = _mm_set1_ps( 1.0f/(float)c.pixelRange );
+    s.zero = _mm_setzero_ps();
+}
+
+static inline __m128i sse2Scale( __m128i value, const sse2Scaling& s )
+{
+    __m128 x = _mm_mul_ps( _mm_cvtepi32_ps( _mm_sub_epi32( value, s.low ) ), s.f255 );
+    __m128i q = _mm_cvttps_epi32( _mm_mul_ps( x, s.reciprocal ) );
+    __m128 remainder = _mm_sub_ps( x, _mm_mul_ps( _mm_cvtepi32_ps( q ), s.range ) );
+
+    // Correct the quotient (compare masks are -1 where true)
+    q = _mm_sub_epi32( q, _mm_castps_si128( _mm_cmpge_ps( remainder, s.range ) ) );
+    q = _mm_add_epi32( q, _mm_castps_si128( _mm_cmplt_ps( remainder, s.zero ) ) );
+
+    // Clip
+    __m128i below = _mm_cmplt_epi32( value, s.low );
+    __m128i above = _mm_cmpgt_epi32( value, s.high );
+    q = _mm_andnot_si128( below, q );
+    return _mm_or_si128( _mm_andnot_si128( above, q ), _mm_and_si128( above, s.v255 ) );
+}
+
+// Load four pixels into 32 bit lanes
+static inline __m128i sse2Load( const unsigned char* p, unsigned long bytesPerPixel, __m128i mask )
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i x;
+    if( bytesPerPixel == 1 )
+    {
+        int four;
+        memcpy( &four, p, sizeof( four ) );
+        x = _mm_unpacklo_epi16( _mm_unpacklo_epi8( _mm_cvtsi32_si128( four ), zero ), zero );
+    }
+    else
+    {
+        x = _mm_unpacklo_epi16( _mm_loadl_epi64( (const __m128i*)p ), zero );
+    }
+    return _mm_and_si128( x, mask );
+}
+
+// Signed 32 bit minimum and maximum (SSE2 has no epi32 min/max). Pixel values are always < 2^31.
+static inline __m128i sse2Min( __m128i a, __m128i b )
+{
+    __m128i lt = _mm_cmplt_epi32( a, b );
+    return _mm_or_si128( _mm_and_si128( lt, a ), _mm_andnot_si128( lt, b ) );
+}
+
+static inline __m128i sse2Max( __m128i a, __m128i b )
+{
+    __m128i gt = _mm_cmpgt_epi32( a, b );
+    return _mm_or_si128( _mm_and_si128( gt, a ), _mm_andnot_si128( gt, b ) );
+}
+
+// Merge vector minimum and maximum into the statistics
+static void sse2MergeMinMax( __m128i minV, __m128i maxV, imageBandStatistics& stats )
+{
+    int mins[4];
+    int maxs[4];
+    _mm_storeu_si128( (__m128i*)mins, minV );
+    _mm_storeu_si128( (__m128i*)maxs, maxV );
+    for( int k = 0; k < 4; k++ )
+    {
+        if( (unsigned int)mins[k] < stats.minP ) stats.minP = mins[k];
+        if( (unsigned int)maxs[k] > stats.maxP ) stats.maxP = maxs[k];
+    }
+}
+
+static void sse2Mono( const context& c, unsigned long dataIndex, int count,
+                      rgbPixel* out, int outStep, imageBandStatistics& stats )
+{
+    sse2Scaling s;
+    sse2SetScaling( c, s );
+    const __m128i mask = _mm_set1_epi32( c.mask );
+    const __m128i binShift = _mm_cvtsi32_si128( c.binShift );
+    __m128i minV = _mm_set1_epi32( 0x7fffffff );
+    __m128i maxV = _mm_setzero_si128();
+
+    const unsigned char* in = c.dataIn + dataIndex*c.bytesPerPixel;
+    int bins[4];
+    int indices[4];
+    int k = 0;
+    for( ; k + 4 <= count; k += 4 )
+    {
+        __m128i value = sse2Load( in, c.bytesPerPixel, mask );
+        minV = sse2Min( minV, value );
+        maxV = sse2Max( maxV, value );
+        _mm_storeu_si128( (__m128i*)bins, _mm_srl_epi32( value, binShift ) );
+        _mm_storeu_si128( (__m128i*)indices, c.scaled ? sse2Scale( value, s ) : value );
+
+        for( int j = 0; j < 4; j++ )
+        {
+            stats.bins[bins[j]]++;
+            *out = c.pixelLookup[indices[j]];
+            out += outStep;
+        }
+        in += 4*c.bytesPerPixel;
+    }
+    if( k > 0 )
+    {
+        sse2MergeMinMax( minV, maxV, stats );
+    }
+
+    portableMono( c, dataIndex+k, count-k, out, outStep, stats );
+}
+
+static void sse2Bayer( const context& c, unsigned long dataIndex, int count,
+                       rgbPixel* out, int outStep, imageBandStatistics& stats )
+{
+    sse2Scaling s;
+    sse2SetScaling( c, s );
+    const __m128i mask = _mm_set1_epi32( c.mask );
+    const __m128i binShift = _mm_cvtsi32_si128( c.binShift );
+    const __m128i shift0 = _mm_cvtsi32_si128( c.shift );
+    const __m128i shift1 = _mm_cvtsi32_si128( c.shift+1 );
+    const __m128i shift2 = _mm_cvtsi32_si128( c.shift+2 );
+    __m128i minV = _mm_set1_epi32( 0x7fffffff );
+    __m128i maxV = _mm_setzero_si128();
+
+    // Cells alternate along the row. Lanes 0 and 2 are the first cell, lanes 1 and 3 the second.
+    unsigned int color = (dataIndex&1)|(((dataIndex/c.width)&1)<<1);
+    const bayerCell& first = c.cells[c.colours[color]];
+    const bayerCell& second = c.cells[c.colours[color^1]];
+    const __m128i firstLanes = _mm_set_epi32( 0, -1, 0, -1 );
+    const __m128i secondLanes = _mm_set_epi32( -1, 0, -1, 0 );
+
+    const long bpp = (long)c.bytesPerPixel;
+    const long row = (long)c.width*bpp;
+    const unsigned char* in = c.dataIn + dataIndex*c.bytesPerPixel;
+    int bins[4];
+    int rs[4];
+    int gs[4];
+    int bs[4];
+    int k = 0;
+    for( ; k + 4 <= count; k += 4 )
+    {
+        __m128i centre = sse2Load( in,           bpp, mask );
+        __m128i t      = sse2Load( in-row,       bpp, mask );
+        __m128i b      = sse2Load( in+row,       bpp, mask );
+        __m128i l      = sse2Load( in-bpp,       bpp, mask );
+        __m128i r      = sse2Load( in+bpp,       bpp, mask );
+        __m128i tl     = sse2Load( in-row-bpp,   bpp, mask );
+        __m128i tr     = sse2Load( in-row+bpp,   bpp, mask );
+        __m128i bl     = sse2Load( in+row-bpp,   bpp, mask );
+        __m128i br     = sse2Load( in+row+bpp,   bpp, mask );
+
+        __m128i sources[BS_COUNT];
+        __m128i horizontal = _mm_add_epi32( l, r );
+        __m128i vertical = _mm_add_epi32( t, b );
+        sources[BS_CENTRE]     = _mm_srl_epi32( centre, shift0 );
+        sources[BS_CROSS]      = _mm_srl_epi32( _mm_add_epi32( horizontal, vertical ), shift2 );
+        sources[BS_DIAGONAL]   = _mm_srl_epi32( _mm_add_epi32( _mm_add_epi32( tl, tr ), _mm_add_epi32( bl, br ) ), shift2 );
+        sources[BS_HORIZONTAL] = _mm_srl_epi32( horizontal, shift1 );
+        sources[BS_VERTICAL]   = _mm_srl_epi32( vertical, shift1 );
+
+        __m128i red   = _mm_or_si128( _mm_and_si128( sources[first.r], firstLanes ), _mm_and_si128( sources[second.r], secondLanes ) );
+        __m128i green = _mm_or_si128( _mm_and_si128( sources[first.g], firstLanes ), _mm_and_si128( sources[second.g], secondLanes ) );
+        __m128i blue  = _mm_or_si128( _mm_and_si128( sources[first.b], firstLanes ), _mm_and_si128( sources[second.b], secondLanes ) );
+
+        minV = sse2Min( minV, green );
+        maxV = sse2Max( maxV, green );
+        _mm_storeu_si128( (__m128i*)bins, _mm_srl_epi32( green, binShift ) );
+        _mm_storeu_si128( (__m128i*)rs, c.scaled ? sse2Scale( red, s ) : red );
+        _mm_storeu_si128( (__m128i*)gs, c.scaled ? sse2Scale( green, s ) : green );
+        _mm_storeu_si128( (__m128i*)bs, c.scaled ? sse2Scale( blue, s ) : blue );
+
+        for( int j = 0; j < 4; j++ )
+        {
+            stats.bins[bins[j]]++;
+            writeColour( c, out, rs[j], gs[j], bs[j] );
+            out += outStep;
+        }
+        in += 4*bpp;
+    }
+    if( k > 0 )
+    {
+        sse2MergeMinMax( minV, maxV, stats );
+    }
+
+    portableBayer( c, dataIndex+k, count-k, out, outStep, false, stats );
+}
+
+//==============================================================================
+// AVX2 kernels. Eight pixels (32 bit lanes) at a time.
+//==============================================================================
+
+struct avx2Scaling
+{
+    __m256i low;
+    __m256i high;
+    __m256i v255;
+    __m256 f255;
+    __m256 range;
+    __m256 reciprocal;
+    __m256 zero;
+};
+
+QE_TARGET_AVX2
+static void avx2SetScaling( const context& c, avx2Scaling& s )
+{
+    s.low = _mm256_set1_epi32( c.pixelLow );
+    s.high = _mm256_set1_epi32( c.pixelHigh );
+    s.v255 = _mm256_set1_epi32( 255 );
+    s.f255 = _mm256_set1_ps( 255.0f );
+    s.range = _mm256_set1_ps( (float)c.pixelRange );
+    s.reciprocal = _mm256_set1_ps( 1.0f/(float)c.pixelRange );
+    s.zero = _mm256_setzero_ps();
+}
+
+// As per sse2Scale()
+QE_TARGET_AVX2
+static inline __m256i avx2Scale( __m256i value, const avx2Scaling& s )
+{
+    __m256 x = _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_sub_epi32( value, s.low ) ), s.f255 );
+    __m256i q = _mm256_cvttps_epi32( _mm256_mul_ps( x, s.reciprocal ) );
+    __m256 remainder = _mm256_sub_ps( x, _mm256_mul_ps( _mm256_cvtepi32_ps( q ), s.range ) );
+
+    q = _mm256_sub_epi32( q, _mm256_castps_si256( _mm256_cmp_ps( remainder, s.range, _CMP_GE_OQ ) ) );
+    q = _mm256_add_epi32( q, _mm256_castps_si256( _mm256_cmp_ps( remainder, s.zero, _CMP_LT_OQ ) ) );
+
+    q = _mm256_andnot_si256( _mm256_cmpgt_epi32( s.low, value ), q );
+    return _mm256_blendv_epi8( q, s.v255, _mm256_cmpgt_epi32( value, s.high ) );
+}
+
+// Load eight pixels into 32 bit lanes
+QE_TARGET_AVX2
+static inline __m256i avx2Load( const unsigned char* p, unsigned long bytesPerPixel, __m256i mask )
+{
+    __m256i x;
+    if( bytesPerPixel == 1 )
+    {
+        x = _mm256_cvtepu8_epi32( _mm_loadl_epi64( (const __m128i*)p ) );
+    }
+    else
+    {
+        x = _mm256_cvtepu16_epi32( _mm_loadu_si128( (const __m128i*)p ) );
+    }
+    return _mm256_and_si256( x, mask );
+}
+
+QE_TARGET_AVX2
+static void avx2MergeMinMax( __m256i minV, __m256i maxV, imageBandStatistics& stats )
+{
+    int mins[8];
+    int maxs[8];
+    _mm256_storeu_si256( (__m256i*)mins, minV );
+    _mm256_storeu_si256( (__m256i*)maxs, maxV );
+    for( int k = 0; k < 8; k++ )
+    {
+        if( (unsigned int)mins[k] < stats.minP ) stats.minP = mins[k];
+        if( (unsigned int)maxs[k] > stats.maxP ) stats.maxP = maxs[k];
+    }
+}
+
+// Store eight output pixels
+QE_TARGET_AVX2
+static inline rgbPixel* avx2Store( rgbPixel* out, int outStep, __m256i pixels )
+{
+    if( outStep == 1 )
+    {
+        _mm256_storeu_si256( (__m256i*)out, pixels );
+        return out + 8;
+    }
+
+    rgbPixel p[8];
+    _mm256_storeu_si256( (__m256i*)p, pixels );
+    for( int j = 0; j < 8; j++ )
+    {
+        *out = p[j];
+        out += outStep;
+    }
+    return out;
+}
+
+QE_TARGET_AVX2
+static void avx2Mono( const context& c, unsigned long dataIndex, int count,
+                      rgbPixel* out, int outStep, imageBandStatistics& stats )
+{
+    avx2Scaling s;
+    avx2SetScaling( c, s );
+    const __m256i mask = _mm256_set1_epi32( c.mask );
+    const __m128i binShift = _mm_cvtsi32_si128( c.binShift );
+    __m256i minV = _mm256_set1_epi32( 0x7fffffff );
+    __m256i maxV = _mm256_setzero_si256();
+
+    const unsigned char* in = c.dataIn + dataIndex*c.bytesPerPixel;
+    const int* lookup = (const int*)c.pixelLookup;
+    int bins[8];
+    int k = 0;
+    for( ; k + 8 <= count; k += 8 )
+    {
+        __m256i value = avx2Load( in, c.bytesPerPixel, mask );
+        minV = _mm256_min_epi32( minV, value );
+        maxV = _mm256_max_epi32( maxV, value );
+        _mm256_storeu_si256( (__m256i*)bins, _mm256_srl_epi32( value, binShift ) );
+
+        __m256i index = c.scaled ? avx2Scale( value, s ) : value;
+        __m256i pixels = _mm256_i32gather_epi32( lookup, index, 4 );
+        out = avx2Store( out, outStep, pixels );
+
+        for( int j = 0; j < 8; j++ )
+        {
+            stats.bins[bins[j]]++;
+        }
+        in += 8*c.bytesPerPixel;
+    }
+    if( k > 0 )
+    {
+        avx2MergeMinMax( minV, maxV, stats );
+    }
+
+    portableMono( c, dataIndex+k, count-k, out, outStep, stats );
+}
+
+QE_TARGET_AVX2
+static void avx2Bayer( const context& c, unsigned long dataIndex, int count,
+                       rgbPixel* out, int outStep, imageBandStatistics& stats )
+{
+    avx2Scaling s;
+    avx2SetScaling( c, s );
+    const __m256i mask = _mm256_set1_epi32( c.mask );
+    const __m128i binShift = _mm_cvtsi32_si128( c.binShift );
+    const __m128i shift0 = _mm_cvtsi32_si128( c.shift );
+    const __m128i shift1 = _mm_cvtsi32_si128( c.shift+1 );
+    const __m128i shift2 = _mm_cvtsi32_si128( c.shift+2 );
+    const __m256i byteMask = _mm256_set1_epi32( 0xff );
+    const __m256i alpha = _mm256_set1_epi32( (int)0xff000000 );
+    __m256i minV = _mm256_set1_epi32( 0x7fffffff );
+    __m256i maxV = _mm256_setzero_si256();
+
+    // Cells alternate along the row. Even lanes are the first cell, odd lanes the second.
+    unsigned int color = (dataIndex&1)|(((dataIndex/c.width)&1)<<1);
+    const bayerCell& first = c.cells[c.colours[color]];
+    const bayerCell& second = c.cells[c.colours[color^1]];
+    const __m256i secondLanes = _mm256_set_epi32( -1, 0, -1, 0, -1, 0, -1, 0 );
+
+    const long bpp = (long)c.bytesPerPixel;
+    const long row = (long)c.width*bpp;
+    const unsigned char* in = c.dataIn + dataIndex*c.bytesPerPixel;
+    const int* lookup = (const int*)c.pixelLookup;
+    int bins[8];
+    int k = 0;
+    for( ; k + 8 <= count; k += 8 )
+    {
+        __m256i centre = avx2Load( in,           bpp, mask );
+        __m256i t      = avx2Load( in-row,       bpp, mask );
+        __m256i b      = avx2Load( in+row,       bpp, mask );
+        __m256i l      = avx2Load( in-bpp,       bpp, mask );
+        __m256i r      = avx2Load( in+bpp,       bpp, mask );
+        __m256i tl     = avx2Load( in-row-bpp,   bpp, mask );
+        __m256i tr     = avx2Load( in-row+bpp,   bpp, mask );
+        __m256i bl     = avx2Load( in+row-bpp,   bpp, mask );
+        __m256i br     = avx2Load( in+row+bpp,   bpp, mask );
+
+        __m256i sources[BS_COUNT];
+        __m256i horizontal = _mm256_add_epi32( l, r );
+        __m256i vertical = _mm256_add_epi32( t, b );
+        sources[BS_CENTRE]     = _mm256_srl_epi32( centre, shift0 );
+        sources[BS_CROSS]      = _mm256_srl_epi32( _mm256_add_epi32( horizontal, vertical ), shift2 );
+        sources[BS_DIAGONAL]   = _mm256_srl_epi32( _mm256_add_epi32( _mm256_add_epi32( tl, tr ), _mm256_add_epi32( bl, br ) ), shift2 );
+        sources[BS_HORIZONTAL] = _mm256_srl_epi32( horizontal, shift1 );
+        sources[BS_VERTICAL]   = _mm256_srl_epi32( vertical, shift1 );
+
+        __m256i red   = _mm256_blendv_epi8( sources[first.r], sources[second.r], secondLanes );
+        __m256i green = _mm256_blendv_epi8( sources[first.g], sources[second.g], secondLanes );
+        __m256i blue  = _mm256_blendv_epi8( sources[first.b], sources[second.b], secondLanes );
+
+        minV = _mm256_min_epi32( minV, green );
+        maxV = _mm256_max_epi32( maxV, green );
+        _mm256_storeu_si256( (__m256i*)bins, _mm256_srl_epi32( green, binShift ) );
+
+        // Select displayed pixel. Only the first byte of each lookup table entry is used for each colour.
+        if( c.scaled )
+        {
+            red   = avx2Scale( red, s );
+            green = avx2Scale( green, s );
+            blue  = avx2Scale( blue, s );
+        }
+        __m256i lr = _mm256_and_si256( _mm256_i32gather_epi32( lookup, red, 4 ), byteMask );
+        __m256i lg = _mm256_and_si256( _mm256_i32gather_epi32( lookup, green, 4 ), byteMask );
+        __m256i lb = _mm256_and_si256( _mm256_i32gather_epi32( lookup, blue, 4 ), byteMask );
+        __m256i pixels = _mm256_or_si256( _mm256_or_si256( lb, alpha ),
+                                          _mm256_or_si256( _mm256_slli_epi32( lg, 8 ), _mm256_slli_epi32( lr, 16 ) ) );
+        out = avx2Store( out, outStep, pixels );
+
+        for( int j = 0; j < 8; j++ )
+        {
+            stats.bins[bins[j]]++;
+        }
+        in += 8*bpp;
+    }
+    if( k > 0 )
+    {
+        avx2MergeMinMax( minV, maxV, stats );
+    }
+
+    portableBayer( c, dataIndex+k, count-k, out, outStep, false, stats );
+}
+
+#endif // QE_IMAGE_X86
+
+//==============================================================================
+// Dispatch
+//==============================================================================
+
+// Convert a run of Mono pixels
+static void convertMono( const context& c, unsigned long dataIndex, int count,
+                         rgbPixel* out, int outStep, imageBandStatistics& stats )
+{
+#if QE_IMAGE_X86
+    if( c.vectorised )
+    {
+        switch( c.instructionSet )
+        {
+            case QENumericKernels::AVX2: avx2Mono( c, dataIndex, count, out, outStep, stats ); return;
+            case QENumericKernels::SSE2: sse2Mono( c, dataIndex, count, out, outStep, stats ); return;
+            default: break;
+        }
+    }
+#endif
+    portableMono( c, dataIndex, count, out, outStep, stats );
+}
+
+// Convert a run of Bayer cells. The run must be within one row of the input data.
+static void convertBayer( const context& c, unsigned long dataIndex, int count,
+                          rgbPixel* out, int outStep, imageBandStatistics& stats )
+{
+    unsigned long x = dataIndex % c.width;
+    unsigned long y = dataIndex / c.width;
+
+    // Top and bottom rows are all edge cells
+    if( y == 0 || y == c.height-1 )
+    {
+        portableBayer( c, dataIndex, count, out, outStep, true, stats );
+        return;
+    }
+
+    // Left edge cell
+    bool rightEdge = ( x + (unsigned long)count >= c.width );
+    if( x == 0 )
+    {
+        portableBayer( c, dataIndex, 1, out, outStep, true, stats );
+        dataIndex++;
+        out += outStep;
+        count--;
+    }
+
+    // Right edge cell (done last)
+    if( rightEdge && count > 0 )
+    {
+        count--;
+    }
+    else
+    {
+        rightEdge = false;
+    }
+
+    // Interior cells
+    if( count > 0 )
+    {
+#if QE_IMAGE_X86
+        if( c.vectorised && c.instructionSet == QENumericKernels::AVX2 )
+        {
+            avx2Bayer( c, dataIndex, count, out, outStep, stats );
+        }
+        else if( c.vectorised && c.instructionSet == QENumericKernels::SSE2 )
+        {
+            sse2Bayer( c, dataIndex, count, out, outStep, stats );
+        }
+        else
+#endif
+        {
+            portableBayer( c, dataIndex, count, out, outStep, false, stats );
+        }
+        dataIndex += count;
+        out += count*outStep;
+    }
+
+    if( rightEdge )
+    {
+        portableBayer( c, dataIndex, 1, out, outStep, true, stats );
+    }
+}
+
+}   // end anonymous namespace
+
+//==============================================================================
+// imageBandStatistics
+//==============================================================================
+
+// Reset band statistics ready for accumulating statistics
+void imageBandStatistics::clear()
+{
+    minP = UINT_MAX;
+    maxP = 0;
+    for( int i = 0; i < HISTOGRAM_BINS; i++ )
+    {
+        bins[i] = 0;
+    }
+}
+
+// Accumulate statistics from another band
+void imageBandStatistics::merge( const imageBandStatistics& other )
+{
+    if( other.minP < minP ) minP = other.minP;
+    if( other.maxP > maxP ) maxP = other.maxP;
+    for( int i = 0; i < HISTOGRAM_BINS; i++ )
+    {
+        bins[i] += other.bins[i];
+    }
+}
+
+//==============================================================================
+// imageConversionKernels
+//==============================================================================
+
+// Return true if the format is converted by these kernels
+bool imageConversionKernels::isFormatSupported( QE::ImageFormatOptions format )
+{
+    switch( format )
+    {
+        case QE::Mono:
+        case QE::BayerGB:
+        case QE::BayerBG:
+        case QE::BayerGR:
+        case QE::BayerRG:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+// Return true if SIMD kernels will be used for these parameters
+bool imageConversionKernels::isVectorised( const parameters& params )
+{
+#if QE_IMAGE_X86
+    if( QENumericKernels::instructionSet() == QENumericKernels::Portable )
+    {
+        return false;
+    }
+
+    // Pixel values must fit in the 8 or 16 bit loads
+    bool sizeOk = ( params.bytesPerPixel == 1 && params.bitDepth <= 8 ) ||
+                  ( params.bytesPerPixel == 2 && params.bitDepth <= 16 );
+
+    // Scaling must be exact (see sse2Scaling), unless no scaling is required
+    bool rangeOk = isFullLookupUsable( params ) ||
+                   ( params.pixelHigh >= params.pixelLow &&
+                     (long)params.pixelHigh - (long)params.pixelLow <= 65535 );
+
+    // Bayer interior runs need neighbouring rows and columns
+    bool shapeOk = params.format == QE::Mono || ( params.width >= 3 && params.height >= 3 );
+
+    return sizeOk && rangeOk && shapeOk && params.bitDepth > 0;
+#else
+    Q_UNUSED( params );
+    return false;
+#endif
+}
+
+// Convert output image rows firstRow to lastRow-1.
+//
+// The output image is written a row at a time when the scan option reads the input data a row at a
+// time (scan options 1 to 4). Otherwise (scan options 5 to 8, where each output row is an input
+// data column) the band is processed one input data row at a time, writing the pixels in a column of
+// the output image. Either way, each kernel is given a run of consecutive input pixels.
+void imageConversionKernels::buildBand( const parameters& params, const scan& scanIn,
+                                        int firstRow, int lastRow,
+                                        const unsigned char* dataIn,
+                                        rgbPixel* dataOut,
+                                        imageBandStatistics& stats )
+{
+    if( firstRow >= lastRow || scanIn.inCount <= 0 )
+    {
+        return;
+    }
+
+    // Set up everything derived from the parameters
+    context c;
+    c.dataIn = dataIn;
+    c.width = params.width;
+    c.height = params.height;
+    c.bytesPerPixel = params.bytesPerPixel;
+    c.mask = ((unsigned long)(1)<<params.bitDepth)-1;
+    c.shift = (params.bitDepth<=8)?0:params.bitDepth-8;
+    c.binShift = (params.bitDepth<8)?0:params.bitDepth-8;
+    c.pixelLow = params.pixelLow;
+    c.pixelHigh = params.pixelHigh;
+    c.pixelRange = params.pixelHigh-params.pixelLow;
+    if( !c.pixelRange )
+    {
+        c.pixelRange = 1;
+    }
+    c.scaled = !isFullLookupUsable( params );
+    c.pixelLookup = c.scaled ? params.pixelLookup : params.fullPixelLookup;
+    c.instructionSet = QENumericKernels::instructionSet();
+    c.vectorised = isVectorised( params );
+
+    // Bayer colour for each cell in a cluster. There are four combinations for each cluster and no standard :(
+    //   01010101010101010101...
+    //   23232323232323232323...
+    switch( params.format )
+    {
+        default:
+        case QE::BayerGB: c.colours[0] = CC_G1; c.colours[1] = CC_B;  c.colours[2] = CC_R;  c.colours[3] = CC_G2; break;
+        case QE::BayerBG: c.colours[0] = CC_B;  c.colours[1] = CC_G1; c.colours[2] = CC_G2; c.colours[3] = CC_R;  break;
+        case QE::BayerGR: c.colours[0] = CC_G1; c.colours[1] = CC_R;  c.colours[2] = CC_B;  c.colours[3] = CC_G2; break;
+        case QE::BayerRG: c.colours[0] = CC_R;  c.colours[1] = CC_G1; c.colours[2] = CC_G2; c.colours[3] = CC_B;  break;
+    }
+    c.g1RedVertical = ( params.format == QE::BayerGB || params.format == QE::BayerBG );
+
+    // Sources for each interior cell colour
+    bayerSources g1Red  = c.g1RedVertical ? BS_VERTICAL : BS_HORIZONTAL;
+    bayerSources g1Blue = c.g1RedVertical ? BS_HORIZONTAL : BS_VERTICAL;
+    c.cells[CC_R].r  = BS_CENTRE;   c.cells[CC_R].g  = BS_CROSS;  c.cells[CC_R].b  = BS_DIAGONAL;
+    c.cells[CC_B].r  = BS_DIAGONAL; c.cells[CC_B].g  = BS_CROSS;  c.cells[CC_B].b  = BS_CENTRE;
+    c.cells[CC_G1].r = g1Red;       c.cells[CC_G1].g = BS_CENTRE; c.cells[CC_G1].b = g1Blue;
+    c.cells[CC_G2].r = g1Blue;      c.cells[CC_G2].g = BS_CENTRE; c.cells[CC_G2].b = g1Red;
+
+    const bool isMono = ( params.format == QE::Mono );
+    const long rowStep = (long)scanIn.inCount*scanIn.inInc + scanIn.outInc;   // Input index change per output row
+
+    if( scanIn.inInc == 1 || scanIn.inInc == -1 )
+    {
+        // Each output row is (part of) an input row
+        for( int i = firstRow; i < lastRow; i++ )
+        {
+            long dataIndex = scanIn.start + i*rowStep;
+            rgbPixel* out = dataOut + (long)i*scanIn.inCount;
+            int outStep = 1;
+            if( scanIn.inInc < 0 )
+            {
+                dataIndex -= scanIn.inCount-1;
+                out += scanIn.inCount-1;
+                outStep = -1;
+            }
+
+            if( isMono ) convertMono( c, dataIndex, scanIn.inCount, out, outStep, stats );
+            else         convertBayer( c, dataIndex, scanIn.inCount, out, outStep, stats );
+        }
+    }
+    else
+    {
+        // Each output row is an input column. Each input row provides one pixel for each output row.
+        // Work through the band a few output rows at a time so the output image columns being
+        // written remain in the cache.
+        for( int tileFirst = firstRow; tileFirst < lastRow; tileFirst += TILE_ROWS )
+        {
+            int tileLast = tileFirst + TILE_ROWS;
+            if( tileLast > lastRow )
+            {
+                tileLast = lastRow;
+            }
+            int count = tileLast-tileFirst;
+
+            for( int j = 0; j < scanIn.inCount; j++ )
+            {
+                long dataIndex = scanIn.start + (long)j*scanIn.inInc;
+                rgbPixel* out;
+                int outStep;
+                if( rowStep > 0 )
+                {
+                    dataIndex += tileFirst;
+                    out = dataOut + (long)tileFirst*scanIn.inCount + j;
+                    outStep = scanIn.inCount;
+                }
+                else
+                {
+                    dataIndex -= tileLast-1;
+                    out = dataOut + (long)(tileLast-1)*scanIn.inCount + j;
+                    outStep = -scanIn.inCount;
+                }
+
+                if( isMono ) convertMono( c, dataIndex, count, out, outStep, stats );
+                else         convertBayer( c, dataIndex, count, out, outStep, stats );
+            }
+        }
+    }
+}
+
+// end
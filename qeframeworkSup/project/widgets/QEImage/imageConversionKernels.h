@@ -0,0 +1,107 @@
+/*  imageConversionKernels.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Rhyder
+ *  Contact details:
+ *    andrew.rhyder@synchrotron.org.au
+ */
+
+#ifndef QE_IMAGE_CONVERSION_KERNELS_H
+#define QE_IMAGE_CONVERSION_KERNELS_H
+
+#include <QEEnums.h>
+#include <brightnessContrast.h>
+
+// Pixel statistics gathered while converting a band of image rows.
+// When an image is converted in several bands (in parallel) the statistics
+// for each band are merged once all bands are complete.
+struct imageBandStatistics
+{
+    unsigned int minP;                      // Minimum pixel value
+    unsigned int maxP;                      // Maximum pixel value
+    unsigned int bins[HISTOGRAM_BINS];      // Pixel histogram
+
+    void clear();                                   // Reset ready for accumulating statistics
+    void merge( const imageBandStatistics& other ); // Accumulate statistics from another band
+};
+
+/*!
+ Pixel conversion kernels used by imagePropertiesCore::buildImageCore() for Mono and Bayer image data.
+
+ Each kernel extracts each pixel, accumulates pixel statistics, scales the pixel for local brightness and
+ contrast, and selects the displayed pixel from the pixel lookup table, all in one pass.
+
+ The input data is processed in runs of consecutive pixels (each run maps to an output image row or
+ column depending on the scan option) so that SIMD instructions can be used regardless of rotation
+ and flipping. The SSE2 or AVX2 kernels are used as selected by QENumericKernels::instructionSet(),
+ with a portable fallback. Results are identical for all instruction sets.
+
+ If a full depth lookup table is available (see imageProcessor::getPixelTranslation()) each pixel
+ is converted with a single lookup. Otherwise each pixel is scaled for local brightness and contrast
+ before selecting the displayed pixel from the 256 entry lookup table.
+
+ The SIMD kernels are used for 1 byte per pixel data up to 8 bits deep and 2 byte per pixel data up
+ to 16 bits deep, when there is a full depth lookup table or the brightness and contrast pixel range
+ is no more than 65535. Other data is converted by the portable kernels.
+ */
+class imageConversionKernels
+{
+public:
+    // Information required to convert the image. Constant for the whole image.
+    struct parameters
+    {
+        QE::ImageFormatOptions format;                          // Mono or one of the Bayer formats
+        unsigned long width;                                    // Original image width
+        unsigned long height;                                   // Original image height
+        unsigned long bytesPerPixel;                            // Bytes in input data per pixel
+        unsigned int bitDepth;                                  // Bits per pixel used
+        int pixelLow;                                           // Pixel value displayed as black (before lookup)
+        int pixelHigh;                                          // Pixel value displayed as white (before lookup)
+        const imageDisplayProperties::rgbPixel* pixelLookup;   // Displayed pixel lookup table (256 entries)
+        const imageDisplayProperties::rgbPixel* fullPixelLookup;   // Displayed pixel lookup table indexed by pixel value (NULL if not available)
+        unsigned int fullPixelLookupSize;                       // Entries in fullPixelLookup
+    };
+
+    // Scan parameters (see imagePropertiesCore::buildImageCore() for details)
+    struct scan
+    {
+        int outCount;   // Outer loop count (output image rows)
+        int inCount;    // Inner loop count (output image columns)
+        int start;      // Input data start pixel (one of the four corners)
+        int outInc;     // Outer loop increment to input data index
+        int inInc;      // Inner loop increment to input data index
+    };
+
+    static bool isFormatSupported( QE::ImageFormatOptions format );     // Return true if the format is converted by these kernels
+    static bool isVectorised( const parameters& params );               // Return true if SIMD kernels will be used for these parameters
+
+    // Convert output image rows firstRow to lastRow-1, accumulating pixel statistics into stats.
+    static void buildBand( const parameters& params, const scan& scanIn,
+                           int firstRow, int lastRow,
+                           const unsigned char* dataIn,
+                           imageDisplayProperties::rgbPixel* dataOut,
+                           imageBandStatistics& stats );
+
+private:
+    imageConversionKernels();
+};
+
+#endif // QE_IMAGE_CONVERSION_KERNELS_H
@@ -29,6 +29,7 @@
  */
 
 #include "imageInfo.h"
+#include "imageProcessor.h"
 #include <QPainter>
 #define _USE_MATH_DEFINES
 #include <math.h>
@@ -40,6 +41,8 @@ imageInfo::imageInfo()
 {
     show = false;
     brief = false;
+    showPipeline = false;
+    showBeamStatistics = false;
 
     currentCursorPixelLabel = new QLabel();
     currentVertPixelLabel = new QLabel();
@@ -53,6 +56,8 @@ imageInfo::imageInfo()
     currentBeamLabel = new QLabel();
     currentPausedLabel = new QLabel();
     currentZoomLabel = new QLabel();
+    currentPipelineLabel = new QLabel();
+    currentBeamStatisticsLabel = new QLabel();
 
     updateIndicator = new imageUpdateIndicator();
 
@@ -73,6 +78,8 @@ imageInfo::imageInfo()
     infoLayout->addWidget( currentArea4Label, 2, 3 );
     infoLayout->addWidget( currentTargetLabel, 3, 0 );
     infoLayout->addWidget( currentBeamLabel, 3, 1 );
+    infoLayout->addWidget( currentPipelineLabel, 4, 0, 1, 4 );
+    infoLayout->addWidget( currentBeamStatisticsLabel, 5, 0, 1, 4 );
 }
 
 // Return the layout of the infomation area for insertion into the main QEImage widget
@@ -98,6 +105,40 @@ bool imageInfo::getBriefInfoArea()
     return brief;
 }
 
+void imageInfo::setShowPipelineInfo( const bool showPipelineIn )
+{
+    // Save the state
+    showPipeline = showPipelineIn;
+
+    // Update the info, only if currently shown
+    if( show )
+    {
+        showInfo( true );
+    }
+}
+
+bool imageInfo::getShowPipelineInfo()
+{
+    return showPipeline;
+}
+
+void imageInfo::setShowBeamStatistics( const bool showBeamStatisticsIn )
+{
+    // Save the state
+    showBeamStatistics = showBeamStatisticsIn;
+
+    // Update the info, only if currently shown
+    if( show )
+    {
+        showInfo( true );
+    }
+}
+
+bool imageInfo::getShowBeamStatistics()
+{
+    return showBeamStatistics;
+}
+
 // Display or hide the contents of the information area
 void imageInfo::showInfo( const bool showIn )
 {
@@ -117,6 +158,8 @@ void imageInfo::showInfo( const bool showIn )
         currentArea4Label->setHidden( brief );
         currentTargetLabel->setHidden( brief );
         currentBeamLabel->setHidden( brief );
+        currentPipelineLabel->setHidden( brief || !showPipeline );
+        currentBeamStatisticsLabel->setHidden( brief || !showBeamStatistics );
     }
     else
     {
@@ -133,6 +176,8 @@ void imageInfo::showInfo( const bool showIn )
         currentArea4Label->hide();
         currentTargetLabel->hide();
         currentBeamLabel->hide();
+        currentPipelineLabel->hide();
+        currentBeamStatisticsLabel->hide();
     }
 }
 
@@ -210,6 +255,18 @@ void imageInfo::infoUpdateZoom()
     currentZoomLabel->clear();
 }
 
+// Clear the image pipeline information
+void imageInfo::infoUpdatePipeline()
+{
+    currentPipelineLabel->clear();
+}
+
+// Clear the beam statistics information
+void imageInfo::infoUpdateBeamStatistics()
+{
+    currentBeamStatisticsLabel->clear();
+}
+
 
 
 // Update the target information
@@ -271,6 +328,41 @@ void imageInfo::infoUpdateRegion( const unsigned int region, const int x1, const
     }
 }
 
+// Update the region information, including statistics for the region
+void imageInfo::infoUpdateRegion( const unsigned int region, const int x1, const int y1, const int x2, const int y2,
+                                  const imageAreaStatistics& statistics )
+{
+    QString regionText = QString( "R%1: (%2,%3)(%4,%5)" ).arg( region ).arg( x1 ).arg( y1 ).arg( x2 ).arg( y2 );
+    if( statistics.valid )
+    {
+        regionText.append( QString( " sum %1, mean %2, max %3" ).arg( statistics.sum, 0, 'g', 6 )
+                                                               .arg( statistics.mean(), 0, 'f', 1 )
+                                                               .arg( statistics.maxP ) );
+    }
+
+    switch( region )
+    {
+    case 1:
+        currentArea1Label->setText( regionText );
+        break;
+
+    case 2:
+        currentArea2Label->setText( regionText );
+        break;
+
+    case 3:
+        currentArea3Label->setText( regionText );
+        break;
+
+    case 4:
+        currentArea4Label->setText( regionText );
+        break;
+
+    default:
+        break;
+    }
+}
+
 // Update the current pixel information
 void imageInfo::infoUpdatePixel( const QPoint pos, int value )
 {
@@ -309,6 +401,58 @@ void imageInfo::infoUpdateZoom( const int zoom, const double XStretch, const dou
     currentZoomLabel->setText( zoomText );
 }
 
+// Update the image pipeline information
+void imageInfo::infoUpdatePipeline( const imagePipelineStatistics& statistics )
+{
+    QString pipelineText;
+
+    // Format the image counts and the time taken by each stage
+    pipelineText = QString( "Images: %1 in, %2 built, %3 dropped, %4 shown  mS: decompress %5, convert %6, stats %7, analysis %8, paint %9" )
+                       .arg( statistics.received )
+                       .arg( statistics.built )
+                       .arg( statistics.dropped )
+                       .arg( statistics.displayed )
+                       .arg( statistics.decompressTime, 0, 'f', 1 )
+                       .arg( statistics.convertTime, 0, 'f', 1 )
+                       .arg( statistics.statisticsTime, 0, 'f', 1 )
+                       .arg( statistics.analysisTime, 0, 'f', 1 )
+                       .arg( statistics.paintTime, 0, 'f', 1 );
+
+    // Add any adaptive processing in effect
+    if( statistics.displayInterval > 1 )
+    {
+        pipelineText.append( QString( " (showing 1 in %1)" ).arg( statistics.displayInterval ) );
+    }
+    if( statistics.reducedStatistics )
+    {
+        pipelineText.append( " (reduced stats)" );
+    }
+
+    // Display the pipeline text
+    currentPipelineLabel->setText( pipelineText );
+}
+
+// Update the beam statistics information
+void imageInfo::infoUpdateBeamStatistics( const imageBeamStatistics& statistics )
+{
+    if( !statistics.valid )
+    {
+        currentBeamStatisticsLabel->clear();
+        return;
+    }
+
+    currentBeamStatisticsLabel->setText( QString( "Beam: centroid (%1,%2) rms (%3,%4) fwhm (%5,%6) peak %7 at (%8,%9)" )
+                                             .arg( statistics.centroid.x(), 0, 'f', 1 )
+                                             .arg( statistics.centroid.y(), 0, 'f', 1 )
+                                             .arg( statistics.rmsSize.x(), 0, 'f', 1 )
+                                             .arg( statistics.rmsSize.y(), 0, 'f', 1 )
+                                             .arg( statistics.fwhm.x(), 0, 'f', 1 )
+                                             .arg( statistics.fwhm.y(), 0, 'f', 1 )
+                                             .arg( statistics.peak )
+                                             .arg( statistics.peakPos.x() )
+                                             .arg( statistics.peakPos.y() ) );
+}
+
 // Update the 'new image' indicator
 void imageInfo::freshImage( QDateTime& time )
 {
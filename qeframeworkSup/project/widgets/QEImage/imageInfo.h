@@ -33,6 +33,10 @@
 #include <QDateTime>
 #include <QEFrameworkLibraryGlobal.h>
 
+class imagePipelineStatistics;    // differed
+struct imageAreaStatistics;       // differed
+struct imageBeamStatistics;       // differed
+
 #define UPDATE_INDICATOR_SIZE 20
 #define UPDATE_INDICATOR_STEPS 32
 
@@ -75,6 +79,8 @@ public:
 
     void infoUpdateRegion( const unsigned int region );                                             // Clear the region information
     void infoUpdateRegion( const unsigned int region, const int x1, const int y1, const int x2, const int y2 );// Update the region information
+    void infoUpdateRegion( const unsigned int region, const int x1, const int y1, const int x2, const int y2,
+                           const imageAreaStatistics& statistics );                                 // Update the region information, including statistics for the region
 
     void infoUpdatePixel();                                 // Clear the current pixel information
     void infoUpdatePixel( const QPoint pos, int value );    // Update the current pixel information
@@ -85,14 +91,28 @@ public:
     void infoUpdatePaused();                                 // Clear the 'paused' information
     void infoUpdatePaused( bool paused );                    // Update the 'paused' information
 
+    void infoUpdatePipeline();                                              // Clear the image pipeline information
+    void infoUpdatePipeline( const imagePipelineStatistics& statistics );   // Update the image pipeline information
+
+    void infoUpdateBeamStatistics();                                        // Clear the beam statistics information
+    void infoUpdateBeamStatistics( const imageBeamStatistics& statistics ); // Update the beam statistics information
+
     void setBriefInfoArea( const bool briefIn );            // Set if displaying all info, or a brief summary
     bool getBriefInfoArea();                                // Report if displaying all info, or a brief summary
 
+    void setShowPipelineInfo( const bool showPipelineIn );  // Set if displaying image pipeline information (not displayed in a brief summary)
+    bool getShowPipelineInfo();                             // Report if displaying image pipeline information
+
+    void setShowBeamStatistics( const bool showBeamStatisticsIn ); // Set if displaying beam statistics (not displayed in a brief summary)
+    bool getShowBeamStatistics();                           // Report if displaying beam statistics
+
     void freshImage( QDateTime& time );                     // Indicate another image has arrived
 
 private:
     bool show;
     bool brief;
+    bool showPipeline;
+    bool showBeamStatistics;
 
     QGridLayout* infoLayout;
     QLabel* currentCursorPixelLabel;
@@ -107,6 +127,8 @@ private:
     QLabel* currentBeamLabel;
     QLabel* currentPausedLabel;
     QLabel* currentZoomLabel;
+    QLabel* currentPipelineLabel;
+    QLabel* currentBeamStatisticsLabel;
 
     imageUpdateIndicator* updateIndicator;
 };
@@ -30,20 +30,81 @@
 
 #include "imageProcessor.h"
 #include "imageDataFormats.h"
+#include "imageConversionKernels.h"
+#include "decodedImageCache.h"
+#include "imageBandPool.h"
 #include <QDebug>
 #include <QMutexLocker>
 #include <QEEnums.h>
+#include <QECommon.h>
+#include <QEAdaptationParameters.h>
 #include <colourConversion.h>
 #include <math.h>
 
 #define DEBUG qDebug () << "imageProcessor" << __LINE__ << __FUNCTION__ << " "
 
+// Images with fewer pixels than this are built by the image processing thread alone
+#define MINIMUM_PARALLEL_PIXELS (256*256)
+
+// When only a region of the image is built, at least this many pixels are sampled when gathering statistics for the whole image
+#define MINIMUM_STATISTICS_PIXELS ((unsigned long)(256*256))
+
+// Only a region of the image is built if it is less than this proportion of the whole image
+#define MAXIMUM_REGION_PROPORTION 0.5
+
+// Deepest pixels for which a full depth pixel lookup table is generated (65536 entries)
+#define MAXIMUM_FULL_LOOKUP_DEPTH 16
+
+// Buffers kept for decompressing image data into.
+// Typically one is held by the widget (the current image), one is being decompressed into, and one is spare.
+#define DECOMPRESS_BUFFERS 3
+
+// Adaptive processing.
+// Processing is considered to be falling behind when the time to process each image is more than ADAPTIVE_HIGH_LOAD
+// of the time between images. Statistics work is reduced until the load falls below ADAPTIVE_LOW_LOAD.
+// When falling behind, only every Nth image is displayed, where N is chosen to bring the load back to ADAPTIVE_HIGH_LOAD.
+#define ADAPTIVE_HIGH_LOAD 0.9
+#define ADAPTIVE_LOW_LOAD 0.7
+#define ADAPTIVE_MAX_DISPLAY_INTERVAL 20   // Always display at least every Nth image
+#define ADAPTIVE_STATISTICS_INTERVAL 10    // When reducing statistics work, only publish statistics for every Nth image displayed
+
+// Weighting of each new time when averaging image pipeline times
+#define PIPELINE_AVERAGE_WEIGHT 0.1
+
 // Constructor
 imageProcessor::imageProcessor()
 {
     // Initialise
     next = NULL;
     finishNow = false;
+    compressedImagePending = false;
+    compressedImageId = 0;
+    newImagePending = false;
+    processingLoad = 0.0;
+    displaySkipCount = 0;
+    statisticsSkipCount = 0;
+
+    // Share the process wide pool of workers used to build bands of image rows in parallel.
+    imageBandPool::addUser();
+
+    QEAdaptationParameters ap( "QE_" );
+
+    // By default, convert Mono and Bayer pixels using a lookup table indexed by the pixel value
+    // rather than scaling each pixel for local brightness and contrast (see getPixelTranslation()).
+    useFullPixelLookup = ap.getInt( "image_full_depth_lookup", 1 ) != 0;
+
+    // Threads used by codecs (that support it) when decompressing image data.
+    codecThreads = ap.getInt( "image_codec_threads", QThread::idealThreadCount() );
+    codecThreads = LIMIT( codecThreads, 1, MAXIMUM_THREADS );
+
+    // By default, process every image regardless of how far processing falls behind
+    adaptiveProcessing = ap.getBool( "image_adaptive_processing" );
+
+    // By default, when only part of an image is displayed (for example, the image is zoomed) only build that part
+    useRegions = ap.getInt( "image_region_processing", 1 ) != 0;
+
+    // Image analysis results are delivered from the image processing thread
+    qRegisterMetaType<imageAnalysisResults>( "imageAnalysisResults" );
 
     // Manage image processing thread
     start();
@@ -74,6 +135,23 @@ imageProcessor::~imageProcessor()
 
     // Wait for the thread to exit
     wait();
+
+    // No longer using the shared band workers
+    imageBandPool::removeUser();
+
+    // No longer sharing decompressed images with other image processors
+    decodedImageCache::removeUser( imageSource );
+}
+
+// Add a new time (nS) to a recent average time (mS)
+static double pipelineAverage( double average, qint64 nSecs )
+{
+    double mSecs = (double)nSecs / 1000000.0;
+    if( average == 0.0 )
+    {
+        return mSecs;
+    }
+    return average + ( mSecs - average ) * PIPELINE_AVERAGE_WEIGHT;
 }
 
 // Image processing thread
@@ -111,8 +189,72 @@ void imageProcessor::run()
             // If any image data, process it
             if( core )
             {
+                // Decompress the image data if required.
+                // Return the decompressed image data to the widget for analysis before delivering the image.
+                qint64 decompressTime = 0;
+                if( core->isCompressed() )
+                {
+                    QString errorText;
+                    QElapsedTimer timer;
+                    timer.start();
+                    bool decompressed = core->decompressImage( getDecompressBuffer(), codecThreads, errorText );
+                    decompressTime = timer.nsecsElapsed();
+                    if( !decompressed )
+                    {
+                        // Skip if errorText same as last time
+                        if( errorText == previousDecompressText )
+                        {
+                            errorText.clear();
+                        }
+                        else
+                        {
+                            previousDecompressText = errorText;
+                        }
+                        emit imageBuilt( QImage(), errorText );
+                        if( core->isNewImage() )
+                        {
+                            imageDropped();
+                        }
+                        delete core;
+                        core = NULL;
+                        continue;
+                    }
+                    previousDecompressText.clear();
+                    emit imageDecompressed( core->getImageData(), core->getCompressedImageId() );
+                }
+
                 // Build the image
-                image = core->buildImageCore();
+                // If the shared band workers are in use by another image processor, build the image in this thread alone.
+                QE::WorkerManager* bandManager = imageBandPool::claim();
+                image = core->buildImageCore( bandManager );
+                if( bandManager )
+                {
+                    imageBandPool::release();
+                }
+
+                // Analyse the image according to the markups in use, and deliver the results ahead of the image
+                imageAnalysisResults analysis;
+                if( core->analyseImage( analysis ) )
+                {
+                    emit imageAnalysed( analysis );
+                }
+
+                // Update the image pipeline statistics (only for new images, not redisplays)
+                if( core->isNewImage() )
+                {
+                    QMutexLocker locker3( &pipelineLock );
+                    pipelineStats.built++;
+                    if( decompressTime )
+                    {
+                        pipelineStats.decompressTime = pipelineAverage( pipelineStats.decompressTime, decompressTime );
+                    }
+                    pipelineStats.convertTime    = pipelineAverage( pipelineStats.convertTime,    core->getConvertTime() );
+                    pipelineStats.statisticsTime = pipelineAverage( pipelineStats.statisticsTime, core->getStatisticsTime() );
+                    if( core->getAnalysisTime() )
+                    {
+                        pipelineStats.analysisTime = pipelineAverage( pipelineStats.analysisTime, core->getAnalysisTime() );
+                    }
+                }
 
                 // Deliver the image to the widget
                 emit imageBuilt( image, "" );
@@ -134,6 +276,13 @@ void imageProcessor::run()
 // Save the image data for analysis, processing and display
 void imageProcessor::setImage( const QByteArray& imageIn, unsigned long dataSize )
 {
+    // Any earlier compressed image data is no longer required
+    compressedImagePending = false;
+    compressedImage.clear();
+
+    // Note another image has arrived
+    imageReceived();
+
     // Save the current image
     imageData = imageIn;
     receivedImageSize = (unsigned long) imageData.size ();
@@ -147,6 +296,87 @@ void imageProcessor::setImage( const QByteArray& imageIn, unsigned long dataSize
     bytesPerPixel = imageDataSize * elementsPerPixel;
 }
 
+// Save compressed image data for processing and display.
+// The image data is decompressed by the image processing thread when the image is built, and is
+// then returned to the widget and saved for analysis using setDecompressedImage().
+// Until then, the previous image data is retained for analysis.
+void imageProcessor::setCompressedImage( const QENTNDArrayData& imageIn, unsigned long dataSize, const QCaDateTime& time )
+{
+    // Note another image has arrived
+    imageReceived();
+
+    // Save the current compressed image
+    compressedImage = imageIn;
+    compressedImagePending = true;
+    compressedImageId++;
+    compressedImageTime = time;
+    imageDataSize = dataSize;
+    bytesPerPixel = imageDataSize * elementsPerPixel;
+
+    // Ensure the retained image data is large enough for the current image dimensions
+    // as it will be used for analysis until the decompressed image data is available.
+    const unsigned long requiredSize = imageBuffWidth * imageBuffHeight * bytesPerPixel;
+    if( requiredSize > (unsigned long)imageData.size() )
+    {
+        imageData = QByteArray( (int)requiredSize, '\0' );
+    }
+}
+
+// Set the image source (PV name).
+// Decompressed images are shared with any other image processors displaying the same image source
+// so each image is only decompressed once. An empty source indicates there is no image source.
+void imageProcessor::setImageSource( const QString& source )
+{
+    if( source == imageSource )
+    {
+        return;
+    }
+
+    decodedImageCache::removeUser( imageSource );
+    imageSource = source;
+    decodedImageCache::addUser( imageSource );
+}
+
+// Save decompressed image data returned from the image processing thread.
+// Returns false if the image data is no longer required as later image data has been received.
+bool imageProcessor::setDecompressedImage( const QByteArray& imageIn, unsigned int imageId )
+{
+    if( !compressedImagePending || imageId != compressedImageId )
+    {
+        return false;
+    }
+
+    compressedImagePending = false;
+    compressedImage.clear();
+
+    imageData = imageIn;
+    receivedImageSize = (unsigned long) imageData.size ();
+    return true;
+}
+
+// Return a buffer to decompress image data into.
+// Buffers are reused once nothing else is referencing them (the widget has moved on to later
+// image data) to avoid allocating and clearing a large buffer for each image.
+// This is only used by the image processing thread.
+QByteArray& imageProcessor::getDecompressBuffer()
+{
+    for( int i = 0; i < decompressBuffers.count(); i++ )
+    {
+        if( decompressBuffers[i].isDetached() )
+        {
+            return decompressBuffers[i];
+        }
+    }
+
+    // No buffer available. Add another, dropping (our reference to) the oldest if there are enough already
+    if( decompressBuffers.count() >= DECOMPRESS_BUFFERS )
+    {
+        decompressBuffers.removeFirst();
+    }
+    decompressBuffers.append( QByteArray() );
+    return decompressBuffers.last();
+}
+
 // Generate a new image.
 // This is the first part of generating an image from new data.
 // most of the processing will occur in a seperate thread in imagePropertiesCore::buildImageCore()
@@ -155,9 +385,17 @@ void imageProcessor::buildImage()
     // Initially no errors
     QString errorText;
 
+    // Note if this is new image data, or a redisplay of the current image data
+    bool newImage = newImagePending;
+    newImagePending = false;
+
     // Do nothing if there is no image, or are no image dimensions yet
     if( imageData.isEmpty() || !imageBuffWidth || !imageBuffHeight )
     {
+        if( newImage )
+        {
+            imageDropped();
+        }
         emit imageBuilt( QImage(), errorText );
         return;
     }
@@ -171,6 +409,10 @@ void imageProcessor::buildImage()
         //
         if( receivedImageSize == 0 )
         {
+            if( newImage )
+            {
+                imageDropped();
+            }
             emit imageBuilt( QImage(), errorText );
             return;
         }
@@ -205,10 +447,41 @@ void imageProcessor::buildImage()
     unsigned long pixelCount = imageBuffWidth*imageBuffHeight;
     if( pixelCount * bytesPerPixel > (unsigned long)imageData.size() )
     {
+        if( newImage )
+        {
+            imageDropped();
+        }
         emit imageBuilt( QImage(), errorText ); // !!! should clear the image by delivering non null blank image???
         return;
     }
 
+    // If processing is falling behind and adaptive processing is only displaying every Nth image, skip this image if required.
+    // Note, the image data is still available for analysis. (Unless it is compressed. Compressed image data is only
+    // decompressed when building an image, so analysis will continue to use the last image data built)
+    // Also, if reducing statistics work, only publish statistics periodically.
+    bool reducedStatistics = false;
+    if( newImage && adaptiveProcessing )
+    {
+        QMutexLocker locker( &pipelineLock );
+        if( displaySkipCount+1 < pipelineStats.displayInterval )
+        {
+            displaySkipCount++;
+            pipelineStats.dropped++;
+            return;
+        }
+        displaySkipCount = 0;
+
+        if( pipelineStats.reducedStatistics && statisticsSkipCount+1 < ADAPTIVE_STATISTICS_INTERVAL )
+        {
+            reducedStatistics = true;
+            statisticsSkipCount++;
+        }
+        else
+        {
+            statisticsSkipCount = 0;
+        }
+    }
+
     // Get the pixel lookup table to convert raw pixel values to display pixel values taking into
     // account input pixel size, clipping, contrast reversal, and local brightness and contrast.
     if( !pixelLookupValid )
@@ -221,27 +494,39 @@ void imageProcessor::buildImage()
         QMutexLocker locker( &imageLock );
 
         // If there is earlier image data that is yet to be processed, discard it.
+        // If the earlier image data was new, then either it has been superseded by later
+        // image data, or this is a redisplay of the same image data which now becomes the new image.
         if( next )
         {
+            if( next->isNewImage() )
+            {
+                if( newImage )
+                {
+                    imageDropped();
+                }
+                newImage = true;
+            }
             delete next;
             next = NULL;
         }
 
         // Package up the current image data and all related information
-        next = new imagePropertiesCore( imageData,
-                                        imageBuffWidth,
-                                        imageBuffHeight,
-                                        getScanOption(),
-                                        bytesPerPixel,
-                                        pixelLow,
-                                        pixelHigh,
-                                        bitDepth,
-                                        pixelLookup,
-                                        formatOption,
-                                        imageDataSize,
-                                        imageDisplayProps,
-                                        rotatedImageBuffWidth(),
-                                        rotatedImageBuffHeight() );
+        next = newImageCore();
+
+        // If only part of the image is displayed (for example, the image is zoomed) only build that part
+        next->setRegion( getBuildRegion() );
+
+        // Note if this is a new image (for image pipeline statistics), and if statistics may be skipped
+        next->setPipelineOptions( newImage, reducedStatistics );
+
+        // Analyse the image according to the markups in use
+        next->setAnalysisRequest( analysisRequest );
+
+        // If the image data is still compressed, the image processing thread will decompress it
+        if( compressedImagePending )
+        {
+            next->setCompressedImage( compressedImage, compressedImageId, imageSource, compressedImageTime );
+        }
     }
 
 // For testing you can include the following two lines to skip processing
@@ -253,6 +538,163 @@ void imageProcessor::buildImage()
     imageSync.wakeOne();
 }
 
+// Package up the current image data along with all the information needed to process it and generate a QImage.
+imagePropertiesCore* imageProcessor::newImageCore()
+{
+    return new imagePropertiesCore( imageData,
+                                    imageBuffWidth,
+                                    imageBuffHeight,
+                                    getScanOption(),
+                                    bytesPerPixel,
+                                    pixelLow,
+                                    pixelHigh,
+                                    bitDepth,
+                                    pixelLookup,
+                                    fullPixelLookup,
+                                    formatOption,
+                                    imageDataSize,
+                                    imageDisplayProps,
+                                    rotatedImageBuffWidth(),
+                                    rotatedImageBuffHeight() );
+}
+
+// Set the area of the image that is displayed (in displayed image orientation, before zooming).
+// This may include a margin around the area actually visible to allow some scrolling before a rebuild is required.
+// A null rectangle indicates the whole image is displayed, or the displayed area is not known.
+void imageProcessor::setDisplayedArea( const QRect& area )
+{
+    displayedArea = area;
+}
+
+// Return the region of the image to build.
+// If only a small part of the image is displayed, only that part is built.
+// Otherwise a null rectangle is returned and the whole image is built.
+QRect imageProcessor::getBuildRegion()
+{
+    if( !useRegions || displayedArea.isNull() )
+    {
+        return QRect();
+    }
+
+    QRect wholeImage( 0, 0, rotatedImageBuffWidth(), rotatedImageBuffHeight() );
+    QRect area = displayedArea & wholeImage;
+    if( area.isEmpty() ||
+        (double)area.width()*area.height() >= MAXIMUM_REGION_PROPORTION * (double)wholeImage.width()*wholeImage.height() )
+    {
+        return QRect();
+    }
+    return area;
+}
+
+// Clear all image pipeline statistics counts and times
+void imagePipelineStatistics::clear()
+{
+    received = 0;
+    built = 0;
+    dropped = 0;
+    displayed = 0;
+
+    decompressTime = 0.0;
+    convertTime = 0.0;
+    statisticsTime = 0.0;
+    analysisTime = 0.0;
+    paintTime = 0.0;
+    arrivalInterval = 0.0;
+
+    reducedStatistics = false;
+    displayInterval = 1;
+}
+
+// Return the current image pipeline statistics
+imagePipelineStatistics imageProcessor::getPipelineStatistics()
+{
+    QMutexLocker locker( &pipelineLock );
+    return pipelineStats;
+}
+
+// Clear the image pipeline statistics.
+// This also restarts adaptive processing.
+void imageProcessor::resetPipelineStatistics()
+{
+    QMutexLocker locker( &pipelineLock );
+    pipelineStats.clear();
+    arrivalTimer.invalidate();
+    processingLoad = 0.0;
+    displaySkipCount = 0;
+    statisticsSkipCount = 0;
+}
+
+// Set adaptive processing.
+// If true, statistics work is reduced, and then only every Nth image is displayed, when processing falls behind.
+void imageProcessor::setAdaptiveProcessing( bool adaptiveProcessingIn )
+{
+    QMutexLocker locker( &pipelineLock );
+    adaptiveProcessing = adaptiveProcessingIn;
+    pipelineStats.reducedStatistics = false;
+    pipelineStats.displayInterval = 1;
+    displaySkipCount = 0;
+    statisticsSkipCount = 0;
+}
+
+// Note an image has been received, and update the adaptive processing state.
+// This is called from the QEImage thread as each image arrives.
+void imageProcessor::imageReceived()
+{
+    newImagePending = true;
+
+    QMutexLocker locker( &pipelineLock );
+    pipelineStats.received++;
+
+    // Update the average time between images
+    if( arrivalTimer.isValid() )
+    {
+        pipelineStats.arrivalInterval = pipelineAverage( pipelineStats.arrivalInterval, arrivalTimer.nsecsElapsed() );
+    }
+    arrivalTimer.start();
+
+    // Determine how busy the image pipeline is, as a proportion of the time between images.
+    // The image processing thread and the QEImage thread (painting) work in parallel, so the busiest of the two determines if processing is falling behind.
+    double processingTime = pipelineStats.decompressTime + pipelineStats.convertTime + pipelineStats.statisticsTime + pipelineStats.analysisTime;
+    double busyTime = MAX( processingTime, pipelineStats.paintTime );
+    processingLoad = ( pipelineStats.arrivalInterval > 0.0 ) ? busyTime / pipelineStats.arrivalInterval : 0.0;
+
+    // Nothing more to do if not adapting to the load
+    if( !adaptiveProcessing )
+    {
+        return;
+    }
+
+    // Reduce statistics work while processing is falling behind
+    if( processingLoad > ADAPTIVE_HIGH_LOAD )
+    {
+        pipelineStats.reducedStatistics = true;
+    }
+    else if( processingLoad < ADAPTIVE_LOW_LOAD )
+    {
+        pipelineStats.reducedStatistics = false;
+    }
+
+    // Display only enough images for processing to keep up
+    int interval = (int)ceil( processingLoad );
+    pipelineStats.displayInterval = LIMIT( interval, 1, ADAPTIVE_MAX_DISPLAY_INTERVAL );
+}
+
+// Note an image has been received but will not be built
+void imageProcessor::imageDropped()
+{
+    QMutexLocker locker( &pipelineLock );
+    pipelineStats.dropped++;
+}
+
+// Note an image has been painted.
+// This is called from the QEImage thread.
+void imageProcessor::imagePainted( qint64 paintNSecs )
+{
+    QMutexLocker locker( &pipelineLock );
+    pipelineStats.displayed++;
+    pipelineStats.paintTime = pipelineAverage( pipelineStats.paintTime, paintNSecs );
+}
+
 // Package up image data along with all the information
 // needed to process it and generate a QImage.
 imagePropertiesCore::imagePropertiesCore( QByteArray imageDataIn,
@@ -264,6 +706,7 @@ imagePropertiesCore::imagePropertiesCore( QByteArray imageDataIn,
                                           int pixelHighIn,
                                           unsigned int bitDepthIn,
                                           imageDisplayProperties::rgbPixel* pixelLookupIn,
+                                          const QVector<imageDisplayProperties::rgbPixel>& fullPixelLookupIn,
                                           QE::ImageFormatOptions formatOptionIn,
                                           unsigned long imageDataSizeIn,
                                           imageDisplayProperties* imageDisplayPropsIn,
@@ -279,624 +722,340 @@ imagePropertiesCore::imagePropertiesCore( QByteArray imageDataIn,
     pixelHigh = pixelHighIn;
     bitDepth = bitDepthIn;
     pixelLookup = pixelLookupIn;
+    fullPixelLookup = fullPixelLookupIn;
     formatOption = formatOptionIn;
     imageDataSize = imageDataSizeIn;
     imageDisplayProps = imageDisplayPropsIn;
     rotatedImageBuffWidth = rotatedImageBuffWidthIn;
     rotatedImageBuffHeight = rotatedImageBuffHeightIn;
+
+    compressed = false;
+    compressedImageId = 0;
+
+    newImage = false;
+    reducedStatistics = false;
+    convertTime = 0;
+    statisticsTime = 0;
+    analysisTime = 0;
+}
+
+// Note if this is a new image (not a redisplay of the current image data), for image pipeline statistics,
+// and if statistics need not be published for this image as adaptive processing is reducing statistics work.
+void imagePropertiesCore::setPipelineOptions( bool newImageIn, bool reducedStatisticsIn )
+{
+    newImage = newImageIn;
+    reducedStatistics = reducedStatisticsIn;
+}
+
+// Note compressed image data that must be decompressed by decompressImage() before the image is built.
+// Until then, the image data is the previous image data.
+void imagePropertiesCore::setCompressedImage( const QENTNDArrayData& compressedImageIn, unsigned int compressedImageIdIn,
+                                              const QString& imageSourceIn, const QCaDateTime& imageTimeIn )
+{
+    compressedImage = compressedImageIn;
+    compressedImageId = compressedImageIdIn;
+    imageSource = imageSourceIn;
+    imageTime = imageTimeIn;
+    compressed = true;
+}
+
+// Decompress the image data.
+// This is performed by the image processing thread, rather than when the compressed image data is received,
+// as decompressing a large image can take some time.
+// If other image processors are displaying the same image source, the image is only decompressed once
+// and the decompressed image data is shared (see decodedImageCache).
+// Returns false (with an error message) if the image data could not be decompressed.
+bool imagePropertiesCore::decompressImage( QByteArray& buffer, int codecThreads, QString& errorText )
+{
+    // Use the decompressed image data if another image processor has already decompressed this image.
+    // (Note, before decompression the data is the compressed data)
+    const int compressedSize = compressedImage.getData().size();
+    const int uniqueId = compressedImage.getUniqueId();
+    decodedImageCache::claimResults claim = decodedImageCache::claim( imageSource, imageTime, uniqueId, compressedSize, imageData );
+    if( claim != decodedImageCache::CLAIM_FOUND )
+    {
+        if( !compressedImage.decompressData( buffer, codecThreads ) )
+        {
+            if( claim == decodedImageCache::CLAIM_DECODE )
+            {
+                decodedImageCache::abandon( imageSource, imageTime, uniqueId, compressedSize );
+            }
+            errorText = QString( "Could not decompress image data (codec: %1)" ).arg( compressedImage.getCodecName() );
+            return false;
+        }
+
+        imageData = compressedImage.getData();
+        if( claim == decodedImageCache::CLAIM_DECODE )
+        {
+            decodedImageCache::publish( imageSource, imageTime, uniqueId, compressedSize, imageData );
+        }
+    }
+    compressedImage.clear();
+    compressed = false;
+
+    // If not enough image data for the expected size then zero extend (as per imageProcessor::buildImage()).
+    const unsigned long requiredSize = imageBuffWidth * imageBuffHeight * bytesPerPixel;
+    if( requiredSize > (unsigned long)imageData.size() )
+    {
+        int extra = (int)requiredSize - imageData.size();
+        QByteArray zero_extend ( extra, '\0' );
+        imageData.append( zero_extend );
+    }
+    return true;
 }
 
 // Generate a new image.
 // This is the second part of generating an image from new data.
 // The image is generated in a seperate thread after preperation by imageProcessor::buildImage()
-QImage imagePropertiesCore::buildImageCore()
+// If a set of workers is available, the image rows are split into bands which are built in parallel.
+// If only a region of the image is required, only that region is built. The image offset is set to
+// the position of the region within the whole image.
+QImage imagePropertiesCore::buildImageCore( QE::WorkerManager* workers )
 {
-    // Create image ready for building the image data
-    QImage image( rotatedImageBuffWidth, rotatedImageBuffHeight, QImage::Format_RGB32 );
-
-    // Set up input and output pointers and counters ready to process each pixel
+    // Set up input pointer ready to process each pixel
     // Note, must be constData() - not data() - to avoid a reallocation of the data
-    const unsigned char* dataIn = (unsigned char*)imageData.constData();
-    // constBits is 4.8 or later. We want the read/write bits anyway.
-    imageDisplayProperties::rgbPixel* dataOut = (imageDisplayProperties::rgbPixel*)(image.bits());
-    unsigned long buffIndex = 0;
-    unsigned long dataIndex = 0;
+    dataIn = (unsigned char*)imageData.constData();
 
+    // Set the loop parameters according to the scan option.
     // Depending on the flipping and rotating options pixel drawing can start in any of
     // the four corners and start scanning either vertically or horizontally.
-    // See getScanOption() comments for more details on how the rotate and flip
-    // options are used to generate one of 8 scan options.
-    // The 8 scanning options are shown numbered here:
-    //
-    //    o----->1         2<-----o
-    //    |                       |
-    //    |                       |
-    //    |                       |
-    //    v                       v
-    //    5                       6
-    //
-    //
-    //
-    //    7                       8
-    //    ^                       ^
-    //    |                       |
-    //    |                       |
-    //    |                       |
-    //    o----->3         4<-----o
-    //
-
     // Drawing is performed in two nested loops, one for height and one for width.
-    // Depending on the scan option, however, the outer may be height or width.
-    // The input buffer is read consecutivly from first pixel to last and written to the
-    // output buffer, which is moved to the next pixel by both the inner and outer
-    // loops to where ever that next pixel is according to the rotation and flipping.
-    // The following defines parameters driving the loops:
-    //
-    // opt      = scan option
-    // outCount = outer loop count (width or height);
-    // inCount  = inner loop count (height or width)
-    // start    = output buffer start pixel (one of the four corners)
-    // outInc   = outer loop increment to output buffer
-    // inInc    = inner loop increment to output buffer
-    // w        = image width
-    // h        = image height
+    // The output buffer is written consecutivly from first pixel to last and read from the
+    // input buffer, which is moved to the next pixel by both the inner and outer loops.
+    // See imageScan for the loop parameters used for each scan option.
     //
-    // opt outCount inCount start    outInc   inInc
-    //  1      h       w      0         0       1
-    //  2      h       w      w-1       w      -1
-    //  3      h       w    w*(h-1)    -2*w     1
-    //  4      h       w    (w*h)-1     0      -1
-    //  5      w       h      0     -w*(h-1)+1   w
-    //  6      w       h      w-1   -w*(h-1)-1   w
-    //  7      w       h    w*(h-1)  w*(h-1)+1  -w
-    //  8      w       h    (w*h)-1  w*(h-1)-1  -w
-
-
-    int outCount;   // Outer loop count (width or height);
-    int inCount;    // Inner loop count (height or width)
-    int start;      // Output buffer start pixel (one of the four corners)
-    int outInc;     // Outer loop increment to output buffer
-    int inInc;      // Inner loop increment to output buffer
-    int h = imageBuffHeight;
-    int w = imageBuffWidth;
-
-    // Set the loop parameters according to the scan option
-    switch( scanOption )
+    // Each outer loop iteration generates one row of the output image, and moves the
+    // input buffer index by (inCount*inInc)+outInc, which is constant for each scan option.
+    // This allows the output rows to be split into bands that can be built independently.
+    imageScan scan( scanOption, imageBuffWidth, imageBuffHeight );
+    outCount = scan.outCount;
+    inCount = scan.inCount;
+    start = scan.start;
+    outInc = scan.outInc;
+    inInc = scan.inInc;
+
+    // If only a region of the image is required (for example, the image is zoomed and only part of it is visible)
+    // then only build that region.
+    // Each output row of the region is part of an output row of the whole image, so the loops are the same,
+    // just starting at the first pixel of the region and with fewer rows and columns.
+    QRect wholeImage( 0, 0, rotatedImageBuffWidth, rotatedImageBuffHeight );
+    QRect builtArea = region.isNull() ? wholeImage : ( region & wholeImage );
+    if( builtArea.isEmpty() )
+    {
+        builtArea = wholeImage;
+    }
+    const bool partial = ( builtArea != wholeImage );
+    if( partial )
     {
-        default:  // Sanity check. default to 1
-        case 1: outCount = h; inCount = w; start = 0;       outInc =  0;     inInc =  1; break;
-        case 2: outCount = h; inCount = w; start = w-1;     outInc =  2*w;   inInc = -1; break;
-        case 3: outCount = h; inCount = w; start = w*(h-1); outInc = -2*w;   inInc =  1; break;
-        case 4: outCount = h; inCount = w; start = (w*h)-1; outInc =  0;     inInc = -1; break;
-        case 5: outCount = w; inCount = h; start = 0;       outInc = -w*h+1; inInc =  w; break;
-        case 6: outCount = w; inCount = h; start = w-1;     outInc = -w*h-1; inInc =  w; break;
-        case 7: outCount = w; inCount = h; start = w*(h-1); outInc =  w*h+1; inInc = -w; break;
-        case 8: outCount = w; inCount = h; start = (w*h)-1; outInc =  w*h-1; inInc = -w; break;
+        const long rowStep = (long)inCount*inInc + outInc;  // Input index change per output row
+        start += builtArea.top()*rowStep + builtArea.left()*inInc;
+        outCount = builtArea.height();
+        inCount = builtArea.width();
+        outInc = rowStep - (long)inCount*inInc;
     }
 
+    // Create image ready for building the image data
+    QImage image( builtArea.width(), builtArea.height(), QImage::Format_RGB32 );
+    image.setOffset( builtArea.topLeft() );
 
+    // Set up output pointer ready to process each pixel
+    // constBits is 4.8 or later. We want the read/write bits anyway.
+    // Note, RGB32 scan lines are always 32 bit aligned, so there is no padding between output rows.
+    dataOut = (imageDisplayProperties::rgbPixel*)(image.bits());
 
     // Draw the input pixels into the image buffer.
-    // Drawing is performed in two nested loops, one for height and one for width.
-    // Depending on the scan option, however, the outer may be height or width.
-    // The input buffer is read consecutively from first pixel to last and written to the
-    // output buffer, which is moved to the next pixel by both the inner and outer
-    // loops to where ever that next pixel is according to the rotation and flipping.
-    dataIndex = start;
-
-    unsigned int pixelRange = pixelHigh-pixelLow;
-    if( !pixelRange )
+    QElapsedTimer timer;
+    timer.start();
+    imageBandStatistics stats;
+    buildBands( workers, stats );
+    convertTime = timer.nsecsElapsed();
+
+    // If only part of the image was built, the statistics gathered only reflect that part.
+    // Gather statistics for the whole image from a sample of the image data, sampling about as many
+    // pixels as were built. The minimum and maximum also include all pixels that were built.
+    // (Skipped if adaptive processing is reducing statistics work)
+    if( partial && !reducedStatistics )
     {
-        pixelRange = 1;
+        imageBandStatistics sampledStats;
+        sampleStatistics( workers, MAX( (unsigned long)outCount*inCount, MINIMUM_STATISTICS_PIXELS ), sampledStats );
+        sampledStats.minP = MIN( sampledStats.minP, stats.minP );
+        sampledStats.maxP = MAX( sampledStats.maxP, stats.maxP );
+        stats = sampledStats;
     }
 
-    unsigned int mask = ((unsigned long)(1)<<bitDepth)-1;
-
-    // Prepare for building image stats while processing image data
-    unsigned int maxP = 0;
-    unsigned int minP = UINT_MAX;
-    unsigned int valP;
-    unsigned int binShift = (bitDepth<8)?0:bitDepth-8;
-    unsigned int bin;
-    unsigned int bins[HISTOGRAM_BINS]; // Bins used for generating a pixel histogram
-    for( int i = 0; i < HISTOGRAM_BINS; i++ )
+    // Update the image display properties controls if present.
+    // (Skipped if adaptive processing is reducing statistics work)
+    if( imageDisplayProps && !reducedStatistics )
     {
-        bins[i]=0;
+        imageDisplayProps->setStatistics( stats.minP, stats.maxP, bitDepth, stats.bins, pixelLookup );
     }
-#define BUILD_STATS \
-    bin = valP>>binShift; \
-    bins[bin] = bins[bin]+1; \
-    if( valP < minP ) minP = valP; \
-    else if( valP > maxP ) maxP = valP;
+    statisticsTime = timer.nsecsElapsed() - convertTime;
 
-// For speed, the format switch statement is outside the pixel loop.
-// An identical(ish) loop is used for each format
-#define LOOP_START                          \
-    for( int i = 0; i < outCount; i++ )     \
-    {                                       \
-        for( int j = 0; j < inCount; j++ )  \
-        {
+    // Return the image
+    return image;
+}
 
-#define LOOP_END                            \
-            dataIndex += inInc;             \
-            buffIndex++;                    \
-        }                                   \
-        dataIndex += outInc;                \
+// Analyse the image data according to the markups in use (beam statistics, selected area statistics and profiles).
+// This is performed by the image processing thread once the image is built so the results can be delivered with the image.
+// Returns false if no analysis was required. While adaptive processing is reducing statistics work, the beam
+// statistics are not generated, but the rest of the analysis is still performed.
+bool imagePropertiesCore::analyseImage( imageAnalysisResults& results )
+{
+    if( compressed )
+    {
+        return false;
     }
 
-    // Format each pixel ready for use in an RGB32 QImage.
-    // Note, for speed, the switch on format is outside the loop. The loop is duplicated in each case using macros.
-    switch( formatOption )
+    // When statistics work is being reduced, skip the beam statistics (which examine the whole image),
+    // but still analyse for the markups so the widget does not have to analyse them itself.
+    imageAnalysisRequest request = analysisRequest;
+    if( reducedStatistics )
     {
-        case QE::Mono:
-        {
-            LOOP_START
-                unsigned int inPixel;
-
-                // Extract pixel
-                inPixel =  (*(unsigned int*) (&dataIn[dataIndex*bytesPerPixel]))&mask;
-
-                // Accumulate pixel statistics
-                valP = inPixel;
-                BUILD_STATS
+        request.beamStatistics = false;
+    }
+    if( request.isEmpty() )
+    {
+        return false;
+    }
 
-                // Scale pixel for local brightness and contrast
-                ( (int)inPixel < pixelLow ) ? inPixel = 0 : ( (int)inPixel > pixelHigh ) ? inPixel = 255 : inPixel = ((int)inPixel-pixelLow)*255/pixelRange;
+    QElapsedTimer timer;
+    timer.start();
+    imageAnalysis analysis( imageData, imageBuffWidth, imageBuffHeight, scanOption, bytesPerPixel, formatOption, bitDepth, imageDataSize );
+    analysis.analyse( request, results );
+    analysisTime = timer.nsecsElapsed();
+    return true;
+}
 
-                // Select displayed pixel
-                dataOut[buffIndex] = pixelLookup[inPixel];
-            LOOP_END
-            break;
-        }
+// Build all output rows (as currently set up in dataIn, dataOut and the scan parameters) and accumulate pixel statistics.
+// Small images are not worth the overhead of distributing the work.
+void imagePropertiesCore::buildBands( QE::WorkerManager* workers, imageBandStatistics& stats )
+{
+    if( workers && workers->getNumber() > 1 && (unsigned long)outCount*inCount >= MINIMUM_PARALLEL_PIXELS )
+    {
+        // Each worker builds a band of rows and accumulates its own statistics.
+        // Merge the statistics once all bands are complete.
+        imageBandPackage package( this, workers->getNumber() );
+        workers->processAndWait( &package );
 
-        case QE::BayerGB:
-        case QE::BayerBG:
-        case QE::BayerGR:
-        case QE::BayerRG:
+        stats = package.stats[0];
+        for( int i = 1; i < package.stats.count(); i++ )
         {
-            // Pre-calculate offsets in the data to neighbouring pixels
-            int TLOffset = (-(int)(imageBuffWidth)-1)*(int)(bytesPerPixel);
-            int  TOffset = -(int)(imageBuffWidth)*(int)(bytesPerPixel);
-            int TROffset = (-(int)(imageBuffWidth)+1)*(int)(bytesPerPixel);
-            int  LOffset = -(int)(bytesPerPixel);
-            int  ROffset = (int)(bytesPerPixel);
-            int BLOffset = ((int)(imageBuffWidth)-1)*(int)(bytesPerPixel);
-            int  BOffset = imageBuffWidth*(int)(bytesPerPixel);
-            int BROffset = ((int)(imageBuffWidth)+1)*(int)(bytesPerPixel);
-
-            // Define regions in the image where different calculations occur.
-            // Over most of the image four neighbouring cells are available.
-            // On the sides five neighbours are present.
-            // On the corners three neighbours are present.
-            enum regions {REG_TL, REG_T, REG_TR, REG_L, REG_C, REG_R, REG_BL, REG_B, REG_BR};
-
-            // Values for all cells that may be involved in generating a pixel
-            quint32 g1; // Green above blue or red
-            quint32 g2; // Green below of blue or red
-            quint32 g3; // Green left of blue or red
-            quint32 g4; // Green right of blue or red
-
-            quint32 d1; // Red or blue diagonally above-left of blue or red
-            quint32 d2; // Red or blue diagonally above-right of blue or red
-            quint32 d3; // Red or blue diagonally below-left of blue or red
-            quint32 d4; // Red or blue diagonally below-right of blue or red
-
-            quint32 d;  // Sum of reds or blues diagonally sourounding current blue or red
-
-            quint32 rb; // Red or blue from current cell (depending on pattern)
-
-            quint32 h1; // Left of green (may be red or blue depending on pattern)
-            quint32 h2; // Right of green (may be red or blue depending on pattern)
-            quint32 v1; // Above green (may be red or blue depending on pattern)
-            quint32 v2; // Below green (may be red or blue depending on pattern)
-
-            quint32 h;  // Sum of left and right or green (horizontal) (may be red or blue depending on pattern)
-            quint32 v;  // Sum of above and below green (vertical) (may be red or blue depending on pattern)
-
-            quint32 g12;// Green (either Green1 or Green 2)
-
-            quint32* g1r; // Pointer to red sum for Green1 (may be h (left and right) or v (above and below) depending on pattern)
-            quint32* g2r; // Pointer to red sum for Green2 (may be h (left and right) or v (above and below) depending on pattern)
-            quint32* g1b; // Pointer to blue sum for Green1 (may be h (left and right) or v (above and below) depending on pattern)
-            quint32* g2b; // Pointer to blue sum for Green2 (may be h (left and right) or v (above and below) depending on pattern)
-
-            // Pixel RGB values
-            quint32 r;
-            quint32 g;
-            quint32 b;
-
-            // Each Bayer cluster of four image cells contain one red, one blue, and two green values.
-            // There are four combinations for each cluster and no standard :(
-            // Preconfigure a table to translate from cluster cell index to color.
-            enum CELL_COLOURS {CC_G1, CC_G2,CC_R,CC_B};
-            CELL_COLOURS cellColours[4];
-            switch( formatOption )
-            {
-                default:    // Should never hit the default case. Include to avoid compilation errors
-                case QE::BayerGB: cellColours[0] = CC_G1; cellColours[1] = CC_B;  cellColours[2] = CC_R;  cellColours[3] = CC_G2; break;
-                case QE::BayerBG: cellColours[0] = CC_B;  cellColours[1] = CC_G1; cellColours[2] = CC_G2; cellColours[3] = CC_R;  break;
-                case QE::BayerGR: cellColours[0] = CC_G1; cellColours[1] = CC_R;  cellColours[2] = CC_B;  cellColours[3] = CC_G2; break;
-                case QE::BayerRG: cellColours[0] = CC_R;  cellColours[1] = CC_G1; cellColours[2] = CC_G2; cellColours[3] = CC_B;  break;
-            }
-
-            // Preconfigure red and blue positions relative to green. Depending on the Bayer pattern
-            // red can be left and right, and blue above and below, or the other way round
-            switch( formatOption )
-            {
-                default:    // Should never hit the default case. Include to avoid compilation errors
-                case QE::BayerGB:
-                case QE::BayerBG:
-                    g1r = &v; // Use vertical (v) for reds associated with Green1
-                    g1b = &h; // Use horizontal (h) for blues associated with Green1
-                    g2r = &h; // Use horizontal (h) for reds associated with Green2
-                    g2b = &v; // Use vertical (v) for blues associated with Green2
-                    break;
-
-                case QE::BayerGR:
-                case QE::BayerRG:
-                    g1r = &h; // Use horizontal (h) for reds associated with Green1
-                    g1b = &v; // Use vertical (v) for blues associated with Green1
-                    g2r = &v; // Use vertical (v) for reds associated with Green2
-                    g2b = &h; // Use horizontal (h) for blues associated with Green2
-                    break;
-            }
-
-            // Pre-calculate last cell for inner and outer loops
-            int outLast = outCount-1;
-            int inLast = inCount-1;
-
-            // Pre-calculate pixel index values for corners
-            unsigned int TLPixel = 0;
-            unsigned int TRPixel = imageBuffWidth-1;
-            unsigned int BLPixel = (imageBuffHeight-1)*imageBuffWidth;
-            unsigned int BRPixel = (imageBuffHeight*imageBuffWidth)-1;
-
-            // Processing region (corners, edges, or central)
-            regions region;
-
-            // Pre-calculate data shift and mask nessesary to obtain most significant 8 bits
-            int shift = (bitDepth<=8)?0:bitDepth-8;
-            quint32 mask = ((unsigned long)(1)<<bitDepth)-1;
-
-            // Loop through the input data
-            // The loop order is based on current flip and rotation and so will not nessesarily
-            // move linearly through input data. No matter what the order of processing neighbouring
-            // cells are referenced the same way.
-            LOOP_START
-
-                // Get a reference to the current 'pixel'
-                unsigned char* inPixel  = (unsigned char*)(&dataIn[dataIndex*bytesPerPixel]);
-
-                // Calculate the current Bayer cell. (one of four as follows)
-                //   01010101010101010101...
-                //   23232323232323232323...
-                //   01010101010101010101...
-                //   23232323232323232323...
-                //   01010101010101010101...
-                //   23232323232323232323...
-                //   .......................
-                //   .......................
-                //   .......................
-                //
-                unsigned int color = (dataIndex&1)|(((dataIndex/imageBuffWidth)&1)<<1);
-
-                // Translate the bayer cell to a color
-                // Depending on the specific bayer pattern the color number is interpreted as follows
-                //
-                // BayerBG = 01 = BG
-                //           23   GR
-                //
-                // BayerGB = 01 = GB
-                //           23   RG
-                //
-                // BayerRG = 01 = RG
-                //           23   GB
-                //
-                // BayerGR = 01 = GR
-                //           23   BG
-                //
-                // So, for example, color = 1 and Bayer pattern is BayerRG, then the current color is G1 (the first green)
-                CELL_COLOURS cellColour = cellColours[color];
-
-                // Calculate the processing region.
-                // This is used to determine what neighbouring cells are available.
-
-                // Assume Central region.
-                region = REG_C;
-
-                // If on an edge...
-                if( i == 0 || j == 0 || i == outLast || j == inLast )
-                {
-                    // Determine where on edge
-                    // (this will be simpler if we loop through source data rather than output image)
-
-                    // If on top edge...
-                    if( dataIndex < imageBuffWidth )
-                    {
-                        if     ( dataIndex == TLPixel ) region = REG_TL;
-                        else if( dataIndex == TRPixel ) region = REG_TR;
-                        else                            region = REG_T;
-                    }
-
-                    // If on bottom edge...
-                    else if( dataIndex >= BLPixel)
-                    {
-                        if     ( dataIndex == BLPixel ) region = REG_BL;
-                        else if( dataIndex == BRPixel ) region = REG_BR;
-                        else                            region = REG_B;
-                    }
-
-                    // if on left or right edge...
-                    else if( !(dataIndex % imageBuffWidth) ) region = REG_L;
-                    else                                     region = REG_R;
-                }
-
-
-                // Process the cell
-                switch( cellColour )
-                {
-                    case CC_R: // red
-                    case CC_B: // blue
-
-                        // Extract the value
-                        rb = (*((quint32*)inPixel))&mask;
-
-                        // Based on the region, use available neighbouring cells to supply green and red or blue (diagonal) values
-                        switch( region )
-                        {
-                            case REG_C:
-                                g1 = (*((quint32*)(&inPixel[TOffset])))&mask;
-                                g2 = (*((quint32*)(&inPixel[BOffset])))&mask;
-                                g3 = (*((quint32*)(&inPixel[LOffset])))&mask;
-                                g4 = (*((quint32*)(&inPixel[ROffset])))&mask;
-                                d1 = (*((quint32*)(&inPixel[TLOffset])))&mask;
-                                d2 = (*((quint32*)(&inPixel[TROffset])))&mask;
-                                d3 = (*((quint32*)(&inPixel[BLOffset])))&mask;
-                                d4 = (*((quint32*)(&inPixel[BROffset])))&mask;
-                                break;
-
-                            case REG_TL:
-                                g2 = (*((quint32*)(&inPixel[BOffset])))&mask;
-                                g4 = (*((quint32*)(&inPixel[ROffset])))&mask;
-                                g1 = g2;
-                                g3 = g4;
-                                d4 = (*((quint32*)(&inPixel[BROffset])))&mask;
-                                d1 = d4;
-                                d2 = d4;
-                                d3 = d4;
-                                break;
-
-                            case REG_T:
-                                g2 = (*((quint32*)(&inPixel[BOffset])))&mask;
-                                g3 = (*((quint32*)(&inPixel[LOffset])))&mask;
-                                g4 = (*((quint32*)(&inPixel[ROffset])))&mask;
-                                g1 = (g2+g3+g4)/3;
-                                d3 = (*((quint32*)(&inPixel[BLOffset])))&mask;
-                                d4 = (*((quint32*)(&inPixel[BROffset])))&mask;
-                                d1 = d3;
-                                d2 = d4;
-                                break;
-
-                            case REG_TR:
-                                g2 = (*((quint32*)(&inPixel[BOffset])))&mask;
-                                g3 = (*((quint32*)(&inPixel[LOffset])))&mask;
-                                g1 = g2;
-                                g4 = g3;
-                                d3 = (*((quint32*)(&inPixel[BLOffset])))&mask;
-                                d1 = d3;
-                                d2 = d3;
-                                d4 = d3;
-                                break;
-
-                            case REG_L:
-                                g1 = (*((quint32*)(&inPixel[TOffset])))&mask;
-                                g2 = (*((quint32*)(&inPixel[BOffset])))&mask;
-                                g4 = (*((quint32*)(&inPixel[ROffset])))&mask;
-                                g3 = g4;
-                                d2 = (*((quint32*)(&inPixel[TROffset])))&mask;
-                                d4 = (*((quint32*)(&inPixel[BROffset])))&mask;
-                                d1 = d2;
-                                d3 = d4;
-                                break;
-
-                            case REG_R:
-                                g1 = (*((quint32*)(&inPixel[TOffset])))&mask;
-                                g2 = (*((quint32*)(&inPixel[BOffset])))&mask;
-                                g3 = (*((quint32*)(&inPixel[LOffset])))&mask;
-                                g4 = (g1+g2+g3)/3;
-                                d1 = (*((quint32*)(&inPixel[TLOffset])))&mask;
-                                d3 = (*((quint32*)(&inPixel[BLOffset])))&mask;
-                                d2 = d1;
-                                d4 = d3;
-                                break;
-
-                            case REG_BL:
-                                g1 = (*((quint32*)(&inPixel[TOffset])))&mask;
-                                g4 = (*((quint32*)(&inPixel[ROffset])))&mask;
-                                g2 = g1;
-                                g3 = g4;
-                                d2 = (*((quint32*)(&inPixel[TROffset])))&mask;
-                                d1 = d2;
-                                d3 = d2;
-                                d4 = d2;
-                                break;
-
-                            case REG_B:
-                                g1 = (*((quint32*)(&inPixel[TOffset])))&mask;
-                                g3 = (*((quint32*)(&inPixel[LOffset])))&mask;
-                                g4 = (*((quint32*)(&inPixel[ROffset])))&mask;
-                                g2 = (g1+g3+g4)/3;
-                                d1 = (*((quint32*)(&inPixel[TLOffset])))&mask;
-                                d2 = (*((quint32*)(&inPixel[TROffset])))&mask;
-                                d3 = d1;
-                                d4 = d2;
-                                break;
-
-                            case REG_BR:
-                                g1 = (*((quint32*)(&inPixel[TOffset])))&mask;
-                                g3 = (*((quint32*)(&inPixel[LOffset])))&mask;
-                                g2 = g1;
-                                g4 = g3;
-                                d1 = (*((quint32*)(&inPixel[TLOffset])))&mask;
-                                d2 = d1;
-                                d3 = d1;
-                                d4 = d1;
-                                break;
-
-                        }
-
-                        // Calculate the diagonal sum (red or blue depending on the pattern)
-                        d = (d1+d2+d3+d4)>>(shift+2);
-
-                        // Calculate the Green value from the green cells
-                        g = (g1+g2+g3+g4)>>(shift+2);
-
-                        // Take the red and blue from the current cell and the diagonals, or the other way round depending on the pattern
-                        switch( cellColour )
-                        {
-                            default:    // Should never hit the default case. Include to avoid compilation errors
-                            case CC_R: // red
-                                r = rb>>shift;
-                                b = d;
-                                break;
-                            case CC_B: // blue
-                                r = d;
-                                b = rb>>shift;
-                                break;
-                        }
-
-                        break;
-
-                    case CC_G1: // green 1
-                    case CC_G2: // green 2
-
-                        // Extract the green value
-                        g12 = (*((quint32*)inPixel))&mask;
-
-                        // Based on the region, use available neighbouring cells to supply red and blue values
-                        // Depending on the pattern top and bottom might be red and left and right blue,
-                        // or the other way round, so for the time being, just refer to them by their
-                        // orientation (v or h), rather than colour
-                        switch( region )
-                        {
-                            case REG_C:
-                                h1 = (*((quint32*)(&inPixel[LOffset])))&mask;
-                                h2 = (*((quint32*)(&inPixel[ROffset])))&mask;
-                                v1 = (*((quint32*)(&inPixel[TOffset])))&mask;
-                                v2 = (*((quint32*)(&inPixel[BOffset])))&mask;
-                                break;
-
-                            case REG_T:
-                                h1 = (*((quint32*)(&inPixel[LOffset])))&mask;
-                                h2 = (*((quint32*)(&inPixel[ROffset])))&mask;
-                                v2 = (*((quint32*)(&inPixel[BOffset])))&mask;
-                                v1 = v2;
-                                break;
-
-                            case REG_TR:
-                                h1 = (*((quint32*)(&inPixel[LOffset])))&mask;
-                                h2 = h1;
-                                v2 = (*((quint32*)(&inPixel[BOffset])))&mask;
-                                v1 = v2;
-                                break;
-
-                            case REG_R:
-                                h1 = (*((quint32*)(&inPixel[LOffset])))&mask;
-                                h2 = h1;
-                                v1 = (*((quint32*)(&inPixel[TOffset])))&mask;
-                                v2 = (*((quint32*)(&inPixel[BOffset])))&mask;
-                                break;
-
-                            case REG_B:
-                                h1 = (*((quint32*)(&inPixel[LOffset])))&mask;
-                                h2 = (*((quint32*)(&inPixel[ROffset])))&mask;
-                                v1 = (*((quint32*)(&inPixel[TOffset])))&mask;
-                                v2 = v1;
-                                break;
-
-                            case REG_BR:
-                                h1 = (*((quint32*)(&inPixel[LOffset])))&mask;
-                                h2 = h1;
-                                v1 = (*((quint32*)(&inPixel[TOffset])))&mask;
-                                v2 = v1;
-                                break;
-
-                            case REG_TL:
-                                h2 = (*((quint32*)(&inPixel[ROffset])))&mask;
-                                h1 = h2;
-                                v2 = (*((quint32*)(&inPixel[BOffset])))&mask;
-                                v1 = v2;
-                                break;
-
-                            case REG_L:
-                                h2 = (*((quint32*)(&inPixel[ROffset])))&mask;
-                                h1 = h2;
-                                v1 = (*((quint32*)(&inPixel[TOffset])))&mask;
-                                v2 = (*((quint32*)(&inPixel[BOffset])))&mask;
-                                break;
-
-                            case REG_BL:
-                                h2 = (*((quint32*)(&inPixel[ROffset])))&mask;
-                                h1 = h2;
-                                v1 = (*((quint32*)(&inPixel[TOffset])))&mask;
-                                v2 = v1;
-                                break;
-                        }
-
-                        // Calculate the vertical and horizontal sums (one is red, the other is blue depending on the pattern)
-                        h = (h1+h2)>>(shift+1);
-                        v = (v1+v2)>>(shift+1);
-
-                        // Calculate the Green value from the green cell
-                        g = g12>>shift;
-
-                        // Take the red and blue from the vertical or horizontal sums depending on the pattern
-                        switch( cellColour )
-                        {
-                            default:    // Should never hit the default case. Include to avoid compilation errors
-                            case CC_G1: // green 1
-                                r = *g1r;
-                                b = *g1b;
-                                break;
-                            case CC_G2: // green 2
-                                r = *g2r;
-                                b = *g2b;
-                                break;
-                        }
+            stats.merge( package.stats[i] );
+        }
+    }
+    else
+    {
+        buildImageBand( 0, outCount, stats );
+    }
+}
 
-                        break;
+// Gather statistics for the whole image from a sample of the image data.
+// Every Nth row of the image data (ignoring rotation and flipping) is converted into a scratch buffer,
+// so the statistics are gathered in exactly the same way as when the whole image is built.
+// Note, this replaces the scan parameters, so must be done after the image is built.
+void imagePropertiesCore::sampleStatistics( QE::WorkerManager* workers, unsigned long samplePixels, imageBandStatistics& stats )
+{
+    // Determine the image data rows to sample
+    unsigned long sampleRows = MAX( samplePixels / imageBuffWidth, (unsigned long)1 );
+    unsigned long rowStep = MAX( imageBuffHeight / sampleRows, (unsigned long)1 );
+
+    // Scan every Nth row as for scan option 1 (no rotation or flipping)
+    outCount = ( imageBuffHeight + rowStep - 1 ) / rowStep;
+    inCount = imageBuffWidth;
+    start = 0;
+    inInc = 1;
+    outInc = ( rowStep - 1 ) * imageBuffWidth;
+
+    // Convert the sampled rows into a scratch buffer, just for the statistics
+    QVector<imageDisplayProperties::rgbPixel> scratch( outCount*inCount );
+    dataOut = scratch.data();
+    buildBands( workers, stats );
+    dataOut = NULL;
+}
 
-                    // Should never get here.
-                    // Included to avoid compilation warnings on some compilers
-                    default:
-                        r = 0;
-                        b = 0;
-                        g = 0;
-                        break;
-                }
+// Build output image rows firstRow to lastRow-1 (rows as per the output image), and
+// accumulate pixel statistics for those rows.
+// This may be called in parallel for different bands of rows, so it must only write to
+// its own rows of the output image, and to its own statistics.
+// Note, all input data may be read as neighbouring pixels are required for some formats.
+void imagePropertiesCore::buildImageBand( int firstRow, int lastRow, imageBandStatistics& stats )
+{
+    stats.clear();
 
+    // Mono and Bayer formats are converted by the (vectorised) conversion kernels
+    if( imageConversionKernels::isFormatSupported( formatOption ) )
+    {
+        imageConversionKernels::parameters params;
+        params.format = formatOption;
+        params.width = imageBuffWidth;
+        params.height = imageBuffHeight;
+        params.bytesPerPixel = bytesPerPixel;
+        params.bitDepth = bitDepth;
+        params.pixelLow = pixelLow;
+        params.pixelHigh = pixelHigh;
+        params.pixelLookup = pixelLookup;
+        params.fullPixelLookup = fullPixelLookup.isEmpty() ? NULL : fullPixelLookup.constData();
+        params.fullPixelLookupSize = fullPixelLookup.count();
+
+        imageConversionKernels::scan scanParams;
+        scanParams.outCount = outCount;
+        scanParams.inCount = inCount;
+        scanParams.start = start;
+        scanParams.outInc = outInc;
+        scanParams.inInc = inInc;
+
+        imageConversionKernels::buildBand( params, scanParams, firstRow, lastRow, dataIn, dataOut, stats );
+        return;
+    }
 
+    // Draw the input pixels into the image buffer.
+    // Drawing is performed in two nested loops, one for height and one for width.
+    // Depending on the scan option, however, the outer may be height or width.
+    // The output buffer is written consecutively from first pixel to last and read from the
+    // input buffer, which is moved to the next pixel by both the inner and outer
+    // loops to where ever that next pixel is according to the rotation and flipping.
+    // Start at the first pixel of the first row in the band.
+    unsigned long buffIndex = (unsigned long)firstRow*inCount;
+    unsigned long dataIndex = start + (long)firstRow*((long)inCount*inInc+outInc);
 
-                // Accumulate pixel statistics
-                valP = g; // use all three colors!!!
-                BUILD_STATS
+    unsigned int pixelRange = pixelHigh-pixelLow;
+    if( !pixelRange )
+    {
+        pixelRange = 1;
+    }
 
-                // Scale pixel for local brightness and contrast
-                // !!! This will introduce some hue issues. Should convert to HSV to manipulate brightness and contrast????
-                ( (int)r < pixelLow ) ? r = 0 : ( (int)r > pixelHigh ) ? r = 255 : r = (r-pixelLow)*255/pixelRange;
-                ( (int)g < pixelLow ) ? g = 0 : ( (int)g > pixelHigh ) ? g = 255 : g = (g-pixelLow)*255/pixelRange;
-                ( (int)b < pixelLow ) ? b = 0 : ( (int)b > pixelHigh ) ? b = 255 : b = (b-pixelLow)*255/pixelRange;
+    // Prepare for building image stats while processing image data
+    unsigned int maxP = 0;
+    unsigned int minP = UINT_MAX;
+    unsigned int valP;
+    unsigned int binShift = (bitDepth<8)?0:bitDepth-8;
+    unsigned int bin;
+    unsigned int* bins = stats.bins; // Bins used for generating a pixel histogram
+#define BUILD_STATS \
+    bin = valP>>binShift; \
+    bins[bin] = bins[bin]+1; \
+    if( valP < minP ) minP = valP; \
+    if( valP > maxP ) maxP = valP;
 
-                // Select displayed pixel
-                dataOut[buffIndex].p[0] = pixelLookup[b].p[0];
-                dataOut[buffIndex].p[1] = pixelLookup[g].p[0];
-                dataOut[buffIndex].p[2] = pixelLookup[r].p[0];
-                dataOut[buffIndex].p[3] = 0xff;
+// For speed, the format switch statement is outside the pixel loop.
+// An identical(ish) loop is used for each format
+#define LOOP_START                          \
+    for( int i = firstRow; i < lastRow; i++ ) \
+    {                                       \
+        for( int j = 0; j < inCount; j++ )  \
+        {
 
-            LOOP_END
-            break;
-        }
+#define LOOP_END                            \
+            dataIndex += inInc;             \
+            buffIndex++;                    \
+        }                                   \
+        dataIndex += outInc;                \
+    }
 
+    // Format each pixel ready for use in an RGB32 QImage.
+    // Note, for speed, the switch on format is outside the loop. The loop is duplicated in each case using macros.
+    switch( formatOption )
+    {
         case QE::rgb1:
         case QE::rgb2: //!!! not done yet - just do the same as RGB1 for the time being and hope
         case QE::rgb3: //!!! not done yet - just do the same as RGB1 for the time being and hope
@@ -999,14 +1158,34 @@ QImage imagePropertiesCore::buildImageCore()
             break;
     }
 
-    // Update the image display properties controls if present
-    if( imageDisplayProps )
+    // Return the band statistics
+    stats.minP = minP;
+    stats.maxP = maxP;
+}
+
+// Construct a work package for building an image in bands
+imageBandPackage::imageBandPackage( imagePropertiesCore* coreIn, int bandCount )
+{
+    core = coreIn;
+    stats.resize( bandCount );
+}
+
+// Build the i-th of n bands of the image in the work package.
+// This is called in the context of one of the image processor's worker threads.
+void imageBandWorker::process( QObject* workPackage, const QE::Counts i, const QE::Counts n )
+{
+    imageBandPackage* package = qobject_cast<imageBandPackage*>( workPackage );
+    if( !package || i >= package->stats.count() )
     {
-        imageDisplayProps->setStatistics( minP, maxP, bitDepth, bins, pixelLookup );
+        return;
     }
 
-    // Return the image
-    return image;
+    // Split the output rows as evenly as possible
+    int rows = package->core->getOutputRows();
+    int firstRow = (int)( (qint64)rows * i / n );
+    int lastRow = (int)( (qint64)rows * (i+1) / n );
+
+    package->core->buildImageBand( firstRow, lastRow, package->stats[i] );
 }
 
 // Set the image width
@@ -1203,6 +1382,8 @@ int imageProcessor::getScanOption()
 // Generate a lookup table to convert raw pixel values to display pixel values taking into
 // account, clipping, and contrast reversal.
 // Note, the table will be used to translate each colour in an RGB format.
+// For Mono and Bayer formats, also generate a full depth lookup table that includes
+// scaling for local brightness and contrast. Both are regenerated whenever pixelLookupValid is cleared.
 //
 void imageProcessor::getPixelTranslation()
 {
@@ -1298,6 +1479,37 @@ void imageProcessor::getPixelTranslation()
 
     }
 
+    // Generate a lookup table indexed directly by pixel value if required.
+    // This folds scaling for local brightness and contrast into the table, so each pixel
+    // is converted with a single lookup, rather than being clipped and scaled first.
+    // It is only used for Mono and Bayer formats. Bayer pixels are reduced to 8 bits so
+    // only the first 256 entries are used for Bayer formats.
+    if( useFullPixelLookup &&
+        imageConversionKernels::isFormatSupported( formatOption ) &&
+        bitDepth <= MAXIMUM_FULL_LOOKUP_DEPTH )
+    {
+        unsigned int size = MAX( (unsigned int)1<<bitDepth, MAX_VALUE+1 );
+        fullPixelLookup.resize( size );
+        imageDisplayProperties::rgbPixel* fullLookup = fullPixelLookup.data();
+
+        // Scale pixel for local brightness and contrast (as per imageConversionKernels)
+        unsigned int pixelRange = pixelHigh-pixelLow;
+        if( !pixelRange )
+        {
+            pixelRange = 1;
+        }
+        for( value = 0; value < size; value++ )
+        {
+            unsigned int scaledValue;
+            ( (int)value < pixelLow ) ? scaledValue = 0 : ( (int)value > pixelHigh ) ? scaledValue = MAX_VALUE : scaledValue = (value-pixelLow)*MAX_VALUE/pixelRange;
+            fullLookup[value] = pixelLookup[scaledValue];
+        }
+    }
+    else
+    {
+        fullPixelLookup.clear();
+    }
+
     return;
 }
 
@@ -1494,53 +1706,6 @@ bool imageProcessor::validateDimensions()
     }
 }
 
-// Determine the range of pixel values an area of the image
-void imageProcessor::getPixelRange( const QRect& area, unsigned int* min, unsigned int* max )
-{
-    // If the area selected was the the entire image, and the image was not presented at 100%, rounding areas while scaling
-    // may result in area dimensions outside than the actual image by a pixel or so, so limit the area to within the image.
-    unsigned int areaX = (area.topLeft().x()>=0)?area.topLeft().x():0;
-    unsigned int areaY = (area.topLeft().y()>=0)?area.topLeft().y():0;
-    unsigned int areaW = (area.width() <=(int)rotatedImageBuffWidth() )?area.width() :rotatedImageBuffWidth();
-    unsigned int areaH = (area.height()<=(int)rotatedImageBuffHeight())?area.height():rotatedImageBuffHeight();
-
-    // Set up to step pixel by pixel through the area
-    const unsigned char* data = (unsigned char*)imageData.constData();
-    unsigned int index = (areaY*rotatedImageBuffWidth()+areaX)*bytesPerPixel;
-
-    // This function is called as the user drags region handles around the
-    // screen. Recalculating min and max pixels for large areas
-    // for each mouse movement event needs to be efficient so speed loop by
-    // extracting width and height. (Compiler can't assume QRect width
-    // and height stays constant so it is evaluated each iteration of for
-    // loop if it was in the form   'for( int i = 0; i < area.height(); i++ )'
-    unsigned int stepW = bytesPerPixel;
-
-    // Calculate the step to the start of the next row in the area selected.
-    unsigned int stepH = (rotatedImageBuffWidth()-areaW)*bytesPerPixel;
-
-    unsigned int maxP = 0;
-    unsigned int minP = UINT_MAX;
-
-    // Determine the maximum and minimum pixel values in the area
-    for( unsigned int i = 0; i < areaH; i++ )
-    {
-        for( unsigned int j = 0; j < areaW; j++ )
-        {
-            unsigned int p = getPixelValueFromData( &(data[index]) );
-            if( p < minP ) minP = p;
-            if( p > maxP ) maxP = p;
-
-            index += stepW;
-        }
-        index += stepH;
-    }
-
-    // Return results
-    *min = minP;
-    *max = maxP;
-}
-
 // Return a pointer to pixel data in the original image data.
 // The position parameter is scaled to the original image size but reflects
 // the displayed rotation and flip options, so it must be transformed first.
@@ -1572,83 +1737,7 @@ const unsigned char* imageProcessor::getImageDataPtr( QPoint& pos )
 // big enough for the data format.
 int imageProcessor::getPixelValueFromData( const unsigned char* ptr )
 {
-    // Sanity check
-    if( !ptr )
-        return 0;
-
-    // Case the data to the correct size, then return the data as a floating point number.
-    switch( formatOption )
-    {
-        case QE::BayerGB:
-        case QE::BayerBG:
-        case QE::BayerGR:
-        case QE::BayerRG:
-        case QE::Mono:
-            {
-                unsigned int usableDepth = bitDepth;
-                if( bitDepth > (imageDataSize*8) )
-                {
-                    usableDepth = imageDataSize*8;
-                }
-
-                quint32 mask = ((unsigned long)(1)<<usableDepth)-1;
-
-                return (*((quint32*)ptr))&mask;
-            }
-
-        case QE::rgb1:
-            {
-                // for RGB, average all colors
-                unsigned int pixel = *(unsigned int*)ptr;
-                return ((pixel&0xff0000>>16) + (pixel&0x00ff00>>8) + (pixel&0x0000ff)) / 3;
-            }
-
-        case QE::rgb2:
-            //!!! not done - copy of RGB1
-            {
-                // for RGB, average all colors
-                unsigned int pixel = *(unsigned int*)ptr;
-                return ((pixel&0xff0000>>16) + (pixel&0x00ff00>>8) + (pixel&0x0000ff)) / 3;
-            }
-
-        case QE::rgb3:
-            //!!! not done - copy of RGB1
-            {
-                // for RGB, average all colors
-                unsigned int pixel = *(unsigned int*)ptr;
-                return ((pixel&0xff0000>>16) + (pixel&0x00ff00>>8) + (pixel&0x0000ff)) / 3;
-            }
-
-        case QE::yuv444:
-            //!!! not done - copy of RGB1
-            {
-                // for RGB, average all colors
-                unsigned int pixel = *(unsigned int*)ptr;
-                return ((pixel&0xff0000>>16) + (pixel&0x00ff00>>8) + (pixel&0x0000ff)) / 3;
-            }
-
-        case QE::yuv422:
-            //!!! not done - copy of RGB1
-            {
-                // for RGB, average all colors
-                unsigned int pixel = *(unsigned int*)ptr;
-                return ((pixel&0xff0000>>16) + (pixel&0x00ff00>>8) + (pixel&0x0000ff)) / 3;
-            }
-
-        case QE::yuv421:
-            //!!! not done - copy of RGB1
-            {
-                // for RGB, average all colors
-                unsigned int pixel = *(unsigned int*)ptr;
-                return ((pixel&0xff0000>>16) + (pixel&0x00ff00>>8) + (pixel&0x0000ff)) / 3;
-            }
-
-        default:   // avoid  compilation warning for NUMBER_OF_FORMATS
-            break;
-    }
-
-    // Avoid compilation warning (not sure why this is required as all cases are handled in switch statements.
-    return *ptr;
+    return imageAnalysis::getPixelValue( ptr, formatOption, bitDepth, imageDataSize );
 }
 
 // Return a floating point number representing a pixel intensity given a pointer into an image data buffer.
@@ -1658,360 +1747,76 @@ double imageProcessor::getFloatingPixelValueFromData( const unsigned char* ptr )
 }
 
 // Return a QImage based on the current image
+// If only a region of the image was built when last displayed (for example, the image is zoomed) the
+// whole image is built now.
 QImage imageProcessor::copyImage()
 {
+    if( image.isNull() || image.offset() != QPoint( 0, 0 ) ||
+        image.width() != (int)rotatedImageBuffWidth() || image.height() != (int)rotatedImageBuffHeight() )
+    {
+        // Can't build the image if there is no image data, or not enough of it
+        if( imageData.isEmpty() || (unsigned long)imageData.size() < imageBuffWidth * imageBuffHeight * bytesPerPixel )
+        {
+            return image;
+        }
+
+        if( !pixelLookupValid )
+        {
+            getPixelTranslation();
+            pixelLookupValid = true;
+        }
+
+        // Build the whole image (without updating statistics).
+        // Note, the band workers may be in use by the image processing thread, so build it in this thread alone.
+        imagePropertiesCore* core = newImageCore();
+        core->setPipelineOptions( false, true );
+        QImage wholeImage = core->buildImageCore();
+        delete core;
+        return wholeImage;
+    }
     return image;
 }
 
+// Return an analyser for the current image data.
+// The analyser reads the image data directly according to the current rotation and flip options.
+imageAnalysis imageProcessor::getImageAnalysis()
+{
+    return imageAnalysis( imageData, imageBuffWidth, imageBuffHeight, getScanOption(), bytesPerPixel, formatOption, bitDepth, imageDataSize );
+}
+
+// Set the analysis to perform for each image built (according to the markups in use).
+// The image processing thread analyses each image once built and delivers the results with the imageAnalysed() signal.
+void imageProcessor::setAnalysisRequest( const imageAnalysisRequest& request )
+{
+    analysisRequest = request;
+}
+
 // Generate a profile along a line down an image at a given X position
 // Input ordinates are scaled to the source image data.
 // The profile contains values for each pixel intersected by the line.
+// (This is normally generated by the image processing thread for each new image. See setAnalysisRequest())
 void imageProcessor::generateVSliceData( QVector<QPointF>& vSliceData, int x, unsigned int thickness )
 {
-    // Ensure the buffer is the correct size
-    if( vSliceData.size() != (int)rotatedImageBuffHeight() )
-        vSliceData.resize( rotatedImageBuffHeight() );
-
-    // Set up to step pixel by pixel through the image data along the line
-    const unsigned char* data = (unsigned char*)imageData.constData();
-    const unsigned char* dataPtr = &(data[x*bytesPerPixel]);
-    int dataPtrStep = rotatedImageBuffWidth()*bytesPerPixel;
-
-    // Set up to step through the line thickness
-    unsigned int halfThickness = thickness/2;
-    int xMin = x-halfThickness;
-    if( xMin < 0 ) xMin = 0;
-    int xMax =  xMin+thickness;
-    if( xMax >= (int)rotatedImageBuffWidth() ) xMax = rotatedImageBuffWidth();
-
-    // Accumulate data for each pixel in the thickness
-    bool firstPass = true;
-    for( int nextX = xMin; nextX < xMax; nextX++ )
-    {
-        // Accumulate the image data value at each pixel.
-        // The buffer is filled backwards so the plot, which sits on its side beside the image is drawn correctly
-        QPoint pos;
-        pos.setX( nextX );
-        for( int i = rotatedImageBuffHeight()-1; i >= 0; i-- )
-        {
-            pos.setY( i );
-            QPointF* dataPoint = &vSliceData[i];
-            double value = getFloatingPixelValueFromData( getImageDataPtr( pos ) );
-
-            // On first pass, set up X and Y
-            if( firstPass )
-            {
-                dataPoint->setY( i );
-                dataPoint->setX( value );
-            }
-
-            // On subsequent passes (when thickness is greater than 1), accumulate X
-            else
-            {
-                dataPoint->setX( dataPoint->x() + value );
-            }
-
-            dataPtr += dataPtrStep;
-        }
-
-        firstPass = false;
-    }
-
-    // Calculate average pixel values if more than one pixel thick
-    if( thickness > 1 )
-    {
-        for( int i = rotatedImageBuffHeight()-1; i >= 0; i-- )
-        {
-            QPointF* dataPoint = &vSliceData[i];
-            dataPoint->setX( dataPoint->x()/thickness );
-        }
-    }
+    getImageAnalysis().generateVSliceData( vSliceData, x, thickness );
 }
 
 // Generate a profile along a line across an image at a given Y position
 // Input ordinates are at the resolution of the source image data
 // The profile contains values for each pixel intersected by the line.
+// (This is normally generated by the image processing thread for each new image. See setAnalysisRequest())
 void imageProcessor::generateHSliceData( QVector<QPointF>& hSliceData, int y, unsigned int thickness )
 {
-    // Ensure the buffer is the correct size
-    if( hSliceData.size() != (int)rotatedImageBuffWidth() )
-        hSliceData.resize( rotatedImageBuffWidth() );
-
-    // Set up to step pixel by pixel through the image data along the line
-    const unsigned char* data = (unsigned char*)imageData.constData();
-    const unsigned char* dataPtr = &(data[y*rotatedImageBuffWidth()*bytesPerPixel]);
-    int dataPtrStep = bytesPerPixel;
-
-    // Set up to step through the line thickness
-    unsigned int halfThickness = thickness/2;
-    int yMin = y-halfThickness;
-    if( yMin < 0 ) yMin = 0;
-    int yMax =  yMin+thickness;
-    if( yMax >= (int)rotatedImageBuffHeight() ) yMax = rotatedImageBuffHeight();
-
-    // Accumulate data for each pixel in the thickness
-    bool firstPass = true;
-    for( int nextY = yMin; nextY < yMax; nextY++ )
-    {
-        // Accumulate the image data value at each pixel.
-        QPoint pos;
-        pos.setY( nextY );
-        for( unsigned int i = 0; i < rotatedImageBuffWidth(); i++ )
-        {
-            pos.setX( i );
-            QPointF* dataPoint = &hSliceData[i];
-            double value = getFloatingPixelValueFromData( getImageDataPtr( pos ) );
-
-            // On first pass, set up X and Y
-            if( firstPass )
-            {
-                dataPoint->setX( i );
-                dataPoint->setY( value );
-            }
-
-            // On subsequent passes (when thickness is greater than 1), accumulate X
-            else
-            {
-                dataPoint->setY( dataPoint->y() + value );
-            }
-
-            dataPtr += dataPtrStep;
-        }
-
-        firstPass = false;
-    }
-
-
-    // Calculate average pixel values if more than one pixel thick
-    if( thickness > 1 )
-    {
-        for( unsigned int i = 0; i < rotatedImageBuffWidth(); i++ )
-        {
-            QPointF* dataPoint = &hSliceData[i];
-            dataPoint->setY( dataPoint->y()/thickness );
-        }
-    }
+    getImageAnalysis().generateHSliceData( hSliceData, y, thickness );
 }
 
 // Generate a profile along an arbitrary line through an image.
 // Input ordinates are scaled to the source image data.
 // The profile contains values one pixel length along the line.
-// Except where the line is vertical or horizontal points one pixel
-// length along the line will not line up with actual pixels.
-// The values returned are a weighted average of the four actual pixels
-// containing a notional pixel drawn around the each point on the line.
-//
-// In the example below, a line was drawn from pixels (1,1) to (3,3).
-//
-// The starting and ending points are the center of the start and end
-// pixels: (1.5,1.5)  (3.5,3.5)
-//
-// The points along the line one pixel length apart are roughly at points
-// (1.5,1.5) (2.2,2.2) (2.9,2.9) (3.6,3.6)
-//
-// The points are marked in the example with an 'x'.
-//
-//     0       1       2       3       4
-//   +-------+-------+-------+-------+-------+
-//   |       |       |       |       |       |
-// 0 |       |       |       |       |       |
-//   |       |       |       |       |       |
-//   +-------+-------+-------+-------+-------+
-//   |       |       |       |       |       |
-// 1 |       |   x ......... |       |       |
-//   |       |     . |     . |       |       |
-//   +-------+-----.-+-----.-+-------+-------+
-//   |       |     . | x   . |       |       |
-// 2 |       |     . |     . |       |       |
-//   |       |     .........x|       |       |
-//   +-------+-------+-------+-------+-------+
-//   |       |       |       |       |       |
-// 3 |       |       |       |   x   |       |
-//   |       |       |       |       |       |
-//   +-------+-------+-------+-------+-------+
-//   |       |       |       |       |       |
-// 4 |       |       |       |       |       |
-//   |       |       |       |       |       |
-//   +-------+-------+-------+-------+-------+
-//
-// The second point has a notional pixel drawn around it like so:
-//      .........
-//      .       .
-//      .       .
-//      .   x   .
-//      .       .
-//      .........
-//
-// This notional pixel overlaps pixels (1,1) (1,2) (2,1) and (2,2).
-//
-// The notional pixel overlaps about 10% of pixel (1,1),
-// 20% of pixels (1,2) and (2,1) and 50% of pixel (2,2).
-//
-// A value for the second point will be the sum of the four pixels
-// overlayed by the notional pixel weighted by these values.
-//
-// The line has a notional thickness. The above processing for a single
-// pixel width is repeated with the start and end points moved at right
-// angles to the line by a 'pixel' distance up to the line thickness.
-// The results are then averaged.
-//
+// Refer to QEImage::generateProfile() for a detailed description.
+// (This is normally generated by the image processing thread for each new image. See setAnalysisRequest())
 void imageProcessor::generateProfileData( QVector<QPointF>& profileData, QPoint point1, QPoint point2, unsigned int thickness )
 {
-    // X and Y components of line drawn
-    double dX = point2.x()-point1.x();
-    double dY = point2.y()-point1.y();
-
-    // Line length
-    double len = sqrt( dX*dX+dY*dY );
-
-    // Step on each axis to move one 'pixel' length
-    double xStep = dX/len;
-    double yStep = dY/len;
-
-    // Starting point in center of start pixel
-    double initX = point1.x()+0.5;
-    double initY = point1.y()+0.5;
-
-    // Ensure output buffer is the correct size
-    if( profileData.size() != len )
-    {
-       profileData.resize( int( len ) );
-    }
-
-    // Integer pixel length
-    int intLen = (int)len;
-
-    // Parrallel passes will be made one 'pixel' away from each other up to the thickness required.
-    // Determine the offset for the first pass.
-    // Note, this will not add an offset for a thickness of 1 pixel
-    initX -= yStep * (double)(thickness-1) / 2;
-    initY += xStep * (double)(thickness-1) / 2;
-
-    // Accumulate a set of values for each pixel width up to the thickness required
-    bool firstPass = true;
-    for( unsigned int j = 0; j < thickness; j++ )
-    {
-        // Starting point for this pass
-        double x = initX;
-        double y = initY;
-
-        // Calculate a value for each pixel length along the selected line
-        for( int i = 0; i < intLen; i++ )
-        {
-            // Calculate the value if the point is within the image (user can drag outside the image)
-            double value;
-            if( x >= 0 && x < rotatedImageBuffWidth() && y >= 0 && y < rotatedImageBuffHeight() )
-            {
-
-                // Determine the top left of the notional pixel that will be measured
-                // The notional pixel is one pixel length both dimensions and will not
-                // nessesarily overlay a single real pixel
-                double xTL = x-0.5;
-                double yTL = y-0.5;
-
-                // Determine the top left actual pixel of the four actual pixels that
-                // the notional pixel overlays, and the fractional part of a pixel that
-                // the notional pixel is offset by.
-                double xTLi, xTLf; // i = integer part, f = fractional part
-                double yTLi, yTLf; // i = integer part, f = fractional part
-
-                xTLf = modf( xTL, & xTLi );
-                yTLf = modf( yTL, & yTLi );
-
-                // For each of the four actual pixels that the notional pixel overlays,
-                // determine the proportion of the actual pixel covered by the notional pixel
-                double propTL = (1.0-xTLf)*(1-yTLf);
-                double propTR = (xTLf)*(1-yTLf);
-                double propBL = (1.0-xTLf)*(yTLf);
-                double propBR = (xTLf)*(yTLf);
-
-                // Determine a pointer into the image data for each of the four actual pixels overlayed by the notional pixel
-                int actualXTL = (int)xTLi;
-                int actualYTL = (int)yTLi;
-                QPoint posTL( actualXTL,   actualYTL );
-                QPoint posTR( actualXTL+1, actualYTL );
-                QPoint posBL( actualXTL,   actualYTL+1 );
-                QPoint posBR( actualXTL+1, actualYTL+1 );
-
-                const unsigned char* dataPtrTL = getImageDataPtr( posTL );
-                const unsigned char* dataPtrTR = getImageDataPtr( posTR );
-                const unsigned char* dataPtrBL = getImageDataPtr( posBL );
-                const unsigned char* dataPtrBR = getImageDataPtr( posBR );
-
-                // Determine the value of the notional pixel from a weighted average of the four real pixels it overlays.
-                // The larger the proportion of the real pixel overlayed, the greated the weight.
-                // (Ignore pixels outside the image)
-                int pixelsInValue = 0;
-                value = 0;
-                if( xTLi >= 0 && yTLi >= 0 )
-                {
-                    value += propTL * getFloatingPixelValueFromData( dataPtrTL );
-                    pixelsInValue++;
-                }
-
-                if( xTLi+1 < rotatedImageBuffWidth() && yTLi >= 0 )
-                {
-                    value += propTR * getFloatingPixelValueFromData( dataPtrTR );
-                    pixelsInValue++;
-                }
-
-                if( xTLi >= 0 && yTLi+1 < rotatedImageBuffHeight() )
-                {
-
-                    value += propBL * getFloatingPixelValueFromData( dataPtrBL );
-                    pixelsInValue++;
-                }
-                if( xTLi+1 < rotatedImageBuffWidth() && yTLi+1 < rotatedImageBuffHeight() )
-                {
-                    value += propBR * getFloatingPixelValueFromData( dataPtrBR );
-                    pixelsInValue++;
-                }
-
-
-                // Calculate the weighted value
-                value = value / pixelsInValue * 4;
-
-                // Move on to the next 'point'
-                x+=xStep;
-                y+=yStep;
-            }
-
-            // Use a value of zero if the point is not within the image (user can drag outside the image)
-            else
-            {
-                value = 0.0;
-            }
-
-            // Get a reference to the current data point
-            QPointF* data = &profileData[i];
-
-            // If the first pass, set the X axis and the initial data value
-            if( firstPass )
-            {
-                data->setX( i );
-                data->setY( value );
-            }
-
-            // On consequent passes, accumulate the data value
-            else
-            {
-                data->setY( data->y() + value );
-            }
-        }
-
-        initX += yStep;
-        initY -= xStep;
-
-        firstPass = false;
-
-    }
-
-    // Average the values
-    for( int i = 0; i < intLen; i++ )
-    {
-        QPointF* data = &profileData[i];
-        data->setY( data->y() / thickness );
-    }
+    getImageAnalysis().generateProfileData( profileData, point1, point2, thickness );
 }
 
 // Transform a rectangle in the displayed image to a rectangle in the
@@ -33,8 +33,62 @@
 #include <QMutex>
 #include <QWaitCondition>
 #include <QReadWriteLock>
+#include <QVector>
+#include <QList>
+#include <QElapsedTimer>
+#include <QEWorkers.h>
 #include <imageProperties.h>
 
+/*!
+ Work package for building an image in parallel bands of rows.
+ Each worker builds one band and accumulates statistics for that band into its own entry in stats.
+ */
+class imageBandPackage : public QObject
+{
+    Q_OBJECT
+
+public:
+    imageBandPackage( imagePropertiesCore* coreIn, int bandCount ); ///< Constructor
+
+    imagePropertiesCore* core;              ///< Image being built
+    QVector<imageBandStatistics> stats;     ///< Statistics for each band
+};
+
+/*!
+ Worker that builds one band of rows of an image. See imageBandPackage.
+ */
+class imageBandWorker : public QE::Worker
+{
+private:
+    void process( QObject* workPackage, const QE::Counts i, const QE::Counts n );  ///< Build the i-th of n bands
+};
+
+/*!
+ Image pipeline statistics. Counts images as they pass through the image pipeline and the time spent in each stage.
+ Times are recent averages in milliseconds. Refer to imageProcessor::getPipelineStatistics()
+ */
+class imagePipelineStatistics
+{
+public:
+    imagePipelineStatistics(){ clear(); }   ///< Constructor
+    void clear();                           ///< Reset all counts and times
+
+    unsigned long received;     ///< Images received
+    unsigned long built;        ///< Images built by the image processing thread
+    unsigned long dropped;      ///< Images received but not built (superseded by a later image, skipped when processing falls behind, or not valid)
+    unsigned long displayed;    ///< Images painted (images built but superseded before being painted are not counted)
+
+    double decompressTime;      ///< Time to decompress compressed image data (mS)
+    double convertTime;         ///< Time to convert image data to a displayable image (mS)
+    double statisticsTime;      ///< Time to gather and publish image statistics (mS)
+    double analysisTime;        ///< Time to analyse image data for markups and beam statistics (mS)
+    double paintTime;           ///< Time to paint the image (mS)
+    double arrivalInterval;     ///< Time between images received (mS)
+
+    bool reducedStatistics;     ///< Adaptive processing is only updating image statistics periodically
+    int displayInterval;        ///< Adaptive processing is only displaying every Nth image
+};
+
 /*!
  This class generates images for presentation from raw image data and formatting
  information such as brightness, contrast, flip, rotate, canvas size, etc.
@@ -51,7 +105,19 @@ public:
 
     // Image update
     void setImage( const QByteArray& imageIn, unsigned long dataSize ); ///< Save the image data for analysis processing and display
+    void setCompressedImage( const QENTNDArrayData& imageIn, unsigned long dataSize, const QCaDateTime& time ); ///< Save compressed image data for processing and display (decompressed by the image processing thread)
+    void setImageSource( const QString& source );                                      ///< Set the image source (PV name). Decompressed images are shared with other image processors displaying the same source
+    bool setDecompressedImage( const QByteArray& imageIn, unsigned int imageId );       ///< Save decompressed image data for analysis (as delivered by the imageDecompressed() signal)
     void buildImage();                                                  ///< Generate a new image.
+    void setDisplayedArea( const QRect& area );                         ///< Set the area of the image displayed (only that area need be built). Null if the whole image is displayed
+    void setAnalysisRequest( const imageAnalysisRequest& request );     ///< Set the analysis to perform for each image built (results are delivered by the imageAnalysed() signal)
+
+    // Image pipeline statistics and adaptive processing
+    imagePipelineStatistics getPipelineStatistics();    ///< Return the current image pipeline statistics
+    void resetPipelineStatistics();                     ///< Clear the image pipeline statistics
+    void imagePainted( qint64 paintNSecs );             ///< Note an image has been painted (and how long it took)
+    void setAdaptiveProcessing( bool adaptiveProcessingIn );  ///< Set adaptive processing. If true, reduce statistics work and then display every Nth image when processing falls behind
+    bool getAdaptiveProcessing(){ return adaptiveProcessing; }  ///< Get adaptive processing
 
     // Set functions for dimensions and image attributes
     bool setWidth( unsigned long uValue );          ///< Set the image width
@@ -74,13 +140,12 @@ public:
     imageDisplayProperties::rgbPixel getFalseColor (const unsigned char value);    ///< Get a false color representation for an entry fro the color lookup table
     int getElementCount();                                                         ///< Determine the element count expected based on the available dimensions
     bool validateDimensions();                                                     ///< Determine if the image dimensional information is valid.
-    void getPixelRange( const QRect& area, unsigned int* min, unsigned int* max ); ///< Determine the range of pixel values an area of the image
     bool hasImage(){ return !imageData.isEmpty(); }                                ///< Return true if the current image is empty
     const unsigned char* getImageDataPtr( QPoint& pos );                           ///< Return a pointer to pixel data in the original image data.
     int getPixelValueFromData( const unsigned char* ptr );                         ///< Return a number representing a pixel intensity given a pointer into an image data buffer.
     double getFloatingPixelValueFromData( const unsigned char* ptr );              ///< Return a floating point number representing a pixel intensity given a pointer into an image data buffer.
 
-    QImage copyImage();         ///< Return a QImage based on the current image
+    QImage copyImage();         ///< Return a QImage based on the current image (the whole image, even if only a region is displayed)
 
     void generateVSliceData( QVector<QPointF>& vSliceData, int x, unsigned int thickness );                          ///< Generate a series of pixel values from a vertical slice through the current image.
     void generateHSliceData( QVector<QPointF>& hSliceData, int y, unsigned int thickness );                          ///< Generate a series of pixel values from a horizontal slice through the current image.
@@ -103,8 +168,44 @@ public:
     bool                 finishNow; // Flag to image processing thread that it should exit
     imagePropertiesCore* next;      // Image related information passed to image processing thread and protected by imageLock
 
+    bool                 useFullPixelLookup; // Generate a lookup table indexed by pixel value for Mono and Bayer formats (see getPixelTranslation())
+
+    // Building only the displayed region of the image
+    bool                 useRegions;      // Only build the region of the image displayed when only a small part of the image is displayed
+    QRect                displayedArea;   // Area of the image displayed (in displayed image orientation). Null if the whole image is displayed
+    QRect                getBuildRegion();// Return the region of the image to build (null for the whole image)
+    imagePropertiesCore* newImageCore();  // Package up the current image data and all related information for building an image
+
+    imageAnalysisRequest analysisRequest; // Analysis to perform for each image built (see setAnalysisRequest())
+    imageAnalysis        getImageAnalysis(); // Return an analyser for the current image data
+
+    // Decompression of compressed image data by the image processing thread
+    QENTNDArrayData      compressedImage;        // Compressed image data not yet returned decompressed from the image processing thread
+    bool                 compressedImagePending; // compressedImage is valid
+    unsigned int         compressedImageId;      // Incremented for each compressedImage
+    QCaDateTime          compressedImageTime;    // Time stamp of compressedImage
+    QString              imageSource;            // Image source (PV name). Used to share decompressed images (see decodedImageCache)
+    int                  codecThreads;           // Threads used when decompressing (by codecs that support it)
+    QList<QByteArray>    decompressBuffers;      // Buffers to decompress image data into (image processing thread only)
+    QString              previousDecompressText; // Previous decompression error (image processing thread only) - avoid repeats.
+    QByteArray&          getDecompressBuffer();  // Return a buffer to decompress image data into (image processing thread only)
+
+    // Image pipeline statistics and adaptive processing
+    QMutex                  pipelineLock;           // Locks access to pipelineStats (updated by both the QEImage thread and image processing thread)
+    imagePipelineStatistics pipelineStats;          // Image pipeline statistics
+    QElapsedTimer           arrivalTimer;           // Times the interval between images received (QEImage thread only)
+    bool                    newImagePending;        // Image data has been received that has not yet been passed to buildImage() (QEImage thread only)
+    bool                    adaptiveProcessing;     // Reduce statistics work and display every Nth image when processing falls behind
+    double                  processingLoad;         // Recent time to process an image as a proportion of the time between images
+    int                     displaySkipCount;       // Images skipped since the last image displayed (adaptive processing)
+    int                     statisticsSkipCount;    // Images displayed since statistics were last published (adaptive processing)
+    void                    imageReceived();        // Note an image has been received and update the adaptive processing state
+    void                    imageDropped();         // Note an image has been received but will not be built
+
 signals:
     void imageBuilt( QImage image, QString error );                         ///< An image has been generated from image data and in now ready for presentation
+    void imageDecompressed( QByteArray imageData, unsigned int imageId );   ///< Compressed image data has been decompressed. It should be passed to setDecompressedImage()
+    void imageAnalysed( imageAnalysisResults results );                     ///< Image data has been analysed. Delivered immediately before the image built from the same image data
 
 private:
 };
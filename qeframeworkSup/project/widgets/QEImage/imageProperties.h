@@ -27,11 +27,19 @@
 #ifndef QE_IMAGE_PROPERTIES_H
 #define QE_IMAGE_PROPERTIES_H
 
+#include <QVector>
+#include <QRect>
 #include "QCaDateTime.h"
 #include <QEEnums.h>
 #include "imageDataFormats.h"
+#include "imageAnalysis.h"
+#include <QENTNDArrayData.h>
 #include <brightnessContrast.h> // Remove this, or extract the general definitions used (eg rgbPixel) into another include file
+#include "imageConversionKernels.h"
 
+namespace QE {
+class WorkerManager;    // differed
+}
 
 // Class to manage core image processing by a seperate thread.
 //
@@ -61,14 +69,37 @@ public:
                          int pixelHighIn,
                          unsigned int bitDepthIn,
                          imageDisplayProperties::rgbPixel* pixelLookupIn,
+                         const QVector<imageDisplayProperties::rgbPixel>& fullPixelLookupIn,
                          QE::ImageFormatOptions formatOptionIn,
                          unsigned long imageDataSizeIn,
                          imageDisplayProperties* imageDisplayPropsIn,
                          unsigned int rotatedImageBuffWidthIn,
                          unsigned int rotatedImageBuffHeightIn );
 
-    QImage buildImageCore();
+    void setCompressedImage( const QENTNDArrayData& compressedImageIn, unsigned int compressedImageIdIn,   // Image data is to be decompressed by decompressImage() before building the image
+                             const QString& imageSourceIn, const QCaDateTime& imageTimeIn );               // (Image source and time stamp identify the image in the decodedImageCache)
+    bool isCompressed() const { return compressed; }                                // Image data must be decompressed before building the image
+    unsigned int getCompressedImageId() const { return compressedImageId; }         // Identifies the compressed image data (see imageProcessor::setCompressedImage())
+    bool decompressImage( QByteArray& buffer, int codecThreads, QString& errorText ); // Decompress the image data into a (reusable) buffer
+    QByteArray getImageData() const { return imageData; }                           // Image data (once decompressed, if compressed)
+
+    QImage buildImageCore( QE::WorkerManager* workers = NULL );                     // Build the image, in parallel if workers are available
+    void buildImageBand( int firstRow, int lastRow, imageBandStatistics& stats );   // Build a band of rows of the image
+    int getOutputRows() const { return outCount; }                                  // Number of output image rows (valid once buildImageCore() has started)
+
+    void setRegion( const QRect& regionIn ) { region = regionIn; }                  // Only build this region of the image (in displayed image orientation). Null for the whole image
+    void setPipelineOptions( bool newImageIn, bool reducedStatisticsIn );           // Note if this is a new image (not a redisplay), and if statistics may be skipped
+    bool isNewImage() const { return newImage; }                                    // Image is built from new image data (not a redisplay of the current image data)
+    qint64 getConvertTime() const { return convertTime; }                           // Time taken to convert the image data (nS) (valid once buildImageCore() is complete)
+    qint64 getStatisticsTime() const { return statisticsTime; }                     // Time taken to gather and publish statistics (nS) (valid once buildImageCore() is complete)
+
+    void setAnalysisRequest( const imageAnalysisRequest& request ) { analysisRequest = request; } // Analysis to perform (see analyseImage())
+    bool analyseImage( imageAnalysisResults& results );                             // Analyse the image data. Returns false if no analysis was performed
+    qint64 getAnalysisTime() const { return analysisTime; }                         // Time taken to analyse the image data (nS) (valid once analyseImage() is complete)
 private:
+    void buildBands( QE::WorkerManager* workers, imageBandStatistics& stats );      // Build all output rows (as currently set up), in parallel if workers are available
+    void sampleStatistics( QE::WorkerManager* workers, unsigned long samplePixels, imageBandStatistics& stats ); // Gather statistics for the whole image from a sample of the image data rows
+
     QByteArray imageData;             // Buffer to hold original image data.
     unsigned long imageBuffWidth;     // Original image width (may be generated directly from a width variable, or selected from the relevent dimension variable)
     unsigned long imageBuffHeight;    // Original image height (may be generated directly from a width variable, or selected from the relevent dimension variable)
@@ -78,11 +109,37 @@ private:
     int pixelHigh;
     unsigned int bitDepth;
     imageDisplayProperties::rgbPixel* pixelLookup;
+    QVector<imageDisplayProperties::rgbPixel> fullPixelLookup;  // Shared (not copied) with imageProperties until it is next regenerated
     QE::ImageFormatOptions formatOption;
     unsigned long imageDataSize;      // Size of elements in image data (originating from CA data type)
     imageDisplayProperties* imageDisplayProps;
     unsigned int rotatedImageBuffWidth;
     unsigned int rotatedImageBuffHeight;
+
+    bool compressed;                  // Image data is held (compressed) in compressedImage until decompressed
+    QENTNDArrayData compressedImage;  // Compressed image data
+    unsigned int compressedImageId;
+    QString imageSource;              // Image source (PV name) of the compressed image data
+    QCaDateTime imageTime;            // Time stamp of the compressed image data
+
+    QRect region;                     // Region of the image to build (in displayed image orientation). Null for the whole image
+
+    bool newImage;                    // Image is built from new image data (not a redisplay)
+    bool reducedStatistics;           // Statistics need not be published for this image (adaptive processing is reducing statistics work)
+    qint64 convertTime;               // Time taken to convert the image data (nS)
+    qint64 statisticsTime;            // Time taken to gather and publish statistics (nS)
+
+    imageAnalysisRequest analysisRequest; // Analysis to perform (according to the markups in use)
+    qint64 analysisTime;              // Time taken to analyse the image data (nS)
+
+    // Set up by buildImageCore() for use by buildImageBand()
+    const unsigned char* dataIn;                    // Input image data
+    imageDisplayProperties::rgbPixel* dataOut;      // Output image pixels
+    int outCount;                                   // Outer loop count (width or height) (output image rows)
+    int inCount;                                    // Inner loop count (height or width) (output image columns)
+    int start;                                      // Input data start pixel (one of the four corners)
+    int outInc;                                     // Outer loop increment to input data index
+    int inInc;                                      // Inner loop increment to input data index
 };
 
 /*!
@@ -158,6 +215,7 @@ protected:
     // Pixel information
     bool pixelLookupValid;            // pixelLookup is valid. It is invalid if anything that affects the translation changes, such as pixel format, local brigHtness, etc
     imageDisplayProperties::rgbPixel pixelLookup[256];
+    QVector<imageDisplayProperties::rgbPixel> fullPixelLookup;  // Lookup from pixel value (rather than scaled pixel value) to display pixel. Empty if not used
     int pixelLow;
     int pixelHigh;
 
@@ -34,6 +34,9 @@
  playback mode. When in playback mode the QEImage widget ensures it is not
  displaying live images.
 
+ This class emits a signal 'recordingFailed' if recording was stopped because
+ recorded images could not be spilled to disk.
+
  QEImage class can determine if this class is currently recording images by calling isRecording()
  When recording, the QEImage class can deliver new images to record by calling recordImage()
 
@@ -96,18 +99,27 @@ bool recording::isRecording()
 // Used by QEImage to record a new image.
 void recording::recordImage( QByteArray image, unsigned long dataSize, QCaAlarmInfo& alarmInfo, QCaDateTime& time )
 {
+    // If recorded images can no longer be spilled to disk, stop recording and report why
+    QString spillError;
+    if( history.getSpillError( spillError ) )
+    {
+        ui->pushButtonRecord->setChecked( false );
+        emit recordingFailed( QString( "Image recording stopped. %1" ).arg( spillError ) );
+        return;
+    }
+
     // Determine behaviour
     bool stopAtLimit = ui->radioButtonStopAtLimit->isChecked();
-    int limit = ui->spinBoxMaxImages->value();
 
     // Discard images if limit has been reached and not stopping when limit is reached
-    if( history.count() >= limit && !stopAtLimit )
+    // (more than one image may need to be discarded to get under the disk budget)
+    while( !stopAtLimit && history.count() && isAtLimit() )
     {
         history.removeFirst();
     }
 
     // If not at limit, add new image
-    if( history.count() < limit )
+    if( !isAtLimit() )
     {
         history.append( historicImage( image, dataSize, alarmInfo, time ) );
 
@@ -115,7 +127,7 @@ void recording::recordImage( QByteArray image, unsigned long dataSize, QCaAlarmI
     }
 
     // If limit has been reached, and stopping when limit is reached, then stop recording
-    if( history.count() >= limit && stopAtLimit )
+    if( isAtLimit() && stopAtLimit )
     {
         ui->pushButtonRecord->setChecked( false );
     }
@@ -125,6 +137,15 @@ void recording::recordImage( QByteArray image, unsigned long dataSize, QCaAlarmI
     ui->radioButtonPlayback->setEnabled( true );
 }
 
+// Determine if the recording limit has been reached.
+// The limit is reached when the maximum number of images have been recorded, or
+// when the recorded images spilled to disk have reached the disk budget, or when
+// images are being recorded faster than they can be spilled to disk.
+bool recording::isAtLimit()
+{
+    return history.count() >= ui->spinBoxMaxImages->value() || history.isFull();
+}
+
 // Start playing back recorded images
 void recording::startPlaying()
 {
@@ -149,10 +170,11 @@ void recording::showRecordedFrame( int currentFrame )
     if( currentFrame<0) //check for currentFrame <0 because it could be set to -1 by invalid slider position.
         return;
     // Get and display the frame
-    if( currentFrame < history.count() )
+    // (Images spilled to disk are retrieved from the spill file)
+    historicImage frame;
+    if( history.getFrame( currentFrame, frame ) )
     {
         ui->labelImageCountPlayback->setText( QString( "%1/%2" ).arg( currentFrame+1 ).arg( ui->horizontalSliderPosition->maximum()+1 ) );
-        historicImage frame = history.at( currentFrame );
         emit byteArrayChanged( frame.image, frame.dataSize, frame.alarmInfo, frame.time, 0 );
     }
 }
@@ -36,20 +36,7 @@
 #include <QByteArray>
 #include <QCaAlarmInfo.h>
 #include <QCaDateTime.h>
-
-// Class used to hold a record of a single image
-// Used when building a list of recorded images
-class historicImage
-{
-public:
-    historicImage( QByteArray image, unsigned long dataSize, QCaAlarmInfo& alarmInfo, QCaDateTime& time );
-    ~historicImage(){}
-
-    QByteArray image;
-    unsigned long dataSize;
-    QCaAlarmInfo alarmInfo;
-    QCaDateTime time;
-};
+#include <recordingStore.h>
 
 namespace Ui {
     class recording;
@@ -86,10 +73,11 @@ private:
     void startPlaying();            // Start playing back recorded images
     void stopPlaying();             // Stop playback (still in playback mode)
     void showRecordedFrame( int currentFrame );
+    bool isAtLimit();               // Determine if the recording limit (number of images or disk budget) has been reached
 
     playbackTimer* timer;           // Playback timer
     Ui::recording *ui;              // Recording and playback controls
-    QList<historicImage> history;   // Saved images
+    recordingStore history;         // Saved images (held in memory up to a memory budget, then spilled to disk)
 
     // Icons
     QIcon* pauseIcon;
@@ -101,6 +89,7 @@ private:
 signals:
   void byteArrayChanged( const QByteArray& value, unsigned long dataSize, QCaAlarmInfo& alarmInfo, QCaDateTime& timeStamp, const unsigned int& variableIndex );
   void playingBack( bool playing );
+  void recordingFailed( QString error );
 
 private slots:
     void on_pushButtonPlay_toggled(bool checked);
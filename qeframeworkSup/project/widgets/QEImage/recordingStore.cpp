@@ -0,0 +1,595 @@
+/*  recordingStore.cpp
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Rhyder
+ *  Contact details:
+ *    andrew.rhyder@synchrotron.org.au
+ */
+
+/*
+ This class stores the images recorded by the recording class.
+
+ Images are added with append() and discarded (oldest first) with removeFirst().
+ While the image data held in memory is within the memory budget, images are simply
+ held in memory. Once over budget, the oldest images held in memory are spilled to disk
+ by a spill thread. Adding an image never waits for images to be compressed or written.
+ If the spill thread falls well behind (or an image can't be spilled) the store is
+ considered full, so the images held in memory remain bounded. If an image can't be
+ spilled, no more images are spilled and the reason is available from getSpillError().
+
+ Spilled images are appended to a series of temporary spill file segments. Segments
+ are deleted once all the images in them have been discarded, so recording can continue
+ indefinitely when discarding the oldest images.
+
+ Spilled images are retrieved by mapping the image data in the spill file segment into
+ memory, so any image may be retrieved quickly in any order.
+
+ The following adaptation parameters are used:
+    QE_image_recording_memory       Memory budget (MBytes). Default 256.
+    QE_image_recording_disk         Disk budget (MBytes). Default 0 (no limit).
+    QE_image_recording_compression  Compression for spilled images: none, zlib, lz4 or blosc.
+                                    Default lz4 if available, otherwise none.
+    QE_image_recording_directory    Directory for spill files. Default is the system temporary directory.
+*/
+
+#include "recordingStore.h"
+#include <QDebug>
+#include <QDir>
+#include <QTemporaryFile>
+#include <QMutexLocker>
+#include <QECommon.h>
+#include <QEAdaptationParameters.h>
+
+#ifdef QE_AD_SUPPORT
+#include <blosc.h>
+#include <lz4.h>
+#endif
+
+#define DEBUG qDebug () << "recordingStore" << __LINE__ << __FUNCTION__ << " "
+
+// Images are appended to a spill file segment until it reaches this size
+#define SEGMENT_SIZE ((qint64)(256)*1024*1024)
+
+#define MBYTES ((qint64)(1024)*1024)
+
+// Minimum bytes of image data that may be waiting to be spilled before the store is considered full.
+// (Otherwise, up to the memory budget again may be waiting to be spilled)
+#define MIN_SPILL_BACKLOG (64*MBYTES)
+
+namespace {
+
+// Compress image data. Returns an empty array if the data could not be compressed,
+// or if compressing it would not reduce its size.
+static QByteArray compressImage( const QByteArray& image, unsigned long dataSize, recordingStore::compressions compression )
+{
+    QByteArray result;
+    switch( compression )
+    {
+        case recordingStore::COMPRESSION_ZLIB:
+            result = qCompress( image, 1 );
+            break;
+
+#ifdef QE_AD_SUPPORT
+        case recordingStore::COMPRESSION_LZ4:
+        {
+            result.resize( LZ4_compressBound( image.size() ) );
+            int size = LZ4_compress_default( image.constData(), result.data(), image.size(), result.size() );
+            result.resize( size > 0 ? size : 0 );
+            break;
+        }
+
+        case recordingStore::COMPRESSION_BLOSC:
+        {
+            // Shuffle by data element size so the bytes of multi byte pixels compress well
+            size_t typeSize = ( dataSize >= 1 && dataSize <= 8 ) ? dataSize : 1;
+            result.resize( image.size() + BLOSC_MAX_OVERHEAD );
+            int size = blosc_compress_ctx( 5, BLOSC_SHUFFLE, typeSize, image.size(), image.constData(),
+                                           result.data(), result.size(), "lz4", 0, 1 );
+            result.resize( size > 0 ? size : 0 );
+            break;
+        }
+#endif
+
+        default:
+            break;
+    }
+
+    Q_UNUSED( dataSize );
+
+    if( result.size() >= image.size() )
+    {
+        result.clear();
+    }
+    return result;
+}
+
+// Decompress image data. Returns false if the data could not be decompressed.
+static bool decompressImage( const char* data, qint64 size, int imageSize,
+                             recordingStore::compressions compression, QByteArray& image )
+{
+    switch( compression )
+    {
+        case recordingStore::COMPRESSION_NONE:
+            image = QByteArray( data, (int)size );
+            return true;
+
+        case recordingStore::COMPRESSION_ZLIB:
+            image = qUncompress( (const uchar*)data, (int)size );
+            return image.size() == imageSize;
+
+#ifdef QE_AD_SUPPORT
+        case recordingStore::COMPRESSION_LZ4:
+            image.resize( imageSize );
+            return LZ4_decompress_safe( data, image.data(), (int)size, imageSize ) == imageSize;
+
+        case recordingStore::COMPRESSION_BLOSC:
+            image.resize( imageSize );
+            return blosc_decompress_ctx( data, image.data(), imageSize, 1 ) == imageSize;
+#endif
+
+        default:
+            return false;
+    }
+}
+
+} // end anonymous namespace
+
+// Constructor for class used to hold a record of a single image
+// Used when building a list of recorded images
+historicImage::historicImage( QByteArray imageIn, unsigned long dataSizeIn, QCaAlarmInfo& alarmInfoIn, QCaDateTime& timeIn )
+{
+    image = imageIn;
+
+    dataSize = dataSizeIn;
+    alarmInfo = alarmInfoIn;
+    time = timeIn;
+}
+
+// Construction
+recordingStore::recordingStore()
+{
+    firstInMemory = 0;
+    nextId = 0;
+    memoryUsed = 0;
+    diskUsed = 0;
+    firstSegment = 0;
+
+    spiller = NULL;
+    finishNow = false;
+    releasePending = false;
+    spillFailed = false;
+
+    // Get options
+    QEAdaptationParameters ap( "QE_" );
+    memoryBudget = ap.getInt( "image_recording_memory", 256 ) * MBYTES;
+    diskBudget = ap.getInt( "image_recording_disk", 0 ) * MBYTES;
+    spillDirectory = ap.getFilename( "image_recording_directory", QDir::tempPath() );
+
+#ifdef QE_AD_SUPPORT
+    QString compressionName = ap.getString( "image_recording_compression", "lz4" ).toLower();
+#else
+    QString compressionName = ap.getString( "image_recording_compression", "none" ).toLower();
+#endif
+    if( compressionName == "zlib" )
+    {
+        compression = COMPRESSION_ZLIB;
+    }
+#ifdef QE_AD_SUPPORT
+    else if( compressionName == "lz4" )
+    {
+        compression = COMPRESSION_LZ4;
+    }
+    else if( compressionName == "blosc" )
+    {
+        compression = COMPRESSION_BLOSC;
+    }
+#endif
+    else
+    {
+        if( compressionName != "none" )
+        {
+            DEBUG << "Recording compression" << compressionName << "not available. Spilled images will not be compressed";
+        }
+        compression = COMPRESSION_NONE;
+    }
+}
+
+// Destruction
+recordingStore::~recordingStore()
+{
+    stopSpilling();
+    clear();
+}
+
+// Add an image.
+// If this takes the images held in memory over the memory budget, ask the spill thread to
+// spill the oldest images held in memory to disk.
+void recordingStore::append( const historicImage& frame )
+{
+    QMutexLocker locker( &lock );
+
+    recordedFrame newFrame;
+    newFrame.frame = frame;
+    newFrame.id = nextId++;
+    newFrame.spilled = false;
+    newFrame.segment = 0;
+    newFrame.offset = 0;
+    newFrame.storedSize = 0;
+    newFrame.imageSize = frame.image.size();
+    newFrame.compression = COMPRESSION_NONE;
+
+    frames.append( newFrame );
+    memoryUsed += newFrame.imageSize;
+
+    if( isSpillRequired() )
+    {
+        // Start the spill thread when first required
+        if( !spiller )
+        {
+            spiller = new recordingSpiller( this );
+            spiller->start();
+        }
+        spillSync.wakeOne();
+    }
+}
+
+// Discard the oldest image
+void recordingStore::removeFirst()
+{
+    QMutexLocker locker( &lock );
+
+    if( frames.isEmpty() )
+    {
+        return;
+    }
+
+    const recordedFrame& oldFrame = frames.first();
+    if( oldFrame.spilled )
+    {
+        diskUsed -= oldFrame.storedSize;
+        spillSegment* segment = getSegment( oldFrame.segment );
+        if( segment )
+        {
+            segment->liveFrames--;
+        }
+        firstInMemory--;
+    }
+    else
+    {
+        memoryUsed -= oldFrame.imageSize;
+    }
+    frames.removeFirst();
+
+    // Ask the spill thread to delete spill file segments no longer required
+    if( spiller )
+    {
+        releasePending = true;
+        spillSync.wakeOne();
+    }
+}
+
+// Discard all images.
+// If an image is being written to disk, wait for it to be written first.
+void recordingStore::clear()
+{
+    QMutexLocker fileLocker( &fileLock );
+    QMutexLocker locker( &lock );
+
+    frames.clear();
+    firstInMemory = 0;
+    memoryUsed = 0;
+    diskUsed = 0;
+
+    for( int i = 0; i < segments.count(); i++ )
+    {
+        delete segments[i].file;
+    }
+    segments.clear();
+    firstSegment = 0;
+
+    spillFailed = false;
+    spillError.clear();
+}
+
+// Number of images stored
+int recordingStore::count() const
+{
+    QMutexLocker locker( &lock );
+    return frames.count();
+}
+
+// Retrieve an image.
+// Images held in memory are returned directly. Spilled images are read from the spill file segment.
+bool recordingStore::getFrame( int index, historicImage& frame )
+{
+    recordedFrame storedFrame;
+    {// set scope of QMutexLocker
+        QMutexLocker locker( &lock );
+        if( index < 0 || index >= frames.count() )
+        {
+            return false;
+        }
+        storedFrame = frames.at( index );
+    }
+
+    frame = storedFrame.frame;
+    if( !storedFrame.spilled )
+    {
+        return true;
+    }
+
+    QMutexLocker fileLocker( &fileLock );
+    spillSegment* segment = getSegment( storedFrame.segment );
+    if( !segment )
+    {
+        return false;
+    }
+
+    // Map the image data and retrieve it
+    uchar* data = segment->file->map( storedFrame.offset, storedFrame.storedSize );
+    if( !data )
+    {
+        DEBUG << "Could not map recorded image:" << segment->file->errorString();
+        return false;
+    }
+    bool result = decompressImage( (const char*)data, storedFrame.storedSize, storedFrame.imageSize,
+                                   storedFrame.compression, frame.image );
+    segment->file->unmap( data );
+
+    return result;
+}
+
+// Return true if no more images should be added.
+// This is when the disk budget has been reached, or when the images waiting to be spilled have
+// reached the backlog limit (the spill thread has fallen well behind, or images can't be spilled).
+bool recordingStore::isFull() const
+{
+    QMutexLocker locker( &lock );
+    return ( diskBudget > 0 && diskUsed >= diskBudget ) ||
+           ( memoryUsed > memoryBudget + MAX( memoryBudget, MIN_SPILL_BACKLOG ) );
+}
+
+// Return true (and the reason) if an image could not be spilled to disk.
+bool recordingStore::getSpillError( QString& error ) const
+{
+    QMutexLocker locker( &lock );
+    error = spillError;
+    return spillFailed;
+}
+
+// Bytes of image data held in memory
+qint64 recordingStore::getMemoryUsed() const
+{
+    QMutexLocker locker( &lock );
+    return memoryUsed;
+}
+
+// Bytes of (live) image data spilled to disk
+qint64 recordingStore::getDiskUsed() const
+{
+    QMutexLocker locker( &lock );
+    return diskUsed;
+}
+
+// Return true if images held in memory are over the memory budget and the oldest may be spilled.
+// Always keep the newest image in memory.
+// Note, 'lock' must be held.
+bool recordingStore::isSpillRequired() const
+{
+    return !spillFailed && memoryUsed > memoryBudget && firstInMemory < frames.count()-1;
+}
+
+// Spill thread main loop.
+// Spill the oldest images held in memory until within the memory budget, and delete
+// spill file segments no longer required, until asked to finish.
+void recordingStore::spill()
+{
+    lock.lock();
+    while( !finishNow )
+    {
+        // Wait until there is something to do
+        bool spillRequired = isSpillRequired();
+        if( !spillRequired && !releasePending )
+        {
+            spillSync.wait( &lock );
+            continue;
+        }
+
+        // Take a (shared) reference to the oldest image held in memory
+        qint64 id = 0;
+        historicImage frame;
+        if( spillRequired )
+        {
+            id = frames.at( firstInMemory ).id;
+            frame = frames.at( firstInMemory ).frame;
+        }
+        releasePending = false;
+        lock.unlock();
+
+        // Delete spill file segments no longer required
+        {// set scope of QMutexLocker
+            QMutexLocker fileLocker( &fileLock );
+            releaseSegments();
+        }
+
+        // Spill the image
+        if( spillRequired )
+        {
+            spillFrame( id, frame );
+        }
+
+        lock.lock();
+    }
+    lock.unlock();
+}
+
+// Write an image to the current spill file segment (called by the spill thread).
+// The image is compressed without holding any lock. Once written, the image data held in memory is released.
+// Returns false if the image could not be written, in which case no more images are spilled until clear() is called.
+bool recordingStore::spillFrame( qint64 id, const historicImage& frame )
+{
+    // Compress the image data if required (and if it helps)
+    QByteArray compressed;
+    if( compression != COMPRESSION_NONE )
+    {
+        compressed = compressImage( frame.image, frame.dataSize, compression );
+    }
+    const QByteArray& stored = compressed.isEmpty() ? frame.image : compressed;
+
+    QMutexLocker fileLocker( &fileLock );
+
+    // Start a new segment if there isn't one, or the current one is full
+    QString error;
+    if( segments.isEmpty() || segments.last().size + stored.size() > SEGMENT_SIZE )
+    {
+        if( !openSegment( error ) )
+        {
+            QMutexLocker locker( &lock );
+            spillFailed = true;
+            spillError = error;
+            return false;
+        }
+    }
+
+    // Write the image data.
+    // Flush it so it is available to be mapped when retrieved.
+    spillSegment& segment = segments.last();
+    if( segment.file->write( stored ) != stored.size() || !segment.file->flush() )
+    {
+        error = QString( "Could not write recorded image to %1: %2" ).arg( segment.file->fileName() ).arg( segment.file->errorString() );
+        DEBUG << error;
+        segment.file->seek( segment.size );
+
+        QMutexLocker locker( &lock );
+        spillFailed = true;
+        spillError = error;
+        return false;
+    }
+    const qint64 offset = segment.size;
+    segment.size += stored.size();
+
+    // Note the image has been spilled and release the image data held in memory.
+    // (unless the image was discarded while being spilled)
+    QMutexLocker locker( &lock );
+    if( firstInMemory < frames.count() && frames.at( firstInMemory ).id == id )
+    {
+        recordedFrame& spilledFrame = frames[firstInMemory];
+        spilledFrame.spilled = true;
+        spilledFrame.segment = firstSegment + segments.count()-1;
+        spilledFrame.offset = offset;
+        spilledFrame.storedSize = stored.size();
+        spilledFrame.compression = compressed.isEmpty() ? COMPRESSION_NONE : compression;
+        spilledFrame.frame.image = QByteArray();
+
+        memoryUsed -= spilledFrame.imageSize;
+        diskUsed += stored.size();
+        segment.liveFrames++;
+        firstInMemory++;
+    }
+
+    return true;
+}
+
+// Start a new spill file segment (called by the spill thread with 'fileLock' held).
+// Returns false, and the reason, if the spill file could not be created.
+bool recordingStore::openSegment( QString& error )
+{
+    QTemporaryFile* file = new QTemporaryFile( QDir( spillDirectory ).filePath( "QEImageRecording_XXXXXX.dat" ) );
+    if( !file->open() )
+    {
+        error = QString( "Could not create recording spill file in %1: %2" ).arg( spillDirectory ).arg( file->errorString() );
+        DEBUG << error;
+        delete file;
+        return false;
+    }
+
+    spillSegment segment;
+    segment.file = file;
+    segment.size = 0;
+    segment.liveFrames = 0;
+
+    QMutexLocker locker( &lock );
+    segments.append( segment );
+
+    // The previous segment may no longer be required (if it was empty)
+    releasePending = true;
+
+    return true;
+}
+
+// Return a spill file segment given its number, or NULL if deleted
+recordingStore::spillSegment* recordingStore::getSegment( int segment )
+{
+    int index = segment - firstSegment;
+    if( index < 0 || index >= segments.count() )
+    {
+        return NULL;
+    }
+    return &segments[index];
+}
+
+// Delete spill file segments no longer required (called by the spill thread with 'fileLock' held).
+// The current segment (the last) is kept as images are still being added to it.
+void recordingStore::releaseSegments()
+{
+    QList<QTemporaryFile*> files;
+    {// set scope of QMutexLocker
+        QMutexLocker locker( &lock );
+        while( segments.count() > 1 && segments.first().liveFrames == 0 )
+        {
+            files.append( segments.first().file );
+            segments.removeFirst();
+            firstSegment++;
+        }
+    }
+
+    // Delete the files without holding 'lock'
+    for( int i = 0; i < files.count(); i++ )
+    {
+        delete files[i];
+    }
+}
+
+// Stop the spill thread (if running)
+void recordingStore::stopSpilling()
+{
+    if( !spiller )
+    {
+        return;
+    }
+
+    {// set scope of QMutexLocker
+        QMutexLocker locker( &lock );
+        finishNow = true;
+        spillSync.wakeOne();
+    }
+    spiller->wait();
+    delete spiller;
+    spiller = NULL;
+}
+
+// Spill thread starting point
+void recordingSpiller::run()
+{
+    store->spill();
+}
+
+// end
@@ -0,0 +1,164 @@
+/*  recordingStore.h
+ *
+ *  This file is part of the EPICS QT Framework, initially developed at the
+ *  Australian Synchrotron.
+ *
+ *  Copyright (c) 2026 Australian Synchrotron
+ *
+ *  The EPICS QT Framework is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  The EPICS QT Framework is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with the EPICS QT Framework.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Author:
+ *    Andrew Rhyder
+ *  Contact details:
+ *    andrew.rhyder@synchrotron.org.au
+ */
+
+/*
+ This class stores the images recorded by the recording class.
+
+ The most recent images are held in memory, up to a memory budget. Older images
+ are spilled (optionally compressed) to temporary files on disk by a spill thread,
+ so recording is not held up by compression or disk writes. An index of all
+ images is kept so any image can be retrieved, in any order, for playback.
+ */
+
+#ifndef QE_RECORDING_STORE_H
+#define QE_RECORDING_STORE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <QCaAlarmInfo.h>
+#include <QCaDateTime.h>
+
+class QTemporaryFile;
+class recordingStore;
+
+// Class used to hold a record of a single image
+// Used when building a list of recorded images
+class historicImage
+{
+public:
+    historicImage(){ dataSize = 0; }
+    historicImage( QByteArray image, unsigned long dataSize, QCaAlarmInfo& alarmInfo, QCaDateTime& time );
+    ~historicImage(){}
+
+    QByteArray image;
+    unsigned long dataSize;
+    QCaAlarmInfo alarmInfo;
+    QCaDateTime time;
+};
+
+// Thread used to spill recorded images to disk
+class recordingSpiller : public QThread
+{
+public:
+    recordingSpiller( recordingStore* storeIn ){ store = storeIn; }
+    recordingStore* store;
+    void run();
+};
+
+// Class used to store recorded images
+class recordingStore
+{
+public:
+    recordingStore();
+    ~recordingStore();
+
+    // Compression used for images spilled to disk
+    enum compressions { COMPRESSION_NONE,   // Not compressed
+                        COMPRESSION_ZLIB,   // qCompress() (always available)
+                        COMPRESSION_LZ4,    // LZ4 (only available if built with area detector support)
+                        COMPRESSION_BLOSC   // Blosc with byte shuffle (only available if built with area detector support)
+                      };
+
+    void append( const historicImage& frame );          // Add an image (older images are spilled to disk if over the memory budget)
+    void removeFirst();                                 // Discard the oldest image
+    void clear();                                       // Discard all images
+    int count() const;                                  // Number of images stored
+    bool getFrame( int index, historicImage& frame );   // Retrieve an image. Returns false if the image could not be retrieved
+
+    bool isFull() const;                                // The disk budget has been reached, or images are arriving faster than they can be spilled (no more images should be added)
+    bool getSpillError( QString& error ) const;         // Return true (and the reason) if an image could not be spilled to disk. Cleared by clear()
+    qint64 getMemoryUsed() const;                       // Bytes of image data held in memory
+    qint64 getDiskUsed() const;                         // Bytes of (live) image data spilled to disk
+
+private:
+    friend class recordingSpiller;
+
+    // Index entry for each image
+    struct recordedFrame
+    {
+        historicImage frame;    // The image. Image data is empty if spilled to disk
+        qint64 id;              // Unique image identifier (identifies the image being spilled)
+        bool spilled;           // Image data has been spilled to disk
+        int segment;            // Spill file segment number
+        qint64 offset;          // Offset to the image data in the spill file segment
+        qint64 storedSize;      // Size of the image data in the spill file segment
+        int imageSize;          // Size of the image data once retrieved
+        compressions compression; // Compression used for the spilled image data
+    };
+
+    // A spill file segment.
+    // Images are appended to the current segment until it is full.
+    // Once all images in a segment have been discarded the segment is deleted.
+    struct spillSegment
+    {
+        QTemporaryFile* file;
+        qint64 size;            // Bytes written
+        int liveFrames;         // Images not yet discarded
+    };
+
+    void spill();                                       // Spill images to disk until within the memory budget (spill thread)
+    bool isSpillRequired() const;                       // Images held in memory are over the memory budget and may be spilled
+    bool spillFrame( qint64 id, const historicImage& frame ); // Write an image to the current spill file segment (spill thread)
+    bool openSegment( QString& error );                 // Start a new spill file segment (spill thread)
+    spillSegment* getSegment( int segment );            // Return a spill file segment given its number, or NULL if deleted
+    void releaseSegments();                             // Delete spill file segments no longer required (spill thread)
+    void stopSpilling();                                // Stop the spill thread
+
+    // Locking.
+    // The spill thread compresses and writes images without holding 'lock' so adding images is never held
+    // up by spilling. 'fileLock' is held while the spill files are used, and while the list of segments is
+    // changed (along with 'lock'). If both are required, 'fileLock' is always taken first.
+    mutable QMutex lock;                // Protects the image index, the statistics, and the spill thread state
+    QMutex fileLock;                    // Protects the spill files
+    QWaitCondition spillSync;           // Wakes the spill thread (used with 'lock')
+
+    QList<recordedFrame> frames;        // All images, oldest first. Images still in memory follow all spilled images
+    int firstInMemory;                  // Index of the oldest image still in memory
+    qint64 nextId;                      // Identifier for the next image added
+    qint64 memoryUsed;                  // Bytes of image data held in memory
+    qint64 diskUsed;                    // Bytes of image data spilled to disk (excluding discarded images)
+
+    QList<spillSegment> segments;       // Spill file segments, oldest first
+    int firstSegment;                   // Segment number of segments[0]
+
+    recordingSpiller* spiller;          // Spill thread (NULL until first required)
+    bool finishNow;                     // Flag to the spill thread that it should exit
+    bool releasePending;                // Images have been discarded, spill file segments may no longer be required
+    bool spillFailed;                   // An image could not be spilled. No more images will be spilled until cleared
+    QString spillError;                 // Reason an image could not be spilled
+
+    // Options (from adaptation parameters)
+    qint64 memoryBudget;                // Bytes of image data that may be held in memory
+    qint64 diskBudget;                  // Bytes of image data that may be spilled to disk (0 for no limit)
+    compressions compression;           // Compression used for spilled images
+    QString spillDirectory;             // Directory for spill files
+};
+
+#endif // QE_RECORDING_STORE_H
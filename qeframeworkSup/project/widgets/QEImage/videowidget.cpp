@@ -33,6 +33,7 @@
 #include "videowidget.h"
 #include <QPainter>
 #include <QDebug>
+#include <QElapsedTimer>
 #include "QEImage.h"
 
 #define DEBUG qDebug() << "videowidget"  << __LINE__ << __FUNCTION__ << "  "
@@ -47,6 +48,8 @@ VideoWidget::VideoWidget(QEImage *parent) : QWidget(parent), owner (parent)
    paintExtraHandler = NULL;
    userContext = NULL;
    panning = false;
+   newImagePending = false;
+   regionRequested = false;
 
    setAutoFillBackground(false);
 
@@ -77,54 +80,90 @@ void VideoWidget::markupSetCursor( QCursor cursor )
 }
 
 //------------------------------------------------------------------------------
-// Ensure we have a reference image and it is the same size as the display.
+// Ensure we have a reference image at the same resolution as the display covering the required area of the display.
+// The reference image covers the visible part of the display (which is all of it unless zoomed).
 //
-void VideoWidget::createRefImage()
+void VideoWidget::createRefImage( const QRect& area )
 {
-   // Do nothing if the reference image has been set and is the correct size
+   // Do nothing if the reference image has been set and covers the required area
    // (it will not be set initially, or after a new image has arrived in which case it is cleared)
-   if( !refImage.isNull() && refImage.size() == size() )
+   if( !refImage.isNull() && refRect.contains( area ) )
    {
       return;
    }
 
-   // If the current image is present and is the same size as the the video widget,
+   // If the current image is present and is the whole image at the same size as the the video widget,
    // use the current image as the reference image.
    // (cheap - creates a shallow copy)
-   if( !currentImage.isNull() && currentImage.size() == size() )
+   if( !currentImage.isNull() && currentImage.size() == size() && currentImageRegion.size() == imageSize )
    {
       refImage = currentImage;
+      refRect = rect();
    }
 
    // If the current image is not present or the wrong size...
    else
    {
-      // Create a correctly sized reference image if one does not exist or it is the wrong size.
-      if( refImage.isNull() || refImage.size() != size() )
+      // Create a reference image covering the visible part of the display (and at least the required area).
+      QRect newRect = ( visibleRegion().boundingRect() | area ) & rect();
+      if( newRect.isEmpty() )
       {
-         refImage = QImage( size(), QImage::Format_RGB32 );
+         newRect = rect();
       }
+      if( refImage.isNull() || refImage.size() != newRect.size() || refImage.cacheKey() == currentImage.cacheKey() )
+      {
+         refImage = QImage( newRect.size(), QImage::Format_RGB32 );
+      }
+      refRect = newRect;
 
-      // If the current image exists, draw it scaled into the reference image
+      // Blank the reference image
       QPainter refPainter( &refImage );
+      QColor bg(0, 0, 0, 255);
+      refPainter.fillRect( refImage.rect(), bg );
+
+      // If the current image exists, draw it scaled into the reference image
       if( !currentImage.isNull() )
       {
-         refPainter.drawImage( refImage.rect(), currentImage, currentImage.rect() );
+         refPainter.translate( -refRect.topLeft() );
+         refPainter.drawImage( getDisplayedRegion(), currentImage, currentImage.rect() );
       }
+   }
+}
 
-      // If the current image does not exists, blank the reference image
-      else
-      {
-         QColor bg(0, 0, 0, 255);
-         refPainter.fillRect(rect(), bg);
-      }
+//------------------------------------------------------------------------------
+// Return the area of the display covered by the current image.
+// (The current image may only be a region of the whole image)
+//
+QRectF VideoWidget::getDisplayedRegion() const
+{
+   if( imageSize.isEmpty() )
+   {
+      return QRectF( rect() );
    }
+
+   double xScale = (double)width() / (double)imageSize.width();
+   double yScale = (double)height() / (double)imageSize.height();
+   return QRectF( currentImageRegion.x() * xScale,
+                  currentImageRegion.y() * yScale,
+                  currentImageRegion.width() * xScale,
+                  currentImageRegion.height() * yScale );
 }
 
 //------------------------------------------------------------------------------
 // The displayed image has changed, redraw it
 //
 void VideoWidget::setNewImage( QImage image, QCaDateTime& time )
+{
+   setNewImage( image, time, image.size() );
+}
+
+//------------------------------------------------------------------------------
+// The displayed image has changed, redraw it.
+// The image may be only a region of the whole image (for example, when zoomed
+// only the visible region may be built). If so, the image offset is the position
+// of the region in the whole image.
+//
+void VideoWidget::setNewImage( QImage image, QCaDateTime& time, QSize wholeImageSize )
 {
    // Note if this is the first image update
    bool firstImage = currentImage.isNull();
@@ -133,6 +172,17 @@ void VideoWidget::setNewImage( QImage image, QCaDateTime& time )
    // (cheap - creates a shallow copy)
    currentImage = image;
 
+   // Note the region of the whole image the image covers.
+   // If it does not fit (the image dimensions have changed since it was built) treat it as the whole image.
+   imageSize = wholeImageSize;
+   currentImageRegion = QRect( image.offset(), image.size() );
+   if( imageSize.isEmpty() || !QRect( QPoint( 0, 0 ), imageSize ).contains( currentImageRegion ) )
+   {
+      imageSize = image.size();
+      currentImageRegion = image.rect();
+   }
+   regionRequested = false;
+
    // Invalidate the current reference image
    refImage = QImage();
 
@@ -140,7 +190,7 @@ void VideoWidget::setNewImage( QImage image, QCaDateTime& time )
    setMarkupTime( time );
 
    // Ensure the markup system is aware of the image size
-   setImageSize( currentImage.size() );
+   setImageSize( imageSize );
 
    // Ensure the markup scaling is correct.
    // The scaling is set up on the first image (here), and each resize (in the resize event)
@@ -150,6 +200,8 @@ void VideoWidget::setNewImage( QImage image, QCaDateTime& time )
    }
 
    // Cause a repaint with the new image
+   // (If another image arrives before the repaint, this image will never be painted)
+   newImagePending = true;
    update();
 }
 
@@ -222,17 +274,30 @@ VideoWidget::CustomisePaintHandlers VideoWidget::getCustomisePaintHandler () con
 // Manage a paint event in the video widget
 void VideoWidget::paintEvent(QPaintEvent* event )
 {
+   // Time the paint (for image pipeline statistics)
+   QElapsedTimer paintTimer;
+   paintTimer.start();
+
    // Create the reference image.
    // It may be created now if there has never been an update, which is likely
    // at creation before an image update has arrived.
-   createRefImage();
+   createRefImage( event->rect() );
+
+   // If the current image is only a region of the whole image, and it does not cover the area being
+   // painted (for example, the image has been scrolled or zoomed out), ask for the image to be rebuilt.
+   if( !currentImage.isNull() && !regionRequested && currentImageRegion.size() != imageSize &&
+       !getDisplayedRegion().contains( QRectF( event->rect() & rect() ) ) )
+   {
+      regionRequested = true;
+      emit imageRegionRequired();
+   }
 
    // Build a painter and only bother about the changed area
    QPainter painter(this);
    painter.setClipRect( event->rect() );
 
    // Update the display with the reference image.
-   painter.drawImage( event->rect(), refImage, event->rect() );
+   painter.drawImage( event->rect(), refImage, event->rect().translated( -refRect.topLeft() ) );
 
    // Update any markups
    if( !currentImage.isNull() )
@@ -247,6 +312,13 @@ void VideoWidget::paintEvent(QPaintEvent* event )
 
    // Report position for pixel info logging
    emit currentPixelInfo( pixelInfoPos );
+
+   // If this paint presented a new image, report it
+   if( newImagePending )
+   {
+      newImagePending = false;
+      emit imagePainted( paintTimer.nsecsElapsed() );
+   }
 }
 
 //------------------------------------------------------------------------------
@@ -334,7 +406,7 @@ int VideoWidget::scaleImageOrdinate( int ord )
 // Return the displayed size of the current image
 QSize VideoWidget::getImageSize()
 {
-   return currentImage.size();
+   return imageSize;
 }
 
 //------------------------------------------------------------------------------
@@ -349,11 +421,11 @@ bool VideoWidget::hasCurrentImage()
 double VideoWidget::getXScale() const
 {
    // If for any reason a scale can't be determined, return scale of 1.0
-   if( currentImage.isNull() || currentImage.width() == 0 || width() == 0)
+   if( currentImage.isNull() || imageSize.width() == 0 || width() == 0)
       return 1.0;
 
    // Return the horizontal scale of the displayed image
-   return (double)width() / (double)currentImage.width();
+   return (double)width() / (double)imageSize.width();
 }
 
 //------------------------------------------------------------------------------
@@ -361,11 +433,11 @@ double VideoWidget::getXScale() const
 double VideoWidget::getYScale() const
 {
    // If for any reason a scale can't be determined, return scale of 1.0
-   if( currentImage.isNull() || currentImage.height() == 0 || height() == 0)
+   if( currentImage.isNull() || imageSize.height() == 0 || height() == 0)
       return 1.0;
 
    // Return the vertical scale of the displayed image
-   return (double)height() / (double)currentImage.height();
+   return (double)height() / (double)imageSize.height();
 }
 
 
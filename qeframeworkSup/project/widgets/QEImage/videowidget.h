@@ -46,6 +46,7 @@ public:
    ~VideoWidget();
 
    void setNewImage( QImage image, QCaDateTime& time );
+   void setNewImage( QImage image, QCaDateTime& time, QSize wholeImageSize );  // Image may be a region of the whole image (positioned by the image offset)
    void setPanning( bool panningIn );
    bool getPanning();
    QPoint scalePoint( QPoint pnt );
@@ -96,13 +97,20 @@ signals:
    void currentPixelInfo( QPoint pos );
    void pan( QPoint pos );
    void redraw();
+   void imagePainted( qint64 paintNSecs );  // A new image has been painted (and how long it took)
+   void imageRegionRequired();              // The current image is only a region of the whole image and more of the image is now required (for example, after scrolling)
 
 private:
    void addMarkups( QPainter& screenPainter, QVector<QRect>& changedAreas );
 
-   QImage currentImage;              // Latest camera image
+   QImage currentImage;              // Latest camera image (may be only a region of the whole image)
+   QRect  currentImageRegion;        // Region of the whole image covered by the latest camera image
+   QSize  imageSize;                 // Size of the whole image
    QImage refImage;                  // Latest camera image at the same resolution as the display - used for erasing markups when they are moved
-   void   createRefImage();          // Create a reference image the same size as currently being viewed.
+   QRect  refRect;                   // Area of the display covered by the reference image (the visible area of the display)
+   void   createRefImage( const QRect& area );  // Create a reference image at the display resolution covering (at least) the given area.
+   QRectF getDisplayedRegion() const;           // Return the area of the display covered by the current image
+   bool   regionRequested;           // More of the whole image has been requested (imageRegionRequired() has been emitted)
 
    double getXScale() const;         // Currently only this used - markups zoom incorrectly when X stretch != Y stretch
    double getYScale() const;         // Place holder function.
@@ -115,6 +123,8 @@ private:
    QPoint panStart;
 
    QPoint pixelInfoPos;    // Current pixel under pointer
+
+   bool newImagePending;   // A new image has been set but not yet painted
 };
 
 #endif // QE_VIDEO_WIDGET_H
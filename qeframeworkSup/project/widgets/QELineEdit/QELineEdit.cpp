@@ -69,7 +69,11 @@ qcaobject::QCaObject* QELineEdit::createQcaItem( unsigned int variableIndex ) {
 
     // Create the item as a QEString
     QString pvName = getSubstitutedVariableName( variableIndex );
-    result = new QEString( pvName, this, &stringFormatting, variableIndex );
+    QEString* qca = new QEString( pvName, this, &stringFormatting, variableIndex );
+
+    // Don't re-format and re-display the text unless it (or the alarm state) would change.
+    qca->setSuppressUnchanged( true );
+    result = qca;
 
     // Apply currently defined array index/elements request values.
     setSingleVariableQCaProperties( result );
@@ -274,7 +274,7 @@ void QEPlot::Trace::setArchiveData (const QCaDataPointList& archiveData)
       // There may be overlap between live/real time data and histrotical
       // archive data, so purge duplicate arhioive data
       //
-      const QCaDateTime firstLiveTime = this->scalarData.value(0).datetime;
+      const QCaTimeStamp firstLiveTime = this->scalarData.value(0).datetime;
       const int posn = mergedData.indexBeforeTime (firstLiveTime, mergedData.count());
       mergedData.truncate (posn);
    }
@@ -728,7 +728,7 @@ void QEPlot::connectionChanged (QCaConnectionInfo& connectionInfo,
       // create a dummy point with last value and time now.
       //
       QCaDataPoint point = tr->scalarData.last ();
-      point.datetime = QDateTime::currentDateTime ().toUTC ();
+      point.datetime = QCaTimeStamp::currentTime ();
       tr->scalarData.append (point);
 
       // create a dummy point with same time but marked invalid to indicate a break.
@@ -936,8 +936,7 @@ void QEPlot::purgeOldData () {
    // Remove any old data
    // Find chart start time.
    //
-   QDateTime startTime = QDateTime::currentDateTime ().toUTC();
-   startTime = startTime.addSecs (-this->timeSpan);
+   const QCaTimeStamp startTime = QCaTimeStamp::currentTime ().addSeconds (-this->timeSpan);
 
    for (int i = 0; i < QEPLOT_NUM_PLOTS; i++) {
       Trace* tr = this->traces[i];
@@ -945,7 +944,7 @@ void QEPlot::purgeOldData () {
          // Check the time of the oldest but one.
          // We need to keep at least one prior to the start time.
          //
-         QCaDateTime datetime = tr->scalarData.value(1).datetime;
+         const QCaTimeStamp datetime = tr->scalarData.value(1).datetime;
          if (datetime < startTime) {
             tr->scalarData.removeFirst ();
          } else {
@@ -959,7 +958,7 @@ void QEPlot::purgeOldData () {
 //
 void QEPlot::plotData ()
 {
-   const QCaDateTime now = QDateTime::currentDateTimeUtc();
+   const QCaTimeStamp now = QCaTimeStamp::currentTime ();
 
    // First release any/all allocated curves.
    //
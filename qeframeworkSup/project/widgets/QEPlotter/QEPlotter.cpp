@@ -42,6 +42,7 @@
 
 #include <QEPlatform.h>
 #include <QECommon.h>
+#include <QENumericKernels.h>
 #include <QEFloating.h>
 #include <QEInteger.h>
 #include <QEScaling.h>
@@ -2633,12 +2634,7 @@ void QEPlotter::plot ()
       // NOTE: It would probably best not to plot NaN/Inf values at all,
       //       but for now set unplotable values to 0.0
       //
-      for (int j = 0; j < number; j++) {
-         double y = ydata [j];
-         if (QEPlatform::isNaN(y) || QEPlatform::isInf(y)) {
-            ydata [j] = 0.0;
-         }
-      }
+      QENumericKernels::replaceNonFinite (ydata.data (), number, 0.0);
 
       // Scale the y data as required.
       //
@@ -2655,10 +2651,7 @@ void QEPlotter::plot ()
             c = 0.0;
          }
 
-         for (int j = 0; j < number; j++) {
-            double t = ydata [j];
-            ydata [j] = m*t + c;
-         }
+         QENumericKernels::affine (ydata.data (), number, m, c);
       }
 
       // Lastly plot the data.
@@ -31,7 +31,6 @@
 #include <QStringList>
 
 #include <ui_QEPVLoadSaveNameSelectDialog.h>
-#include <QEPvNameSearch.h>
 #include <QEArchiveManager.h>
 #include <QEPVNameSelectDialog.h>
 #include <QEScaling.h>
@@ -146,18 +145,12 @@ void QEPVLoadSaveNameSelectDialog::applyFilter ()
    const QString pattern = this->ui->filterEdit->text ().trimmed ();
    const QRegularExpression re (pattern, QRegularExpression::NoPatternOption);
 
-   // Form list of PV names from both the user defined arbitary list
+   // Find matching PV names from both the user defined arbitary list
    // and the list extarcted from the QEArchiveAccess.
    //
-   QEPvNameSearch findNames (QEPVNameSelectDialog::getPvNameList());
-
-   // addPvNameList ensures overall set of names is sorted and unique.
-   //
-   findNames.addPvNameList (QEArchiveAccess::getAllPvNames ());
-   const int m = findNames.count ();
-
+   int m = 0;
    this->filteredNames.clear ();
-   this->filteredNames = findNames.getMatchingPvNames (re, true);
+   this->filteredNames = QEPVNameSelectDialog::getMatchingPvNames (re, m);
    const int n = this->filteredNames.count ();
 
    for (int j = 0; j < PT_NUMBER; j++) {
@@ -29,7 +29,10 @@
 
 #include <QList>
 #include <QModelIndex>
+#include <QMultiHash>
 #include <QObject>
+#include <QPointer>
+#include <QSet>
 #include <QString>
 #include <QStringList>
 #include <QTreeView>
@@ -173,6 +176,8 @@ protected:
 };
 
 
+class QEPvLoadSaveLeaf;   // differed
+
 //------------------------------------------------------------------------------
 // Sub class for group
 //
@@ -201,6 +206,29 @@ public:
    QEPvLoadSaveCommon::StatusSummary getStatusSummary () const;
 
    QEPvLoadSaveCommon::PvNameValueMaps getPvNameValueMap () const;
+
+private:
+   // Appends all leaf items at or below this group.
+   //
+   void appendLeaves (QList<QEPvLoadSaveLeaf*>& leaves) const;
+
+   // Archive values are read using a single bulk request for all leaves as
+   // opposed to one request per leaf. The access object is created on demand.
+   //
+   QEArchiveAccess* archiveAccess;
+   QMultiHash<QString, QPointer<QEPvLoadSaveLeaf> > archiveLeaves;  // by archiver PV name
+
+   // Each request is tagged with its own object, passed as the user data, so
+   // that a late response to an earlier request can be identified and dropped.
+   // A tag is only deleted once its response has arrived, so the address
+   // cannot be reused by a later tag while that response is outstanding.
+   //
+   QObject* archiveRequestTag;                 // current request
+   QSet<const QObject*> archiveRequestTags;    // all outstanding requests
+
+private slots:
+   void setArchiveValuesAtTime (const QObject* userData,
+                                const QEArchiveAccess::PVValueAtTimeList& values);
 };
 
 
@@ -273,6 +301,13 @@ signals:
                                 const QEPvLoadSaveCommon::ActionKinds action);
 
 private:
+   friend class QEPvLoadSaveGroup;
+
+   // Used by QEPvLoadSaveGroup for bulk archive reads.
+   //
+   void beginReadArchiveData (const QCaDateTime& dateTime);
+   void setArchiveValueAtTime (const bool okay, const QCaDataPoint& point);
+
    QString calcNodeName () const;  // Merges three PV names into a single node name.
    void setupQCaObjects ();        // Create/updates internal QCaObjects
    void determineDeltaAndLeafStatus () const;
@@ -885,7 +885,7 @@ void QEStripChart::plotMouseMove  (const QPointF& position)
       if (nearest) {
          QEStripChartItem* item = this->getItem (this->selectedPointSlot);
          if (item) {
-            this->selectedPointDateTime = nearest->datetime;
+            this->selectedPointDateTime = QCaDateTime (nearest->datetime);
             this->selectedPointValue = nearest->value;
 
             this->plotArea->setMarkupVisible (QEGraphicNames::Box, true);
@@ -902,7 +902,7 @@ void QEStripChart::plotMouseMove  (const QPointF& position)
             const QString desc = item->getDescription();
             if (!desc.isEmpty()) info.append (desc);
             info.append (QString ("%1 %2").arg (svalue).arg (item->getEgu ()));
-            info.append (nearest->datetime.toString (format).left (format.length() - 2));
+            info.append (QCaDateTime (nearest->datetime).toString (format).left (format.length() - 2));
 
             this->plotArea->setMarkupData (QEGraphicNames::Box, QVariant (info));
             this->setContextMenuPolicy (Qt::NoContextMenu);
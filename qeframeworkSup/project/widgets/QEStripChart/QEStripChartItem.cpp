@@ -124,6 +124,11 @@ QEStripChartItem::QEStripChartItem (QEStripChart* chartIn,
    this->lastExpressionValueIsDefined = false;
    this->lastExpressionValue = 0.0;
 
+   this->coarseArchiveTag = NULL;
+   this->fineArchiveTag = NULL;
+   this->archiveWindowDuration = 0;
+   this->archiveWindowIsRealTime = false;
+
    // Set up other properties.
    //
    this->pvSlotLetter->setStyleSheet (letterStyle);
@@ -587,7 +592,7 @@ QEDisplayRanges QEStripChartItem::getBufferedMinMax (bool doScale) const
 QPointF QEStripChartItem::dataPointToReal (const QCaDataPoint& point) const
 {
 
-   const QCaDateTime end_time = this->chart->getEndDateTime ();
+   const QCaTimeStamp end_time = QCaDateTime (this->chart->getEndDateTime ()).toTimeStamp ();
    const double t = end_time.secondsTo (point.datetime);
    QPointF result = QPointF (PLOT_T (t), PLOT_Y (point.value));
    return result;
@@ -600,8 +605,8 @@ void QEStripChartItem::plotDataPoints (const QCaDataPointList& dataPoints,
                                        const Qt::PenStyle penStyle,
                                        QEDisplayRanges& plottedTrackRange)
 {
-   const QCaDateTime start_time = this->chart->getStartDateTime ();
-   const QCaDateTime end_time = this->chart->getEndDateTime ();
+   const QCaTimeStamp start_time = QCaDateTime (this->chart->getStartDateTime ()).toTimeStamp ();
+   const QCaTimeStamp end_time = QCaDateTime (this->chart->getEndDateTime ()).toTimeStamp ();
    const double duration = this->chart->getDuration ();
    QEGraphic* graphic = this->chart->plotArea;
 
@@ -774,7 +779,7 @@ void QEStripChartItem::plotDataPoints (const QCaDataPointList& dataPoints,
 //
 QCaDataPointList QEStripChartItem::extractPlotPoints (const bool doBuffered) const
 {
-   const QCaDateTime end_time = this->chart->getEndDateTime ();
+   const QCaTimeStamp end_time = QCaDateTime (this->chart->getEndDateTime ()).toTimeStamp ();
    const double duration = this->chart->getDuration ();
 
    QCaDataPointList result;
@@ -818,6 +823,8 @@ void QEStripChartItem::plotData ()
 {
    QEDisplayRanges temp;
 
+   this->checkArchiveReads ();
+
    this->displayedMinMax.clear ();
    this->firstPointIsDefined = false;
 
@@ -1005,7 +1012,7 @@ void QEStripChartItem::setDataConnection (QCaConnectionInfo& connectionInfo, con
       // create a dummy point with last value and time now.
       //
       QCaDataPoint point = this->realTimeDataPoints.last ();
-      point.datetime = QDateTime::currentDateTime ().toUTC ();
+      point.datetime = QCaTimeStamp::currentTime ();
       this->addRealTimeDataPoint (point);
 
       // create a dummy point with same time but marked invalid to indicate a break.
@@ -1062,7 +1069,7 @@ void QEStripChartItem::setDataValue (const QVariant& value, QCaAlarmInfo& alarm,
    // receive time.
    //
    if (this->useReceiveTime) {
-      point.datetime = QDateTime::currentDateTime ().toUTC ();
+      point.datetime = QCaTimeStamp::currentTime ();
    } else {
       point.datetime = datetime;
    }
@@ -1080,11 +1087,49 @@ void QEStripChartItem::setArchiveData (const QObject* userData, const bool okay,
                                        const QCaDataPointList& archiveData,
                                        const QString& pvName, const QString& supplementary)
 {
-   QCaDateTime firstRealTime;
+   if (userData == this) {
+      // Not an archive response per se, e.g. re-calculated values.
+      //
+      this->applyArchiveData (okay, archiveData, pvName, supplementary);
+      return;
+   }
+
+   if (!this->archiveTags.contains (userData)) return;   // not one of ours
+   this->archiveTags.remove (userData);
+
+   const bool isCoarse = (userData == this->coarseArchiveTag);
+   const bool isFine = (userData == this->fineArchiveTag);
+   delete (QObject*) userData;
+
+   if (isFine) {
+      // Any outstanding coarse data is now redundant.
+      //
+      this->fineArchiveTag = NULL;
+      if (this->coarseArchiveTag) {
+         this->archiveAccess.cancelReadArchive (this->coarseArchiveTag);
+         this->coarseArchiveTag = NULL;
+      }
+      this->applyArchiveData (okay, archiveData, pvName, supplementary);
+
+   } else if (isCoarse) {
+      this->coarseArchiveTag = NULL;
+      this->applyArchiveData (okay, archiveData, pvName, supplementary);
+   }
+
+   // else a superseded or cancelled request - just ignore.
+}
+
+//------------------------------------------------------------------------------
+//
+void QEStripChartItem::applyArchiveData (const bool okay,
+                                         const QCaDataPointList& archiveData,
+                                         const QString& pvName, const QString& supplementary)
+{
+   QCaTimeStamp firstRealTime;
    int count;
    QCaDataPoint point;
 
-   if ((userData == this) && (okay)) {
+   if (okay) {
 
       this->dashExists = false;
 
@@ -1122,7 +1167,7 @@ void QEStripChartItem::setArchiveData (const QObject* userData, const bool okay,
          if (this->realTimeDataPoints.count () > 0) {
             firstRealTime = this->realTimeDataPoints.value (0).datetime;
          } else {
-            firstRealTime = QDateTime::currentDateTime ().toUTC ();
+            firstRealTime = QCaTimeStamp::currentTime ();
          }
 
          // Look at first historical data point.
@@ -1169,7 +1214,7 @@ void QEStripChartItem::setArchiveData (const QObject* userData, const bool okay,
             // Limit Time to be no more than live data or or 10 seconds.
             //
             QCaDataPoint virtualPoint = lastPoint;
-            QCaDateTime plus10 = lastPoint.datetime.addSeconds (10.0);
+            const QCaTimeStamp plus10 = lastPoint.datetime.addSeconds (10.0);
             virtualPoint.datetime = MIN (firstRealTime, plus10);
 
             // Append virtual historical point.
@@ -1213,55 +1258,115 @@ void QEStripChartItem::readArchive ()
 {
    if (!this->isPvData ()) return;  // sanity check
 
-   const double chartDuration =  this->chart->getDuration();  // in seconds
+   const int chartDuration = this->chart->getDuration();  // in seconds
 
    // For longer time frames use selected data extractions.
    // For short time frames, we can accomodate raw data extraction.
    //
-   const double rawLimit = 10.0 * 60.0;
+   const int rawLimit = 10 * 60;
    QEArchiveInterface::How how =
          (chartDuration >= rawLimit) ? this->archiveReadHow : QEArchiveInterface::Raw;
 
-   // Depending on the mode, we actually request a bit more  before
-   // and/or after the displayed window in order to cashe data for when
-   // the operator pages forward or backwards.
-   //
-   // However we limit any extra size to at most one day.
-   //
-   const double aday = 24.0 * 60.0 * 60.0;
-   double extra;
-   switch (how) {
-      case QEArchiveInterface::Raw:          extra = 0.0;                        break;
-      case QEArchiveInterface::SpreadSheet:  extra = 0.0;                        break;
-      case QEArchiveInterface::Averaged:     extra = MIN (aday, chartDuration);  break;
-      case QEArchiveInterface::PlotBinning:  extra = 0.0;                        break;
-      case QEArchiveInterface::Linear:       extra = MIN (aday, chartDuration);  break;
-      default:                               extra = 0.0;                        break;
-   }
+   // Assign the chart widget message source id the the associated archive access object.
+   // We re-assign just before each read in case it has changed.
+   //
+   this->archiveAccess.setMessageSourceId (this->chart->getMessageSourceId ());
 
-   const QDateTime archiveStartDateTime = this->chart->getStartDateTime ().addSecs (-extra);
-   const QDateTime archiveEndDateTime   = this->chart->getEndDateTime ().addSecs (+extra);
+   // Any outstanding requests are now redundant.
+   //
+   this->cancelArchiveReads ();
 
-   // Doesn't apply to Plot_Binning which return up to the maximum
-   // supported by archiver (currently 10K).
+   const QDateTime startDateTime = this->chart->getStartDateTime ();
+   const QDateTime endDateTime = this->chart->getEndDateTime ();
+
+   this->archiveWindowEnd = endDateTime;
+   this->archiveWindowDuration = chartDuration;
+   this->archiveWindowIsRealTime =
+         (this->chart->chartTimeMode == QEStripChartNames::tmRealTime);
+   this->archiveRequestTime = QDateTime::currentDateTime ();
+
+   // Data is loaded progressively. First make a quick, coarse, plot binning
+   // request for the displayed window with approx one bin per pixel, but no
+   // less than one second per bin, the archiver's minimum. This is plotted
+   // as soon as it arrives.
    //
-   int numberPoints = MAXIMUM_HISTORY_POINTS;
+   const int pixels = this->chart->plotArea->getEmbeddedCanvasGeometry ().width ();
+   const int numberBins = LIMIT (MIN (pixels, chartDuration), 1, MAXIMUM_HISTORY_POINTS / 4);
+
+   this->coarseArchiveTag = this->archiveRead (startDateTime, endDateTime,
+                                               numberBins, QEArchiveInterface::PlotBinning);
 
+   // Then refine just the displayed window, i.e. raw data for short time frames,
+   // or the selected extraction (which for plot binning means finer bins).
+   // This replaces the coarse data, and any outstanding coarse request is
+   // cancelled. Paging forward or backwards makes new requests (which may
+   // well be satisfied by the archive segment cache).
+   //
+   this->fineArchiveTag = this->archiveRead (startDateTime, endDateTime,
+                                             MAXIMUM_HISTORY_POINTS, how);
+
+   // The responses go to the setArchiveData slot method.
+}
+
+//------------------------------------------------------------------------------
+// Returns the request's tag object, i.e. the request's user data.
+//
+QObject* QEStripChartItem::archiveRead (const QDateTime& startDateTime,
+                                        const QDateTime& endDateTime,
+                                        const int count,
+                                        const QEArchiveInterface::How how)
+{
    // Extract the array element index used to display this PV.
    // Go with zero for now.
    //
-   int arrayIndex = 0;
+   const int arrayIndex = 0;
 
-   // Assign the chart widget message source id the the associated archive access object.
-   // We re-assign just before each read in case it has changed.
-   //
-   this->archiveAccess.setMessageSourceId (this->chart->getMessageSourceId ());
+   QObject* tag = new QObject (this);
+   this->archiveTags.insert (tag);
 
    this->archiveAccess.readArchive
-         (this, this->getPvName (), archiveStartDateTime, archiveEndDateTime,
-          numberPoints, how, arrayIndex);
+         (tag, this->getPvName (), startDateTime, endDateTime,
+          count, how, arrayIndex);
 
-   // The response goes to the setArchiveData slot method.
+   return tag;
+}
+
+//------------------------------------------------------------------------------
+// Note: the tag objects are retained until the (cancelled) responses arrive.
+//
+void QEStripChartItem::cancelArchiveReads ()
+{
+   if (this->coarseArchiveTag) {
+      this->archiveAccess.cancelReadArchive (this->coarseArchiveTag);
+      this->coarseArchiveTag = NULL;
+   }
+
+   if (this->fineArchiveTag) {
+      this->archiveAccess.cancelReadArchive (this->fineArchiveTag);
+      this->fineArchiveTag = NULL;
+   }
+}
+
+//------------------------------------------------------------------------------
+// If the user has zoomed or panned since the archive data was requested, that
+// data is no longer wanted. Whilst in real time mode, the window moves with
+// the current time, but that is not panning.
+//
+void QEStripChartItem::checkArchiveReads ()
+{
+   if (!this->coarseArchiveTag && !this->fineArchiveTag) return;
+
+   bool isAway = (this->chart->getDuration () != this->archiveWindowDuration);
+   if (!isAway) {
+      const qint64 shift = this->archiveWindowEnd.secsTo (this->chart->getEndDateTime ());
+      const qint64 drift = this->archiveWindowIsRealTime
+                           ? this->archiveRequestTime.secsTo (QDateTime::currentDateTime ()) : 0;
+      isAway = (shift < -1) || (shift > drift + 1);
+   }
+
+   if (isAway) {
+      this->cancelArchiveReads ();
+   }
 }
 
 //------------------------------------------------------------------------------
@@ -1287,7 +1392,7 @@ void QEStripChartItem::recalcualteBufferedValues ()
 
    // Find first start time of the PVs. Exclude the start time of any calculations.
    //
-   QCaDateTime start_time = QCaDateTime::currentDateTime().toUTC ();
+   QCaTimeStamp start_time = QCaTimeStamp::currentTime ();
    for (int j = 0; j < QEStripChart::NUMBER_OF_PVS; j++) {
       QEStripChartItem* item = this->chart->getItem (j);
       if ((j != this->slot) && item && item->isPvData ()) {
@@ -1300,7 +1405,7 @@ void QEStripChartItem::recalcualteBufferedValues ()
 
    // Find last end time of the PVs. Exclude the start time of any calculations.
    //
-   QCaDateTime end_time = start_time;
+   QCaTimeStamp end_time = start_time;
    for (int j = 0; j < QEStripChart::NUMBER_OF_PVS; j++) {
       QEStripChartItem* item = this->chart->getItem (j);
       if ((j != this->slot) && item && item->isPvData ()) {
@@ -1335,7 +1440,8 @@ void QEStripChartItem::recalcualteBufferedValues ()
    double previousValue = 0.0;
    QCaAlarmInfo previousAlarm (CALC_ALARM, INVALID_ALARM);
 
-   for (QCaDateTime time = start_time; time <= end_time; time = time.addMSecs(deltaTimeMS)) {
+   const qint64 deltaTimeNS = deltaTimeMS * 1000000;
+   for (QCaTimeStamp time = start_time; time <= end_time; time = time.addNanoSecs (deltaTimeNS)) {
 
       QEStripChartItem::CalcInputs values;
 
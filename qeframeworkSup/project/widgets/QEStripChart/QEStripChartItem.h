@@ -35,6 +35,7 @@
 #include <QObject>
 #include <QPoint>
 #include <QPushButton>
+#include <QSet>
 #include <QString>
 #include <QWidget>
 
@@ -215,6 +216,28 @@ private:
 
    QEArchiveAccess archiveAccess;
 
+   // Archive data is loaded progressively, i.e. a quick coarse request followed
+   // by a finer request for the displayed window. Each request has its own user
+   // data tag object, which is held until the response arrives, even if the
+   // request is cancelled.
+   //
+   QObject* coarseArchiveTag;             // outstanding coarse request, if any
+   QObject* fineArchiveTag;               // outstanding finer request, if any
+   QSet<const QObject*> archiveTags;      // all outstanding requests
+   QDateTime archiveWindowEnd;            // chart window when requested
+   int archiveWindowDuration;
+   bool archiveWindowIsRealTime;
+   QDateTime archiveRequestTime;
+
+   QObject* archiveRead (const QDateTime& startDateTime,
+                         const QDateTime& endDateTime,
+                         const int count,
+                         const QEArchiveInterface::How how);
+   void cancelArchiveReads ();
+   void checkArchiveReads ();             // cancels if panned/zoomed away
+   void applyArchiveData (const bool okay, const QCaDataPointList& archiveData,
+                          const QString& pvName, const QString& supplementary);
+
    QEStripChartAdjustPVDialog *adjustPVDialog;
 
    enum DataChartKinds { NotInUse,          // blank  - not in use - no data - no plot
@@ -122,10 +122,10 @@ void QEStripChartStatistics::processDataList (const QCaDataPointList& dataList)
    QCaDateTime endTime;
    QString format ("yyyy-MM-dd hh:mm:ss");
 
-   startTime = dataList.value (0).datetime;
+   startTime = QCaDateTime (dataList.value (0).datetime);
    this->ui->startTimeLabel->setText (startTime.toString (format) + "  " + QEUtilities::getTimeZoneTLA (startTime));
 
-   endTime = dataList.value (n - 1).datetime;
+   endTime = QCaDateTime (dataList.value (n - 1).datetime);
    this->ui->endTimeLabel->setText (endTime.toString (format) + "  " + QEUtilities::getTimeZoneTLA (endTime));
 
    double duration = startTime.secondsTo (endTime);
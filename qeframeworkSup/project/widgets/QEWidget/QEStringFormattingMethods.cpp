@@ -185,4 +185,10 @@ QELocalEnumeration QEStringFormattingMethods::getLocalEnumerationObject() const
     return this->stringFormatting.getLocalEnumerationObject();
 }
 
+// Number of data updates not re-formatted/re-displayed because the text would not change.
+quint64 QEStringFormattingMethods::getUnchangedUpdateCount() const
+{
+    return this->stringFormatting.getUnchangedUpdateCount();
+}
+
 // end
@@ -101,6 +101,11 @@ public:
     // Access underlying local enumerations object (as opposed to property string)
     QELocalEnumeration getLocalEnumerationObject() const;
 
+    // Number of data updates skipped (not formatted nor presented) because
+    // neither the text nor the alarm state would have changed.
+    // Only applies to widgets that enable QEString::setSuppressUnchanged.
+    quint64 getUnchangedUpdateCount() const;
+
 protected:
     QEStringFormatting stringFormatting;
 };